@@ -504,8 +504,12 @@ size_t light_pcapng_to_file_stream(const light_pcapng pcapng, light_file file)
       DCHECK_ASSERT(iterator->block_total_length, body_length + option_length + 3 * sizeof(uint32_t), light_stop);
 
       free(option_mem);
+      if (light_write(file, block_mem, iterator->block_total_length) != iterator->block_total_length)
+      {
+         free(block_mem);
+         return 0;
+      }
       total_bytes += iterator->block_total_length;
-      light_write(file, block_mem, iterator->block_total_length);
       iterator = iterator->next_block;
    }
 
@@ -468,12 +468,12 @@ int light_get_next_packet(light_pcapng_t *pcapng, light_packet_header *packet_he
 
 static const uint8_t NSEC_PRECISION = 9;
 
-void light_write_packet(light_pcapng_t *pcapng, const light_packet_header *packet_header, const uint8_t *packet_data)
+int light_write_packet(light_pcapng_t *pcapng, const light_packet_header *packet_header, const uint8_t *packet_data)
 {
-	DCHECK_NULLP(pcapng, return);
-	DCHECK_NULLP(packet_header, return);
-	DCHECK_NULLP(packet_data, return);
-	DCHECK_ASSERT_EXP(__is_open_for_write(pcapng) == LIGHT_TRUE, "file not open for writing", return);
+	DCHECK_NULLP(pcapng, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_header, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_NULLP(packet_data, return LIGHT_INVALID_ARGUMENT);
+	DCHECK_ASSERT_EXP(__is_open_for_write(pcapng) == LIGHT_TRUE, "file not open for writing", return LIGHT_FAILURE);
 
 	size_t iface_id = 0;
 	for (iface_id = 0; iface_id < pcapng->file_info->interface_block_count; iface_id++)
@@ -542,9 +542,11 @@ void light_write_packet(light_pcapng_t *pcapng, const light_packet_header *packe
 	else
 		light_add_block(blocks_to_write, packet_block_pcapng);
 
-	light_pcapng_to_file_stream(blocks_to_write, pcapng->file);
+	size_t written = light_pcapng_to_file_stream(blocks_to_write, pcapng->file);
 
 	light_pcapng_release(blocks_to_write);
+
+	return written > 0 ? LIGHT_SUCCESS : LIGHT_FAILURE;
 }
 
 void light_pcapng_close(light_pcapng_t *pcapng)
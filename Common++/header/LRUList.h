@@ -3,6 +3,9 @@
 
 #include <map>
 #include <list>
+#include <vector>
+#include <functional>
+#include <stdint.h>
 
 #if __cplusplus > 199711L || _MSC_VER >= 1800
 #include <utility>
@@ -130,6 +133,321 @@ namespace pcpp
 		size_t m_MaxSize;
 	};
 
+	/**
+	 * @class HashedLRUList
+	 * A template class that implements a LRU cache with limited size, with the same interface and behavior as LRUList but with all
+	 * operations in O(1). Elements are kept in an intrusive doubly-linked list of nodes stored in a pool, and are indexed by an open
+	 * addressing hash table that holds node indices. Freed nodes are reused, so once the list has reached its max size put() and
+	 * eraseElement() don't allocate memory at all. The pool and the hash table grow geometrically up to the max size; if that's
+	 * undesirable the whole storage can be allocated up front with reserve().
+	 *
+	 * Element type T must be copy-assignable, and hashable with the provided Hash (std::hash<T> by default) and comparable with the
+	 * provided KeyEqual (std::equal_to<T> by default)
+	 */
+	template<typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T> >
+	class HashedLRUList
+	{
+	public:
+
+		/**
+		 * A c'tor for this class
+		 * @param[in] maxSize The max size this list can go
+		 * @param[in] hasher The hash function object to use. This parameter is optional
+		 * @param[in] keyEqual The equality function object to use. This parameter is optional
+		 */
+		explicit HashedLRUList(size_t maxSize, const Hash& hasher = Hash(), const KeyEqual& keyEqual = KeyEqual()) :
+			m_MaxSize(maxSize), m_Size(0), m_Head(InvalidIndex), m_Tail(InvalidIndex), m_FreeList(InvalidIndex), m_HashShift(64), m_Hasher(hasher), m_KeyEqual(keyEqual)
+		{
+		}
+
+		/**
+		 * Puts an element in the list. This element will be inserted (or advanced if it already exists) to the head of the
+		 * list as the most recently used element. If the list already reached its max size and the element is new this method
+		 * will remove the least recently used element and return a value in deletedValue. Method complexity is O(1).
+		 * @param[in] element The element to insert or to advance to the head of the list (if already exists)
+		 * @param[out] deletedValue The value of deleted element if a pointer is not NULL. This parameter is optional.
+		 * @return 0 if the list didn't reach its max size, 1 otherwise. In case the list already reached its max size
+		 * and deletedValue is not NULL the value of deleted element is copied into the place the deletedValue points to.
+		 */
+		int put(const T& element, T* deletedValue = NULL)
+		{
+			size_t bucket = findBucket(element);
+			if (bucket != InvalidIndex)
+			{
+				size_t nodeIndex = m_Buckets[bucket];
+				unlinkNode(nodeIndex);
+				linkNodeAtHead(nodeIndex);
+				return 0;
+			}
+
+			// one extra node is needed since the new element is inserted before the least recently used one is removed
+			if (m_FreeList == InvalidIndex && m_Nodes.size() == m_Nodes.capacity())
+				grow();
+
+			size_t nodeIndex = allocateNode(element);
+			linkNodeAtHead(nodeIndex);
+			insertToBuckets(nodeIndex);
+			m_Size++;
+
+			if (m_Size > m_MaxSize)
+			{
+				size_t lruIndex = m_Tail;
+				if (deletedValue != NULL)
+#if __cplusplus > 199711L || _MSC_VER >= 1800
+					*deletedValue = std::move(m_Nodes[lruIndex].element);
+#else
+					*deletedValue = m_Nodes[lruIndex].element;
+#endif
+				eraseFromBuckets(findNodeBucket(lruIndex));
+				unlinkNode(lruIndex);
+				freeNode(lruIndex);
+				m_Size--;
+				return 1;
+			}
+
+			return 0;
+		}
+
+		/**
+		 * Get the most recently used element (the one at the beginning of the list)
+		 * @return The most recently used element
+		 */
+		const T& getMRUElement() const
+		{
+			return m_Nodes[m_Head].element;
+		}
+
+		/**
+		 * Get the least recently used element (the one at the end of the list)
+		 * @return The least recently used element
+		 */
+		const T& getLRUElement() const
+		{
+			return m_Nodes[m_Tail].element;
+		}
+
+		/**
+		 * Look for an element in the list without changing its position in it. Method complexity is O(1)
+		 * @param[in] element The element to look for
+		 * @return A pointer to the stored element which is equal to the given one, or NULL if it's not in the list. The pointer is valid
+		 * until the list is modified
+		 */
+		const T* find(const T& element) const
+		{
+			size_t bucket = findBucket(element);
+			if (bucket == InvalidIndex)
+				return NULL;
+
+			return &m_Nodes[m_Buckets[bucket]].element;
+		}
+
+		/**
+		 * Erase an element from the list. If element isn't found in the list nothing happens. Method complexity is O(1)
+		 * @param[in] element The element to erase
+		 */
+		void eraseElement(const T& element)
+		{
+			size_t bucket = findBucket(element);
+			if (bucket == InvalidIndex)
+				return;
+
+			size_t nodeIndex = m_Buckets[bucket];
+			eraseFromBuckets(bucket);
+			unlinkNode(nodeIndex);
+			freeNode(nodeIndex);
+			m_Size--;
+		}
+
+		/**
+		 * Allocate the node pool and the hash table for the given number of elements up front, so that no memory is allocated
+		 * until the list holds more elements than that
+		 * @param[in] numOfElements The number of elements to allocate storage for. It's capped at the max size of the list
+		 */
+		void reserve(size_t numOfElements)
+		{
+			if (numOfElements > m_MaxSize)
+				numOfElements = m_MaxSize;
+
+			// one extra node is needed since the new element is inserted before the least recently used one is removed
+			if (numOfElements + 1 > m_Nodes.capacity())
+				rehash(numOfElements + 1);
+		}
+
+		/**
+		 * @return The max size of this list as determined in the c'tor
+		 */
+		size_t getMaxSize() const { return m_MaxSize; }
+
+		/**
+		 * @return The number of elements currently in this list
+		 */
+		size_t getSize() const { return m_Size; }
+
+	private:
+		static const size_t InvalidIndex = (size_t)-1;
+
+		struct Node
+		{
+			T element;
+			size_t prev;
+			size_t next;
+
+			Node(const T& elem) : element(elem), prev(InvalidIndex), next(InvalidIndex) {}
+		};
+
+		std::vector<Node> m_Nodes;
+		std::vector<size_t> m_Buckets;
+		size_t m_MaxSize;
+		size_t m_Size;
+		size_t m_Head;
+		size_t m_Tail;
+		size_t m_FreeList;
+		int m_HashShift;
+		Hash m_Hasher;
+		KeyEqual m_KeyEqual;
+
+		size_t getIdealBucket(const T& element) const
+		{
+			// Fibonacci hashing spreads hashers that return the element itself (like std::hash for integers) over the whole table
+			return (size_t)(((uint64_t)m_Hasher(element) * 0x9E3779B97F4A7C15ULL) >> m_HashShift);
+		}
+
+		size_t findBucket(const T& element) const
+		{
+			if (m_Buckets.empty())
+				return InvalidIndex;
+
+			size_t mask = m_Buckets.size() - 1;
+			for (size_t bucket = getIdealBucket(element); m_Buckets[bucket] != InvalidIndex; bucket = (bucket + 1) & mask)
+			{
+				if (m_KeyEqual(m_Nodes[m_Buckets[bucket]].element, element))
+					return bucket;
+			}
+
+			return InvalidIndex;
+		}
+
+		size_t findNodeBucket(size_t nodeIndex) const
+		{
+			size_t mask = m_Buckets.size() - 1;
+			size_t bucket = getIdealBucket(m_Nodes[nodeIndex].element);
+			while (m_Buckets[bucket] != nodeIndex)
+				bucket = (bucket + 1) & mask;
+
+			return bucket;
+		}
+
+		void insertToBuckets(size_t nodeIndex)
+		{
+			size_t mask = m_Buckets.size() - 1;
+			size_t bucket = getIdealBucket(m_Nodes[nodeIndex].element);
+			while (m_Buckets[bucket] != InvalidIndex)
+				bucket = (bucket + 1) & mask;
+
+			m_Buckets[bucket] = nodeIndex;
+		}
+
+		void eraseFromBuckets(size_t bucket)
+		{
+			// backward shift deletion: move following entries of the probe sequence into the hole so lookups never need tombstones
+			size_t mask = m_Buckets.size() - 1;
+			size_t hole = bucket;
+			size_t next = (hole + 1) & mask;
+			while (m_Buckets[next] != InvalidIndex)
+			{
+				size_t ideal = getIdealBucket(m_Nodes[m_Buckets[next]].element);
+				if (((next - ideal) & mask) >= ((next - hole) & mask))
+				{
+					m_Buckets[hole] = m_Buckets[next];
+					hole = next;
+				}
+				next = (next + 1) & mask;
+			}
+
+			m_Buckets[hole] = InvalidIndex;
+		}
+
+		void linkNodeAtHead(size_t nodeIndex)
+		{
+			Node& node = m_Nodes[nodeIndex];
+			node.prev = InvalidIndex;
+			node.next = m_Head;
+			if (m_Head != InvalidIndex)
+				m_Nodes[m_Head].prev = nodeIndex;
+			m_Head = nodeIndex;
+			if (m_Tail == InvalidIndex)
+				m_Tail = nodeIndex;
+		}
+
+		void unlinkNode(size_t nodeIndex)
+		{
+			Node& node = m_Nodes[nodeIndex];
+			if (node.prev != InvalidIndex)
+				m_Nodes[node.prev].next = node.next;
+			else
+				m_Head = node.next;
+
+			if (node.next != InvalidIndex)
+				m_Nodes[node.next].prev = node.prev;
+			else
+				m_Tail = node.prev;
+		}
+
+		size_t allocateNode(const T& element)
+		{
+			if (m_FreeList == InvalidIndex)
+			{
+				m_Nodes.push_back(Node(element));
+				return m_Nodes.size() - 1;
+			}
+
+			size_t nodeIndex = m_FreeList;
+			m_FreeList = m_Nodes[nodeIndex].next;
+			m_Nodes[nodeIndex].element = element;
+			return nodeIndex;
+		}
+
+		void freeNode(size_t nodeIndex)
+		{
+			// free nodes are chained through their next index
+			m_Nodes[nodeIndex].next = m_FreeList;
+			m_FreeList = nodeIndex;
+		}
+
+		void grow()
+		{
+			size_t newCapacity = m_Nodes.capacity() < 16 ? 16 : m_Nodes.capacity() * 2;
+			if (newCapacity > m_MaxSize + 1)
+				newCapacity = m_MaxSize + 1;
+
+			rehash(newCapacity);
+		}
+
+		void rehash(size_t nodeCapacity)
+		{
+			m_Nodes.reserve(nodeCapacity);
+
+			// keep the hash table at most half full
+			size_t numOfBuckets = 2;
+			m_HashShift = 63;
+			while (numOfBuckets < nodeCapacity * 2)
+			{
+				numOfBuckets <<= 1;
+				m_HashShift--;
+			}
+
+			if (numOfBuckets == m_Buckets.size())
+				return;
+
+			m_Buckets.assign(numOfBuckets, InvalidIndex);
+			for (size_t nodeIndex = m_Head; nodeIndex != InvalidIndex; nodeIndex = m_Nodes[nodeIndex].next)
+				insertToBuckets(nodeIndex);
+		}
+	};
+
+	template<typename T, typename Hash, typename KeyEqual>
+	const size_t HashedLRUList<T, Hash, KeyEqual>::InvalidIndex;
+
 } // namespace pcpp
 
 #endif /* PCAPPP_LRU_LIST */
@@ -6,11 +6,32 @@
 #include <sstream>
 #include <iomanip>
 #include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <utility>
 
 #ifndef LOG_MODULE
 #define LOG_MODULE UndefinedLogModule
 #endif
 
+/**
+ * The most verbose log level compiled into the code: 0 (Logger#Error), 1 (Logger#Info) or 2 (Logger#Debug, the default).
+ * Log macros of a more verbose level expand to nothing and have no runtime cost, for example building with -DPCPP_MAX_LOG_LEVEL=0
+ * strips all debug logs. Setting it to -1 strips error logs as well, in which case Logger#getLastError() is no longer updated
+ */
+#ifndef PCPP_MAX_LOG_LEVEL
+#define PCPP_MAX_LOG_LEVEL 2
+#endif
+
+/**
+ * The max length of a message kept in the asynchronous log queues (see pcpp#Logger#startAsyncLogging()). Longer messages are truncated
+ */
+#ifndef PCPP_ASYNC_LOG_MAX_MESSAGE_LEN
+#define PCPP_ASYNC_LOG_MAX_MESSAGE_LEN 480
+#endif
+
 /// @file
 
 /**
@@ -85,6 +106,34 @@ namespace pcpp
 		NumOfLogModules
 	};
 
+	/**
+	 * @class LogRateLimiter
+	 * The rate limit state of a single log call site (see Logger#setMaxLogsPerSecond()). The log macros define a static instance of this
+	 * class in each call site, so it shouldn't be used directly
+	 */
+	class LogRateLimiter
+	{
+	public:
+		/**
+		 * A constexpr c'tor, so static instances are initialized at compile time and accessing them doesn't need a guard
+		 */
+		constexpr LogRateLimiter() : m_Window(0), m_NumOfLogs(0), m_NumOfSuppressedLogs(0) {}
+
+		/**
+		 * Check if another message can be printed in the current one second window
+		 * @param[in] maxLogsPerSecond The max number of messages per second
+		 * @param[out] numOfSuppressedLogs If the message can be printed, set to the number of messages suppressed since the previous
+		 * printed message
+		 * @return True if the message can be printed, false if it should be suppressed
+		 */
+		bool allow(uint32_t maxLogsPerSecond, uint32_t& numOfSuppressedLogs);
+
+	private:
+		std::atomic<uint64_t> m_Window;
+		std::atomic<uint32_t> m_NumOfLogs;
+		std::atomic<uint32_t> m_NumOfSuppressedLogs;
+	};
+
 	/**
 	 * @class Logger
 	 * PcapPlusPlus logger manager.
@@ -102,6 +151,12 @@ namespace pcpp
 	 * PcapPlusPlus logger is a singleton which can be reached from anywhere in the code.
 	 *
 	 * Note: Logger#Info level logs are currently only used in DPDK devices to set DPDK log level to RTE_LOG_NOTICE.
+	 *
+	 * The logger can be used from multiple threads. Log messages are formatted into a per-thread buffer, so no memory is allocated on the
+	 * calling thread. By default the log printer is called on the thread that logged the message. Calling startAsyncLogging() moves the printing
+	 * to a dedicated flusher thread: each logging thread gets its own lock-free queue, so a slow printer never stalls the threads that log.
+	 * In addition, setMaxLogsPerSecond() limits the number of messages each log call site can print per second, so error storms don't flood
+	 * the log, and PCPP_MAX_LOG_LEVEL strips log levels at compile time.
 	 */
 	class Logger
 	{
@@ -175,7 +230,11 @@ namespace pcpp
 		/**
 		 * @return Get the last error message
 		 */
-		std::string getLastError() { return m_LastError; }
+		std::string getLastError()
+		{
+			std::lock_guard<std::mutex> lock(m_LastErrorMutex);
+			return m_LastError;
+		}
 
 		/**
 		 * Suppress logs in all PcapPlusPlus modules
@@ -193,23 +252,72 @@ namespace pcpp
 		 */
 		bool logsEnabled() const { return m_LogsEnabled; }
 
-		template<class T>
-		Logger& operator<<(const T& msg)
+		/**
+		 * Limit the number of messages each log call site (each PCPP_LOG_ERROR or PCPP_LOG_DEBUG in the code) prints per second. Messages
+		 * beyond the limit are dropped before they're formatted, and the next message printed by the same call site mentions how many
+		 * messages were suppressed. Logger#getLastError() is updated only by messages that aren't suppressed
+		 * @param[in] maxLogsPerSecond The max number of messages per call site per second. 0 means no limit, which is the default
+		 */
+		void setMaxLogsPerSecond(uint32_t maxLogsPerSecond) { m_MaxLogsPerSecond.store(maxLogsPerSecond, std::memory_order_relaxed); }
+
+		/**
+		 * @return The max number of messages each log call site prints per second. 0 means no limit
+		 */
+		uint32_t getMaxLogsPerSecond() const { return m_MaxLogsPerSecond.load(std::memory_order_relaxed); }
+
+		/**
+		 * Start printing log messages asynchronously. From now on log messages are copied into a lock-free queue owned by the logging thread
+		 * and printed by a dedicated flusher thread, which is the only thread that calls the log printer. If a queue is full the message is
+		 * dropped and counted (see getNumOfDroppedLogs()). Messages longer than PCPP_ASYNC_LOG_MAX_MESSAGE_LEN are truncated.
+		 * Logger#getLastError() is still updated synchronously
+		 * @param[in] queueCapacity The number of messages each logging thread can queue. Rounded up to a power of 2. Applies to
+		 * queues created after this call
+		 * @return True if asynchronous logging was started, false if it's already running
+		 */
+		bool startAsyncLogging(size_t queueCapacity = 1024);
+
+		/**
+		 * Print all queued messages, stop the flusher thread and go back to printing log messages on the logging thread. It should be called
+		 * when no other thread is logging. It is called automatically when the application exits
+		 */
+		void stopAsyncLogging();
+
+		/**
+		 * @return True if log messages are currently printed asynchronously
+		 */
+		bool isAsyncLoggingEnabled() const { return m_AsyncLoggingEnabled.load(std::memory_order_acquire); }
+
+		/**
+		 * Wait until all the messages queued so far are printed. Does nothing if asynchronous logging isn't enabled
+		 */
+		void flushAsyncLogs();
+
+		/**
+		 * @return The number of log messages dropped because the queue of the logging thread was full
+		 */
+		uint64_t getNumOfDroppedLogs() const { return m_NumOfDroppedLogs.load(std::memory_order_relaxed); }
+
+		/**
+		 * An internal method that returns the calling thread's log stream, cleared and ready for a new message. Shouldn't be used externally.
+		 */
+		std::ostream* internalCreateLogStream();
+
+		/**
+		 * An internal method that checks the rate limit of a log call site. Shouldn't be used externally.
+		 */
+		bool internalShouldLog(LogRateLimiter& rateLimiter, uint32_t& numOfSuppressedLogs)
 		{
-			(*m_LogStream) << msg;
-			return *this;
+			uint32_t maxLogsPerSecond = m_MaxLogsPerSecond.load(std::memory_order_relaxed);
+			return maxLogsPerSecond == 0 || rateLimiter.allow(maxLogsPerSecond, numOfSuppressedLogs);
 		}
 
-		std::ostringstream * internalCreateLogStream();
-
 		/**
 		 * An internal method to print log messages. Shouldn't be used externally.
 		 */
-		void internalPrintLogMessage(std::ostringstream* logStream, Logger::LogLevel logLevel, const char* file, const char* method, int line);
+		void internalPrintLogMessage(std::ostream* logStream, Logger::LogLevel logLevel, const char* file, const char* method, int line, uint32_t numOfSuppressedLogs = 0);
 
 		/**
-		 * Get access to Logger singleton
-		 * @todo: make this singleton thread-safe/
+		 * Get access to Logger singleton. The singleton is created on first use, which is thread-safe
 		 * @return a pointer to the Logger singleton
 		**/
 		static Logger& getInstance()
@@ -217,36 +325,72 @@ namespace pcpp
 			static Logger instance;
 			return instance;
 		}
+
+		~Logger();
 	private:
+		struct AsyncLogQueue;
+
 		bool m_LogsEnabled;
 		Logger::LogLevel m_LogModulesArray[NumOfLogModules];
 		LogPrinter m_LogPrinter;
 		std::string m_LastError;
-		std::ostringstream* m_LogStream;
+		std::mutex m_LastErrorMutex;
+		std::atomic<uint32_t> m_MaxLogsPerSecond;
+
+		// async logging. Queues are created once per logging thread and reused by later threads, they're freed only when the logger is destroyed
+		std::vector<AsyncLogQueue*> m_AsyncQueues;
+		std::mutex m_AsyncQueuesMutex;
+		size_t m_AsyncQueueCapacity;
+		std::atomic<bool> m_AsyncLoggingEnabled;
+		std::atomic<bool> m_StopFlusher;
+		std::atomic<uint64_t> m_NumOfDroppedLogs;
+		std::thread m_FlusherThread;
 
 		// private c'tor - this class is a singleton
 		Logger();
 
+		AsyncLogQueue* acquireAsyncQueue();
+		void enqueueLogMessage(Logger::LogLevel logLevel, const char* file, const char* method, int line, const char* message, size_t messageLen);
+		bool flushAsyncQueues();
+		void flusherThreadMain();
+
 		static void defaultLogPrinter(LogLevel logLevel, const std::string& logMessage, const std::string& file, const std::string& method, const int line);
 	};
 
-#define PCPP_LOG_DEBUG(message) do \
+#define PCPP_LOG(level, message) do \
 	{ \
-		if (pcpp::Logger::getInstance().logsEnabled() && pcpp::Logger::getInstance().isDebugEnabled(LOG_MODULE)) \
+		static pcpp::LogRateLimiter pcppLogRateLimiter; \
+		uint32_t pcppNumOfSuppressedLogs = 0; \
+		if (pcpp::Logger::getInstance().internalShouldLog(pcppLogRateLimiter, pcppNumOfSuppressedLogs)) \
 		{ \
-			std::ostringstream* sstream = pcpp::Logger::getInstance().internalCreateLogStream(); \
+			std::ostream* sstream = pcpp::Logger::getInstance().internalCreateLogStream(); \
 			(*sstream) << message; \
-			pcpp::Logger::getInstance().internalPrintLogMessage(sstream, pcpp::Logger::Debug, __FILE__, __FUNCTION__, __LINE__); \
+			pcpp::Logger::getInstance().internalPrintLogMessage(sstream, level, __FILE__, __FUNCTION__, __LINE__, pcppNumOfSuppressedLogs); \
 		} \
-	} while(0)
+	} while (0)
 
-#define PCPP_LOG_ERROR(message) do \
+// a stripped log statement is never evaluated, but still references the variables in the message so they don't become unused
+#define PCPP_LOG_STRIPPED(message) do \
 	{ \
-        std::ostringstream* sstream = pcpp::Logger::getInstance().internalCreateLogStream(); \
-  		(*sstream) << message; \
-		pcpp::Logger::getInstance().internalPrintLogMessage(sstream, pcpp::Logger::Error, __FILE__, __FUNCTION__, __LINE__); \
+		(void)sizeof(std::declval<std::ostream&>() << message); \
 	} while (0)
 
+#if PCPP_MAX_LOG_LEVEL >= 2
+#define PCPP_LOG_DEBUG(message) do \
+	{ \
+		if (pcpp::Logger::getInstance().logsEnabled() && pcpp::Logger::getInstance().isDebugEnabled(LOG_MODULE)) \
+			PCPP_LOG(pcpp::Logger::Debug, message); \
+	} while(0)
+#else
+#define PCPP_LOG_DEBUG(message) PCPP_LOG_STRIPPED(message)
+#endif
+
+#if PCPP_MAX_LOG_LEVEL >= 0
+#define PCPP_LOG_ERROR(message) PCPP_LOG(pcpp::Logger::Error, message)
+#else
+#define PCPP_LOG_ERROR(message) PCPP_LOG_STRIPPED(message)
+#endif
+
 } // namespace pcpp
 
 #endif /* PCAPPP_LOGGER */
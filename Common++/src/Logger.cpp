@@ -1,16 +1,213 @@
 #include <sstream>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
 #include "Logger.h"
 
+// the time the flusher thread sleeps when all queues are empty
+#define FLUSHER_IDLE_SLEEP_USEC 500
+
+// the size of the per-thread buffer log messages are formatted into. Longer messages temporarily allocate memory
+#define LOG_MESSAGE_BUFFER_SIZE 512
+
 namespace pcpp
 {
 
-Logger::Logger() : m_LogsEnabled(true), m_LogPrinter(&defaultLogPrinter)
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Per-thread log message buffer
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace
+{
+
+/**
+ * A stream buffer that formats into a fixed-size array and moves to a heap string only when a message doesn't fit in it
+ */
+class LogMessageBuffer : public std::streambuf
+{
+public:
+	LogMessageBuffer() { clear(); }
+
+	void clear()
+	{
+		setp(m_Buffer, m_Buffer + LOG_MESSAGE_BUFFER_SIZE);
+		if (!m_Overflow.empty())
+			std::string().swap(m_Overflow);
+	}
+
+	const char* data() const { return m_Overflow.empty() ? m_Buffer : m_Overflow.data(); }
+
+	size_t size() const { return m_Overflow.empty() ? (size_t)(pptr() - pbase()) : m_Overflow.size(); }
+
+protected:
+	int_type overflow(int_type ch)
+	{
+		if (traits_type::eq_int_type(ch, traits_type::eof()))
+			return traits_type::not_eof(ch);
+
+		moveToOverflow();
+		m_Overflow.push_back(traits_type::to_char_type(ch));
+		return ch;
+	}
+
+	std::streamsize xsputn(const char* s, std::streamsize count)
+	{
+		if (m_Overflow.empty() && count <= epptr() - pptr())
+		{
+			memcpy(pptr(), s, (size_t)count);
+			pbump((int)count);
+			return count;
+		}
+
+		moveToOverflow();
+		m_Overflow.append(s, (size_t)count);
+		return count;
+	}
+
+private:
+	void moveToOverflow()
+	{
+		if (!m_Overflow.empty())
+			return;
+
+		m_Overflow.assign(pbase(), pptr());
+		// from now on all writes go through overflow() and xsputn()
+		setp(m_Buffer, m_Buffer);
+	}
+
+	char m_Buffer[LOG_MESSAGE_BUFFER_SIZE];
+	std::string m_Overflow;
+};
+
+struct ThreadLogState
+{
+	LogMessageBuffer buffer;
+	std::ostream stream;
+	std::ios_base::fmtflags defaultFlags;
+	void* asyncQueue;
+	std::atomic<bool>* asyncQueueInUse;
+
+	ThreadLogState() : stream(&buffer), asyncQueue(NULL), asyncQueueInUse(NULL) { defaultFlags = stream.flags(); }
+
+	~ThreadLogState()
+	{
+		// let another thread reuse this thread's queue. Queues are freed only by the logger d'tor, which runs after all threads exited
+		if (asyncQueueInUse != NULL)
+			asyncQueueInUse->store(false, std::memory_order_release);
+	}
+};
+
+ThreadLogState& getThreadLogState()
+{
+	static thread_local ThreadLogState state;
+	return state;
+}
+
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+// LogRateLimiter members
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+
+bool LogRateLimiter::allow(uint32_t maxLogsPerSecond, uint32_t& numOfSuppressedLogs)
+{
+	// windows start at 1 so the initial 0 never matches the current window
+	uint64_t window = (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count() + 1;
+	uint64_t prevWindow = m_Window.load(std::memory_order_relaxed);
+	if (prevWindow != window && m_Window.compare_exchange_strong(prevWindow, window, std::memory_order_relaxed))
+		m_NumOfLogs.store(0, std::memory_order_relaxed);
+
+	if (m_NumOfLogs.fetch_add(1, std::memory_order_relaxed) < maxLogsPerSecond)
+	{
+		numOfSuppressedLogs = m_NumOfSuppressedLogs.exchange(0, std::memory_order_relaxed);
+		return true;
+	}
+
+	m_NumOfSuppressedLogs.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Logger::AsyncLogQueue members
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/**
+ * A single-producer single-consumer ring of log messages. The producer is the thread that owns the queue and the consumer is the flusher thread
+ */
+struct Logger::AsyncLogQueue
+{
+	struct Entry
+	{
+		Logger::LogLevel logLevel;
+		const char* file;
+		const char* method;
+		int line;
+		size_t messageLen;
+		char message[PCPP_ASYNC_LOG_MAX_MESSAGE_LEN];
+	};
+
+	std::vector<Entry> entries;
+	size_t mask;
+	std::atomic<uint64_t> writeIndex;
+	std::atomic<uint64_t> readIndex;
+	std::atomic<bool> inUse;
+
+	explicit AsyncLogQueue(size_t capacity) : writeIndex(0), readIndex(0), inUse(true)
+	{
+		size_t roundedCapacity = 2;
+		while (roundedCapacity < capacity)
+			roundedCapacity <<= 1;
+
+		entries.resize(roundedCapacity);
+		mask = roundedCapacity - 1;
+	}
+
+	Entry* getWriteEntry()
+	{
+		uint64_t index = writeIndex.load(std::memory_order_relaxed);
+		if (index - readIndex.load(std::memory_order_acquire) >= entries.size())
+			return NULL;
+
+		return &entries[index & mask];
+	}
+
+	void commitWrite() { writeIndex.store(writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+	Entry* getReadEntry()
+	{
+		uint64_t index = readIndex.load(std::memory_order_relaxed);
+		if (index == writeIndex.load(std::memory_order_acquire))
+			return NULL;
+
+		return &entries[index & mask];
+	}
+
+	void commitRead() { readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+};
+
+
+// ~~~~~~~~~~~~~~~~
+// Logger members
+// ~~~~~~~~~~~~~~~~
+
+Logger::Logger() : m_LogsEnabled(true), m_LogPrinter(&defaultLogPrinter), m_MaxLogsPerSecond(0),
+	m_AsyncQueueCapacity(1024), m_AsyncLoggingEnabled(false), m_StopFlusher(false), m_NumOfDroppedLogs(0)
 {
 	m_LastError.reserve(200);
 	for (int i = 0; i<NumOfLogModules; i++)
 		m_LogModulesArray[i] = Info;
 }
 
+Logger::~Logger()
+{
+	stopAsyncLogging();
+
+	for (std::vector<AsyncLogQueue*>::iterator iter = m_AsyncQueues.begin(); iter != m_AsyncQueues.end(); ++iter)
+		delete *iter;
+}
+
 std::string Logger::logLevelAsString(LogLevel logLevel)
 {
 	switch (logLevel)
@@ -36,22 +233,178 @@ void Logger::defaultLogPrinter(LogLevel logLevel, const std::string& logMessage,
 		<< logMessage << std::endl;
 }
 
-std::ostringstream * Logger::internalCreateLogStream()
+std::ostream* Logger::internalCreateLogStream()
 {
-	return new std::ostringstream ();
+	ThreadLogState& state = getThreadLogState();
+	state.buffer.clear();
+
+	// formatting set by a previous message (e.g std::hex) shouldn't leak to this one
+	state.stream.clear();
+	state.stream.flags(state.defaultFlags);
+	state.stream.width(0);
+	state.stream.precision(6);
+	state.stream.fill(' ');
+	return &state.stream;
 }
 
-void Logger::internalPrintLogMessage(std::ostringstream* logStream, Logger::LogLevel logLevel, const char* file, const char* method, int line)
+void Logger::internalPrintLogMessage(std::ostream* logStream, Logger::LogLevel logLevel, const char* file, const char* method, int line, uint32_t numOfSuppressedLogs)
 {
-	std::string logMessage = logStream->str();
-	delete logStream;
+	if (numOfSuppressedLogs > 0)
+		(*logStream) << " (" << numOfSuppressedLogs << " similar messages were suppressed)";
+
+	LogMessageBuffer* buffer = static_cast<LogMessageBuffer*>(logStream->rdbuf());
+
 	if (logLevel == Logger::Error)
 	{
-		m_LastError = logMessage;
+		std::lock_guard<std::mutex> lock(m_LastErrorMutex);
+		m_LastError.assign(buffer->data(), buffer->size());
+	}
+
+	if (!m_LogsEnabled)
+		return;
+
+	if (m_AsyncLoggingEnabled.load(std::memory_order_acquire))
+	{
+		enqueueLogMessage(logLevel, file, method, line, buffer->data(), buffer->size());
+		return;
+	}
+
+	m_LogPrinter(logLevel, std::string(buffer->data(), buffer->size()), file, method, line);
+}
+
+bool Logger::startAsyncLogging(size_t queueCapacity)
+{
+	std::lock_guard<std::mutex> lock(m_AsyncQueuesMutex);
+	if (m_AsyncLoggingEnabled.load(std::memory_order_relaxed))
+		return false;
+
+	m_AsyncQueueCapacity = queueCapacity;
+	m_StopFlusher.store(false, std::memory_order_relaxed);
+	m_FlusherThread = std::thread(&Logger::flusherThreadMain, this);
+	m_AsyncLoggingEnabled.store(true, std::memory_order_release);
+	return true;
+}
+
+void Logger::stopAsyncLogging()
+{
+	if (!m_AsyncLoggingEnabled.exchange(false, std::memory_order_acq_rel))
+		return;
+
+	// the flusher drains all queues before it exits
+	m_StopFlusher.store(true, std::memory_order_release);
+	if (m_FlusherThread.joinable())
+		m_FlusherThread.join();
+}
+
+void Logger::flushAsyncLogs()
+{
+	if (!m_AsyncLoggingEnabled.load(std::memory_order_acquire))
+		return;
+
+	std::vector<std::pair<AsyncLogQueue*, uint64_t> > writeCounts;
+	{
+		std::lock_guard<std::mutex> lock(m_AsyncQueuesMutex);
+		for (std::vector<AsyncLogQueue*>::iterator iter = m_AsyncQueues.begin(); iter != m_AsyncQueues.end(); ++iter)
+			writeCounts.push_back(std::make_pair(*iter, (*iter)->writeIndex.load(std::memory_order_acquire)));
 	}
-	if (m_LogsEnabled)
+
+	// queues are never freed while the logger is alive, so they can be accessed without the lock
+	for (std::vector<std::pair<AsyncLogQueue*, uint64_t> >::iterator iter = writeCounts.begin(); iter != writeCounts.end(); ++iter)
 	{
-		m_LogPrinter(logLevel, logMessage, file, method, line);
+		while (iter->first->readIndex.load(std::memory_order_acquire) < iter->second)
+			std::this_thread::yield();
+	}
+}
+
+Logger::AsyncLogQueue* Logger::acquireAsyncQueue()
+{
+	std::lock_guard<std::mutex> lock(m_AsyncQueuesMutex);
+
+	// reuse the queue of a thread that already exited
+	for (std::vector<AsyncLogQueue*>::iterator iter = m_AsyncQueues.begin(); iter != m_AsyncQueues.end(); ++iter)
+	{
+		bool inUse = false;
+		if ((*iter)->inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire))
+			return *iter;
+	}
+
+	AsyncLogQueue* queue = new AsyncLogQueue(m_AsyncQueueCapacity);
+	m_AsyncQueues.push_back(queue);
+	return queue;
+}
+
+void Logger::enqueueLogMessage(Logger::LogLevel logLevel, const char* file, const char* method, int line, const char* message, size_t messageLen)
+{
+	ThreadLogState& state = getThreadLogState();
+	if (state.asyncQueue == NULL)
+	{
+		AsyncLogQueue* queue = acquireAsyncQueue();
+		state.asyncQueue = queue;
+		state.asyncQueueInUse = &queue->inUse;
+	}
+
+	AsyncLogQueue* queue = static_cast<AsyncLogQueue*>(state.asyncQueue);
+	AsyncLogQueue::Entry* entry = queue->getWriteEntry();
+	if (entry == NULL)
+	{
+		m_NumOfDroppedLogs.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	entry->logLevel = logLevel;
+	entry->file = file;
+	entry->method = method;
+	entry->line = line;
+	entry->messageLen = std::min(messageLen, (size_t)PCPP_ASYNC_LOG_MAX_MESSAGE_LEN);
+	memcpy(entry->message, message, entry->messageLen);
+	queue->commitWrite();
+}
+
+bool Logger::flushAsyncQueues()
+{
+	bool printedMessages = false;
+	std::string message;
+
+	// the log printer is called without holding the lock, so a printer that logs doesn't deadlock when registering a new queue. Queues are never
+	// freed while the logger exists, so they can be read after the lock is released
+	std::vector<AsyncLogQueue*> queues;
+	{
+		std::lock_guard<std::mutex> lock(m_AsyncQueuesMutex);
+		queues = m_AsyncQueues;
+	}
+
+	for (std::vector<AsyncLogQueue*>::iterator iter = queues.begin(); iter != queues.end(); ++iter)
+	{
+		AsyncLogQueue::Entry* entry = (*iter)->getReadEntry();
+		while (entry != NULL)
+		{
+			message.assign(entry->message, entry->messageLen);
+			m_LogPrinter(entry->logLevel, message, entry->file, entry->method, entry->line);
+			(*iter)->commitRead();
+			printedMessages = true;
+			entry = (*iter)->getReadEntry();
+		}
+	}
+
+	return printedMessages;
+}
+
+void Logger::flusherThreadMain()
+{
+	while (true)
+	{
+		if (flushAsyncQueues())
+			continue;
+
+		// the stop flag is checked only when all queues are empty, so everything queued before stopAsyncLogging() is printed
+		if (m_StopFlusher.load(std::memory_order_acquire))
+		{
+			if (!flushAsyncQueues())
+				break;
+			continue;
+		}
+
+		std::this_thread::sleep_for(std::chrono::microseconds(FLUSHER_IDLE_SLEEP_USEC));
 	}
 }
 
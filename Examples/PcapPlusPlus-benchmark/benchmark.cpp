@@ -15,17 +15,51 @@
 
 #include <Packet.h>
 #include <DnsLayer.h>
+#include <EthLayer.h>
+#include <IPv4Layer.h>
+#include <TcpLayer.h>
+#include <IPv6Layer.h>
+#include <HttpLayer.h>
+#include <SSLLayer.h>
+#include <PayloadLayer.h>
+#include <LayerAllocator.h>
+#include <UdpLayer.h>
+#include <PacketUtils.h>
+#include <TcpReassembly.h>
+#include <LRUList.h>
+#include <SystemUtils.h>
+#include <Logger.h>
 #include <PcapFileDevice.h>
 #include <iostream>
 #include <chrono>
 #include <string>
 #include <vector>
 #include <numeric>
+#include <atomic>
+#include <new>
+#include <stdlib.h>
 
 using namespace pcpp;
 
 size_t count = 0;
 
+// count heap allocations so the benchmark can report the number of allocations per packet
+std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	void* ptr = malloc(size == 0 ? 1 : size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
 bool handle_dns(Packet& packet)
 {
 	if (!packet.isPacketOfType(DNS))
@@ -50,28 +84,314 @@ bool handle_dns(Packet& packet)
 	return true;
 }
 
+// the same records as handle_dns(), read with the record iteration API of DnsLayer which doesn't create DnsQuery and DnsResource objects.
+// The names are decoded as well, since consumers usually need them
+bool handle_dns_lazy(Packet& packet)
+{
+	if (!packet.isPacketOfType(DNS))
+		return true;
+
+	DnsLayer* dnsLayer = packet.getLayerOfType<DnsLayer>();
+
+	char name[DnsLayer::MaxDecodedNameLength + 1];
+	DnsRecordInfo record;
+	bool recordFound = dnsLayer->getFirstRecord(record);
+	while (recordFound && (record.resourceType == DnsQueryType || record.resourceType == DnsAnswerType))
+	{
+		dnsLayer->decodeName(record.offsetInLayer, name, sizeof(name));
+		count++;
+		recordFound = dnsLayer->getNextRecord(record);
+	}
+
+	return true;
+}
+
 bool handle_packet(Packet& packet)
 {
 	count++;
 	return true;
 }
 
+// a typical consumer which only classifies the packet and looks at a single layer
+bool handle_lookup(Packet& packet)
+{
+	if (!packet.isPacketOfType(TCP))
+		return true;
+
+	TcpLayer* tcpLayer = packet.getLayerOfType<TcpLayer>();
+	if (tcpLayer != nullptr && tcpLayer->getTcpHeader()->synFlag == 0)
+		count++;
+
+	return true;
+}
+
+// the lookup Packet::getLayerOfType() used before layer classes were tagged with their protocol, kept for comparison
+template<class TLayer>
+TLayer* get_layer_rtti(Packet& packet)
+{
+	Layer* curLayer = packet.getFirstLayer();
+	while (curLayer != nullptr && dynamic_cast<TLayer*>(curLayer) == nullptr)
+		curLayer = curLayer->getNextLayer();
+
+	return dynamic_cast<TLayer*>(curLayer);
+}
+
+// the number of times each packet is searched in the layer-lookup modes, so the lookups and not the loop dominate the measurement
+const int LayerLookupRounds = 100;
+
+// look up the layers a typical analyzer needs, either by protocol (the default getLayerOfType()) or with dynamic_cast
+template<bool rtti>
+void handle_layer_lookup(Packet& packet)
+{
+	for (int i = 0; i < LayerLookupRounds; i++)
+	{
+		Layer* layers[] = {
+			rtti ? get_layer_rtti<EthLayer>(packet) : packet.getLayerOfType<EthLayer>(),
+			rtti ? get_layer_rtti<IPv4Layer>(packet) : packet.getLayerOfType<IPv4Layer>(),
+			rtti ? get_layer_rtti<IPv6Layer>(packet) : packet.getLayerOfType<IPv6Layer>(),
+			rtti ? get_layer_rtti<TcpLayer>(packet) : packet.getLayerOfType<TcpLayer>(),
+			rtti ? get_layer_rtti<UdpLayer>(packet) : packet.getLayerOfType<UdpLayer>(),
+			rtti ? get_layer_rtti<DnsLayer>(packet) : packet.getLayerOfType<DnsLayer>(),
+			rtti ? get_layer_rtti<HttpRequestLayer>(packet) : packet.getLayerOfType<HttpRequestLayer>()
+		};
+
+		for (size_t j = 0; j < sizeof(layers) / sizeof(layers[0]); j++)
+		{
+			if (layers[j] != nullptr)
+				count++;
+		}
+	}
+}
+
+// the number of times each packet is searched in the ssl-cipher-lookup mode
+const int SSLCipherLookupRounds = 100;
+
+// look up the cipher-suites of each TLS hello message as SSLAnalyzer does: all cipher-suites offered in a client-hello by ID, and the
+// cipher-suite chosen in a server-hello by ID and then by its name
+void handle_ssl_cipher_lookup(Packet& packet)
+{
+	SSLHandshakeLayer* handshakeLayer = packet.getLayerOfType<SSLHandshakeLayer>();
+	while (handshakeLayer != nullptr)
+	{
+		SSLClientHelloMessage* clientHello = handshakeLayer->getHandshakeMessageOfType<SSLClientHelloMessage>();
+		SSLServerHelloMessage* serverHello = handshakeLayer->getHandshakeMessageOfType<SSLServerHelloMessage>();
+		for (int i = 0; i < SSLCipherLookupRounds; i++)
+		{
+			if (clientHello != nullptr)
+			{
+				int cipherSuiteCount = clientHello->getCipherSuiteCount();
+				for (int j = 0; j < cipherSuiteCount; j++)
+				{
+					if (clientHello->getCipherSuite(j) != nullptr)
+						count++;
+				}
+			}
+
+			if (serverHello != nullptr)
+			{
+				SSLCipherSuite* cipherSuite = serverHello->getCipherSuite();
+				if (cipherSuite != nullptr && SSLCipherSuite::getCipherSuiteByName(cipherSuite->asString()) == cipherSuite)
+					count++;
+			}
+		}
+
+		handshakeLayer = packet.getNextLayerOfType<SSLHandshakeLayer>(handshakeLayer);
+	}
+}
+
+// the number of concurrent connections simulated by the tcp-reassembly mode
+const uint32_t TcpReassemblyNumOfFlows = 1000000;
+
+void handle_tcp_message(int8_t side, const TcpStreamData& tcpData, void* userCookie)
+{
+	*static_cast<size_t*>(userCookie) += tcpData.getDataLength();
+}
+
+// feed TcpReassembly with synthetic traffic: first a request on each of numOfFlows connections, then a response on each of them and
+// finally a FIN from both sides, so all connections are open at the same time. Returns the number of packets processed
+size_t run_tcp_reassembly(uint32_t numOfFlows)
+{
+	uint8_t payload[64] = {};
+	Packet templatePacket(128);
+	EthLayer ethLayer(MacAddress("00:11:22:33:44:55"), MacAddress("66:77:88:99:aa:bb"));
+	IPv4Layer ipLayer(IPv4Address("10.0.0.1"), IPv4Address("192.168.1.1"));
+	TcpLayer tcpLayer(1024, 80);
+	PayloadLayer payloadLayer(payload, sizeof(payload), false);
+	templatePacket.addLayer(&ethLayer);
+	templatePacket.addLayer(&ipLayer);
+	templatePacket.addLayer(&tcpLayer);
+	templatePacket.addLayer(&payloadLayer);
+	templatePacket.computeCalculateFields();
+
+	std::vector<uint8_t> buffer(templatePacket.getRawPacket()->getRawData(), templatePacket.getRawPacket()->getRawData() + templatePacket.getRawPacket()->getRawDataLen());
+	iphdr* ipHeader = reinterpret_cast<iphdr*>(&buffer[ethLayer.getHeaderLen()]);
+	tcphdr* tcpHeader = reinterpret_cast<tcphdr*>(&buffer[ethLayer.getHeaderLen() + ipLayer.getHeaderLen()]);
+	const uint32_t serverIP = ipHeader->ipDst;
+
+	size_t numOfBytes = 0;
+	size_t numOfPackets = 0;
+	TcpReassembly tcpReassembly(handle_tcp_message, &numOfBytes);
+	RawPacket rawPacket;
+	timespec timestamp = { 0, 0 };
+
+	for (int phase = 0; phase < 4; phase++)
+	{
+		// phase 0: client request, phase 1: server response, phase 2: client FIN, phase 3: server FIN
+		bool fromClient = (phase % 2 == 0);
+		tcpHeader->finFlag = (phase >= 2 ? 1 : 0);
+		tcpHeader->sequenceNumber = hostToNet32((fromClient ? 1000 : 5000) + (phase >= 2 ? sizeof(payload) : 0));
+
+		for (uint32_t flow = 0; flow < numOfFlows; flow++)
+		{
+			uint32_t clientIP = hostToNet32(0x0a000000 | (flow & 0xffffff));
+			uint16_t clientPort = hostToNet16(1024 + flow % 60000);
+			ipHeader->ipSrc = (fromClient ? clientIP : serverIP);
+			ipHeader->ipDst = (fromClient ? serverIP : clientIP);
+			tcpHeader->portSrc = (fromClient ? clientPort : hostToNet16(80));
+			tcpHeader->portDst = (fromClient ? hostToNet16(80) : clientPort);
+
+			timestamp.tv_nsec += 100;
+			if (timestamp.tv_nsec >= 1000000000)
+			{
+				timestamp.tv_sec++;
+				timestamp.tv_nsec = 0;
+			}
+
+			rawPacket.setRawData(buffer.data(), static_cast<int>(buffer.size()), timestamp, LINKTYPE_ETHERNET, -1, false);
+			tcpReassembly.reassemblePacket(&rawPacket);
+			numOfPackets++;
+		}
+	}
+
+	return numOfPackets;
+}
+
+// the max size of the lists in the lru-list and lru-hashed modes
+const uint32_t LRUNumOfEntries = 1000000;
+
+// fill an LRU list with numOfEntries elements, then put the same number of new elements (each one evicts the least recently used element),
+// touch every remaining element again and finally erase all of them. Returns the number of put and erase operations
+template<typename List>
+size_t run_lru(uint32_t numOfEntries)
+{
+	List lruList(numOfEntries);
+	size_t numOfOperations = 0;
+	uint32_t deletedValue = 0;
+
+	// multiplying by an odd number is a bijection, so all elements are distinct but not in sequential order
+	for (uint32_t i = 0; i < 2 * numOfEntries; i++, numOfOperations++)
+		lruList.put(i * 2654435761u, &deletedValue);
+
+	for (uint32_t i = numOfEntries; i < 2 * numOfEntries; i++, numOfOperations++)
+		lruList.put(i * 2654435761u, &deletedValue);
+
+	for (uint32_t i = numOfEntries; i < 2 * numOfEntries; i++, numOfOperations++)
+		lruList.eraseElement(i * 2654435761u);
+
+	return numOfOperations;
+}
+
+// the buffer sizes the checksum mode runs with, and the number of bytes summed for each size
+const size_t ChecksumBufferSizes[] = { 64, 256, 576, 1500, 9000, 65535 };
+const size_t ChecksumNumOfSizes = sizeof(ChecksumBufferSizes) / sizeof(ChecksumBufferSizes[0]);
+const size_t ChecksumBytesPerSize = 256 * 1024 * 1024;
+
+// the total time spent on each buffer size in the checksum mode, over all repetitions
+std::chrono::high_resolution_clock::duration checksum_durations[ChecksumNumOfSizes];
+
+// compute the Internet checksum of buffers of different sizes. Returns the number of checksums computed
+size_t run_checksum()
+{
+	std::vector<uint8_t> buffer(ChecksumBufferSizes[ChecksumNumOfSizes - 1]);
+	for (size_t i = 0; i < buffer.size(); i++)
+		buffer[i] = static_cast<uint8_t>(i * 7);
+
+	size_t numOfChecksums = 0;
+	uint16_t result = 0;
+	for (size_t i = 0; i < ChecksumNumOfSizes; i++)
+	{
+		ScalarBuffer<uint16_t> vec;
+		vec.buffer = reinterpret_cast<uint16_t*>(buffer.data());
+		vec.len = ChecksumBufferSizes[i];
+		size_t iterations = ChecksumBytesPerSize / vec.len;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (size_t j = 0; j < iterations; j++)
+		{
+			// change the data a little so the compiler can't hoist the computation out of the loop
+			buffer[0] = static_cast<uint8_t>(j);
+			result ^= computeChecksum(&vec, 1);
+		}
+		checksum_durations[i] += std::chrono::high_resolution_clock::now() - start;
+		numOfChecksums += iterations;
+	}
+
+	// make sure the result is used
+	if (result == 0x1234)
+		std::cout << "";
+
+	return numOfChecksums;
+}
+
+// rewrite the source address and port of each IPv4 TCP/UDP packet (as NAT does) and keep the checksums valid, either by updating them
+// incrementally through the layer setters or by recomputing them. Returns true if the packet was rewritten
+bool handle_nat(Packet& packet, bool incremental)
+{
+	IPv4Layer* ipLayer = packet.getLayerOfType<IPv4Layer>();
+	if (ipLayer == nullptr)
+		return false;
+
+	Layer* transportLayer = ipLayer->getNextLayer();
+	if (transportLayer == nullptr || (transportLayer->getProtocol() != TCP && transportLayer->getProtocol() != UDP))
+		return false;
+
+	IPv4Address natAddress(0x0100000a);
+	uint16_t natPort = 40000;
+	if (incremental)
+	{
+		ipLayer->setSrcIPv4Address(natAddress);
+		if (transportLayer->getProtocol() == TCP)
+			static_cast<TcpLayer*>(transportLayer)->setSrcPort(natPort);
+		else
+			static_cast<UdpLayer*>(transportLayer)->setSrcPort(natPort);
+	}
+	else
+	{
+		ipLayer->getIPv4Header()->ipSrc = natAddress.toInt();
+		if (transportLayer->getProtocol() == TCP)
+			static_cast<TcpLayer*>(transportLayer)->getTcpHeader()->portSrc = hostToNet16(natPort);
+		else
+			static_cast<UdpLayer*>(transportLayer)->getUdpHeader()->portSrc = hostToNet16(natPort);
+		transportLayer->computeCalculateFields();
+		ipLayer->computeCalculateFields();
+	}
+
+	count++;
+	return true;
+}
+
 int main(int argc, char *argv[])
 {
 	if(argc != 4)
 	{
-		std::cout << "Usage: " << *argv << " <input-file> <dns|packet> <repetitions>\n";
+		std::cout << "Usage: " << *argv << " <input-file> <dns|dns-lazy|packet|layers|layers-cached|lookup|lookup-lazy|layer-lookup|layer-lookup-rtti|ssl-cipher-lookup|checksum|nat-incremental|nat-recompute|tcp-reassembly|lru-list|lru-hashed> <repetitions>\n";
 		return 1;
 	}
 	std::string input_type(argv[2]);
 	int total_runs = std::stoi(argv[3]);
 	size_t total_packets = 0;
+	size_t total_allocations = 0;
+	size_t total_lookup_packets = 0;
 	std::vector<std::chrono::high_resolution_clock::duration> durations;
 	for(int i = 0; i < total_runs; ++i)
 	{
 		count = 0;
 		PcapFileReaderDevice reader(argv[1]);
-		reader.open();
+		RawPacketVector parsed_raw_packets;
+		PointerVector<Packet> parsed_packets;
+		bool synthetic_input = (input_type == "tcp-reassembly" || input_type == "lru-list" || input_type == "lru-hashed" || input_type == "checksum");
+		if (!synthetic_input)
+			reader.open();
 		std::chrono::high_resolution_clock::time_point start;
 		if(input_type == "dns")
 		{
@@ -83,6 +403,116 @@ int main(int argc, char *argv[])
 				handle_dns(packet);
 			}
 		}
+		else if (input_type == "dns-lazy")
+		{
+			RawPacket rawPacket;
+			size_t allocationsBefore = allocations.load();
+			start = std::chrono::high_resolution_clock::now();
+			while (reader.getNextPacket(rawPacket))
+			{
+				Packet packet(&rawPacket);
+				handle_dns_lazy(packet);
+				total_lookup_packets++;
+			}
+			total_allocations += allocations.load() - allocationsBefore;
+		}
+		else if (input_type == "layers" || input_type == "layers-cached")
+		{
+			// parse all layers of each packet, optionally with the layer thread cache enabled
+			if (input_type == "layers-cached")
+				LayerAllocator::enableThreadCache();
+			RawPacket rawPacket;
+			Packet packet;
+			size_t allocationsBefore = allocations.load();
+			start = std::chrono::high_resolution_clock::now();
+			while (reader.getNextPacket(rawPacket))
+			{
+				packet.setRawPacket(&rawPacket, false);
+				handle_packet(packet);
+			}
+			total_allocations += allocations.load() - allocationsBefore;
+			LayerAllocator::disableThreadCache();
+		}
+		else if (input_type == "lookup" || input_type == "lookup-lazy")
+		{
+			// classify each packet and fetch its TCP layer, with all layers parsed up front or only the ones that are reached
+			PacketParsingMode parsingMode = (input_type == "lookup-lazy" ? LazyParsing : EagerParsing);
+			RawPacket rawPacket;
+			Packet packet;
+			size_t allocationsBefore = allocations.load();
+			start = std::chrono::high_resolution_clock::now();
+			while (reader.getNextPacket(rawPacket))
+			{
+				packet.setRawPacket(&rawPacket, false, parsingMode);
+				handle_lookup(packet);
+				total_lookup_packets++;
+			}
+			total_allocations += allocations.load() - allocationsBefore;
+		}
+		else if (input_type == "checksum")
+		{
+			// synthetic buffers, the input file isn't used
+			start = std::chrono::high_resolution_clock::now();
+			count = run_checksum();
+		}
+		else if (input_type == "nat-incremental" || input_type == "nat-recompute")
+		{
+			// the packets are read and parsed first so only the rewrite is measured. They're freed after the run is timed
+			reader.getNextPackets(parsed_raw_packets);
+			for (RawPacketVector::VectorIterator iter = parsed_raw_packets.begin(); iter != parsed_raw_packets.end(); ++iter)
+				parsed_packets.pushBack(new Packet(*iter, OsiModelTransportLayer));
+
+			bool incremental = (input_type == "nat-incremental");
+			start = std::chrono::high_resolution_clock::now();
+			for (PointerVector<Packet>::VectorIterator iter = parsed_packets.begin(); iter != parsed_packets.end(); ++iter)
+				handle_nat(**iter, incremental);
+		}
+		else if (input_type == "layer-lookup" || input_type == "layer-lookup-rtti")
+		{
+			// the packets are read and parsed first so only the lookups are measured
+			reader.getNextPackets(parsed_raw_packets);
+			for (RawPacketVector::VectorIterator iter = parsed_raw_packets.begin(); iter != parsed_raw_packets.end(); ++iter)
+				parsed_packets.pushBack(new Packet(*iter));
+
+			start = std::chrono::high_resolution_clock::now();
+			for (PointerVector<Packet>::VectorIterator iter = parsed_packets.begin(); iter != parsed_packets.end(); ++iter)
+			{
+				if (input_type == "layer-lookup")
+					handle_layer_lookup<false>(**iter);
+				else
+					handle_layer_lookup<true>(**iter);
+			}
+		}
+		else if (input_type == "ssl-cipher-lookup")
+		{
+			// the packets are read and parsed first so only the cipher-suite lookups are measured
+			reader.getNextPackets(parsed_raw_packets);
+			for (RawPacketVector::VectorIterator iter = parsed_raw_packets.begin(); iter != parsed_raw_packets.end(); ++iter)
+				parsed_packets.pushBack(new Packet(*iter));
+
+			start = std::chrono::high_resolution_clock::now();
+			for (PointerVector<Packet>::VectorIterator iter = parsed_packets.begin(); iter != parsed_packets.end(); ++iter)
+				handle_ssl_cipher_lookup(**iter);
+		}
+		else if (input_type == "tcp-reassembly")
+		{
+			// synthetic traffic, the input file isn't used. Some of the synthetic flows share a flow key, don't flood the output with errors about them
+			Logger::getInstance().suppressLogs();
+			start = std::chrono::high_resolution_clock::now();
+			count = run_tcp_reassembly(TcpReassemblyNumOfFlows);
+			Logger::getInstance().enableLogs();
+		}
+		else if (input_type == "lru-list" || input_type == "lru-hashed")
+		{
+			// synthetic put/erase workload, the input file isn't used
+			size_t allocationsBefore = allocations.load();
+			start = std::chrono::high_resolution_clock::now();
+			if (input_type == "lru-list")
+				count = run_lru<LRUList<uint32_t> >(LRUNumOfEntries);
+			else
+				count = run_lru<HashedLRUList<uint32_t> >(LRUNumOfEntries);
+			total_allocations += allocations.load() - allocationsBefore;
+		}
 		else
 		{
 			start = std::chrono::high_resolution_clock::now();
@@ -107,5 +537,22 @@ int main(int argc, char *argv[])
 	using std::chrono::duration_cast;
 	using std::chrono::milliseconds;
 	auto total_time_in_ms = duration_cast<milliseconds>(total_time).count();
-	std::cout << (total_packets / total_runs) << " " << (total_time_in_ms / durations.size()) << std::endl;
+	std::cout << (total_packets / total_runs) << " " << (total_time_in_ms / durations.size());
+	if (input_type == "layers" || input_type == "layers-cached" || input_type == "lru-list" || input_type == "lru-hashed")
+		std::cout << " " << (total_packets > 0 ? (double)total_allocations / total_packets : 0);
+	else if (input_type == "lookup" || input_type == "lookup-lazy" || input_type == "dns-lazy")
+		std::cout << " " << (total_lookup_packets > 0 ? (double)total_allocations / total_lookup_packets : 0);
+	std::cout << std::endl;
+
+	if (input_type == "checksum")
+	{
+		// a line per buffer size: the size in bytes, the average time per checksum in nanoseconds and the throughput in GB/s
+		for (size_t i = 0; i < ChecksumNumOfSizes; i++)
+		{
+			double totalNanoseconds = std::chrono::duration<double, std::nano>(checksum_durations[i]).count();
+			double numOfChecksums = (double)(ChecksumBytesPerSize / ChecksumBufferSizes[i]) * total_runs;
+			std::cout << ChecksumBufferSizes[i] << " " << totalNanoseconds / numOfChecksums << " "
+				<< (double)ChecksumBytesPerSize * total_runs / totalNanoseconds << std::endl;
+		}
+	}
 }
@@ -19,6 +19,13 @@
  * There are switches that allows the user to search only in the provided folder (without sub-directories), search user-defined file extensions (sometimes
  * pcap files have an extension which is not '.pcap'), and output or not output the detailed report
  *
+ * Files can be searched by several threads. Each thread has its own queue of directories and files to search and threads that run out of work steal
+ * work from the queues of other threads, so a large directory tree is spread over all threads. The results are printed in the same order as when
+ * searching on a single thread, each one as soon as the results of all files before it are ready, so only the results that are waiting for an earlier
+ * file are kept in memory. The application can also keep a search index: a file that records how many packets matched each search criteria in
+ * each file. When the same search is repeated, files that didn't match aren't opened at all and files that did match are only read if a detailed
+ * report is requested. Files that changed since they were indexed are searched again
+ *
  * For more details about modes of operation and parameters please run PcapSearch -h
  */
 
@@ -30,7 +37,13 @@
 #include <dirent.h>
 #include <utility>
 #include <vector>
+#include <deque>
 #include <map>
+#include <set>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <Logger.h>
 #include <PcapPlusPlusVersion.h>
 #include <SystemUtils.h>
@@ -47,6 +60,8 @@ static struct option PcapSearchOptions[] =
 	{"search", required_argument, nullptr, 's'},
 	{"detailed-report", required_argument, nullptr, 'r'},
 	{"set-extensions", required_argument, nullptr, 'e'},
+	{"threads", required_argument, nullptr, 't'},
+	{"index-file", required_argument, nullptr, 'x'},
 	{"version", no_argument, nullptr, 'v'},
 	{"help", no_argument, nullptr, 'h'},
 	{nullptr, 0, nullptr, 0}
@@ -75,7 +90,7 @@ void printUsage()
 	std::cout << std::endl
 		<< "Usage:" << std::endl
 		<< "------" << std::endl
-		<< pcpp::AppName::get() << " [-h] [-v] [-n] [-r file_name] [-e extension_list] -d directory -s search_criteria" << std::endl
+		<< pcpp::AppName::get() << " [-h] [-v] [-n] [-r file_name] [-e extension_list] [-t num_threads] [-x index_file] -d directory -s search_criteria" << std::endl
 		<< std::endl
 		<< "Options:" << std::endl
 		<< std::endl
@@ -86,6 +101,9 @@ void printUsage()
 		<< "    -r file_name        : Write a detailed search report to a file" << std::endl
 		<< "    -e extension_list   : Set file extensions to search. The default is searching '.pcap' and '.pcapng' files." << std::endl
 		<< "                          extension_list should be a comma-separated list of extensions, for example: pcap,net,dmp" << std::endl
+		<< "    -t num_threads      : The number of threads that search files. The default is 1" << std::endl
+		<< "    -x index_file       : Use a search index file. Files that didn't match a previous search with the same criteria" << std::endl
+		<< "                          and haven't changed since are skipped. The index file is created if it doesn't exist" << std::endl
 		<< "    -v                  : Displays the current version and exists" << std::endl
 		<< "    -h                  : Displays this help message and exits" << std::endl
 		<< std::endl;
@@ -115,10 +133,16 @@ std::string getExtension(const std::string& fileName)
 
 
 /**
- * Searches all packet in a given pcap file for a certain search criteria. Returns how many packets matched the search criteria
+ * Searches all packet in a given pcap file for a certain search criteria. Returns false if the file couldn't be searched, otherwise returns true and
+ * how many packets matched the search criteria
  */
-int searchPcap(const std::string& pcapFilePath, std::string searchCriteria, std::ofstream* detailedReportFile)
+bool searchPcap(const std::string& pcapFilePath, const std::string& searchCriteria, std::ostream* detailedReportFile, int& packetCount)
 {
+	// pcap_compile() isn't thread-safe in older libpcap versions, so filters are set one at a time
+	static std::mutex setFilterMutex;
+
+	packetCount = 0;
+
 	// create the pcap/pcap-ng reader
 	pcpp::IFileReaderDevice* reader = pcpp::IFileReaderDevice::getReader(pcapFilePath);
 
@@ -135,15 +159,21 @@ int searchPcap(const std::string& pcapFilePath, std::string searchCriteria, std:
 
 		// free the reader memory and return
 		delete reader;
-		return 0;
+		return false;
 	}
 
 	// set the filter for the file so only packets that match the search criteria will be read
-	if (!reader->setFilter(std::move(searchCriteria)))
+	bool filterSet;
+	{
+		std::lock_guard<std::mutex> lock(setFilterMutex);
+		filterSet = reader->setFilter(searchCriteria);
+	}
+
+	if (!filterSet)
 	{
 		// free the reader memory and return
 		delete reader;
-		return 0;
+		return false;
 	}
 
 	if (detailedReportFile != nullptr)
@@ -151,7 +181,6 @@ int searchPcap(const std::string& pcapFilePath, std::string searchCriteria, std:
 		(*detailedReportFile) << "File '" << pcapFilePath << "':" << std::endl;
 	}
 
-	int packetCount = 0;
 	pcpp::RawPacket rawPacket;
 
 	// read packets from the file. Since we already set the filter, only packets that matches the filter will be read
@@ -191,98 +220,480 @@ int searchPcap(const std::string& pcapFilePath, std::string searchCriteria, std:
 	// free the reader memory
 	delete reader;
 
-	// return how many packets matched the search criteria
-	return packetCount;
+	return true;
 }
 
 
 /**
- * Searches all pcap files in given directory (and sub-directories if directed by the user) and output how many packets in each file matches a given
- * search criteria. This method outputs how many directories were searched, how many files were searched and how many packets were matched
+ * A search index: a text file that records how many packets matched each search criteria in each file. A record is used only if the size and
+ * modification time of the file didn't change since it was written. Each line of the file is a record made of these tab-separated fields:
+ * modification time, file size, number of matched packets, search criteria, file path
  */
-void searchDirectories(const std::string &directory, bool includeSubDirectories, const std::string &searchCriteria, std::ofstream* detailedReportFile,
-		std::map<std::string, bool> extensionsToSearch,
-		int& totalDirSearched, int& totalFilesSearched, int& totalPacketsFound)
+class SearchIndex
 {
-	// open the directory
-	DIR *dir = opendir(directory.c_str());
+public:
+	struct Record
+	{
+		int64_t modificationTime;
+		int64_t fileSize;
+		int packetCount;
+	};
+
+	/**
+	 * Read the index file. A missing file is treated as an empty index
+	 */
+	void load(const std::string& indexFileName)
+	{
+		std::ifstream indexFile(indexFileName.c_str());
+		std::string line;
+		while (std::getline(indexFile, line))
+		{
+			std::stringstream lineStream(line);
+			Record record;
+			std::string searchCriteria, filePath;
+			lineStream >> record.modificationTime >> record.fileSize >> record.packetCount;
+			if (lineStream.fail() || lineStream.get() != '\t' || !std::getline(lineStream, searchCriteria, '\t') || !std::getline(lineStream, filePath))
+				continue;
+
+			m_Records[std::make_pair(filePath, searchCriteria)] = record;
+		}
+	}
 
-	// dir is null usually when user has no access permissions
-	if (dir == nullptr)
-		return;
+	/**
+	 * Write the index file
+	 */
+	bool save(const std::string& indexFileName) const
+	{
+		std::ofstream indexFile(indexFileName.c_str());
+		for (std::map<std::pair<std::string, std::string>, Record>::const_iterator iter = m_Records.begin(); iter != m_Records.end(); iter++)
+		{
+			indexFile
+				<< iter->second.modificationTime << '\t' << iter->second.fileSize << '\t' << iter->second.packetCount << '\t'
+				<< iter->first.second << '\t' << iter->first.first << '\n';
+		}
+
+		indexFile.close();
+		return !indexFile.fail();
+	}
+
+	/**
+	 * Look up the number of packets that matched a search criteria in a file. Returns false if there is no up-to-date record
+	 */
+	bool lookup(const std::string& filePath, const std::string& searchCriteria, int64_t modificationTime, int64_t fileSize, int& packetCount) const
+	{
+		std::map<std::pair<std::string, std::string>, Record>::const_iterator iter = m_Records.find(std::make_pair(filePath, searchCriteria));
+		if (iter == m_Records.end() || iter->second.modificationTime != modificationTime || iter->second.fileSize != fileSize)
+			return false;
+
+		packetCount = iter->second.packetCount;
+		return true;
+	}
+
+	void update(const std::string& filePath, const std::string& searchCriteria, int64_t modificationTime, int64_t fileSize, int packetCount)
+	{
+		Record record;
+		record.modificationTime = modificationTime;
+		record.fileSize = fileSize;
+		record.packetCount = packetCount;
+		m_Records[std::make_pair(filePath, searchCriteria)] = record;
+	}
+
+	/**
+	 * Search criteria that contain tabs or line breaks can't be stored in the index
+	 */
+	static bool canIndex(const std::string& searchCriteria)
+	{
+		return searchCriteria.find_first_of("\t\r\n") == std::string::npos;
+	}
+
+private:
+	// a map of (file path, search criteria) to record
+	std::map<std::pair<std::string, std::string>, Record> m_Records;
+};
+
+
+/**
+ * A directory or a file waiting to be searched
+ */
+struct SearchWorkItem
+{
+	std::string path;
+	bool isDirectory;
+	// the position of the item in the order a single thread searches the tree: a directory searches its sub-directories in the order they're
+	// read and then its own files, so the key of a child is the key of its directory followed by the child's index, where the indices of files
+	// come after the indices of all sub-directories. Sorting results by this key gives the single-threaded order
+	std::vector<uint32_t> orderKey;
+	int64_t modificationTime;
+	int64_t fileSize;
+};
+
+
+/**
+ * The result of searching one file
+ */
+struct FileSearchResult
+{
+	std::vector<uint32_t> orderKey;
+	std::string path;
+	int packetsFound;
+	std::string detailedReport;
+	bool searched;
+	bool skippedByIndex;
+	int64_t modificationTime;
+	int64_t fileSize;
+};
 
-	struct dirent *entry = readdir(dir);
 
-	std::vector<std::string> pcapList;
+/**
+ * A callback invoked for the result of each file searched, in the order a single thread would have found them
+ */
+typedef void (*OnFileSearchedCallback)(const FileSearchResult& result, void* cookie);
+
 
-	// go over all files in this directory
-	while (entry != nullptr)
+/**
+ * Searches a directory tree using a number of threads. Each thread owns a queue of work items. A thread takes items from the back of its own queue,
+ * so it goes deep into the tree it's working on, and when it has no work it steals an item from the front of another thread's queue, which is usually
+ * a directory high in the tree and therefore a large piece of work
+ */
+class DirectorySearcher
+{
+public:
+	DirectorySearcher(int numOfThreads, bool includeSubDirectories, const std::string& searchCriteria, bool detailedReport,
+		const std::map<std::string, bool>& extensionsToSearch, const SearchIndex* searchIndex) :
+		m_Queues(numOfThreads), m_IncludeSubDirectories(includeSubDirectories), m_SearchCriteria(searchCriteria),
+		m_DetailedReport(detailedReport), m_ExtensionsToSearch(extensionsToSearch), m_SearchIndex(searchIndex),
+		m_NumOfPendingItems(0), m_NumOfQueuedItems(0), m_OnFileSearched(nullptr), m_OnFileSearchedCookie(nullptr), m_TotalDirSearched(0)
 	{
-		std::string name(entry->d_name);
+	}
+
+	/**
+	 * Search a directory tree. The callback is invoked for each file in the order a single thread would have found them, as soon as the results
+	 * of all files before it are ready. Returns the number of directories searched
+	 */
+	int search(const std::string& directory, OnFileSearchedCallback onFileSearched, void* onFileSearchedCookie)
+	{
+		m_OnFileSearched = onFileSearched;
+		m_OnFileSearchedCookie = onFileSearchedCookie;
 
-		// construct directory full path
-		std::string dirPath = directory;
-		std::string dirSep = DIR_SEPARATOR;
-		if (0 != directory.compare(directory.length() - dirSep.length(), dirSep.length(), dirSep)) // directory doesn't contain separator in the end
-			dirPath += DIR_SEPARATOR;
-		dirPath += name;
+		SearchWorkItem rootItem;
+		rootItem.path = directory;
+		rootItem.isDirectory = true;
+		pushItem(0, rootItem);
 
-		struct stat info;
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < m_Queues.size(); i++)
+			threads.push_back(std::thread(&DirectorySearcher::workerThreadMain, this, i));
 
-		// get file attributes
-		if (stat(dirPath.c_str(), &info) != 0)
+		for (std::vector<std::thread>::iterator iter = threads.begin(); iter != threads.end(); iter++)
+			iter->join();
+
+		return m_TotalDirSearched;
+	}
+
+private:
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<SearchWorkItem> items;
+	};
+
+	std::vector<WorkQueue> m_Queues;
+	bool m_IncludeSubDirectories;
+	std::string m_SearchCriteria;
+	bool m_DetailedReport;
+	std::map<std::string, bool> m_ExtensionsToSearch;
+	const SearchIndex* m_SearchIndex;
+
+	// the number of items queued or being processed. The search ends when it drops to 0
+	std::atomic<int> m_NumOfPendingItems;
+	// the number of items queued and not taken by a thread yet. Idle threads wait until it's positive or the search ends. Both counters
+	// are changed with m_IdleMutex held so an idle thread can't miss a notification between checking them and starting to wait
+	std::atomic<int> m_NumOfQueuedItems;
+	std::mutex m_IdleMutex;
+	std::condition_variable m_IdleCondition;
+
+	// results are reported in order: a result is reported once no item before it is still pending, since only pending items can add results
+	// before it. Results of files that are done are kept until then
+	std::mutex m_ResultsMutex;
+	std::set<std::vector<uint32_t> > m_PendingOrderKeys;
+	std::map<std::vector<uint32_t>, FileSearchResult> m_WaitingResults;
+	OnFileSearchedCallback m_OnFileSearched;
+	void* m_OnFileSearchedCookie;
+	std::atomic<int> m_TotalDirSearched;
+
+	void pushItem(size_t queueIndex, const SearchWorkItem& item)
+	{
 		{
-			entry = readdir(dir);
-			continue;
+			std::lock_guard<std::mutex> lock(m_ResultsMutex);
+			m_PendingOrderKeys.insert(item.orderKey);
 		}
 
-		// if the file is not a directory
-		if (!(info.st_mode & S_IFDIR))
 		{
-			// check if the file extension matches the requested extensions to search. If it does, put the file name in a list of files
-			// that should be searched (don't do the search just yet)
-			if (extensionsToSearch.find(getExtension(name)) != extensionsToSearch.end())
-				pcapList.push_back(dirPath);
-			entry = readdir(dir);
-			continue;
+			std::lock_guard<std::mutex> lock(m_Queues[queueIndex].mutex);
+			m_Queues[queueIndex].items.push_back(item);
 		}
 
-		// if the file is a '.' or '..' skip it
-		if (name == "." || name == "..")
 		{
-			entry = readdir(dir);
-			continue;
+			std::lock_guard<std::mutex> lock(m_IdleMutex);
+			m_NumOfPendingItems++;
+			m_NumOfQueuedItems++;
 		}
+		m_IdleCondition.notify_one();
+	}
 
-		// if we got to here it means the file is actually a directory. If required to search sub-directories, call this method recursively to search
-		// inside this sub-directory
-		if (includeSubDirectories)
-			searchDirectories(dirPath, true, searchCriteria, detailedReportFile, extensionsToSearch, totalDirSearched, totalFilesSearched, totalPacketsFound);
+	/**
+	 * Mark an item as done, store the result of searching it if it's a file, and report all results no pending item comes before
+	 */
+	void completeItem(const SearchWorkItem& item, FileSearchResult* result)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_ResultsMutex);
+			m_PendingOrderKeys.erase(item.orderKey);
+			if (result != nullptr)
+				m_WaitingResults[item.orderKey] = std::move(*result);
 
-		// move to the next file
-		entry = readdir(dir);
+			while (!m_WaitingResults.empty() && (m_PendingOrderKeys.empty() || m_WaitingResults.begin()->first < *m_PendingOrderKeys.begin()))
+			{
+				m_OnFileSearched(m_WaitingResults.begin()->second, m_OnFileSearchedCookie);
+				m_WaitingResults.erase(m_WaitingResults.begin());
+			}
+		}
+
+		bool searchDone;
+		{
+			std::lock_guard<std::mutex> lock(m_IdleMutex);
+			searchDone = (--m_NumOfPendingItems == 0);
+		}
+
+		if (searchDone)
+			m_IdleCondition.notify_all();
 	}
 
-	// close dir
-	closedir(dir);
+	bool popItem(size_t queueIndex, SearchWorkItem& item)
+	{
+		// take the newest item from the thread's own queue
+		{
+			std::lock_guard<std::mutex> lock(m_Queues[queueIndex].mutex);
+			if (!m_Queues[queueIndex].items.empty())
+			{
+				item = std::move(m_Queues[queueIndex].items.back());
+				m_Queues[queueIndex].items.pop_back();
+				m_NumOfQueuedItems--;
+				return true;
+			}
+		}
+
+		// steal the oldest item of another thread
+		for (size_t i = 1; i < m_Queues.size(); i++)
+		{
+			WorkQueue& victim = m_Queues[(queueIndex + i) % m_Queues.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.items.empty())
+			{
+				item = std::move(victim.items.front());
+				victim.items.pop_front();
+				m_NumOfQueuedItems--;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void workerThreadMain(size_t queueIndex)
+	{
+		SearchWorkItem item;
+		while (true)
+		{
+			if (!popItem(queueIndex, item))
+			{
+				// other threads are still working and may queue more items
+				std::unique_lock<std::mutex> lock(m_IdleMutex);
+				m_IdleCondition.wait(lock, [this] { return m_NumOfPendingItems == 0 || m_NumOfQueuedItems > 0; });
+				if (m_NumOfPendingItems == 0)
+					break;
+
+				continue;
+			}
+
+			if (item.isDirectory)
+			{
+				searchDirectory(queueIndex, item);
+				completeItem(item, nullptr);
+			}
+			else
+			{
+				FileSearchResult result;
+				searchFile(item, result);
+				completeItem(item, &result);
+			}
+		}
+	}
+
+	void searchDirectory(size_t queueIndex, const SearchWorkItem& dirItem)
+	{
+		// open the directory
+		DIR *dir = opendir(dirItem.path.c_str());
+
+		// dir is null usually when user has no access permissions
+		if (dir == nullptr)
+			return;
+
+		struct dirent *entry = readdir(dir);
+
+		std::vector<SearchWorkItem> subDirList;
+		std::vector<SearchWorkItem> pcapList;
+
+		// go over all files in this directory
+		while (entry != nullptr)
+		{
+			std::string name(entry->d_name);
+
+			// construct directory full path
+			std::string dirPath = dirItem.path;
+			std::string dirSep = DIR_SEPARATOR;
+			if (0 != dirItem.path.compare(dirItem.path.length() - dirSep.length(), dirSep.length(), dirSep)) // directory doesn't contain separator in the end
+				dirPath += DIR_SEPARATOR;
+			dirPath += name;
+
+			struct stat info;
 
-	totalDirSearched++;
+			// get file attributes
+			if (stat(dirPath.c_str(), &info) != 0)
+			{
+				entry = readdir(dir);
+				continue;
+			}
+
+			SearchWorkItem item;
+			item.path = dirPath;
+			item.modificationTime = info.st_mtime;
+			item.fileSize = info.st_size;
+
+			// if the file is not a directory
+			if (!(info.st_mode & S_IFDIR))
+			{
+				// check if the file extension matches the requested extensions to search. If it does, put the file name in a list of files
+				// that should be searched
+				if (m_ExtensionsToSearch.find(getExtension(name)) != m_ExtensionsToSearch.end())
+				{
+					item.isDirectory = false;
+					pcapList.push_back(item);
+				}
+			}
+			// if the file is a directory other than '.' or '..' and required to search sub-directories, search inside this sub-directory
+			else if (name != "." && name != ".." && m_IncludeSubDirectories)
+			{
+				item.isDirectory = true;
+				subDirList.push_back(item);
+			}
+
+			// move to the next file
+			entry = readdir(dir);
+		}
+
+		// close dir
+		closedir(dir);
+
+		m_TotalDirSearched++;
+
+		// queue the files first so the sub-directories, which are usually more work, are at the back of the queue where this thread takes
+		// its next items from, and files are at the front where other threads steal from
+		uint32_t filesKeyBase = static_cast<uint32_t>(subDirList.size());
+		for (size_t i = 0; i < pcapList.size(); i++)
+		{
+			pcapList[i].orderKey = dirItem.orderKey;
+			pcapList[i].orderKey.push_back(filesKeyBase + static_cast<uint32_t>(i));
+			pushItem(queueIndex, pcapList[i]);
+		}
+
+		for (size_t i = subDirList.size(); i > 0; i--)
+		{
+			subDirList[i - 1].orderKey = dirItem.orderKey;
+			subDirList[i - 1].orderKey.push_back(static_cast<uint32_t>(i - 1));
+			pushItem(queueIndex, subDirList[i - 1]);
+		}
+	}
 
-	// when we get to here we already covered all sub-directories and collected all the files in this directory that are required for search
-	// go over each such file and search its packets to find the search criteria
-	for (std::vector<std::string>::iterator iter = pcapList.begin(); iter != pcapList.end(); iter++)
+	void searchFile(const SearchWorkItem& fileItem, FileSearchResult& result)
 	{
-		// do the actual search
-		int packetsFound = searchPcap(*iter, searchCriteria, detailedReportFile);
+		result.orderKey = fileItem.orderKey;
+		result.path = fileItem.path;
+		result.packetsFound = 0;
+		result.searched = false;
+		result.skippedByIndex = false;
+		result.modificationTime = fileItem.modificationTime;
+		result.fileSize = fileItem.fileSize;
+
+		// the callback updates the search index while results are reported, so it's looked up with the results lock held
+		int indexedPacketCount;
+		bool isIndexed = false;
+		if (m_SearchIndex != nullptr)
+		{
+			std::lock_guard<std::mutex> lock(m_ResultsMutex);
+			isIndexed = m_SearchIndex->lookup(fileItem.path, m_SearchCriteria, fileItem.modificationTime, fileItem.fileSize, indexedPacketCount);
+		}
 
-		// add to total matched packets
-		totalFilesSearched++;
-		if (packetsFound > 0)
+		if (isIndexed && (indexedPacketCount == 0 || !m_DetailedReport))
+		{
+			// the file didn't change since the same search was done, no need to read it unless the matched packets should be printed
+			result.packetsFound = indexedPacketCount;
+			result.searched = true;
+			result.skippedByIndex = true;
+			if (m_DetailedReport)
+				result.detailedReport = "File '" + fileItem.path + "':\n    ----> Found 0 packets\n\n";
+		}
+		else if (m_DetailedReport)
 		{
-			std::cout << packetsFound << " packets found in '" << *iter << "'" << std::endl;
-			totalPacketsFound += packetsFound;
+			std::ostringstream detailedReport;
+			result.searched = searchPcap(fileItem.path, m_SearchCriteria, &detailedReport, result.packetsFound);
+			result.detailedReport = detailedReport.str();
+		}
+		else
+		{
+			result.searched = searchPcap(fileItem.path, m_SearchCriteria, nullptr, result.packetsFound);
 		}
 	}
+};
+
+
+/**
+ * The totals of a search and where its results are written to
+ */
+struct SearchReport
+{
+	std::ofstream* detailedReportFile;
+	SearchIndex* searchIndex;
+	std::string searchCriteria;
+	int totalFilesSearched;
+	int totalFilesSkippedByIndex;
+	int totalPacketsFound;
+};
+
+
+/**
+ * Output the result of searching a file: how many packets matched and the detailed report of the file if requested
+ */
+void onFileSearched(const FileSearchResult& result, void* cookie)
+{
+	SearchReport* report = static_cast<SearchReport*>(cookie);
+
+	if (report->detailedReportFile != nullptr)
+		(*report->detailedReportFile) << result.detailedReport;
+
+	// add to total matched packets
+	report->totalFilesSearched++;
+	if (result.packetsFound > 0)
+	{
+		std::cout << result.packetsFound << " packets found in '" << result.path << "'" << std::endl;
+		report->totalPacketsFound += result.packetsFound;
+	}
+
+	if (result.skippedByIndex)
+		report->totalFilesSkippedByIndex++;
+
+	if (result.searched)
+		report->searchIndex->update(result.path, report->searchCriteria, result.modificationTime, result.fileSize, result.packetsFound);
 }
 
 
@@ -304,6 +715,10 @@ int main(int argc, char* argv[])
 
 	std::map<std::string, bool> extensionsToSearch;
 
+	int numOfThreads = 1;
+
+	std::string indexFileName = "";
+
 	// the default (unless set otherwise) is to search in '.pcap' and '.pcapng' extensions
 	extensionsToSearch["pcap"] = true;
 	extensionsToSearch["pcapng"] = true;
@@ -311,7 +726,7 @@ int main(int argc, char* argv[])
 	int optionIndex = 0;
 	int opt = 0;
 
-	while((opt = getopt_long(argc, argv, "d:s:r:e:hvn", PcapSearchOptions, &optionIndex)) != -1)
+	while((opt = getopt_long(argc, argv, "d:s:r:e:t:x:hvn", PcapSearchOptions, &optionIndex)) != -1)
 	{
 		switch (opt)
 		{
@@ -351,6 +766,12 @@ int main(int argc, char* argv[])
 				}
 				break;
 			}
+			case 't':
+				numOfThreads = atoi(optarg);
+				break;
+			case 'x':
+				indexFileName = optarg;
+				break;
 			case 'h':
 				printUsage();
 				exit(0);
@@ -373,6 +794,16 @@ int main(int argc, char* argv[])
 		EXIT_WITH_ERROR("Search criteria was not given");
 	}
 
+	if (numOfThreads <= 0)
+	{
+		EXIT_WITH_ERROR("Number of threads must be a positive number");
+	}
+
+	if (indexFileName != "" && !SearchIndex::canIndex(searchCriteria))
+	{
+		EXIT_WITH_ERROR("Search criteria containing tabs or line breaks can't be used with a search index");
+	}
+
 	DIR *dir = opendir(inputDirectory.c_str());
 	if (dir == nullptr)
 	{
@@ -400,22 +831,42 @@ int main(int argc, char* argv[])
 	}
 
 
+	// load the search index if requested by the user
+	SearchIndex searchIndex;
+	if (indexFileName != "")
+		searchIndex.load(indexFileName);
+
 	std::cout << "Searching..." << std::endl;
-	int totalDirSearched = 0;
-	int totalFilesSearched = 0;
-	int totalPacketsFound = 0;
 
-	// the main call - start searching!
-	searchDirectories(inputDirectory, includeSubDirectories, searchCriteria, detailedReportFile, extensionsToSearch, totalDirSearched, totalFilesSearched, totalPacketsFound);
+	SearchReport report;
+	report.detailedReportFile = detailedReportFile;
+	report.searchIndex = &searchIndex;
+	report.searchCriteria = searchCriteria;
+	report.totalFilesSearched = 0;
+	report.totalFilesSkippedByIndex = 0;
+	report.totalPacketsFound = 0;
+
+	// the main call - start searching! The result of each file is output as soon as the files before it are done
+	DirectorySearcher searcher(numOfThreads, includeSubDirectories, searchCriteria, detailedReportFile != nullptr, extensionsToSearch,
+		(indexFileName != "" ? &searchIndex : nullptr));
+	int totalDirSearched = searcher.search(inputDirectory, onFileSearched, &report);
 
 	// after search is done, close the report file and delete its instance
 	std::cout << std::endl << std::endl
 		<< "Done! Searched "
-		<< totalFilesSearched << " files in "
+		<< report.totalFilesSearched << " files in "
 		<< totalDirSearched << " directories, "
-		<< totalPacketsFound << " packets were matched to search criteria"
+		<< report.totalPacketsFound << " packets were matched to search criteria"
 		<< std::endl;
 
+	if (indexFileName != "")
+	{
+		if (!searchIndex.save(indexFileName))
+			std::cout << "Couldn't write search index to '" << indexFileName << "'" << std::endl;
+		else
+			std::cout << report.totalFilesSkippedByIndex << " files weren't read thanks to the search index" << std::endl;
+	}
+
 	if (detailedReportFile != nullptr)
 	{
 		if (detailedReportFile->is_open())
@@ -11,6 +11,11 @@
  */
 class TwoTupleSplitter : public ValueBasedSplitter
 {
+private:
+
+	// a flow table that maps the 2-tuple hash of each flow to its file number
+	std::map<uint32_t, int> m_FlowTable;
+
 public:
 
 	/**
@@ -56,9 +61,17 @@ class FiveTupleSplitter : public ValueBasedSplitter
 {
 private:
 
-	// a flow table for saving TCP state per flow. Currently the only data that is saved is whether
-	// the last packet seen on the flow was a TCP SYN packet
-	std::map<uint32_t, bool> m_TcpFlowTable;
+	// the data saved per flow: the file number and, for TCP flows, whether the last packet seen on the flow was a TCP SYN packet
+	struct FlowData
+	{
+		int fileNumber;
+		bool lastPacketWasSyn;
+
+		FlowData() : fileNumber(0), lastPacketWasSyn(false) {}
+	};
+
+	// a flow table keyed by the full 5-tuple. All packets that don't have a 5-tuple share the empty key
+	pcpp::FlowTable<FlowData> m_FlowTable;
 
 	/**
 	 * A utility method that takes a packet and returns true if it's a TCP SYN packet
@@ -87,27 +100,30 @@ public:
 	 * A c'tor for this class that gets the maximum number of files. If this number is lower or equal to 0 it's
 	 * considered not to have a file count limit
 	 */
-	explicit FiveTupleSplitter(int maxFiles) : ValueBasedSplitter(maxFiles) {}
+	explicit FiveTupleSplitter(int maxFiles) : ValueBasedSplitter(maxFiles), m_FlowTable(MaxNumOfFlows) {}
 
 	/**
 	 * Find the flow for this packet and get the file number it belongs to. If flow is new, return a new file number
 	 */
 	int getFileNumber(pcpp::Packet& packet, std::vector<int>& filesToClose)
 	{
-		// hash the 5-tuple and look for it in the flow table
-		uint32_t hash = pcpp::hash5Tuple(&packet);
+		// look for the 5-tuple in the flow table
+		pcpp::FlowKey key;
+		key.initFromPacket(&packet);
+		bool isNewFlow = false;
+		FlowData& flowData = m_FlowTable.findOrCreate(key, packet.getRawPacket()->getPacketTimeStamp().tv_sec, &isNewFlow);
 
 		// if flow isn't found in the flow table
-		if (m_FlowTable.find(hash) == m_FlowTable.end())
+		if (isNewFlow)
 		{
-			// create a new entry and get a new file number for it
-			m_FlowTable[hash] = getNextFileNumber(filesToClose);
+			// get a new file number for the new entry
+			flowData.fileNumber = getNextFileNumber(filesToClose);
 
 			// if this is s a TCP packet check whether it's a SYN packet
-			// and save this data in the TCP flow table
+			// and save this data in the flow table
 			if (packet.isPacketOfType(pcpp::TCP))
 			{
-				m_TcpFlowTable[hash] = isTcpSyn(packet);
+				flowData.lastPacketWasSyn = isTcpSyn(packet);
 			}
 		}
 		else // flow is found in the flow table
@@ -121,28 +137,28 @@ public:
 				//(with the same 5-tuple as the previous one), so assign a new file number to it.
 				// unless the last packet was also SYN, which is an indication of SYN retransmission.
 				// In this case don't assign a new file number
-				if (isSyn && m_TcpFlowTable.find(hash) != m_TcpFlowTable.end() && m_TcpFlowTable[hash] == false)
+				if (isSyn && !flowData.lastPacketWasSyn)
 				{
-					m_FlowTable[hash] = getNextFileNumber(filesToClose);
+					flowData.fileNumber = getNextFileNumber(filesToClose);
 				}
 				else
 				{
 					// indicate file is being written because this file may not be in the LRU list (and hence closed),
 					// so we need to put it there, open it, and maybe close another file
-					writingToFile(m_FlowTable[hash], filesToClose);
+					writingToFile(flowData.fileNumber, filesToClose);
 				}
 
-				// update the TCP flow table
-				m_TcpFlowTable[hash] = isSyn;
+				// update the TCP state of the flow
+				flowData.lastPacketWasSyn = isSyn;
 			}
 			else
 			{
 				// indicate file is being written because this file may not be in the LRU list (and hence closed),
 				// so we need to put it there, open it, and maybe close another file
-				writingToFile(m_FlowTable[hash], filesToClose);
+				writingToFile(flowData.fileNumber, filesToClose);
 			}
 		}
 
-		return m_FlowTable[hash];
+		return flowData.fileNumber;
 	}
 };
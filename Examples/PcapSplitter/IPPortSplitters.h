@@ -7,18 +7,23 @@
 
 /**
  * A virtual abstract class for all splitters that split files by IP address or TCP/UDP port. Inherits from ValueBasedSplitter,
- * so it already contains a mapping of IP/port to file number, a flow table, and supports max number of files or undefined
- * number of files. This class arranges packets by TCP/UDP flows and for each flow lets the inherited classes determine
+ * so it already contains a mapping of IP/port to file number and supports max number of files or undefined number of files.
+ * It also contains a flow table keyed by the full 5-tuple. This class arranges packets by TCP/UDP flows and for each flow lets the inherited classes determine
  * to which file number this flow will be matched
  */
 class IPPortSplitter : public ValueBasedSplitter
 {
+private:
+
+	// a flow table that maps each TCP/UDP flow to its file number
+	pcpp::FlowTable<int> m_FlowTable;
+
 public:
 
 	/**
-	 * C'tor for this class, does nothing but calling its ancestor
+	 * C'tor for this class, does nothing but calling its ancestor and creating the flow table
 	 */
-	IPPortSplitter(int maxFiles) : ValueBasedSplitter(maxFiles) {}
+	IPPortSplitter(int maxFiles) : ValueBasedSplitter(maxFiles), m_FlowTable(MaxNumOfFlows) {}
 
 	/**
 	 * Implements Splitter's abstract method. This method takes a packet and decides to which flow it belongs to (can
@@ -33,15 +38,18 @@ public:
 			return 0;
 		}
 
-		// hash the 5-tuple and look for it in the flow table
-		uint32_t hash = pcpp::hash5Tuple(&packet);
+		// look for the 5-tuple in the flow table
+		pcpp::FlowKey key;
+		key.initFromPacket(&packet);
+		bool isNewFlow = false;
+		int& fileNumber = m_FlowTable.findOrCreate(key, packet.getRawPacket()->getPacketTimeStamp().tv_sec, &isNewFlow);
 
-		if (m_FlowTable.find(hash) != m_FlowTable.end())
+		if (!isNewFlow)
 		{
-			writingToFile(m_FlowTable[hash], filesToClose);
+			writingToFile(fileNumber, filesToClose);
 
-			// if found it, follow the file number written in the hash record
-			return m_FlowTable[hash];
+			// if found it, follow the file number written in the flow record
+			return fileNumber;
 		}
 
 		// if it's the first packet seen on this flow, try to guess the server port
@@ -60,21 +68,21 @@ public:
 					// SYN packet
 					if (!tcpLayer->getTcpHeader()->ackFlag)
 					{
-						m_FlowTable[hash] = getFileNumberForValue(getValue(packet, SYN, srcPort, dstPort), filesToClose);
-						return m_FlowTable[hash];
+						fileNumber = getFileNumberForValue(getValue(packet, SYN, srcPort, dstPort), filesToClose);
+						return fileNumber;
 					}
 					// SYN/ACK packet
 					else
 					{
-						m_FlowTable[hash] = getFileNumberForValue(getValue(packet, SYN_ACK, srcPort, dstPort), filesToClose);
-						return m_FlowTable[hash];
+						fileNumber = getFileNumberForValue(getValue(packet, SYN_ACK, srcPort, dstPort), filesToClose);
+						return fileNumber;
 					}
 				}
 				// Other TCP packet
 				else
 				{
-					m_FlowTable[hash] = getFileNumberForValue(getValue(packet, TCP_OTHER, srcPort, dstPort), filesToClose);
-					return m_FlowTable[hash];
+					fileNumber = getFileNumberForValue(getValue(packet, TCP_OTHER, srcPort, dstPort), filesToClose);
+					return fileNumber;
 				}
 			}
 		}
@@ -87,8 +95,8 @@ public:
 			{
 				uint16_t srcPort = udpLayer->getSrcPort();
 				uint16_t dstPort = udpLayer->getDstPort();
-				m_FlowTable[hash] = getFileNumberForValue(getValue(packet, UDP, srcPort, dstPort), filesToClose);
-				return m_FlowTable[hash];
+				fileNumber = getFileNumberForValue(getValue(packet, UDP, srcPort, dstPort), filesToClose);
+				return fileNumber;
 			}
 		}
 
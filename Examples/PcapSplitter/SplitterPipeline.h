@@ -0,0 +1,280 @@
+#pragma once
+
+#include "RawPacket.h"
+#include "Packet.h"
+#include "LayerAllocator.h"
+#include "PcapFileDevice.h"
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/**
+ * A batch of packets read from the input file. Batches are allocated once and recycled, so the pipeline doesn't allocate memory per packet
+ * other than the packet data copied by the reader
+ */
+struct PacketBatch
+{
+	// batches are numbered in the order they were read so the splitter can process them in file order
+	uint64_t batchNumber;
+	size_t numOfPackets;
+	std::vector<pcpp::RawPacket> rawPackets;
+	std::vector<pcpp::Packet> parsedPackets;
+
+	explicit PacketBatch(size_t batchSize) : batchNumber(0), numOfPackets(0), rawPackets(batchSize), parsedPackets(batchSize) {}
+};
+
+
+/**
+ * A blocking FIFO of batches used to pass batches between the pipeline threads. pop() returns nullptr once the queue is closed and empty
+ */
+class PacketBatchQueue
+{
+private:
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::deque<PacketBatch*> m_Batches;
+	bool m_Closed;
+	uint64_t m_NumOfWaits;
+
+public:
+	PacketBatchQueue() : m_Closed(false), m_NumOfWaits(0) {}
+
+	void push(PacketBatch* batch)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Batches.push_back(batch);
+		}
+		m_Condition.notify_one();
+	}
+
+	PacketBatch* pop()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		if (m_Batches.empty() && !m_Closed)
+		{
+			m_NumOfWaits++;
+			m_Condition.wait(lock, [this]() { return !m_Batches.empty() || m_Closed; });
+		}
+
+		if (m_Batches.empty())
+			return nullptr;
+
+		PacketBatch* batch = m_Batches.front();
+		m_Batches.pop_front();
+		return batch;
+	}
+
+	void close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Closed = true;
+		}
+		m_Condition.notify_all();
+	}
+
+	/**
+	 * @return The number of times pop() waited for a batch
+	 */
+	uint64_t getNumOfWaits()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_NumOfWaits;
+	}
+};
+
+
+/**
+ * Splits the work of the splitter between several threads:
+ * - A reader thread reads batches of packets from the input file
+ * - Parsing threads parse the packets of each batch, several batches in parallel
+ * - The calling thread gets the parsed packets in file order and hands them to the packet handler, which runs the splitter and
+ *   writes each packet to its output file
+ * Splitters keep state (file sizes, packet counts, the files flows were assigned to) so they must see the packets in file order,
+ * which also keeps the packets of each output file in the same order as in the input file. The output files are the same as when
+ * splitting on a single thread
+ */
+class SplitterPipeline
+{
+public:
+	/**
+	 * A callback that gets the parsed packets in file order. Returning false stops the pipeline
+	 */
+	typedef std::function<bool(pcpp::Packet& packet)> PacketHandler;
+
+	/**
+	 * Pipeline statistics
+	 */
+	struct Stats
+	{
+		uint64_t numOfPackets;
+		uint64_t numOfBytes;
+		uint64_t numOfBatches;
+		// the number of times the reader waited for a free batch, meaning parsing or writing were slower than reading
+		uint64_t readerWaits;
+		// the number of times the splitter waited for a parsed batch, meaning reading or parsing were slower than writing
+		uint64_t splitterWaits;
+	};
+
+	/**
+	 * A c'tor for this class
+	 * @param[in] reader An opened reader of the input file
+	 * @param[in] numOfParsingThreads The number of threads that parse packets
+	 * @param[in] batchSize The number of packets in each batch
+	 */
+	SplitterPipeline(pcpp::IFileReaderDevice* reader, int numOfParsingThreads, size_t batchSize = 1024) :
+		m_Reader(reader), m_NumOfParsingThreads(numOfParsingThreads), m_BatchSize(batchSize), m_NextBatchNumber(0),
+		m_NumOfRunningParsers(0), m_Stopped(false), m_SplitterWaits(0)
+	{
+		// enough batches to keep all threads busy: one being read, two per parsing thread and one being split
+		size_t numOfBatches = 2 * numOfParsingThreads + 2;
+		for (size_t i = 0; i < numOfBatches; i++)
+		{
+			m_Batches.push_back(new PacketBatch(batchSize));
+			m_FreeBatches.push(m_Batches.back());
+		}
+	}
+
+	~SplitterPipeline()
+	{
+		for (std::vector<PacketBatch*>::iterator iter = m_Batches.begin(); iter != m_Batches.end(); iter++)
+			delete *iter;
+	}
+
+	/**
+	 * Read the whole input file and hand its packets to the packet handler on the calling thread
+	 * @param[in] packetHandler The callback that gets the packets in file order
+	 * @param[out] stats The pipeline statistics
+	 */
+	void run(const PacketHandler& packetHandler, Stats& stats)
+	{
+		memset(&stats, 0, sizeof(stats));
+
+		m_NumOfRunningParsers = m_NumOfParsingThreads;
+		std::thread readerThread(&SplitterPipeline::readerThreadMain, this);
+		std::vector<std::thread> parsingThreads;
+		for (int i = 0; i < m_NumOfParsingThreads; i++)
+			parsingThreads.push_back(std::thread(&SplitterPipeline::parsingThreadMain, this));
+
+		PacketBatch* batch;
+		while ((batch = getNextParsedBatch()) != nullptr)
+		{
+			stats.numOfBatches++;
+
+			for (size_t i = 0; i < batch->numOfPackets && !m_Stopped; i++)
+			{
+				if (!packetHandler(batch->parsedPackets[i]))
+				{
+					// let the reader finish quickly, the rest of the packets are ignored
+					m_Stopped = true;
+					break;
+				}
+
+				stats.numOfPackets++;
+				stats.numOfBytes += batch->rawPackets[i].getRawDataLen();
+			}
+
+			m_FreeBatches.push(batch);
+		}
+
+		readerThread.join();
+		for (std::vector<std::thread>::iterator iter = parsingThreads.begin(); iter != parsingThreads.end(); iter++)
+			iter->join();
+
+		stats.readerWaits = m_FreeBatches.getNumOfWaits();
+		stats.splitterWaits = m_SplitterWaits;
+	}
+
+private:
+	pcpp::IFileReaderDevice* m_Reader;
+	int m_NumOfParsingThreads;
+	size_t m_BatchSize;
+	std::vector<PacketBatch*> m_Batches;
+	PacketBatchQueue m_FreeBatches;
+	PacketBatchQueue m_ReadBatches;
+
+	// parsed batches waiting for their turn to be split, by batch number
+	std::mutex m_ParsedBatchesMutex;
+	std::condition_variable m_ParsedBatchesCondition;
+	std::map<uint64_t, PacketBatch*> m_ParsedBatches;
+	uint64_t m_NextBatchNumber;
+	int m_NumOfRunningParsers;
+	std::atomic<bool> m_Stopped;
+	uint64_t m_SplitterWaits;
+
+	void readerThreadMain()
+	{
+		uint64_t batchNumber = 0;
+		bool endOfFile = false;
+		while (!endOfFile && !m_Stopped)
+		{
+			PacketBatch* batch = m_FreeBatches.pop();
+			batch->batchNumber = batchNumber++;
+			batch->numOfPackets = 0;
+			while (batch->numOfPackets < m_BatchSize && m_Reader->getNextPacket(batch->rawPackets[batch->numOfPackets]))
+				batch->numOfPackets++;
+
+			endOfFile = (batch->numOfPackets < m_BatchSize);
+			m_ReadBatches.push(batch);
+		}
+
+		m_ReadBatches.close();
+	}
+
+	void parsingThreadMain()
+	{
+		pcpp::LayerAllocator::enableThreadCache();
+
+		PacketBatch* batch;
+		while ((batch = m_ReadBatches.pop()) != nullptr)
+		{
+			for (size_t i = 0; i < batch->numOfPackets; i++)
+				batch->parsedPackets[i].setRawPacket(&batch->rawPackets[i], false);
+
+			{
+				std::lock_guard<std::mutex> lock(m_ParsedBatchesMutex);
+				m_ParsedBatches[batch->batchNumber] = batch;
+			}
+			m_ParsedBatchesCondition.notify_one();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_ParsedBatchesMutex);
+			m_NumOfRunningParsers--;
+		}
+		m_ParsedBatchesCondition.notify_one();
+
+		pcpp::LayerAllocator::disableThreadCache();
+	}
+
+	PacketBatch* getNextParsedBatch()
+	{
+		std::unique_lock<std::mutex> lock(m_ParsedBatchesMutex);
+		std::map<uint64_t, PacketBatch*>::iterator iter = m_ParsedBatches.find(m_NextBatchNumber);
+		if (iter == m_ParsedBatches.end() && m_NumOfRunningParsers > 0)
+		{
+			m_SplitterWaits++;
+			m_ParsedBatchesCondition.wait(lock, [this, &iter]()
+			{
+				iter = m_ParsedBatches.find(m_NextBatchNumber);
+				return iter != m_ParsedBatches.end() || m_NumOfRunningParsers == 0;
+			});
+		}
+
+		if (iter == m_ParsedBatches.end())
+			return nullptr;
+
+		PacketBatch* batch = iter->second;
+		m_ParsedBatches.erase(iter);
+		m_NextBatchNumber++;
+		return batch;
+	}
+};
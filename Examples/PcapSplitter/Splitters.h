@@ -9,6 +9,7 @@
 #include "UdpLayer.h"
 #include "DnsLayer.h"
 #include "PacketUtils.h"
+#include "FlowTable.h"
 #include <map>
 #include <algorithm>
 #include <iomanip>
@@ -165,8 +166,6 @@ public:
 class ValueBasedSplitter : public SplitterWithMaxFiles
 {
 protected:
-	// A flow table that keeps track of all flows (a flow is usually identified by 5-tuple)
-	std::map<uint32_t, int> m_FlowTable;
 	// a map between the relevant packet value (e.g client-ip) and the file to write the packet to
 	std::map<uint32_t, int> m_ValueToFileTable;
 
@@ -175,6 +174,9 @@ protected:
 	 */
 	explicit ValueBasedSplitter(int maxFiles) : SplitterWithMaxFiles(maxFiles, 1) {}
 
+	// the maximum number of flows kept by splitters that track flows. Flow tables only grow as flows are added, so this is just an upper bound
+	static const size_t MaxNumOfFlows = 1 << 30;
+
 	/**
 	 * A helper method that gets the packet value and returns the file to write it to, and also a file to close if the
 	 * LRU list is full
@@ -39,6 +39,9 @@
  * - In options 3-5 & 7 all packets which aren't UDP or TCP (hence don't belong to any connection) will be written to
  *   one output file, separate from the other output files (usually file#0)
  * - Works only on files of the pcap (TCPDUMP) format
+ * - Splitting can be spread over several threads: a reader thread, a number of parsing threads and a writer thread for each
+ *   of a few open output files (more files than that are written on the splitter thread). Packets are still handed to the
+ *   splitter in file order, so the output files are the same as when splitting on a single thread
  *
  */
 
@@ -50,12 +53,14 @@
 #include <string>
 #include <iomanip>
 #include <map>
+#include <chrono>
 #include <RawPacket.h>
 #include <Packet.h>
 #include <PcapFileDevice.h>
 #include "SimpleSplitters.h"
 #include "IPPortSplitters.h"
 #include "ConnectionSplitters.h"
+#include "SplitterPipeline.h"
 #include <getopt.h>
 #include <SystemUtils.h>
 #include <PcapPlusPlusVersion.h>
@@ -68,6 +73,7 @@ static struct option PcapSplitterOptions[] =
 	{"method", required_argument, nullptr, 'm'},
 	{"param", required_argument, nullptr, 'p'},
 	{"filter", required_argument, nullptr, 'i'},
+	{"threads", required_argument, nullptr, 't'},
 	{"help", no_argument, nullptr, 'h'},
 	{"version", no_argument, nullptr, 'v'},
 	{nullptr, 0, nullptr, 0}
@@ -93,6 +99,14 @@ static struct option PcapSplitterOptions[] =
 #define SPLIT_BY_ROUND_ROBIN   "round-robin"
 
 
+// the size of each of the two buffers of an output file writer in multi-threaded mode
+#define OUTPUT_FILE_ASYNC_BUFFER_SIZE (256 * 1024)
+
+// the max number of output files that are open with their own writer thread at the same time in multi-threaded mode. Each of them takes
+// a thread and two buffers of OUTPUT_FILE_ASYNC_BUFFER_SIZE, so files opened while this many are open are written on the splitter thread
+#define MAX_ASYNC_OUTPUT_FILES 8
+
+
 #if defined(_WIN32)
 #define SEPARATOR '\\'
 #else
@@ -108,7 +122,7 @@ void printUsage()
 	std::cout << std::endl
 		<< "Usage:" << std::endl
 		<< "------" << std::endl
-		<< pcpp::AppName::get() << " [-h] [-v] [-i filter] -f pcap_file -o output_dir -m split_method [-p split_param]" << std::endl
+		<< pcpp::AppName::get() << " [-h] [-v] [-i filter] [-t num_threads] -f pcap_file -o output_dir -m split_method [-p split_param]" << std::endl
 		<< std::endl
 		<< "Options:" << std::endl
 		<< std::endl
@@ -152,6 +166,9 @@ void printUsage()
 		<< "                      'method = bpf-filter'   => split-param is the BPF filter to match upon" << std::endl
 		<< "                      'method = round-robin'  => split-param is number of files to round-robin packets between" << std::endl
 		<< "    -i filter       : Apply a BPF filter, meaning only filtered packets will be counted in the split" << std::endl
+		<< "    -t num_threads  : Split using a reader thread, num_threads packet parsing threads and a writer thread" << std::endl
+		<< "                      for each of up to " << MAX_ASYNC_OUTPUT_FILES << " open output files. The output files are the same as" << std::endl
+		<< "                      without this option, which does all the work on a single thread" << std::endl
 		<< "    -v              : Displays the current version and exists" << std::endl
 		<< "    -h              : Displays this help message and exits" << std::endl
 		<< std::endl;
@@ -211,6 +228,134 @@ std::string getFileNameWithoutExtension(const std::string& path)
 }
 
 
+/**
+ * The output files of the split and what's needed to create them
+ */
+struct SplitterOutput
+{
+	// the output file format: /requested-path/original-file-name-[4-digit-number-starting-at-0000].pcap
+	std::string outputPcapFileName;
+	std::string outputFileExtension;
+	bool isReaderPcapng;
+	// write up to MAX_ASYNC_OUTPUT_FILES output files on their own writer threads
+	bool asyncWriting;
+	int numOfAsyncFiles;
+	int numOfFiles;
+	// a map of file number to IFileWriterDevice. A null writer means the file was opened once and then closed
+	std::map<int, pcpp::IFileWriterDevice*> outputFiles;
+	// the number of times writing a packet waited for an output file writer thread
+	uint64_t numOfBlockedWrites;
+
+	SplitterOutput() : isReaderPcapng(false), asyncWriting(false), numOfAsyncFiles(0), numOfFiles(0), numOfBlockedWrites(0) {}
+};
+
+
+/**
+ * Create a writer for an output file and open it. If the file was already written to and closed, it's opened in append mode
+ */
+pcpp::IFileWriterDevice* openOutputFile(pcpp::Packet& parsedPacket, Splitter* splitter, SplitterOutput& output, int fileNum, bool appendMode)
+{
+	// get file name from the splitter and add the .pcap extension
+	std::string fileName = splitter->getFileName(parsedPacket, output.outputPcapFileName, fileNum) + output.outputFileExtension;
+
+	pcpp::IFileWriterDevice* writer;
+	if (output.isReaderPcapng)
+	{
+		// if reader is pcapng, create a pcapng writer
+		writer = new pcpp::PcapNgFileWriterDevice(fileName);
+	}
+	else
+	{
+		// if reader is pcap, create a pcap writer
+		writer = new pcpp::PcapFileWriterDevice(fileName, parsedPacket.getRawPacket()->getLinkLayerType());
+	}
+
+	bool asyncWriting = (output.asyncWriting && output.numOfAsyncFiles < MAX_ASYNC_OUTPUT_FILES);
+	if (!writer->open(appendMode) || (asyncWriting && !writer->startAsyncWriting(OUTPUT_FILE_ASYNC_BUFFER_SIZE)))
+	{
+		delete writer;
+		return nullptr;
+	}
+
+	if (asyncWriting)
+		output.numOfAsyncFiles++;
+
+	return writer;
+}
+
+
+/**
+ * Close an output file and free its writer
+ */
+void closeOutputFile(SplitterOutput& output, std::map<int, pcpp::IFileWriterDevice*>::iterator fileIter)
+{
+	if (fileIter->second == nullptr)
+		return;
+
+	if (fileIter->second->isAsyncWritingEnabled())
+		output.numOfAsyncFiles--;
+
+	// close() writes all queued packets so it's called before reading the stats
+	fileIter->second->close();
+
+	pcpp::IFileWriterDevice::AsyncWriterStats asyncStats;
+	fileIter->second->getAsyncWriterStats(asyncStats);
+	output.numOfBlockedWrites += asyncStats.numOfBlockedWrites;
+
+	delete fileIter->second;
+	fileIter->second = nullptr;
+}
+
+
+/**
+ * Write a packet to the output file chosen by the splitter and close the files the splitter wants to close.
+ * Returns false if the output file couldn't be opened
+ */
+bool writePacketToOutputFile(pcpp::Packet& parsedPacket, Splitter* splitter, SplitterOutput& output)
+{
+	std::vector<int> filesToClose;
+
+	// call the splitter to get the file number to write the current packet to
+	int fileNum = splitter->getFileNumber(parsedPacket, filesToClose);
+
+	std::map<int, pcpp::IFileWriterDevice*>::iterator fileIter = output.outputFiles.find(fileNum);
+
+	// if file number is seen for the first time (meaning it's the first packet written to it)
+	if (fileIter == output.outputFiles.end())
+	{
+		pcpp::IFileWriterDevice* writer = openOutputFile(parsedPacket, splitter, output, fileNum, false);
+		if (writer == nullptr)
+			return false;
+
+		fileIter = output.outputFiles.insert(std::make_pair(fileNum, writer)).first;
+		output.numOfFiles++;
+	}
+
+	// if file number exists in the map but IFileWriterDevice is null it means this file was open once and
+	// then closed. In this case we need to re-open the IFileWriterDevice in append mode
+	else if (fileIter->second == nullptr)
+	{
+		fileIter->second = openOutputFile(parsedPacket, splitter, output, fileNum, true);
+		if (fileIter->second == nullptr)
+			return false;
+	}
+
+	// write the packet to the writer
+	fileIter->second->writePacket(*parsedPacket.getRawPacket());
+
+	// if splitter wants us to close files - go over the file numbers and close them
+	for (std::vector<int>::iterator it = filesToClose.begin(); it != filesToClose.end(); it++)
+	{
+		// check if that file number is in the map
+		std::map<int, pcpp::IFileWriterDevice*>::iterator fileToCloseIter = output.outputFiles.find(*it);
+		if (fileToCloseIter != output.outputFiles.end())
+			closeOutputFile(output, fileToCloseIter);
+	}
+
+	return true;
+}
+
+
 /**
  * main method of this utility
  */
@@ -230,10 +375,12 @@ int main(int argc, char* argv[])
 
 	bool paramWasSet = false;
 
+	int numOfThreads = 0;
+
 	int optionIndex = 0;
 	int opt = 0;
 
-	while((opt = getopt_long(argc, argv, "f:o:m:p:i:vh", PcapSplitterOptions, &optionIndex)) != -1)
+	while((opt = getopt_long(argc, argv, "f:o:m:p:i:t:vh", PcapSplitterOptions, &optionIndex)) != -1)
 	{
 		switch (opt)
 		{
@@ -255,6 +402,9 @@ int main(int argc, char* argv[])
 			case 'i':
 				filter = optarg;
 				break;
+			case 't':
+				numOfThreads = atoi(optarg);
+				break;
 			case 'h':
 				printUsage();
 				exit(0);
@@ -287,6 +437,11 @@ int main(int argc, char* argv[])
 		EXIT_WITH_ERROR("Split method was not given");
 	}
 
+	if (numOfThreads < 0)
+	{
+		EXIT_WITH_ERROR("Number of threads must be a positive number");
+	}
+
 	Splitter* splitter = nullptr;
 
 	// decide of the splitter to use, according to the user's choice
@@ -351,12 +506,14 @@ int main(int argc, char* argv[])
 		EXIT_WITH_ERROR(errorStr);
 	}
 
+	SplitterOutput output;
+
 	// prepare the output file format: /requested-path/original-file-name-[4-digit-number-starting-at-0000].pcap
-	std::string outputPcapFileName = outputPcapDir + std::string(1, SEPARATOR) + getFileNameWithoutExtension(inputPcapFileName) + "-";
+	output.outputPcapFileName = outputPcapDir + std::string(1, SEPARATOR) + getFileNameWithoutExtension(inputPcapFileName) + "-";
 
 	// open a pcap file for reading
 	pcpp::IFileReaderDevice* reader = pcpp::IFileReaderDevice::getReader(inputPcapFileName);
-	bool isReaderPcapng = (dynamic_cast<pcpp::PcapNgFileReaderDevice*>(reader) != nullptr);
+	output.isReaderPcapng = (dynamic_cast<pcpp::PcapNgFileReaderDevice*>(reader) != nullptr);
 
 	if (reader == nullptr || !reader->open())
 	{
@@ -373,97 +530,64 @@ int main(int argc, char* argv[])
 	std::cout << "Started..." << std::endl;
 
 	// determine output file extension
-	std::string outputFileExtenison = (isReaderPcapng ? ".pcapng" : ".pcap");
-
-	int packetCountSoFar = 0;
-	int numOfFiles = 0;
-	pcpp::RawPacket rawPacket;
+	output.outputFileExtension = (output.isReaderPcapng ? ".pcapng" : ".pcap");
 
-	// prepare a map of file number to IFileWriterDevice
-	std::map<int, pcpp::IFileWriterDevice*> outputFiles;
+	uint64_t packetCountSoFar = 0;
+	uint64_t bytesCountSoFar = 0;
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
 
-	// read all packets from input file, for each packet do:
-	while (reader->getNextPacket(rawPacket))
+	if (numOfThreads > 0)
 	{
-		// parse the raw packet into a parsed packet
-		pcpp::Packet parsedPacket(&rawPacket);
-
-		std::vector<int> filesToClose;
-
-		// call the splitter to get the file number to write the current packet to
-		int fileNum = splitter->getFileNumber(parsedPacket, filesToClose);
+		// read, parse and write on separate threads. The splitter gets the packets in file order on this thread
+		output.asyncWriting = true;
+		SplitterPipeline pipeline(reader, numOfThreads);
+		SplitterPipeline::Stats pipelineStats;
+		pipeline.run([splitter, &output](pcpp::Packet& parsedPacket) { return writePacketToOutputFile(parsedPacket, splitter, output); }, pipelineStats);
+
+		packetCountSoFar = pipelineStats.numOfPackets;
+		bytesCountSoFar = pipelineStats.numOfBytes;
+		std::cout
+			<< "Pipeline: " << numOfThreads << " parsing threads, " << pipelineStats.numOfBatches << " batches. "
+			<< "Reader waited " << pipelineStats.readerWaits << " times, splitter waited " << pipelineStats.splitterWaits << " times" << std::endl;
+	}
+	else
+	{
+		pcpp::RawPacket rawPacket;
 
-		// if file number is seen for the first time (meaning it's the first packet written to it)
-		if (outputFiles.find(fileNum) == outputFiles.end())
+		// read all packets from input file, for each packet do:
+		while (reader->getNextPacket(rawPacket))
 		{
-			// get file name from the splitter and add the .pcap extension
-			std::string fileName = splitter->getFileName(parsedPacket, outputPcapFileName, fileNum) + outputFileExtenison;
-
-			// create a new IFileWriterDevice for this file
-			if (isReaderPcapng)
-			{
-				// if reader is pcapng, create a pcapng writer
-				outputFiles[fileNum] = new pcpp::PcapNgFileWriterDevice(fileName);
-			}
-			else
-			{
-				// if reader is pcap, create a pcap writer
-				outputFiles[fileNum] = new pcpp::PcapFileWriterDevice(fileName, rawPacket.getLinkLayerType());
-			}
-
-			// open the writer
-			if (!outputFiles[fileNum]->open())
+			// parse the raw packet into a parsed packet
+			pcpp::Packet parsedPacket(&rawPacket);
+
+			if (!writePacketToOutputFile(parsedPacket, splitter, output))
 				break;
 
-			numOfFiles++;
+			packetCountSoFar++;
+			bytesCountSoFar += rawPacket.getRawDataLen();
 		}
+	}
 
-		// if file number exists in the map but PcapFileWriterDevice is null it means this file was open once and
-		// then closed. In this case we need to re-open the PcapFileWriterDevice in append mode
-		else if (outputFiles[fileNum] == nullptr)
-		{
-			// get file name from the splitter and add the .pcap extension
-			std::string fileName = splitter->getFileName(parsedPacket, outputPcapFileName, fileNum) + outputFileExtenison;
-
-			// re-create the IFileWriterDevice object
-			if (isReaderPcapng)
-			{
-				// if reader is pcapng, create a pcapng writer
-				outputFiles[fileNum] = new pcpp::PcapNgFileWriterDevice(fileName);
-			}
-			else
-			{
-				// if reader is pcap, create a pcap writer
-				outputFiles[fileNum] = new pcpp::PcapFileWriterDevice(fileName, rawPacket.getLinkLayerType());
-			}
-
-			// open the writer in __append__ mode
-			if (!outputFiles[fileNum]->open(true))
-				break;
-		}
+	// close the writer files which are still open
+	for (std::map<int, pcpp::IFileWriterDevice*>::iterator it = output.outputFiles.begin(); it != output.outputFiles.end(); ++it)
+	{
+		closeOutputFile(output, it);
+	}
 
-		// write the packet to the writer
-		outputFiles[fileNum]->writePacket(*parsedPacket.getRawPacket());
+	double elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
 
-		// if splitter wants us to close files - go over the file numbers and close them
-		for (std::vector<int>::iterator it = filesToClose.begin(); it != filesToClose.end(); it++)
-		{
-			// check if that file number is in the map
-			if (outputFiles.find(*it) != outputFiles.end())
-			{
-				// close the writer
-				outputFiles[*it]->close();
-
-				// free the writer memory and put null in the map record
-				delete outputFiles[*it];
-				outputFiles[*it] = nullptr;
-			}
-		}
+	std::cout << "Finished. Read and written " << packetCountSoFar << " packets to " << output.numOfFiles << " files" << std::endl;
 
-		packetCountSoFar++;
-	}
+	if (output.asyncWriting)
+		std::cout << "Writing packets waited for output file writer threads " << output.numOfBlockedWrites << " times" << std::endl;
 
-	std::cout << "Finished. Read and written " << packetCountSoFar << " packets to " << numOfFiles << " files" << std::endl;
+	if (elapsedSec > 0)
+	{
+		std::cout
+			<< "Throughput: " << std::fixed << std::setprecision(3) << elapsedSec << " seconds, "
+			<< std::setprecision(0) << packetCountSoFar / elapsedSec << " packets/sec, "
+			<< std::setprecision(2) << bytesCountSoFar / elapsedSec / (1024 * 1024) << " MB/sec" << std::endl;
+	}
 
 	// close the reader file
 	reader->close();
@@ -472,15 +596,5 @@ int main(int argc, char* argv[])
 	delete reader;
 	delete splitter;
 
-	// close the writer files which are still open
-	for(std::map<int, pcpp::IFileWriterDevice*>::iterator it = outputFiles.begin(); it != outputFiles.end(); ++it)
-	{
-		if (it->second != NULL)
-		{
-			it->second->close();
-			delete it->second;
-		}
-	}
-
 	return 0;
 }
@@ -8,7 +8,7 @@
  * You can also run `TLSFingerprinting -h` for modes of operation and parameters.
  */
 
-#include <map>
+#include <unordered_map>
 #include <vector>
 #include <algorithm>
 #include <iostream>
@@ -56,14 +56,17 @@ bool isNotAlphanumeric(char c)
 }
 
 
+typedef std::unordered_map<pcpp::TLSFingerprintDigest, uint64_t, pcpp::TLSFingerprintDigest::Hash> TLSFingerprintCountMap;
+
+
 /**
  * An auxiliary method for sorting the TLS fingerprint count map. Used in printCommonTLSFingerprints()
  */
-bool stringCountComparer(const std::pair<std::string, uint64_t>& first, const std::pair<std::string, uint64_t>& second)
+bool fingerprintCountComparer(const std::pair<pcpp::TLSFingerprintDigest, uint64_t>& first, const std::pair<pcpp::TLSFingerprintDigest, uint64_t>& second)
 {
 	if (first.second == second.second)
 	{
-		return first.first > second.first;
+		return second.first < first.first;
 	}
 	return first.second > second.second;
 }
@@ -222,8 +225,9 @@ struct TLSFingerprintingStats
 	uint64_t numOfPacketsTotal;
 	uint64_t numOfCHPackets;
 	uint64_t numOfSHPackets;
-	std::map<std::string, uint64_t> chFingerprints;
-	std::map<std::string, uint64_t> shFingerprints;
+	// fingerprints are counted by their binary MD5 hash so counting doesn't allocate memory
+	TLSFingerprintCountMap chFingerprints;
+	TLSFingerprintCountMap shFingerprints;
 };
 
 struct HandlePacketData
@@ -239,7 +243,7 @@ struct HandlePacketData
 /**
  * Print cipher-suite map in a table sorted by number of occurrences (most common cipher-suite will be first)
  */
-void printCommonTLSFingerprints(const std::map<std::string, uint64_t>& tlsFingerprintMap, int printCountItems)
+void printCommonTLSFingerprints(const TLSFingerprintCountMap& tlsFingerprintMap, int printCountItems)
 {
 	// create the table
 	std::vector<std::string> columnNames;
@@ -251,12 +255,12 @@ void printCommonTLSFingerprints(const std::map<std::string, uint64_t>& tlsFinger
 	pcpp::TablePrinter printer(columnNames, columnsWidths);
 
 	// sort the TLS fingerprint map so the most popular will be first
-	// since it's not possible to sort a std::map you must copy it to a std::vector and sort it then
-	std::vector<std::pair<std::string, int> > map2vec(tlsFingerprintMap.begin(), tlsFingerprintMap.end());
-	std::sort(map2vec.begin(),map2vec.end(), &stringCountComparer);
+	// since it's not possible to sort a std::unordered_map you must copy it to a std::vector and sort it then
+	std::vector<std::pair<pcpp::TLSFingerprintDigest, uint64_t> > map2vec(tlsFingerprintMap.begin(), tlsFingerprintMap.end());
+	std::sort(map2vec.begin(),map2vec.end(), &fingerprintCountComparer);
 
 	// go over all items (fingerprints + count) in the sorted vector and print them
-	for(std::vector<std::pair<std::string, int> >::iterator iter = map2vec.begin();
+	for(std::vector<std::pair<pcpp::TLSFingerprintDigest, uint64_t> >::iterator iter = map2vec.begin();
 			iter != map2vec.end();
 			iter++)
 	{
@@ -264,7 +268,7 @@ void printCommonTLSFingerprints(const std::map<std::string, uint64_t>& tlsFinger
 			break;
 
 		std::stringstream values;
-		values << iter->first << "|" << iter->second;
+		values << iter->first.toString() << "|" << iter->second;
 		printer.printRow(values.str(), '|');
 	}
 }
@@ -343,12 +347,11 @@ void handlePacket(pcpp::RawPacket* rawPacket, const HandlePacketData* data)
 				{
 					data->stats->numOfCHPackets++;
 
-					// extract the TLS fingerprint
-					pcpp::SSLClientHelloMessage::ClientHelloTLSFingerprint tlsFingerprint = clientHelloMessage->generateTLSFingerprint();
-					std::pair<std::string, std::string> tlsFingerprintStringAndMD5 = tlsFingerprint.toStringAndMD5();
-					data->stats->chFingerprints[tlsFingerprintStringAndMD5.second]++;
+					// extract the TLS fingerprint hash
+					pcpp::TLSFingerprintDigest tlsFingerprintDigest = clientHelloMessage->generateTLSFingerprintDigest();
+					data->stats->chFingerprints[tlsFingerprintDigest]++;
 					// write data to output file
-					writeToOutputFile(data->outputFile, parsedPacket, tlsFingerprintStringAndMD5.first, tlsFingerprintStringAndMD5.second, "ClientHello", data->separator);
+					writeToOutputFile(data->outputFile, parsedPacket, clientHelloMessage->generateTLSFingerprint().toString(), tlsFingerprintDigest.toString(), "ClientHello", data->separator);
 					return;
 				}
 			}
@@ -361,12 +364,11 @@ void handlePacket(pcpp::RawPacket* rawPacket, const HandlePacketData* data)
 				{
 					data->stats->numOfSHPackets++;
 
-					// extract the TLS fingerprint
-					pcpp::SSLServerHelloMessage::ServerHelloTLSFingerprint tlsFingerprint = servertHelloMessage->generateTLSFingerprint();
-					std::pair<std::string, std::string> tlsFingerprintStringAndMD5 = tlsFingerprint.toStringAndMD5();
-					data->stats->shFingerprints[tlsFingerprintStringAndMD5.second]++;
+					// extract the TLS fingerprint hash
+					pcpp::TLSFingerprintDigest tlsFingerprintDigest = servertHelloMessage->generateTLSFingerprintDigest();
+					data->stats->shFingerprints[tlsFingerprintDigest]++;
 					// write data to output file
-					writeToOutputFile(data->outputFile, parsedPacket, tlsFingerprintStringAndMD5.first, tlsFingerprintStringAndMD5.second, "ServerHello", data->separator);
+					writeToOutputFile(data->outputFile, parsedPacket, servertHelloMessage->generateTLSFingerprint().toString(), tlsFingerprintDigest.toString(), "ServerHello", data->separator);
 				}
 			}
 		}
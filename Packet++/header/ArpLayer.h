@@ -146,5 +146,11 @@ namespace pcpp
 		OsiModelLayer getOsiModelLayer() const { return OsiModelNetworkLayer; }
 	};
 
+	template<>
+	struct LayerProtocolTag<ArpLayer>
+	{
+		static const ProtocolType value = ARP;
+	};
+
 } // namespace pcpp
 #endif /* PACKETPP_ARP_LAYER */
@@ -130,6 +130,12 @@ protected:
 
 };
 
+template<>
+struct LayerProtocolTag<BgpLayer>
+{
+	static const ProtocolType value = BGP;
+};
+
 
 
 /**
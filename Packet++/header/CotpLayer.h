@@ -115,6 +115,12 @@ namespace pcpp
 		cotphdr *getCotpHeader() const { return (cotphdr *)m_Data; }
 	};
 
+	template<>
+	struct LayerProtocolTag<CotpLayer>
+	{
+		static const ProtocolType value = COTP;
+	};
+
 } // namespace pcpp
 
 #endif // PCAPPLUSPLUS_COTPLAYER_H
@@ -801,6 +801,12 @@ namespace pcpp
 
 		DhcpOption addOptionAt(const DhcpOptionBuilder& optionBuilder, int offset);
 	};
+
+	template<>
+	struct LayerProtocolTag<DhcpLayer>
+	{
+		static const ProtocolType value = DHCP;
+	};
 }
 
 #endif /* PACKETPP_DHCP_LAYER */
@@ -434,6 +434,12 @@ namespace pcpp
 		TLVRecordReader<DhcpV6Option> m_OptionReader;
 	};
 
+	template<>
+	struct LayerProtocolTag<DhcpV6Layer>
+	{
+		static const ProtocolType value = DHCPv6;
+	};
+
 
 	// implementation of inline methods
 
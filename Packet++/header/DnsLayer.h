@@ -89,9 +89,41 @@ namespace pcpp
 	class IDnsResourceData;
 
 
+	/**
+	 * @struct DnsRecordInfo
+	 * The fields of a DNS record (a query, an answer, an authority or an additional record) as read by DnsLayer#getFirstRecord() and
+	 * DnsLayer#getNextRecord(). The record names can be decoded with DnsLayer#decodeName()
+	 */
+	struct DnsRecordInfo
+	{
+		/** The section of the message the record belongs to */
+		DnsResourceType resourceType;
+		/** The index of the record in the message, counting all sections */
+		uint16_t index;
+		/** The offset of the record (which is also the offset of its name) in the layer */
+		size_t offsetInLayer;
+		/** The size of the record in bytes, including its name */
+		size_t size;
+		/** The record type */
+		DnsType dnsType;
+		/** The record class. In OPT records this is the UDP payload size */
+		uint16_t dnsClass;
+		/** The record TTL. Always 0 for queries */
+		uint32_t ttl;
+		/** The offset of the record data in the layer. Always 0 for queries */
+		size_t dataOffset;
+		/** The length of the record data in bytes. Always 0 for queries */
+		size_t dataLength;
+	};
+
+
 	/**
 	 * @class DnsLayer
-	 * Represents the DNS protocol layer
+	 * Represents the DNS protocol layer.
+	 *
+	 * The DnsQuery and DnsResource objects of a parsed message are created only when they're needed, meaning the first time a method that
+	 * returns or modifies them is called. getFirstRecord(), getNextRecord() and decodeName() read the records straight from the layer data
+	 * and don't allocate memory, so they're the cheaper way of reading a parsed message
 	 */
 	class DnsLayer : public Layer
 	{
@@ -163,6 +195,38 @@ namespace pcpp
 		 */
 		size_t getQueryCount() const;
 
+		/**
+		 * Read the first record of the message (the first query, or the first record of the next non-empty section) without creating
+		 * DnsQuery or DnsResource objects
+		 * @param[out] record The record fields
+		 * @return True if the record was read, false if the message has no records or the first record is malformed
+		 */
+		bool getFirstRecord(DnsRecordInfo& record) const;
+
+		/**
+		 * Read the record following a record read by getFirstRecord() or getNextRecord() without creating DnsQuery or DnsResource objects.
+		 * Records are read in the order they appear in the message: queries, answers, authorities and then additional records
+		 * @param[in,out] record The previous record. On success it's overwritten with the fields of the next record
+		 * @return True if the next record was read, false if 'record' was the last record of the message or the next record is malformed
+		 */
+		bool getNextRecord(DnsRecordInfo& record) const;
+
+		/**
+		 * Decode a DNS name in the layer into a caller-provided buffer, following name compression pointers. This method doesn't allocate
+		 * memory. Decoded names are at most MaxDecodedNameLength characters long, so a buffer of MaxDecodedNameLength+1 bytes fits any name
+		 * @param[in] offsetInLayer The offset of the encoded name in the layer: DnsRecordInfo#offsetInLayer for the name of a record, or
+		 * DnsRecordInfo#dataOffset for the name in the data of CNAME, NS, PTR and DNAME records
+		 * @param[out] buffer The buffer to write the decoded name to. The name is always null-terminated, and truncated if it doesn't fit
+		 * @param[in] bufferLen The buffer size in bytes
+		 * @return The length of the decoded name, not including the terminating null
+		 */
+		size_t decodeName(size_t offsetInLayer, char* buffer, size_t bufferLen) const;
+
+		/**
+		 * The max length of a decoded DNS name
+		 */
+		static const size_t MaxDecodedNameLength = 255;
+
 		/**
 		 * Add a new DNS query to the layer
 		 * @param[in] name The value that shall be set in the name field of the query
@@ -449,14 +513,16 @@ namespace pcpp
 		explicit DnsLayer(size_t offsetAdjustment);
 
 	private:
-		IDnsResource* m_ResourceList;
-		DnsQuery*     m_FirstQuery;
-		DnsResource*  m_FirstAnswer;
-		DnsResource*  m_FirstAuthority;
-		DnsResource*  m_FirstAdditional;
+		mutable IDnsResource* m_ResourceList;
+		mutable DnsQuery*     m_FirstQuery;
+		mutable DnsResource*  m_FirstAnswer;
+		mutable DnsResource*  m_FirstAuthority;
+		mutable DnsResource*  m_FirstAdditional;
 		uint16_t      m_OffsetAdjustment;
+		// true if the DnsQuery and DnsResource objects of the message were created
+		mutable bool  m_ResourcesParsed;
 
-		size_t getBasicHeaderSize();
+		size_t getBasicHeaderSize() const;
 		void init(size_t offsetAdjustment, bool callParseResource);
 		void initNewLayer(size_t offsetAdjustment);
 
@@ -471,7 +537,8 @@ namespace pcpp
 
 		IDnsResource* getResourceByName(IDnsResource* startFrom, size_t resourceCount, const std::string& name, bool exactMatch) const;
 
-		void parseResources();
+		void parseResources() const;
+		bool readRecord(size_t offsetInLayer, uint16_t index, DnsRecordInfo& record) const;
 
 		DnsResource* addResource(DnsResourceType resType, const std::string& name, DnsType dnsType, DnsClass dnsClass,
 				uint32_t ttl, IDnsResourceData* data);
@@ -480,6 +547,12 @@ namespace pcpp
 
 	};
 
+	template<>
+	struct LayerProtocolTag<DnsLayer>
+	{
+		static const ProtocolType value = DNS;
+	};
+
 
 
 	/**
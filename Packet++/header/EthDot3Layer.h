@@ -124,6 +124,12 @@ namespace pcpp
 		static bool isDataValid(const uint8_t* data, size_t dataLen);
 	};
 
+	template<>
+	struct LayerProtocolTag<EthDot3Layer>
+	{
+		static const ProtocolType value = EthernetDot3;
+	};
+
 } // namespace pcpp
 
 #endif // PACKETPP_ETH_DOT3_LAYER
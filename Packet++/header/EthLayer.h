@@ -163,6 +163,12 @@ namespace pcpp
 		static bool isDataValid(const uint8_t* data, size_t dataLen);
 	};
 
+	template<>
+	struct LayerProtocolTag<EthLayer>
+	{
+		static const ProtocolType value = Ethernet;
+	};
+
 } // namespace pcpp
 
 #endif /* PACKETPP_ETH_LAYER */
@@ -0,0 +1,497 @@
+#ifndef PACKETPP_FLOW_TABLE
+#define PACKETPP_FLOW_TABLE
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include <utility>
+#include "IpAddress.h"
+
+/// @file
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	class Packet;
+
+	/**
+	 * @struct FlowKey
+	 * The full 5-tuple (source and destination IP addresses, source and destination ports and IP protocol) of a TCP or UDP flow over IPv4
+	 * or IPv6. Unlike hash5Tuple() which reduces the 5-tuple to a 32-bit value, keys of different flows never compare equal, so a flow table
+	 * keyed by FlowKey can't merge two flows. The struct has no padding so it can be compared and hashed as a byte array
+	 */
+	struct FlowKey
+	{
+		/** The source IP address. IPv4 addresses occupy the first 4 bytes, the rest are zero */
+		uint8_t srcIP[16];
+		/** The destination IP address. IPv4 addresses occupy the first 4 bytes, the rest are zero */
+		uint8_t dstIP[16];
+		/** The source port (in host byte order) */
+		uint16_t srcPort;
+		/** The destination port (in host byte order) */
+		uint16_t dstPort;
+		/** The IP protocol number (IPPROTO_TCP or IPPROTO_UDP) */
+		uint8_t protocol;
+		/** The IP version (4 or 6), or 0 for a key that wasn't initialized from a packet */
+		uint8_t ipVersion;
+		/** Always zero */
+		uint8_t reserved[2];
+
+		/**
+		 * A c'tor that creates an empty key (all fields are zero). All packets that don't have a 5-tuple map to this key
+		 */
+		FlowKey() { memset(this, 0, sizeof(FlowKey)); }
+
+		/**
+		 * Initialize the key from the 5-tuple of a packet. The ports are taken from the last TCP or UDP layer in the packet and the IP
+		 * addresses from the IPv4 or IPv6 layer that carries it, so for tunneled traffic the key is the one of the inner flow. Like hash5Tuple(),
+		 * ICMP packets are considered as not having a 5-tuple
+		 * @param[in] packet The packet to take the 5-tuple from
+		 * @param[in] directionUnique If set to false (the default) both directions of a flow get the same key: the endpoints are ordered so the
+		 * one with the lower IP address (or the lower port if the addresses are equal) is the source. If set to true the key is the
+		 * 5-tuple exactly as it appears in the packet
+		 * @return True if the packet has a 5-tuple and the key was initialized, false otherwise. In this case the key is reset to an empty key
+		 */
+		bool initFromPacket(Packet* packet, bool directionUnique = false);
+
+		/**
+		 * @return True if the key was initialized from a packet, false if it's an empty key
+		 */
+		bool isValid() const { return ipVersion != 0; }
+
+		/**
+		 * @return The source IP address as an IPAddress object
+		 */
+		IPAddress getSrcIPAddress() const;
+
+		/**
+		 * @return The destination IP address as an IPAddress object
+		 */
+		IPAddress getDstIPAddress() const;
+
+		/**
+		 * @return A 64-bit hash of the key. Equal keys always have the same hash value
+		 */
+		uint64_t hash() const;
+
+		bool operator==(const FlowKey& other) const { return memcmp(this, &other, sizeof(FlowKey)) == 0; }
+		bool operator!=(const FlowKey& other) const { return !(*this == other); }
+	};
+
+
+	/**
+	 * @class FlowTable
+	 * A table that maps flows (identified by a FlowKey) to a user-defined value of type T. The table is meant to be used by anything that needs
+	 * to keep state per flow, for example stream reassembly or splitting capture files by connection.
+	 * The main characteristics of this table are:
+	 * - Entries are stored in one array using open addressing with linear probing and backward-shift deletion, so lookups don't chase
+	 *   pointers and no memory is allocated per flow
+	 * - The number of flows is bounded by a limit set in the c'tor. The array starts small and grows as flows are added, until it's big enough
+	 *   for the limit. When the table is full and a new flow arrives the least recently seen flow is evicted
+	 * - Each flow remembers the last time it was seen. If an idle timeout is set, flows that weren't seen for longer than the timeout are
+	 *   evicted when new flows are created or when purgeIdleFlows() is called
+	 * - The user can set a callback that is called for every evicted flow, with the reason for the eviction
+	 *
+	 * Flows are kept in a list ordered by the last time they were seen, which makes finding the least recently seen flow and the idle flows
+	 * an O(1) operation per flow. The order follows the order of the calls and not the timestamps passed to them, so when timestamps go back
+	 * in time idle flows are detected approximately.
+	 * T must be default-constructible and move-assignable. References and pointers to values returned by this class are valid only until the
+	 * next call that adds or removes flows
+	 */
+	template<typename T>
+	class FlowTable
+	{
+	public:
+
+		/**
+		 * An enum representing the reasons for a flow to be evicted from the table
+		 */
+		enum EvictionReason
+		{
+			/** The flow wasn't seen for longer than the idle timeout */
+			FlowIdleTimeout,
+			/** The table reached its maximum number of flows and this was the least recently seen flow */
+			FlowTableFull,
+			/** The table was cleared using clear() */
+			FlowTableCleared
+		};
+
+		/**
+		 * @typedef OnFlowEvicted
+		 * A callback invoked when a flow is evicted from the table, just before the flow is removed. The callback must not add or remove
+		 * flows from the table
+		 * @param[in] key The key of the evicted flow
+		 * @param[in] value The value of the evicted flow. The callback may move data out of it
+		 * @param[in] reason The reason for the eviction
+		 * @param[in] userCookie A pointer to the cookie provided by the user in the c'tor (or NULL if no cookie provided)
+		 */
+		typedef void (*OnFlowEvicted)(const FlowKey& key, T& value, EvictionReason reason, void* userCookie);
+
+		/**
+		 * A c'tor for this class
+		 * @param[in] maxNumOfFlows The maximum number of flows the table can hold. Must be greater than zero and lower than 2^30
+		 * @param[in] idleTimeoutSec The number of seconds after which a flow that wasn't seen is evicted. The default is 0 which means flows
+		 * aren't evicted because of idleness
+		 * @param[in] onFlowEvicted A callback that is called for every evicted flow. This parameter is optional
+		 * @param[in] userCookie A pointer to an object provided by the user which is passed to the eviction callback. This parameter is optional
+		 */
+		explicit FlowTable(size_t maxNumOfFlows, uint32_t idleTimeoutSec = 0, OnFlowEvicted onFlowEvicted = NULL, void* userCookie = NULL) :
+			m_MaxNumOfFlows(maxNumOfFlows), m_IdleTimeoutSec(idleTimeoutSec), m_OnFlowEvicted(onFlowEvicted), m_UserCookie(userCookie),
+			m_NumOfFlows(0), m_Mask(0), m_MaxNumOfSlots(0), m_Head(NoEntry), m_Tail(NoEntry)
+		{
+			if (m_MaxNumOfFlows == 0)
+				m_MaxNumOfFlows = 1;
+			if (m_MaxNumOfFlows > MaxNumOfFlowsLimit)
+				m_MaxNumOfFlows = MaxNumOfFlowsLimit;
+
+			// keep the load factor at 3/4 or lower
+			m_MaxNumOfSlots = roundUpToPowerOf2(m_MaxNumOfFlows + m_MaxNumOfFlows / 3 + 1);
+			size_t initialNumOfSlots = m_MaxNumOfSlots < InitialNumOfSlots ? m_MaxNumOfSlots : InitialNumOfSlots;
+			m_Slots.resize(initialNumOfSlots);
+			m_Mask = initialNumOfSlots - 1;
+		}
+
+		/**
+		 * Find a flow in the table without changing its last seen time
+		 * @param[in] key The flow key to look for
+		 * @return A pointer to the value of the flow or NULL if the flow isn't in the table
+		 */
+		T* find(const FlowKey& key)
+		{
+			uint32_t index = findSlot(key, hashKey(key));
+			return index == NoEntry ? NULL : &m_Slots[index].value;
+		}
+
+		/**
+		 * Find a flow in the table and mark it as seen at a certain time
+		 * @param[in] key The flow key to look for
+		 * @param[in] timestamp The time the flow was seen (in seconds)
+		 * @return A pointer to the value of the flow or NULL if the flow isn't in the table
+		 */
+		T* find(const FlowKey& key, time_t timestamp)
+		{
+			uint32_t index = findSlot(key, hashKey(key));
+			if (index == NoEntry)
+				return NULL;
+
+			touch(index, timestamp);
+			return &m_Slots[index].value;
+		}
+
+		/**
+		 * Find a flow in the table or create it if it doesn't exist, and mark it as seen at a certain time. Before a new flow is created,
+		 * flows that are idle for longer than the idle timeout are evicted, and if the table is full the least recently seen flow is evicted
+		 * @param[in] key The flow key to look for
+		 * @param[in] timestamp The time the flow was seen (in seconds)
+		 * @param[out] isNewFlow If not NULL, set to true if the flow was created by this call or to false if it already existed
+		 * @return A reference to the value of the flow. The value of a new flow is default-constructed
+		 */
+		T& findOrCreate(const FlowKey& key, time_t timestamp, bool* isNewFlow = NULL)
+		{
+			uint32_t hash = hashKey(key);
+			uint32_t index = findSlot(key, hash);
+			if (index != NoEntry)
+			{
+				touch(index, timestamp);
+				if (isNewFlow != NULL)
+					*isNewFlow = false;
+				return m_Slots[index].value;
+			}
+
+			if (m_IdleTimeoutSec > 0)
+				purgeIdleFlows(timestamp);
+
+			if (m_NumOfFlows >= m_MaxNumOfFlows)
+				evictSlot(m_Tail, FlowTableFull);
+
+			if ((m_NumOfFlows + 1) * 4 > m_Slots.size() * 3 && m_Slots.size() < m_MaxNumOfSlots)
+				grow();
+
+			index = hash & m_Mask;
+			while (m_Slots[index].inUse)
+				index = (index + 1) & m_Mask;
+
+			FlowEntry& entry = m_Slots[index];
+			entry.key = key;
+			entry.hash = hash;
+			entry.lastSeen = timestamp;
+			entry.inUse = true;
+			linkAtHead(index);
+			m_NumOfFlows++;
+
+			if (isNewFlow != NULL)
+				*isNewFlow = true;
+			return entry.value;
+		}
+
+		/**
+		 * Remove a flow from the table. The eviction callback isn't called for flows removed by this method
+		 * @param[in] key The key of the flow to remove
+		 * @return True if the flow was found and removed, false if it isn't in the table
+		 */
+		bool erase(const FlowKey& key)
+		{
+			uint32_t index = findSlot(key, hashKey(key));
+			if (index == NoEntry)
+				return false;
+
+			removeSlot(index);
+			return true;
+		}
+
+		/**
+		 * Evict all flows that weren't seen for longer than the idle timeout. The eviction callback is called for each of them with
+		 * FlowIdleTimeout as the reason. Does nothing if no idle timeout is set
+		 * @param[in] currentTime The current time (in seconds)
+		 * @return The number of flows evicted
+		 */
+		size_t purgeIdleFlows(time_t currentTime)
+		{
+			if (m_IdleTimeoutSec == 0)
+				return 0;
+
+			size_t numOfEvictedFlows = 0;
+			while (m_Tail != NoEntry && currentTime - m_Slots[m_Tail].lastSeen > (time_t)m_IdleTimeoutSec)
+			{
+				evictSlot(m_Tail, FlowIdleTimeout);
+				numOfEvictedFlows++;
+			}
+
+			return numOfEvictedFlows;
+		}
+
+		/**
+		 * Evict all flows in the table. The eviction callback is called for each of them with FlowTableCleared as the reason
+		 */
+		void clear()
+		{
+			while (m_Tail != NoEntry)
+				evictSlot(m_Tail, FlowTableCleared);
+		}
+
+		/**
+		 * Call a function for every flow in the table, from the least recently seen flow to the most recently seen one. The function
+		 * must not add or remove flows from the table
+		 * @param[in] func A function or a function object that is called with (const FlowKey& key, T& value) for every flow
+		 */
+		template<typename Func>
+		void forEachFlow(Func func)
+		{
+			for (uint32_t index = m_Tail; index != NoEntry; index = m_Slots[index].prev)
+				func(m_Slots[index].key, m_Slots[index].value);
+		}
+
+		/**
+		 * @return The number of flows currently in the table
+		 */
+		size_t getNumOfFlows() const { return m_NumOfFlows; }
+
+		/**
+		 * @return The maximum number of flows the table can hold
+		 */
+		size_t getMaxNumOfFlows() const { return m_MaxNumOfFlows; }
+
+		/**
+		 * @return The idle timeout in seconds, or 0 if flows aren't evicted because of idleness
+		 */
+		uint32_t getIdleTimeout() const { return m_IdleTimeoutSec; }
+
+	private:
+
+		static const uint32_t NoEntry = 0xFFFFFFFF;
+		static const size_t MaxNumOfFlowsLimit = 1 << 30;
+		static const size_t InitialNumOfSlots = 64;
+
+		struct FlowEntry
+		{
+			FlowKey key;
+			T value;
+			time_t lastSeen;
+			uint32_t hash;
+			// the neighbours in the list ordered by the last seen time. prev is the more recently seen flow
+			uint32_t prev;
+			uint32_t next;
+			bool inUse;
+
+			FlowEntry() : value(), lastSeen(0), hash(0), prev(NoEntry), next(NoEntry), inUse(false) {}
+		};
+
+		std::vector<FlowEntry> m_Slots;
+		size_t m_MaxNumOfFlows;
+		uint32_t m_IdleTimeoutSec;
+		OnFlowEvicted m_OnFlowEvicted;
+		void* m_UserCookie;
+		size_t m_NumOfFlows;
+		size_t m_Mask;
+		size_t m_MaxNumOfSlots;
+		// the most recently seen flow
+		uint32_t m_Head;
+		// the least recently seen flow
+		uint32_t m_Tail;
+
+		// the hash stored in each entry is only 32 bits, it's enough for indexing up to 2^31 slots
+		static uint32_t hashKey(const FlowKey& key)
+		{
+			uint64_t hash = key.hash();
+			return (uint32_t)(hash ^ (hash >> 32));
+		}
+
+		static size_t roundUpToPowerOf2(size_t value)
+		{
+			size_t result = 1;
+			while (result < value)
+				result <<= 1;
+			return result;
+		}
+
+		uint32_t findSlot(const FlowKey& key, uint32_t hash) const
+		{
+			uint32_t index = hash & m_Mask;
+			while (m_Slots[index].inUse)
+			{
+				if (m_Slots[index].hash == hash && m_Slots[index].key == key)
+					return index;
+				index = (index + 1) & m_Mask;
+			}
+
+			return NoEntry;
+		}
+
+		void linkAtHead(uint32_t index)
+		{
+			FlowEntry& entry = m_Slots[index];
+			entry.prev = NoEntry;
+			entry.next = m_Head;
+			if (m_Head != NoEntry)
+				m_Slots[m_Head].prev = index;
+			else
+				m_Tail = index;
+			m_Head = index;
+		}
+
+		void unlink(uint32_t index)
+		{
+			FlowEntry& entry = m_Slots[index];
+			if (entry.prev != NoEntry)
+				m_Slots[entry.prev].next = entry.next;
+			else
+				m_Head = entry.next;
+
+			if (entry.next != NoEntry)
+				m_Slots[entry.next].prev = entry.prev;
+			else
+				m_Tail = entry.prev;
+		}
+
+		void touch(uint32_t index, time_t timestamp)
+		{
+			m_Slots[index].lastSeen = timestamp;
+			if (index != m_Head)
+			{
+				unlink(index);
+				linkAtHead(index);
+			}
+		}
+
+		void evictSlot(uint32_t index, EvictionReason reason)
+		{
+			if (m_OnFlowEvicted != NULL)
+				m_OnFlowEvicted(m_Slots[index].key, m_Slots[index].value, reason, m_UserCookie);
+
+			removeSlot(index);
+		}
+
+		void releaseSlot(uint32_t index)
+		{
+			// drop the value so resources it holds are freed now and not when the slot is reused
+			m_Slots[index].value = T();
+			m_Slots[index].inUse = false;
+		}
+
+		// remove an entry and shift back the entries that follow it in the same probe sequence, so no tombstones are needed
+		void removeSlot(uint32_t index)
+		{
+			unlink(index);
+			releaseSlot(index);
+			m_NumOfFlows--;
+
+			uint32_t hole = index;
+			uint32_t next = (hole + 1) & m_Mask;
+			while (m_Slots[next].inUse)
+			{
+				uint32_t home = m_Slots[next].hash & m_Mask;
+				// the entry can move to the hole only if the hole isn't cyclically between its home slot and its current slot
+				bool canMove = (next > hole) ? (home <= hole || home > next) : (home <= hole && home > next);
+				if (canMove)
+				{
+					moveSlot(next, hole);
+					hole = next;
+				}
+
+				next = (next + 1) & m_Mask;
+			}
+		}
+
+		void moveSlot(uint32_t from, uint32_t to)
+		{
+			FlowEntry& source = m_Slots[from];
+			FlowEntry& target = m_Slots[to];
+			target.key = source.key;
+			target.value = std::move(source.value);
+			target.lastSeen = source.lastSeen;
+			target.hash = source.hash;
+			target.prev = source.prev;
+			target.next = source.next;
+			target.inUse = true;
+
+			if (target.prev != NoEntry)
+				m_Slots[target.prev].next = to;
+			else
+				m_Head = to;
+
+			if (target.next != NoEntry)
+				m_Slots[target.next].prev = to;
+			else
+				m_Tail = to;
+
+			releaseSlot(from);
+		}
+
+		void grow()
+		{
+			std::vector<FlowEntry> oldSlots(m_Slots.size() * 2);
+			oldSlots.swap(m_Slots);
+			m_Mask = m_Slots.size() - 1;
+
+			// re-insert from the least recently seen flow so the order of the list is kept
+			uint32_t oldIndex = m_Tail;
+			m_Head = NoEntry;
+			m_Tail = NoEntry;
+			while (oldIndex != NoEntry)
+			{
+				FlowEntry& oldEntry = oldSlots[oldIndex];
+				uint32_t index = oldEntry.hash & m_Mask;
+				while (m_Slots[index].inUse)
+					index = (index + 1) & m_Mask;
+
+				FlowEntry& entry = m_Slots[index];
+				entry.key = oldEntry.key;
+				entry.value = std::move(oldEntry.value);
+				entry.lastSeen = oldEntry.lastSeen;
+				entry.hash = oldEntry.hash;
+				entry.inUse = true;
+				linkAtHead(index);
+
+				oldIndex = oldEntry.prev;
+			}
+		}
+	};
+
+} // namespace pcpp
+
+#endif /* PACKETPP_FLOW_TABLE */
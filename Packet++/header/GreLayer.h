@@ -179,6 +179,12 @@ namespace pcpp
 		void computeCalculateFieldsInner();
 	};
 
+	template<>
+	struct LayerProtocolTag<GreLayer>
+	{
+		static const ProtocolType value = GRE;
+	};
+
 
 	/**
 	 * @class GREv0Layer
@@ -291,6 +297,12 @@ namespace pcpp
 
 	};
 
+	template<>
+	struct LayerProtocolTag<GREv0Layer>
+	{
+		static const ProtocolType value = GREv0;
+	};
+
 
 	/**
 	 * @class GREv1Layer
@@ -364,6 +376,12 @@ namespace pcpp
 
 	};
 
+	template<>
+	struct LayerProtocolTag<GREv1Layer>
+	{
+		static const ProtocolType value = GREv1;
+	};
+
 
 	/**
 	 * @class PPP_PPTPLayer
@@ -421,6 +439,12 @@ namespace pcpp
 
 	};
 
+	template<>
+	struct LayerProtocolTag<PPP_PPTPLayer>
+	{
+		static const ProtocolType value = PPP_PPTP;
+	};
+
 } // namespace pcpp
 
 #endif /* PACKETPP_GRE_LAYER */
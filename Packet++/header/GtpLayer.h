@@ -457,6 +457,12 @@ namespace pcpp
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelTransportLayer; }
 	};
+
+	template<>
+	struct LayerProtocolTag<GtpV1Layer>
+	{
+		static const ProtocolType value = GTPv1;
+	};
 }
 
 #endif //PACKETPP_GTP_LAYER
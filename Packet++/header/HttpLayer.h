@@ -218,6 +218,12 @@ namespace pcpp
 		HttpRequestFirstLine* m_FirstLine;
 	};
 
+	template<>
+	struct LayerProtocolTag<HttpRequestLayer>
+	{
+		static const ProtocolType value = HTTPRequest;
+	};
+
 	// -------- Class HttpResponseStatusCode -----------------
 
 	/**
@@ -587,6 +593,12 @@ namespace pcpp
 
 	};
 
+	template<>
+	struct LayerProtocolTag<HttpResponseLayer>
+	{
+		static const ProtocolType value = HTTPResponse;
+	};
+
 
 
 
@@ -0,0 +1,318 @@
+#ifndef PACKETPP_HTTP_REASSEMBLY
+#define PACKETPP_HTTP_REASSEMBLY
+
+#include "TcpReassembly.h"
+#include "HttpLayer.h"
+#include <unordered_map>
+#include <deque>
+#include <vector>
+#include <string>
+
+
+/**
+ * @file
+ * An incremental HTTP/1.x message parser working on top of pcpp#TcpReassembly. While pcpp#HttpRequestLayer and pcpp#HttpResponseLayer parse
+ * a single TCP segment, so they only see the part of the message that fits in the first segment, pcpp#HttpReassembly follows the reassembled TCP
+ * stream of each connection and finds the boundaries of every HTTP message in it.
+ *
+ * __General Features:__
+ * - Headers spanning multiple TCP segments
+ * - Bodies delimited by Content-Length, by chunked transfer encoding or by the end of the connection
+ * - Pipelined requests, which are matched to their responses in order to report complete transactions (request + response) with their latency and sizes
+ * - Responses without a body (HEAD requests, 1xx, 204 and 304 responses) and protocol switches (101 responses and CONNECT tunnels), after which
+ *   the connection is no longer parsed
+ * - Missing TCP data: missing bytes inside a Content-Length body or a body delimited by the end of the connection are skipped, otherwise the message
+ *   is reported as incomplete and parsing resumes on the next HTTP start line seen on that side
+ *
+ * __Zero-copy and bounded memory:__
+ * Body data is handed to the user as pointers into the buffers of pcpp#TcpStreamData, it's never copied. Headers are handed to the user in place too
+ * when they're contained in a single TCP segment. Only headers (and chunk size lines) spanning multiple segments are buffered, and this buffer is limited
+ * by pcpp#HttpReassemblyConfiguration#maxHeaderSize - a side whose header exceeds the limit stops being parsed. The number of requests waiting for
+ * their responses is limited by pcpp#HttpReassemblyConfiguration#maxPendingRequests
+ *
+ * __Basic Usage and APIs:__
+ * - pcpp#HttpReassembly c'tor - Create an instance, provide the callbacks and the user cookie to the instance
+ * - Create a pcpp#TcpReassembly instance with pcpp#HttpReassembly#tcpMessageReadyCallback and pcpp#HttpReassembly#tcpConnectionEndCallback as its
+ *   callbacks and the pcpp#HttpReassembly instance as the user cookie, or call pcpp#HttpReassembly#onTcpMessageReady() and
+ *   pcpp#HttpReassembly#onTcpConnectionEnd() from existing pcpp#TcpReassembly callbacks
+ * - pcpp#HttpReassembly#OnHttpMessageHeaders callback - Invoked when the header of a message was fully received
+ * - pcpp#HttpReassembly#OnHttpMessageBody callback - Invoked for every piece of body data, after removing the chunked encoding framing
+ * - pcpp#HttpReassembly#OnHttpMessageEnd callback - Invoked when a message ends
+ * - pcpp#HttpReassembly#OnHttpTransactionEnd callback - Invoked when a response ends, together with the request it answers
+ *
+ * All callbacks are invoked from within pcpp#HttpReassembly#onTcpMessageReady() or pcpp#HttpReassembly#onTcpConnectionEnd(), so when used with
+ * pcpp#ShardedTcpReassembly a separate pcpp#HttpReassembly instance is needed per shard
+ */
+
+/**
+ * @namespace pcpp
+ * @brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+/**
+ * @struct HttpMessageData
+ * Information about an HTTP message found by pcpp#HttpReassembly
+ */
+struct HttpMessageData
+{
+	/** True if the message is a request, false if it's a response */
+	bool isRequest;
+	/** The side of the TCP connection the message was sent from, as in pcpp#TcpReassembly#OnTcpMessageReady */
+	int8_t side;
+	/** The flow key of the TCP connection */
+	uint32_t flowKey;
+	/** The request method. For responses it's the method of the request the response answers, or HttpMethodUnknown if it's not known */
+	HttpRequestLayer::HttpMethod method;
+	/** The response status code (e.g 200, 404, etc.) or 0 for requests */
+	int statusCode;
+	/**
+	 * A pointer to the message header (start line, header fields and the empty line ending them). It's only valid during the
+	 * pcpp#HttpReassembly#OnHttpMessageHeaders callback and is NULL in the other callbacks
+	 */
+	const uint8_t* header;
+	/** The size of the message header in bytes */
+	size_t headerLength;
+	/** The value of the Content-Length header field, or -1 if the message doesn't have one */
+	int64_t contentLength;
+	/** True if the message body uses the chunked transfer encoding */
+	bool isChunked;
+	/** The number of body bytes seen so far, excluding the chunked encoding framing and missing bytes */
+	uint64_t bodyLength;
+	/** The number of bytes the message took on the wire so far, including header, chunked encoding framing and missing bytes */
+	uint64_t wireLength;
+	/** True if some of the message bytes were missing in the TCP stream */
+	bool isBytesMissing;
+	/** True if the message ended as described by its header. It's false if the connection ended or data was lost before the message ended */
+	bool isComplete;
+	/** The timestamp of the packet containing the start of the message */
+	timeval startTime;
+	/** The timestamp of the packet containing the end of the message, or of the last packet seen if the message didn't end yet */
+	timeval endTime;
+
+	/**
+	 * A c'tor for this struct that basically zeros all members
+	 */
+	HttpMessageData() : isRequest(false), side(0), flowKey(0), method(HttpRequestLayer::HttpMethodUnknown), statusCode(0), header(nullptr), headerLength(0),
+		contentLength(-1), isChunked(false), bodyLength(0), wireLength(0), isBytesMissing(false), isComplete(false), startTime(), endTime() {}
+
+	/**
+	 * Get a header field value. The lookup is case-insensitive and the value is trimmed from surrounding white spaces. This method can only be
+	 * used during the pcpp#HttpReassembly#OnHttpMessageHeaders callback
+	 * @param[in] fieldName The field name
+	 * @return The value of the first field with this name, or an empty string if the header doesn't contain such a field
+	 */
+	std::string getFieldValue(const std::string& fieldName) const;
+
+	/**
+	 * @return The request URI as it appears in the start line, or an empty string if the message isn't a request. Can only be used during the
+	 * pcpp#HttpReassembly#OnHttpMessageHeaders callback
+	 */
+	std::string getUri() const;
+};
+
+
+/**
+ * @struct HttpReassemblyConfiguration
+ * A structure for configuring the HttpReassembly class
+ */
+struct HttpReassemblyConfiguration
+{
+	/** The maximum size of a message header (or a chunk size line) that can be buffered when it spans multiple TCP segments. A side of a connection whose
+	 * header exceeds this size stops being parsed
+	 */
+	size_t maxHeaderSize;
+
+	/** The maximum number of requests per connection that can wait for their responses. When a request exceeds this number, the
+	 * requests of the connection are no longer matched to responses (the messages themselves are still reported)
+	 */
+	size_t maxPendingRequests;
+
+	/**
+	 * A c'tor for this struct
+	 * @param[in] maxHeaderSize The maximum size of a buffered message header. The default is 64KB
+	 * @param[in] maxPendingRequests The maximum number of requests waiting for their responses per connection. The default is 64
+	 */
+	explicit HttpReassemblyConfiguration(size_t maxHeaderSize = 65536, size_t maxPendingRequests = 64) : maxHeaderSize(maxHeaderSize), maxPendingRequests(maxPendingRequests)
+	{
+	}
+};
+
+
+/**
+ * @class HttpReassembly
+ * A class that finds HTTP/1.x messages in reassembled TCP streams. Please refer to the documentation at the top of HttpReassembly.h for understanding
+ * how to use this class
+ */
+class HttpReassembly
+{
+public:
+
+	/**
+	 * @typedef OnHttpMessageHeaders
+	 * A callback invoked when the header of a message was fully received
+	 * @param[in] message The message information. Its header and headerLength members point to the message header
+	 * @param[in] userCookie A pointer to the cookie provided by the user in the pcpp#HttpReassembly c'tor (or NULL if no cookie provided)
+	 */
+	typedef void (*OnHttpMessageHeaders)(const HttpMessageData& message, void* userCookie);
+
+	/**
+	 * @typedef OnHttpMessageBody
+	 * A callback invoked for every piece of body data of a message
+	 * @param[in] message The message information
+	 * @param[in] data A pointer to the body data. It points into the buffer of the pcpp#TcpStreamData being processed so it's only valid during
+	 * the callback
+	 * @param[in] dataLen The size of the body data
+	 * @param[in] userCookie A pointer to the cookie provided by the user in the pcpp#HttpReassembly c'tor (or NULL if no cookie provided)
+	 */
+	typedef void (*OnHttpMessageBody)(const HttpMessageData& message, const uint8_t* data, size_t dataLen, void* userCookie);
+
+	/**
+	 * @typedef OnHttpMessageEnd
+	 * A callback invoked when a message ends, either as described by its header or because the connection ended or data was lost
+	 * @param[in] message The message information
+	 * @param[in] userCookie A pointer to the cookie provided by the user in the pcpp#HttpReassembly c'tor (or NULL if no cookie provided)
+	 */
+	typedef void (*OnHttpMessageEnd)(const HttpMessageData& message, void* userCookie);
+
+	/**
+	 * @typedef OnHttpTransactionEnd
+	 * A callback invoked when a response ends, together with the request it answers. The latency of the transaction is the time between the
+	 * end of the request and the start of the response
+	 * @param[in] request The request information
+	 * @param[in] response The response information
+	 * @param[in] userCookie A pointer to the cookie provided by the user in the pcpp#HttpReassembly c'tor (or NULL if no cookie provided)
+	 */
+	typedef void (*OnHttpTransactionEnd)(const HttpMessageData& request, const HttpMessageData& response, void* userCookie);
+
+	/**
+	 * A c'tor for this class
+	 * @param[in] onMessageEndCallback The callback to be invoked when a message ends. This parameter is optional
+	 * @param[in] userCookie A pointer to an object provided by the user. This pointer will be returned when invoking the various callbacks.
+	 * This parameter is optional, default cookie is NULL
+	 * @param[in] onTransactionEndCallback The callback to be invoked when a response ends. This parameter is optional
+	 * @param[in] onMessageHeadersCallback The callback to be invoked when the header of a message was received. This parameter is optional
+	 * @param[in] onMessageBodyCallback The callback to be invoked for every piece of body data. This parameter is optional
+	 * @param[in] config Optional parameter for defining special configuration parameters. If not set the default parameters will be set
+	 */
+	explicit HttpReassembly(OnHttpMessageEnd onMessageEndCallback = NULL, void* userCookie = NULL, OnHttpTransactionEnd onTransactionEndCallback = NULL,
+		OnHttpMessageHeaders onMessageHeadersCallback = NULL, OnHttpMessageBody onMessageBodyCallback = NULL,
+		const HttpReassemblyConfiguration& config = HttpReassemblyConfiguration());
+
+	/**
+	 * Process a piece of a reassembled TCP stream. Should be called from the pcpp#TcpReassembly#OnTcpMessageReady callback
+	 * @param[in] side The side of the connection the data belongs to
+	 * @param[in] tcpData The TCP data and connection information
+	 */
+	void onTcpMessageReady(int8_t side, const TcpStreamData& tcpData);
+
+	/**
+	 * Notify that a TCP connection ended. Messages whose body is delimited by the end of the connection end successfully, other messages in
+	 * progress are reported as incomplete. The connection state is then freed. Should be called from the pcpp#TcpReassembly#OnTcpConnectionEnd callback
+	 * @param[in] connectionData The connection information
+	 */
+	void onTcpConnectionEnd(const ConnectionData& connectionData);
+
+	/**
+	 * End all connections, as if pcpp#HttpReassembly#onTcpConnectionEnd() was called for each of them
+	 */
+	void closeAllConnections();
+
+	/**
+	 * A pcpp#TcpReassembly#OnTcpMessageReady callback that can be given to pcpp#TcpReassembly directly
+	 * @param[in] side The side of the connection the data belongs to
+	 * @param[in] tcpData The TCP data and connection information
+	 * @param[in] userCookie A pointer to the pcpp#HttpReassembly instance
+	 */
+	static void tcpMessageReadyCallback(int8_t side, const TcpStreamData& tcpData, void* userCookie);
+
+	/**
+	 * A pcpp#TcpReassembly#OnTcpConnectionEnd callback that can be given to pcpp#TcpReassembly directly
+	 * @param[in] connectionData The connection information
+	 * @param[in] reason The reason the connection ended
+	 * @param[in] userCookie A pointer to the pcpp#HttpReassembly instance
+	 */
+	static void tcpConnectionEndCallback(const ConnectionData& connectionData, TcpReassembly::ConnectionEndReason reason, void* userCookie);
+
+	/**
+	 * @return The number of connections currently followed
+	 */
+	size_t getConnectionCount() const { return m_Connections.size(); }
+
+	/**
+	 * @return The number of bytes currently buffered for headers spanning multiple TCP segments in all connections
+	 */
+	size_t getBufferedDataSize() const;
+
+private:
+
+	enum ParserState
+	{
+		// waiting for a start line, possibly preceded by empty lines
+		StateHeader,
+		StateFixedBody,
+		StateChunkSize,
+		StateChunkData,
+		StateChunkDataEnd,
+		StateChunkTrailer,
+		StateBodyUntilClose,
+		// data was lost or couldn't be parsed, waiting for a start line at the beginning of a line
+		StateResync,
+		// the protocol was switched or the header was too long, the rest of the data on this side is ignored
+		StateIgnore
+	};
+
+	enum SideRole
+	{
+		RoleUnknown,
+		RoleClient,
+		RoleServer
+	};
+
+	struct HttpSideState
+	{
+		ParserState state;
+		SideRole role;
+		bool inMessage;
+		uint64_t bytesRemaining;
+		HttpMessageData message;
+		std::vector<uint8_t> lineBuffer;
+
+		HttpSideState() : state(StateHeader), role(RoleUnknown), inMessage(false), bytesRemaining(0) {}
+	};
+
+	struct HttpConnectionState
+	{
+		HttpSideState sides[2];
+		std::deque<HttpMessageData> pendingRequests;
+		// true once a request or a response was lost, from then on responses can't be matched to requests
+		bool outOfSync;
+
+		HttpConnectionState() : outOfSync(false) {}
+	};
+
+	typedef std::unordered_map<uint32_t, HttpConnectionState> ConnectionStateMap;
+
+	ConnectionStateMap m_Connections;
+	OnHttpMessageEnd m_OnMessageEnd;
+	OnHttpTransactionEnd m_OnTransactionEnd;
+	OnHttpMessageHeaders m_OnMessageHeaders;
+	OnHttpMessageBody m_OnMessageBody;
+	void* m_UserCookie;
+	HttpReassemblyConfiguration m_Config;
+
+	size_t processHeader(HttpConnectionState& conn, HttpSideState& sideState, const uint8_t* data, size_t dataLen, const timeval& timestamp);
+	bool parseHeader(HttpConnectionState& conn, HttpSideState& sideState, const uint8_t* header, size_t headerLen);
+	size_t processChunkLine(HttpConnectionState& conn, HttpSideState& sideState, const uint8_t* data, size_t dataLen);
+	bool readLine(HttpSideState& sideState, const uint8_t* data, size_t dataLen, size_t& consumed, const uint8_t*& line, size_t& lineLen);
+	size_t findStartLine(const HttpSideState& sideState, const uint8_t* data, size_t dataLen) const;
+	void handleMissingData(HttpConnectionState& conn, HttpSideState& sideState, size_t missingBytes);
+	void handleBody(HttpSideState& sideState, const uint8_t* data, size_t dataLen);
+	void endMessage(HttpConnectionState& conn, HttpSideState& sideState, bool isComplete);
+	void endConnection(HttpConnectionState& conn);
+};
+
+} // namespace pcpp
+
+#endif // PACKETPP_HTTP_REASSEMBLY
@@ -5,7 +5,7 @@
 #include "LRUList.h"
 #include "IpAddress.h"
 #include "PointerVector.h"
-#include <map>
+#include <vector>
 
 /**
  * @file
@@ -19,13 +19,16 @@
  * The logic works as follows:
  * - There is an internal map that stores the reassembly data for each packet. The key to this map, meaning the way to uniquely associate a
  *   fragment to a (reassembled) packet is the triplet of source IP, destination IP and IP ID (for IPv4) or Fragment ID (for IPv6)
- * - When the first fragment arrives a new record is created in the map and the fragment data is copied
- * - With each fragment arriving the fragment data is copied right after the previous fragment and the reassembled packet is gradually being built
- * - When the last fragment arrives the packet is fully reassembled and returned to the user. Since all fragment data is copied, the packet pointer
- *   returned to the user has to be freed by the user when done using it
- * - The logic supports out-of-order fragments, meaning that a fragment which arrives out-of-order, its data will be copied to a list of out-of-order
- *   fragments where it waits for its turn. This list is observed each time a new fragment arrives to see if the next fragment(s) wait(s) in this
- *   list
+ * - When the first fragment arrives a new record is created in the map and a reassembly buffer is allocated for the packet. The buffer is sized
+ *   from the offset and length of the fragment (or exactly, once the last fragment was seen) and grows geometrically if needed
+ * - The data of each fragment arriving is copied to its place in the reassembly buffer, so the reassembled packet is gradually being built in place
+ * - When the last fragment arrives the packet is fully reassembled and returned to the user. The reassembly buffer is handed over to the returned
+ *   packet, so the packet pointer returned to the user has to be freed by the user when done using it
+ * - The logic supports out-of-order fragments, meaning that a fragment which arrives out-of-order, its data is copied to a separate buffer of the
+ *   packet where the data of out-of-order fragments is packed, and it's added to a list of out-of-order fragments where it waits for its turn.
+ *   This list is observed each time a new fragment arrives to see if the next fragment(s) wait(s) in this list, and their data is then copied to
+ *   its place in the reassembly buffer. This way the reassembly buffer grows only with the data received in order, so fragments with high offsets
+ *   don't make it as large as the whole packet
  * - If a non-IP packet arrives it's returned as is to the user
  * - If a non-fragment packet arrives it's returned as is to the user
  *
@@ -34,7 +37,16 @@
  * c'tor). Once capacity (the number of concurrent reassembled packets) exceeds this number, the packet that was least recently used will be
  * dropped from the map along with all the data that was reassembled so far. This means that if the next fragment from this packet suddenly
  * appears it will be treated as a new reassembled packet (which will create another record in the map). The user can be notified when
- * reassembled packets are removed from the map by registering to the pcpp#IPReassembly#OnFragmentsClean callback in pcpp#IPReassembly c'tor
+ * reassembled packets are removed from the map by registering to the pcpp#IPReassembly#OnFragmentsClean callback in pcpp#IPReassembly c'tor.<BR>
+ *
+ * Since every stored fragment costs memory, the number of packets alone doesn't bound the memory an attacker sending incomplete fragmented
+ * packets can make this mechanism hold. Therefore an optional budget for the total size of the reassembly and out-of-order buffers can be set in
+ * the c'tor as well.
+ * When a fragment doesn't fit in the budget the least recently used packets are dropped (and the pcpp#IPReassembly#OnFragmentsClean callback is
+ * fired for them) until it fits. If it can't fit even after all other packets were dropped, the fragment itself is dropped. The bytes currently
+ * held and the number of fragments dropped so far can be retrieved using pcpp#IPReassembly#getCurrentBytesHeld() and
+ * pcpp#IPReassembly#getNumOfDroppedFragments(). With a budget, an out-of-order fragment overlapping another out-of-order fragment of the
+ * same packet is dropped as well, so duplicated fragments can't use up the budget
  */
 
 /**
@@ -310,10 +322,14 @@ namespace pcpp
 			FRAGMENT =              0x04,
 			/** The processed fragment is not the fragment that was expected at this time */
 			OUT_OF_ORDER_FRAGMENT = 0x08,
-			/** The processed fragment is malformed, meaning a fragment which has offset of zero but isn't the first fragment */
+			/** The processed fragment is malformed, meaning a fragment which has offset of zero but isn't the first fragment, or it completed a
+			 * packet whose IP layer can't be parsed, in which case the packet is dropped */
 			MALFORMED_FRAGMENT =    0x10,
 			/** Packet is now fully reassembled */
-			REASSEMBLED =           0x20
+			REASSEMBLED =           0x20,
+			/** The processed fragment was dropped because a memory budget is set and either storing it would exceed the budget or it overlaps
+			 * an out-of-order fragment which is already stored */
+			FRAGMENT_DROPPED =      0x40
 		};
 
 		/**
@@ -323,9 +339,13 @@ namespace pcpp
 		 * @param[in] callbackUserCookie A pointer to an object provided by the user. This pointer will be returned when invoking the
 		 * onFragmentsCleanCallback. This parameter is optional, default cookie is NULL
 		 * @param[in] maxPacketsToStore Set the capacity limit of the IP reassembly mechanism. Default capacity is #PCPP_IP_REASSEMBLY_DEFAULT_MAX_PACKETS_TO_STORE
+		 * @param[in] maxBytesToStore Set the limit in bytes for the total size of the reassembly and out-of-order buffers of all packets being reassembled. Please read more
+		 * about the memory budget in IPReassembly.h file description. This parameter is optional, default value is 0 which means no limit
 		 */
-		explicit IPReassembly(OnFragmentsClean onFragmentsCleanCallback = NULL, void *callbackUserCookie = NULL, size_t maxPacketsToStore = PCPP_IP_REASSEMBLY_DEFAULT_MAX_PACKETS_TO_STORE)
-			: m_PacketLRU(maxPacketsToStore), m_OnFragmentsCleanCallback(onFragmentsCleanCallback), m_CallbackUserCookie(callbackUserCookie) {}
+		explicit IPReassembly(OnFragmentsClean onFragmentsCleanCallback = NULL, void *callbackUserCookie = NULL, size_t maxPacketsToStore = PCPP_IP_REASSEMBLY_DEFAULT_MAX_PACKETS_TO_STORE,
+			size_t maxBytesToStore = 0)
+			: m_PacketLRU(maxPacketsToStore), m_OnFragmentsCleanCallback(onFragmentsCleanCallback), m_CallbackUserCookie(callbackUserCookie),
+			m_MaxBytesToStore(maxBytesToStore), m_CurrentBytesHeld(0), m_NumOfDroppedFragments(0) {}
 
 		/**
 		 * A d'tor for this class
@@ -422,39 +442,116 @@ namespace pcpp
 		/**
 		 * Get the current number of packets being processed
 		 */
-		size_t getCurrentCapacity() const { return m_FragmentMap.size(); }
+		size_t getCurrentCapacity() const { return m_PacketLRU.getSize(); }
+
+		/**
+		 * @return The memory budget in bytes as determined in the c'tor, or 0 if there is no limit
+		 */
+		size_t getMaxBytesToStore() const { return m_MaxBytesToStore; }
+
+		/**
+		 * @return The total size in bytes of the reassembly and out-of-order buffers of all packets currently being reassembled
+		 */
+		size_t getCurrentBytesHeld() const { return m_CurrentBytesHeld; }
+
+		/**
+		 * @return The number of fragments dropped so far. This includes fragments that were dropped because they didn't fit in the memory budget,
+		 * were malformed, duplicated or overlapping, and the fragments stored for packets that were removed from the map due to the capacity limit
+		 * or the memory budget. Packets removed by the user using removePacket() aren't counted
+		 */
+		uint64_t getNumOfDroppedFragments() const { return m_NumOfDroppedFragments; }
 
 	private:
 
+		// an out-of-order fragment whose data is stored in the out-of-order buffer, waiting for the data before it to arrive
 		struct IPFragment
 		{
-			uint16_t fragmentOffset;
+			uint32_t fragmentOffset;
+			uint32_t fragmentDataLen;
+			// the offset of the fragment data in the out-of-order buffer
+			uint32_t dataOffset;
 			bool lastFragment;
-			uint8_t* fragmentData;
-			size_t fragmentDataLen;
-			IPFragment() { fragmentOffset = 0; lastFragment = false; fragmentData = NULL; fragmentDataLen = 0; }
-			~IPFragment() { delete [] fragmentData; }
 		};
 
+		// the reassembly state of a single packet. These objects are pooled and reused, so they're allocated only when the number of packets
+		// being reassembled reaches a new high
 		struct IPFragmentData
 		{
-			uint16_t currentOffset;
-			RawPacket* data;
-			bool deleteData;
+			// the buffer starts with a headroom for the headers of the first fragment (including the link layer), followed by the IP payload
+			uint8_t* buffer;
+			size_t bufferLen;
+			size_t headroom;
+			// 0 until the first fragment arrives
+			size_t headerLen;
+			size_t ipHeaderOffset;
+			// the number of payload bytes reassembled so far from offset 0
+			uint32_t currentOffset;
+			// the IP payload length, known once the last fragment arrives. 0 until then
+			uint32_t totalPayloadLen;
+			uint32_t fragmentID;
+			uint32_t numOfFragments;
+			ProtocolType protocol;
+			timespec timestamp;
+			LinkLayerType linkLayerType;
+			// the data of the out-of-order fragments, packed one after the other
+			uint8_t* outOfOrderBuffer;
+			size_t outOfOrderBufferLen;
+			size_t outOfOrderDataLen;
+			std::vector<IPFragment> outOfOrderFragments;
+
+			IPFragmentData() : buffer(NULL), bufferLen(0), outOfOrderBuffer(NULL), outOfOrderBufferLen(0) { reset(0, UnknownProtocol); }
+			~IPFragmentData() { delete [] buffer; delete [] outOfOrderBuffer; }
+			void reset(uint32_t fragId, ProtocolType ipProtocol);
+		};
+
+		// a value-type key of a packet being reassembled. Unlike PacketKey it doesn't need to be allocated, and keys are compared in full so
+		// packets whose hash values collide are never mixed
+		struct FragmentKey
+		{
+			uint32_t hash;
 			uint32_t fragmentID;
-			PacketKey* packetKey;
-			PointerVector<IPFragment> outOfOrderFragments;
-			IPFragmentData(PacketKey* pktKey, uint32_t fragId) { currentOffset = 0; data = NULL; deleteData = true; fragmentID = fragId; packetKey = pktKey; }
-			~IPFragmentData() { delete packetKey; if (deleteData && data != NULL) { delete data; } }
+			ProtocolType protocol;
+			uint8_t srcIP[16];
+			uint8_t dstIP[16];
+		};
+
+		struct FragmentEntry
+		{
+			FragmentKey key;
+			IPFragmentData* data;
+		};
+
+		struct FragmentEntryHash
+		{
+			size_t operator()(const FragmentEntry& entry) const { return entry.key.hash; }
+		};
+
+		struct FragmentEntryEqual
+		{
+			bool operator()(const FragmentEntry& first, const FragmentEntry& second) const;
 		};
 
-		LRUList<uint32_t> m_PacketLRU;
-		std::map<uint32_t, IPFragmentData*> m_FragmentMap;
+		// the LRU list is also the map of packets being reassembled: each element holds the reassembly state of its packet
+		HashedLRUList<FragmentEntry, FragmentEntryHash, FragmentEntryEqual> m_PacketLRU;
+		std::vector<IPFragmentData*> m_FragmentDataPool;
+		std::vector<IPFragmentData*> m_FreeFragmentData;
 		OnFragmentsClean m_OnFragmentsCleanCallback;
 		void* m_CallbackUserCookie;
-
-		void addNewFragment(uint32_t hash, IPFragmentData* fragData);
+		size_t m_MaxBytesToStore;
+		size_t m_CurrentBytesHeld;
+		uint64_t m_NumOfDroppedFragments;
+		// used for parsing fragments given as RawPacket objects
+		Packet m_FragmentPacket;
+
+		static void createFragmentKey(const PacketKey& packetKey, FragmentKey& fragKey);
+		IPFragmentData* getFragmentData(const FragmentKey& fragKey, uint32_t fragmentID);
+		void releaseFragmentData(IPFragmentData* fragData);
+		void dropPacket(const FragmentEntry& entry);
+		bool makeRoomInBudget(IPFragmentData* fragData, size_t bytesToAdd);
+		bool reserveBuffer(IPFragmentData* fragData, size_t headroom, size_t payloadLen);
+		bool reserveOutOfOrderBuffer(IPFragmentData* fragData, size_t dataLen);
 		bool matchOutOfOrderFragments(IPFragmentData* fragData);
+		Packet* createReassembledPacket(IPFragmentData* fragData, uint8_t* data, ProtocolType parseUntil, OsiModelLayer parseUntilLayer);
 	};
 
 } // namespace pcpp
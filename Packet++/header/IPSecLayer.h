@@ -125,6 +125,12 @@ namespace pcpp
 		AuthenticationHeaderLayer() {}
 	};
 
+	template<>
+	struct LayerProtocolTag<AuthenticationHeaderLayer>
+	{
+		static const ProtocolType value = AuthenticationHeader;
+	};
+
 
 
 	/**
@@ -188,6 +194,12 @@ namespace pcpp
 		ESPLayer() {}
 	};
 
+	template<>
+	struct LayerProtocolTag<ESPLayer>
+	{
+		static const ProtocolType value = ESP;
+	};
+
 
 	// implementation of inline methods
 
@@ -474,10 +474,11 @@ namespace pcpp
 		IPv4Address getSrcIPv4Address() const { return getIPv4Header()->ipSrc; }
 
 		/**
-		 * Set the source IP address
+		 * Set the source IP address. The IPv4 header checksum and the checksum of the next layer (if it's TCP or UDP) are updated
+		 * incrementally (RFC 1624) so they stay valid without recomputing them over the packet data
 		 * @param[in] ipAddr The IP address to set
 		 */
-		void setSrcIPv4Address(const IPv4Address& ipAddr) { getIPv4Header()->ipSrc = ipAddr.toInt(); }
+		void setSrcIPv4Address(const IPv4Address& ipAddr);
 
 		/**
 		 * Get the destination IP address in the form of IPAddress. This method is very similar to getDstIPv4Address(),
@@ -493,10 +494,17 @@ namespace pcpp
 		IPv4Address getDstIPv4Address() const { return getIPv4Header()->ipDst; }
 
 		/**
-		 * Set the dest IP address
+		 * Set the dest IP address. The IPv4 header checksum and the checksum of the next layer (if it's TCP or UDP) are updated
+		 * incrementally (RFC 1624) so they stay valid without recomputing them over the packet data
 		 * @param[in] ipAddr The IP address to set
 		 */
-		void setDstIPv4Address(const IPv4Address& ipAddr) { getIPv4Header()->ipDst = ipAddr.toInt(); }
+		void setDstIPv4Address(const IPv4Address& ipAddr);
+
+		/**
+		 * Set the time to live value. The IPv4 header checksum is updated incrementally (RFC 1624)
+		 * @param[in] timeToLive The time to live value to set
+		 */
+		void setTimeToLive(uint8_t timeToLive);
 
 		/**
 		 * @return True if this packet is a fragment (in sense of IP fragmentation), false otherwise
@@ -645,6 +653,12 @@ namespace pcpp
 		void initLayerInPacket(bool setTotalLenAsDataLen);
 	};
 
+	template<>
+	struct LayerProtocolTag<IPv4Layer>
+	{
+		static const ProtocolType value = IPv4;
+	};
+
 
 	// implementation of inline methods
 
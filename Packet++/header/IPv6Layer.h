@@ -112,17 +112,19 @@ namespace pcpp
 		IPv6Address getSrcIPv6Address() const { return getIPv6Header()->ipSrc; }
 
 		/**
-		 * Set the source IP address
+		 * Set the source IP address. The checksum of the next layer (if it's TCP or UDP) is updated incrementally (RFC 1624) so it
+		 * stays valid without recomputing it over the packet data
 		 * @param[in] ipAddr The IP address to set
 		 */
-		void setSrcIPv6Address(const IPv6Address& ipAddr) { ipAddr.copyTo(getIPv6Header()->ipSrc); }
+		void setSrcIPv6Address(const IPv6Address& ipAddr);
 
 
 		/**
-		 * Set the dest IP address
+		 * Set the dest IP address. The checksum of the next layer (if it's TCP or UDP) is updated incrementally (RFC 1624) so it
+		 * stays valid without recomputing it over the packet data
 		 * @param[in] ipAddr The IP address to set
 		 */
-		void setDstIPv6Address(const IPv6Address& ipAddr) { ipAddr.copyTo(getIPv6Header()->ipDst); }
+		void setDstIPv6Address(const IPv6Address& ipAddr);
 
 		/**
 		 * Get the destination IP address in the form of IPAddress. This method is very similar to getDstIPv6Address(),
@@ -224,6 +226,12 @@ namespace pcpp
 		size_t m_ExtensionsLen;
 	};
 
+	template<>
+	struct LayerProtocolTag<IPv6Layer>
+	{
+		static const ProtocolType value = IPv6;
+	};
+
 
 	template<class TIPv6Extension>
 	TIPv6Extension* IPv6Layer::getExtensionOfType() const
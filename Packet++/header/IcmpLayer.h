@@ -706,6 +706,12 @@ namespace pcpp
 		OsiModelLayer getOsiModelLayer() const { return OsiModelNetworkLayer; }
 	};
 
+	template<>
+	struct LayerProtocolTag<IcmpLayer>
+	{
+		static const ProtocolType value = ICMP;
+	};
+
 	// implementation of inline methods
 
 	bool IcmpLayer::isDataValid(const uint8_t* data, size_t dataLen)
@@ -212,6 +212,12 @@ private:
 	icmpv6hdr *getIcmpv6Header() const { return (icmpv6hdr *)m_Data; }
 };
 
+template<>
+struct LayerProtocolTag<IcmpV6Layer>
+{
+	static const ProtocolType value = ICMPv6;
+};
+
 /**
  * @class ICMPv6EchoLayer
  * Represents an ICMPv6 echo request/reply protocol layer
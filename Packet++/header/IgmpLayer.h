@@ -230,6 +230,12 @@ public:
 	OsiModelLayer getOsiModelLayer() const { return OsiModelNetworkLayer; }
 };
 
+template<>
+struct LayerProtocolTag<IgmpLayer>
+{
+	static const ProtocolType value = IGMP;
+};
+
 
 /**
  * @class IgmpV1Layer
@@ -271,6 +277,12 @@ public:
 
 };
 
+template<>
+struct LayerProtocolTag<IgmpV1Layer>
+{
+	static const ProtocolType value = IGMPv1;
+};
+
 
 /**
  * @class IgmpV2Layer
@@ -311,6 +323,12 @@ public:
 	void computeCalculateFields();
 };
 
+template<>
+struct LayerProtocolTag<IgmpV2Layer>
+{
+	static const ProtocolType value = IGMPv2;
+};
+
 
 /**
  * @class IgmpV3QueryLayer
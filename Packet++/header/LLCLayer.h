@@ -90,6 +90,12 @@ namespace pcpp
 		static bool isDataValid(const uint8_t *data, size_t dataLen);
 	};
 
+	template<>
+	struct LayerProtocolTag<LLCLayer>
+	{
+		static const ProtocolType value = LLC;
+	};
+
 } // namespace pcpp
 
 #endif /* PACKETPP_LLC_LAYER */
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include "ProtocolType.h"
+#include "LayerAllocator.h"
 #include <string>
 
 /// @file
@@ -35,6 +36,20 @@ namespace pcpp
 
 	class Packet;
 
+	/**
+	 * @struct LayerProtocolTag
+	 * A compile-time tag that maps a layer class to the protocol(s) of its instances. Packet#getLayerOfType() and the other templated layer
+	 * lookups use it to find layers of a class by comparing Layer#getProtocol() values and using static_cast instead of dynamic_cast.
+	 * A layer class may be tagged (by specializing this struct in its header) only if all layers with a protocol in the tag are instances of
+	 * this class (or of classes derived from it), and all instances of this class have a protocol in the tag. Classes that aren't tagged
+	 * (the tag value is ::UnknownProtocol) are looked up using dynamic_cast
+	 */
+	template<class TLayer>
+	struct LayerProtocolTag
+	{
+		static const ProtocolType value = UnknownProtocol;
+	};
+
 	/**
 	 * @class Layer
 	 * Layer is the base class for all protocol layers. Each protocol supported in PcapPlusPlus has a class that inherits Layer.
@@ -77,9 +92,25 @@ namespace pcpp
 		virtual ~Layer();
 
 		/**
-		 * @return A pointer to the next layer in the protocol stack or NULL if the layer is the last one
+		 * Layer objects are allocated through LayerAllocator, which allows reusing the storage of freed layers instead of going to the
+		 * heap for every parsed layer. Please refer to LayerAllocator for more details
+		 * @param[in] size The size of the layer object in bytes
+		 * @return A pointer to the allocated storage
+		 */
+		static void* operator new(size_t size) { return LayerAllocator::allocate(size); }
+
+		/**
+		 * Free the storage of a layer object through LayerAllocator
+		 * @param[in] ptr A pointer to the storage to free
+		 * @param[in] size The size of the layer object in bytes
+		 */
+		static void operator delete(void* ptr, size_t size) { LayerAllocator::deallocate(ptr, size); }
+
+		/**
+		 * @return A pointer to the next layer in the protocol stack or NULL if the layer is the last one. If the layer belongs to a packet
+		 * parsed with pcpp#LazyParsing and the next layer wasn't parsed yet, it's parsed by this call
 		 */
-		Layer* getNextLayer() const { return m_NextLayer; }
+		Layer* getNextLayer() const { return m_NextLayerPending ? parsePendingNextLayer() : m_NextLayer; }
 
 		/**
 		 * @return A pointer to the previous layer in the protocol stack or NULL if the layer is the first one
@@ -167,13 +198,15 @@ namespace pcpp
 		Layer* m_NextLayer;
 		Layer* m_PrevLayer;
 		bool m_IsAllocatedInPacket;
+		// set on the last parsed layer of a lazily parsed packet until parseNextLayer() is called for it
+		bool m_NextLayerPending;
 
-		Layer() : m_Data(NULL), m_DataLen(0), m_Packet(NULL), m_Protocol(UnknownProtocol), m_NextLayer(NULL), m_PrevLayer(NULL), m_IsAllocatedInPacket(false) { }
+		Layer() : m_Data(NULL), m_DataLen(0), m_Packet(NULL), m_Protocol(UnknownProtocol), m_NextLayer(NULL), m_PrevLayer(NULL), m_IsAllocatedInPacket(false), m_NextLayerPending(false) { }
 
 		Layer(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) :
 			m_Data(data), m_DataLen(dataLen),
 			m_Packet(packet), m_Protocol(UnknownProtocol),
-			m_NextLayer(NULL), m_PrevLayer(prevLayer), m_IsAllocatedInPacket(false) {}
+			m_NextLayer(NULL), m_PrevLayer(prevLayer), m_IsAllocatedInPacket(false), m_NextLayerPending(false) {}
 
 		// Copy c'tor
 		Layer(const Layer& other);
@@ -184,6 +217,9 @@ namespace pcpp
 
 		virtual bool extendLayer(int offsetInLayer, size_t numOfBytesToExtend);
 		virtual bool shortenLayer(int offsetInLayer, size_t numOfBytesToShorten);
+
+	private:
+		Layer* parsePendingNextLayer() const;
 	};
 
 } // namespace pcpp
@@ -0,0 +1,76 @@
+#ifndef PACKETPP_LAYER_ALLOCATOR
+#define PACKETPP_LAYER_ALLOCATOR
+
+#include <stddef.h>
+
+/// @file
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * @class LayerAllocator
+	 * A per-thread cache for Layer objects storage. Every time a packet is parsed each layer allocates the next layer object on the heap, and
+	 * when the packet is destroyed (or re-parsed using Packet#setRawPacket()) all of these objects are deleted. When processing millions of
+	 * packets per second this results in millions of malloc/free pairs per second per core.
+	 *
+	 * When the thread cache is enabled on a certain thread, layer objects freed on this thread are not returned to the heap but rather kept in
+	 * size-classed free lists, and are handed back the next time a layer of the same size class is allocated on this thread. In steady state
+	 * (e.g when repeatedly parsing packets with a similar protocol stack) parsing a packet doesn't require any heap allocation for its layers.
+	 *
+	 * The cache is disabled by default and has to be enabled explicitly on each thread that wants to use it. Layer objects may be freely
+	 * created on one thread and deleted on another, in which case the storage simply moves to the cache of the deleting thread.
+	 * Cached storage is returned to the heap when the cache is disabled or when the thread exits
+	 */
+	class LayerAllocator
+	{
+	public:
+		/**
+		 * The default maximum number of cached objects for each size class
+		 */
+		static const size_t DefaultMaxCachedObjectsPerSizeClass = 64;
+
+		/**
+		 * Enable the layer cache on the calling thread. If the cache is already enabled only the maximum cache size is updated
+		 * @param[in] maxCachedObjectsPerSizeClass The maximum number of freed layer objects kept for each size class. Objects freed beyond
+		 * this limit are returned to the heap. The default value is DefaultMaxCachedObjectsPerSizeClass
+		 */
+		static void enableThreadCache(size_t maxCachedObjectsPerSizeClass = DefaultMaxCachedObjectsPerSizeClass);
+
+		/**
+		 * Disable the layer cache on the calling thread and return all of its cached storage to the heap
+		 */
+		static void disableThreadCache();
+
+		/**
+		 * @return True if the layer cache is enabled on the calling thread, false otherwise
+		 */
+		static bool isThreadCacheEnabled();
+
+		/**
+		 * @return The number of layer objects currently cached on the calling thread and ready for reuse
+		 */
+		static size_t getThreadCacheSize();
+
+		/**
+		 * Allocate storage for a layer object. This method is used by Layer's operator new and shouldn't normally be called directly
+		 * @param[in] size The requested size in bytes
+		 * @return A pointer to the allocated storage
+		 */
+		static void* allocate(size_t size);
+
+		/**
+		 * Free storage previously allocated with allocate(). This method is used by Layer's operator delete and shouldn't normally be called directly
+		 * @param[in] ptr A pointer to the storage to free
+		 * @param[in] size The size in bytes that was requested when the storage was allocated
+		 */
+		static void deallocate(void* ptr, size_t size);
+	};
+
+} // namespace pcpp
+
+#endif /* PACKETPP_LAYER_ALLOCATOR */
@@ -121,6 +121,12 @@ namespace pcpp
 		OsiModelLayer getOsiModelLayer() const { return OsiModelNetworkLayer; }
 	};
 
+	template<>
+	struct LayerProtocolTag<MplsLayer>
+	{
+		static const ProtocolType value = MPLS;
+	};
+
 } // namespace pcpp
 
 #endif /* PACKETPP_MPLS_LAYER */
@@ -226,6 +226,12 @@ namespace pcpp
 		TLVRecordReader<NflogTlv> m_TlvReader;
 	};
 
+	template<>
+	struct LayerProtocolTag<NflogLayer>
+	{
+		static const ProtocolType value = NFLOG;
+	};
+
 } // namespace pcpp
 
 #endif /* PACKETPP_NFLOG_LAYER */
@@ -672,6 +672,12 @@ namespace pcpp
         std::string toString() const;
     };
 
+    template<>
+    struct LayerProtocolTag<NtpLayer>
+    {
+    	static const ProtocolType value = NTP;
+    };
+
 } // namespace pcpp
 
 #endif /* PACKETPP_NTP_LAYER */
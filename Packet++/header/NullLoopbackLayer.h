@@ -87,6 +87,12 @@ namespace pcpp
 		OsiModelLayer getOsiModelLayer() const { return OsiModelDataLinkLayer; }
 	};
 
+	template<>
+	struct LayerProtocolTag<NullLoopbackLayer>
+	{
+		static const ProtocolType value = NULL_LOOPBACK;
+	};
+
 } // namespace pcpp
 
 #endif /* PACKETPP_NULL_LOOPBACK_LAYER */
@@ -109,6 +109,12 @@ namespace pcpp
 
 	};
 
+	template<>
+	struct LayerProtocolTag<PPPoELayer>
+	{
+		static const ProtocolType value = PPPoE;
+	};
+
 
 	/**
 	 * @class PPPoESessionLayer
@@ -173,6 +179,12 @@ namespace pcpp
 		virtual std::string toString() const;
 	};
 
+	template<>
+	struct LayerProtocolTag<PPPoESessionLayer>
+	{
+		static const ProtocolType value = PPPoESession;
+	};
+
 
 
 	/**
@@ -421,6 +433,12 @@ namespace pcpp
 		std::string codeToString(PPPoECode code) const;
 	};
 
+	template<>
+	struct LayerProtocolTag<PPPoEDiscoveryLayer>
+	{
+		static const ProtocolType value = PPPoEDiscovery;
+	};
+
 
 	// implementation of inline methods
 
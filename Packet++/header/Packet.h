@@ -4,6 +4,7 @@
 #include "RawPacket.h"
 #include "Layer.h"
 #include <vector>
+#include <type_traits>
 
 /// @file
 
@@ -14,6 +15,20 @@
 namespace pcpp
 {
 
+	/**
+	 * An enum representing how the layers of a parsed packet are created
+	 */
+	enum PacketParsingMode
+	{
+		/** All layers are parsed when the raw packet is set */
+		EagerParsing,
+		/**
+		 * Only the first layer is parsed when the raw packet is set. Each next layer is parsed only when it's reached by Layer#getNextLayer(),
+		 * Packet#getLayerOfType() or Packet#isPacketOfType(), so layers above the ones that are actually used are never created
+		 */
+		LazyParsing
+	};
+
 	/**
 	 * @class Packet
 	 * This class represents a parsed packet. It contains the raw data (RawPacket instance), and a linked list of layers, each layer is a parsed
@@ -27,6 +42,15 @@ namespace pcpp
 	{
 		friend class Layer;
 	private:
+		// the max number of distinct protocols kept in the layer index
+		static const int LayerIndexSize = 8;
+
+		struct LayerIndexEntry
+		{
+			ProtocolType protocol;
+			Layer* layer;
+		};
+
 		RawPacket* m_RawPacket;
 		Layer* m_FirstLayer;
 		Layer* m_LastLayer;
@@ -34,6 +58,11 @@ namespace pcpp
 		size_t m_MaxPacketLen;
 		bool m_FreeRawPacket;
 		bool m_CanReallocateData;
+		// the first layer of each protocol in the packet, in layer order. It's filled as layers are parsed and rebuilt when layers are added
+		// or removed. If the packet has more than LayerIndexSize protocols the index is incomplete and lookups that miss it walk the layers
+		LayerIndexEntry m_LayerIndex[LayerIndexSize];
+		int m_LayerIndexCount;
+		bool m_LayerIndexComplete;
 
 	public:
 
@@ -93,6 +122,18 @@ namespace pcpp
 		 */
 		Packet(RawPacket* rawPacket, OsiModelLayer parseUntilLayer);
 
+		/**
+		 * A constructor for creating a packet out of already allocated RawPacket, which lets the user choose how the packet is parsed.
+		 * With pcpp#LazyParsing only the first layer is parsed when the packet is constructed and the rest are parsed on demand. This is useful
+		 * when most packets are only checked with isPacketOfType() or searched for a single layer: isPacketOfType() parses layers only until
+		 * the protocol is found, and getLayerOfType() only until the requested layer is reached. Methods that need all layers (such as
+		 * getLastLayer(), computeCalculateFields(), toString() or adding and removing layers) parse the rest of the packet first
+		 * @param[in] rawPacket A pointer to the raw packet
+		 * @param[in] parsingMode The parsing mode
+		 * @param[in] freeRawPacket Optional parameter. A flag indicating if the destructor should also call the raw packet destructor or not. Default value is false
+		 */
+		Packet(RawPacket* rawPacket, PacketParsingMode parsingMode, bool freeRawPacket = false);
+
 		/**
 		 * A destructor for this class. Frees all layers allocated by this instance (Notice: it doesn't free layers that weren't allocated by this
 		 * class, for example layers that were added by addLayer() or insertLayer() ). In addition it frees the raw packet if it was allocated by
@@ -133,6 +174,15 @@ namespace pcpp
 		 */
 		void setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType parseUntil = UnknownProtocol, OsiModelLayer parseUntilLayer = OsiModelLayerUnknown);
 
+		/**
+		 * Set a RawPacket and re-construct the packet layers using a certain parsing mode. Please refer to
+		 * Packet(RawPacket*, PacketParsingMode, bool) for more details about pcpp#LazyParsing
+		 * @param[in] rawPacket Raw packet to set
+		 * @param[in] freeRawPacket A flag indicating if the destructor should also call the raw packet destructor or not
+		 * @param[in] parsingMode The parsing mode
+		 */
+		void setRawPacket(RawPacket* rawPacket, bool freeRawPacket, PacketParsingMode parsingMode);
+
 		/**
 		 * Get a pointer to the Packet's RawPacket in a read-only manner
 		 * @return A pointer to the Packet's RawPacket
@@ -146,10 +196,15 @@ namespace pcpp
 		Layer* getFirstLayer() const { return m_FirstLayer; }
 
 		/**
-		 * Get a pointer to the last (highest) layer in the packet
+		 * Get a pointer to the last (highest) layer in the packet. If the packet is parsed with pcpp#LazyParsing, all of its layers are parsed
 		 * @return A pointer to the last (highest) layer in the packet
 		 */
-		Layer* getLastLayer() const { return m_LastLayer; }
+		Layer* getLastLayer() const
+		{
+			if (hasPendingLayers())
+				const_cast<Packet*>(this)->parseRemainingLayers();
+			return m_LastLayer;
+		}
 
 		/**
 		 * Add a new layer as the last layer in the packet. This method gets a pointer to the new layer as a parameter
@@ -256,7 +311,9 @@ namespace pcpp
 		Layer* getLayerOfType(ProtocolType layerType, int index = 0) const;
 
 		/**
-		 * A templated method to get a layer of a certain type (protocol). If no layer of such type is found, NULL is returned
+		 * A templated method to get a layer of a certain type (protocol). If no layer of such type is found, NULL is returned.
+		 * Layer classes tagged with pcpp#LayerProtocolTag (all built-in layers with a unique protocol) are found by protocol, and the first layer
+		 * of a protocol is fetched from a per-packet index without walking the layers. Other classes are found using dynamic_cast
 		 * @param[in] reverseOrder The optional parameter that indicates that the lookup should run in reverse order, the default value is false
 		 * @return A pointer to the layer of the requested type, NULL if not found
 		 */
@@ -286,11 +343,17 @@ namespace pcpp
 		TLayer* getPrevLayerOfType(Layer* startLayer) const;
 
 		/**
-		 * Check whether the packet contains a certain protocol
+		 * Check whether the packet contains a certain protocol. If the packet is parsed with pcpp#LazyParsing and the protocol wasn't found
+		 * in the layers parsed so far, the next layers are parsed until it's found
 		 * @param[in] protocolType The protocol type to search
 		 * @return True if the packet contains the protocol, false otherwise
 		 */
-		bool isPacketOfType(ProtocolType protocolType) const { return m_ProtocolTypes & protocolType; }
+		bool isPacketOfType(ProtocolType protocolType) const
+		{
+			if ((m_ProtocolTypes & protocolType) != 0)
+				return true;
+			return hasPendingLayers() && const_cast<Packet*>(this)->parseUntilProtocol(protocolType);
+		}
 
 		/**
 		 * Each layer can have fields that can be calculate automatically from other fields using Layer#computeCalculateFields(). This method forces all layers to calculate these
@@ -318,6 +381,58 @@ namespace pcpp
 
 		void destructPacketData();
 
+		void resetPacketData(RawPacket* rawPacket, bool freeRawPacket);
+
+		void addPacketTrailerIfExists();
+
+		// must be called for every layer parsed or added, in layer order
+		void addLayerToIndex(Layer* layer)
+		{
+			if ((m_ProtocolTypes & layer->getProtocol()) == 0)
+			{
+				if (m_LayerIndexCount < LayerIndexSize)
+					m_LayerIndex[m_LayerIndexCount++] = { layer->getProtocol(), layer };
+				else
+					m_LayerIndexComplete = false;
+			}
+
+			m_ProtocolTypes |= layer->getProtocol();
+		}
+
+		void rebuildLayerIndex();
+		Layer* getFirstLayerOfProtocol(ProtocolType protocols) const;
+		Layer* findFirstLayerOfProtocol(ProtocolType protocols) const;
+
+		template<class TLayer>
+		using IsTaggedLayer = std::integral_constant<bool, LayerProtocolTag<TLayer>::value != UnknownProtocol>;
+
+		template<class TLayer>
+		static TLayer* asLayerOfType(Layer* layer, std::true_type /* tagged */)
+		{
+			return (layer->getProtocol() & LayerProtocolTag<TLayer>::value) != 0 ? static_cast<TLayer*>(layer) : NULL;
+		}
+
+		template<class TLayer>
+		static TLayer* asLayerOfType(Layer* layer, std::false_type /* tagged */) { return dynamic_cast<TLayer*>(layer); }
+
+		template<class TLayer>
+		static TLayer* asLayerOfType(Layer* layer) { return asLayerOfType<TLayer>(layer, IsTaggedLayer<TLayer>()); }
+
+		template<class TLayer>
+		TLayer* getFirstLayerOfType(std::true_type /* tagged */) const
+		{
+			return static_cast<TLayer*>(getFirstLayerOfProtocol(LayerProtocolTag<TLayer>::value));
+		}
+
+		template<class TLayer>
+		TLayer* getFirstLayerOfType(std::false_type /* tagged */) const;
+
+		// lazy parsing: the last parsed layer is m_LastLayer, and it has a pending next layer until the whole packet is parsed
+		bool hasPendingLayers() const { return m_LastLayer != NULL && m_LastLayer->m_NextLayerPending; }
+		Layer* parseNextLayerOnDemand(Layer* layer);
+		void parseRemainingLayers();
+		bool parseUntilProtocol(ProtocolType protocolType);
+
 		bool extendLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToExtend);
 		bool shortenLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToShorten);
 
@@ -333,24 +448,53 @@ namespace pcpp
 
 	// implementation of inline methods
 
+	inline Layer* Packet::getFirstLayerOfProtocol(ProtocolType protocols) const
+	{
+		for (int i = 0; i < m_LayerIndexCount; i++)
+		{
+			if ((m_LayerIndex[i].protocol & protocols) != 0)
+				return m_LayerIndex[i].layer;
+		}
+
+		if (m_LayerIndexComplete && !hasPendingLayers())
+			return NULL;
+
+		return findFirstLayerOfProtocol(protocols);
+	}
+
 	template<class TLayer>
 	TLayer* Packet::getLayerOfType(bool reverse) const
 	{
 		if (!reverse)
-		{
-			if (dynamic_cast<TLayer*>(getFirstLayer()) != NULL)
-				return dynamic_cast<TLayer*>(getFirstLayer());
-
-			return getNextLayerOfType<TLayer>(getFirstLayer());
-		}
+			return getFirstLayerOfType<TLayer>(IsTaggedLayer<TLayer>());
 
 		// lookup in reverse order
-		if (dynamic_cast<TLayer*>(getLastLayer()) != NULL)
-			return dynamic_cast<TLayer*>(getLastLayer());
+		if (IsTaggedLayer<TLayer>::value && !isPacketOfType(LayerProtocolTag<TLayer>::value))
+			return NULL;
+
+		if (getLastLayer() == NULL)
+			return NULL;
+
+		TLayer* lastLayer = asLayerOfType<TLayer>(getLastLayer());
+		if (lastLayer != NULL)
+			return lastLayer;
 
 		return getPrevLayerOfType<TLayer>(getLastLayer());
 	}
 
+	template<class TLayer>
+	TLayer* Packet::getFirstLayerOfType(std::false_type /* tagged */) const
+	{
+		if (getFirstLayer() == NULL)
+			return NULL;
+
+		TLayer* firstLayer = asLayerOfType<TLayer>(getFirstLayer());
+		if (firstLayer != NULL)
+			return firstLayer;
+
+		return getNextLayerOfType<TLayer>(getFirstLayer());
+	}
+
 	template<class TLayer>
 	TLayer* Packet::getNextLayerOfType(Layer* curLayer) const
 	{
@@ -358,12 +502,16 @@ namespace pcpp
 			return NULL;
 
 		curLayer = curLayer->getNextLayer();
-		while ((curLayer != NULL) && (dynamic_cast<TLayer*>(curLayer) == NULL))
+		while (curLayer != NULL)
 		{
+			TLayer* layer = asLayerOfType<TLayer>(curLayer);
+			if (layer != NULL)
+				return layer;
+
 			curLayer = curLayer->getNextLayer();
 		}
 
-		return dynamic_cast<TLayer*>(curLayer);
+		return NULL;
 	}
 
 	template<class TLayer>
@@ -373,12 +521,16 @@ namespace pcpp
 			return NULL;
 
 		curLayer = curLayer->getPrevLayer();
-		while (curLayer != NULL && dynamic_cast<TLayer*>(curLayer) == NULL)
+		while (curLayer != NULL)
 		{
+			TLayer* layer = asLayerOfType<TLayer>(curLayer);
+			if (layer != NULL)
+				return layer;
+
 			curLayer = curLayer->getPrevLayer();
 		}
 
-		return dynamic_cast<TLayer*>(curLayer);
+		return NULL;
 	}
 
 } // namespace pcpp
@@ -79,6 +79,12 @@ namespace pcpp
 		OsiModelLayer getOsiModelLayer() const { return OsiModelDataLinkLayer; }
 	};
 
+	template<>
+	struct LayerProtocolTag<PacketTrailerLayer>
+	{
+		static const ProtocolType value = PacketTrailer;
+	};
+
 }
 
 #endif // PACKETPP_PACKET_TRAILER_LAYER
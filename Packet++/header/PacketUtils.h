@@ -30,13 +30,36 @@ namespace pcpp
 	};
 
 	/**
-	 * Computes the checksum for a vector of buffers
+	 * Computes the checksum for a vector of buffers. Long buffers are summed with SSE2 or AVX2 instructions when the platform supports them
 	 * @param[in] vec The vector of buffers
 	 * @param[in] vecSize Number of ScalarBuffers in vector
 	 * @return The checksum result
 	 */
 	uint16_t computeChecksum(ScalarBuffer<uint16_t> vec[], size_t vecSize);
 
+	/**
+	 * Update an Internet checksum after some of the data it covers was changed, without going over the rest of the data (RFC 1624).
+	 * This is much cheaper than recomputing the checksum when rewriting a few header fields, for example when doing NAT
+	 * @param[in] checksum The current checksum, as it's stored in the packet
+	 * @param[in] oldData A pointer to the old value of the changed data
+	 * @param[in] newData A pointer to the new value of the changed data
+	 * @param[in] dataLen The length of the changed data in bytes. It must be even, and the data must start at an even offset from the
+	 * beginning of the checksummed data
+	 * @return The updated checksum, in the same byte order as the stored one
+	 */
+	uint16_t updateChecksum(uint16_t checksum, const uint8_t* oldData, const uint8_t* newData, size_t dataLen);
+
+	/**
+	 * Update the checksum of a TCP or UDP layer after a field it covers was changed. The field can be in the TCP/UDP header (such as a port)
+	 * or in the IPv4/IPv6 pseudo header (such as an IP address). A UDP checksum of zero (meaning no checksum) is left as is. Nothing is done
+	 * for other layers
+	 * @param[in] transportLayer The TCP or UDP layer
+	 * @param[in] oldData A pointer to the old value of the changed field
+	 * @param[in] newData A pointer to the new value of the changed field
+	 * @param[in] dataLen The length of the field in bytes, must be even
+	 */
+	void updateTransportChecksum(Layer* transportLayer, const uint8_t* oldData, const uint8_t* newData, size_t dataLen);
+
   /**
 	 * Computes the checksum for Pseudo header
 	 * @param[in] dataPtr Data pointer
@@ -334,6 +334,12 @@ namespace pcpp
 		OsiModelLayer getOsiModelLayer() const { return OsiModelApplicationLayer; }
 	};
 
+	template<>
+	struct LayerProtocolTag<RadiusLayer>
+	{
+		static const ProtocolType value = Radius;
+	};
+
 
 	// implementation of inline methods
 
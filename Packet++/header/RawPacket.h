@@ -348,6 +348,21 @@ namespace pcpp
 		 */
 		virtual bool setRawData(const uint8_t* pRawData, int rawDataLen, timespec timestamp, LinkLayerType layerType = LINKTYPE_ETHERNET, int frameLength = -1);
 
+		/**
+		 * Set a raw data and determine whether this instance owns it. If data was already set and it was owned by this instance the old data
+		 * will be freed first
+		 * @param[in] pRawData A pointer to the new raw data
+		 * @param[in] rawDataLen The new raw data length in bytes
+		 * @param[in] timestamp The timestamp packet was received by the NIC (in nsec precision)
+		 * @param[in] layerType The link layer type for this raw data
+		 * @param[in] frameLength The original packet length. If set to -1 it is assumed to be equal to rawDataLen
+		 * @param[in] deleteRawDataAtDestructor An indicator whether the new raw data should be freed when the instance is freed, cleared or
+		 * when another raw data is set. If set to 'false' the raw data is borrowed and the caller is responsible for keeping it valid
+		 * as long as this instance uses it
+		 * @return True if raw data was set successfully, false otherwise
+		 */
+		bool setRawData(const uint8_t* pRawData, int rawDataLen, timespec timestamp, LinkLayerType layerType, int frameLength, bool deleteRawDataAtDestructor);
+
 		/**
 		 * Get raw data pointer
 		 * @return A read-only pointer to the raw data
@@ -407,9 +422,8 @@ namespace pcpp
 		bool isPacketSet() const { return m_RawPacketSet; }
 
 		/**
-		 * Clears all members of this instance, meaning setting raw data to NULL, raw data length to 0, etc. Currently raw data is always freed,
-		 * even if deleteRawDataAtDestructor was set to 'false'
-		 * @todo deleteRawDataAtDestructor was set to 'true', don't free the raw data
+		 * Clears all members of this instance, meaning setting raw data to NULL, raw data length to 0, etc. Raw data is freed only
+		 * if deleteRawDataAtDestructor was set to 'true'
 		 * @todo set timestamp to a default value as well
 		 */
 		virtual void clear();
@@ -118,6 +118,12 @@ namespace pcpp
 		SSHLayer();
 	};
 
+	template<>
+	struct LayerProtocolTag<SSHLayer>
+	{
+		static const ProtocolType value = SSH;
+	};
+
 
 
 	/**
@@ -2,6 +2,7 @@
 #define PACKETPP_SSL_HANDSHAKE_MESSAGE
 
 #include <utility>
+#include <string.h>
 #include "SSLCommon.h"
 #include "PointerVector.h"
 
@@ -39,7 +40,7 @@ public:
 	 * @param[in] MACAlg MAC algorithm used in this cipher-suite
 	 * @param[in] name String representation of this cipher-suite
 	 */
-	SSLCipherSuite(uint16_t id, SSLKeyExchangeAlgorithm keyExAlg,
+	constexpr SSLCipherSuite(uint16_t id, SSLKeyExchangeAlgorithm keyExAlg,
 			SSLAuthenticationAlgorithm authAlg,
 			SSLSymetricEncryptionAlgorithm symKeyAlg,
 			SSLHashingAlgorithm MACAlg,
@@ -96,7 +97,7 @@ private:
 	SSLAuthenticationAlgorithm m_AuthAlg;
 	SSLSymetricEncryptionAlgorithm m_SymKeyAlg;
 	SSLHashingAlgorithm m_MACAlg;
-	std::string m_Name;
+	const char* m_Name;
 };
 
 
@@ -293,6 +294,53 @@ private:
 };
 
 
+/**
+ * @struct TLSFingerprintDigest
+ * A TLS fingerprint (JA3 or JA3S) MD5 hash in binary form, as generated by SSLClientHelloMessage#generateTLSFingerprintDigest() and
+ * SSLServerHelloMessage#generateTLSFingerprintDigest(). Unlike the hash strings returned by the toMD5() methods it doesn't require
+ * any memory allocation, and it can be used as a key of hash tables using TLSFingerprintDigest#Hash
+ */
+struct TLSFingerprintDigest
+{
+	/** The size of the MD5 hash in bytes */
+	static const size_t DigestLength = 16;
+
+	/** The MD5 hash bytes */
+	uint8_t digest[DigestLength];
+
+	/**
+	 * A c'tor for this struct that zeros the hash
+	 */
+	TLSFingerprintDigest() { memset(digest, 0, DigestLength); }
+
+	/**
+	 * @return The MD5 hash as a 32 character hex string, the same as returned by the toMD5() methods of the TLS fingerprint structs
+	 */
+	std::string toString() const;
+
+	bool operator==(const TLSFingerprintDigest& other) const { return memcmp(digest, other.digest, DigestLength) == 0; }
+
+	bool operator!=(const TLSFingerprintDigest& other) const { return !(*this == other); }
+
+	bool operator<(const TLSFingerprintDigest& other) const { return memcmp(digest, other.digest, DigestLength) < 0; }
+
+	/**
+	 * @struct Hash
+	 * A hash functor for using TLSFingerprintDigest as a key of std::unordered_map. MD5 bytes are uniformly distributed so the
+	 * first bytes of the hash are used as is
+	 */
+	struct Hash
+	{
+		size_t operator()(const TLSFingerprintDigest& fingerprintDigest) const
+		{
+			size_t result;
+			memcpy(&result, fingerprintDigest.digest, sizeof(result));
+			return result;
+		}
+	};
+};
+
+
 class SSLHandshakeLayer;
 
 
@@ -533,6 +581,14 @@ public:
 	 */
 	ClientHelloTLSFingerprint generateTLSFingerprint() const;
 
+	/**
+	 * Generate the MD5 hash of the TLS fingerprint of this message, the same as generateTLSFingerprint() followed by
+	 * ClientHelloTLSFingerprint#toMD5(). The fingerprint elements are read directly from the message and hashed while
+	 * being formatted, so no memory is allocated. This is the preferred method when many messages need to be fingerprinted
+	 * @return The MD5 hash of the TLS fingerprint in binary form
+	 */
+	TLSFingerprintDigest generateTLSFingerprintDigest() const;
+
 	// implement abstract methods
 
 	std::string toString() const;
@@ -705,6 +761,13 @@ public:
 	 */
 	ServerHelloTLSFingerprint generateTLSFingerprint() const;
 
+	/**
+	 * Generate the MD5 hash of the TLS fingerprint of this message, the same as generateTLSFingerprint() followed by
+	 * ServerHelloTLSFingerprint#toMD5(), without allocating memory
+	 * @return The MD5 hash of the TLS fingerprint in binary form
+	 */
+	TLSFingerprintDigest generateTLSFingerprintDigest() const;
+
 	// implement abstract methods
 
 	std::string toString() const;
@@ -256,6 +256,12 @@ namespace pcpp
 
 	}; // class SSLLayer
 
+	template<>
+	struct LayerProtocolTag<SSLLayer>
+	{
+		static const ProtocolType value = SSL;
+	};
+
 
 	/**
 	 * @class SSLHandshakeLayer
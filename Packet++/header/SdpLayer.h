@@ -164,6 +164,12 @@ namespace pcpp
 		bool spacesAllowedBetweenHeaderFieldNameAndValue() const { return false; }
 
 	};
+
+	template<>
+	struct LayerProtocolTag<SdpLayer>
+	{
+		static const ProtocolType value = SDP;
+	};
 }
 
 #endif // PACKETPP_SDP_LAYER
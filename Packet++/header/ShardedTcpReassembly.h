@@ -0,0 +1,200 @@
+#ifndef PACKETPP_SHARDED_TCP_REASSEMBLY
+#define PACKETPP_SHARDED_TCP_REASSEMBLY
+
+#include "TcpReassembly.h"
+#include "RawPacket.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @file
+ * A multi-threaded front-end for pcpp#TcpReassembly. TCP connections are spread across a number of shards, each running on its own worker thread and
+ * owning its own pcpp#TcpReassembly instance, so reassembly of many connections can scale with the number of cores.
+ *
+ * __How it works:__
+ * - Each packet is assigned to a shard by a direction-insensitive hash of its 5-tuple (see pcpp#hash5Tuple()), so both sides of a connection always
+ *   go to the same shard and are processed in the order they were received
+ * - The packet data is copied into a lock-free single-producer/single-consumer queue of that shard. The queue buffers are reused, so in steady
+ *   state feeding packets doesn't require any memory allocation
+ * - The shard's worker thread pulls packets from its queue and feeds them into its pcpp#TcpReassembly instance, which means __all callbacks are
+ *   invoked on the worker thread owning the connection__. Callbacks of different connections may run concurrently on different threads, so any
+ *   state they share must be synchronized by the user. Callbacks of the same connection are always invoked on the same thread
+ *
+ * __Threading model:__
+ * All public methods of pcpp#ShardedTcpReassembly (except the getters) must be called from a single thread - typically the capture thread.
+ * When a shard's queue is full, reassemblePacket() waits until the worker frees a place in the queue
+ */
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+/**
+ * @class ShardedTcpReassembly
+ * A class that spreads TCP reassembly across multiple worker threads. Please refer to the documentation at the top of ShardedTcpReassembly.h
+ * for understanding how to use this class
+ */
+class ShardedTcpReassembly
+{
+public:
+
+	/**
+	 * The default number of packets each shard's queue can hold
+	 */
+	static const size_t DefaultQueueCapacity = 4096;
+
+	/**
+	 * A c'tor for this class. Creates the shards and starts their worker threads
+	 * @param[in] numOfShards The number of shards (and worker threads) to use. If 0 is given the number of hardware threads is used
+	 * @param[in] onMessageReadyCallback The callback to be invoked when new data arrives. It's invoked on the worker thread owning the connection
+	 * @param[in] userCookie A pointer to an object provided by the user. This pointer will be returned when invoking the various callbacks.
+	 * The same cookie is passed to all shards. This parameter is optional, default cookie is NULL
+	 * @param[in] onConnectionStartCallback The callback to be invoked when a new connection is identified. This parameter is optional
+	 * @param[in] onConnectionEndCallback The callback to be invoked when a new connection is terminated (either by a FIN/RST packet or manually
+	 * by the user). This parameter is optional
+	 * @param[in] config Optional parameter for defining special configuration parameters, applied to each shard's pcpp#TcpReassembly instance.
+	 * If not set the default parameters will be set
+	 * @param[in] queueCapacity The number of packets each shard's queue can hold. It's rounded up to a power of 2. The default is DefaultQueueCapacity
+	 */
+	ShardedTcpReassembly(size_t numOfShards, TcpReassembly::OnTcpMessageReady onMessageReadyCallback, void* userCookie = NULL,
+		TcpReassembly::OnTcpConnectionStart onConnectionStartCallback = NULL, TcpReassembly::OnTcpConnectionEnd onConnectionEndCallback = NULL,
+		const TcpReassemblyConfiguration& config = TcpReassemblyConfiguration(), size_t queueCapacity = DefaultQueueCapacity);
+
+	/**
+	 * A d'tor for this class. Waits until all queued packets are processed and stops the worker threads. Connections which are still open aren't
+	 * closed, please call closeAllConnections() before destroying the object if their end callbacks are needed
+	 */
+	~ShardedTcpReassembly();
+
+	/**
+	 * Queue a packet for reassembly on the shard owning its connection. The packet data is copied, so the packet can be reused or freed as soon
+	 * as this method returns
+	 * @param[in] tcpData A reference to the packet to process. The packet has to be parsed up to its TCP layer
+	 * @return True if the packet was queued or false if it's not an IPv4/IPv6 TCP packet, in which case it's ignored
+	 */
+	bool reassemblePacket(Packet& tcpData);
+
+	/**
+	 * Queue a raw packet for reassembly on the shard owning its connection. This method parses the packet only up to its transport layer in
+	 * order to find its shard, and the rest is done on the worker thread
+	 * @param[in] tcpRawData A pointer to the raw packet to process
+	 * @return True if the packet was queued or false if it's not an IPv4/IPv6 TCP packet, in which case it's ignored
+	 */
+	bool reassemblePacket(RawPacket* tcpRawData);
+
+	/**
+	 * Close a connection manually. The request is queued on the shard owning the connection after all packets already queued on it. If the
+	 * connection is open, its end callback is invoked on the worker thread with reason TcpReassembly#TcpReassemblyConnectionClosedManually
+	 * @param[in] flowKey A 4-byte hash key representing the connection. Can be taken from a ConnectionData instance
+	 */
+	void closeConnection(uint32_t flowKey);
+
+	/**
+	 * Close all open connections of all shards manually and wait until they're closed. The end callback of each connection is invoked
+	 * on its worker thread with reason TcpReassembly#TcpReassemblyConnectionClosedManually
+	 */
+	void closeAllConnections();
+
+	/**
+	 * Wait until all packets and requests queued so far are processed by the worker threads
+	 */
+	void flush();
+
+	/**
+	 * @return The number of shards (and worker threads)
+	 */
+	size_t getNumOfShards() const { return m_Shards.size(); }
+
+	/**
+	 * Get the shard a connection is assigned to
+	 * @param[in] flowKey A 4-byte hash key representing the connection. Can be taken from a ConnectionData instance
+	 * @return The index of the shard, between 0 and getNumOfShards()-1
+	 */
+	size_t getShardIndex(uint32_t flowKey) const;
+
+	/**
+	 * @param[in] shardIndex The index of the shard
+	 * @return The number of packets processed so far by the shard's worker thread, or 0 if the index is out of range
+	 */
+	uint64_t getNumOfProcessedPackets(size_t shardIndex) const;
+
+private:
+
+	enum QueueEntryType
+	{
+		PacketEntry,
+		CloseConnectionEntry,
+		CloseAllConnectionsEntry
+	};
+
+	struct QueueEntry
+	{
+		QueueEntryType type;
+		uint32_t flowKey;
+		std::vector<uint8_t> data;
+		int frameLength;
+		timespec timestamp;
+		LinkLayerType linkLayerType;
+
+		QueueEntry() : type(PacketEntry), flowKey(0), frameLength(0), linkLayerType(LINKTYPE_ETHERNET) { timestamp.tv_sec = 0; timestamp.tv_nsec = 0; }
+	};
+
+	// a bounded lock-free queue with a single producer (the thread feeding packets) and a single consumer (the shard's worker thread).
+	// Entries are written in place and never freed, so their data buffers are reused
+	class PacketQueue
+	{
+	public:
+		explicit PacketQueue(size_t capacity);
+
+		// producer side: get the entry to fill, or NULL if the queue is full, and publish it once it's filled
+		QueueEntry* getWriteEntry();
+		void commitWrite();
+
+		// consumer side: get the next entry to process, or NULL if the queue is empty, and release it once it's processed
+		QueueEntry* getReadEntry();
+		void commitRead();
+
+		// the number of entries written so far and the number of entries processed so far
+		uint64_t getWriteCount() const { return m_WriteIndex.load(std::memory_order_acquire); }
+		uint64_t getReadCount() const { return m_ReadIndex.load(std::memory_order_acquire); }
+
+	private:
+		std::vector<QueueEntry> m_Entries;
+		size_t m_Mask;
+		// the indices are kept on separate cache lines to avoid false sharing between the producer and the consumer
+		uint8_t m_Padding1[64];
+		std::atomic<uint64_t> m_WriteIndex;
+		uint8_t m_Padding2[64];
+		std::atomic<uint64_t> m_ReadIndex;
+	};
+
+	struct Shard
+	{
+		TcpReassembly tcpReassembly;
+		PacketQueue queue;
+		std::thread workerThread;
+		std::atomic<uint64_t> numOfProcessedPackets;
+
+		Shard(TcpReassembly::OnTcpMessageReady onMessageReadyCallback, void* userCookie, TcpReassembly::OnTcpConnectionStart onConnectionStartCallback,
+			TcpReassembly::OnTcpConnectionEnd onConnectionEndCallback, const TcpReassemblyConfiguration& config, size_t queueCapacity);
+	};
+
+	std::vector<Shard*> m_Shards;
+	std::atomic<bool> m_StopWorkers;
+
+	// no copying allowed
+	ShardedTcpReassembly(const ShardedTcpReassembly&);
+	ShardedTcpReassembly& operator=(const ShardedTcpReassembly&);
+
+	void workerThreadMain(Shard* shard);
+	QueueEntry* waitForWriteEntry(Shard* shard);
+};
+
+}
+
+#endif /* PACKETPP_SHARDED_TCP_REASSEMBLY */
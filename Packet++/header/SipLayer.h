@@ -129,6 +129,12 @@ namespace pcpp
 		bool spacesAllowedBetweenHeaderFieldNameAndValue() const { return true; }
 	};
 
+	template<>
+	struct LayerProtocolTag<SipLayer>
+	{
+		static const ProtocolType value = SIP;
+	};
+
 
 	class SipRequestFirstLine;
 
@@ -230,6 +236,12 @@ namespace pcpp
 		SipRequestFirstLine* m_FirstLine;
 	};
 
+	template<>
+	struct LayerProtocolTag<SipRequestLayer>
+	{
+		static const ProtocolType value = SIPRequest;
+	};
+
 
 
 
@@ -462,6 +474,12 @@ namespace pcpp
 		SipResponseFirstLine* m_FirstLine;
 	};
 
+	template<>
+	struct LayerProtocolTag<SipResponseLayer>
+	{
+		static const ProtocolType value = SIPResponse;
+	};
+
 
 
 	/**
@@ -187,6 +187,12 @@ namespace pcpp
 		OsiModelLayer getOsiModelLayer() const { return OsiModelDataLinkLayer; }
 	};
 
+	template<>
+	struct LayerProtocolTag<Sll2Layer>
+	{
+		static const ProtocolType value = SLL2;
+	};
+
 } // namespace pcpp
 
 #endif /* PACKETPP_SLL2_LAYER */
@@ -105,6 +105,12 @@ namespace pcpp
 		OsiModelLayer getOsiModelLayer() const { return OsiModelDataLinkLayer; }
 	};
 
+	template<>
+	struct LayerProtocolTag<SllLayer>
+	{
+		static const ProtocolType value = SLL;
+	};
+
 } // namespace pcpp
 
 #endif /* PACKETPP_SLL_LAYER */
@@ -353,6 +353,12 @@ private:
 	static std::unordered_set<uint16_t> m_SomeIpPorts;
 };
 
+template<>
+struct LayerProtocolTag<SomeIpLayer>
+{
+	static const ProtocolType value = SomeIP;
+};
+
 /**
  * @class SomeIpTpLayer
  * Represents an SOME/IP Transport Protocol Layer
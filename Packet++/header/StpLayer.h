@@ -227,6 +227,12 @@ typedef stp_tcn_bpdu stp_header;
 		static StpLayer *parseStpLayer(uint8_t *data, size_t dataLen, Layer *prevLayer, Packet *packet);
 	};
 
+	template<>
+	struct LayerProtocolTag<StpLayer>
+	{
+		static const ProtocolType value = STP;
+	};
+
 	/**
 	 * @class StpTopologyChangeBPDULayer
 	 * Represents network topology change BPDU message of Spanning Tree Protocol
@@ -378,6 +378,20 @@ namespace pcpp
 		 */
 		uint16_t getDstPort() const;
 
+		/**
+		 * Set the TCP source port. The TCP checksum is updated incrementally (RFC 1624) so it stays valid without recomputing it over
+		 * the payload
+		 * @param[in] port The port to set
+		 */
+		void setSrcPort(uint16_t port);
+
+		/**
+		 * Set the TCP destination port. The TCP checksum is updated incrementally (RFC 1624) so it stays valid without recomputing it
+		 * over the payload
+		 * @param[in] port The port to set
+		 */
+		void setDstPort(uint16_t port);
+
 		/**
 		 * Get a TCP option by type
 		 * @param[in] option TCP option type to retrieve
@@ -490,6 +504,12 @@ namespace pcpp
 		void copyLayerData(const TcpLayer& other);
 	};
 
+	template<>
+	struct LayerProtocolTag<TcpLayer>
+	{
+		static const ProtocolType value = TCP;
+	};
+
 
 	// implementation of inline methods
 
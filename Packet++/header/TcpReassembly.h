@@ -3,9 +3,9 @@
 
 #include "Packet.h"
 #include "IpAddress.h"
-#include "PointerVector.h"
+#include <unordered_map>
 #include <map>
-#include <list>
+#include <vector>
 #include <time.h>
 
 
@@ -62,6 +62,13 @@
  * - pcpp#TcpReassemblyConfiguration#closedConnectionDelay - the value of delay expressed in seconds. The minimum value is 1
  * - pcpp#TcpReassemblyConfiguration#maxNumToClean - to avoid performance overhead when the cleanup is being performed, this parameter is used. It defines the maximum number of items to be removed per one call of pcpp#TcpReassembly#purgeClosedConnections
  * - pcpp#TcpReassemblyConfiguration#maxOutOfOrderFragments - the maximum number of unmatched fragments to keep per flow before missed fragments are considered lost. A value of 0 means unlimited
+ * - pcpp#TcpReassemblyConfiguration#maxOutOfOrderMemory - the maximum number of bytes used for buffering out-of-order fragments of all connections. When the limit is exceeded the
+ *   missing data of the connections holding the most out-of-order data is considered lost, so a single stalled connection can't make the other connections lose data.
+ *   A value of 0 means unlimited
+ *
+ * Out-of-order fragments are kept ordered by sequence number, and their data is stored in a pool of size-classed memory blocks owned by the pcpp#TcpReassembly instance,
+ * so buffering fragments doesn't require a heap allocation per fragment once the pool has warmed up. The memory used for buffering can be queried using
+ * pcpp#TcpReassembly#getOutOfOrderMemoryUsage() and pcpp#TcpReassembly#getConnectionOutOfOrderDataSize()
  *
  */
 
@@ -209,6 +216,13 @@ struct TcpReassemblyConfiguration
 	 */
 	bool enableBaseBufferClearCondition;
 
+	/** The maximum number of bytes used for buffering out-of-order fragments of all connections (including bookkeeping overhead). When buffering a fragment
+	    exceeds this limit, the missing data of the connection sides holding the most out-of-order data is considered lost and their buffered fragments are sent
+	    to the user, until the memory used is back below 3/4 of the limit. The limit may be exceeded by up to the size of one fragment. If the value is 0, memory
+	    usage isn't limited
+	 */
+	size_t maxOutOfOrderMemory;
+
 	/**
 	 * A c'tor for this struct
 	 * @param[in] removeConnInfo The flag indicating whether to remove the connection data after a connection is closed. The default is true
@@ -216,9 +230,10 @@ struct TcpReassemblyConfiguration
 	 * @param[in] maxNumToClean The maximum number of items to be cleaned up per one call of purgeClosedConnections. If it's set to 0 the default value will be used. The default is 30.
 	 * @param[in] maxOutOfOrderFragments The maximum number of unmatched fragments to keep per flow before missed fragments are considered lost. The default is unlimited.
 	 * @param[in] enableBaseBufferClearCondition To enable to clear buffer once packet contains data from a different side than the side seen before
+	 * @param[in] maxOutOfOrderMemory The maximum number of bytes used for buffering out-of-order fragments of all connections. The default is unlimited.
 	 */
 	explicit TcpReassemblyConfiguration(bool removeConnInfo = true, uint32_t closedConnectionDelay = 5, uint32_t maxNumToClean = 30, uint32_t maxOutOfOrderFragments = 0,
-		bool enableBaseBufferClearCondition = true) : removeConnInfo(removeConnInfo), closedConnectionDelay(closedConnectionDelay), maxNumToClean(maxNumToClean), maxOutOfOrderFragments(maxOutOfOrderFragments), enableBaseBufferClearCondition(enableBaseBufferClearCondition)
+		bool enableBaseBufferClearCondition = true, size_t maxOutOfOrderMemory = 0) : removeConnInfo(removeConnInfo), closedConnectionDelay(closedConnectionDelay), maxNumToClean(maxNumToClean), maxOutOfOrderFragments(maxOutOfOrderFragments), enableBaseBufferClearCondition(enableBaseBufferClearCondition), maxOutOfOrderMemory(maxOutOfOrderMemory)
 	{
 	}
 };
@@ -308,7 +323,7 @@ public:
 	/**
 	 * The type for storing the connection information
 	 */
-	typedef std::map<uint32_t, ConnectionData> ConnectionInfoList;
+	typedef std::unordered_map<uint32_t, ConnectionData> ConnectionInfoList;
 
 	/**
 	 * @typedef OnTcpMessageReady
@@ -395,27 +410,134 @@ public:
 	 */
 	uint32_t purgeClosedConnections(uint32_t maxNumToClean = 0);
 
+	/**
+	 * @return The number of bytes currently used for buffering out-of-order fragments of all connections, including bookkeeping overhead. This is the value
+	 * limited by TcpReassemblyConfiguration#maxOutOfOrderMemory
+	 */
+	size_t getOutOfOrderMemoryUsage() const { return m_OutOfOrderMemoryPool.getUsedBytes(); }
+
+	/**
+	 * @return The number of bytes allocated from the heap for buffering out-of-order fragments. This includes memory blocks that are currently unused and
+	 * kept for reuse, so it's always greater or equal to getOutOfOrderMemoryUsage(). Memory is returned to the heap once it's no longer used, except for one
+	 * slab of blocks per block size
+	 */
+	size_t getOutOfOrderMemoryPoolSize() const { return m_OutOfOrderMemoryPool.getAllocatedBytes(); }
+
+	/**
+	 * Get the amount of out-of-order data currently buffered for a connection
+	 * @param[in] flowKey A 4-byte hash key representing the connection. Can be taken from a ConnectionData instance
+	 * @return The number of bytes of out-of-order TCP data buffered for both sides of the connection, or 0 if the connection isn't managed by this instance
+	 */
+	size_t getConnectionOutOfOrderDataSize(uint32_t flowKey) const;
+
 private:
+	/**
+	 * A pool of memory blocks used for buffering out-of-order fragments. Blocks are divided into power-of-2 size classes and carved out of larger slabs,
+	 * each slab serving a single size class. Freed blocks are kept in a free list of their slab for reuse, and a slab is returned to the heap once all of
+	 * its blocks are free, unless it's the last slab of its size class with free blocks
+	 */
+	class OutOfOrderMemoryPool
+	{
+	public:
+		OutOfOrderMemoryPool();
+		~OutOfOrderMemoryPool();
+
+		void* allocate(size_t size);
+		void deallocate(void* ptr, size_t size);
+
+		size_t getUsedBytes() const { return m_UsedBytes; }
+		size_t getAllocatedBytes() const { return m_AllocatedBytes; }
+
+		static size_t getBlockSize(size_t size);
+
+	private:
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+		struct Slab
+		{
+			uint8_t* memory;
+			FreeBlock* freeList;
+			size_t numOfUsedBlocks;
+			// links in the list of slabs of the same size class which have free blocks
+			Slab* prev;
+			Slab* next;
+		};
+
+		static const int NumOfSizeClasses = 11;
+
+		Slab* m_SlabsWithFreeBlocks[NumOfSizeClasses];
+		// all slabs by their memory address, used for finding the slab of a freed block
+		std::map<const uint8_t*, Slab*> m_Slabs;
+		size_t m_UsedBytes;
+		size_t m_AllocatedBytes;
+
+		static int getSizeClass(size_t size);
+		void linkSlab(Slab* slab, int sizeClass);
+		void unlinkSlab(Slab* slab, int sizeClass);
+
+		OutOfOrderMemoryPool(const OutOfOrderMemoryPool&);
+		OutOfOrderMemoryPool& operator=(const OutOfOrderMemoryPool&);
+	};
+
+	/**
+	 * An allocator that takes its memory from an OutOfOrderMemoryPool, used for the nodes of the out-of-order fragment lists
+	 */
+	template <typename T>
+	class OutOfOrderAllocator
+	{
+	public:
+		typedef T value_type;
+
+		explicit OutOfOrderAllocator(OutOfOrderMemoryPool* pool) : m_Pool(pool) {}
+
+		template <typename U>
+		OutOfOrderAllocator(const OutOfOrderAllocator<U>& other) : m_Pool(other.getPool()) {}
+
+		T* allocate(size_t n) { return static_cast<T*>(m_Pool->allocate(n * sizeof(T))); }
+		void deallocate(T* ptr, size_t n) { m_Pool->deallocate(ptr, n * sizeof(T)); }
+
+		OutOfOrderMemoryPool* getPool() const { return m_Pool; }
+
+		template <typename U>
+		bool operator==(const OutOfOrderAllocator<U>& other) const { return m_Pool == other.getPool(); }
+
+		template <typename U>
+		bool operator!=(const OutOfOrderAllocator<U>& other) const { return m_Pool != other.getPool(); }
+
+	private:
+		OutOfOrderMemoryPool* m_Pool;
+	};
+
 	struct TcpFragment
 	{
-		uint32_t sequence;
 		size_t dataLength;
 		uint8_t* data;
 		timeval timestamp;
-
-		TcpFragment() : sequence(0), dataLength(0), data(NULL) {}
-		~TcpFragment() { delete [] data; }
 	};
 
+	/**
+	 * Out-of-order fragments of one side of a connection keyed by their sequence number
+	 */
+	typedef std::multimap<uint32_t, TcpFragment, std::less<uint32_t>, OutOfOrderAllocator<std::pair<const uint32_t, TcpFragment> > > TcpFragmentList;
+
 	struct TcpOneSideData
 	{
 		IPAddress srcIP;
 		uint16_t srcPort;
 		uint32_t sequence;
-		PointerVector<TcpFragment> tcpFragmentList;
+		TcpFragmentList tcpFragmentList;
+		size_t outOfOrderDataSize;
 		bool gotFinOrRst;
 
-		TcpOneSideData() : srcPort(0), sequence(0), gotFinOrRst(false) {}
+		explicit TcpOneSideData(OutOfOrderMemoryPool* pool) : srcPort(0), sequence(0), tcpFragmentList(std::less<uint32_t>(), TcpFragmentList::allocator_type(pool)), outOfOrderDataSize(0), gotFinOrRst(false) {}
+		// the d'tor returns the fragment data to the pool, so copies would return it twice. Moving is needed for initializing TcpReassemblyData::twoSides
+		TcpOneSideData(TcpOneSideData&& other) = default;
+		TcpOneSideData(const TcpOneSideData&) = delete;
+		TcpOneSideData& operator=(const TcpOneSideData&) = delete;
+		~TcpOneSideData();
 	};
 
 	struct TcpReassemblyData
@@ -426,28 +548,89 @@ private:
 		TcpOneSideData twoSides[2];
 		ConnectionData connData;
 
-		TcpReassemblyData() : closed(false), numOfSides(0), prevSide(-1) {}
+		explicit TcpReassemblyData(OutOfOrderMemoryPool* pool) : closed(false), numOfSides(0), prevSide(-1), twoSides{ TcpOneSideData(pool), TcpOneSideData(pool) } {}
+	};
+
+	/**
+	 * An open-addressing hash table (linear probing with backward-shift deletion) mapping flow keys to connections. Connection data is
+	 * allocated separately so pointers to it remain valid when the table grows or other connections are removed
+	 */
+	class ConnectionList
+	{
+	public:
+		ConnectionList();
+		~ConnectionList();
+
+		TcpReassemblyData* find(uint32_t flowKey) const;
+		void insert(uint32_t flowKey, TcpReassemblyData* tcpReassemblyData);
+		void erase(uint32_t flowKey);
+
+		size_t size() const { return m_Size; }
+		size_t getNumOfSlots() const { return m_Slots.size(); }
+		TcpReassemblyData* getSlotData(size_t slotIndex) const { return m_Slots[slotIndex].data; }
+
+	private:
+		struct Slot
+		{
+			uint32_t flowKey;
+			TcpReassemblyData* data;
+
+			Slot() : flowKey(0), data(NULL) {}
+		};
+
+		std::vector<Slot> m_Slots;
+		size_t m_Size;
+
+		size_t getIdealSlot(uint32_t flowKey) const;
+		void grow();
+
+		// the table owns the connection data so it must not be copied
+		ConnectionList(const ConnectionList&);
+		ConnectionList& operator=(const ConnectionList&);
+	};
+
+	/**
+	 * An entry in the cleanup wheel: a closed connection and the time it should be removed
+	 */
+	struct CleanupEntry
+	{
+		time_t expiration;
+		uint32_t flowKey;
 	};
 
-	typedef std::map<uint32_t, TcpReassemblyData> ConnectionList;
-	typedef std::map<time_t, std::list<uint32_t> > CleanupList;
+	/**
+	 * A hashed timing wheel with one slot per second. Each entry is stored in the slot of its expiration second modulo the wheel size,
+	 * so inserting is O(1) and purging only scans the slots of the seconds that passed since the previous purge
+	 */
+	typedef std::vector<std::vector<CleanupEntry> > CleanupList;
 
 	OnTcpMessageReady m_OnMessageReadyCallback;
 	OnTcpConnectionStart m_OnConnStart;
 	OnTcpConnectionEnd m_OnConnEnd;
 	void* m_UserCookie;
+	// declared before the connection list so it's destroyed after all connections are
+	OutOfOrderMemoryPool m_OutOfOrderMemoryPool;
 	ConnectionList m_ConnectionList;
 	ConnectionInfoList m_ConnectionInfo;
 	CleanupList m_CleanupList;
+	time_t m_CleanupListTime;
+	size_t m_CleanupListSize;
 	bool m_RemoveConnInfo;
 	uint32_t m_ClosedConnectionDelay;
 	uint32_t m_MaxNumToClean;
 	size_t m_MaxOutOfOrderFragments;
+	size_t m_MaxOutOfOrderMemory;
 	time_t m_PurgeTimepoint;
 	bool m_EnableBaseBufferClearCondition;
 
 	void checkOutOfOrderFragments(TcpReassemblyData* tcpReassemblyData, int8_t sideIndex, bool cleanWholeFragList);
 
+	void addOutOfOrderFragment(TcpOneSideData& sideData, uint32_t sequence, const uint8_t* data, size_t dataLength, const timeval& timestamp);
+
+	void removeOutOfOrderFragment(TcpOneSideData& sideData, TcpFragmentList::iterator fragment);
+
+	void enforceOutOfOrderMemoryLimit();
+
 	void handleFinOrRst(TcpReassemblyData* tcpReassemblyData, int8_t sideIndex, uint32_t flowKey, bool isRst);
 
 	void closeConnectionInternal(uint32_t flowKey, ConnectionEndReason reason);
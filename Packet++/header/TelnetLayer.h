@@ -346,6 +346,12 @@ class TelnetLayer : public Layer
 	std::string toString() const;
 };
 
+template<>
+struct LayerProtocolTag<TelnetLayer>
+{
+	static const ProtocolType value = Telnet;
+};
+
 } // namespace pcpp
 
 #endif /* PACKETPP_TELNET_LAYER */
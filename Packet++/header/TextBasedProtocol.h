@@ -2,6 +2,9 @@
 #define PACKETPP_TEXT_BASED_PROTOCOL_LAYER
 
 #include <map>
+#include <vector>
+#include <atomic>
+#include <mutex>
 #include "Layer.h"
 
 /// @file
@@ -81,7 +84,8 @@ public:
 
 private:
 	HeaderField(const std::string& name, const std::string& value, char nameValueSeparator, bool spacesAllowedBetweenNameAndValue);
-	HeaderField(TextBasedProtocolMessage* TextBasedProtocolMessage, int offsetInMessage, char nameValueSeparator, bool spacesAllowedBetweenNameAndValue);
+	HeaderField(TextBasedProtocolMessage* TextBasedProtocolMessage, int nameOffsetInMessage, size_t fieldNameSize, int valueOffsetInMessage, size_t fieldValueSize,
+		size_t fieldSize, char nameValueSeparator, bool spacesAllowedBetweenNameAndValue);
 
 	char* getData() const;
 	void setNextField(HeaderField* nextField);
@@ -111,11 +115,22 @@ private:
  * @class TextBasedProtocolMessage
  * An abstract base class that wraps text-based-protocol header layers (both requests and responses). It is the base class for all those layers.
  * This class is not meant to be instantiated, hence the protected c'tor
+ *
+ * When a message is parsed, the position of each header field is kept in a compact index stored inside the layer object, so parsing
+ * doesn't allocate memory for messages with up to MaxInlineIndexedFields fields. HeaderField objects are created only when they're needed,
+ * meaning the first time a method that returns or modifies HeaderField instances is called. Methods such as getFieldValueByName(),
+ * getFieldCount(), isHeaderComplete() and getHeaderLen() use the index and don't create them. HeaderField objects are created under a
+ * lock and the index isn't changed once they exist, so const methods may be called on the same message from several threads
  */
 class TextBasedProtocolMessage : public Layer
 {
 	friend class HeaderField;
 public:
+	/**
+	 * The number of fields a parsed message can have before its field index is extended with heap memory
+	 */
+	static const int MaxInlineIndexedFields = 12;
+
 	~TextBasedProtocolMessage();
 
 	/**
@@ -128,10 +143,20 @@ public:
 	 */
 	HeaderField* getFieldByName(std::string fieldName, int index = 0) const;
 
+	/**
+	 * Get the value of a header field by name. The search is case insensitive, like in getFieldByName(). Unlike getFieldByName(), this
+	 * method doesn't create HeaderField objects, so it's the cheaper way of reading fields of a parsed message
+	 * @param[in] fieldName The field name
+	 * @param[in] index Optional parameter. If the field name appears more than once, this parameter will indicate which field to get.
+	 * The default value is 0 (get the first appearance of the field name as appears on the packet)
+	 * @return The field value or an empty string if the field doesn't exist or doesn't have a value
+	 */
+	std::string getFieldValueByName(const std::string& fieldName, int index = 0) const;
+
 	/**
 	 * @return A pointer to the first header field exists in this message, or NULL if no such field exists
 	 */
-	HeaderField* getFirstField() const { return m_FieldList; }
+	HeaderField* getFirstField() const { materializeFields(); return m_FieldList; }
 
 	/**
 	 * Get the field which appears after a certain field
@@ -235,7 +260,7 @@ public:
 
 protected:
 	TextBasedProtocolMessage(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet);
-	TextBasedProtocolMessage() : m_FieldList(NULL), m_LastField(NULL), m_FieldsOffset(0) {}
+	TextBasedProtocolMessage() : m_FieldList(NULL), m_LastField(NULL), m_FieldsOffset(0), m_NumOfIndexedFields(0), m_FieldsMaterialized(true) {}
 
 	// copy c'tor
 	TextBasedProtocolMessage(const TextBasedProtocolMessage& other);
@@ -246,14 +271,47 @@ protected:
 	void parseFields();
 	void shiftFieldsOffset(HeaderField* fromField, int numOfBytesToShift);
 
+	// the fields are materialized before the layer changes since the index can't be shifted
+	bool extendLayer(int offsetInLayer, size_t numOfBytesToExtend);
+	bool shortenLayer(int offsetInLayer, size_t numOfBytesToShorten);
+
 	// abstract methods
 	virtual char getHeaderFieldNameValueSeparator() const = 0;
 	virtual bool spacesAllowedBetweenHeaderFieldNameAndValue() const = 0;
 
-	HeaderField* m_FieldList;
-	HeaderField* m_LastField;
+	mutable HeaderField* m_FieldList;
+	mutable HeaderField* m_LastField;
 	int m_FieldsOffset;
-	std::multimap<std::string, HeaderField*> m_FieldNameToFieldMap;
+	mutable std::multimap<std::string, HeaderField*> m_FieldNameToFieldMap;
+
+private:
+	// the position of a header field in the message. Unknown sizes and offsets are -1, like in HeaderField
+	struct FieldIndexEntry
+	{
+		int nameOffset;
+		int valueOffset;
+		uint32_t nameSize;
+		uint32_t valueSize;
+		uint32_t fieldSize;
+		// a case insensitive hash of the field name
+		uint32_t nameHash;
+
+		bool isEndOfHeader() const { return nameSize == (uint32_t)-1; }
+	};
+
+	FieldIndexEntry m_InlineFieldIndex[MaxInlineIndexedFields];
+	std::vector<FieldIndexEntry> m_ExtraFieldIndex;
+	int m_NumOfIndexedFields;
+	// true if the header fields are represented by HeaderField objects (m_FieldList), false if they are only represented by the index.
+	// Const methods may create the HeaderField objects, so that's done with m_MaterializeMutex held and this flag is set when they're ready
+	mutable std::atomic<bool> m_FieldsMaterialized;
+	mutable std::mutex m_MaterializeMutex;
+
+	const FieldIndexEntry& getIndexedField(int index) const { return index < MaxInlineIndexedFields ? m_InlineFieldIndex[index] : m_ExtraFieldIndex[index - MaxInlineIndexedFields]; }
+	void addIndexedField(const FieldIndexEntry& entry);
+	void parseFieldAt(int offset, char nameValueSeparator, bool spacesAllowedBetweenNameAndValue, FieldIndexEntry& entry) const;
+	void materializeFields() const;
+	static uint32_t hashFieldName(const char* name, size_t nameSize);
 };
 
 
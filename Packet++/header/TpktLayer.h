@@ -130,5 +130,11 @@ namespace pcpp
 		tpkthdr *getTpktHeader() const { return (tpkthdr *)m_Data; }
 	};
 
+	template<>
+	struct LayerProtocolTag<TpktLayer>
+	{
+		static const ProtocolType value = TPKT;
+	};
+
 } // namespace pcpp
 #endif // PACKETPP_TPKT_LAYER
@@ -70,6 +70,20 @@ namespace pcpp
 		 */
 		uint16_t getDstPort() const;
 
+		/**
+		 * Set the UDP source port. The UDP checksum is updated incrementally (RFC 1624) so it stays valid without recomputing it over
+		 * the payload
+		 * @param[in] port The port to set
+		 */
+		void setSrcPort(uint16_t port);
+
+		/**
+		 * Set the UDP destination port. The UDP checksum is updated incrementally (RFC 1624) so it stays valid without recomputing it
+		 * over the payload
+		 * @param[in] port The port to set
+		 */
+		void setDstPort(uint16_t port);
+
 		/**
 		 * Calculate the checksum from header and data and possibly write the result to @ref udphdr#headerChecksum
 		 * @param[in] writeResultToPacket If set to true then checksum result will be written to @ref udphdr#headerChecksum
@@ -100,6 +114,12 @@ namespace pcpp
 		OsiModelLayer getOsiModelLayer() const { return OsiModelTransportLayer; }
 	};
 
+	template<>
+	struct LayerProtocolTag<UdpLayer>
+	{
+		static const ProtocolType value = UDP;
+	};
+
 } // namespace pcpp
 
 #endif /* PACKETPP_UDP_LAYER */
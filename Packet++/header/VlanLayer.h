@@ -132,6 +132,12 @@ namespace pcpp
 		OsiModelLayer getOsiModelLayer() const { return OsiModelDataLinkLayer; }
 	};
 
+	template<>
+	struct LayerProtocolTag<VlanLayer>
+	{
+		static const ProtocolType value = VLAN;
+	};
+
 } // namespace pcpp
 
 #endif /* PACKETPP_VLAN_LAYER */
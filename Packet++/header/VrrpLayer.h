@@ -310,6 +310,12 @@ namespace pcpp
 		OsiModelLayer getOsiModelLayer() const override { return OsiModelNetworkLayer; }
 	};
 
+	template<>
+	struct LayerProtocolTag<VrrpLayer>
+	{
+		static const ProtocolType value = VRRP;
+	};
+
 	/**
 	 * @class VrrpV2Layer
 	 * Represents VRRPv2 (Virtual Router Redundancy Protocol ver 2) layer. This class represents all the different messages of VRRPv2
@@ -400,6 +406,12 @@ namespace pcpp
 		uint16_t calculateChecksum() const override;
 	};
 
+	template<>
+	struct LayerProtocolTag<VrrpV2Layer>
+	{
+		static const ProtocolType value = VRRPv2;
+	};
+
 	/**
 	 * @class VrrpV3Layer
 	 * Represents VRRPv3 (Virtual Router Redundancy Protocol ver 3) layer. This class represents all the different messages of VRRP
@@ -456,6 +468,12 @@ namespace pcpp
 		*/
 		uint16_t calculateChecksum() const override;
 	};
+
+	template<>
+	struct LayerProtocolTag<VrrpV3Layer>
+	{
+		static const ProtocolType value = VRRPv3;
+	};
 }
 
 #endif // PACKETPP_VRRP_LAYER
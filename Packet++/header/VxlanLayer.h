@@ -140,6 +140,12 @@ namespace pcpp
 
 	};
 
+	template<>
+	struct LayerProtocolTag<VxlanLayer>
+	{
+		static const ProtocolType value = VXLAN;
+	};
+
 }
 
 #endif // PACKETPP_VXLAN_LAYER
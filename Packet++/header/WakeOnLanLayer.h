@@ -168,6 +168,12 @@ namespace pcpp
 		 */
 		std::string toString() const;
 	};
+
+	template<>
+	struct LayerProtocolTag<WakeOnLanLayer>
+	{
+		static const ProtocolType value = WakeOnLan;
+	};
 } // namespace pcpp
 
 #endif /* PACKETPP_WAKEONLAN_LAYER */
@@ -6,6 +6,7 @@
 #include <sstream>
 #include <string.h>
 #include <iomanip>
+#include <algorithm>
 #include <stdlib.h>
 #include "EndianPortable.h"
 
@@ -82,8 +83,8 @@ void DnsLayer::init(size_t offsetAdjustment, bool callParseResource)
 	m_FirstAuthority = nullptr;
 	m_FirstAdditional = nullptr;
 
-	if (callParseResource)
-		parseResources();
+	// the resources of a parsed message are created the first time they're needed
+	m_ResourcesParsed = !callParseResource;
 }
 
 
@@ -98,7 +99,7 @@ void DnsLayer::initNewLayer(size_t offsetAdjustment)
 	init(m_OffsetAdjustment, false);
 }
 
-size_t DnsLayer::getBasicHeaderSize()
+size_t DnsLayer::getBasicHeaderSize() const
 {
 	return sizeof(dnshdr) + m_OffsetAdjustment;
 }
@@ -139,8 +140,14 @@ bool DnsLayer::shortenLayer(int offsetInLayer, size_t numOfBytesToShorten, IDnsR
 }
 
 
-void DnsLayer::parseResources()
+void DnsLayer::parseResources() const
 {
+	if (m_ResourcesParsed)
+		return;
+
+	m_ResourcesParsed = true;
+
+	DnsLayer* nonConstThis = const_cast<DnsLayer*>(this);
 	size_t offsetInPacket = getBasicHeaderSize();
 	IDnsResource* curResource = m_ResourceList;
 
@@ -187,13 +194,13 @@ void DnsLayer::parseResources()
 		IDnsResource* newGenResource = nullptr;
 		if (resType == DnsQueryType)
 		{
-			newQuery = new DnsQuery(this, offsetInPacket);
+			newQuery = new DnsQuery(nonConstThis, offsetInPacket);
 			newGenResource = newQuery;
 			offsetInPacket += newQuery->getSize();
 		}
 		else
 		{
-			newResource = new DnsResource(this, offsetInPacket, resType);
+			newResource = new DnsResource(nonConstThis, offsetInPacket, resType);
 			newGenResource = newResource;
 			offsetInPacket += newResource->getSize();
 		}
@@ -229,6 +236,143 @@ void DnsLayer::parseResources()
 
 }
 
+bool DnsLayer::readRecord(size_t offsetInLayer, uint16_t index, DnsRecordInfo& record) const
+{
+	uint16_t numOfQuestions = be16toh(getDnsHeader()->numberOfQuestions);
+	uint16_t numOfAnswers = be16toh(getDnsHeader()->numberOfAnswers);
+	uint16_t numOfAuthority = be16toh(getDnsHeader()->numberOfAuthority);
+	uint16_t numOfAdditional = be16toh(getDnsHeader()->numberOfAdditional);
+
+	// the same limit as in parseResources()
+	uint32_t numOfResources = numOfQuestions + numOfAnswers + numOfAuthority + numOfAdditional;
+	if (numOfResources > 300 || index >= numOfResources)
+		return false;
+
+	DnsRecordInfo result;
+	result.index = index;
+	result.offsetInLayer = offsetInLayer;
+	if (index < numOfQuestions)
+		result.resourceType = DnsQueryType;
+	else if (index < numOfQuestions + numOfAnswers)
+		result.resourceType = DnsAnswerType;
+	else if (index < numOfQuestions + numOfAnswers + numOfAuthority)
+		result.resourceType = DnsAuthorityType;
+	else
+		result.resourceType = DnsAdditionalType;
+
+	// skip the record name: a zero length label or a compression pointer ends it
+	size_t offset = offsetInLayer;
+	while (true)
+	{
+		if (offset >= m_DataLen)
+			return false;
+
+		uint8_t labelLength = m_Data[offset];
+		if (labelLength == 0)
+		{
+			offset++;
+			break;
+		}
+
+		if ((labelLength & 0xc0) == 0xc0)
+		{
+			offset += sizeof(uint16_t);
+			break;
+		}
+
+		offset += labelLength + 1;
+	}
+
+	size_t fixedFieldsLen = 2 * sizeof(uint16_t);
+	if (result.resourceType != DnsQueryType)
+		fixedFieldsLen += sizeof(uint32_t) + sizeof(uint16_t);
+
+	if (offset + fixedFieldsLen > m_DataLen)
+		return false;
+
+	result.dnsType = (DnsType)be16toh(*(uint16_t*)(m_Data + offset));
+	result.dnsClass = be16toh(*(uint16_t*)(m_Data + offset + sizeof(uint16_t)));
+	if (result.resourceType == DnsQueryType)
+	{
+		result.ttl = 0;
+		result.dataOffset = 0;
+		result.dataLength = 0;
+	}
+	else
+	{
+		result.ttl = be32toh(*(uint32_t*)(m_Data + offset + 2 * sizeof(uint16_t)));
+		result.dataLength = be16toh(*(uint16_t*)(m_Data + offset + 2 * sizeof(uint16_t) + sizeof(uint32_t)));
+		result.dataOffset = offset + fixedFieldsLen;
+	}
+
+	result.size = offset + fixedFieldsLen + result.dataLength - offsetInLayer;
+	if (offsetInLayer + result.size > m_DataLen)
+		return false;
+
+	record = result;
+	return true;
+}
+
+bool DnsLayer::getFirstRecord(DnsRecordInfo& record) const
+{
+	return readRecord(getBasicHeaderSize(), 0, record);
+}
+
+bool DnsLayer::getNextRecord(DnsRecordInfo& record) const
+{
+	return readRecord(record.offsetInLayer + record.size, record.index + 1, record);
+}
+
+size_t DnsLayer::decodeName(size_t offsetInLayer, char* buffer, size_t bufferLen) const
+{
+	if (buffer == nullptr || bufferLen == 0)
+		return 0;
+
+	size_t maxNameLength = (bufferLen - 1 < MaxDecodedNameLength ? bufferLen - 1 : MaxDecodedNameLength);
+	size_t nameLength = 0;
+	int numOfPointers = 0;
+	size_t offset = offsetInLayer;
+	while (offset < m_DataLen)
+	{
+		uint8_t labelLength = m_Data[offset];
+		if (labelLength == 0)
+			break;
+
+		// a pointer to another place in the packet. Limit the number of pointers like IDnsResource::decodeName() does, so pointer
+		// loops end
+		if ((labelLength & 0xc0) == 0xc0)
+		{
+			if (offset + 1 >= m_DataLen || ++numOfPointers > 20)
+				break;
+
+			size_t pointerOffset = (labelLength & 0x3f) * 256 + m_Data[offset + 1] + m_OffsetAdjustment;
+			if (pointerOffset < sizeof(dnshdr) || pointerOffset >= m_DataLen)
+			{
+				PCPP_LOG_ERROR("DNS parsing error: name pointer is illegal");
+				nameLength = 0;
+				break;
+			}
+
+			offset = pointerOffset;
+			continue;
+		}
+
+		if (offset + labelLength + 1 > m_DataLen)
+			break;
+
+		if (nameLength > 0 && nameLength < maxNameLength)
+			buffer[nameLength++] = '.';
+
+		size_t copyLength = std::min((size_t)labelLength, maxNameLength - nameLength);
+		memcpy(buffer + nameLength, m_Data + offset + 1, copyLength);
+		nameLength += copyLength;
+		offset += labelLength + 1;
+	}
+
+	buffer[nameLength] = 0;
+	return nameLength;
+}
+
 IDnsResource* DnsLayer::getResourceByName(IDnsResource* startFrom, size_t resourceCount, const std::string& name, bool exactMatch) const
 {
 	size_t index = 0;
@@ -253,6 +397,7 @@ IDnsResource* DnsLayer::getResourceByName(IDnsResource* startFrom, size_t resour
 
 DnsQuery* DnsLayer::getQuery(const std::string& name, bool exactMatch) const
 {
+	parseResources();
 	uint16_t numOfQueries = be16toh(getDnsHeader()->numberOfQuestions);
 	IDnsResource* res = getResourceByName(m_FirstQuery, numOfQueries, name, exactMatch);
 	if (res != nullptr)
@@ -263,6 +408,7 @@ DnsQuery* DnsLayer::getQuery(const std::string& name, bool exactMatch) const
 
 DnsQuery* DnsLayer::getFirstQuery() const
 {
+	parseResources();
 	return m_FirstQuery;
 }
 
@@ -285,6 +431,7 @@ size_t DnsLayer::getQueryCount() const
 
 DnsResource* DnsLayer::getAnswer(const std::string& name, bool exactMatch) const
 {
+	parseResources();
 	uint16_t numOfAnswers = be16toh(getDnsHeader()->numberOfAnswers);
 	IDnsResource* res = getResourceByName(m_FirstAnswer, numOfAnswers, name, exactMatch);
 	if (res != nullptr)
@@ -294,6 +441,7 @@ DnsResource* DnsLayer::getAnswer(const std::string& name, bool exactMatch) const
 
 DnsResource* DnsLayer::getFirstAnswer() const
 {
+	parseResources();
 	return m_FirstAnswer;
 }
 
@@ -315,6 +463,7 @@ size_t DnsLayer::getAnswerCount() const
 
 DnsResource* DnsLayer::getAuthority(const std::string& name, bool exactMatch) const
 {
+	parseResources();
 	uint16_t numOfAuthorities = be16toh(getDnsHeader()->numberOfAuthority);
 	IDnsResource* res = getResourceByName(m_FirstAuthority, numOfAuthorities, name, exactMatch);
 	if (res != nullptr)
@@ -324,6 +473,7 @@ DnsResource* DnsLayer::getAuthority(const std::string& name, bool exactMatch) co
 
 DnsResource* DnsLayer::getFirstAuthority() const
 {
+	parseResources();
 	return m_FirstAuthority;
 }
 
@@ -345,6 +495,7 @@ size_t DnsLayer::getAuthorityCount() const
 
 DnsResource* DnsLayer::getAdditionalRecord(const std::string& name, bool exactMatch) const
 {
+	parseResources();
 	uint16_t numOfAdditionalRecords = be16toh(getDnsHeader()->numberOfAdditional);
 	IDnsResource* res = getResourceByName(m_FirstAdditional, numOfAdditionalRecords, name, exactMatch);
 	if (res != nullptr)
@@ -354,6 +505,7 @@ DnsResource* DnsLayer::getAdditionalRecord(const std::string& name, bool exactMa
 
 DnsResource* DnsLayer::getFirstAdditionalRecord() const
 {
+	parseResources();
 	return m_FirstAdditional;
 }
 
@@ -474,6 +626,8 @@ void DnsLayer::setFirstResource(DnsResourceType resType, IDnsResource* resource)
 DnsResource* DnsLayer::addResource(DnsResourceType resType, const std::string& name, DnsType dnsType, DnsClass dnsClass,
 		uint32_t ttl, IDnsResourceData* data)
 {
+	parseResources();
+
 	// create new query on temporary buffer
 	uint8_t newResourceRawData[4096];
 	memset(newResourceRawData, 0, sizeof(newResourceRawData));
@@ -560,6 +714,8 @@ DnsResource* DnsLayer::addResource(DnsResourceType resType, const std::string& n
 
 DnsQuery* DnsLayer::addQuery(const std::string& name, DnsType dnsType, DnsClass dnsClass)
 {
+	parseResources();
+
 	// create new query on temporary buffer
 	uint8_t newQueryRawData[256];
 	DnsQuery* newQuery = new DnsQuery(newQueryRawData);
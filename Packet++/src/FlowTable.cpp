@@ -0,0 +1,124 @@
+#include "FlowTable.h"
+#include "Packet.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "TcpLayer.h"
+#include "UdpLayer.h"
+#include <string.h>
+#include <algorithm>
+
+namespace pcpp
+{
+
+static_assert(sizeof(FlowKey) == 40, "FlowKey must not contain padding since it's compared and hashed as a byte array");
+
+bool FlowKey::initFromPacket(Packet* packet, bool directionUnique)
+{
+	memset(this, 0, sizeof(FlowKey));
+
+	if (!packet->isPacketOfType(IPv4) && !packet->isPacketOfType(IPv6))
+		return false;
+
+	if (packet->isPacketOfType(ICMP))
+		return false;
+
+	Layer* transportLayer = packet->getLayerOfType<TcpLayer>(true); // lookup in reverse order
+	if (transportLayer != NULL)
+	{
+		TcpLayer* tcpLayer = static_cast<TcpLayer*>(transportLayer);
+		srcPort = tcpLayer->getSrcPort();
+		dstPort = tcpLayer->getDstPort();
+		protocol = PACKETPP_IPPROTO_TCP;
+	}
+	else
+	{
+		UdpLayer* udpLayer = packet->getLayerOfType<UdpLayer>(true);
+		if (udpLayer == NULL)
+			return false;
+
+		transportLayer = udpLayer;
+		srcPort = udpLayer->getSrcPort();
+		dstPort = udpLayer->getDstPort();
+		protocol = PACKETPP_IPPROTO_UDP;
+	}
+
+	// the IP layer is the closest one that precedes the transport layer
+	Layer* ipLayer = transportLayer->getPrevLayer();
+	while (ipLayer != NULL && ipLayer->getProtocol() != IPv4 && ipLayer->getProtocol() != IPv6)
+		ipLayer = ipLayer->getPrevLayer();
+
+	if (ipLayer == NULL)
+	{
+		memset(this, 0, sizeof(FlowKey));
+		return false;
+	}
+
+	if (ipLayer->getProtocol() == IPv4)
+	{
+		iphdr* ipHeader = static_cast<IPv4Layer*>(ipLayer)->getIPv4Header();
+		memcpy(srcIP, &ipHeader->ipSrc, 4);
+		memcpy(dstIP, &ipHeader->ipDst, 4);
+		ipVersion = 4;
+	}
+	else
+	{
+		ip6_hdr* ipHeader = static_cast<IPv6Layer*>(ipLayer)->getIPv6Header();
+		memcpy(srcIP, ipHeader->ipSrc, 16);
+		memcpy(dstIP, ipHeader->ipDst, 16);
+		ipVersion = 6;
+	}
+
+	if (!directionUnique)
+	{
+		int ipCompare = memcmp(srcIP, dstIP, 16);
+		if (ipCompare > 0 || (ipCompare == 0 && srcPort > dstPort))
+		{
+			uint8_t tempIP[16];
+			memcpy(tempIP, srcIP, 16);
+			memcpy(srcIP, dstIP, 16);
+			memcpy(dstIP, tempIP, 16);
+			std::swap(srcPort, dstPort);
+		}
+	}
+
+	return true;
+}
+
+IPAddress FlowKey::getSrcIPAddress() const
+{
+	if (ipVersion == 6)
+		return IPv6Address(srcIP);
+	return IPv4Address(srcIP);
+}
+
+IPAddress FlowKey::getDstIPAddress() const
+{
+	if (ipVersion == 6)
+		return IPv6Address(dstIP);
+	return IPv4Address(dstIP);
+}
+
+uint64_t FlowKey::hash() const
+{
+	// the key is hashed as 5 64-bit words, each mixed with multiply-rotate steps and the result finalized with the MurmurHash3 fmix64 function
+	uint64_t words[sizeof(FlowKey) / sizeof(uint64_t)];
+	memcpy(words, this, sizeof(words));
+
+	uint64_t hash = 0x9E3779B97F4A7C15ULL;
+	for (size_t i = 0; i < sizeof(words) / sizeof(uint64_t); i++)
+	{
+		uint64_t word = words[i] * 0x87C37B91114253D5ULL;
+		word = (word << 31) | (word >> 33);
+		hash ^= word * 0x4CF5AD432745937FULL;
+		hash = ((hash << 27) | (hash >> 37)) * 5 + 0x52DCE729;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33;
+	hash *= 0xC4CEB9FE1A85EC53ULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+} // namespace pcpp
@@ -100,11 +100,7 @@ HttpRequestLayer& HttpRequestLayer::operator=(const HttpRequestLayer& other)
 
 std::string HttpRequestLayer::getUrl() const
 {
-	HeaderField* hostField = getFieldByName(PCPP_HTTP_HOST_FIELD);
-	if (hostField == nullptr)
-		return m_FirstLine->getUri();
-
-	return hostField->getFieldValue() + m_FirstLine->getUri();
+	return getFieldValueByName(PCPP_HTTP_HOST_FIELD) + m_FirstLine->getUri();
 }
 
 HttpRequestLayer::~HttpRequestLayer()
@@ -755,12 +751,7 @@ HeaderField* HttpResponseLayer::setContentLength(int contentLength, const std::s
 
 int HttpResponseLayer::getContentLength() const
 {
-	std::string contentLengthFieldName(PCPP_HTTP_CONTENT_LENGTH_FIELD);
-	std::transform(contentLengthFieldName.begin(), contentLengthFieldName.end(), contentLengthFieldName.begin(), ::tolower);
-	HeaderField* contentLengthField = getFieldByName(contentLengthFieldName);
-	if (contentLengthField != nullptr)
-		return atoi(contentLengthField->getFieldValue().c_str());
-	return 0;
+	return atoi(getFieldValueByName(PCPP_HTTP_CONTENT_LENGTH_FIELD).c_str());
 }
 
 std::string HttpResponseLayer::toString() const
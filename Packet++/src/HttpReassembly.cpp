@@ -0,0 +1,750 @@
+#define LOG_MODULE PacketLogModuleHttpLayer
+
+#include "HttpReassembly.h"
+#include "Logger.h"
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+
+// the longest chunk size that can be parsed: 15 hex digits keep it below 2^60
+#define MAX_CHUNK_SIZE_DIGITS 15
+
+// the longest Content-Length value that can be parsed: 18 decimal digits fit in int64_t
+#define MAX_CONTENT_LENGTH_DIGITS 18
+
+namespace pcpp
+{
+
+// ~~~~~~~~~~~~~~~~
+// Helper functions
+// ~~~~~~~~~~~~~~~~
+
+struct HttpMethodToken
+{
+	const char* name;
+	size_t nameLen;
+	HttpRequestLayer::HttpMethod method;
+};
+
+static const HttpMethodToken HttpMethodTokens[] =
+{
+	{ "GET", 3, HttpRequestLayer::HttpGET },
+	{ "HEAD", 4, HttpRequestLayer::HttpHEAD },
+	{ "POST", 4, HttpRequestLayer::HttpPOST },
+	{ "PUT", 3, HttpRequestLayer::HttpPUT },
+	{ "DELETE", 6, HttpRequestLayer::HttpDELETE },
+	{ "TRACE", 5, HttpRequestLayer::HttpTRACE },
+	{ "OPTIONS", 7, HttpRequestLayer::HttpOPTIONS },
+	{ "CONNECT", 7, HttpRequestLayer::HttpCONNECT },
+	{ "PATCH", 5, HttpRequestLayer::HttpPATCH }
+};
+
+// parse the method of a request start line without allocating memory. The method must be followed by a space
+static HttpRequestLayer::HttpMethod parseMethodToken(const uint8_t* data, size_t dataLen)
+{
+	for (size_t i = 0; i < sizeof(HttpMethodTokens) / sizeof(HttpMethodTokens[0]); i++)
+	{
+		const HttpMethodToken& token = HttpMethodTokens[i];
+		if (dataLen > token.nameLen && data[token.nameLen] == ' ' && memcmp(data, token.name, token.nameLen) == 0)
+			return token.method;
+	}
+
+	return HttpRequestLayer::HttpMethodUnknown;
+}
+
+static bool isResponseStartLine(const uint8_t* data, size_t dataLen)
+{
+	return dataLen >= 7 && memcmp(data, "HTTP/1.", 7) == 0;
+}
+
+// find the end of a message header: the empty line after the header fields. Returns the header length including the empty line,
+// or 0 if the header doesn't end in the data
+static size_t findHeaderEnd(const uint8_t* data, size_t dataLen, size_t searchFrom)
+{
+	const uint8_t* end = data + dataLen;
+	const uint8_t* pos = data + searchFrom;
+	while (pos < end)
+	{
+		pos = static_cast<const uint8_t*>(memchr(pos, '\n', end - pos));
+		if (pos == nullptr)
+			return 0;
+
+		pos++;
+		if (pos < end && *pos == '\n')
+			return pos + 1 - data;
+		if (pos + 1 < end && pos[0] == '\r' && pos[1] == '\n')
+			return pos + 2 - data;
+	}
+
+	return 0;
+}
+
+static bool equalsIgnoreCase(const uint8_t* data, size_t dataLen, const char* str, size_t strLen)
+{
+	if (dataLen != strLen)
+		return false;
+
+	for (size_t i = 0; i < dataLen; i++)
+	{
+		if (tolower(data[i]) != str[i])
+			return false;
+	}
+
+	return true;
+}
+
+static void trimSpaces(const uint8_t*& data, size_t& dataLen)
+{
+	while (dataLen > 0 && (data[0] == ' ' || data[0] == '\t'))
+	{
+		data++;
+		dataLen--;
+	}
+
+	while (dataLen > 0 && (data[dataLen - 1] == ' ' || data[dataLen - 1] == '\t' || data[dataLen - 1] == '\r'))
+		dataLen--;
+}
+
+// iterate over the header field lines of a message header (skipping the start line). Returns false when there are no more fields
+static bool getNextHeaderField(const uint8_t* header, size_t headerLen, size_t& offset, const uint8_t*& name, size_t& nameLen, const uint8_t*& value, size_t& valueLen)
+{
+	while (offset < headerLen)
+	{
+		const uint8_t* line = header + offset;
+		const uint8_t* lineEnd = static_cast<const uint8_t*>(memchr(line, '\n', headerLen - offset));
+		if (lineEnd == nullptr)
+			lineEnd = header + headerLen;
+		offset = lineEnd + 1 - header;
+
+		const uint8_t* colon = static_cast<const uint8_t*>(memchr(line, ':', lineEnd - line));
+		if (colon == nullptr)
+			continue;
+
+		name = line;
+		nameLen = colon - line;
+		trimSpaces(name, nameLen);
+		value = colon + 1;
+		valueLen = lineEnd - value;
+		trimSpaces(value, valueLen);
+		return true;
+	}
+
+	return false;
+}
+
+static size_t getStartLineLength(const uint8_t* header, size_t headerLen)
+{
+	const uint8_t* lineEnd = static_cast<const uint8_t*>(memchr(header, '\n', headerLen));
+	return lineEnd == nullptr ? headerLen : lineEnd + 1 - header;
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+// HttpMessageData members
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+
+std::string HttpMessageData::getFieldValue(const std::string& fieldName) const
+{
+	if (header == nullptr)
+		return "";
+
+	std::string lowerFieldName(fieldName);
+	for (std::string::iterator iter = lowerFieldName.begin(); iter != lowerFieldName.end(); iter++)
+		*iter = tolower(*iter);
+
+	size_t offset = getStartLineLength(header, headerLength);
+	const uint8_t* name;
+	const uint8_t* value;
+	size_t nameLen, valueLen;
+	while (getNextHeaderField(header, headerLength, offset, name, nameLen, value, valueLen))
+	{
+		if (equalsIgnoreCase(name, nameLen, lowerFieldName.c_str(), lowerFieldName.length()))
+			return std::string(reinterpret_cast<const char*>(value), valueLen);
+	}
+
+	return "";
+}
+
+std::string HttpMessageData::getUri() const
+{
+	if (header == nullptr || !isRequest)
+		return "";
+
+	size_t startLineLen = getStartLineLength(header, headerLength);
+	const uint8_t* uri = static_cast<const uint8_t*>(memchr(header, ' ', startLineLen));
+	if (uri == nullptr)
+		return "";
+
+	uri++;
+	const uint8_t* uriEnd = static_cast<const uint8_t*>(memchr(uri, ' ', header + startLineLen - uri));
+	if (uriEnd == nullptr)
+		return "";
+
+	return std::string(reinterpret_cast<const char*>(uri), uriEnd - uri);
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// HttpReassembly members
+// ~~~~~~~~~~~~~~~~~~~~~~~
+
+HttpReassembly::HttpReassembly(OnHttpMessageEnd onMessageEndCallback, void* userCookie, OnHttpTransactionEnd onTransactionEndCallback,
+	OnHttpMessageHeaders onMessageHeadersCallback, OnHttpMessageBody onMessageBodyCallback, const HttpReassemblyConfiguration& config) :
+	m_OnMessageEnd(onMessageEndCallback), m_OnTransactionEnd(onTransactionEndCallback), m_OnMessageHeaders(onMessageHeadersCallback),
+	m_OnMessageBody(onMessageBodyCallback), m_UserCookie(userCookie), m_Config(config)
+{
+}
+
+void HttpReassembly::onTcpMessageReady(int8_t side, const TcpStreamData& tcpData)
+{
+	if (side != 0 && side != 1)
+		return;
+
+	HttpConnectionState& conn = m_Connections[tcpData.getConnectionData().flowKey];
+	HttpSideState& sideState = conn.sides[side];
+	sideState.message.side = side;
+	sideState.message.flowKey = tcpData.getConnectionData().flowKey;
+
+	const uint8_t* data = tcpData.getData();
+	size_t dataLen = tcpData.getDataLength();
+	timeval timestamp = tcpData.getTimeStamp();
+
+	if (sideState.inMessage)
+		sideState.message.endTime = timestamp;
+
+	if (tcpData.isBytesMissing())
+	{
+		// TcpReassembly puts a "[X bytes missing]" text before the data that follows the missing bytes
+		char missingDataText[48];
+		int missingDataTextLen = snprintf(missingDataText, sizeof(missingDataText), "[%llu bytes missing]", (unsigned long long)tcpData.getMissingByteCount());
+		if (missingDataTextLen > 0 && dataLen >= (size_t)missingDataTextLen && memcmp(data, missingDataText, missingDataTextLen) == 0)
+		{
+			data += missingDataTextLen;
+			dataLen -= missingDataTextLen;
+		}
+
+		handleMissingData(conn, sideState, tcpData.getMissingByteCount());
+	}
+
+	size_t offset = 0;
+	while (offset < dataLen)
+	{
+		const uint8_t* curData = data + offset;
+		size_t curDataLen = dataLen - offset;
+		size_t consumed = curDataLen;
+
+		switch (sideState.state)
+		{
+		case StateHeader:
+			consumed = processHeader(conn, sideState, curData, curDataLen, timestamp);
+			break;
+
+		case StateFixedBody:
+		case StateChunkData:
+			if (consumed > sideState.bytesRemaining)
+				consumed = (size_t)sideState.bytesRemaining;
+			handleBody(sideState, curData, consumed);
+			sideState.bytesRemaining -= consumed;
+			if (sideState.bytesRemaining == 0)
+			{
+				if (sideState.state == StateFixedBody)
+					endMessage(conn, sideState, true);
+				else
+					sideState.state = StateChunkDataEnd;
+			}
+			break;
+
+		case StateChunkSize:
+		case StateChunkDataEnd:
+		case StateChunkTrailer:
+			consumed = processChunkLine(conn, sideState, curData, curDataLen);
+			break;
+
+		case StateBodyUntilClose:
+			handleBody(sideState, curData, curDataLen);
+			break;
+
+		case StateResync:
+			consumed = findStartLine(sideState, curData, curDataLen);
+			if (consumed < curDataLen)
+			{
+				PCPP_LOG_DEBUG("Found an HTTP start line on side " << (int)side << " of flow " << sideState.message.flowKey << ", resuming parsing");
+				sideState.state = StateHeader;
+			}
+			break;
+
+		case StateIgnore:
+			break;
+		}
+
+		offset += consumed;
+	}
+}
+
+void HttpReassembly::onTcpConnectionEnd(const ConnectionData& connectionData)
+{
+	ConnectionStateMap::iterator iter = m_Connections.find(connectionData.flowKey);
+	if (iter == m_Connections.end())
+		return;
+
+	endConnection(iter->second);
+	m_Connections.erase(iter);
+}
+
+void HttpReassembly::closeAllConnections()
+{
+	for (ConnectionStateMap::iterator iter = m_Connections.begin(); iter != m_Connections.end(); iter++)
+		endConnection(iter->second);
+
+	m_Connections.clear();
+}
+
+void HttpReassembly::tcpMessageReadyCallback(int8_t side, const TcpStreamData& tcpData, void* userCookie)
+{
+	static_cast<HttpReassembly*>(userCookie)->onTcpMessageReady(side, tcpData);
+}
+
+void HttpReassembly::tcpConnectionEndCallback(const ConnectionData& connectionData, TcpReassembly::ConnectionEndReason /*reason*/, void* userCookie)
+{
+	static_cast<HttpReassembly*>(userCookie)->onTcpConnectionEnd(connectionData);
+}
+
+size_t HttpReassembly::getBufferedDataSize() const
+{
+	size_t result = 0;
+	for (ConnectionStateMap::const_iterator iter = m_Connections.begin(); iter != m_Connections.end(); iter++)
+		result += iter->second.sides[0].lineBuffer.size() + iter->second.sides[1].lineBuffer.size();
+
+	return result;
+}
+
+size_t HttpReassembly::processHeader(HttpConnectionState& conn, HttpSideState& sideState, const uint8_t* data, size_t dataLen, const timeval& timestamp)
+{
+	size_t offset = 0;
+	if (!sideState.inMessage)
+	{
+		// empty lines before the start line are allowed and ignored
+		while (offset < dataLen && (data[offset] == '\r' || data[offset] == '\n'))
+			offset++;
+
+		if (offset == dataLen)
+			return dataLen;
+
+		int8_t side = sideState.message.side;
+		uint32_t flowKey = sideState.message.flowKey;
+		sideState.message = HttpMessageData();
+		sideState.message.side = side;
+		sideState.message.flowKey = flowKey;
+		sideState.message.isRequest = (sideState.role == RoleClient);
+		sideState.message.startTime = timestamp;
+		sideState.message.endTime = timestamp;
+		sideState.inMessage = true;
+	}
+
+	const uint8_t* header = data + offset;
+	size_t headerLen;
+	size_t consumed;
+	if (sideState.lineBuffer.empty())
+	{
+		// the whole header is in this piece of data, no need to copy it
+		headerLen = findHeaderEnd(header, dataLen - offset, 0);
+		if (headerLen == 0)
+		{
+			if (dataLen - offset > m_Config.maxHeaderSize)
+				headerLen = 0;
+			else
+			{
+				sideState.lineBuffer.assign(header, data + dataLen);
+				return dataLen;
+			}
+		}
+
+		consumed = offset + headerLen;
+	}
+	else
+	{
+		size_t prevLen = sideState.lineBuffer.size();
+		size_t copyLen = dataLen;
+		if (prevLen + copyLen > m_Config.maxHeaderSize)
+			copyLen = (m_Config.maxHeaderSize > prevLen ? m_Config.maxHeaderSize - prevLen : 0);
+		sideState.lineBuffer.insert(sideState.lineBuffer.end(), data, data + copyLen);
+
+		headerLen = findHeaderEnd(sideState.lineBuffer.data(), sideState.lineBuffer.size(), prevLen >= 2 ? prevLen - 2 : 0);
+		if (headerLen == 0 && copyLen == dataLen)
+			return dataLen;
+
+		header = sideState.lineBuffer.data();
+		consumed = headerLen - prevLen;
+	}
+
+	if (headerLen == 0)
+	{
+		PCPP_LOG_DEBUG("HTTP header on side " << (int)sideState.message.side << " of flow " << sideState.message.flowKey << " exceeds " << m_Config.maxHeaderSize << " bytes, ignoring the rest of this side");
+		endMessage(conn, sideState, false);
+		sideState.state = StateIgnore;
+		std::vector<uint8_t>().swap(sideState.lineBuffer);
+		return dataLen;
+	}
+
+	if (!parseHeader(conn, sideState, header, headerLen))
+	{
+		PCPP_LOG_DEBUG("Data on side " << (int)sideState.message.side << " of flow " << sideState.message.flowKey << " isn't an HTTP message, looking for the next start line");
+		sideState.inMessage = false;
+		sideState.lineBuffer.clear();
+		sideState.state = StateResync;
+		conn.outOfSync = true;
+		conn.pendingRequests.clear();
+		// skip the first byte so the same data isn't found again as a start line
+		return offset + 1;
+	}
+
+	sideState.message.header = header;
+	sideState.message.headerLength = headerLen;
+	sideState.message.wireLength = headerLen;
+	if (m_OnMessageHeaders != nullptr)
+		m_OnMessageHeaders(sideState.message, m_UserCookie);
+	sideState.message.header = nullptr;
+	sideState.lineBuffer.clear();
+
+	// the state is left as StateHeader for messages without a body
+	if (sideState.state == StateHeader)
+		endMessage(conn, sideState, true);
+
+	return consumed;
+}
+
+bool HttpReassembly::parseHeader(HttpConnectionState& conn, HttpSideState& sideState, const uint8_t* header, size_t headerLen)
+{
+	HttpMessageData& message = sideState.message;
+	if (isResponseStartLine(header, headerLen))
+	{
+		if (sideState.role == RoleClient || headerLen < 12 || header[8] != ' ' || !isdigit(header[9]) || !isdigit(header[10]) || !isdigit(header[11]))
+			return false;
+
+		sideState.role = RoleServer;
+		message.isRequest = false;
+		message.statusCode = (header[9] - '0') * 100 + (header[10] - '0') * 10 + (header[11] - '0');
+		if (!conn.outOfSync && !conn.pendingRequests.empty())
+			message.method = conn.pendingRequests.front().method;
+	}
+	else
+	{
+		HttpRequestLayer::HttpMethod method = parseMethodToken(header, headerLen);
+		if (sideState.role == RoleServer || method == HttpRequestLayer::HttpMethodUnknown)
+			return false;
+
+		sideState.role = RoleClient;
+		message.isRequest = true;
+		message.method = method;
+	}
+
+	size_t offset = getStartLineLength(header, headerLen);
+	const uint8_t* name;
+	const uint8_t* value;
+	size_t nameLen, valueLen;
+	while (getNextHeaderField(header, headerLen, offset, name, nameLen, value, valueLen))
+	{
+		if (equalsIgnoreCase(name, nameLen, "content-length", 14))
+		{
+			if (valueLen == 0 || valueLen > MAX_CONTENT_LENGTH_DIGITS)
+				continue;
+
+			int64_t contentLength = 0;
+			size_t i = 0;
+			for (; i < valueLen && isdigit(value[i]); i++)
+				contentLength = contentLength * 10 + (value[i] - '0');
+
+			if (i == valueLen)
+				message.contentLength = contentLength;
+		}
+		else if (equalsIgnoreCase(name, nameLen, "transfer-encoding", 17))
+		{
+			// chunked must be the last transfer coding applied
+			message.isChunked = (valueLen >= 7 && equalsIgnoreCase(value + valueLen - 7, 7, "chunked", 7));
+		}
+	}
+
+	// messages without a body keep the StateHeader state
+	sideState.state = StateHeader;
+	sideState.bytesRemaining = 0;
+
+	if (!message.isRequest)
+	{
+		int statusCode = message.statusCode;
+		if ((statusCode >= 100 && statusCode < 200) || statusCode == 204 || statusCode == 304 || message.method == HttpRequestLayer::HttpHEAD ||
+			(message.method == HttpRequestLayer::HttpCONNECT && statusCode >= 200 && statusCode < 300))
+			return true;
+	}
+
+	if (message.isChunked)
+		sideState.state = StateChunkSize;
+	else if (message.contentLength > 0)
+	{
+		sideState.state = StateFixedBody;
+		sideState.bytesRemaining = message.contentLength;
+	}
+	else if (message.contentLength < 0 && !message.isRequest)
+		sideState.state = StateBodyUntilClose;
+
+	return true;
+}
+
+size_t HttpReassembly::processChunkLine(HttpConnectionState& conn, HttpSideState& sideState, const uint8_t* data, size_t dataLen)
+{
+	size_t consumed;
+	const uint8_t* line;
+	size_t lineLen;
+	if (!readLine(sideState, data, dataLen, consumed, line, lineLen))
+	{
+		PCPP_LOG_DEBUG("Chunked body line on side " << (int)sideState.message.side << " of flow " << sideState.message.flowKey << " exceeds " << m_Config.maxHeaderSize << " bytes");
+		endMessage(conn, sideState, false);
+		sideState.state = StateResync;
+		conn.outOfSync = true;
+		conn.pendingRequests.clear();
+		std::vector<uint8_t>().swap(sideState.lineBuffer);
+		return dataLen;
+	}
+
+	sideState.message.wireLength += consumed;
+
+	// the line isn't complete yet
+	if (line == nullptr)
+		return consumed;
+
+	bool isValid = true;
+	switch (sideState.state)
+	{
+	case StateChunkSize:
+	{
+		uint64_t chunkSize = 0;
+		size_t numOfDigits = 0;
+		for (; numOfDigits < lineLen && isxdigit(line[numOfDigits]); numOfDigits++)
+		{
+			uint8_t digit = line[numOfDigits];
+			chunkSize = (chunkSize << 4) | (isdigit(digit) ? digit - '0' : tolower(digit) - 'a' + 10);
+		}
+
+		// chunk extensions after the size are ignored
+		if (numOfDigits == 0 || numOfDigits > MAX_CHUNK_SIZE_DIGITS || (numOfDigits < lineLen && line[numOfDigits] != ';' && line[numOfDigits] != ' ' && line[numOfDigits] != '\t'))
+			isValid = false;
+		else if (chunkSize == 0)
+			sideState.state = StateChunkTrailer;
+		else
+		{
+			sideState.state = StateChunkData;
+			sideState.bytesRemaining = chunkSize;
+		}
+		break;
+	}
+
+	case StateChunkDataEnd:
+		isValid = (lineLen == 0);
+		sideState.state = StateChunkSize;
+		break;
+
+	default:
+		// trailer fields are ignored, an empty line ends the message
+		if (lineLen == 0)
+		{
+			sideState.lineBuffer.clear();
+			endMessage(conn, sideState, true);
+			return consumed;
+		}
+		break;
+	}
+
+	sideState.lineBuffer.clear();
+
+	if (!isValid)
+	{
+		PCPP_LOG_DEBUG("Malformed chunked body on side " << (int)sideState.message.side << " of flow " << sideState.message.flowKey << ", looking for the next start line");
+		endMessage(conn, sideState, false);
+		sideState.state = StateResync;
+		conn.outOfSync = true;
+		conn.pendingRequests.clear();
+	}
+
+	return consumed;
+}
+
+bool HttpReassembly::readLine(HttpSideState& sideState, const uint8_t* data, size_t dataLen, size_t& consumed, const uint8_t*& line, size_t& lineLen)
+{
+	const uint8_t* lineEnd = static_cast<const uint8_t*>(memchr(data, '\n', dataLen));
+	size_t copyLen = (lineEnd == nullptr ? dataLen : lineEnd - data);
+
+	if (sideState.lineBuffer.size() + copyLen > m_Config.maxHeaderSize)
+		return false;
+
+	if (lineEnd == nullptr)
+	{
+		sideState.lineBuffer.insert(sideState.lineBuffer.end(), data, data + dataLen);
+		consumed = dataLen;
+		line = nullptr;
+		lineLen = 0;
+		return true;
+	}
+
+	consumed = copyLen + 1;
+	if (sideState.lineBuffer.empty())
+		line = data;
+	else
+	{
+		sideState.lineBuffer.insert(sideState.lineBuffer.end(), data, data + copyLen);
+		line = sideState.lineBuffer.data();
+		copyLen = sideState.lineBuffer.size();
+	}
+
+	lineLen = copyLen;
+	if (lineLen > 0 && line[lineLen - 1] == '\r')
+		lineLen--;
+
+	return true;
+}
+
+size_t HttpReassembly::findStartLine(const HttpSideState& sideState, const uint8_t* data, size_t dataLen) const
+{
+	// a start line can only begin at the beginning of a line
+	const uint8_t* end = data + dataLen;
+	const uint8_t* pos = data;
+	while (pos < end)
+	{
+		if ((sideState.role != RoleClient && isResponseStartLine(pos, end - pos)) ||
+			(sideState.role != RoleServer && parseMethodToken(pos, end - pos) != HttpRequestLayer::HttpMethodUnknown))
+			return pos - data;
+
+		pos = static_cast<const uint8_t*>(memchr(pos, '\n', end - pos));
+		if (pos == nullptr)
+			break;
+		pos++;
+	}
+
+	return dataLen;
+}
+
+void HttpReassembly::handleMissingData(HttpConnectionState& conn, HttpSideState& sideState, size_t missingBytes)
+{
+	if (sideState.inMessage)
+	{
+		sideState.message.isBytesMissing = true;
+		sideState.message.wireLength += missingBytes;
+	}
+
+	switch (sideState.state)
+	{
+	case StateFixedBody:
+	case StateChunkData:
+		// the missing bytes are part of the body, the data after them is still in sync
+		if (missingBytes <= sideState.bytesRemaining)
+		{
+			sideState.bytesRemaining -= missingBytes;
+			if (sideState.bytesRemaining == 0)
+			{
+				// the gap ends exactly where the body or the chunk data ends
+				if (sideState.state == StateFixedBody)
+					endMessage(conn, sideState, true);
+				else
+					sideState.state = StateChunkDataEnd;
+			}
+			return;
+		}
+		break;
+
+	case StateBodyUntilClose:
+	case StateResync:
+	case StateIgnore:
+		return;
+
+	default:
+		break;
+	}
+
+	PCPP_LOG_DEBUG(missingBytes << " bytes missing on side " << (int)sideState.message.side << " of flow " << sideState.message.flowKey << ", looking for the next start line");
+	if (sideState.inMessage)
+		endMessage(conn, sideState, false);
+	sideState.lineBuffer.clear();
+	sideState.state = StateResync;
+	conn.outOfSync = true;
+	conn.pendingRequests.clear();
+}
+
+void HttpReassembly::handleBody(HttpSideState& sideState, const uint8_t* data, size_t dataLen)
+{
+	sideState.message.bodyLength += dataLen;
+	sideState.message.wireLength += dataLen;
+	if (m_OnMessageBody != nullptr && dataLen > 0)
+		m_OnMessageBody(sideState.message, data, dataLen, m_UserCookie);
+}
+
+void HttpReassembly::endMessage(HttpConnectionState& conn, HttpSideState& sideState, bool isComplete)
+{
+	HttpMessageData& message = sideState.message;
+	message.isComplete = isComplete;
+	message.header = nullptr;
+
+	if (m_OnMessageEnd != nullptr)
+		m_OnMessageEnd(message, m_UserCookie);
+
+	// messages whose header wasn't parsed can't be matched
+	if (message.headerLength > 0)
+	{
+		if (message.isRequest)
+		{
+			if (!conn.outOfSync)
+			{
+				if (conn.pendingRequests.size() < m_Config.maxPendingRequests)
+					conn.pendingRequests.push_back(message);
+				else
+				{
+					PCPP_LOG_DEBUG("Too many pending HTTP requests in flow " << message.flowKey << ", requests are no longer matched to responses");
+					conn.outOfSync = true;
+					conn.pendingRequests.clear();
+				}
+			}
+		}
+		// informational responses precede the final response to the same request
+		else if (message.statusCode >= 200 || message.statusCode < 100 || message.statusCode == 101)
+		{
+			if (!conn.outOfSync && !conn.pendingRequests.empty())
+			{
+				if (m_OnTransactionEnd != nullptr)
+					m_OnTransactionEnd(conn.pendingRequests.front(), message, m_UserCookie);
+				conn.pendingRequests.pop_front();
+			}
+
+			// after a protocol switch or a successful CONNECT the connection no longer carries HTTP
+			if (isComplete && (message.statusCode == 101 || (message.method == HttpRequestLayer::HttpCONNECT && message.statusCode >= 200 && message.statusCode < 300)))
+			{
+				for (int side = 0; side < 2; side++)
+				{
+					conn.sides[side].state = StateIgnore;
+					conn.sides[side].lineBuffer.clear();
+				}
+			}
+		}
+	}
+
+	sideState.inMessage = false;
+	sideState.bytesRemaining = 0;
+	if (sideState.state != StateIgnore)
+		sideState.state = StateHeader;
+}
+
+void HttpReassembly::endConnection(HttpConnectionState& conn)
+{
+	// handle the requests first so responses ending with the connection can still be matched to them
+	for (int i = 0; i < 2; i++)
+	{
+		HttpSideState& sideState = conn.sides[i];
+		if (sideState.inMessage && sideState.role != RoleServer)
+			endMessage(conn, sideState, false);
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		HttpSideState& sideState = conn.sides[i];
+		if (sideState.inMessage)
+			endMessage(conn, sideState, sideState.state == StateBodyUntilClose);
+	}
+}
+
+} // namespace pcpp
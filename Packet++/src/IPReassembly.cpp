@@ -6,8 +6,12 @@
 #include "PacketUtils.h"
 #include "Logger.h"
 #include <string.h>
+#include <algorithm>
 #include "EndianPortable.h"
 
+// the maximum IP payload length of a reassembled packet
+#define IP_REASSEMBLY_MAX_PAYLOAD_LEN 0xFFFF
+
 namespace pcpp
 {
 
@@ -52,9 +56,9 @@ public:
 	virtual bool isLastFragment() = 0;
 	virtual uint16_t getFragmentOffset() = 0;
 	virtual uint32_t getFragmentId() = 0;
-	virtual uint32_t hashPacket() = 0;
-	virtual IPReassembly::PacketKey* createPacketKey() = 0;
+	virtual const IPReassembly::PacketKey& getPacketKey() = 0;
 
+	virtual uint8_t* getIPLayerData() = 0;
 	virtual uint8_t* getIPLayerPayload() = 0;
 	virtual size_t getIPLayerPayloadSize() = 0;
 
@@ -100,23 +104,15 @@ public:
 		return (uint32_t)be16toh(m_IPLayer->getIPv4Header()->ipId);
 	}
 
-	uint32_t hashPacket() override
+	const IPReassembly::PacketKey& getPacketKey() override
 	{
-		ScalarBuffer<uint8_t> vec[3];
-
-		vec[0].buffer = (uint8_t*)&m_IPLayer->getIPv4Header()->ipSrc;
-		vec[0].len = 4;
-		vec[1].buffer = (uint8_t*)&m_IPLayer->getIPv4Header()->ipDst;
-		vec[1].len = 4;
-		vec[2].buffer = (uint8_t*)&m_IPLayer->getIPv4Header()->ipId;
-		vec[2].len = 2;
-
-		return pcpp::fnvHash(vec, 3);
+		m_PacketKey = IPReassembly::IPv4PacketKey(be16toh(m_IPLayer->getIPv4Header()->ipId), m_IPLayer->getSrcIPv4Address(), m_IPLayer->getDstIPv4Address());
+		return m_PacketKey;
 	}
 
-	IPReassembly::PacketKey* createPacketKey() override
+	uint8_t* getIPLayerData() override
 	{
-		return new IPReassembly::IPv4PacketKey(be16toh(m_IPLayer->getIPv4Header()->ipId), m_IPLayer->getSrcIPv4Address(), m_IPLayer->getDstIPv4Address());
+		return m_IPLayer->getData();
 	}
 
 	uint8_t* getIPLayerPayload() override
@@ -131,6 +127,7 @@ public:
 
 private:
 	IPv4Layer* m_IPLayer;
+	IPReassembly::IPv4PacketKey m_PacketKey;
 
 };
 
@@ -183,26 +180,15 @@ public:
 		return be32toh(m_FragHeader->getFragHeader()->id);
 	}
 
-	uint32_t hashPacket() override
+	const IPReassembly::PacketKey& getPacketKey() override
 	{
-		if (m_FragHeader == nullptr)
-			return 0;
-
-		ScalarBuffer<uint8_t> vec[3];
-
-		vec[0].buffer = m_IPLayer->getIPv6Header()->ipSrc;
-		vec[0].len = 16;
-		vec[1].buffer = m_IPLayer->getIPv6Header()->ipDst;
-		vec[1].len = 16;
-		vec[2].buffer = (uint8_t*)&m_FragHeader->getFragHeader()->id;
-		vec[2].len = 4;
-
-		return pcpp::fnvHash(vec, 3);
+		m_PacketKey = IPReassembly::IPv6PacketKey(be32toh(m_FragHeader->getFragHeader()->id), m_IPLayer->getSrcIPv6Address(), m_IPLayer->getDstIPv6Address());
+		return m_PacketKey;
 	}
 
-	IPReassembly::PacketKey* createPacketKey() override
+	uint8_t* getIPLayerData() override
 	{
-		return new IPReassembly::IPv6PacketKey(be32toh(m_FragHeader->getFragHeader()->id), m_IPLayer->getSrcIPv6Address(), m_IPLayer->getDstIPv6Address());
+		return m_IPLayer->getData();
 	}
 
 	uint8_t* getIPLayerPayload() override
@@ -218,6 +204,7 @@ public:
 private:
 	IPv6Layer* m_IPLayer;
 	IPv6FragmentationHeader* m_FragHeader;
+	IPReassembly::IPv6PacketKey m_PacketKey;
 
 };
 
@@ -262,14 +249,37 @@ uint32_t IPReassembly::IPv6PacketKey::getHashValue() const
 
 
 
+void IPReassembly::IPFragmentData::reset(uint32_t fragId, ProtocolType ipProtocol)
+{
+	headroom = 0;
+	headerLen = 0;
+	ipHeaderOffset = 0;
+	currentOffset = 0;
+	totalPayloadLen = 0;
+	fragmentID = fragId;
+	numOfFragments = 0;
+	protocol = ipProtocol;
+	timestamp.tv_sec = 0;
+	timestamp.tv_nsec = 0;
+	linkLayerType = LINKTYPE_ETHERNET;
+	outOfOrderDataLen = 0;
+	outOfOrderFragments.clear();
+}
+
+bool IPReassembly::FragmentEntryEqual::operator()(const FragmentEntry& first, const FragmentEntry& second) const
+{
+	return first.key.hash == second.key.hash &&
+		first.key.fragmentID == second.key.fragmentID &&
+		first.key.protocol == second.key.protocol &&
+		memcmp(first.key.srcIP, second.key.srcIP, sizeof(first.key.srcIP)) == 0 &&
+		memcmp(first.key.dstIP, second.key.dstIP, sizeof(first.key.dstIP)) == 0;
+}
+
 IPReassembly::~IPReassembly()
 {
-	// empty the map - go over all keys, delete all IPFragmentData objects and remove them from the map
-	while (!m_FragmentMap.empty())
-	{
-		delete m_FragmentMap.begin()->second;
-		m_FragmentMap.erase(m_FragmentMap.begin());
-	}
+	// the pool holds all reassembly state objects, including the ones of packets which are still being reassembled
+	for (std::vector<IPFragmentData*>::iterator iter = m_FragmentDataPool.begin(); iter != m_FragmentDataPool.end(); ++iter)
+		delete *iter;
 }
 
 Packet* IPReassembly::processPacket(Packet* fragment, ReassemblyStatus& status, ProtocolType parseUntil, OsiModelLayer parseUntilLayer)
@@ -284,9 +294,6 @@ Packet* IPReassembly::processPacket(Packet* fragment, ReassemblyStatus& status,
 		return fragment;
 	}
 
-	// get IPv4 layer
-	//IPv4Layer* ipLayer = fragment->getLayerOfType<IPv4Layer>();
-
 	// create fragment wrapper
 	IPv4FragmentWrapper ipv4Wrapper(fragment);
 	IPv6FragmentWrapper ipv6Wrapper(fragment);
@@ -304,54 +311,57 @@ Packet* IPReassembly::processPacket(Packet* fragment, ReassemblyStatus& status,
 		return fragment;
 	}
 
-	// create a hash from source IP, destination IP and IP/fragment ID
-	uint32_t hash = fragWrapper->hashPacket();
+	// find the packet this fragment belongs to by source IP, destination IP and IP/fragment ID, or start a new one
+	FragmentKey fragKey;
+	createFragmentKey(fragWrapper->getPacketKey(), fragKey);
+	IPFragmentData* fragData = getFragmentData(fragKey, fragWrapper->getFragmentId());
 
-	IPFragmentData* fragData = nullptr;
+	// the headers are everything from the beginning of the fragment until the IP layer payload. Data beyond the IP layer payload such as
+	// packet trailer isn't copied
+	RawPacket* fragmentRawPacket = fragment->getRawPacket();
+	uint8_t* payload = fragWrapper->getIPLayerPayload();
+	size_t payloadSize = fragWrapper->getIPLayerPayloadSize();
+	size_t headerLen = payload - fragmentRawPacket->getRawData();
+	size_t fragOffset = fragWrapper->getFragmentOffset();
+	size_t fragEnd = fragOffset + payloadSize;
 
-	// check whether this packet already exists in the map
-	std::map<uint32_t, IPFragmentData*>::iterator iter = m_FragmentMap.find(hash);
-
-	// this is the first fragment seen for this packet
-	if (iter == m_FragmentMap.end())
+	if (fragEnd > IP_REASSEMBLY_MAX_PAYLOAD_LEN)
 	{
-		PCPP_LOG_DEBUG("Got new packet with FragID=0x" << std::hex << fragWrapper->getFragmentId() << ", allocating place in map");
-
-		// create the IPFragmentData object
-		fragData = new IPFragmentData(fragWrapper->createPacketKey(), fragWrapper->getFragmentId());
-
-		// add the new fragment to the map
-		addNewFragment(hash, fragData);
+		PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Fragment exceeds the maximum IP payload length, ignoring it");
+		m_NumOfDroppedFragments++;
+		status = MALFORMED_FRAGMENT;
+		return nullptr;
 	}
-	else // packet was seen before
-	{
-		// get the IPFragmentData object
-		fragData = iter->second;
 
-		// mark this packet as used
-		m_PacketLRU.put(hash, nullptr);
-	}
+	if (fragWrapper->isLastFragment())
+		fragData->totalPayloadLen = fragEnd;
 
 	bool gotLastFragment = false;
 
 	// if current fragment is the first fragment of this packet
 	if (fragWrapper->isFirstFragment())
 	{
-		if (fragData->data == nullptr) // first fragment
+		if (fragData->headerLen == 0) // first fragment
 		{
-			PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragWrapper->getFragmentId() << "] Got first fragment, allocating RawPacket");
+			PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Got first fragment, copying it to the reassembly buffer");
 
-			// create the reassembled packet and copy the fragment data to it
-
-			// copy only data from the beginning of the fragment to the end of IP layer payload.
-			// Don't copy data beyond it such as packet trailer
-			auto fragmentRawPacket = fragment->getRawPacket();
-			auto rawDataLen = fragWrapper->getIPLayerPayload() - fragmentRawPacket ->getRawData() + fragWrapper->getIPLayerPayloadSize();
-			auto rawData = new uint8_t[rawDataLen];
-			memcpy(rawData, fragmentRawPacket->getRawData(), rawDataLen);
+			if (!reserveBuffer(fragData, headerLen, fragEnd))
+			{
+				PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Fragment doesn't fit in the memory budget, dropping it");
+				m_NumOfDroppedFragments++;
+				status = FRAGMENT_DROPPED;
+				return nullptr;
+			}
 
-			fragData->data = new RawPacket(rawData, rawDataLen, fragmentRawPacket->getPacketTimeStamp(), true, fragmentRawPacket->getLinkLayerType());
-			fragData->currentOffset = fragWrapper->getIPLayerPayloadSize();
+			// the headers are copied right before the payload
+			memcpy(fragData->buffer + fragData->headroom - headerLen, fragmentRawPacket->getRawData(), headerLen);
+			memcpy(fragData->buffer + fragData->headroom, payload, payloadSize);
+			fragData->headerLen = headerLen;
+			fragData->ipHeaderOffset = fragWrapper->getIPLayerData() - fragmentRawPacket->getRawData();
+			fragData->timestamp = fragmentRawPacket->getPacketTimeStamp();
+			fragData->linkLayerType = fragmentRawPacket->getLinkLayerType();
+			fragData->currentOffset = payloadSize;
+			fragData->numOfFragments++;
 			status = FIRST_FRAGMENT;
 
 			// check if the next fragments already arrived out-of-order and waiting in the out-of-order list
@@ -359,7 +369,8 @@ Packet* IPReassembly::processPacket(Packet* fragment, ReassemblyStatus& status,
 		}
 		else // duplicated first fragment
 		{
-			PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragWrapper->getFragmentId() << "] Got duplicated first fragment");
+			PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Got duplicated first fragment");
+			m_NumOfDroppedFragments++;
 			status = FRAGMENT;
 			return nullptr;
 		}
@@ -367,30 +378,34 @@ Packet* IPReassembly::processPacket(Packet* fragment, ReassemblyStatus& status,
 
 	else // not first fragment
 	{
-		PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragWrapper->getFragmentId() << "] Got fragment");
-
-		uint16_t fragOffset = fragWrapper->getFragmentOffset();
+		PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Got fragment");
 
 		// check if the current fragment offset matches the expected fragment offset
 		if (fragData->currentOffset == fragOffset)
 		{
 			// malformed fragment which is not the first fragment but its offset is 0
-			if (fragData->data == nullptr)
+			if (fragData->headerLen == 0)
 			{
-				PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragWrapper->getFragmentId() << "] Fragment is malformed");
+				PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Fragment is malformed");
+				m_NumOfDroppedFragments++;
 				status = MALFORMED_FRAGMENT;
 				return nullptr;
 			}
 
-			PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragWrapper->getFragmentId() << "] Found next matching fragment with offset " << fragOffset << ", adding fragment data to reassembled packet");
+			PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Found next matching fragment with offset " << fragOffset << ", adding fragment data to reassembled packet");
 
-			size_t payloadSize = fragWrapper->getIPLayerPayloadSize();
-			// copy fragment data to reassembled packet
-			fragData->data->reallocateData(fragData->data->getRawDataLen() + payloadSize);
-			fragData->data->appendData(fragWrapper->getIPLayerPayload(), payloadSize);
+			if (!reserveBuffer(fragData, 0, fragEnd))
+			{
+				PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Fragment doesn't fit in the memory budget, dropping it");
+				m_NumOfDroppedFragments++;
+				status = FRAGMENT_DROPPED;
+				return nullptr;
+			}
 
-			// update expected offset
-			fragData->currentOffset += payloadSize;
+			// copy fragment data to its place in the reassembled packet and update expected offset
+			memcpy(fragData->buffer + fragData->headroom + fragOffset, payload, payloadSize);
+			fragData->currentOffset = fragEnd;
+			fragData->numOfFragments++;
 
 			// if this is the last fragment - mark it
 			if (fragWrapper->isLastFragment())
@@ -402,26 +417,49 @@ Packet* IPReassembly::processPacket(Packet* fragment, ReassemblyStatus& status,
 		// if current fragment offset is larger than expected - this means this fragment is out-of-order
 		else if (fragOffset > fragData->currentOffset)
 		{
-			PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragWrapper->getFragmentId() << "] Got out-of-ordered fragment with offset " << fragOffset << " (expected: " << fragData->currentOffset << "). Adding it to out-of-order list");
+			PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Got out-of-ordered fragment with offset " << fragOffset << " (expected: " << fragData->currentOffset << "). Adding it to out-of-order list");
 
-			// create a new IPFragment and copy the fragment data and params to it
-			size_t payloadSize = fragWrapper->getIPLayerPayloadSize();
-			IPFragment* newFrag = new IPFragment();
-			newFrag->fragmentOffset = fragWrapper->getFragmentOffset();
-			newFrag->fragmentData = new uint8_t[payloadSize];
-			newFrag->fragmentDataLen = payloadSize;
-			memcpy(newFrag->fragmentData, fragWrapper->getIPLayerPayload(), newFrag->fragmentDataLen);
-			newFrag->lastFragment = fragWrapper->isLastFragment();
+			// with a memory budget, a fragment overlapping a fragment which is already waiting in the out-of-order list is dropped, so duplicated
+			// or overlapping fragments (a known attack vector) can't use up the budget. Without a budget it's stored, as it always was
+			for (std::vector<IPFragment>::iterator iter = fragData->outOfOrderFragments.begin(); m_MaxBytesToStore > 0 && iter != fragData->outOfOrderFragments.end(); ++iter)
+			{
+				if (fragOffset < iter->fragmentOffset + iter->fragmentDataLen && iter->fragmentOffset < fragEnd)
+				{
+					PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Fragment overlaps the out-of-order fragment with offset " << iter->fragmentOffset << ", dropping it");
+					m_NumOfDroppedFragments++;
+					status = FRAGMENT_DROPPED;
+					return nullptr;
+				}
+			}
 
-			// store the IPFragment in the out-of-order fragment list
-			fragData->outOfOrderFragments.pushBack(newFrag);
+			// the reassembly buffer grows only with the data received in order, so the data of out-of-order fragments is packed in a separate
+			// buffer. Otherwise a single small fragment with a high offset would make the reassembly buffer as large as the whole packet
+			if (!reserveOutOfOrderBuffer(fragData, fragData->outOfOrderDataLen + payloadSize))
+			{
+				PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Fragment doesn't fit in the memory budget, dropping it");
+				m_NumOfDroppedFragments++;
+				status = FRAGMENT_DROPPED;
+				return nullptr;
+			}
+
+			// copy the fragment data to the out-of-order buffer and store its params in the out-of-order fragment list
+			memcpy(fragData->outOfOrderBuffer + fragData->outOfOrderDataLen, payload, payloadSize);
+			IPFragment newFrag;
+			newFrag.fragmentOffset = fragOffset;
+			newFrag.fragmentDataLen = payloadSize;
+			newFrag.dataOffset = fragData->outOfOrderDataLen;
+			newFrag.lastFragment = fragWrapper->isLastFragment();
+			fragData->outOfOrderDataLen += payloadSize;
+			fragData->outOfOrderFragments.push_back(newFrag);
+			fragData->numOfFragments++;
 
 			status = OUT_OF_ORDER_FRAGMENT;
 			return nullptr;
 		}
 		else
 		{
-			PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragWrapper->getFragmentId() << "] Got a fragment with an offset that was already seen: " << fragOffset << " (current offset is: " << fragData->currentOffset << "), probably duplicated fragment");
+			PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Got a fragment with an offset that was already seen: " << fragOffset << " (current offset is: " << fragData->currentOffset << "), probably duplicated fragment");
+			m_NumOfDroppedFragments++;
 		}
 
 	}
@@ -429,50 +467,37 @@ Packet* IPReassembly::processPacket(Packet* fragment, ReassemblyStatus& status,
 	// if seen the last fragment
 	if (gotLastFragment)
 	{
-		PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragWrapper->getFragmentId() << "] Reassembly process completed, allocating a packet and returning it");
-		fragData->deleteData = false;
+		PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Reassembly process completed, allocating a packet and returning it");
 
-		// fix IP length field
-		if (fragData->packetKey->getProtocolType() == IPv4)
-		{
-			Packet tempPacket(fragData->data, IPv4);
-			IPv4Layer* ipLayer = tempPacket.getLayerOfType<IPv4Layer>();
-			iphdr* iphdr = ipLayer->getIPv4Header();
-			iphdr->totalLength = htobe16(fragData->currentOffset + ipLayer->getHeaderLen());
-			iphdr->fragmentOffset = 0;
-		}
-		else
-		{
-			Packet tempPacket(fragData->data, IPv6);
-			IPv6Layer* ipLayer = tempPacket.getLayerOfType<IPv6Layer>();
-			tempPacket.getLayerOfType<IPv6Layer>()->getIPv6Header()->payloadLength = fragData->currentOffset + ipLayer->getHeaderLen();
-		}
+		// the reassembly buffer is handed over to the reassembled packet. If the headroom is larger than the headers, the data is moved to
+		// the beginning of the buffer
+		uint8_t* data = fragData->buffer;
+		size_t headroomGap = fragData->headroom - fragData->headerLen;
+		if (headroomGap > 0)
+			memmove(data, data + headroomGap, fragData->headerLen + fragData->currentOffset);
 
-		// create a new Packet object with the reassembled data as its RawPacket
-		Packet* reassembledPacket = new Packet(fragData->data, true, parseUntil, parseUntilLayer);
+		m_CurrentBytesHeld -= fragData->bufferLen;
+		fragData->buffer = nullptr;
+		fragData->bufferLen = 0;
 
-		if (fragData->packetKey->getProtocolType() == IPv4)
+		Packet* reassembledPacket = createReassembledPacket(fragData, data, parseUntil, parseUntilLayer);
+		if (reassembledPacket == nullptr)
 		{
-			// re-calculate all IPv4 fields
-			reassembledPacket->getLayerOfType<IPv4Layer>()->computeCalculateFields();
+			PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Reassembled packet has no IP layer, dropping it");
+			m_NumOfDroppedFragments += fragData->numOfFragments;
+			status = MALFORMED_FRAGMENT;
 		}
 		else
-		{
-			// remove fragment extension
-			IPv6Layer* ipLayer = reassembledPacket->getLayerOfType<IPv6Layer>();
-			ipLayer->removeAllExtensions();
-
-			// re-calculate all IPv4 fields
-			ipLayer->computeCalculateFields();
-		}
+			status = REASSEMBLED;
 
-		PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragWrapper->getFragmentId() << "] Deleting fragment data from map");
+		PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Deleting fragment data from map");
 
-		// delete the IPFragmentData object and remove it from the map
-		delete fragData;
-		m_FragmentMap.erase(iter);
-		m_PacketLRU.eraseElement(hash);
-		status = REASSEMBLED;
+		// remove the packet from the map and release its reassembly state
+		FragmentEntry entry;
+		entry.key = fragKey;
+		entry.data = fragData;
+		m_PacketLRU.eraseElement(entry);
+		releaseFragmentData(fragData);
 		return reassembledPacket;
 	}
 
@@ -485,121 +510,244 @@ Packet* IPReassembly::processPacket(Packet* fragment, ReassemblyStatus& status,
 
 Packet* IPReassembly::processPacket(RawPacket* fragment, ReassemblyStatus& status, ProtocolType parseUntil, OsiModelLayer parseUntilLayer)
 {
-	Packet* parsedFragment = new Packet(fragment, false, parseUntil, parseUntilLayer);
-	Packet* result = processPacket(parsedFragment, status, parseUntil, parseUntilLayer);
-	if (result != parsedFragment)
-		delete parsedFragment;
+	// the fragment is parsed into a packet object owned by this instance, so processing fragments doesn't require allocating a packet.
+	// Only the IP layer is needed for the reassembly logic
+	m_FragmentPacket.setRawPacket(fragment, false, UnknownProtocol, OsiModelNetworkLayer);
+	Packet* result = processPacket(&m_FragmentPacket, status, parseUntil, parseUntilLayer);
+	m_FragmentPacket.setRawPacket(nullptr, false);
+
+	// non-IP and non-fragment packets are returned to the user in a new packet object
+	if (status == NON_IP_PACKET || status == NON_FRAGMENT)
+		result = new Packet(fragment, false, parseUntil, parseUntilLayer);
 
 	return result;
 }
 
 Packet* IPReassembly::getCurrentPacket(const PacketKey& key)
 {
-	// create a hash out of the packet key
-	uint32_t hash = key.getHashValue();
+	FragmentEntry entry;
+	createFragmentKey(key, entry.key);
+	entry.data = nullptr;
+
+	// look for this packet in the map
+	const FragmentEntry* storedEntry = m_PacketLRU.find(entry);
+
+	// some data already exists only if the first fragment arrived
+	if (storedEntry == nullptr || storedEntry->data->headerLen == 0)
+		return nullptr;
+
+	// copy the headers and the payload reassembled so far, which are contiguous in the reassembly buffer
+	IPFragmentData* fragData = storedEntry->data;
+	size_t partialDataLen = fragData->headerLen + fragData->currentOffset;
+	uint8_t* partialData = new uint8_t[partialDataLen];
+	memcpy(partialData, fragData->buffer + fragData->headroom - fragData->headerLen, partialDataLen);
+
+	return createReassembledPacket(fragData, partialData, UnknownProtocol, OsiModelLayerUnknown);
+}
 
-	// look for this hash value in the map
-	std::map<uint32_t, IPFragmentData*>::iterator iter = m_FragmentMap.find(hash);
+void IPReassembly::removePacket(const PacketKey& key)
+{
+	FragmentEntry entry;
+	createFragmentKey(key, entry.key);
+	entry.data = nullptr;
 
-	// hash was found
-	if (iter != m_FragmentMap.end())
+	// look for this packet in the map
+	const FragmentEntry* storedEntry = m_PacketLRU.find(entry);
+	if (storedEntry != nullptr)
 	{
-		IPFragmentData* fragData = iter->second;
+		// remove it from the map and free all data saved for it
+		IPFragmentData* fragData = storedEntry->data;
+		m_PacketLRU.eraseElement(entry);
+		releaseFragmentData(fragData);
+	}
+}
 
-		// some data already exists
-		if (fragData != nullptr && fragData->data != nullptr)
-		{
-			// create a copy of the RawPacket object
-			RawPacket* partialRawPacket = new RawPacket(*(fragData->data));
+void IPReassembly::createFragmentKey(const PacketKey& packetKey, FragmentKey& fragKey)
+{
+	memset(&fragKey, 0, sizeof(fragKey));
+	fragKey.hash = packetKey.getHashValue();
+	fragKey.protocol = packetKey.getProtocolType();
 
-			// fix IP length field
-			if (fragData->packetKey->getProtocolType() == IPv4)
-			{
-				Packet tempPacket(partialRawPacket, IPv4);
-				IPv4Layer* ipLayer = tempPacket.getLayerOfType<IPv4Layer>();
-				ipLayer->getIPv4Header()->totalLength = htobe16(fragData->currentOffset + ipLayer->getHeaderLen());
-			}
-			else
-			{
-				Packet tempPacket(partialRawPacket, IPv6);
-				IPv6Layer* ipLayer = tempPacket.getLayerOfType<IPv6Layer>();
-				tempPacket.getLayerOfType<IPv6Layer>()->getIPv6Header()->payloadLength = fragData->currentOffset + + ipLayer->getHeaderLen();
-			}
+	if (fragKey.protocol == IPv4)
+	{
+		const IPv4PacketKey& ipv4Key = static_cast<const IPv4PacketKey&>(packetKey);
+		fragKey.fragmentID = ipv4Key.getIpID();
+		memcpy(fragKey.srcIP, ipv4Key.getSrcIP().toBytes(), 4);
+		memcpy(fragKey.dstIP, ipv4Key.getDstIP().toBytes(), 4);
+	}
+	else
+	{
+		const IPv6PacketKey& ipv6Key = static_cast<const IPv6PacketKey&>(packetKey);
+		fragKey.fragmentID = ipv6Key.getFragmentID();
+		ipv6Key.getSrcIP().copyTo(fragKey.srcIP);
+		ipv6Key.getDstIP().copyTo(fragKey.dstIP);
+	}
+}
 
-			// create a packet object wrapping the RawPacket we've just created
-			Packet* partialDataPacket = new Packet(partialRawPacket, true);
+IPReassembly::IPFragmentData* IPReassembly::getFragmentData(const FragmentKey& fragKey, uint32_t fragmentID)
+{
+	FragmentEntry entry;
+	entry.key = fragKey;
+	entry.data = nullptr;
 
-			// prepare the packet and return it
-			if (key.getProtocolType() == IPv4)
-			{
-				IPv4Layer* ipLayer = partialDataPacket->getLayerOfType<IPv4Layer>();
-				ipLayer->getIPv4Header()->fragmentOffset = 0;
-				ipLayer->computeCalculateFields();
-			}
-			else // key.getProtocolType() == IPv6
-			{
-				IPv6Layer* ipLayer = partialDataPacket->getLayerOfType<IPv6Layer>();
-				ipLayer->removeAllExtensions();
-				ipLayer->computeCalculateFields();
-			}
+	// packet was seen before - mark it as used
+	const FragmentEntry* storedEntry = m_PacketLRU.find(entry);
+	if (storedEntry != nullptr)
+	{
+		IPFragmentData* fragData = storedEntry->data;
+		m_PacketLRU.put(entry);
+		return fragData;
+	}
 
-			return partialDataPacket;
+	PCPP_LOG_DEBUG("Got new packet with FragID=0x" << std::hex << fragmentID << ", allocating place in map");
+
+	// take a reassembly state object from the pool, or allocate a new one if all of them are in use
+	if (m_FreeFragmentData.empty())
+	{
+		IPFragmentData* newFragData = new IPFragmentData();
+		m_FragmentDataPool.push_back(newFragData);
+		m_FreeFragmentData.push_back(newFragData);
+	}
+
+	entry.data = m_FreeFragmentData.back();
+	m_FreeFragmentData.pop_back();
+	entry.data->reset(fragmentID, fragKey.protocol);
+
+	// put the new packet in the LRU list
+	FragmentEntry removedEntry;
+	if (m_PacketLRU.put(entry, &removedEntry) == 1) // this means LRU list was full and the least recently used item was removed
+	{
+		PCPP_LOG_DEBUG("Reached maximum packet capacity, removing data for FragID=0x" << std::hex << removedEntry.data->fragmentID);
+		dropPacket(removedEntry);
+	}
+
+	return entry.data;
+}
+
+void IPReassembly::releaseFragmentData(IPFragmentData* fragData)
+{
+	m_CurrentBytesHeld -= fragData->bufferLen + fragData->outOfOrderBufferLen;
+	delete [] fragData->buffer;
+	fragData->buffer = nullptr;
+	fragData->bufferLen = 0;
+	delete [] fragData->outOfOrderBuffer;
+	fragData->outOfOrderBuffer = nullptr;
+	fragData->outOfOrderBufferLen = 0;
+	m_FreeFragmentData.push_back(fragData);
+}
+
+void IPReassembly::dropPacket(const FragmentEntry& entry)
+{
+	m_NumOfDroppedFragments += entry.data->numOfFragments;
+
+	// fire callback if not null. The key is created on the stack so no allocation is needed
+	if (m_OnFragmentsCleanCallback != nullptr)
+	{
+		if (entry.key.protocol == IPv4)
+		{
+			IPv4PacketKey key((uint16_t)entry.key.fragmentID, IPv4Address(entry.key.srcIP), IPv4Address(entry.key.dstIP));
+			m_OnFragmentsCleanCallback(&key, m_CallbackUserCookie);
+		}
+		else
+		{
+			IPv6PacketKey key(entry.key.fragmentID, IPv6Address(entry.key.srcIP), IPv6Address(entry.key.dstIP));
+			m_OnFragmentsCleanCallback(&key, m_CallbackUserCookie);
 		}
 	}
 
-	return nullptr;
+	releaseFragmentData(entry.data);
 }
 
-void IPReassembly::removePacket(const PacketKey& key)
+bool IPReassembly::makeRoomInBudget(IPFragmentData* fragData, size_t bytesToAdd)
 {
-	// create a hash out of the packet key
-	uint32_t hash = key.getHashValue();
+	if (m_MaxBytesToStore == 0)
+		return true;
 
-	// look for this hash value in the map
-	std::map<uint32_t, IPFragmentData*>::iterator iter = m_FragmentMap.find(hash);
+	// the packet can't fit in the budget even if all other packets are dropped
+	if (fragData->bufferLen + fragData->outOfOrderBufferLen + bytesToAdd > m_MaxBytesToStore)
+		return false;
 
-	// hash was found
-	if (iter != m_FragmentMap.end())
+	// drop the least recently used packets until the new bytes fit in the budget. The current packet is the most recently used one,
+	// so it's the last one left
+	while (m_CurrentBytesHeld + bytesToAdd > m_MaxBytesToStore)
 	{
-		// free all data saved in the map
-		delete iter->second;
-		m_FragmentMap.erase(iter);
+		FragmentEntry lruEntry = m_PacketLRU.getLRUElement();
+		if (lruEntry.data == fragData)
+			return false;
 
-		// remove from LRU list
-		m_PacketLRU.eraseElement(hash);
+		PCPP_LOG_DEBUG("Reached memory budget, removing data for FragID=0x" << std::hex << lruEntry.data->fragmentID);
+		m_PacketLRU.eraseElement(lruEntry);
+		dropPacket(lruEntry);
 	}
+
+	return true;
 }
 
-void IPReassembly::addNewFragment(uint32_t hash, IPFragmentData* fragData)
+bool IPReassembly::reserveBuffer(IPFragmentData* fragData, size_t headroom, size_t payloadLen)
 {
-	// put the new frag in the LRU list
-	uint32_t packetRemoved;
+	headroom = std::max(headroom, fragData->headroom);
+	size_t payloadCapacity = fragData->bufferLen - fragData->headroom;
+	if (fragData->buffer != nullptr && headroom == fragData->headroom && payloadLen <= payloadCapacity)
+		return true;
 
-	if (m_PacketLRU.put(hash, &packetRemoved) == 1) // this means LRU list was full and the least recently used item was removed
+	// payloadLen is the end of the data received in order, so leave room for more fragments by (at least) doubling the capacity, but not
+	// beyond the payload length if the last fragment was seen
+	size_t newPayloadCapacity = payloadCapacity;
+	if (payloadLen > payloadCapacity)
 	{
-		// remove this item from the fragment map
-		std::map<uint32_t, IPFragmentData*>::iterator iter = m_FragmentMap.find(packetRemoved);
-		IPFragmentData* dataRemoved = iter->second;
+		size_t maxPayloadLen = (fragData->totalPayloadLen > 0 ? fragData->totalPayloadLen : IP_REASSEMBLY_MAX_PAYLOAD_LEN);
+		newPayloadCapacity = std::max(payloadLen, std::min<size_t>(2 * std::max(payloadLen, payloadCapacity), maxPayloadLen));
+	}
 
-		PacketKey* key = nullptr;
-		if (m_OnFragmentsCleanCallback != nullptr)
-			key = dataRemoved->packetKey->clone();
+	size_t newBufferLen = headroom + newPayloadCapacity;
 
-		PCPP_LOG_DEBUG("Reached maximum packet capacity, removing data for FragID=0x" << std::hex << dataRemoved->fragmentID);
-		delete dataRemoved;
-		m_FragmentMap.erase(iter);
+	// don't leave extra room if it doesn't fit in the budget
+	if (m_MaxBytesToStore > 0 && fragData->outOfOrderBufferLen + newBufferLen > m_MaxBytesToStore)
+	{
+		newPayloadCapacity = std::max(payloadLen, payloadCapacity);
+		newBufferLen = headroom + newPayloadCapacity;
+	}
 
-		// fire callback if not null
-		if (m_OnFragmentsCleanCallback != nullptr)
-		{
-			m_OnFragmentsCleanCallback(key, m_CallbackUserCookie);
-			delete key;
-		}
+	if (!makeRoomInBudget(fragData, newBufferLen - fragData->bufferLen))
+		return false;
+
+	uint8_t* newBuffer = new uint8_t[newBufferLen];
+	if (fragData->buffer != nullptr)
+	{
+		// copy the headers (if the first fragment already arrived) and the payload to their places in the new buffer
+		memcpy(newBuffer + headroom - fragData->headerLen, fragData->buffer + fragData->headroom - fragData->headerLen, fragData->headerLen);
+		memcpy(newBuffer + headroom, fragData->buffer + fragData->headroom, payloadCapacity);
+		delete [] fragData->buffer;
 	}
 
-	// add the new fragment to the map
-	std::pair<uint32_t, IPFragmentData*> pair(hash, fragData);
-	m_FragmentMap.insert(pair);
+	m_CurrentBytesHeld = m_CurrentBytesHeld - fragData->bufferLen + newBufferLen;
+	fragData->buffer = newBuffer;
+	fragData->bufferLen = newBufferLen;
+	fragData->headroom = headroom;
+	return true;
+}
+
+bool IPReassembly::reserveOutOfOrderBuffer(IPFragmentData* fragData, size_t dataLen)
+{
+	if (dataLen <= fragData->outOfOrderBufferLen)
+		return true;
+
+	// the buffer holds only the data of the out-of-order fragments, which is at most the maximum payload length
+	size_t newBufferLen = std::max(dataLen, std::min<size_t>(2 * fragData->outOfOrderBufferLen, IP_REASSEMBLY_MAX_PAYLOAD_LEN));
+	if (m_MaxBytesToStore > 0 && fragData->bufferLen + newBufferLen > m_MaxBytesToStore)
+		newBufferLen = dataLen;
+
+	if (!makeRoomInBudget(fragData, newBufferLen - fragData->outOfOrderBufferLen))
+		return false;
+
+	uint8_t* newBuffer = new uint8_t[newBufferLen];
+	memcpy(newBuffer, fragData->outOfOrderBuffer, fragData->outOfOrderDataLen);
+	delete [] fragData->outOfOrderBuffer;
+
+	m_CurrentBytesHeld = m_CurrentBytesHeld - fragData->outOfOrderBufferLen + newBufferLen;
+	fragData->outOfOrderBuffer = newBuffer;
+	fragData->outOfOrderBufferLen = newBufferLen;
+	return true;
 }
 
 bool IPReassembly::matchOutOfOrderFragments(IPFragmentData* fragData)
@@ -614,31 +762,43 @@ bool IPReassembly::matchOutOfOrderFragments(IPFragmentData* fragData)
 	{
 		bool foundOutOfOrderFrag = false;
 
-		int index = 0;
+		size_t index = 0;
 
 		// go over all fragment in the out-of-order list
-		while (index < (int)fragData->outOfOrderFragments.size())
+		while (index < fragData->outOfOrderFragments.size())
 		{
 			// get the current fragment from the out-of-order list
-			IPFragment* frag = fragData->outOfOrderFragments.at(index);
+			IPFragment& frag = fragData->outOfOrderFragments[index];
 
 			// this fragment is exactly the one we're looking for
-			if (fragData->currentOffset == frag->fragmentOffset)
+			if (fragData->currentOffset == frag.fragmentOffset)
 			{
-				// add it to the reassembled packet
-				PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Found the next matching fragment in out-of-order list with offset " << frag->fragmentOffset << ", adding its data to reassembled packet");
-				fragData->data->reallocateData(fragData->data->getRawDataLen() + frag->fragmentDataLen);
-				fragData->data->appendData(frag->fragmentData, frag->fragmentDataLen);
-				fragData->currentOffset += frag->fragmentDataLen;
-				if (frag->lastFragment) // if this is the last fragment of the packet
+				PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Found the next matching fragment in out-of-order list with offset " << frag.fragmentOffset << ", adding its data to reassembled packet");
+
+				// the packet stays incomplete until it's removed from the map
+				if (!reserveBuffer(fragData, 0, frag.fragmentOffset + frag.fragmentDataLen))
+				{
+					PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Fragment doesn't fit in the memory budget, can't add it to reassembled packet");
+					return false;
+				}
+
+				// copy its data from the out-of-order buffer to its place in the reassembled packet
+				memcpy(fragData->buffer + fragData->headroom + frag.fragmentOffset, fragData->outOfOrderBuffer + frag.dataOffset, frag.fragmentDataLen);
+				fragData->currentOffset += frag.fragmentDataLen;
+				if (frag.lastFragment) // if this is the last fragment of the packet
 				{
 					PCPP_LOG_DEBUG("[FragID=0x" << std::hex << fragData->fragmentID << "] Found last fragment inside out-of-order list");
 					foundLastSegment = true;
 				}
 
-				// remove this fragment from the out-of-order list
+				// remove this fragment from the out-of-order list. The list stays in arrival order, so of fragments with the same offset the one
+				// which arrived first is used
 				fragData->outOfOrderFragments.erase(fragData->outOfOrderFragments.begin() + index);
 
+				// the out-of-order buffer is reused once all of its fragments were added to the reassembled packet
+				if (fragData->outOfOrderFragments.empty())
+					fragData->outOfOrderDataLen = 0;
+
 				// mark that we found at least one matching fragment in the out-of-order list
 				foundOutOfOrderFrag = true;
 			}
@@ -658,4 +818,61 @@ bool IPReassembly::matchOutOfOrderFragments(IPFragmentData* fragData)
 	return foundLastSegment;
 }
 
+Packet* IPReassembly::createReassembledPacket(IPFragmentData* fragData, uint8_t* data, ProtocolType parseUntil, OsiModelLayer parseUntilLayer)
+{
+	size_t dataLen = fragData->headerLen + fragData->currentOffset;
+	size_t ipHeadersLen = fragData->headerLen - fragData->ipHeaderOffset;
+
+	// fix IP length field so the IP layer is parsed with all the reassembled data
+	if (fragData->protocol == IPv4)
+	{
+		iphdr* ipHeader = (iphdr*)(data + fragData->ipHeaderOffset);
+		ipHeader->totalLength = htobe16(ipHeadersLen + fragData->currentOffset);
+		ipHeader->fragmentOffset = 0;
+	}
+	else
+	{
+		ip6_hdr* ipHeader = (ip6_hdr*)(data + fragData->ipHeaderOffset);
+		ipHeader->payloadLength = htobe16(ipHeadersLen - sizeof(ip6_hdr) + fragData->currentOffset);
+	}
+
+	RawPacket* rawPacket = new RawPacket(data, dataLen, fragData->timestamp, true, fragData->linkLayerType);
+
+	// the IP fields are re-calculated on a packet parsed until the IP layer, since the returned packet may be parsed only until an earlier layer.
+	// If the IP layer can't be parsed, for example because the headers before it are malformed, the packet is dropped
+	{
+		Packet ipPacket(rawPacket, false, fragData->protocol);
+		if (fragData->protocol == IPv4)
+		{
+			IPv4Layer* ipLayer = ipPacket.getLayerOfType<IPv4Layer>();
+			if (ipLayer == nullptr)
+			{
+				delete rawPacket;
+				return nullptr;
+			}
+
+			// re-calculate all IPv4 fields
+			ipLayer->computeCalculateFields();
+		}
+		else
+		{
+			IPv6Layer* ipLayer = ipPacket.getLayerOfType<IPv6Layer>();
+			if (ipLayer == nullptr)
+			{
+				delete rawPacket;
+				return nullptr;
+			}
+
+			// remove fragment extension
+			ipLayer->removeAllExtensions();
+
+			// re-calculate all IPv6 fields
+			ipLayer->computeCalculateFields();
+		}
+	}
+
+	// create a new Packet object with the reassembled data as its RawPacket
+	return new Packet(rawPacket, true, parseUntil, parseUntilLayer);
+}
+
 }
@@ -12,6 +12,7 @@
 #include "VrrpLayer.h"
 #include "PacketUtils.h"
 #include <string.h>
+#include <stddef.h>
 #include <sstream>
 #include "Logger.h"
 #include "EndianPortable.h"
@@ -386,6 +387,40 @@ void IPv4Layer::computeCalculateFields()
 	ipHdr->headerChecksum = htobe16(computeChecksum(&scalar, 1));
 }
 
+// update the IPv4 header checksum after a header field was changed, and the TCP/UDP checksum too if the field is part of the pseudo header
+static void updateIPv4Checksums(IPv4Layer* ipLayer, const uint8_t* oldData, const uint8_t* newData, size_t dataLen, bool isPseudoHeaderField)
+{
+	iphdr* ipHdr = ipLayer->getIPv4Header();
+	ipHdr->headerChecksum = updateChecksum(ipHdr->headerChecksum, oldData, newData, dataLen);
+	if (isPseudoHeaderField)
+		updateTransportChecksum(ipLayer->getNextLayer(), oldData, newData, dataLen);
+}
+
+void IPv4Layer::setSrcIPv4Address(const IPv4Address& ipAddr)
+{
+	uint32_t oldAddr = getIPv4Header()->ipSrc;
+	uint32_t newAddr = ipAddr.toInt();
+	getIPv4Header()->ipSrc = newAddr;
+	updateIPv4Checksums(this, (uint8_t*)&oldAddr, (uint8_t*)&newAddr, sizeof(uint32_t), true);
+}
+
+void IPv4Layer::setDstIPv4Address(const IPv4Address& ipAddr)
+{
+	uint32_t oldAddr = getIPv4Header()->ipDst;
+	uint32_t newAddr = ipAddr.toInt();
+	getIPv4Header()->ipDst = newAddr;
+	updateIPv4Checksums(this, (uint8_t*)&oldAddr, (uint8_t*)&newAddr, sizeof(uint32_t), true);
+}
+
+void IPv4Layer::setTimeToLive(uint8_t timeToLive)
+{
+	// the checksum is computed over 16-bit words, and the TTL shares its word with the protocol field
+	uint8_t* ttlWord = m_Data + offsetof(iphdr, timeToLive);
+	uint8_t oldWord[2] = { ttlWord[0], ttlWord[1] };
+	ttlWord[0] = timeToLive;
+	updateIPv4Checksums(this, oldWord, ttlWord, sizeof(oldWord), false);
+}
+
 bool IPv4Layer::isFragment() const
 {
 	return ((getFragmentFlags() & PCPP_IP_MORE_FRAGMENTS) != 0 || getFragmentOffset() != 0);
@@ -10,6 +10,7 @@
 #include "IcmpV6Layer.h"
 #include "VrrpLayer.h"
 #include "Packet.h"
+#include "PacketUtils.h"
 #include <string.h>
 #include "EndianPortable.h"
 
@@ -78,6 +79,22 @@ IPv6Layer& IPv6Layer::operator=(const IPv6Layer& other)
 	return *this;
 }
 
+void IPv6Layer::setSrcIPv6Address(const IPv6Address& ipAddr)
+{
+	uint8_t oldAddr[16];
+	memcpy(oldAddr, getIPv6Header()->ipSrc, sizeof(oldAddr));
+	ipAddr.copyTo(getIPv6Header()->ipSrc);
+	updateTransportChecksum(getNextLayer(), oldAddr, getIPv6Header()->ipSrc, sizeof(oldAddr));
+}
+
+void IPv6Layer::setDstIPv6Address(const IPv6Address& ipAddr)
+{
+	uint8_t oldAddr[16];
+	memcpy(oldAddr, getIPv6Header()->ipDst, sizeof(oldAddr));
+	ipAddr.copyTo(getIPv6Header()->ipDst);
+	updateTransportChecksum(getNextLayer(), oldAddr, getIPv6Header()->ipDst, sizeof(oldAddr));
+}
+
 void IPv6Layer::parseExtensions()
 {
 	uint8_t nextHdr = getIPv6Header()->nextHeader;
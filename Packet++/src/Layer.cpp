@@ -14,7 +14,7 @@ Layer::~Layer()
 		delete [] m_Data;
 }
 
-Layer::Layer(const Layer& other) : m_Packet(nullptr), m_Protocol(other.m_Protocol), m_NextLayer(nullptr), m_PrevLayer(nullptr), m_IsAllocatedInPacket(false)
+Layer::Layer(const Layer& other) : m_Packet(nullptr), m_Protocol(other.m_Protocol), m_NextLayer(nullptr), m_PrevLayer(nullptr), m_IsAllocatedInPacket(false), m_NextLayerPending(false)
 {
 	m_DataLen = other.getHeaderLen();
 	m_Data = new uint8_t[other.m_DataLen];
@@ -36,11 +36,18 @@ Layer& Layer::operator=(const Layer& other)
 	m_PrevLayer = nullptr;
 	m_Data = new uint8_t[other.m_DataLen];
 	m_IsAllocatedInPacket = false;
+	m_NextLayerPending = false;
 	memcpy(m_Data, other.m_Data, other.m_DataLen);
 
 	return *this;
 }
 
+Layer* Layer::parsePendingNextLayer() const
+{
+	// parsing the next layer doesn't change this layer's data, only links a new layer to it
+	return m_Packet->parseNextLayerOnDemand(const_cast<Layer*>(this));
+}
+
 void Layer::copyData(uint8_t* toArr) const
 {
 	memcpy(toArr, m_Data, m_DataLen);
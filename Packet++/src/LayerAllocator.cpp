@@ -0,0 +1,128 @@
+#include "LayerAllocator.h"
+#include <new>
+
+namespace pcpp
+{
+
+// layer objects are bucketed into size classes of SizeClassGranularity bytes. Objects larger than MaxCachedObjectSize are never cached
+static const size_t SizeClassGranularity = 16;
+static const size_t MaxCachedObjectSize = 512;
+static const size_t NumOfSizeClasses = MaxCachedObjectSize / SizeClassGranularity;
+
+struct CachedBlock
+{
+	CachedBlock* next;
+};
+
+struct LayerThreadCache
+{
+	bool enabled;
+	size_t maxObjectsPerSizeClass;
+	size_t totalCachedObjects;
+	CachedBlock* freeLists[NumOfSizeClasses];
+	size_t freeListSizes[NumOfSizeClasses];
+
+	LayerThreadCache() : enabled(false), maxObjectsPerSizeClass(0), totalCachedObjects(0)
+	{
+		for (size_t i = 0; i < NumOfSizeClasses; i++)
+		{
+			freeLists[i] = nullptr;
+			freeListSizes[i] = 0;
+		}
+	}
+
+	~LayerThreadCache()
+	{
+		// layers may still be deleted after this thread-local object is destroyed (e.g by static objects), make sure they go to the heap
+		enabled = false;
+		clear();
+	}
+
+	void clear()
+	{
+		for (size_t i = 0; i < NumOfSizeClasses; i++)
+		{
+			while (freeLists[i] != nullptr)
+			{
+				CachedBlock* block = freeLists[i];
+				freeLists[i] = block->next;
+				::operator delete(block);
+			}
+			freeListSizes[i] = 0;
+		}
+		totalCachedObjects = 0;
+	}
+};
+
+static thread_local LayerThreadCache layerThreadCache;
+
+void LayerAllocator::enableThreadCache(size_t maxCachedObjectsPerSizeClass)
+{
+	layerThreadCache.enabled = true;
+	layerThreadCache.maxObjectsPerSizeClass = maxCachedObjectsPerSizeClass;
+}
+
+void LayerAllocator::disableThreadCache()
+{
+	layerThreadCache.enabled = false;
+	layerThreadCache.clear();
+}
+
+bool LayerAllocator::isThreadCacheEnabled()
+{
+	return layerThreadCache.enabled;
+}
+
+size_t LayerAllocator::getThreadCacheSize()
+{
+	return layerThreadCache.totalCachedObjects;
+}
+
+void* LayerAllocator::allocate(size_t size)
+{
+	if (size > MaxCachedObjectSize || size == 0)
+		return ::operator new(size);
+
+	size_t sizeClass = (size - 1) / SizeClassGranularity;
+	LayerThreadCache& cache = layerThreadCache;
+	if (cache.enabled && cache.freeLists[sizeClass] != nullptr)
+	{
+		CachedBlock* block = cache.freeLists[sizeClass];
+		cache.freeLists[sizeClass] = block->next;
+		cache.freeListSizes[sizeClass]--;
+		cache.totalCachedObjects--;
+		return block;
+	}
+
+	// always allocate the full size class so any block can later serve any object of the same class, even if the cache was disabled
+	// when the block was allocated
+	return ::operator new((sizeClass + 1) * SizeClassGranularity);
+}
+
+void LayerAllocator::deallocate(void* ptr, size_t size)
+{
+	if (ptr == nullptr)
+		return;
+
+	if (size > MaxCachedObjectSize || size == 0)
+	{
+		::operator delete(ptr);
+		return;
+	}
+
+	size_t sizeClass = (size - 1) / SizeClassGranularity;
+	LayerThreadCache& cache = layerThreadCache;
+	if (!cache.enabled || cache.freeListSizes[sizeClass] >= cache.maxObjectsPerSizeClass)
+	{
+		::operator delete(ptr);
+		return;
+	}
+
+	CachedBlock* block = static_cast<CachedBlock*>(ptr);
+	block->next = cache.freeLists[sizeClass];
+	cache.freeLists[sizeClass] = block;
+	cache.freeListSizes[sizeClass]++;
+	cache.totalCachedObjects++;
+}
+
+} // namespace pcpp
@@ -32,7 +32,9 @@ Packet::Packet(size_t maxPacketLen) :
 	m_ProtocolTypes(UnknownProtocol),
 	m_MaxPacketLen(maxPacketLen),
 	m_FreeRawPacket(true),
-	m_CanReallocateData(true)
+	m_CanReallocateData(true),
+	m_LayerIndexCount(0),
+	m_LayerIndexComplete(true)
 {
 	timeval time;
 	gettimeofday(&time, nullptr);
@@ -48,7 +50,9 @@ Packet::Packet(uint8_t* buffer, size_t bufferSize) :
 	m_ProtocolTypes(UnknownProtocol),
 	m_MaxPacketLen(bufferSize),
 	m_FreeRawPacket(true),
-	m_CanReallocateData(false)
+	m_CanReallocateData(false),
+	m_LayerIndexCount(0),
+	m_LayerIndexComplete(true)
 {
 	timeval time;
 	gettimeofday(&time, nullptr);
@@ -56,17 +60,24 @@ Packet::Packet(uint8_t* buffer, size_t bufferSize) :
 	m_RawPacket = new RawPacket(buffer, 0, time, false, LINKTYPE_ETHERNET);
 }
 
-void Packet::setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType parseUntil, OsiModelLayer parseUntilLayer)
+void Packet::resetPacketData(RawPacket* rawPacket, bool freeRawPacket)
 {
 	destructPacketData();
 
 	m_FirstLayer = nullptr;
 	m_LastLayer = nullptr;
 	m_ProtocolTypes = UnknownProtocol;
-	m_MaxPacketLen = rawPacket->getRawDataLen();
+	m_LayerIndexCount = 0;
+	m_LayerIndexComplete = true;
+	m_MaxPacketLen = (rawPacket != nullptr ? rawPacket->getRawDataLen() : 0);
 	m_FreeRawPacket = freeRawPacket;
 	m_RawPacket = rawPacket;
 	m_CanReallocateData = true;
+}
+
+void Packet::setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType parseUntil, OsiModelLayer parseUntilLayer)
+{
+	resetPacketData(rawPacket, freeRawPacket);
 	if (m_RawPacket == nullptr)
 		return;
 
@@ -78,7 +89,7 @@ void Packet::setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType
 	Layer* curLayer = m_FirstLayer;
 	while (curLayer != nullptr && (curLayer->getProtocol() & parseUntil) == 0 && curLayer->getOsiModelLayer() <= parseUntilLayer)
 	{
-		m_ProtocolTypes |= curLayer->getProtocol();
+		addLayerToIndex(curLayer);
 		curLayer->parseNextLayer();
 		curLayer->m_IsAllocatedInPacket = true;
 		curLayer = curLayer->getNextLayer();
@@ -88,7 +99,7 @@ void Packet::setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType
 
 	if (curLayer != nullptr && (curLayer->getProtocol() & parseUntil) != 0)
 	{
-		m_ProtocolTypes |= curLayer->getProtocol();
+		addLayerToIndex(curLayer);
 		curLayer->m_IsAllocatedInPacket = true;
 	}
 
@@ -99,27 +110,95 @@ void Packet::setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType
 		m_LastLayer->m_NextLayer = nullptr;
 	}
 
-	if (m_LastLayer != nullptr && parseUntil == UnknownProtocol && parseUntilLayer == OsiModelLayerUnknown)
+	if (parseUntil == UnknownProtocol && parseUntilLayer == OsiModelLayerUnknown)
+		addPacketTrailerIfExists();
+}
+
+void Packet::setRawPacket(RawPacket* rawPacket, bool freeRawPacket, PacketParsingMode parsingMode)
+{
+	if (parsingMode == EagerParsing)
 	{
-		// find if there is data left in the raw packet that doesn't belong to any layer. In that case it's probably a packet trailer.
-		// create a PacketTrailerLayer layer and add it at the end of the packet
-		int trailerLen = (int)((m_RawPacket->getRawData() + m_RawPacket->getRawDataLen()) - (m_LastLayer->getData() + m_LastLayer->getDataLen()));
-		if (trailerLen > 0)
-		{
-			PacketTrailerLayer* trailerLayer = new PacketTrailerLayer(
-					(uint8_t*)(m_LastLayer->getData() + m_LastLayer->getDataLen()),
-					trailerLen,
-					m_LastLayer,
-					this);
-
-			trailerLayer->m_IsAllocatedInPacket = true;
-			m_LastLayer->setNextLayer(trailerLayer);
-			m_LastLayer = trailerLayer;
-			m_ProtocolTypes |= trailerLayer->getProtocol();
-		}
+		setRawPacket(rawPacket, freeRawPacket);
+		return;
+	}
+
+	resetPacketData(rawPacket, freeRawPacket);
+	if (m_RawPacket == nullptr)
+		return;
+
+	m_FirstLayer = createFirstLayer(m_RawPacket->getLinkLayerType());
+	m_LastLayer = m_FirstLayer;
+	if (m_FirstLayer != nullptr)
+	{
+		addLayerToIndex(m_FirstLayer);
+		m_FirstLayer->m_IsAllocatedInPacket = true;
+		m_FirstLayer->m_NextLayerPending = true;
 	}
 }
 
+void Packet::addPacketTrailerIfExists()
+{
+	if (m_LastLayer == nullptr)
+		return;
+
+	// find if there is data left in the raw packet that doesn't belong to any layer. In that case it's probably a packet trailer.
+	// create a PacketTrailerLayer layer and add it at the end of the packet
+	int trailerLen = (int)((m_RawPacket->getRawData() + m_RawPacket->getRawDataLen()) - (m_LastLayer->getData() + m_LastLayer->getDataLen()));
+	if (trailerLen > 0)
+	{
+		PacketTrailerLayer* trailerLayer = new PacketTrailerLayer(
+				(uint8_t*)(m_LastLayer->getData() + m_LastLayer->getDataLen()),
+				trailerLen,
+				m_LastLayer,
+				this);
+
+		trailerLayer->m_IsAllocatedInPacket = true;
+		m_LastLayer->setNextLayer(trailerLayer);
+		m_LastLayer = trailerLayer;
+		addLayerToIndex(trailerLayer);
+	}
+}
+
+Layer* Packet::parseNextLayerOnDemand(Layer* layer)
+{
+	// clear the flag first, parseNextLayer() may look at the next layer which isn't there yet
+	layer->m_NextLayerPending = false;
+	layer->parseNextLayer();
+
+	Layer* curLayer = layer->m_NextLayer;
+	if (curLayer == nullptr)
+	{
+		// this was the last layer, the rest of the data (if any) is a packet trailer
+		addPacketTrailerIfExists();
+		return layer->m_NextLayer;
+	}
+
+	while (curLayer != nullptr)
+	{
+		addLayerToIndex(curLayer);
+		curLayer->m_IsAllocatedInPacket = true;
+		m_LastLayer = curLayer;
+		curLayer = curLayer->m_NextLayer;
+	}
+
+	m_LastLayer->m_NextLayerPending = true;
+	return layer->m_NextLayer;
+}
+
+void Packet::parseRemainingLayers()
+{
+	while (hasPendingLayers())
+		parseNextLayerOnDemand(m_LastLayer);
+}
+
+bool Packet::parseUntilProtocol(ProtocolType protocolType)
+{
+	while ((m_ProtocolTypes & protocolType) == 0 && hasPendingLayers())
+		parseNextLayerOnDemand(m_LastLayer);
+
+	return (m_ProtocolTypes & protocolType) != 0;
+}
+
 Packet::Packet(RawPacket* rawPacket, bool freeRawPacket, ProtocolType parseUntil, OsiModelLayer parseUntilLayer)
 {
 	m_FreeRawPacket = false;
@@ -144,12 +223,21 @@ Packet::Packet(RawPacket* rawPacket, OsiModelLayer parseUntilLayer)
 	setRawPacket(rawPacket, false, UnknownProtocol, parseUntilLayer);
 }
 
+Packet::Packet(RawPacket* rawPacket, PacketParsingMode parsingMode, bool freeRawPacket)
+{
+	m_FreeRawPacket = false;
+	m_RawPacket = nullptr;
+	m_FirstLayer = nullptr;
+	setRawPacket(rawPacket, freeRawPacket, parsingMode);
+}
+
 void Packet::destructPacketData()
 {
+	// go over the layers parsed so far without parsing the pending ones
 	Layer* curLayer = m_FirstLayer;
 	while (curLayer != nullptr)
 	{
-		Layer* nextLayer = curLayer->getNextLayer();
+		Layer* nextLayer = curLayer->m_NextLayer;
 		if (curLayer->m_IsAllocatedInPacket)
 			delete curLayer;
 		curLayer = nextLayer;
@@ -175,19 +263,25 @@ void Packet::copyDataFrom(const Packet& other)
 	m_RawPacket = new RawPacket(*(other.m_RawPacket));
 	m_FreeRawPacket = true;
 	m_MaxPacketLen = other.m_MaxPacketLen;
-	m_ProtocolTypes = other.m_ProtocolTypes;
+	m_ProtocolTypes = UnknownProtocol;
+	m_LayerIndexCount = 0;
+	m_LayerIndexComplete = true;
 	m_FirstLayer = createFirstLayer(m_RawPacket->getLinkLayerType());
 	m_LastLayer = m_FirstLayer;
 	m_CanReallocateData = true;
 	Layer* curLayer = m_FirstLayer;
 	while (curLayer != nullptr)
 	{
+		// the other packet may be lazily parsed, so not all of its protocols are known yet
+		addLayerToIndex(curLayer);
 		curLayer->parseNextLayer();
 		curLayer->m_IsAllocatedInPacket = true;
 		curLayer = curLayer->getNextLayer();
 		if (curLayer != nullptr)
 			m_LastLayer = curLayer;
 	}
+
+	m_ProtocolTypes |= other.m_ProtocolTypes;
 }
 
 void Packet::reallocateRawData(size_t newSize)
@@ -237,6 +331,8 @@ bool Packet::insertLayer(Layer* prevLayer, Layer* newLayer, bool ownInPacket)
 		return false;
 	}
 
+	parseRemainingLayers();
+
 	size_t newLayerHeaderLen = newLayer->getHeaderLen();
 	if (m_RawPacket->getRawDataLen() + newLayerHeaderLen > m_MaxPacketLen)
 	{
@@ -324,6 +420,7 @@ bool Packet::insertLayer(Layer* prevLayer, Layer* newLayer, bool ownInPacket)
 
 	// add layer protocol to protocol collection
 	m_ProtocolTypes |= newLayer->getProtocol();
+	rebuildLayerIndex();
 	return true;
 }
 
@@ -413,6 +510,8 @@ bool Packet::removeLayer(Layer* layer, bool tryToDelete)
 		return false;
 	}
 
+	parseRemainingLayers();
+
 	// verify layer is allocated to *this* packet
 	Layer* curLayer = layer;
 	while (curLayer->m_PrevLayer != nullptr)
@@ -499,6 +598,8 @@ bool Packet::removeLayer(Layer* layer, bool tryToDelete)
 	if (!anotherLayerWithSameProtocolExists)
 		m_ProtocolTypes &= ~((uint64_t)layer->getProtocol());
 
+	rebuildLayerIndex();
+
 	// if layer was allocated by this packet and tryToDelete flag is set, delete it
 	if (tryToDelete && layer->m_IsAllocatedInPacket)
 	{
@@ -516,8 +617,45 @@ bool Packet::removeLayer(Layer* layer, bool tryToDelete)
 	return true;
 }
 
+void Packet::rebuildLayerIndex()
+{
+	// called only when all layers are parsed, so m_ProtocolTypes is already up to date
+	ProtocolType protocolTypes = m_ProtocolTypes;
+	m_ProtocolTypes = UnknownProtocol;
+	m_LayerIndexCount = 0;
+	m_LayerIndexComplete = true;
+	for (Layer* curLayer = m_FirstLayer; curLayer != nullptr; curLayer = curLayer->m_NextLayer)
+		addLayerToIndex(curLayer);
+
+	m_ProtocolTypes |= protocolTypes;
+}
+
+Layer* Packet::findFirstLayerOfProtocol(ProtocolType protocols) const
+{
+	// the layer isn't in the index: the index is full or the layer wasn't parsed yet
+	for (Layer* curLayer = getFirstLayer(); curLayer != nullptr; curLayer = curLayer->getNextLayer())
+	{
+		if ((curLayer->getProtocol() & protocols) != 0)
+			return curLayer;
+	}
+
+	return nullptr;
+}
+
 Layer* Packet::getLayerOfType(ProtocolType layerType, int index) const
 {
+	if (index == 0)
+	{
+		for (int i = 0; i < m_LayerIndexCount; i++)
+		{
+			if (m_LayerIndex[i].protocol == layerType)
+				return m_LayerIndex[i].layer;
+		}
+
+		if (m_LayerIndexComplete && !hasPendingLayers())
+			return nullptr;
+	}
+
 	Layer* curLayer = getFirstLayer();
 	int curIndex = 0;
 	while (curLayer != nullptr)
@@ -550,6 +688,9 @@ bool Packet::extendLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToExt
 		return false;
 	}
 
+	// data pointers of all layers are updated below, so all layers have to exist
+	parseRemainingLayers();
+
 	if (m_RawPacket->getRawDataLen() + numOfBytesToExtend > m_MaxPacketLen)
 	{
 		if (!m_CanReallocateData)
@@ -615,6 +756,9 @@ bool Packet::shortenLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToSh
 		return false;
 	}
 
+	// data pointers of all layers are updated below, so all layers have to exist
+	parseRemainingLayers();
+
 	// remove data from raw packet
 	int indexOfDataToRemove = layer->m_Data + offsetInLayer - m_RawPacket->getRawData();
 	if (!m_RawPacket->removeData(indexOfDataToRemove, numOfBytesToShorten))
@@ -655,6 +799,7 @@ void Packet::computeCalculateFields()
 {
 	// calculated fields should be calculated from top layer to bottom layer
 
+	parseRemainingLayers();
 	Layer* curLayer = m_LastLayer;
 	while (curLayer != nullptr)
 	{
@@ -5,63 +5,218 @@
 #include "UdpLayer.h"
 #include "Logger.h"
 #include "EndianPortable.h"
+#include <string.h>
+
+// SSE2 is always available on x86-64, AVX2 is used only if the CPU supports it (checked at runtime)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PCPP_CHECKSUM_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PCPP_CHECKSUM_AVX2
+#include <immintrin.h>
+#endif
 
 namespace pcpp
 {
 
-uint16_t computeChecksum(ScalarBuffer<uint16_t> vec[], size_t vecSize)
+// All checksum kernels add the 16-bit words of the data in host byte order into a wide accumulator, which is folded to 16 bits at the end.
+// The one's complement sum is byte order independent (RFC 1071), so the result is the same as adding the words one by one
+
+static uint64_t sumWordsScalar(const uint8_t* data, size_t len)
 {
-	uint32_t sum = 0;
-	for (size_t i = 0; i<vecSize; i++)
+	uint64_t sum = 0;
+
+	// adding 32-bit words is equivalent to adding their two 16-bit halves, the carries are folded at the end
+	while (len >= 8)
 	{
-		uint32_t localSum = 0;
+		uint32_t words[2];
+		memcpy(words, data, sizeof(words));
+		sum += words[0];
+		sum += words[1];
+		data += 8;
+		len -= 8;
+	}
 
-		// vec len is in bytes
-		for (size_t j = 0; j < vec[i].len / 2; j++)
+	while (len >= 2)
+	{
+		uint16_t word;
+		memcpy(&word, data, sizeof(word));
+		sum += word;
+		data += 2;
+		len -= 2;
+	}
+
+	return sum;
+}
+
+#ifdef PCPP_CHECKSUM_SSE2
+
+// the 16-bit words are zero-extended into 32-bit lanes. Each 16-byte block adds at most 2 * 0xffff to a lane, so lanes are flushed into the
+// 64-bit sum before they can overflow
+#define SSE2_BLOCKS_PER_FLUSH 16384
+
+static uint64_t sumWordsSSE2(const uint8_t* data, size_t len)
+{
+	const __m128i zero = _mm_setzero_si128();
+	uint64_t sum = 0;
+
+	while (len >= 16)
+	{
+		__m128i acc = _mm_setzero_si128();
+		for (size_t block = 0; block < SSE2_BLOCKS_PER_FLUSH && len >= 16; block++)
 		{
-			PCPP_LOG_DEBUG("Value to add = 0x" << std::uppercase << std::hex << vec[i].buffer[j]);
-			localSum += vec[i].buffer[j];
+			__m128i words = _mm_loadu_si128((const __m128i*)data);
+			acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(words, zero));
+			acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(words, zero));
+			data += 16;
+			len -= 16;
 		}
-		PCPP_LOG_DEBUG("Local sum = " << localSum << ", 0x" << std::uppercase << std::hex << localSum);
 
-		// check if there is one byte left
-		if (vec[i].len % 2) {
-			// access to the last byte using an uint8_t pointer
-			uint8_t *vecBytes = (uint8_t *)vec[i].buffer;
-			uint8_t lastByte = vecBytes[vec[i].len - 1];
-			PCPP_LOG_DEBUG("1 byte left, adding value: 0x" << std::uppercase << std::hex << lastByte);
-			// We have read the latest byte manually but this byte should be properly interpreted
-			// as a 0xFF on LE and a 0xFF00 on BE to have a proper checksum computation
-			localSum += be16toh(lastByte << 8);
+		uint32_t lanes[4];
+		_mm_storeu_si128((__m128i*)lanes, acc);
+		sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
 
-			PCPP_LOG_DEBUG("Local sum = " << localSum << ", 0x" << std::uppercase << std::hex << localSum);
-		}
+	return sum + sumWordsScalar(data, len);
+}
+
+#endif // PCPP_CHECKSUM_SSE2
+
+#ifdef PCPP_CHECKSUM_AVX2
+
+#define AVX2_BLOCKS_PER_FLUSH 16384
 
-		// carry count is added to the sum
-		while (localSum>>16)
+__attribute__((target("avx2")))
+static uint64_t sumWordsAVX2(const uint8_t* data, size_t len)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	uint64_t sum = 0;
+
+	while (len >= 32)
+	{
+		__m256i acc = _mm256_setzero_si256();
+		for (size_t block = 0; block < AVX2_BLOCKS_PER_FLUSH && len >= 32; block++)
 		{
-			localSum = (localSum & 0xffff) + (localSum >> 16);
+			__m256i words = _mm256_loadu_si256((const __m256i*)data);
+			acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(words, zero));
+			acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(words, zero));
+			data += 32;
+			len -= 32;
 		}
-		PCPP_LOG_DEBUG("Local sum = " << localSum << ", 0x" << std::uppercase << std::hex << localSum);
-		sum += localSum;
+
+		uint32_t lanes[8];
+		_mm256_storeu_si256((__m256i*)lanes, acc);
+		for (int i = 0; i < 8; i++)
+			sum += lanes[i];
 	}
 
-	while (sum>>16)
+	return sum + sumWordsScalar(data, len);
+}
+
+static bool isAVX2Supported()
+{
+	static const bool avx2Supported = __builtin_cpu_supports("avx2");
+	return avx2Supported;
+}
+
+#endif // PCPP_CHECKSUM_AVX2
+
+// buffers shorter than that are summed by the scalar kernel, setting up the vector registers isn't worth it for them
+#define CHECKSUM_VECTOR_MIN_LEN 64
+
+static uint64_t sumWords(const uint8_t* data, size_t len)
+{
+	if (len >= CHECKSUM_VECTOR_MIN_LEN)
 	{
+#ifdef PCPP_CHECKSUM_AVX2
+		if (isAVX2Supported())
+			return sumWordsAVX2(data, len);
+#endif
+#ifdef PCPP_CHECKSUM_SSE2
+		return sumWordsSSE2(data, len);
+#endif
+	}
+
+	return sumWordsScalar(data, len);
+}
+
+static uint16_t foldChecksum(uint64_t sum)
+{
+	// carry count is added to the sum
+	while (sum >> 16)
 		sum = (sum & 0xffff) + (sum >> 16);
+
+	return (uint16_t)sum;
+}
+
+uint16_t computeChecksum(ScalarBuffer<uint16_t> vec[], size_t vecSize)
+{
+	uint64_t sum = 0;
+	for (size_t i = 0; i < vecSize; i++)
+	{
+		// vec len is in bytes
+		const uint8_t* vecBytes = (const uint8_t*)vec[i].buffer;
+		sum += sumWords(vecBytes, vec[i].len & ~(size_t)1);
+
+		// check if there is one byte left
+		if (vec[i].len % 2)
+		{
+			// We have read the latest byte manually but this byte should be properly interpreted
+			// as a 0xFF on LE and a 0xFF00 on BE to have a proper checksum computation
+			uint8_t lastByte = vecBytes[vec[i].len - 1];
+			sum += be16toh(lastByte << 8);
+		}
 	}
-	PCPP_LOG_DEBUG("Sum before invert = " << sum << ", 0x" << std::uppercase << std::hex << sum);
 
 	// To obtain the checksum we take the ones' complement of this result
-	uint16_t result = sum;
-	result = ~result;
+	uint16_t result = (uint16_t)~foldChecksum(sum);
 
-	PCPP_LOG_DEBUG("Calculated checksum = " << sum << ", 0x" << std::uppercase << std::hex << result);
+	PCPP_LOG_DEBUG("Calculated checksum = 0x" << std::uppercase << std::hex << result);
 
 	// We return the result in BigEndian byte order
 	return htobe16(result);
 }
 
+uint16_t updateChecksum(uint16_t checksum, const uint8_t* oldData, const uint8_t* newData, size_t dataLen)
+{
+	// RFC 1624 eqn. 3: HC' = ~(~HC + ~m + m'). Unlike eqn. 2 it never turns a valid checksum into -0
+	uint64_t sum = (uint16_t)~checksum;
+	for (size_t i = 0; i + 1 < dataLen; i += 2)
+	{
+		uint16_t oldWord, newWord;
+		memcpy(&oldWord, oldData + i, sizeof(oldWord));
+		memcpy(&newWord, newData + i, sizeof(newWord));
+		sum += (uint16_t)~oldWord;
+		sum += newWord;
+	}
+
+	return (uint16_t)~foldChecksum(sum);
+}
+
+void updateTransportChecksum(Layer* transportLayer, const uint8_t* oldData, const uint8_t* newData, size_t dataLen)
+{
+	if (transportLayer == nullptr)
+		return;
+
+	if (transportLayer->getProtocol() == TCP)
+	{
+		tcphdr* tcpHdr = ((TcpLayer*)transportLayer)->getTcpHeader();
+		tcpHdr->headerChecksum = updateChecksum(tcpHdr->headerChecksum, oldData, newData, dataLen);
+	}
+	else if (transportLayer->getProtocol() == UDP)
+	{
+		udphdr* udpHdr = ((UdpLayer*)transportLayer)->getUdpHeader();
+		// a zero UDP checksum means no checksum was computed, and a computed checksum of zero is transmitted as all ones (RFC 768)
+		if (udpHdr->headerChecksum == 0)
+			return;
+		udpHdr->headerChecksum = updateChecksum(udpHdr->headerChecksum, oldData, newData, dataLen);
+		if (udpHdr->headerChecksum == 0)
+			udpHdr->headerChecksum = 0xffff;
+	}
+}
+
 uint16_t computePseudoHdrChecksum(uint8_t *dataPtr, size_t dataLen, IPAddress::AddressType ipAddrType,
 								  uint8_t protocolType, IPAddress srcIPAddress,
 								  IPAddress dstIPAddress)
@@ -55,9 +55,12 @@ RawPacket& RawPacket::operator=(const RawPacket& other)
 {
 	if (this != &other)
 	{
-		if (m_RawData != nullptr)
+		if (m_RawData != nullptr && m_DeleteRawDataAtDestructor)
 			delete [] m_RawData;
 
+		m_RawData = nullptr;
+		m_RawDataLen = 0;
+		m_DeleteRawDataAtDestructor = true;
 		m_RawPacketSet = false;
 
 		copyDataFrom(other, true);
@@ -112,9 +115,18 @@ bool RawPacket::setRawData(const uint8_t* pRawData, int rawDataLen, timespec tim
 	return true;
 }
 
+bool RawPacket::setRawData(const uint8_t* pRawData, int rawDataLen, timespec timestamp, LinkLayerType layerType, int frameLength, bool deleteRawDataAtDestructor)
+{
+	if (!setRawData(pRawData, rawDataLen, timestamp, layerType, frameLength))
+		return false;
+
+	m_DeleteRawDataAtDestructor = deleteRawDataAtDestructor;
+	return true;
+}
+
 void RawPacket::clear()
 {
-	if (m_RawData != nullptr)
+	if (m_RawData != nullptr && m_DeleteRawDataAtDestructor)
 		delete[] m_RawData;
 
 	m_RawData = nullptr;
@@ -4,8 +4,6 @@
 #include "md5.h"
 #include <string.h>
 #include <sstream>
-#include <map>
-#include <set>
 #include <utility>
 #include "Logger.h"
 #include "SSLHandshake.h"
@@ -349,347 +347,11 @@ static const SSLCipherSuite Cipher328 = SSLCipherSuite(0x1304, SSL_KEYX_NULL, SS
 static const SSLCipherSuite Cipher329 = SSLCipherSuite(0x1305, SSL_KEYX_NULL, SSL_AUTH_NULL, SSL_SYM_AES_128_CCM_8, SSL_HASH_SHA256, "TLS_AES_128_CCM_8_SHA256");
 
 
-static std::map<uint16_t, SSLCipherSuite*> createCipherSuiteIdToObjectMap()
-{
-	std::map<uint16_t, SSLCipherSuite*> result;
-
-	result[0x0000] = (SSLCipherSuite*)&Cipher1;
-	result[0x0001] = (SSLCipherSuite*)&Cipher2;
-	result[0x0002] = (SSLCipherSuite*)&Cipher3;
-	result[0x0003] = (SSLCipherSuite*)&Cipher4;
-	result[0x0004] = (SSLCipherSuite*)&Cipher5;
-	result[0x0005] = (SSLCipherSuite*)&Cipher6;
-	result[0x0006] = (SSLCipherSuite*)&Cipher7;
-	result[0x0007] = (SSLCipherSuite*)&Cipher8;
-	result[0x0008] = (SSLCipherSuite*)&Cipher9;
-	result[0x0009] = (SSLCipherSuite*)&Cipher10;
-	result[0x000A] = (SSLCipherSuite*)&Cipher11;
-	result[0x000B] = (SSLCipherSuite*)&Cipher12;
-	result[0x000C] = (SSLCipherSuite*)&Cipher13;
-	result[0x000D] = (SSLCipherSuite*)&Cipher14;
-	result[0x000E] = (SSLCipherSuite*)&Cipher15;
-	result[0x000F] = (SSLCipherSuite*)&Cipher16;
-	result[0x0010] = (SSLCipherSuite*)&Cipher17;
-	result[0x0011] = (SSLCipherSuite*)&Cipher18;
-	result[0x0012] = (SSLCipherSuite*)&Cipher19;
-	result[0x0013] = (SSLCipherSuite*)&Cipher20;
-	result[0x0014] = (SSLCipherSuite*)&Cipher21;
-	result[0x0015] = (SSLCipherSuite*)&Cipher22;
-	result[0x0016] = (SSLCipherSuite*)&Cipher23;
-	result[0x0017] = (SSLCipherSuite*)&Cipher24;
-	result[0x0018] = (SSLCipherSuite*)&Cipher25;
-	result[0x0019] = (SSLCipherSuite*)&Cipher26;
-	result[0x001A] = (SSLCipherSuite*)&Cipher27;
-	result[0x001B] = (SSLCipherSuite*)&Cipher28;
-	result[0x001E] = (SSLCipherSuite*)&Cipher29;
-	result[0x001F] = (SSLCipherSuite*)&Cipher30;
-	result[0x0020] = (SSLCipherSuite*)&Cipher31;
-	result[0x0021] = (SSLCipherSuite*)&Cipher32;
-	result[0x0022] = (SSLCipherSuite*)&Cipher33;
-	result[0x0023] = (SSLCipherSuite*)&Cipher34;
-	result[0x0024] = (SSLCipherSuite*)&Cipher35;
-	result[0x0025] = (SSLCipherSuite*)&Cipher36;
-	result[0x0026] = (SSLCipherSuite*)&Cipher37;
-	result[0x0027] = (SSLCipherSuite*)&Cipher38;
-	result[0x0028] = (SSLCipherSuite*)&Cipher39;
-	result[0x0029] = (SSLCipherSuite*)&Cipher40;
-	result[0x002A] = (SSLCipherSuite*)&Cipher41;
-	result[0x002B] = (SSLCipherSuite*)&Cipher42;
-	result[0x002C] = (SSLCipherSuite*)&Cipher43;
-	result[0x002D] = (SSLCipherSuite*)&Cipher44;
-	result[0x002E] = (SSLCipherSuite*)&Cipher45;
-	result[0x002F] = (SSLCipherSuite*)&Cipher46;
-	result[0x0030] = (SSLCipherSuite*)&Cipher47;
-	result[0x0031] = (SSLCipherSuite*)&Cipher48;
-	result[0x0032] = (SSLCipherSuite*)&Cipher49;
-	result[0x0033] = (SSLCipherSuite*)&Cipher50;
-	result[0x0034] = (SSLCipherSuite*)&Cipher51;
-	result[0x0035] = (SSLCipherSuite*)&Cipher52;
-	result[0x0036] = (SSLCipherSuite*)&Cipher53;
-	result[0x0037] = (SSLCipherSuite*)&Cipher54;
-	result[0x0038] = (SSLCipherSuite*)&Cipher55;
-	result[0x0039] = (SSLCipherSuite*)&Cipher56;
-	result[0x003A] = (SSLCipherSuite*)&Cipher57;
-	result[0x003B] = (SSLCipherSuite*)&Cipher58;
-	result[0x003C] = (SSLCipherSuite*)&Cipher59;
-	result[0x003D] = (SSLCipherSuite*)&Cipher60;
-	result[0x003E] = (SSLCipherSuite*)&Cipher61;
-	result[0x003F] = (SSLCipherSuite*)&Cipher62;
-	result[0x0040] = (SSLCipherSuite*)&Cipher63;
-	result[0x0041] = (SSLCipherSuite*)&Cipher64;
-	result[0x0042] = (SSLCipherSuite*)&Cipher65;
-	result[0x0043] = (SSLCipherSuite*)&Cipher66;
-	result[0x0044] = (SSLCipherSuite*)&Cipher67;
-	result[0x0045] = (SSLCipherSuite*)&Cipher68;
-	result[0x0046] = (SSLCipherSuite*)&Cipher69;
-	result[0x0067] = (SSLCipherSuite*)&Cipher70;
-	result[0x0068] = (SSLCipherSuite*)&Cipher71;
-	result[0x0069] = (SSLCipherSuite*)&Cipher72;
-	result[0x006A] = (SSLCipherSuite*)&Cipher73;
-	result[0x006B] = (SSLCipherSuite*)&Cipher74;
-	result[0x006C] = (SSLCipherSuite*)&Cipher75;
-	result[0x006D] = (SSLCipherSuite*)&Cipher76;
-	result[0x0084] = (SSLCipherSuite*)&Cipher77;
-	result[0x0085] = (SSLCipherSuite*)&Cipher78;
-	result[0x0086] = (SSLCipherSuite*)&Cipher79;
-	result[0x0087] = (SSLCipherSuite*)&Cipher80;
-	result[0x0088] = (SSLCipherSuite*)&Cipher81;
-	result[0x0089] = (SSLCipherSuite*)&Cipher82;
-	result[0x008A] = (SSLCipherSuite*)&Cipher83;
-	result[0x008B] = (SSLCipherSuite*)&Cipher84;
-	result[0x008C] = (SSLCipherSuite*)&Cipher85;
-	result[0x008D] = (SSLCipherSuite*)&Cipher86;
-	result[0x008E] = (SSLCipherSuite*)&Cipher87;
-	result[0x008F] = (SSLCipherSuite*)&Cipher88;
-	result[0x0090] = (SSLCipherSuite*)&Cipher89;
-	result[0x0091] = (SSLCipherSuite*)&Cipher90;
-	result[0x0092] = (SSLCipherSuite*)&Cipher91;
-	result[0x0093] = (SSLCipherSuite*)&Cipher92;
-	result[0x0094] = (SSLCipherSuite*)&Cipher93;
-	result[0x0095] = (SSLCipherSuite*)&Cipher94;
-	result[0x0096] = (SSLCipherSuite*)&Cipher95;
-	result[0x0097] = (SSLCipherSuite*)&Cipher96;
-	result[0x0098] = (SSLCipherSuite*)&Cipher97;
-	result[0x0099] = (SSLCipherSuite*)&Cipher98;
-	result[0x009A] = (SSLCipherSuite*)&Cipher99;
-	result[0x009B] = (SSLCipherSuite*)&Cipher100;
-	result[0x009C] = (SSLCipherSuite*)&Cipher101;
-	result[0x009D] = (SSLCipherSuite*)&Cipher102;
-	result[0x009E] = (SSLCipherSuite*)&Cipher103;
-	result[0x009F] = (SSLCipherSuite*)&Cipher104;
-	result[0x00A0] = (SSLCipherSuite*)&Cipher105;
-	result[0x00A1] = (SSLCipherSuite*)&Cipher106;
-	result[0x00A2] = (SSLCipherSuite*)&Cipher107;
-	result[0x00A3] = (SSLCipherSuite*)&Cipher108;
-	result[0x00A4] = (SSLCipherSuite*)&Cipher109;
-	result[0x00A5] = (SSLCipherSuite*)&Cipher110;
-	result[0x00A6] = (SSLCipherSuite*)&Cipher111;
-	result[0x00A7] = (SSLCipherSuite*)&Cipher112;
-	result[0x00A8] = (SSLCipherSuite*)&Cipher113;
-	result[0x00A9] = (SSLCipherSuite*)&Cipher114;
-	result[0x00AA] = (SSLCipherSuite*)&Cipher115;
-	result[0x00AB] = (SSLCipherSuite*)&Cipher116;
-	result[0x00AC] = (SSLCipherSuite*)&Cipher117;
-	result[0x00AD] = (SSLCipherSuite*)&Cipher118;
-	result[0x00AE] = (SSLCipherSuite*)&Cipher119;
-	result[0x00AF] = (SSLCipherSuite*)&Cipher120;
-	result[0x00B0] = (SSLCipherSuite*)&Cipher121;
-	result[0x00B1] = (SSLCipherSuite*)&Cipher122;
-	result[0x00B2] = (SSLCipherSuite*)&Cipher123;
-	result[0x00B3] = (SSLCipherSuite*)&Cipher124;
-	result[0x00B4] = (SSLCipherSuite*)&Cipher125;
-	result[0x00B5] = (SSLCipherSuite*)&Cipher126;
-	result[0x00B6] = (SSLCipherSuite*)&Cipher127;
-	result[0x00B7] = (SSLCipherSuite*)&Cipher128;
-	result[0x00B8] = (SSLCipherSuite*)&Cipher129;
-	result[0x00B9] = (SSLCipherSuite*)&Cipher130;
-	result[0x00BA] = (SSLCipherSuite*)&Cipher131;
-	result[0x00BB] = (SSLCipherSuite*)&Cipher132;
-	result[0x00BC] = (SSLCipherSuite*)&Cipher133;
-	result[0x00BD] = (SSLCipherSuite*)&Cipher134;
-	result[0x00BE] = (SSLCipherSuite*)&Cipher135;
-	result[0x00BF] = (SSLCipherSuite*)&Cipher136;
-	result[0x00C0] = (SSLCipherSuite*)&Cipher137;
-	result[0x00C1] = (SSLCipherSuite*)&Cipher138;
-	result[0x00C2] = (SSLCipherSuite*)&Cipher139;
-	result[0x00C3] = (SSLCipherSuite*)&Cipher140;
-	result[0x00C4] = (SSLCipherSuite*)&Cipher141;
-	result[0x00C5] = (SSLCipherSuite*)&Cipher142;
-	result[0xC001] = (SSLCipherSuite*)&Cipher143;
-	result[0xC002] = (SSLCipherSuite*)&Cipher144;
-	result[0xC003] = (SSLCipherSuite*)&Cipher145;
-	result[0xC004] = (SSLCipherSuite*)&Cipher146;
-	result[0xC005] = (SSLCipherSuite*)&Cipher147;
-	result[0xC006] = (SSLCipherSuite*)&Cipher148;
-	result[0xC007] = (SSLCipherSuite*)&Cipher149;
-	result[0xC008] = (SSLCipherSuite*)&Cipher150;
-	result[0xC009] = (SSLCipherSuite*)&Cipher151;
-	result[0xC00A] = (SSLCipherSuite*)&Cipher152;
-	result[0xC00B] = (SSLCipherSuite*)&Cipher153;
-	result[0xC00C] = (SSLCipherSuite*)&Cipher154;
-	result[0xC00D] = (SSLCipherSuite*)&Cipher155;
-	result[0xC00E] = (SSLCipherSuite*)&Cipher156;
-	result[0xC00F] = (SSLCipherSuite*)&Cipher157;
-	result[0xC010] = (SSLCipherSuite*)&Cipher158;
-	result[0xC011] = (SSLCipherSuite*)&Cipher159;
-	result[0xC012] = (SSLCipherSuite*)&Cipher160;
-	result[0xC013] = (SSLCipherSuite*)&Cipher161;
-	result[0xC014] = (SSLCipherSuite*)&Cipher162;
-	result[0xC015] = (SSLCipherSuite*)&Cipher163;
-	result[0xC016] = (SSLCipherSuite*)&Cipher164;
-	result[0xC017] = (SSLCipherSuite*)&Cipher165;
-	result[0xC018] = (SSLCipherSuite*)&Cipher166;
-	result[0xC019] = (SSLCipherSuite*)&Cipher167;
-	result[0xC01A] = (SSLCipherSuite*)&Cipher168;
-	result[0xC01B] = (SSLCipherSuite*)&Cipher169;
-	result[0xC01C] = (SSLCipherSuite*)&Cipher170;
-	result[0xC01D] = (SSLCipherSuite*)&Cipher171;
-	result[0xC01E] = (SSLCipherSuite*)&Cipher172;
-	result[0xC01F] = (SSLCipherSuite*)&Cipher173;
-	result[0xC020] = (SSLCipherSuite*)&Cipher174;
-	result[0xC021] = (SSLCipherSuite*)&Cipher175;
-	result[0xC022] = (SSLCipherSuite*)&Cipher176;
-	result[0xC023] = (SSLCipherSuite*)&Cipher177;
-	result[0xC024] = (SSLCipherSuite*)&Cipher178;
-	result[0xC025] = (SSLCipherSuite*)&Cipher179;
-	result[0xC026] = (SSLCipherSuite*)&Cipher180;
-	result[0xC027] = (SSLCipherSuite*)&Cipher181;
-	result[0xC028] = (SSLCipherSuite*)&Cipher182;
-	result[0xC029] = (SSLCipherSuite*)&Cipher183;
-	result[0xC02A] = (SSLCipherSuite*)&Cipher184;
-	result[0xC02B] = (SSLCipherSuite*)&Cipher185;
-	result[0xC02C] = (SSLCipherSuite*)&Cipher186;
-	result[0xC02D] = (SSLCipherSuite*)&Cipher187;
-	result[0xC02E] = (SSLCipherSuite*)&Cipher188;
-	result[0xC02F] = (SSLCipherSuite*)&Cipher189;
-	result[0xC030] = (SSLCipherSuite*)&Cipher190;
-	result[0xC031] = (SSLCipherSuite*)&Cipher191;
-	result[0xC032] = (SSLCipherSuite*)&Cipher192;
-	result[0xC033] = (SSLCipherSuite*)&Cipher193;
-	result[0xC034] = (SSLCipherSuite*)&Cipher194;
-	result[0xC035] = (SSLCipherSuite*)&Cipher195;
-	result[0xC036] = (SSLCipherSuite*)&Cipher196;
-	result[0xC037] = (SSLCipherSuite*)&Cipher197;
-	result[0xC038] = (SSLCipherSuite*)&Cipher198;
-	result[0xC039] = (SSLCipherSuite*)&Cipher199;
-	result[0xC03A] = (SSLCipherSuite*)&Cipher200;
-	result[0xC03B] = (SSLCipherSuite*)&Cipher201;
-	result[0xC03C] = (SSLCipherSuite*)&Cipher202;
-	result[0xC03D] = (SSLCipherSuite*)&Cipher203;
-	result[0xC03E] = (SSLCipherSuite*)&Cipher204;
-	result[0xC03F] = (SSLCipherSuite*)&Cipher205;
-	result[0xC040] = (SSLCipherSuite*)&Cipher206;
-	result[0xC041] = (SSLCipherSuite*)&Cipher207;
-	result[0xC042] = (SSLCipherSuite*)&Cipher208;
-	result[0xC043] = (SSLCipherSuite*)&Cipher209;
-	result[0xC044] = (SSLCipherSuite*)&Cipher210;
-	result[0xC045] = (SSLCipherSuite*)&Cipher211;
-	result[0xC046] = (SSLCipherSuite*)&Cipher212;
-	result[0xC047] = (SSLCipherSuite*)&Cipher213;
-	result[0xC048] = (SSLCipherSuite*)&Cipher214;
-	result[0xC049] = (SSLCipherSuite*)&Cipher215;
-	result[0xC04A] = (SSLCipherSuite*)&Cipher216;
-	result[0xC04B] = (SSLCipherSuite*)&Cipher217;
-	result[0xC04C] = (SSLCipherSuite*)&Cipher218;
-	result[0xC04D] = (SSLCipherSuite*)&Cipher219;
-	result[0xC04E] = (SSLCipherSuite*)&Cipher220;
-	result[0xC04F] = (SSLCipherSuite*)&Cipher221;
-	result[0xC050] = (SSLCipherSuite*)&Cipher222;
-	result[0xC051] = (SSLCipherSuite*)&Cipher223;
-	result[0xC052] = (SSLCipherSuite*)&Cipher224;
-	result[0xC053] = (SSLCipherSuite*)&Cipher225;
-	result[0xC054] = (SSLCipherSuite*)&Cipher226;
-	result[0xC055] = (SSLCipherSuite*)&Cipher227;
-	result[0xC056] = (SSLCipherSuite*)&Cipher228;
-	result[0xC057] = (SSLCipherSuite*)&Cipher229;
-	result[0xC058] = (SSLCipherSuite*)&Cipher230;
-	result[0xC059] = (SSLCipherSuite*)&Cipher231;
-	result[0xC05A] = (SSLCipherSuite*)&Cipher232;
-	result[0xC05B] = (SSLCipherSuite*)&Cipher233;
-	result[0xC05C] = (SSLCipherSuite*)&Cipher234;
-	result[0xC05D] = (SSLCipherSuite*)&Cipher235;
-	result[0xC05E] = (SSLCipherSuite*)&Cipher236;
-	result[0xC05F] = (SSLCipherSuite*)&Cipher237;
-	result[0xC060] = (SSLCipherSuite*)&Cipher238;
-	result[0xC061] = (SSLCipherSuite*)&Cipher239;
-	result[0xC062] = (SSLCipherSuite*)&Cipher240;
-	result[0xC063] = (SSLCipherSuite*)&Cipher241;
-	result[0xC064] = (SSLCipherSuite*)&Cipher242;
-	result[0xC065] = (SSLCipherSuite*)&Cipher243;
-	result[0xC066] = (SSLCipherSuite*)&Cipher244;
-	result[0xC067] = (SSLCipherSuite*)&Cipher245;
-	result[0xC068] = (SSLCipherSuite*)&Cipher246;
-	result[0xC069] = (SSLCipherSuite*)&Cipher247;
-	result[0xC06A] = (SSLCipherSuite*)&Cipher248;
-	result[0xC06B] = (SSLCipherSuite*)&Cipher249;
-	result[0xC06C] = (SSLCipherSuite*)&Cipher250;
-	result[0xC06D] = (SSLCipherSuite*)&Cipher251;
-	result[0xC06E] = (SSLCipherSuite*)&Cipher252;
-	result[0xC06F] = (SSLCipherSuite*)&Cipher253;
-	result[0xC070] = (SSLCipherSuite*)&Cipher254;
-	result[0xC071] = (SSLCipherSuite*)&Cipher255;
-	result[0xC072] = (SSLCipherSuite*)&Cipher256;
-	result[0xC073] = (SSLCipherSuite*)&Cipher257;
-	result[0xC074] = (SSLCipherSuite*)&Cipher258;
-	result[0xC075] = (SSLCipherSuite*)&Cipher259;
-	result[0xC076] = (SSLCipherSuite*)&Cipher260;
-	result[0xC077] = (SSLCipherSuite*)&Cipher261;
-	result[0xC078] = (SSLCipherSuite*)&Cipher262;
-	result[0xC079] = (SSLCipherSuite*)&Cipher263;
-	result[0xC07A] = (SSLCipherSuite*)&Cipher264;
-	result[0xC07B] = (SSLCipherSuite*)&Cipher265;
-	result[0xC07C] = (SSLCipherSuite*)&Cipher266;
-	result[0xC07D] = (SSLCipherSuite*)&Cipher267;
-	result[0xC07E] = (SSLCipherSuite*)&Cipher268;
-	result[0xC07F] = (SSLCipherSuite*)&Cipher269;
-	result[0xC080] = (SSLCipherSuite*)&Cipher270;
-	result[0xC081] = (SSLCipherSuite*)&Cipher271;
-	result[0xC082] = (SSLCipherSuite*)&Cipher272;
-	result[0xC083] = (SSLCipherSuite*)&Cipher273;
-	result[0xC084] = (SSLCipherSuite*)&Cipher274;
-	result[0xC085] = (SSLCipherSuite*)&Cipher275;
-	result[0xC086] = (SSLCipherSuite*)&Cipher276;
-	result[0xC087] = (SSLCipherSuite*)&Cipher277;
-	result[0xC088] = (SSLCipherSuite*)&Cipher278;
-	result[0xC089] = (SSLCipherSuite*)&Cipher279;
-	result[0xC08A] = (SSLCipherSuite*)&Cipher280;
-	result[0xC08B] = (SSLCipherSuite*)&Cipher281;
-	result[0xC08C] = (SSLCipherSuite*)&Cipher282;
-	result[0xC08D] = (SSLCipherSuite*)&Cipher283;
-	result[0xC08E] = (SSLCipherSuite*)&Cipher284;
-	result[0xC08F] = (SSLCipherSuite*)&Cipher285;
-	result[0xC090] = (SSLCipherSuite*)&Cipher286;
-	result[0xC091] = (SSLCipherSuite*)&Cipher287;
-	result[0xC092] = (SSLCipherSuite*)&Cipher288;
-	result[0xC093] = (SSLCipherSuite*)&Cipher289;
-	result[0xC094] = (SSLCipherSuite*)&Cipher290;
-	result[0xC095] = (SSLCipherSuite*)&Cipher291;
-	result[0xC096] = (SSLCipherSuite*)&Cipher292;
-	result[0xC097] = (SSLCipherSuite*)&Cipher293;
-	result[0xC098] = (SSLCipherSuite*)&Cipher294;
-	result[0xC099] = (SSLCipherSuite*)&Cipher295;
-	result[0xC09A] = (SSLCipherSuite*)&Cipher296;
-	result[0xC09B] = (SSLCipherSuite*)&Cipher297;
-	result[0xC09C] = (SSLCipherSuite*)&Cipher298;
-	result[0xC09D] = (SSLCipherSuite*)&Cipher299;
-	result[0xC09E] = (SSLCipherSuite*)&Cipher300;
-	result[0xC09F] = (SSLCipherSuite*)&Cipher301;
-	result[0xC0A0] = (SSLCipherSuite*)&Cipher302;
-	result[0xC0A1] = (SSLCipherSuite*)&Cipher303;
-	result[0xC0A2] = (SSLCipherSuite*)&Cipher304;
-	result[0xC0A3] = (SSLCipherSuite*)&Cipher305;
-	result[0xC0A4] = (SSLCipherSuite*)&Cipher306;
-	result[0xC0A5] = (SSLCipherSuite*)&Cipher307;
-	result[0xC0A6] = (SSLCipherSuite*)&Cipher308;
-	result[0xC0A7] = (SSLCipherSuite*)&Cipher309;
-	result[0xC0A8] = (SSLCipherSuite*)&Cipher310;
-	result[0xC0A9] = (SSLCipherSuite*)&Cipher311;
-	result[0xC0AA] = (SSLCipherSuite*)&Cipher312;
-	result[0xC0AB] = (SSLCipherSuite*)&Cipher313;
-	result[0xC0AC] = (SSLCipherSuite*)&Cipher314;
-	result[0xC0AD] = (SSLCipherSuite*)&Cipher315;
-	result[0xC0AE] = (SSLCipherSuite*)&Cipher316;
-	result[0xC0AF] = (SSLCipherSuite*)&Cipher317;
-	result[0xCCA8] = (SSLCipherSuite*)&Cipher318;
-	result[0xCCA9] = (SSLCipherSuite*)&Cipher319;
-	result[0xCCAA] = (SSLCipherSuite*)&Cipher320;
-	result[0xCCAB] = (SSLCipherSuite*)&Cipher321;
-	result[0xCCAC] = (SSLCipherSuite*)&Cipher322;
-	result[0xCCAD] = (SSLCipherSuite*)&Cipher323;
-	result[0xCCAE] = (SSLCipherSuite*)&Cipher324;
-	result[0x1301] = (SSLCipherSuite*)&Cipher325;
-	result[0x1302] = (SSLCipherSuite*)&Cipher326;
-	result[0x1303] = (SSLCipherSuite*)&Cipher327;
-	result[0x1304] = (SSLCipherSuite*)&Cipher328;
-	result[0x1305] = (SSLCipherSuite*)&Cipher329;
-	return result;
-}
-
 #define A 54059 /* a prime */
 #define B 76963 /* another prime */
 #define C 86969 /* yet another prime */
 #define FIRST_HASH 37 /* also prime */
-static uint32_t hashString(std::string str)
+static uint32_t hashString(const std::string& str)
 {
 	unsigned h = FIRST_HASH;
 	for(std::string::size_type i = 0; i < str.size(); ++i)
@@ -699,372 +361,405 @@ static uint32_t hashString(std::string str)
 	return h;
 }
 
-static std::map<uint32_t, SSLCipherSuite*> createCipherSuiteStringToObjectMap()
-{
-	std::map<uint32_t, SSLCipherSuite*> result;
-
-	result[0x9F180F43] = (SSLCipherSuite*)&Cipher1;
-	result[0x97D9341F] = (SSLCipherSuite*)&Cipher2;
-	result[0x288FABA1] = (SSLCipherSuite*)&Cipher3;
-	result[0x9179C5BD] = (SSLCipherSuite*)&Cipher4;
-	result[0x68DF0C8F] = (SSLCipherSuite*)&Cipher5;
-	result[0x5FB32DF1] = (SSLCipherSuite*)&Cipher6;
-	result[0x2A1FC0FC] = (SSLCipherSuite*)&Cipher7;
-	result[0x5BF6459E] = (SSLCipherSuite*)&Cipher8;
-	result[0x60D692F4] = (SSLCipherSuite*)&Cipher9;
-	result[0x26A21427] = (SSLCipherSuite*)&Cipher10;
-	result[0xD3558C6D] = (SSLCipherSuite*)&Cipher11;
-	result[0xAE2673E9] = (SSLCipherSuite*)&Cipher12;
-	result[0xC63B19B0] = (SSLCipherSuite*)&Cipher13;
-	result[0xFE49B3BC] = (SSLCipherSuite*)&Cipher14;
-	result[0x625A86D5] = (SSLCipherSuite*)&Cipher15;
-	result[0x60FF1BD4] = (SSLCipherSuite*)&Cipher16;
-	result[0xE101D5C8] = (SSLCipherSuite*)&Cipher17;
-	result[0x422859E8] = (SSLCipherSuite*)&Cipher18;
-	result[0x88ABC503] = (SSLCipherSuite*)&Cipher19;
-	result[0x44284B1] = (SSLCipherSuite*)&Cipher20;
-	result[0xFD71B064] = (SSLCipherSuite*)&Cipher21;
-	result[0x76F35237] = (SSLCipherSuite*)&Cipher22;
-	result[0x7D93159D] = (SSLCipherSuite*)&Cipher23;
-	result[0x6E9D1AE2] = (SSLCipherSuite*)&Cipher24;
-	result[0xFA0974E4] = (SSLCipherSuite*)&Cipher25;
-	result[0xEC27ACB1] = (SSLCipherSuite*)&Cipher26;
-	result[0x6859C7A8] = (SSLCipherSuite*)&Cipher27;
-	result[0x55FD3D14] = (SSLCipherSuite*)&Cipher28;
-	result[0xA7650023] = (SSLCipherSuite*)&Cipher29;
-	result[0xDC042011] = (SSLCipherSuite*)&Cipher30;
-	result[0x94BFBF4D] = (SSLCipherSuite*)&Cipher31;
-	result[0x2FE24162] = (SSLCipherSuite*)&Cipher32;
-	result[0xC449D595] = (SSLCipherSuite*)&Cipher33;
-	result[0xE11292AF] = (SSLCipherSuite*)&Cipher34;
-	result[0x47D0643] = (SSLCipherSuite*)&Cipher35;
-	result[0xC9ABBA3C] = (SSLCipherSuite*)&Cipher36;
-	result[0x9F323A5F] = (SSLCipherSuite*)&Cipher37;
-	result[0xFBF78046] = (SSLCipherSuite*)&Cipher38;
-	result[0x859BD79F] = (SSLCipherSuite*)&Cipher39;
-	result[0xF9FBBB39] = (SSLCipherSuite*)&Cipher40;
-	result[0x63587748] = (SSLCipherSuite*)&Cipher41;
-	result[0xF84CAE79] = (SSLCipherSuite*)&Cipher42;
-	result[0xCA39F6F1] = (SSLCipherSuite*)&Cipher43;
-	result[0xDC4D17C1] = (SSLCipherSuite*)&Cipher44;
-	result[0x955FBE28] = (SSLCipherSuite*)&Cipher45;
-	result[0x73ED7B86] = (SSLCipherSuite*)&Cipher46;
-	result[0x14A51855] = (SSLCipherSuite*)&Cipher47;
-	result[0x2CE54061] = (SSLCipherSuite*)&Cipher48;
-	result[0x3360789A] = (SSLCipherSuite*)&Cipher49;
-	result[0xDFEF59B6] = (SSLCipherSuite*)&Cipher50;
-	result[0xE819855D] = (SSLCipherSuite*)&Cipher51;
-	result[0x24CC3946] = (SSLCipherSuite*)&Cipher52;
-	result[0x1CACB5FD] = (SSLCipherSuite*)&Cipher53;
-	result[0x40193001] = (SSLCipherSuite*)&Cipher54;
-	result[0xA3846DA2] = (SSLCipherSuite*)&Cipher55;
-	result[0x8F3B7CF6] = (SSLCipherSuite*)&Cipher56;
-	result[0xC7B09945] = (SSLCipherSuite*)&Cipher57;
-	result[0xD8172F82] = (SSLCipherSuite*)&Cipher58;
-	result[0xB6748503] = (SSLCipherSuite*)&Cipher59;
-	result[0xDB105043] = (SSLCipherSuite*)&Cipher60;
-	result[0x21E8AC2E] = (SSLCipherSuite*)&Cipher61;
-	result[0x55096FC2] = (SSLCipherSuite*)&Cipher62;
-	result[0x38F955AF] = (SSLCipherSuite*)&Cipher63;
-	result[0xBA8C1D77] = (SSLCipherSuite*)&Cipher64;
-	result[0x91128102] = (SSLCipherSuite*)&Cipher65;
-	result[0xA7ED740E] = (SSLCipherSuite*)&Cipher66;
-	result[0x75C4908B] = (SSLCipherSuite*)&Cipher67;
-	result[0xBC6C5E87] = (SSLCipherSuite*)&Cipher68;
-	result[0xA0499A2A] = (SSLCipherSuite*)&Cipher69;
-	result[0x4F0FFC13] = (SSLCipherSuite*)&Cipher70;
-	result[0xCCEE9996] = (SSLCipherSuite*)&Cipher71;
-	result[0x8570DA22] = (SSLCipherSuite*)&Cipher72;
-	result[0x75D4FD57] = (SSLCipherSuite*)&Cipher73;
-	result[0x602E04D3] = (SSLCipherSuite*)&Cipher74;
-	result[0x5EDC9C36] = (SSLCipherSuite*)&Cipher75;
-	result[0xE66C167E] = (SSLCipherSuite*)&Cipher76;
-	result[0x909F6D7B] = (SSLCipherSuite*)&Cipher77;
-	result[0x3C35B1AA] = (SSLCipherSuite*)&Cipher78;
-	result[0x6D4D1A2E] = (SSLCipherSuite*)&Cipher79;
-	result[0xBF788317] = (SSLCipherSuite*)&Cipher80;
-	result[0x5329738B] = (SSLCipherSuite*)&Cipher81;
-	result[0x7D11AB2] = (SSLCipherSuite*)&Cipher82;
-	result[0x461ACA21] = (SSLCipherSuite*)&Cipher83;
-	result[0x15404ADD] = (SSLCipherSuite*)&Cipher84;
-	result[0x3806AF6] = (SSLCipherSuite*)&Cipher85;
-	result[0xB2D80EB6] = (SSLCipherSuite*)&Cipher86;
-	result[0xE54425D1] = (SSLCipherSuite*)&Cipher87;
-	result[0x476457CD] = (SSLCipherSuite*)&Cipher88;
-	result[0x1D55E526] = (SSLCipherSuite*)&Cipher89;
-	result[0x953C69E6] = (SSLCipherSuite*)&Cipher90;
-	result[0x6ADE7E16] = (SSLCipherSuite*)&Cipher91;
-	result[0xE8C7BBE8] = (SSLCipherSuite*)&Cipher92;
-	result[0x623DC741] = (SSLCipherSuite*)&Cipher93;
-	result[0xF403E1] = (SSLCipherSuite*)&Cipher94;
-	result[0x90D8CADC] = (SSLCipherSuite*)&Cipher95;
-	result[0xC30D1199] = (SSLCipherSuite*)&Cipher96;
-	result[0x9CFB1B5D] = (SSLCipherSuite*)&Cipher97;
-	result[0x2D3B99E8] = (SSLCipherSuite*)&Cipher98;
-	result[0x4A9E8B0C] = (SSLCipherSuite*)&Cipher99;
-	result[0x16BD2351] = (SSLCipherSuite*)&Cipher100;
-	result[0x586BC20E] = (SSLCipherSuite*)&Cipher101;
-	result[0x996B90AA] = (SSLCipherSuite*)&Cipher102;
-	result[0x2F3871FE] = (SSLCipherSuite*)&Cipher103;
-	result[0xF2DD519A] = (SSLCipherSuite*)&Cipher104;
-	result[0x52615F23] = (SSLCipherSuite*)&Cipher105;
-	result[0xDEE51337] = (SSLCipherSuite*)&Cipher106;
-	result[0xB30890E2] = (SSLCipherSuite*)&Cipher107;
-	result[0x40F3FF3E] = (SSLCipherSuite*)&Cipher108;
-	result[0xE306EE17] = (SSLCipherSuite*)&Cipher109;
-	result[0x870C6FCB] = (SSLCipherSuite*)&Cipher110;
-	result[0xEB12CAEF] = (SSLCipherSuite*)&Cipher111;
-	result[0x68795983] = (SSLCipherSuite*)&Cipher112;
-	result[0x606BA9BE] = (SSLCipherSuite*)&Cipher113;
-	result[0x2C33475A] = (SSLCipherSuite*)&Cipher114;
-	result[0x640CAAEE] = (SSLCipherSuite*)&Cipher115;
-	result[0x6603488A] = (SSLCipherSuite*)&Cipher116;
-	result[0x8BA58643] = (SSLCipherSuite*)&Cipher117;
-	result[0x16059E57] = (SSLCipherSuite*)&Cipher118;
-	result[0x1B0606D3] = (SSLCipherSuite*)&Cipher119;
-	result[0x1CF76007] = (SSLCipherSuite*)&Cipher120;
-	result[0x618CE8F2] = (SSLCipherSuite*)&Cipher121;
-	result[0xE264D3B6] = (SSLCipherSuite*)&Cipher122;
-	result[0xB4C5AE63] = (SSLCipherSuite*)&Cipher123;
-	result[0x95DF4757] = (SSLCipherSuite*)&Cipher124;
-	result[0x1D1CF062] = (SSLCipherSuite*)&Cipher125;
-	result[0xE7AA2826] = (SSLCipherSuite*)&Cipher126;
-	result[0x38D94EE2] = (SSLCipherSuite*)&Cipher127;
-	result[0x889BA306] = (SSLCipherSuite*)&Cipher128;
-	result[0x5B816E75] = (SSLCipherSuite*)&Cipher129;
-	result[0x6F18C4DD] = (SSLCipherSuite*)&Cipher130;
-	result[0x2E1C05E0] = (SSLCipherSuite*)&Cipher131;
-	result[0x5592CFF7] = (SSLCipherSuite*)&Cipher132;
-	result[0x8221D38B] = (SSLCipherSuite*)&Cipher133;
-	result[0x9538105C] = (SSLCipherSuite*)&Cipher134;
-	result[0xF1100DD0] = (SSLCipherSuite*)&Cipher135;
-	result[0xF492EF1F] = (SSLCipherSuite*)&Cipher136;
-	result[0x226BD52C] = (SSLCipherSuite*)&Cipher137;
-	result[0xBBACE99F] = (SSLCipherSuite*)&Cipher138;
-	result[0xB3D4B66B] = (SSLCipherSuite*)&Cipher139;
-	result[0x8C619440] = (SSLCipherSuite*)&Cipher140;
-	result[0xE60B95C] = (SSLCipherSuite*)&Cipher141;
-	result[0x24F48D07] = (SSLCipherSuite*)&Cipher142;
-	result[0x15C7AF26] = (SSLCipherSuite*)&Cipher143;
-	result[0xCBA219CC] = (SSLCipherSuite*)&Cipher144;
-	result[0x9BD946BE] = (SSLCipherSuite*)&Cipher145;
-	result[0x7CCA46FF] = (SSLCipherSuite*)&Cipher146;
-	result[0x9FB51FA3] = (SSLCipherSuite*)&Cipher147;
-	result[0xC82A275B] = (SSLCipherSuite*)&Cipher148;
-	result[0x4472A583] = (SSLCipherSuite*)&Cipher149;
-	result[0xDBA3A5CF] = (SSLCipherSuite*)&Cipher150;
-	result[0x86338128] = (SSLCipherSuite*)&Cipher151;
-	result[0x8CCE91E4] = (SSLCipherSuite*)&Cipher152;
-	result[0xA81C6CA0] = (SSLCipherSuite*)&Cipher153;
-	result[0x6D80815E] = (SSLCipherSuite*)&Cipher154;
-	result[0xA383DEB0] = (SSLCipherSuite*)&Cipher155;
-	result[0x52073879] = (SSLCipherSuite*)&Cipher156;
-	result[0x5BA0B279] = (SSLCipherSuite*)&Cipher157;
-	result[0xD787CCC9] = (SSLCipherSuite*)&Cipher158;
-	result[0x9C86C6A9] = (SSLCipherSuite*)&Cipher159;
-	result[0xDAE424E5] = (SSLCipherSuite*)&Cipher160;
-	result[0x72C15ECE] = (SSLCipherSuite*)&Cipher161;
-	result[0xF0E8FB6E] = (SSLCipherSuite*)&Cipher162;
-	result[0xA2005D44] = (SSLCipherSuite*)&Cipher163;
-	result[0x77F79962] = (SSLCipherSuite*)&Cipher164;
-	result[0x25C8184C] = (SSLCipherSuite*)&Cipher165;
-	result[0x2070F8A5] = (SSLCipherSuite*)&Cipher166;
-	result[0x4189ED8D] = (SSLCipherSuite*)&Cipher167;
-	result[0x94C21B1] = (SSLCipherSuite*)&Cipher168;
-	result[0x1B0CB25C] = (SSLCipherSuite*)&Cipher169;
-	result[0xF18127A0] = (SSLCipherSuite*)&Cipher170;
-	result[0xC7FCA79A] = (SSLCipherSuite*)&Cipher171;
-	result[0xC1DEE135] = (SSLCipherSuite*)&Cipher172;
-	result[0xDA7143E9] = (SSLCipherSuite*)&Cipher173;
-	result[0xE82B6A2] = (SSLCipherSuite*)&Cipher174;
-	result[0x438EC1DD] = (SSLCipherSuite*)&Cipher175;
-	result[0x6BE32FA9] = (SSLCipherSuite*)&Cipher176;
-	result[0x18A5C375] = (SSLCipherSuite*)&Cipher177;
-	result[0x24136C59] = (SSLCipherSuite*)&Cipher178;
-	result[0x88529408] = (SSLCipherSuite*)&Cipher179;
-	result[0xADAB33FC] = (SSLCipherSuite*)&Cipher180;
-	result[0x79407DCB] = (SSLCipherSuite*)&Cipher181;
-	result[0x64970FFF] = (SSLCipherSuite*)&Cipher182;
-	result[0x8260DC9A] = (SSLCipherSuite*)&Cipher183;
-	result[0x4B74FFFE] = (SSLCipherSuite*)&Cipher184;
-	result[0x350DD5C8] = (SSLCipherSuite*)&Cipher185;
-	result[0x53E057C] = (SSLCipherSuite*)&Cipher186;
-	result[0x266020E1] = (SSLCipherSuite*)&Cipher187;
-	result[0xE6DB4B9D] = (SSLCipherSuite*)&Cipher188;
-	result[0x5A992E6] = (SSLCipherSuite*)&Cipher189;
-	result[0x1B33C882] = (SSLCipherSuite*)&Cipher190;
-	result[0x33579D2B] = (SSLCipherSuite*)&Cipher191;
-	result[0x1BD7F7FF] = (SSLCipherSuite*)&Cipher192;
-	result[0x39C59ED9] = (SSLCipherSuite*)&Cipher193;
-	result[0x4F19FB95] = (SSLCipherSuite*)&Cipher194;
-	result[0x8F4737BE] = (SSLCipherSuite*)&Cipher195;
-	result[0x2567AA9E] = (SSLCipherSuite*)&Cipher196;
-	result[0xEEF843DB] = (SSLCipherSuite*)&Cipher197;
-	result[0x978C4E4F] = (SSLCipherSuite*)&Cipher198;
-	result[0x2F8D17D9] = (SSLCipherSuite*)&Cipher199;
-	result[0x7F80393A] = (SSLCipherSuite*)&Cipher200;
-	result[0xDCA5AE1E] = (SSLCipherSuite*)&Cipher201;
-	result[0x74AA95D7] = (SSLCipherSuite*)&Cipher202;
-	result[0xB93174BB] = (SSLCipherSuite*)&Cipher203;
-	result[0x46E274FC] = (SSLCipherSuite*)&Cipher204;
-	result[0x9DC85330] = (SSLCipherSuite*)&Cipher205;
-	result[0x972847B8] = (SSLCipherSuite*)&Cipher206;
-	result[0xFCF61DAC] = (SSLCipherSuite*)&Cipher207;
-	result[0x73C0029B] = (SSLCipherSuite*)&Cipher208;
-	result[0xDA41D70F] = (SSLCipherSuite*)&Cipher209;
-	result[0x12CBC4E7] = (SSLCipherSuite*)&Cipher210;
-	result[0x8B2D5ACB] = (SSLCipherSuite*)&Cipher211;
-	result[0x28C0C084] = (SSLCipherSuite*)&Cipher212;
-	result[0x1602C1F8] = (SSLCipherSuite*)&Cipher213;
-	result[0xF5FB9ED] = (SSLCipherSuite*)&Cipher214;
-	result[0xE8E30E91] = (SSLCipherSuite*)&Cipher215;
-	result[0x70BA7792] = (SSLCipherSuite*)&Cipher216;
-	result[0x94C38076] = (SSLCipherSuite*)&Cipher217;
-	result[0xE5B3483F] = (SSLCipherSuite*)&Cipher218;
-	result[0x892DEBE3] = (SSLCipherSuite*)&Cipher219;
-	result[0x65609E50] = (SSLCipherSuite*)&Cipher220;
-	result[0xAB4F3F04] = (SSLCipherSuite*)&Cipher221;
-	result[0x8BFC76DA] = (SSLCipherSuite*)&Cipher222;
-	result[0xD4BDCD6] = (SSLCipherSuite*)&Cipher223;
-	result[0xCAB8F54A] = (SSLCipherSuite*)&Cipher224;
-	result[0xA10DCFC6] = (SSLCipherSuite*)&Cipher225;
-	result[0xD6B71B71] = (SSLCipherSuite*)&Cipher226;
-	result[0x6D775A2D] = (SSLCipherSuite*)&Cipher227;
-	result[0x7997AD16] = (SSLCipherSuite*)&Cipher228;
-	result[0x5338C632] = (SSLCipherSuite*)&Cipher229;
-	result[0x45F0598D] = (SSLCipherSuite*)&Cipher230;
-	result[0x2D8B6A99] = (SSLCipherSuite*)&Cipher231;
-	result[0xE14DC125] = (SSLCipherSuite*)&Cipher232;
-	result[0x1538351] = (SSLCipherSuite*)&Cipher233;
-	result[0x1A8CE530] = (SSLCipherSuite*)&Cipher234;
-	result[0xB01E69C4] = (SSLCipherSuite*)&Cipher235;
-	result[0xCCBF70D3] = (SSLCipherSuite*)&Cipher236;
-	result[0xEF664FE7] = (SSLCipherSuite*)&Cipher237;
-	result[0xF6ED4F52] = (SSLCipherSuite*)&Cipher238;
-	result[0x7D6522E] = (SSLCipherSuite*)&Cipher239;
-	result[0xBDB5C9B9] = (SSLCipherSuite*)&Cipher240;
-	result[0xD98D5C95] = (SSLCipherSuite*)&Cipher241;
-	result[0x92B92727] = (SSLCipherSuite*)&Cipher242;
-	result[0xB4FE570B] = (SSLCipherSuite*)&Cipher243;
-	result[0x8DCF7F77] = (SSLCipherSuite*)&Cipher244;
-	result[0x8208545B] = (SSLCipherSuite*)&Cipher245;
-	result[0x39A13298] = (SSLCipherSuite*)&Cipher246;
-	result[0xECB7070C] = (SSLCipherSuite*)&Cipher247;
-	result[0xAFA95F8A] = (SSLCipherSuite*)&Cipher248;
-	result[0x3D80E106] = (SSLCipherSuite*)&Cipher249;
-	result[0x83AF9B7A] = (SSLCipherSuite*)&Cipher250;
-	result[0x1FAAC2F6] = (SSLCipherSuite*)&Cipher251;
-	result[0x2AF11F51] = (SSLCipherSuite*)&Cipher252;
-	result[0xEDFD300D] = (SSLCipherSuite*)&Cipher253;
-	result[0x91AA268F] = (SSLCipherSuite*)&Cipher254;
-	result[0x9DF0E933] = (SSLCipherSuite*)&Cipher255;
-	result[0xF3951A6A] = (SSLCipherSuite*)&Cipher256;
-	result[0xE4FF8DCE] = (SSLCipherSuite*)&Cipher257;
-	result[0xBE4DFC61] = (SSLCipherSuite*)&Cipher258;
-	result[0xBB2CF025] = (SSLCipherSuite*)&Cipher259;
-	result[0x354D38A8] = (SSLCipherSuite*)&Cipher260;
-	result[0xE2444B9C] = (SSLCipherSuite*)&Cipher261;
-	result[0xF8298D43] = (SSLCipherSuite*)&Cipher262;
-	result[0x3EC413B7] = (SSLCipherSuite*)&Cipher263;
-	result[0xE0C75BE9] = (SSLCipherSuite*)&Cipher264;
-	result[0x7191BE45] = (SSLCipherSuite*)&Cipher265;
-	result[0xDDE7C439] = (SSLCipherSuite*)&Cipher266;
-	result[0xBE715415] = (SSLCipherSuite*)&Cipher267;
-	result[0x6CF8F9A6] = (SSLCipherSuite*)&Cipher268;
-	result[0x36D61242] = (SSLCipherSuite*)&Cipher269;
-	result[0xFA9BA9ED] = (SSLCipherSuite*)&Cipher270;
-	result[0x4588B179] = (SSLCipherSuite*)&Cipher271;
-	result[0xB3C246FA] = (SSLCipherSuite*)&Cipher272;
-	result[0x750EEB76] = (SSLCipherSuite*)&Cipher273;
-	result[0xC50ACCB2] = (SSLCipherSuite*)&Cipher274;
-	result[0x9555CD0E] = (SSLCipherSuite*)&Cipher275;
-	result[0xF25A659B] = (SSLCipherSuite*)&Cipher276;
-	result[0x1670E72F] = (SSLCipherSuite*)&Cipher277;
-	result[0xDB0DD6BC] = (SSLCipherSuite*)&Cipher278;
-	result[0x19CACD70] = (SSLCipherSuite*)&Cipher279;
-	result[0xC54D5481] = (SSLCipherSuite*)&Cipher280;
-	result[0x7BCCA2BD] = (SSLCipherSuite*)&Cipher281;
-	result[0xA851374E] = (SSLCipherSuite*)&Cipher282;
-	result[0xE887BEA] = (SSLCipherSuite*)&Cipher283;
-	result[0xDECAA7F9] = (SSLCipherSuite*)&Cipher284;
-	result[0x29DA73D5] = (SSLCipherSuite*)&Cipher285;
-	result[0xAC69ECC9] = (SSLCipherSuite*)&Cipher286;
-	result[0x6AE55625] = (SSLCipherSuite*)&Cipher287;
-	result[0x2BB24546] = (SSLCipherSuite*)&Cipher288;
-	result[0x7AB5F262] = (SSLCipherSuite*)&Cipher289;
-	result[0x3DB83990] = (SSLCipherSuite*)&Cipher290;
-	result[0xC852A244] = (SSLCipherSuite*)&Cipher291;
-	result[0xA3C952C0] = (SSLCipherSuite*)&Cipher292;
-	result[0xAF630C34] = (SSLCipherSuite*)&Cipher293;
-	result[0xD4EE22B] = (SSLCipherSuite*)&Cipher294;
-	result[0x83F4C5DF] = (SSLCipherSuite*)&Cipher295;
-	result[0xCCF6F918] = (SSLCipherSuite*)&Cipher296;
-	result[0x955C9E8C] = (SSLCipherSuite*)&Cipher297;
-	result[0xF3559154] = (SSLCipherSuite*)&Cipher298;
-	result[0xE0991C14] = (SSLCipherSuite*)&Cipher299;
-	result[0x7F6BF424] = (SSLCipherSuite*)&Cipher300;
-	result[0x4A129264] = (SSLCipherSuite*)&Cipher301;
-	result[0xB25E29E3] = (SSLCipherSuite*)&Cipher302;
-	result[0xA6E15A23] = (SSLCipherSuite*)&Cipher303;
-	result[0x637C5C53] = (SSLCipherSuite*)&Cipher304;
-	result[0x22794513] = (SSLCipherSuite*)&Cipher305;
-	result[0x4CE30464] = (SSLCipherSuite*)&Cipher306;
-	result[0xFDFE3B24] = (SSLCipherSuite*)&Cipher307;
-	result[0xDC8A2074] = (SSLCipherSuite*)&Cipher308;
-	result[0xFD448934] = (SSLCipherSuite*)&Cipher309;
-	result[0xF4FC2B13] = (SSLCipherSuite*)&Cipher310;
-	result[0xB10ECD53] = (SSLCipherSuite*)&Cipher311;
-	result[0xF44F4BC7] = (SSLCipherSuite*)&Cipher312;
-	result[0x49AF0BF] = (SSLCipherSuite*)&Cipher313;
-	result[0xDFAF479A] = (SSLCipherSuite*)&Cipher314;
-	result[0x82BF78CE] = (SSLCipherSuite*)&Cipher315;
-	result[0x46CD83C9] = (SSLCipherSuite*)&Cipher316;
-	result[0x8F7D7465] = (SSLCipherSuite*)&Cipher317;
-	result[0xBD9CDFE5] = (SSLCipherSuite*)&Cipher318;
-	result[0x92942203] = (SSLCipherSuite*)&Cipher319;
-	result[0x783C98AD] = (SSLCipherSuite*)&Cipher320;
-	result[0x92213B6D] = (SSLCipherSuite*)&Cipher321;
-	result[0xCFCB1A55] = (SSLCipherSuite*)&Cipher322;
-	result[0x54C2D55D] = (SSLCipherSuite*)&Cipher323;
-	result[0xDCD6F114] = (SSLCipherSuite*)&Cipher324;
-	result[0x6AD23C40] = (SSLCipherSuite*)&Cipher325;
-	result[0x5F5239D4] = (SSLCipherSuite*)&Cipher326;
-	result[0xAB27704B] = (SSLCipherSuite*)&Cipher327;
-	result[0xA3178D0C] = (SSLCipherSuite*)&Cipher328;
-	result[0x5DAAA195] = (SSLCipherSuite*)&Cipher329;
+// The tables below are generated from the cipher-suite list above by scripts/generate_cipher_suite_tables.py, rerun it after changing the list
+// BEGIN GENERATED CIPHER-SUITE TABLES
+// Cipher-suite IDs are looked up in two steps: the high byte of the ID selects a page of 256 cipher-suites and the low byte selects
+// the cipher-suite in the page. All known IDs fall in 4 pages so the tables take a few KB instead of a 65536-entry array, and IDs in
+// pages with no known cipher-suites point to an empty page so a lookup never branches. These tables and the name table below are
+// constant-initialized, so they don't cost anything at startup
+static const uint8_t CipherSuiteIdPageIndex[256] =
+{
+	1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static const SSLCipherSuite* const CipherSuiteIdPages[5][256] =
+{
+	// unknown pages
+	{},
+	// 0x0000-0x00FF
+	{
+		&Cipher1, &Cipher2, &Cipher3, &Cipher4, &Cipher5, &Cipher6, &Cipher7, &Cipher8,
+		&Cipher9, &Cipher10, &Cipher11, &Cipher12, &Cipher13, &Cipher14, &Cipher15, &Cipher16,
+		&Cipher17, &Cipher18, &Cipher19, &Cipher20, &Cipher21, &Cipher22, &Cipher23, &Cipher24,
+		&Cipher25, &Cipher26, &Cipher27, &Cipher28, nullptr, nullptr, &Cipher29, &Cipher30,
+		&Cipher31, &Cipher32, &Cipher33, &Cipher34, &Cipher35, &Cipher36, &Cipher37, &Cipher38,
+		&Cipher39, &Cipher40, &Cipher41, &Cipher42, &Cipher43, &Cipher44, &Cipher45, &Cipher46,
+		&Cipher47, &Cipher48, &Cipher49, &Cipher50, &Cipher51, &Cipher52, &Cipher53, &Cipher54,
+		&Cipher55, &Cipher56, &Cipher57, &Cipher58, &Cipher59, &Cipher60, &Cipher61, &Cipher62,
+		&Cipher63, &Cipher64, &Cipher65, &Cipher66, &Cipher67, &Cipher68, &Cipher69, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher70,
+		&Cipher71, &Cipher72, &Cipher73, &Cipher74, &Cipher75, &Cipher76, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, &Cipher77, &Cipher78, &Cipher79, &Cipher80,
+		&Cipher81, &Cipher82, &Cipher83, &Cipher84, &Cipher85, &Cipher86, &Cipher87, &Cipher88,
+		&Cipher89, &Cipher90, &Cipher91, &Cipher92, &Cipher93, &Cipher94, &Cipher95, &Cipher96,
+		&Cipher97, &Cipher98, &Cipher99, &Cipher100, &Cipher101, &Cipher102, &Cipher103, &Cipher104,
+		&Cipher105, &Cipher106, &Cipher107, &Cipher108, &Cipher109, &Cipher110, &Cipher111, &Cipher112,
+		&Cipher113, &Cipher114, &Cipher115, &Cipher116, &Cipher117, &Cipher118, &Cipher119, &Cipher120,
+		&Cipher121, &Cipher122, &Cipher123, &Cipher124, &Cipher125, &Cipher126, &Cipher127, &Cipher128,
+		&Cipher129, &Cipher130, &Cipher131, &Cipher132, &Cipher133, &Cipher134, &Cipher135, &Cipher136,
+		&Cipher137, &Cipher138, &Cipher139, &Cipher140, &Cipher141, &Cipher142, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
+	},
+	// 0x1300-0x13FF
+	{
+		nullptr, &Cipher325, &Cipher326, &Cipher327, &Cipher328, &Cipher329, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
+	},
+	// 0xC000-0xC0FF
+	{
+		nullptr, &Cipher143, &Cipher144, &Cipher145, &Cipher146, &Cipher147, &Cipher148, &Cipher149,
+		&Cipher150, &Cipher151, &Cipher152, &Cipher153, &Cipher154, &Cipher155, &Cipher156, &Cipher157,
+		&Cipher158, &Cipher159, &Cipher160, &Cipher161, &Cipher162, &Cipher163, &Cipher164, &Cipher165,
+		&Cipher166, &Cipher167, &Cipher168, &Cipher169, &Cipher170, &Cipher171, &Cipher172, &Cipher173,
+		&Cipher174, &Cipher175, &Cipher176, &Cipher177, &Cipher178, &Cipher179, &Cipher180, &Cipher181,
+		&Cipher182, &Cipher183, &Cipher184, &Cipher185, &Cipher186, &Cipher187, &Cipher188, &Cipher189,
+		&Cipher190, &Cipher191, &Cipher192, &Cipher193, &Cipher194, &Cipher195, &Cipher196, &Cipher197,
+		&Cipher198, &Cipher199, &Cipher200, &Cipher201, &Cipher202, &Cipher203, &Cipher204, &Cipher205,
+		&Cipher206, &Cipher207, &Cipher208, &Cipher209, &Cipher210, &Cipher211, &Cipher212, &Cipher213,
+		&Cipher214, &Cipher215, &Cipher216, &Cipher217, &Cipher218, &Cipher219, &Cipher220, &Cipher221,
+		&Cipher222, &Cipher223, &Cipher224, &Cipher225, &Cipher226, &Cipher227, &Cipher228, &Cipher229,
+		&Cipher230, &Cipher231, &Cipher232, &Cipher233, &Cipher234, &Cipher235, &Cipher236, &Cipher237,
+		&Cipher238, &Cipher239, &Cipher240, &Cipher241, &Cipher242, &Cipher243, &Cipher244, &Cipher245,
+		&Cipher246, &Cipher247, &Cipher248, &Cipher249, &Cipher250, &Cipher251, &Cipher252, &Cipher253,
+		&Cipher254, &Cipher255, &Cipher256, &Cipher257, &Cipher258, &Cipher259, &Cipher260, &Cipher261,
+		&Cipher262, &Cipher263, &Cipher264, &Cipher265, &Cipher266, &Cipher267, &Cipher268, &Cipher269,
+		&Cipher270, &Cipher271, &Cipher272, &Cipher273, &Cipher274, &Cipher275, &Cipher276, &Cipher277,
+		&Cipher278, &Cipher279, &Cipher280, &Cipher281, &Cipher282, &Cipher283, &Cipher284, &Cipher285,
+		&Cipher286, &Cipher287, &Cipher288, &Cipher289, &Cipher290, &Cipher291, &Cipher292, &Cipher293,
+		&Cipher294, &Cipher295, &Cipher296, &Cipher297, &Cipher298, &Cipher299, &Cipher300, &Cipher301,
+		&Cipher302, &Cipher303, &Cipher304, &Cipher305, &Cipher306, &Cipher307, &Cipher308, &Cipher309,
+		&Cipher310, &Cipher311, &Cipher312, &Cipher313, &Cipher314, &Cipher315, &Cipher316, &Cipher317,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
+	},
+	// 0xCC00-0xCCFF
+	{
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		&Cipher318, &Cipher319, &Cipher320, &Cipher321, &Cipher322, &Cipher323, &Cipher324, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
+	}
+};
+
+// An open-addressing hash table of the cipher-suites by name: a name is looked for from slot hashString(name) % 1024 onwards until
+// it's found or an empty slot is reached. The table is less than a third full so most names are found in the first slot
+static const size_t CipherSuiteNameTableSize = 1024;
+
+static const SSLCipherSuite* const CipherSuiteNameTable[CipherSuiteNameTableSize] =
+{
+	&Cipher192, &Cipher54, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher120,
+	&Cipher179, nullptr, nullptr, nullptr, nullptr, &Cipher253, &Cipher66, nullptr,
+	nullptr, &Cipher30, nullptr, &Cipher70, &Cipher299, &Cipher267, nullptr, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher2,
+	nullptr, nullptr, nullptr, &Cipher29, &Cipher300, &Cipher259, &Cipher126, &Cipher10,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher61, nullptr,
+	nullptr, nullptr, nullptr, nullptr, &Cipher293, nullptr, &Cipher75, nullptr,
+	nullptr, &Cipher266, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher218,
+	&Cipher140, &Cipher325, nullptr, &Cipher60, nullptr, nullptr, &Cipher38, nullptr,
+	nullptr, nullptr, nullptr, &Cipher327, &Cipher165, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, &Cipher304, nullptr, &Cipher47, nullptr, nullptr,
+	nullptr, &Cipher178, nullptr, &Cipher245, &Cipher134, nullptr, nullptr, nullptr,
+	nullptr, &Cipher48, &Cipher125, &Cipher258, &Cipher21, &Cipher306, &Cipher317, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher11, nullptr, nullptr,
+	nullptr, nullptr, nullptr, nullptr, &Cipher308, nullptr, &Cipher217, nullptr,
+	nullptr, &Cipher156, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	nullptr, &Cipher280, &Cipher190, nullptr, &Cipher212, nullptr, nullptr, nullptr,
+	nullptr, nullptr, &Cipher116, &Cipher67, nullptr, nullptr, nullptr, &Cipher5,
+	nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher241, nullptr, nullptr,
+	nullptr, nullptr, &Cipher49, &Cipher183, nullptr, nullptr, nullptr, nullptr,
+	&Cipher153, nullptr, nullptr, nullptr, nullptr, &Cipher166, nullptr, nullptr,
+	&Cipher260, nullptr, &Cipher102, nullptr, nullptr, &Cipher320, nullptr, nullptr,
+	nullptr, &Cipher20, &Cipher26, &Cipher274, nullptr, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, &Cipher203, nullptr, nullptr, nullptr, &Cipher313,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	nullptr, &Cipher158, &Cipher286, nullptr, nullptr, nullptr, &Cipher315, nullptr,
+	nullptr, nullptr, nullptr, &Cipher74, &Cipher236, nullptr, &Cipher223, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher130, nullptr, nullptr,
+	nullptr, &Cipher187, &Cipher107, nullptr, &Cipher25, &Cipher160, nullptr, &Cipher210,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	nullptr, nullptr, &Cipher121, nullptr, nullptr, nullptr, &Cipher56, nullptr,
+	nullptr, nullptr, nullptr, nullptr, &Cipher7, &Cipher204, nullptr, nullptr,
+	nullptr, nullptr, &Cipher65, &Cipher19, &Cipher59, nullptr, &Cipher249, &Cipher142,
+	nullptr, nullptr, nullptr, nullptr, &Cipher328, nullptr, &Cipher275, nullptr,
+	nullptr, nullptr, nullptr, &Cipher305, &Cipher28, &Cipher324, &Cipher228, nullptr,
+	&Cipher296, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher232, &Cipher89, nullptr,
+	&Cipher151, nullptr, nullptr, &Cipher191, &Cipher137, nullptr, nullptr, nullptr,
+	&Cipher234, nullptr, nullptr, &Cipher255, &Cipher309, &Cipher172, nullptr, nullptr,
+	nullptr, nullptr, &Cipher200, nullptr, nullptr, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, &Cipher262, &Cipher163, &Cipher57, &Cipher52, &Cipher288,
+	nullptr, nullptr, &Cipher224, nullptr, nullptr, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, &Cipher311, &Cipher298, nullptr, nullptr, &Cipher73,
+	nullptr, nullptr, nullptr, nullptr, &Cipher141, &Cipher51, &Cipher154, &Cipher323,
+	nullptr, nullptr, &Cipher32, &Cipher164, nullptr, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	&Cipher279, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher64,
+	nullptr, &Cipher271, nullptr, &Cipher77, &Cipher186, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, &Cipher112, &Cipher149, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher167, &Cipher230, nullptr,
+	&Cipher290, nullptr, nullptr, nullptr, nullptr, &Cipher33, &Cipher71, &Cipher329,
+	nullptr, &Cipher96, &Cipher104, &Cipher276, nullptr, &Cipher23, &Cipher8, &Cipher138,
+	nullptr, nullptr, &Cipher55, nullptr, nullptr, nullptr, &Cipher268, nullptr,
+	nullptr, nullptr, &Cipher78, nullptr, &Cipher207, nullptr, nullptr, &Cipher63,
+	&Cipher13, &Cipher168, nullptr, nullptr, nullptr, nullptr, &Cipher50, nullptr,
+	nullptr, &Cipher240, nullptr, nullptr, nullptr, &Cipher4, &Cipher113, nullptr,
+	nullptr, nullptr, nullptr, nullptr, &Cipher235, nullptr, nullptr, nullptr,
+	&Cipher17, &Cipher185, nullptr, &Cipher181, &Cipher144, nullptr, &Cipher257, &Cipher150,
+	&Cipher135, &Cipher87, nullptr, nullptr, &Cipher326, nullptr, nullptr, &Cipher202,
+	nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher175, nullptr, &Cipher295,
+	&Cipher131, nullptr, nullptr, &Cipher302, &Cipher152, nullptr, &Cipher90, nullptr,
+	&Cipher18, &Cipher98, nullptr, nullptr, nullptr, &Cipher214, &Cipher270, nullptr,
+	nullptr, &Cipher6, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	&Cipher213, nullptr, nullptr, nullptr, nullptr, &Cipher53, &Cipher103, nullptr,
+	nullptr, nullptr, nullptr, &Cipher319, nullptr, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher101, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher91, &Cipher109,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher201, nullptr,
+	nullptr, &Cipher83, &Cipher72, &Cipher303, nullptr, &Cipher287, nullptr, nullptr,
+	&Cipher45, nullptr, &Cipher69, &Cipher294, nullptr, &Cipher227, &Cipher79, &Cipher239,
+	nullptr, nullptr, &Cipher229, nullptr, nullptr, nullptr, nullptr, &Cipher22,
+	nullptr, nullptr, nullptr, nullptr, &Cipher36, nullptr, nullptr, nullptr,
+	nullptr, nullptr, &Cipher269, &Cipher35, &Cipher117, &Cipher265, &Cipher291, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher198,
+	&Cipher220, nullptr, nullptr, nullptr, nullptr, &Cipher322, nullptr, &Cipher118,
+	nullptr, nullptr, nullptr, nullptr, &Cipher169, nullptr, nullptr, &Cipher37,
+	nullptr, nullptr, &Cipher289, &Cipher123, &Cipher301, nullptr, nullptr, nullptr,
+	nullptr, nullptr, &Cipher256, &Cipher139, nullptr, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher129, nullptr, nullptr,
+	nullptr, &Cipher42, &Cipher157, nullptr, nullptr, nullptr, &Cipher76, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher68,
+	nullptr, nullptr, nullptr, nullptr, &Cipher297, nullptr, nullptr, &Cipher254,
+	nullptr, &Cipher215, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	&Cipher246, &Cipher231, nullptr, &Cipher208, nullptr, nullptr, &Cipher196, nullptr,
+	nullptr, nullptr, &Cipher174, nullptr, nullptr, nullptr, nullptr, nullptr,
+	nullptr, &Cipher159, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher34,
+	&Cipher155, nullptr, &Cipher82, nullptr, nullptr, nullptr, &Cipher86, nullptr,
+	nullptr, nullptr, nullptr, nullptr, &Cipher278, &Cipher281, &Cipher145, nullptr,
+	&Cipher292, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, &Cipher211, nullptr, nullptr, &Cipher161, nullptr,
+	nullptr, nullptr, nullptr, &Cipher119, nullptr, &Cipher15, nullptr, nullptr,
+	nullptr, &Cipher193, &Cipher222, nullptr, &Cipher95, &Cipher84, nullptr, nullptr,
+	nullptr, nullptr, &Cipher24, &Cipher127, nullptr, nullptr, &Cipher189, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher115, &Cipher111,
+	nullptr, &Cipher43, nullptr, nullptr, &Cipher9, nullptr, &Cipher85, &Cipher251,
+	nullptr, nullptr, &Cipher272, nullptr, nullptr, nullptr, nullptr, &Cipher146,
+	nullptr, nullptr, nullptr, nullptr, &Cipher221, nullptr, &Cipher128, nullptr,
+	nullptr, nullptr, nullptr, &Cipher243, &Cipher99, &Cipher247, nullptr, &Cipher209,
+	nullptr, nullptr, nullptr, &Cipher310, nullptr, nullptr, nullptr, &Cipher80,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher136,
+	nullptr, nullptr, nullptr, &Cipher105, &Cipher307, nullptr, &Cipher143, &Cipher242,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher277,
+	&Cipher205, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher106,
+	nullptr, &Cipher40, nullptr, nullptr, nullptr, nullptr, &Cipher108, nullptr,
+	nullptr, &Cipher93, nullptr, &Cipher1, nullptr, nullptr, nullptr, nullptr,
+	&Cipher41, nullptr, nullptr, nullptr, nullptr, &Cipher31, &Cipher282, nullptr,
+	nullptr, &Cipher100, &Cipher233, &Cipher238, &Cipher252, nullptr, nullptr, &Cipher124,
+	nullptr, nullptr, &Cipher114, &Cipher148, nullptr, &Cipher97, nullptr, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher321, &Cipher162, nullptr,
+	nullptr, &Cipher226, nullptr, nullptr, nullptr, &Cipher177, &Cipher273, &Cipher244,
+	nullptr, nullptr, &Cipher250, nullptr, nullptr, nullptr, nullptr, nullptr,
+	nullptr, nullptr, &Cipher58, nullptr, nullptr, nullptr, &Cipher46, nullptr,
+	nullptr, nullptr, &Cipher248, &Cipher81, &Cipher133, nullptr, nullptr, nullptr,
+	nullptr, nullptr, &Cipher216, nullptr, nullptr, &Cipher194, nullptr, nullptr,
+	nullptr, nullptr, &Cipher171, &Cipher314, &Cipher261, &Cipher188, nullptr, &Cipher39,
+	&Cipher170, &Cipher3, nullptr, &Cipher147, nullptr, nullptr, nullptr, nullptr,
+	&Cipher27, &Cipher176, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher122, &Cipher263,
+	&Cipher206, nullptr, nullptr, nullptr, &Cipher14, nullptr, &Cipher195, nullptr,
+	nullptr, &Cipher44, &Cipher62, nullptr, nullptr, nullptr, &Cipher225, &Cipher312,
+	nullptr, &Cipher316, nullptr, &Cipher110, nullptr, &Cipher88, nullptr, nullptr,
+	nullptr, nullptr, nullptr, nullptr, &Cipher16, &Cipher285, nullptr, nullptr,
+	nullptr, &Cipher199, nullptr, &Cipher197, nullptr, nullptr, nullptr, nullptr,
+	nullptr, &Cipher94, nullptr, &Cipher219, nullptr, &Cipher318, nullptr, &Cipher237,
+	&Cipher92, &Cipher12, &Cipher173, &Cipher264, &Cipher283, nullptr, nullptr, nullptr,
+	nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &Cipher132,
+	nullptr, &Cipher284, nullptr, nullptr, &Cipher180, nullptr, &Cipher184, &Cipher182
+};
+// END GENERATED CIPHER-SUITE TABLES
 
-	return result;
+SSLCipherSuite* SSLCipherSuite::getCipherSuiteByID(uint16_t id)
+{
+	return const_cast<SSLCipherSuite*>(CipherSuiteIdPages[CipherSuiteIdPageIndex[id >> 8]][id & 0xff]);
 }
 
-std::set<uint16_t> createGreaseSet()
+SSLCipherSuite* SSLCipherSuite::getCipherSuiteByName(std::string name)
 {
-	uint16_t greaseExtensions[] = {0x0a0a, 0x1a1a, 0x2a2a, 0x3a3a, 0x4a4a, 0x5a5a, 0x6a6a, 0x7a7a, 0x8a8a, 0x9a9a, 0xaaaa, 0xbaba, 0xcaca, 0xdada, 0xeaea, 0xfafa};
-	return std::set<uint16_t>(greaseExtensions, greaseExtensions + 16);
-}
+	size_t slot = hashString(name) & (CipherSuiteNameTableSize - 1);
+	while (CipherSuiteNameTable[slot] != nullptr)
+	{
+		if (name == CipherSuiteNameTable[slot]->m_Name)
+			return const_cast<SSLCipherSuite*>(CipherSuiteNameTable[slot]);
 
-static const std::map<uint16_t, SSLCipherSuite*> CipherSuiteIdToObjectMap = createCipherSuiteIdToObjectMap();
+		slot = (slot + 1) & (CipherSuiteNameTableSize - 1);
+	}
 
-static const std::map<uint32_t, SSLCipherSuite*> CipherSuiteStringToObjectMap = createCipherSuiteStringToObjectMap();
+	return nullptr;
+}
 
-static const std::set<uint16_t> GreaseSet = createGreaseSet();
+// ----------------------------
+// TLSFingerprintDigest methods
+// ----------------------------
 
-SSLCipherSuite* SSLCipherSuite::getCipherSuiteByID(uint16_t id)
+std::string TLSFingerprintDigest::toString() const
 {
-	std::map<uint16_t, SSLCipherSuite*>::const_iterator pos = CipherSuiteIdToObjectMap.find(id);
-	if (pos == CipherSuiteIdToObjectMap.end())
-		return nullptr;
-	else
-		return pos->second;
+	static const char hexDigits[] = "0123456789abcdef";
+	std::string result(2 * DigestLength, '0');
+	for (size_t i = 0; i < DigestLength; i++)
+	{
+		result[2 * i] = hexDigits[digest[i] >> 4];
+		result[2 * i + 1] = hexDigits[digest[i] & 0x0f];
+	}
+
+	return result;
 }
 
-SSLCipherSuite* SSLCipherSuite::getCipherSuiteByName(std::string name)
+/**
+ * Formats a TLS fingerprint string into a small buffer which is fed to MD5 whenever it fills up, so the fingerprint
+ * can be hashed without building the whole string
+ */
+class TLSFingerprintHasher
 {
-	uint32_t nameHash = hashString(std::move(name));
-	std::map<uint32_t, SSLCipherSuite*>::const_iterator pos = CipherSuiteStringToObjectMap.find(nameHash);
-	if (pos == CipherSuiteStringToObjectMap.end())
-		return nullptr;
-	else
-		return pos->second;
+public:
+	TLSFingerprintHasher() : m_BufferLen(0), m_FieldHasValues(false) {}
+
+	void addValue(uint16_t value)
+	{
+		if (m_FieldHasValues)
+			addChar('-');
+		m_FieldHasValues = true;
+
+		char digits[5];
+		int numOfDigits = 0;
+		do
+		{
+			digits[numOfDigits++] = '0' + (value % 10);
+			value /= 10;
+		} while (value > 0);
+
+		while (numOfDigits > 0)
+			addChar(digits[--numOfDigits]);
+	}
+
+	void endField()
+	{
+		addChar(',');
+		m_FieldHasValues = false;
+	}
+
+	void getDigest(TLSFingerprintDigest& result)
+	{
+		m_MD5.add(m_Buffer, m_BufferLen);
+		m_BufferLen = 0;
+		m_MD5.getHash(result.digest);
+	}
+
+private:
+	MD5 m_MD5;
+	char m_Buffer[64];
+	size_t m_BufferLen;
+	bool m_FieldHasValues;
+
+	void addChar(char c)
+	{
+		if (m_BufferLen == sizeof(m_Buffer))
+		{
+			m_MD5.add(m_Buffer, m_BufferLen);
+			m_BufferLen = 0;
+		}
+
+		m_Buffer[m_BufferLen++] = c;
+	}
+};
+
+// GREASE values (RFC 8701) are 0x0a0a, 0x1a1a, ..., 0xfafa
+static inline bool isGreaseValue(uint16_t value)
+{
+	return (value & 0x0f0f) == 0x0a0a && (value >> 8) == (value & 0xff);
 }
 
 // --------------------
@@ -1482,7 +1177,7 @@ SSLClientHelloMessage::ClientHelloTLSFingerprint SSLClientHelloMessage::generate
 	{
 		bool isValid = false;
 		uint16_t cipherSuiteID = getCipherSuiteID(i, isValid);
-		if (isValid && GreaseSet.find(cipherSuiteID) == GreaseSet.end())
+		if (isValid && !isGreaseValue(cipherSuiteID))
 			result.cipherSuites.push_back(cipherSuiteID);
 	}
 
@@ -1491,7 +1186,7 @@ SSLClientHelloMessage::ClientHelloTLSFingerprint SSLClientHelloMessage::generate
 	for (int i = 0; i < extensionCount; i++)
 	{
 		uint16_t extensionType = getExtension(i)->getTypeAsInt();
-		if (GreaseSet.find(extensionType) != GreaseSet.end())
+		if (isGreaseValue(extensionType))
 			continue;
 
 		result.extensions.push_back(extensionType);
@@ -1503,7 +1198,7 @@ SSLClientHelloMessage::ClientHelloTLSFingerprint SSLClientHelloMessage::generate
 	{
 		std::vector<uint16_t> supportedGroups = supportedGroupsExt->getSupportedGroups();
 		for (std::vector<uint16_t>::const_iterator iter = supportedGroups.begin(); iter != supportedGroups.end(); iter++)
-			if (GreaseSet.find(*iter) == GreaseSet.end())
+			if (!isGreaseValue(*iter))
 				result.supportedGroups.push_back(*iter);
 	}
 
@@ -1517,6 +1212,80 @@ SSLClientHelloMessage::ClientHelloTLSFingerprint SSLClientHelloMessage::generate
 	return result;
 }
 
+TLSFingerprintDigest SSLClientHelloMessage::generateTLSFingerprintDigest() const
+{
+	TLSFingerprintHasher hasher;
+
+	// add version
+	hasher.addValue(getHandshakeVersion().asUInt());
+	hasher.endField();
+
+	// add cipher suites
+	int cipherSuiteCount = getCipherSuiteCount();
+	for (int i = 0; i < cipherSuiteCount; i++)
+	{
+		bool isValid = false;
+		uint16_t cipherSuiteID = getCipherSuiteID(i, isValid);
+		if (isValid && !isGreaseValue(cipherSuiteID))
+			hasher.addValue(cipherSuiteID);
+	}
+	hasher.endField();
+
+	// add extensions and find the supported groups and EC point formats extensions on the way
+	const SSLExtension* supportedGroupsExt = nullptr;
+	const SSLExtension* ecPointFormatExt = nullptr;
+	int extensionCount = getExtensionCount();
+	for (int i = 0; i < extensionCount; i++)
+	{
+		const SSLExtension* extension = getExtension(i);
+		uint16_t extensionType = extension->getTypeAsInt();
+		if (isGreaseValue(extensionType))
+			continue;
+
+		hasher.addValue(extensionType);
+		if (extensionType == SSL_EXT_SUPPORTED_GROUPS && supportedGroupsExt == nullptr)
+			supportedGroupsExt = extension;
+		else if (extensionType == SSL_EXT_EC_POINT_FORMATS && ecPointFormatExt == nullptr)
+			ecPointFormatExt = extension;
+	}
+	hasher.endField();
+
+	// add supported groups, with the same validation as TLSSupportedGroupsExtension#getSupportedGroups()
+	if (supportedGroupsExt != nullptr && supportedGroupsExt->getLength() >= sizeof(uint16_t))
+	{
+		uint16_t extensionLength = supportedGroupsExt->getLength();
+		const uint8_t* dataPtr = supportedGroupsExt->getData();
+		uint16_t listLength = be16toh(*(uint16_t*)dataPtr);
+		if (listLength == extensionLength - sizeof(uint16_t) && listLength % 2 == 0)
+		{
+			dataPtr += sizeof(uint16_t);
+			for (int i = 0; i < listLength / 2; i++, dataPtr += sizeof(uint16_t))
+			{
+				uint16_t supportedGroup = be16toh(*(uint16_t*)dataPtr);
+				if (!isGreaseValue(supportedGroup))
+					hasher.addValue(supportedGroup);
+			}
+		}
+	}
+	hasher.endField();
+
+	// add EC point formats, with the same validation as TLSECPointFormatExtension#getECPointFormatList()
+	if (ecPointFormatExt != nullptr && ecPointFormatExt->getLength() >= sizeof(uint8_t))
+	{
+		const uint8_t* dataPtr = ecPointFormatExt->getData();
+		uint8_t listLength = *dataPtr;
+		if (listLength == static_cast<uint8_t>(ecPointFormatExt->getLength() - 1))
+		{
+			for (int i = 0; i < listLength; i++)
+				hasher.addValue(dataPtr[i + 1]);
+		}
+	}
+
+	TLSFingerprintDigest result;
+	hasher.getDigest(result);
+	return result;
+}
+
 std::string SSLClientHelloMessage::toString() const
 {
 	return "Client Hello message";
@@ -1774,6 +1543,47 @@ SSLServerHelloMessage::ServerHelloTLSFingerprint SSLServerHelloMessage::generate
 	return result;
 }
 
+TLSFingerprintDigest SSLServerHelloMessage::generateTLSFingerprintDigest() const
+{
+	TLSFingerprintHasher hasher;
+
+	// add version, taken from the supported versions extension if it contains a single version, like getHandshakeVersion() does
+	uint16_t tlsVersion = be16toh(getServerHelloHeader()->handshakeVersion);
+	const SSLExtension* supportedVersionsExt = nullptr;
+	int extensionCount = getExtensionCount();
+	for (int i = 0; i < extensionCount && supportedVersionsExt == nullptr; i++)
+	{
+		if (getExtension(i)->getTypeAsInt() == SSL_EXT_SUPPORTED_VERSIONS)
+			supportedVersionsExt = getExtension(i);
+	}
+
+	if (supportedVersionsExt != nullptr)
+	{
+		uint16_t extensionLength = supportedVersionsExt->getLength();
+		const uint8_t* dataPtr = supportedVersionsExt->getData();
+		if (extensionLength == 2)
+			tlsVersion = be16toh(*(uint16_t*)dataPtr);
+		else if (extensionLength == 3 && *dataPtr == 2)
+			tlsVersion = be16toh(*(uint16_t*)(dataPtr + 1));
+	}
+	hasher.addValue(tlsVersion);
+	hasher.endField();
+
+	// add cipher suite
+	bool isValid;
+	uint16_t cipherSuite = getCipherSuiteID(isValid);
+	hasher.addValue(isValid ? cipherSuite : 0);
+	hasher.endField();
+
+	// add extensions
+	for (int i = 0; i < extensionCount; i++)
+		hasher.addValue(getExtension(i)->getTypeAsInt());
+
+	TLSFingerprintDigest result;
+	hasher.getDigest(result);
+	return result;
+}
+
 std::string SSLServerHelloMessage::toString() const
 {
 	return "Server Hello message";
@@ -74,11 +74,7 @@ std::string SdpLayer::toString() const
 
 IPv4Address SdpLayer::getOwnerIPv4Address() const
 {
-	HeaderField* originator = getFieldByName(PCPP_SDP_ORIGINATOR_FIELD);
-	if (originator == nullptr)
-		return IPv4Address::Zero;
-
-	std::vector<std::string> tokens = splitByWhiteSpaces(originator->getFieldValue());
+	std::vector<std::string> tokens = splitByWhiteSpaces(getFieldValueByName(PCPP_SDP_ORIGINATOR_FIELD));
 	if (tokens.size() < 6)
 		return IPv4Address::Zero;
 
@@ -0,0 +1,253 @@
+#define LOG_MODULE PacketLogModuleTcpReassembly
+
+#include "ShardedTcpReassembly.h"
+#include "PacketUtils.h"
+#include "Logger.h"
+#include <chrono>
+
+// the number of times a worker polls its empty queue before it starts sleeping between polls
+#define WORKER_SPIN_COUNT 1024
+
+// the time a worker with an empty queue sleeps between polls
+#define WORKER_IDLE_SLEEP_USEC 50
+
+namespace pcpp
+{
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ShardedTcpReassembly::PacketQueue members
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+ShardedTcpReassembly::PacketQueue::PacketQueue(size_t capacity) : m_WriteIndex(0), m_ReadIndex(0)
+{
+	size_t roundedCapacity = 2;
+	while (roundedCapacity < capacity)
+		roundedCapacity <<= 1;
+
+	m_Entries.resize(roundedCapacity);
+	m_Mask = roundedCapacity - 1;
+}
+
+ShardedTcpReassembly::QueueEntry* ShardedTcpReassembly::PacketQueue::getWriteEntry()
+{
+	uint64_t writeIndex = m_WriteIndex.load(std::memory_order_relaxed);
+	if (writeIndex - m_ReadIndex.load(std::memory_order_acquire) >= m_Entries.size())
+		return NULL;
+
+	return &m_Entries[writeIndex & m_Mask];
+}
+
+void ShardedTcpReassembly::PacketQueue::commitWrite()
+{
+	m_WriteIndex.store(m_WriteIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+ShardedTcpReassembly::QueueEntry* ShardedTcpReassembly::PacketQueue::getReadEntry()
+{
+	uint64_t readIndex = m_ReadIndex.load(std::memory_order_relaxed);
+	if (readIndex == m_WriteIndex.load(std::memory_order_acquire))
+		return NULL;
+
+	return &m_Entries[readIndex & m_Mask];
+}
+
+void ShardedTcpReassembly::PacketQueue::commitRead()
+{
+	m_ReadIndex.store(m_ReadIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ShardedTcpReassembly::Shard members
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+ShardedTcpReassembly::Shard::Shard(TcpReassembly::OnTcpMessageReady onMessageReadyCallback, void* userCookie, TcpReassembly::OnTcpConnectionStart onConnectionStartCallback,
+	TcpReassembly::OnTcpConnectionEnd onConnectionEndCallback, const TcpReassemblyConfiguration& config, size_t queueCapacity) :
+	tcpReassembly(onMessageReadyCallback, userCookie, onConnectionStartCallback, onConnectionEndCallback, config), queue(queueCapacity), numOfProcessedPackets(0)
+{
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ShardedTcpReassembly members
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+ShardedTcpReassembly::ShardedTcpReassembly(size_t numOfShards, TcpReassembly::OnTcpMessageReady onMessageReadyCallback, void* userCookie,
+	TcpReassembly::OnTcpConnectionStart onConnectionStartCallback, TcpReassembly::OnTcpConnectionEnd onConnectionEndCallback,
+	const TcpReassemblyConfiguration& config, size_t queueCapacity) : m_StopWorkers(false)
+{
+	if (numOfShards == 0)
+	{
+		numOfShards = std::thread::hardware_concurrency();
+		if (numOfShards == 0)
+			numOfShards = 1;
+	}
+
+	for (size_t i = 0; i < numOfShards; i++)
+		m_Shards.push_back(new Shard(onMessageReadyCallback, userCookie, onConnectionStartCallback, onConnectionEndCallback, config, queueCapacity));
+
+	// start the workers only after all shards are created, so m_Shards is never modified while they're running
+	for (std::vector<Shard*>::iterator iter = m_Shards.begin(); iter != m_Shards.end(); ++iter)
+		(*iter)->workerThread = std::thread(&ShardedTcpReassembly::workerThreadMain, this, *iter);
+
+	PCPP_LOG_DEBUG("Started " << numOfShards << " TCP reassembly shards");
+}
+
+ShardedTcpReassembly::~ShardedTcpReassembly()
+{
+	// workers drain their queues before they exit
+	m_StopWorkers = true;
+
+	for (std::vector<Shard*>::iterator iter = m_Shards.begin(); iter != m_Shards.end(); ++iter)
+	{
+		if ((*iter)->workerThread.joinable())
+			(*iter)->workerThread.join();
+		delete *iter;
+	}
+}
+
+size_t ShardedTcpReassembly::getShardIndex(uint32_t flowKey) const
+{
+	// flow keys are hashes already, but the low bits of hash5Tuple aren't well distributed. Mix them with the murmur3 finalizer
+	flowKey ^= flowKey >> 16;
+	flowKey *= 0x85ebca6b;
+	flowKey ^= flowKey >> 13;
+	flowKey *= 0xc2b2ae35;
+	flowKey ^= flowKey >> 16;
+	return flowKey % m_Shards.size();
+}
+
+uint64_t ShardedTcpReassembly::getNumOfProcessedPackets(size_t shardIndex) const
+{
+	if (shardIndex >= m_Shards.size())
+		return 0;
+
+	return m_Shards[shardIndex]->numOfProcessedPackets.load(std::memory_order_relaxed);
+}
+
+ShardedTcpReassembly::QueueEntry* ShardedTcpReassembly::waitForWriteEntry(Shard* shard)
+{
+	QueueEntry* entry = shard->queue.getWriteEntry();
+	while (entry == NULL)
+	{
+		std::this_thread::yield();
+		entry = shard->queue.getWriteEntry();
+	}
+
+	return entry;
+}
+
+bool ShardedTcpReassembly::reassemblePacket(Packet& tcpData)
+{
+	if (!tcpData.isPacketOfType(TCP) || !(tcpData.isPacketOfType(IPv4) || tcpData.isPacketOfType(IPv6)))
+	{
+		PCPP_LOG_DEBUG("Packet isn't an IPv4/IPv6 TCP packet, ignoring it");
+		return false;
+	}
+
+	// this is the same direction-insensitive flow key TcpReassembly uses, so both sides of a connection go to the same shard
+	uint32_t flowKey = hash5Tuple(&tcpData);
+	Shard* shard = m_Shards[getShardIndex(flowKey)];
+
+	RawPacket* rawPacket = tcpData.getRawPacket();
+	QueueEntry* entry = waitForWriteEntry(shard);
+	entry->type = PacketEntry;
+	// assign() reuses the entry's buffer if it's large enough
+	entry->data.assign(rawPacket->getRawData(), rawPacket->getRawData() + rawPacket->getRawDataLen());
+	entry->frameLength = rawPacket->getFrameLength();
+	entry->timestamp = rawPacket->getPacketTimeStamp();
+	entry->linkLayerType = rawPacket->getLinkLayerType();
+	shard->queue.commitWrite();
+
+	return true;
+}
+
+bool ShardedTcpReassembly::reassemblePacket(RawPacket* tcpRawData)
+{
+	Packet parsedPacket(tcpRawData, false, UnknownProtocol, OsiModelTransportLayer);
+	return reassemblePacket(parsedPacket);
+}
+
+void ShardedTcpReassembly::closeConnection(uint32_t flowKey)
+{
+	Shard* shard = m_Shards[getShardIndex(flowKey)];
+	QueueEntry* entry = waitForWriteEntry(shard);
+	entry->type = CloseConnectionEntry;
+	entry->flowKey = flowKey;
+	shard->queue.commitWrite();
+}
+
+void ShardedTcpReassembly::closeAllConnections()
+{
+	for (std::vector<Shard*>::iterator iter = m_Shards.begin(); iter != m_Shards.end(); ++iter)
+	{
+		QueueEntry* entry = waitForWriteEntry(*iter);
+		entry->type = CloseAllConnectionsEntry;
+		(*iter)->queue.commitWrite();
+	}
+
+	flush();
+}
+
+void ShardedTcpReassembly::flush()
+{
+	for (std::vector<Shard*>::iterator iter = m_Shards.begin(); iter != m_Shards.end(); ++iter)
+	{
+		uint64_t writeCount = (*iter)->queue.getWriteCount();
+		while ((*iter)->queue.getReadCount() < writeCount)
+			std::this_thread::yield();
+	}
+}
+
+void ShardedTcpReassembly::workerThreadMain(Shard* shard)
+{
+	RawPacket rawPacket;
+	Packet packet;
+	int idlePolls = 0;
+
+	while (true)
+	{
+		QueueEntry* entry = shard->queue.getReadEntry();
+		if (entry == NULL)
+		{
+			// the stop flag is checked only when the queue is empty, so everything queued before the d'tor was called is processed
+			if (m_StopWorkers.load(std::memory_order_acquire) && shard->queue.getReadEntry() == NULL)
+				break;
+
+			if (idlePolls < WORKER_SPIN_COUNT)
+			{
+				idlePolls++;
+				std::this_thread::yield();
+			}
+			else
+				std::this_thread::sleep_for(std::chrono::microseconds(WORKER_IDLE_SLEEP_USEC));
+
+			continue;
+		}
+
+		idlePolls = 0;
+
+		switch (entry->type)
+		{
+		case PacketEntry:
+		{
+			// the raw packet only points to the entry's buffer, which is released (but not freed) right after the packet is processed
+			rawPacket.setRawData(entry->data.data(), (int)entry->data.size(), entry->timestamp, entry->linkLayerType, entry->frameLength, false);
+			packet.setRawPacket(&rawPacket, false);
+			shard->tcpReassembly.reassemblePacket(packet);
+			shard->numOfProcessedPackets.fetch_add(1, std::memory_order_relaxed);
+			break;
+		}
+		case CloseConnectionEntry:
+			shard->tcpReassembly.closeConnection(entry->flowKey);
+			break;
+		case CloseAllConnectionsEntry:
+			shard->tcpReassembly.closeAllConnections();
+			break;
+		}
+
+		shard->queue.commitRead();
+	}
+}
+
+}
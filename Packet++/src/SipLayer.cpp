@@ -56,12 +56,7 @@ const std::unordered_map<std::string, SipRequestLayer::SipMethod> SipMethodStrin
 
 int SipLayer::getContentLength() const
 {
-	std::string contentLengthFieldName(PCPP_SIP_CONTENT_LENGTH_FIELD);
-	std::transform(contentLengthFieldName.begin(), contentLengthFieldName.end(), contentLengthFieldName.begin(), ::tolower);
-	HeaderField* contentLengthField = getFieldByName(contentLengthFieldName);
-	if (contentLengthField != nullptr)
-		return atoi(contentLengthField->getFieldValue().c_str());
-	return 0;
+	return atoi(getFieldValueByName(PCPP_SIP_CONTENT_LENGTH_FIELD).c_str());
 }
 
 HeaderField* SipLayer::setContentLength(int contentLength, const std::string &prevFieldName)
@@ -88,6 +88,22 @@ uint16_t TcpLayer::getDstPort() const
 	return be16toh(getTcpHeader()->portDst);
 }
 
+void TcpLayer::setSrcPort(uint16_t port)
+{
+	uint16_t oldPort = getTcpHeader()->portSrc;
+	uint16_t newPort = htobe16(port);
+	getTcpHeader()->portSrc = newPort;
+	updateTransportChecksum(this, (uint8_t*)&oldPort, (uint8_t*)&newPort, sizeof(uint16_t));
+}
+
+void TcpLayer::setDstPort(uint16_t port)
+{
+	uint16_t oldPort = getTcpHeader()->portDst;
+	uint16_t newPort = htobe16(port);
+	getTcpHeader()->portDst = newPort;
+	updateTransportChecksum(this, (uint8_t*)&oldPort, (uint8_t*)&newPort, sizeof(uint16_t));
+}
+
 TcpOption TcpLayer::getTcpOption(TcpOptionType option) const
 {
 	return m_OptionReader.getTLVRecord((uint8_t)option, getOptionsBasePtr(), getHeaderLen() - sizeof(tcphdr));
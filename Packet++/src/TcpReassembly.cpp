@@ -7,6 +7,7 @@
 #include "Logger.h"
 #include <sstream>
 #include <vector>
+#include <algorithm>
 #include "EndianPortable.h"
 #include "TimespecTimeval.h"
 #ifdef _MSC_VER
@@ -15,6 +16,16 @@
 
 #define PURGE_FREQ_SECS 1
 
+// the number of one-second slots in the cleanup wheel. Must be a power of 2
+#define CLEANUP_WHEEL_SIZE 64
+
+// the initial number of slots in the connection table. Must be a power of 2
+#define CONNECTION_LIST_INITIAL_SIZE 64
+
+// out-of-order memory pool blocks are 64 bytes, 128 bytes, ... up to 64KB. Larger blocks are allocated directly from the heap
+#define OOO_POOL_MIN_BLOCK_SIZE_BITS 6
+#define OOO_POOL_SLAB_SIZE 65536
+
 #define SEQ_LT(a,b)  ((int32_t)((a)-(b)) < 0)
 #define SEQ_LEQ(a,b) ((int32_t)((a)-(b)) <= 0)
 #define SEQ_GT(a,b)  ((int32_t)((a)-(b)) > 0)
@@ -41,8 +52,12 @@ TcpReassembly::TcpReassembly(OnTcpMessageReady onMessageReadyCallback, void* use
 	m_RemoveConnInfo = config.removeConnInfo;
 	m_MaxNumToClean = (config.removeConnInfo == true && config.maxNumToClean == 0) ? 30 : config.maxNumToClean;
 	m_MaxOutOfOrderFragments = config.maxOutOfOrderFragments;
+	m_MaxOutOfOrderMemory = config.maxOutOfOrderMemory;
 	m_PurgeTimepoint = time(nullptr) + PURGE_FREQ_SECS;
 	m_EnableBaseBufferClearCondition = config.enableBaseBufferClearCondition;
+	m_CleanupList.resize(CLEANUP_WHEEL_SIZE);
+	m_CleanupListTime = time(nullptr);
+	m_CleanupListSize = 0;
 }
 
 
@@ -116,14 +131,14 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 	// time stamp for this packet
 	timeval currTime = timespecToTimeval(tcpData.getRawPacket()->getPacketTimeStamp());
 
-	// find the connection in the connection map
-	ConnectionList::iterator iter = m_ConnectionList.find(flowKey);
+	// find the connection in the connection table
+	tcpReassemblyData = m_ConnectionList.find(flowKey);
 
-	if (iter == m_ConnectionList.end())
+	if (tcpReassemblyData == nullptr)
 	{
 		// if it's a packet of a new connection, create a TcpReassemblyData object and add it to the active connection list
-		std::pair<ConnectionList::iterator, bool> pair = m_ConnectionList.insert(std::make_pair(flowKey, TcpReassemblyData()));
-		tcpReassemblyData = &pair.first->second;
+		tcpReassemblyData = new TcpReassemblyData(&m_OutOfOrderMemoryPool);
+		m_ConnectionList.insert(flowKey, tcpReassemblyData);
 		tcpReassemblyData->connData.srcIP = srcIP;
 		tcpReassemblyData->connData.dstIP = dstIP;
 		tcpReassemblyData->connData.srcPort = tcpLayer->getSrcPort();
@@ -140,14 +155,12 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 	else // connection already exists
 	{
 		// if this packet belongs to a connection that was already closed (for example: data packet that comes after FIN), ignore it.
-		if (iter->second.closed)
+		if (tcpReassemblyData->closed)
 		{
 			PCPP_LOG_DEBUG("Ignoring packet of already closed flow [0x" << std::hex << flowKey << "]");
 			return Ignore_PacketOfClosedFlow;
 		}
 
-		tcpReassemblyData = &iter->second;
-
 		if (currTime.tv_sec > tcpReassemblyData->connData.endTime.tv_sec)
 		{
 			tcpReassemblyData->connData.setEndTime(currTime);
@@ -408,21 +421,21 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 			return status;
 		}
 
-		// create a new TcpFragment, copy the TCP data to it and add this packet to the the out-of-order packet list
-		TcpFragment* newTcpFrag = new TcpFragment();
-		newTcpFrag->data = new uint8_t[tcpPayloadSize];
-		newTcpFrag->dataLength = tcpPayloadSize;
-		newTcpFrag->sequence = sequence;
-		newTcpFrag->timestamp = timestampOfTheReceivedPacket;
-		memcpy(newTcpFrag->data, tcpLayer->getLayerPayload(), tcpPayloadSize);
-		tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.pushBack(newTcpFrag);
+		// copy the TCP data to a new fragment and add it to the out-of-order fragment list
+		addOutOfOrderFragment(tcpReassemblyData->twoSides[sideIndex], sequence, tcpLayer->getLayerPayload(), tcpPayloadSize, timestampOfTheReceivedPacket);
 
 		PCPP_LOG_DEBUG("Found out-of-order packet and added a new TCP fragment with size " << tcpPayloadSize << " to the out-of-order list of side " << sideIndex);
 		status = OutOfOrderTcpMessageBuffered;
 
+		// check if we've used too much memory for out-of-order fragments; if so, consider missing packets of the connections holding
+		// the most out-of-order data lost and send their buffered fragments
+		if (m_MaxOutOfOrderMemory > 0 && m_OutOfOrderMemoryPool.getUsedBytes() > m_MaxOutOfOrderMemory)
+		{
+			enforceOutOfOrderMemoryLimit();
+		}
 		// check if we've stored too many out-of-order fragments; if so, consider missing packets lost and
 		// continue processing until the number of stored fragments is lower than the acceptable limit again
-		if (m_MaxOutOfOrderFragments > 0 && tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.size() > m_MaxOutOfOrderFragments)
+		else if (m_MaxOutOfOrderFragments > 0 && tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.size() > m_MaxOutOfOrderFragments)
 		{
 			checkOutOfOrderFragments(tcpReassemblyData, sideIndex, false);
 		}
@@ -478,178 +491,180 @@ void TcpReassembly::handleFinOrRst(TcpReassemblyData* tcpReassemblyData, int8_t
 
 void TcpReassembly::checkOutOfOrderFragments(TcpReassemblyData* tcpReassemblyData, int8_t sideIndex, bool cleanWholeFragList)
 {
-	bool foundSomething = false;
+	TcpOneSideData& sideData = tcpReassemblyData->twoSides[sideIndex];
 
-	do
+	while (!sideData.tcpFragmentList.empty())
 	{
-		PCPP_LOG_DEBUG("Starting first iteration of checkOutOfOrderFragments - looking for fragments that match the current sequence or have smaller sequence");
+		// the fragment list is ordered by sequence. Taking sequence wrap-around into account, the fragment with the lowest sequence relative to the current
+		// sequence is the first one whose sequence is at least half the sequence space below the current sequence
+		TcpFragmentList::iterator fragIter = sideData.tcpFragmentList.lower_bound(sideData.sequence - 0x80000000);
+		if (fragIter == sideData.tcpFragmentList.end())
+			fragIter = sideData.tcpFragmentList.begin();
 
-		int index = 0;
-		foundSomething = false;
+		uint32_t fragSequence = fragIter->first;
+		TcpFragment& curTcpFrag = fragIter->second;
 
-		do
+		// if fragment sequence matches the current sequence
+		if (fragSequence == sideData.sequence)
 		{
-			index = 0;
-			foundSomething = false;
-
-			// first fragment list iteration - go over the whole fragment list and see if can find fragments that match the current sequence
-			// or have smaller sequence but have big enough payload to get new data
-			while (index < (int)tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.size())
+			// update sequence
+			sideData.sequence += curTcpFrag.dataLength;
+			if (curTcpFrag.data != nullptr)
 			{
-				TcpFragment* curTcpFrag = tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.at(index);
+				PCPP_LOG_DEBUG("Found an out-of-order packet matching to the current sequence with size " << curTcpFrag.dataLength << " on side " << sideIndex << ". Pulling it out of the list and sending the data to the callback");
 
-				// if fragment sequence matches the current sequence
-				if (curTcpFrag->sequence == tcpReassemblyData->twoSides[sideIndex].sequence)
+				// send new data to callback
+				if (m_OnMessageReadyCallback != nullptr)
 				{
-					// update sequence
-					tcpReassemblyData->twoSides[sideIndex].sequence += curTcpFrag->dataLength;
-					if (curTcpFrag->data != nullptr)
-					{
-						PCPP_LOG_DEBUG("Found an out-of-order packet matching to the current sequence with size " << curTcpFrag->dataLength << " on side " << sideIndex << ". Pulling it out of the list and sending the data to the callback");
-
-						// send new data to callback
+					TcpStreamData streamData(curTcpFrag.data, curTcpFrag.dataLength, 0, tcpReassemblyData->connData, curTcpFrag.timestamp);
+					m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
+				}
+			}
 
-						if (m_OnMessageReadyCallback != nullptr)
-						{
-							TcpStreamData streamData(curTcpFrag->data, curTcpFrag->dataLength, 0, tcpReassemblyData->connData, curTcpFrag->timestamp);
-							m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
-						}
-					}
+			// remove fragment from list
+			removeOutOfOrderFragment(sideData, fragIter);
+			continue;
+		}
 
+		// if fragment sequence has lower sequence than the current sequence
+		if (SEQ_LT(fragSequence, sideData.sequence))
+		{
+			// check if it still has new data
+			uint32_t newSequence = fragSequence + curTcpFrag.dataLength;
 
-					// remove fragment from list
-					tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.erase(tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.begin() + index);
+			// it has new data
+			if (SEQ_GT(newSequence, sideData.sequence))
+			{
+				// calculate the delta new data size
+				uint32_t newLength = sideData.sequence - fragSequence;
 
-					foundSomething = true;
+				PCPP_LOG_DEBUG("Found a fragment in the out-of-order list which its sequence is lower than expected but its payload is long enough to contain new data. "
+					"Calling the callback with the new data. Fragment size is " << curTcpFrag.dataLength << " on side " << sideIndex << ", new data size is " << (int)(curTcpFrag.dataLength - newLength));
 
-					continue;
-				}
+				// update current sequence with the delta new data size
+				sideData.sequence += curTcpFrag.dataLength - newLength;
 
-				// if fragment sequence has lower sequence than the current sequence
-				if (SEQ_LT(curTcpFrag->sequence, tcpReassemblyData->twoSides[sideIndex].sequence))
+				// send only the new data to the callback
+				if (m_OnMessageReadyCallback != nullptr)
 				{
-					// check if it still has new data
-					uint32_t newSequence = curTcpFrag->sequence + curTcpFrag->dataLength;
-
-					// it has new data
-					if (SEQ_GT(newSequence, tcpReassemblyData->twoSides[sideIndex].sequence))
-					{
-						// calculate the delta new data size
-						uint32_t newLength = tcpReassemblyData->twoSides[sideIndex].sequence - curTcpFrag->sequence;
-
-						PCPP_LOG_DEBUG("Found a fragment in the out-of-order list which its sequence is lower than expected but its payload is long enough to contain new data. "
-							"Calling the callback with the new data. Fragment size is " << curTcpFrag->dataLength << " on side " << sideIndex << ", new data size is " << (int)(curTcpFrag->dataLength - newLength));
-
-						// update current sequence with the delta new data size
-						tcpReassemblyData->twoSides[sideIndex].sequence += curTcpFrag->dataLength - newLength;
-
-						// send only the new data to the callback
-						if (m_OnMessageReadyCallback != nullptr)
-						{
-							TcpStreamData streamData(curTcpFrag->data + newLength, curTcpFrag->dataLength - newLength, 0, tcpReassemblyData->connData, curTcpFrag->timestamp);
-							m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
-						}
-
-						foundSomething = true;
-					}
-					else
-					{
-						PCPP_LOG_DEBUG("Found a fragment in the out-of-order list which doesn't contain any new data, ignoring it. Fragment size is " << curTcpFrag->dataLength << " on side " << sideIndex);
-					}
-
-					// delete fragment from list
-					tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.erase(tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.begin() + index);
-
-					continue;
+					TcpStreamData streamData(curTcpFrag.data + newLength, curTcpFrag.dataLength - newLength, 0, tcpReassemblyData->connData, curTcpFrag.timestamp);
+					m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
 				}
-
-				//if got to here it means the fragment has higher sequence than current sequence, increment index and continue
-				index++;
+			}
+			else
+			{
+				PCPP_LOG_DEBUG("Found a fragment in the out-of-order list which doesn't contain any new data, ignoring it. Fragment size is " << curTcpFrag.dataLength << " on side " << sideIndex);
 			}
 
-			// if managed to find new segment, do the search all over again
-		} while (foundSomething);
-
+			// delete fragment from list
+			removeOutOfOrderFragment(sideData, fragIter);
+			continue;
+		}
 
 		// if got here it means we're left only with fragments that have higher sequence than current sequence. This means out-of-order packets or
 		// missing data. If we don't want to clear the frag list yet and the number of out of order fragments isn't above the configured limit,
 		// assume it's out-of-order and return
-		if (!cleanWholeFragList && (m_MaxOutOfOrderFragments == 0 || tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.size() <= m_MaxOutOfOrderFragments))
+		if (!cleanWholeFragList && (m_MaxOutOfOrderFragments == 0 || sideData.tcpFragmentList.size() <= m_MaxOutOfOrderFragments))
 		{
 			return;
 		}
 
-		PCPP_LOG_DEBUG("Starting second  iteration of checkOutOfOrderFragments - handle missing data");
+		// this is missing data. The current fragment is the one with the closest sequence to the current one
 
-		// second fragment list iteration - now we're left only with fragments that have higher sequence than current sequence. This means missing data.
-		// Search for the fragment with the closest sequence to the current one
+		// calculate number of missing bytes
+		uint32_t missingDataLen = fragSequence - sideData.sequence;
 
-		uint32_t closestSequence = 0xffffffff;
-		bool closestSequenceDefined = false;
-		int closestSequenceFragIndex = -1;
-		index = 0;
-
-		while (index < (int)tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.size())
+		// update sequence
+		sideData.sequence = fragSequence + curTcpFrag.dataLength;
+		if (curTcpFrag.data != nullptr)
 		{
-			// extract segment at current index
-			TcpFragment* curTcpFrag = tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.at(index);
-
-			// check if its sequence is closer than current closest sequence
-			if (!closestSequenceDefined || SEQ_LT(curTcpFrag->sequence, closestSequence))
+			// send new data to callback
+			if (m_OnMessageReadyCallback != nullptr)
 			{
-				closestSequence = curTcpFrag->sequence;
-				closestSequenceFragIndex = index;
-				closestSequenceDefined = true;
-			}
+				// prepare missing data text
+				std::string missingDataTextStr = prepareMissingDataMessage(missingDataLen);
 
-			index++;
-		}
+				// add missing data text to the data that will be sent to the callback. This means that the data will look something like:
+				// "[xx bytes missing]<original_data>"
+				std::vector<uint8_t> dataWithMissingDataText;
+				dataWithMissingDataText.reserve(missingDataTextStr.length() + curTcpFrag.dataLength);
+				dataWithMissingDataText.insert(dataWithMissingDataText.end(), missingDataTextStr.begin(), missingDataTextStr.end());
+				dataWithMissingDataText.insert(dataWithMissingDataText.end(), curTcpFrag.data, curTcpFrag.data + curTcpFrag.dataLength);
 
-		// this means fragment list is not empty at this stage
-		if (closestSequenceFragIndex > -1)
-		{
-			// get the fragment with the closest sequence
-			TcpFragment* curTcpFrag = tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.at(closestSequenceFragIndex);
+				TcpStreamData streamData(&dataWithMissingDataText[0], dataWithMissingDataText.size(), missingDataLen, tcpReassemblyData->connData, curTcpFrag.timestamp);
+				m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
 
-			// calculate number of missing bytes
-			uint32_t missingDataLen = curTcpFrag->sequence - tcpReassemblyData->twoSides[sideIndex].sequence;
+				PCPP_LOG_DEBUG("Found missing data on side " << sideIndex << ": " << missingDataLen << " byte are missing. Sending the closest fragment which is in size " << curTcpFrag.dataLength << " + missing text message which size is " << missingDataTextStr.length());
+			}
+		}
 
-			// update sequence
-			tcpReassemblyData->twoSides[sideIndex].sequence = curTcpFrag->sequence + curTcpFrag->dataLength;
-			if (curTcpFrag->data != nullptr)
-			{
-				// send new data to callback
-				if (m_OnMessageReadyCallback != nullptr)
-				{
-					// prepare missing data text
-					std::string missingDataTextStr = prepareMissingDataMessage(missingDataLen);
-
-					// add missing data text to the data that will be sent to the callback. This means that the data will look something like:
-					// "[xx bytes missing]<original_data>"
-					std::vector<uint8_t> dataWithMissingDataText;
-					dataWithMissingDataText.reserve(missingDataTextStr.length() + curTcpFrag->dataLength);
-					dataWithMissingDataText.insert(dataWithMissingDataText.end(), missingDataTextStr.begin(), missingDataTextStr.end());
-					dataWithMissingDataText.insert(dataWithMissingDataText.end(), curTcpFrag->data, curTcpFrag->data + curTcpFrag->dataLength);
-
-					//TcpStreamData streamData(curTcpFrag->data, curTcpFrag->dataLength, tcpReassemblyData->connData);
-					TcpStreamData streamData(&dataWithMissingDataText[0], dataWithMissingDataText.size(), missingDataLen, tcpReassemblyData->connData, curTcpFrag->timestamp);
-					m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
+		// remove fragment from list
+		removeOutOfOrderFragment(sideData, fragIter);
+	}
+}
 
-					PCPP_LOG_DEBUG("Found missing data on side " << sideIndex << ": " << missingDataLen << " byte are missing. Sending the closest fragment which is in size " << curTcpFrag->dataLength << " + missing text message which size is " << missingDataTextStr.length());
-				}
-			}
+void TcpReassembly::addOutOfOrderFragment(TcpOneSideData& sideData, uint32_t sequence, const uint8_t* data, size_t dataLength, const timeval& timestamp)
+{
+	TcpFragment newTcpFrag;
+	newTcpFrag.data = static_cast<uint8_t*>(m_OutOfOrderMemoryPool.allocate(dataLength));
+	newTcpFrag.dataLength = dataLength;
+	newTcpFrag.timestamp = timestamp;
+	memcpy(newTcpFrag.data, data, dataLength);
+
+	// fragments with the same sequence are kept in arrival order
+	sideData.tcpFragmentList.insert(sideData.tcpFragmentList.upper_bound(sequence), std::make_pair(sequence, newTcpFrag));
+	sideData.outOfOrderDataSize += dataLength;
+}
 
-			// remove fragment from list
-			tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.erase(tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.begin() + closestSequenceFragIndex);
+void TcpReassembly::removeOutOfOrderFragment(TcpOneSideData& sideData, TcpFragmentList::iterator fragment)
+{
+	sideData.outOfOrderDataSize -= fragment->second.dataLength;
+	m_OutOfOrderMemoryPool.deallocate(fragment->second.data, fragment->second.dataLength);
+	sideData.tcpFragmentList.erase(fragment);
+}
+
+void TcpReassembly::enforceOutOfOrderMemoryLimit()
+{
+	// memory is released down to 3/4 of the limit, so the connections aren't scanned again for every out-of-order fragment that follows
+	size_t targetMemoryUsage = m_MaxOutOfOrderMemory - m_MaxOutOfOrderMemory / 4;
 
-			PCPP_LOG_DEBUG("Calling checkOutOfOrderFragments again from the start");
+	std::vector<std::pair<size_t, std::pair<TcpReassemblyData*, int8_t> > > sidesWithOutOfOrderData;
+	for (size_t slotIndex = 0; slotIndex < m_ConnectionList.getNumOfSlots(); ++slotIndex)
+	{
+		TcpReassemblyData* tcpReassemblyData = m_ConnectionList.getSlotData(slotIndex);
+		if (tcpReassemblyData == nullptr)
+			continue;
 
-			// call the method again from the start to do the whole search again (both iterations).
-			// the stop condition is when the list is empty (so closestSequenceFragIndex == -1)
-			foundSomething = true;
+		for (int8_t sideIndex = 0; sideIndex < 2; ++sideIndex)
+		{
+			size_t outOfOrderDataSize = tcpReassemblyData->twoSides[sideIndex].outOfOrderDataSize;
+			if (outOfOrderDataSize > 0)
+				sidesWithOutOfOrderData.push_back(std::make_pair(outOfOrderDataSize, std::make_pair(tcpReassemblyData, sideIndex)));
 		}
+	}
+
+	// the sides holding the most out-of-order data are flushed first
+	std::sort(sidesWithOutOfOrderData.begin(), sidesWithOutOfOrderData.end(),
+		[](const std::pair<size_t, std::pair<TcpReassemblyData*, int8_t> >& first, const std::pair<size_t, std::pair<TcpReassemblyData*, int8_t> >& second)
+		{ return first.first > second.first; });
 
-	} while (foundSomething);
+	for (size_t i = 0; i < sidesWithOutOfOrderData.size() && m_OutOfOrderMemoryPool.getUsedBytes() > targetMemoryUsage; ++i)
+	{
+		TcpReassemblyData* tcpReassemblyData = sidesWithOutOfOrderData[i].second.first;
+		int8_t sideIndex = sidesWithOutOfOrderData[i].second.second;
+		PCPP_LOG_DEBUG("Out-of-order memory limit exceeded, considering missing data on side " << (int)sideIndex << " of connection with flow key 0x"
+			<< std::hex << tcpReassemblyData->connData.flowKey << " lost");
+		checkOutOfOrderFragments(tcpReassemblyData, sideIndex, true);
+	}
+}
+
+size_t TcpReassembly::getConnectionOutOfOrderDataSize(uint32_t flowKey) const
+{
+	const TcpReassemblyData* tcpReassemblyData = m_ConnectionList.find(flowKey);
+	if (tcpReassemblyData == nullptr)
+		return 0;
+
+	return tcpReassemblyData->twoSides[0].outOfOrderDataSize + tcpReassemblyData->twoSides[1].outOfOrderDataSize;
 }
 
 void TcpReassembly::closeConnection(uint32_t flowKey)
@@ -659,14 +674,14 @@ void TcpReassembly::closeConnection(uint32_t flowKey)
 
 void TcpReassembly::closeConnectionInternal(uint32_t flowKey, ConnectionEndReason reason)
 {
-	ConnectionList::iterator iter = m_ConnectionList.find(flowKey);
-	if (iter == m_ConnectionList.end())
+	TcpReassemblyData* tcpReassemblyDataPtr = m_ConnectionList.find(flowKey);
+	if (tcpReassemblyDataPtr == nullptr)
 	{
 		PCPP_LOG_ERROR("Cannot close flow with key 0x" << std::uppercase << std::hex << flowKey << ": cannot find flow");
 		return;
 	}
 
-	TcpReassemblyData& tcpReassemblyData = iter->second;
+	TcpReassemblyData& tcpReassemblyData = *tcpReassemblyDataPtr;
 
 	if (tcpReassemblyData.closed) // the connection is already closed
 		return;
@@ -692,14 +707,15 @@ void TcpReassembly::closeAllConnections()
 {
 	PCPP_LOG_DEBUG("Closing all flows");
 
-	ConnectionList::iterator iter = m_ConnectionList.begin(), iterEnd = m_ConnectionList.end();
-	for (; iter != iterEnd; ++iter)
+	for (size_t slotIndex = 0; slotIndex < m_ConnectionList.getNumOfSlots(); ++slotIndex)
 	{
-		TcpReassemblyData& tcpReassemblyData = iter->second;
+		TcpReassemblyData* tcpReassemblyDataPtr = m_ConnectionList.getSlotData(slotIndex);
 
-		if (tcpReassemblyData.closed) // the connection is already closed, skip it
+		if (tcpReassemblyDataPtr == nullptr || tcpReassemblyDataPtr->closed) // empty slot or the connection is already closed, skip it
 			continue;
 
+		TcpReassemblyData& tcpReassemblyData = *tcpReassemblyDataPtr;
+
 		uint32_t flowKey = tcpReassemblyData.connData.flowKey;
 		PCPP_LOG_DEBUG("Closing connection with flow key 0x" << std::hex << flowKey);
 
@@ -721,23 +737,24 @@ void TcpReassembly::closeAllConnections()
 
 int TcpReassembly::isConnectionOpen(const ConnectionData& connection) const
 {
-	ConnectionList::const_iterator iter = m_ConnectionList.find(connection.flowKey);
-	if (iter != m_ConnectionList.end())
-		return iter->second.closed == false;
+	const TcpReassemblyData* tcpReassemblyData = m_ConnectionList.find(connection.flowKey);
+	if (tcpReassemblyData != nullptr)
+		return tcpReassemblyData->closed == false;
 
 	return -1;
 }
 
 void TcpReassembly::insertIntoCleanupList(uint32_t flowKey)
 {
-	// m_CleanupList is a map with key of type time_t (expiration time). The mapped type is a list that stores the flow keys to be cleared in certain point of time.
-	// m_CleanupList.insert inserts an empty list if the container does not already contain an element with an equivalent key,
-	// otherwise this method returns an iterator to the element that prevents insertion.
-	std::pair<CleanupList::iterator, bool> pair = m_CleanupList.insert(std::make_pair(time(nullptr) + m_ClosedConnectionDelay, CleanupList::mapped_type()));
-
-	// getting the reference to list
-	CleanupList::mapped_type& keysList = pair.first->second;
-	keysList.push_front(flowKey);
+	// m_CleanupList is a timing wheel with a slot per second. The entry is stored in the slot of its expiration time, but never in a slot
+	// that was already scanned (which may happen if the system clock goes backwards)
+	time_t expiration = time(nullptr) + m_ClosedConnectionDelay;
+	if (expiration < m_CleanupListTime)
+		expiration = m_CleanupListTime;
+
+	CleanupEntry entry = { expiration, flowKey };
+	m_CleanupList[expiration & (CLEANUP_WHEEL_SIZE - 1)].push_back(entry);
+	m_CleanupListSize++;
 }
 
 uint32_t TcpReassembly::purgeClosedConnections(uint32_t maxNumToClean)
@@ -747,26 +764,315 @@ uint32_t TcpReassembly::purgeClosedConnections(uint32_t maxNumToClean)
 	if (maxNumToClean == 0)
 		maxNumToClean = m_MaxNumToClean;
 
-	CleanupList::iterator iterTime = m_CleanupList.begin(), iterTimeEnd = m_CleanupList.upper_bound(time(nullptr));
-	while (iterTime != iterTimeEnd && count < maxNumToClean)
+	time_t currTime = time(nullptr);
+	if (m_CleanupListSize == 0)
 	{
-		CleanupList::mapped_type& keysList = iterTime->second;
+		if (currTime >= m_CleanupListTime)
+			m_CleanupListTime = currTime + 1;
+		return 0;
+	}
+
+	// scan the slots of all seconds that passed since the last scan. If more than a full rotation passed, each slot is scanned once
+	time_t slotTime = m_CleanupListTime;
+	if (currTime - slotTime >= CLEANUP_WHEEL_SIZE)
+		slotTime = currTime - CLEANUP_WHEEL_SIZE + 1;
 
-		for (; !keysList.empty() && count < maxNumToClean; ++count)
+	for (; slotTime <= currTime; ++slotTime)
+	{
+		if (count >= maxNumToClean)
 		{
-			CleanupList::mapped_type::const_reference key = keysList.front();
+			// continue from this slot in the next call
+			m_CleanupListTime = slotTime;
+			return count;
+		}
+
+		// a slot may also contain entries that expire in a later rotation of the wheel, these are kept
+		std::vector<CleanupEntry>& slot = m_CleanupList[slotTime & (CLEANUP_WHEEL_SIZE - 1)];
+		size_t entryIndex = 0;
+		while (entryIndex < slot.size() && count < maxNumToClean)
+		{
+			if (slot[entryIndex].expiration > currTime)
+			{
+				++entryIndex;
+				continue;
+			}
+
+			uint32_t key = slot[entryIndex].flowKey;
 			m_ConnectionInfo.erase(key);
 			m_ConnectionList.erase(key);
-			keysList.pop_front();
+
+			slot[entryIndex] = slot.back();
+			slot.pop_back();
+			m_CleanupListSize--;
+			++count;
 		}
 
-		if (keysList.empty())
-			m_CleanupList.erase(iterTime++);
-		else
-			++iterTime;
+		if (count >= maxNumToClean && entryIndex < slot.size())
+		{
+			m_CleanupListTime = slotTime;
+			return count;
+		}
 	}
 
+	m_CleanupListTime = currTime + 1;
 	return count;
 }
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TcpReassembly::ConnectionList members
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TcpReassembly::ConnectionList::ConnectionList() : m_Slots(CONNECTION_LIST_INITIAL_SIZE), m_Size(0)
+{
+}
+
+TcpReassembly::ConnectionList::~ConnectionList()
+{
+	for (std::vector<Slot>::iterator iter = m_Slots.begin(); iter != m_Slots.end(); ++iter)
+		delete iter->data;
+}
+
+size_t TcpReassembly::ConnectionList::getIdealSlot(uint32_t flowKey) const
+{
+	// flow keys are hashes already, but the low bits of hash5Tuple aren't well distributed. Mix them with the murmur3 finalizer
+	flowKey ^= flowKey >> 16;
+	flowKey *= 0x85ebca6b;
+	flowKey ^= flowKey >> 13;
+	flowKey *= 0xc2b2ae35;
+	flowKey ^= flowKey >> 16;
+	return flowKey & (m_Slots.size() - 1);
+}
+
+TcpReassembly::TcpReassemblyData* TcpReassembly::ConnectionList::find(uint32_t flowKey) const
+{
+	size_t mask = m_Slots.size() - 1;
+	for (size_t index = getIdealSlot(flowKey); m_Slots[index].data != nullptr; index = (index + 1) & mask)
+	{
+		if (m_Slots[index].flowKey == flowKey)
+			return m_Slots[index].data;
+	}
+
+	return nullptr;
+}
+
+void TcpReassembly::ConnectionList::insert(uint32_t flowKey, TcpReassemblyData* tcpReassemblyData)
+{
+	// keep the load factor under 3/4 so probe sequences stay short
+	if ((m_Size + 1) * 4 > m_Slots.size() * 3)
+		grow();
+
+	size_t mask = m_Slots.size() - 1;
+	size_t index = getIdealSlot(flowKey);
+	while (m_Slots[index].data != nullptr)
+		index = (index + 1) & mask;
+
+	m_Slots[index].flowKey = flowKey;
+	m_Slots[index].data = tcpReassemblyData;
+	m_Size++;
+}
+
+void TcpReassembly::ConnectionList::erase(uint32_t flowKey)
+{
+	size_t mask = m_Slots.size() - 1;
+	size_t index = getIdealSlot(flowKey);
+	while (m_Slots[index].data != nullptr && m_Slots[index].flowKey != flowKey)
+		index = (index + 1) & mask;
+
+	if (m_Slots[index].data == nullptr)
+		return;
+
+	delete m_Slots[index].data;
+	m_Size--;
+
+	// shift back the following entries of the probe sequence so no tombstones are needed
+	size_t nextIndex = (index + 1) & mask;
+	while (m_Slots[nextIndex].data != nullptr)
+	{
+		size_t idealIndex = getIdealSlot(m_Slots[nextIndex].flowKey);
+		// the entry can move to the freed slot only if the freed slot isn't cyclically between the entry's ideal slot and its current slot
+		if (((nextIndex - idealIndex) & mask) >= ((nextIndex - index) & mask))
+		{
+			m_Slots[index] = m_Slots[nextIndex];
+			index = nextIndex;
+		}
+		nextIndex = (nextIndex + 1) & mask;
+	}
+
+	m_Slots[index] = Slot();
+}
+
+void TcpReassembly::ConnectionList::grow()
+{
+	std::vector<Slot> oldSlots(m_Slots.size() * 2);
+	oldSlots.swap(m_Slots);
+
+	size_t mask = m_Slots.size() - 1;
+	for (std::vector<Slot>::const_iterator iter = oldSlots.begin(); iter != oldSlots.end(); ++iter)
+	{
+		if (iter->data == nullptr)
+			continue;
+
+		size_t index = getIdealSlot(iter->flowKey);
+		while (m_Slots[index].data != nullptr)
+			index = (index + 1) & mask;
+
+		m_Slots[index] = *iter;
+	}
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TcpReassembly::OutOfOrderMemoryPool members
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TcpReassembly::OutOfOrderMemoryPool::OutOfOrderMemoryPool() : m_UsedBytes(0), m_AllocatedBytes(0)
+{
+	for (int i = 0; i < NumOfSizeClasses; i++)
+		m_SlabsWithFreeBlocks[i] = nullptr;
+}
+
+TcpReassembly::OutOfOrderMemoryPool::~OutOfOrderMemoryPool()
+{
+	for (std::map<const uint8_t*, Slab*>::iterator iter = m_Slabs.begin(); iter != m_Slabs.end(); ++iter)
+	{
+		delete [] iter->second->memory;
+		delete iter->second;
+	}
+}
+
+int TcpReassembly::OutOfOrderMemoryPool::getSizeClass(size_t size)
+{
+	int sizeClass = 0;
+	size_t blockSize = 1 << OOO_POOL_MIN_BLOCK_SIZE_BITS;
+	while (blockSize < size)
+	{
+		blockSize <<= 1;
+		sizeClass++;
+	}
+
+	return sizeClass;
+}
+
+size_t TcpReassembly::OutOfOrderMemoryPool::getBlockSize(size_t size)
+{
+	int sizeClass = getSizeClass(size);
+	if (sizeClass >= NumOfSizeClasses)
+		return size;
+
+	return (size_t)1 << (sizeClass + OOO_POOL_MIN_BLOCK_SIZE_BITS);
+}
+
+void TcpReassembly::OutOfOrderMemoryPool::linkSlab(Slab* slab, int sizeClass)
+{
+	slab->prev = nullptr;
+	slab->next = m_SlabsWithFreeBlocks[sizeClass];
+	if (slab->next != nullptr)
+		slab->next->prev = slab;
+	m_SlabsWithFreeBlocks[sizeClass] = slab;
+}
+
+void TcpReassembly::OutOfOrderMemoryPool::unlinkSlab(Slab* slab, int sizeClass)
+{
+	if (slab->prev != nullptr)
+		slab->prev->next = slab->next;
+	else
+		m_SlabsWithFreeBlocks[sizeClass] = slab->next;
+
+	if (slab->next != nullptr)
+		slab->next->prev = slab->prev;
+
+	slab->prev = nullptr;
+	slab->next = nullptr;
+}
+
+void* TcpReassembly::OutOfOrderMemoryPool::allocate(size_t size)
+{
+	int sizeClass = getSizeClass(size);
+	if (sizeClass >= NumOfSizeClasses)
+	{
+		m_UsedBytes += size;
+		m_AllocatedBytes += size;
+		return new uint8_t[size];
+	}
+
+	size_t blockSize = (size_t)1 << (sizeClass + OOO_POOL_MIN_BLOCK_SIZE_BITS);
+
+	// carve a new slab into blocks of this size class if there are no free blocks left
+	if (m_SlabsWithFreeBlocks[sizeClass] == nullptr)
+	{
+		Slab* newSlab = new Slab();
+		newSlab->memory = new uint8_t[OOO_POOL_SLAB_SIZE];
+		newSlab->freeList = nullptr;
+		newSlab->numOfUsedBlocks = 0;
+		for (size_t offset = OOO_POOL_SLAB_SIZE; offset >= blockSize; offset -= blockSize)
+		{
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(newSlab->memory + offset - blockSize);
+			block->next = newSlab->freeList;
+			newSlab->freeList = block;
+		}
+
+		m_Slabs[newSlab->memory] = newSlab;
+		linkSlab(newSlab, sizeClass);
+		m_AllocatedBytes += OOO_POOL_SLAB_SIZE;
+	}
+
+	Slab* slab = m_SlabsWithFreeBlocks[sizeClass];
+	FreeBlock* block = slab->freeList;
+	slab->freeList = block->next;
+	slab->numOfUsedBlocks++;
+	if (slab->freeList == nullptr)
+		unlinkSlab(slab, sizeClass);
+
+	m_UsedBytes += blockSize;
+	return block;
+}
+
+void TcpReassembly::OutOfOrderMemoryPool::deallocate(void* ptr, size_t size)
+{
+	int sizeClass = getSizeClass(size);
+	if (sizeClass >= NumOfSizeClasses)
+	{
+		m_UsedBytes -= size;
+		m_AllocatedBytes -= size;
+		delete [] static_cast<uint8_t*>(ptr);
+		return;
+	}
+
+	// the block belongs to the slab with the highest address which isn't above it
+	std::map<const uint8_t*, Slab*>::iterator slabIter = m_Slabs.upper_bound(static_cast<const uint8_t*>(ptr));
+	--slabIter;
+	Slab* slab = slabIter->second;
+
+	if (slab->freeList == nullptr)
+		linkSlab(slab, sizeClass);
+
+	FreeBlock* block = static_cast<FreeBlock*>(ptr);
+	block->next = slab->freeList;
+	slab->freeList = block;
+	slab->numOfUsedBlocks--;
+	m_UsedBytes -= (size_t)1 << (sizeClass + OOO_POOL_MIN_BLOCK_SIZE_BITS);
+
+	// return the slab to the heap once all of its blocks are free. The last slab of the size class with free blocks is kept, so a block that is
+	// allocated and freed repeatedly doesn't allocate a slab every time
+	if (slab->numOfUsedBlocks == 0 && (slab->prev != nullptr || slab->next != nullptr))
+	{
+		unlinkSlab(slab, sizeClass);
+		m_Slabs.erase(slabIter);
+		delete [] slab->memory;
+		delete slab;
+		m_AllocatedBytes -= OOO_POOL_SLAB_SIZE;
+	}
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// TcpReassembly::TcpOneSideData members
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+TcpReassembly::TcpOneSideData::~TcpOneSideData()
+{
+	// the fragment list nodes are released by the list itself, but the fragment data has to be returned to the pool explicitly
+	OutOfOrderMemoryPool* pool = tcpFragmentList.get_allocator().getPool();
+	for (TcpFragmentList::iterator iter = tcpFragmentList.begin(); iter != tcpFragmentList.end(); ++iter)
+		pool->deallocate(iter->second.data, iter->second.dataLength);
+}
+
 }
@@ -2,6 +2,7 @@
 #include "Logger.h"
 #include "PayloadLayer.h"
 #include <string.h>
+#include <ctype.h>
 #include <algorithm>
 #include <utility>
 #include <stdlib.h>
@@ -20,14 +21,27 @@ size_t tbp_my_own_strnlen(const char* s, size_t maxlen)
 	return i;
 }
 
+// a case insensitive comparison of 2 strings of the same length, strncasecmp() isn't available on all platforms
+static bool tbp_equals_ignore_case(const char* s1, const char* s2, size_t len)
+{
+	for (size_t i = 0; i < len; ++i)
+	{
+		if (tolower((unsigned char)s1[i]) != tolower((unsigned char)s2[i]))
+			return false;
+	}
+
+	return true;
+}
+
 
 // -------- Class TextBasedProtocolMessage -----------------
 
 
 TextBasedProtocolMessage::TextBasedProtocolMessage(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) : Layer(data, dataLen, prevLayer, packet),
-						m_FieldList(nullptr), m_LastField(nullptr), m_FieldsOffset(0) {}
+						m_FieldList(nullptr), m_LastField(nullptr), m_FieldsOffset(0), m_NumOfIndexedFields(0), m_FieldsMaterialized(true) {}
 
-TextBasedProtocolMessage::TextBasedProtocolMessage(const TextBasedProtocolMessage& other) : Layer(other)
+TextBasedProtocolMessage::TextBasedProtocolMessage(const TextBasedProtocolMessage& other) : Layer(other),
+						m_FieldList(nullptr), m_LastField(nullptr), m_FieldsOffset(0), m_NumOfIndexedFields(0), m_FieldsMaterialized(true)
 {
 	copyDataFrom(other);
 }
@@ -43,6 +57,13 @@ TextBasedProtocolMessage& TextBasedProtocolMessage::operator=(const TextBasedPro
 		delete temp;
 	}
 
+	m_FieldList = nullptr;
+	m_LastField = nullptr;
+	m_FieldNameToFieldMap.clear();
+	m_ExtraFieldIndex.clear();
+	m_NumOfIndexedFields = 0;
+	m_FieldsMaterialized = true;
+
 	copyDataFrom(other);
 
 	return *this;
@@ -50,6 +71,19 @@ TextBasedProtocolMessage& TextBasedProtocolMessage::operator=(const TextBasedPro
 
 void TextBasedProtocolMessage::copyDataFrom(const TextBasedProtocolMessage& other)
 {
+	m_FieldsOffset = other.m_FieldsOffset;
+
+	// if the fields of the other message weren't materialized, copying the index is enough since it holds offsets only
+	if (!other.m_FieldsMaterialized)
+	{
+		m_FieldList = nullptr;
+		m_LastField = nullptr;
+		for (int i = 0; i < other.m_NumOfIndexedFields; i++)
+			addIndexedField(other.getIndexedField(i));
+		m_FieldsMaterialized = false;
+		return;
+	}
+
 	// copy field list
 	if (other.m_FieldList != nullptr)
 	{
@@ -74,12 +108,12 @@ void TextBasedProtocolMessage::copyDataFrom(const TextBasedProtocolMessage& othe
 		m_LastField = nullptr;
 	}
 
-	m_FieldsOffset = other.m_FieldsOffset;
-
 	// copy map
 	for(HeaderField* field = m_FieldList; field != nullptr; field = field->getNextField())
 	{
-		m_FieldNameToFieldMap.insert(std::pair<std::string, HeaderField*>(field->getFieldName(), field));
+		std::string fieldName = field->getFieldName();
+		std::transform(fieldName.begin(), fieldName.end(), fieldName.begin(), ::tolower);
+		m_FieldNameToFieldMap.insert(std::pair<std::string, HeaderField*>(fieldName, field));
 	}
 }
 
@@ -89,47 +123,173 @@ void TextBasedProtocolMessage::parseFields()
 	char nameValueSeparator = getHeaderFieldNameValueSeparator();
 	bool spacesAllowedBetweenNameAndValue = spacesAllowedBetweenHeaderFieldNameAndValue();
 
-	HeaderField* firstField = new HeaderField(this, m_FieldsOffset, nameValueSeparator, spacesAllowedBetweenNameAndValue);
-	PCPP_LOG_DEBUG("Added new field: name='" << firstField->getFieldName() << "'; offset in packet=" << firstField->m_NameOffsetInMessage << "; length=" << firstField->getFieldSize());
-	PCPP_LOG_DEBUG("     Field value = " << firstField->getFieldValue());
+	m_FieldsMaterialized = false;
+	m_NumOfIndexedFields = 0;
+	m_ExtraFieldIndex.clear();
 
-	if (m_FieldList == nullptr)
-		m_FieldList = firstField;
-	else
-		m_FieldList->setNextField(firstField);
-
-	std::string fieldName = firstField->getFieldName();
-	std::transform(fieldName.begin(), fieldName.end(), fieldName.begin(), ::tolower);
-	m_FieldNameToFieldMap.insert(std::pair<std::string, HeaderField*>(fieldName, firstField));
+	FieldIndexEntry field;
+	parseFieldAt(m_FieldsOffset, nameValueSeparator, spacesAllowedBetweenNameAndValue, field);
+	addIndexedField(field);
 
 	// Last field will be empty and contain just "\n" or "\r\n". This field will mark the end of the header
-	HeaderField* curField = m_FieldList;
-	int curOffset = m_FieldsOffset;
 	// last field can be one of:
 	// a.) \r\n\r\n or \n\n marking the end of the header
 	// b.) the end of the packet
-	while (!curField->isEndOfHeader() && curOffset + curField->getFieldSize() < m_DataLen)
+	int curOffset = m_FieldsOffset;
+	while (!field.isEndOfHeader() && curOffset + field.fieldSize < m_DataLen)
 	{
-		curOffset += curField->getFieldSize();
-		HeaderField* newField = new HeaderField(this, curOffset, nameValueSeparator, spacesAllowedBetweenNameAndValue);
-		if(newField->getFieldSize() > 0)
-		{
-			PCPP_LOG_DEBUG("Added new field: name='" << newField->getFieldName() << "'; offset in packet=" << newField->m_NameOffsetInMessage << "; length=" << newField->getFieldSize());
-			PCPP_LOG_DEBUG("     Field value = " << newField->getFieldValue());
-			curField->setNextField(newField);
-			curField = newField;
-			fieldName = newField->getFieldName();
-			std::transform(fieldName.begin(), fieldName.end(), fieldName.begin(), ::tolower);
-			m_FieldNameToFieldMap.insert(std::pair<std::string, HeaderField*>(fieldName, newField));
-		}
-		else
-		{
-			delete newField;
+		curOffset += field.fieldSize;
+		parseFieldAt(curOffset, nameValueSeparator, spacesAllowedBetweenNameAndValue, field);
+		if (field.fieldSize == 0)
 			break;
-		}
+
+		addIndexedField(field);
+	}
+}
+
+void TextBasedProtocolMessage::parseFieldAt(int offset, char nameValueSeparator, bool spacesAllowedBetweenNameAndValue, FieldIndexEntry& entry) const
+{
+	const char* data = (const char*)m_Data;
+	const char* dataEnd = data + m_DataLen;
+	const char* fieldData = data + offset;
+	size_t maxFieldSize = m_DataLen - (size_t)offset;
+
+	entry.nameOffset = offset;
+	entry.nameHash = 0;
+
+	// the line end is found with memchr rather than with SSE2/AVX2 kernels like the checksum ones in PacketUtils.cpp: the C library's
+	// memchr already picks a vectorized implementation for the CPU at runtime, and the lines are short so a kernel of our own wouldn't
+	// make up for its call and dispatch overhead. Only '\n' is searched for, a preceding '\r' is part of the field and handled below
+	const char* fieldEndPtr = (const char*)memchr(fieldData, '\n', maxFieldSize);
+	if (fieldEndPtr == nullptr)
+		entry.fieldSize = tbp_my_own_strnlen(fieldData, maxFieldSize);
+	else
+		entry.fieldSize = fieldEndPtr - fieldData + 1;
+
+	if (entry.fieldSize == 0 || (*fieldData) == '\r' || (*fieldData) == '\n')
+	{
+		entry.nameSize = (uint32_t)-1;
+		entry.valueOffset = -1;
+		entry.valueSize = (uint32_t)-1;
+		return;
+	}
+
+	// the separator is searched only in the current line
+	const char* fieldValuePtr = (const char*)memchr(fieldData, nameValueSeparator, (fieldEndPtr != nullptr ? fieldEndPtr - fieldData : maxFieldSize));
+	// could not find the position of the separator, meaning field value position is unknown
+	if (fieldValuePtr == nullptr)
+	{
+		entry.valueOffset = -1;
+		entry.valueSize = (uint32_t)-1;
+		entry.nameSize = entry.fieldSize;
+		entry.nameHash = hashFieldName(fieldData, entry.nameSize);
+		return;
+	}
+
+	entry.nameSize = fieldValuePtr - fieldData;
+	entry.nameHash = hashFieldName(fieldData, entry.nameSize);
+
+	// Header field looks like this: <field_name>[separator]<zero or more spaces><field_Value>
+	// So fieldValuePtr give us the position of the separator. Value offset is the first non-space byte forward
+	fieldValuePtr++;
+
+	if (spacesAllowedBetweenNameAndValue)
+	{
+		// advance fieldValuePtr 1 byte forward while didn't get to end of packet and fieldValuePtr points to a space char
+		while (fieldValuePtr < dataEnd && (*fieldValuePtr) == ' ')
+			fieldValuePtr++;
+	}
+
+	// reached the end of the packet and value start offset wasn't found
+	if (fieldValuePtr >= dataEnd)
+	{
+		entry.valueOffset = -1;
+		entry.valueSize = (uint32_t)-1;
+		return;
 	}
 
-	m_LastField = curField;
+	entry.valueOffset = fieldValuePtr - data;
+	// couldn't find the end of the field, so assuming the field value length is from the value offset until the end of the packet
+	if (fieldEndPtr == nullptr)
+		entry.valueSize = dataEnd - fieldValuePtr;
+	else
+	{
+		entry.valueSize = fieldEndPtr - fieldValuePtr;
+		// if field ends with \r\n, decrease the value length by 1
+		if (*(fieldEndPtr - 1) == '\r')
+			entry.valueSize--;
+	}
+}
+
+void TextBasedProtocolMessage::addIndexedField(const FieldIndexEntry& entry)
+{
+	if (m_NumOfIndexedFields < MaxInlineIndexedFields)
+		m_InlineFieldIndex[m_NumOfIndexedFields] = entry;
+	else
+		m_ExtraFieldIndex.push_back(entry);
+
+	m_NumOfIndexedFields++;
+}
+
+void TextBasedProtocolMessage::materializeFields() const
+{
+	if (m_FieldsMaterialized.load(std::memory_order_acquire))
+		return;
+
+	// another thread may be creating the fields of the same message
+	std::lock_guard<std::mutex> lock(m_MaterializeMutex);
+	if (m_FieldsMaterialized.load(std::memory_order_relaxed))
+		return;
+
+	char nameValueSeparator = getHeaderFieldNameValueSeparator();
+	bool spacesAllowedBetweenNameAndValue = spacesAllowedBetweenHeaderFieldNameAndValue();
+	TextBasedProtocolMessage* nonConstThis = const_cast<TextBasedProtocolMessage*>(this);
+
+	for (int i = 0; i < m_NumOfIndexedFields; i++)
+	{
+		const FieldIndexEntry& entry = getIndexedField(i);
+		HeaderField* newField = new HeaderField(nonConstThis, entry.nameOffset, (entry.nameSize == (uint32_t)-1 ? (size_t)-1 : entry.nameSize),
+			entry.valueOffset, (entry.valueSize == (uint32_t)-1 ? (size_t)-1 : entry.valueSize), entry.fieldSize,
+			nameValueSeparator, spacesAllowedBetweenNameAndValue);
+
+		if (m_LastField == nullptr)
+			m_FieldList = newField;
+		else
+			m_LastField->setNextField(newField);
+		m_LastField = newField;
+
+		std::string fieldName = newField->getFieldName();
+		std::transform(fieldName.begin(), fieldName.end(), fieldName.begin(), ::tolower);
+		m_FieldNameToFieldMap.insert(std::pair<std::string, HeaderField*>(fieldName, newField));
+	}
+
+	// from now on the field list is used. The index is left as is since other threads may still be reading it
+	m_FieldsMaterialized.store(true, std::memory_order_release);
+}
+
+bool TextBasedProtocolMessage::extendLayer(int offsetInLayer, size_t numOfBytesToExtend)
+{
+	materializeFields();
+	return Layer::extendLayer(offsetInLayer, numOfBytesToExtend);
+}
+
+bool TextBasedProtocolMessage::shortenLayer(int offsetInLayer, size_t numOfBytesToShorten)
+{
+	materializeFields();
+	return Layer::shortenLayer(offsetInLayer, numOfBytesToShorten);
+}
+
+uint32_t TextBasedProtocolMessage::hashFieldName(const char* name, size_t nameSize)
+{
+	// FNV-1a over the lower case name
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < nameSize; i++)
+	{
+		hash ^= (uint8_t)tolower((unsigned char)name[i]);
+		hash *= 16777619u;
+	}
+
+	return hash;
 }
 
 
@@ -152,11 +312,13 @@ HeaderField* TextBasedProtocolMessage::addField(const std::string& fieldName, co
 
 HeaderField* TextBasedProtocolMessage::addField(const HeaderField& newField)
 {
+	materializeFields();
 	return insertField(m_LastField, newField);
 }
 
 HeaderField* TextBasedProtocolMessage::addEndOfHeader()
 {
+	materializeFields();
 	HeaderField endOfHeaderField(PCPP_END_OF_TEXT_BASED_PROTOCOL_HEADER, "", '\0', false);
 	return insertField(m_LastField, endOfHeaderField);
 }
@@ -199,6 +361,8 @@ HeaderField* TextBasedProtocolMessage::insertField(HeaderField* prevField, const
 		return nullptr;
 	}
 
+	materializeFields();
+
 	HeaderField* newFieldToAdd = new HeaderField(newField);
 
 	int newFieldOffset = m_FieldsOffset;
@@ -252,6 +416,7 @@ HeaderField* TextBasedProtocolMessage::insertField(HeaderField* prevField, const
 
 bool TextBasedProtocolMessage::removeField(std::string fieldName, int index)
 {
+	materializeFields();
 	std::transform(fieldName.begin(), fieldName.end(), fieldName.begin(), ::tolower);
 
 	HeaderField* fieldToRemove = nullptr;
@@ -358,6 +523,16 @@ bool TextBasedProtocolMessage::removeField(HeaderField* fieldToRemove)
 
 bool TextBasedProtocolMessage::isHeaderComplete() const
 {
+	if (!m_FieldsMaterialized)
+	{
+		if (m_NumOfIndexedFields == 0)
+			return false;
+
+		// the name of the last field is empty
+		uint32_t lastFieldNameSize = getIndexedField(m_NumOfIndexedFields - 1).nameSize;
+		return lastFieldNameSize == 0 || lastFieldNameSize == (uint32_t)-1;
+	}
+
 	if (m_LastField == nullptr)
 		return false;
 
@@ -377,6 +552,7 @@ void TextBasedProtocolMessage::shiftFieldsOffset(HeaderField* fromField, int num
 
 HeaderField* TextBasedProtocolMessage::getFieldByName(std::string fieldName, int index) const
 {
+	materializeFields();
 	std::transform(fieldName.begin(), fieldName.end(), fieldName.begin(), ::tolower);
 
 	std::pair <std::multimap<std::string,HeaderField*>::const_iterator, std::multimap<std::string,HeaderField*>::const_iterator> range;
@@ -393,10 +569,53 @@ HeaderField* TextBasedProtocolMessage::getFieldByName(std::string fieldName, int
 	return nullptr;
 }
 
+std::string TextBasedProtocolMessage::getFieldValueByName(const std::string& fieldName, int index) const
+{
+	if (m_FieldsMaterialized)
+	{
+		HeaderField* field = getFieldByName(fieldName, index);
+		if (field == nullptr)
+			return "";
+
+		return field->getFieldValue();
+	}
+
+	uint32_t nameHash = hashFieldName(fieldName.c_str(), fieldName.length());
+	int i = 0;
+	for (int fieldIndex = 0; fieldIndex < m_NumOfIndexedFields; fieldIndex++)
+	{
+		const FieldIndexEntry& entry = getIndexedField(fieldIndex);
+		if (entry.nameHash != nameHash || entry.nameSize != fieldName.length() ||
+			!tbp_equals_ignore_case((const char*)m_Data + entry.nameOffset, fieldName.c_str(), fieldName.length()))
+			continue;
+
+		if (i++ < index)
+			continue;
+
+		if (entry.valueOffset == -1)
+			return "";
+
+		return std::string((const char*)m_Data + entry.valueOffset, entry.valueSize);
+	}
+
+	return "";
+}
+
 int TextBasedProtocolMessage::getFieldCount() const
 {
 	int result = 0;
 
+	if (!m_FieldsMaterialized)
+	{
+		for (int i = 0; i < m_NumOfIndexedFields; i++)
+		{
+			if (!getIndexedField(i).isEndOfHeader())
+				result++;
+		}
+
+		return result;
+	}
+
 	HeaderField* curField = getFirstField();
 	while (curField != nullptr)
 	{
@@ -419,6 +638,12 @@ void TextBasedProtocolMessage::parseNextLayer()
 
 size_t TextBasedProtocolMessage::getHeaderLen() const
 {
+	if (!m_FieldsMaterialized)
+	{
+		const FieldIndexEntry& lastField = getIndexedField(m_NumOfIndexedFields - 1);
+		return lastField.nameOffset + lastField.fieldSize;
+	}
+
 	return m_LastField->m_NameOffsetInMessage + m_LastField->m_FieldSize;
 }
 
@@ -434,82 +659,12 @@ void TextBasedProtocolMessage::computeCalculateFields()
 // -------- Class HeaderField -----------------
 
 
-HeaderField::HeaderField(TextBasedProtocolMessage* TextBasedProtocolMessage, int offsetInMessage, char nameValueSeparator, bool spacesAllowedBetweenNameAndValue) :
-		m_NewFieldData(nullptr), m_TextBasedProtocolMessage(TextBasedProtocolMessage), m_NameOffsetInMessage(offsetInMessage), m_NextField(nullptr),
-		m_NameValueSeparator(nameValueSeparator), m_SpacesAllowedBetweenNameAndValue(spacesAllowedBetweenNameAndValue)
+HeaderField::HeaderField(TextBasedProtocolMessage* TextBasedProtocolMessage, int nameOffsetInMessage, size_t fieldNameSize, int valueOffsetInMessage, size_t fieldValueSize,
+		size_t fieldSize, char nameValueSeparator, bool spacesAllowedBetweenNameAndValue) :
+		m_NewFieldData(nullptr), m_TextBasedProtocolMessage(TextBasedProtocolMessage), m_NameOffsetInMessage(nameOffsetInMessage), m_FieldNameSize(fieldNameSize),
+		m_ValueOffsetInMessage(valueOffsetInMessage), m_FieldValueSize(fieldValueSize), m_FieldSize(fieldSize), m_NextField(nullptr),
+		m_IsEndOfHeaderField(fieldNameSize == (size_t)-1), m_NameValueSeparator(nameValueSeparator), m_SpacesAllowedBetweenNameAndValue(spacesAllowedBetweenNameAndValue)
 {
-	char* fieldData = (char*)(m_TextBasedProtocolMessage->m_Data + m_NameOffsetInMessage);
-	char* fieldEndPtr = (char*)memchr(fieldData, '\n', m_TextBasedProtocolMessage->m_DataLen - (size_t)m_NameOffsetInMessage);
-	if (fieldEndPtr == nullptr)
-		m_FieldSize = tbp_my_own_strnlen(fieldData, m_TextBasedProtocolMessage->m_DataLen - (size_t)m_NameOffsetInMessage);
-	else
-		m_FieldSize = fieldEndPtr - fieldData + 1;
-
-	if (m_FieldSize == 0 || (*fieldData) == '\r' || (*fieldData) == '\n')
-	{
-		m_FieldNameSize = -1;
-		m_ValueOffsetInMessage = -1;
-		m_FieldValueSize = -1;
-		m_FieldNameSize = -1;
-		m_IsEndOfHeaderField = true;
-		return;
-	}
-	else
-		m_IsEndOfHeaderField = false;
-
-	char* fieldValuePtr = (char*)memchr(fieldData, nameValueSeparator, m_TextBasedProtocolMessage->m_DataLen - (size_t)m_NameOffsetInMessage);
-	// could not find the position of the separator, meaning field value position is unknown
-	if (fieldValuePtr == nullptr || (fieldEndPtr != nullptr && fieldValuePtr >= fieldEndPtr))
-	{
-		m_ValueOffsetInMessage = -1;
-		m_FieldValueSize = -1;
-		m_FieldNameSize = m_FieldSize;
-	}
-	else
-	{
-		m_FieldNameSize = fieldValuePtr - fieldData;
-		// Header field looks like this: <field_name>[separator]<zero or more spaces><field_Value>
-		// So fieldValuePtr give us the position of the separator. Value offset is the first non-space byte forward
-		fieldValuePtr++;
-
-		// reached the end of the packet and value start offset wasn't found
-		if ((size_t)(fieldValuePtr - (char*)(m_TextBasedProtocolMessage->m_Data)) >= m_TextBasedProtocolMessage->getDataLen())
-		{
-			m_ValueOffsetInMessage = -1;
-			m_FieldValueSize = -1;
-			return;
-		}
-
-		if (spacesAllowedBetweenNameAndValue)
-		{
-			// advance fieldValuePtr 1 byte forward while didn't get to end of packet and fieldValuePtr points to a space char
-			while ((size_t)(fieldValuePtr - (char*)m_TextBasedProtocolMessage->m_Data) < m_TextBasedProtocolMessage->getDataLen() && (*fieldValuePtr) == ' ')
-			{
-				fieldValuePtr++;
-			}
-		}
-
-		// reached the end of the packet and value start offset wasn't found
-		if ((size_t)(fieldValuePtr - (char*)(m_TextBasedProtocolMessage->m_Data)) >= m_TextBasedProtocolMessage->getDataLen())
-		{
-			m_ValueOffsetInMessage = -1;
-			m_FieldValueSize = -1;
-		}
-		else
-		{
-			m_ValueOffsetInMessage = fieldValuePtr - (char*)m_TextBasedProtocolMessage->m_Data;
-			// couldn't find the end of the field, so assuming the field value length is from m_ValueOffsetInMessage until the end of the packet
-			if (fieldEndPtr == nullptr)
-				m_FieldValueSize = (char*)(m_TextBasedProtocolMessage->m_Data + m_TextBasedProtocolMessage->getDataLen()) - fieldValuePtr;
-			else
-			{
-				m_FieldValueSize = fieldEndPtr - fieldValuePtr;
-				// if field ends with \r\n, decrease the value length by 1
-				if ((*(--fieldEndPtr)) == '\r')
-					m_FieldValueSize--;
-			}
-		}
-	}
 }
 
 HeaderField::HeaderField(const std::string& name, const std::string& value, char nameValueSeparator, bool spacesAllowedBetweenNameAndValue)
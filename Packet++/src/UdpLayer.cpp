@@ -45,6 +45,22 @@ uint16_t UdpLayer::getDstPort() const
 	return be16toh(getUdpHeader()->portDst);
 }
 
+void UdpLayer::setSrcPort(uint16_t port)
+{
+	uint16_t oldPort = getUdpHeader()->portSrc;
+	uint16_t newPort = htobe16(port);
+	getUdpHeader()->portSrc = newPort;
+	updateTransportChecksum(this, (uint8_t*)&oldPort, (uint8_t*)&newPort, sizeof(uint16_t));
+}
+
+void UdpLayer::setDstPort(uint16_t port)
+{
+	uint16_t oldPort = getUdpHeader()->portDst;
+	uint16_t newPort = htobe16(port);
+	getUdpHeader()->portDst = newPort;
+	updateTransportChecksum(this, (uint8_t*)&oldPort, (uint8_t*)&newPort, sizeof(uint16_t));
+}
+
 uint16_t UdpLayer::calculateChecksum(bool writeResultToPacket)
 {
 	udphdr* udpHdr = (udphdr*)m_Data;
@@ -3,7 +3,9 @@
 
 #include "PcapDevice.h"
 #include "RawPacket.h"
+#include <atomic>
 #include <fstream>
+#include <vector>
 
 // forward declaration for structs and typedefs defined in pcap.h
 struct pcap_dumper;
@@ -53,9 +55,32 @@ namespace pcpp
 	 */
 	class IFileReaderDevice : public IFileDevice
 	{
+	public:
+		/**
+		 * An enum representing the way packet data is handed over to the RawPacket objects returned by getNextPacket()
+		 */
+		enum PacketDataMode
+		{
+			/** The data of each packet is copied into a newly allocated buffer which is owned by the RawPacket. This is the default mode */
+			CopyPacketData,
+			/**
+			 * The data of each packet is copied into a single buffer owned by the reader, which grows when a larger packet is read. The
+			 * RawPacket doesn't own the data and it remains valid only until the next packet is read or until the reader is closed
+			 */
+			ReusePacketBuffer,
+			/**
+			 * The RawPacket points directly into the reader's internal buffer and no copy is made. The data should be treated as read-only
+			 * and it remains valid only until the next packet is read or until the reader is closed. Readers that don't have an internal
+			 * buffer to expose behave as in ReusePacketBuffer mode
+			 */
+			ZeroCopyPacketData
+		};
+
 	protected:
 		uint32_t m_NumOfPacketsRead;
 		uint32_t m_NumOfPacketsNotParsed;
+		PacketDataMode m_PacketDataMode;
+		std::vector<uint8_t> m_PacketBuffer;
 
 		/**
 		 * A constructor for this class that gets the pcap full path file name to open. Notice that after calling this constructor the file
@@ -64,6 +89,18 @@ namespace pcpp
 		 */
 		IFileReaderDevice(const std::string& fileName);
 
+		/**
+		 * Set packet data read from the file into a raw packet according to the current packet data mode
+		 * @param[in] rawPacket The raw packet to set the data to
+		 * @param[in] data A pointer to the packet data, which is assumed to be valid until the next packet is read
+		 * @param[in] dataLen The captured length of the packet
+		 * @param[in] timestamp The packet timestamp
+		 * @param[in] linkType The packet link layer type
+		 * @param[in] frameLength The original length of the packet
+		 * @return True if the data was set successfully, false otherwise
+		 */
+		bool setPacketData(RawPacket& rawPacket, const uint8_t* data, int dataLen, timespec timestamp, LinkLayerType linkType, int frameLength);
+
 	public:
 
 		/**
@@ -79,7 +116,20 @@ namespace pcpp
 		virtual bool getNextPacket(RawPacket& rawPacket) = 0;
 
 		/**
-		 * Read the next N packets into a raw packet vector
+		 * Set the way packet data is handed over to the RawPacket objects returned by getNextPacket(). Please refer to PacketDataMode
+		 * for the available modes. The mode can be changed at any time, also while the file is open
+		 * @param[in] mode The packet data mode to use
+		 */
+		void setPacketDataMode(PacketDataMode mode) { m_PacketDataMode = mode; }
+
+		/**
+		 * @return The current packet data mode. The default is CopyPacketData
+		 */
+		PacketDataMode getPacketDataMode() const { return m_PacketDataMode; }
+
+		/**
+		 * Read the next N packets into a raw packet vector. Since each packet in the vector has to own its data, packets are always
+		 * copied in this method regardless of the packet data mode
 		 * @param[out] packetVec The raw packet vector to read packets into
 		 * @param[in] numOfPacketsToRead Number of packets to read. If value <0 all remaining packets in the file will be read into the
 		 * raw packet vector (this is the default value)
@@ -153,6 +203,174 @@ namespace pcpp
 		void getStatistics(PcapStats& stats) const;
 	};
 
+	/**
+	 * @class PcapMmapFileReaderDevice
+	 * A class for reading a classic pcap file by mapping it to memory instead of reading it through libpcap. Packets returned by this reader
+	 * point directly into the mapped file (unless a different packet data mode is set using setPacketDataMode()), so their data remains valid
+	 * until the reader is closed.
+	 *
+	 * In addition to sequential reading using getNextPacket(), this class can split the file into a number of byte ranges whose boundaries
+	 * are aligned to packet records (see splitToRanges()), and create independent RangeReader objects for each range. Range readers only
+	 * read from the shared read-only mapping, so different range readers may be used concurrently from different threads, which allows
+	 * processing a single large capture file on all cores.
+	 *
+	 * Pcap files in both byte orders and with either microsecond or nanosecond timestamp precision are supported. Pcap-ng files are not supported
+	 */
+	class PcapMmapFileReaderDevice : public IFileReaderDevice
+	{
+	public:
+		/**
+		 * @struct FileRange
+		 * A byte range in the mapped file. Both offsets are from the beginning of the file, and startOffset always points to the beginning
+		 * of a packet record
+		 */
+		struct FileRange
+		{
+			/** The offset of the first packet record in the range */
+			uint64_t startOffset;
+			/** The offset right after the end of the range (non-inclusive) */
+			uint64_t endOffset;
+		};
+
+		/**
+		 * @class RangeReader
+		 * A lightweight reader of the packets in a certain range of a mapped pcap file. Range readers are created using
+		 * PcapMmapFileReaderDevice#getRangeReader() and don't modify the device, hence different range readers may be used concurrently.
+		 * Packets returned by a range reader always point directly into the mapped file and are valid until the device is closed
+		 */
+		class RangeReader
+		{
+			friend class PcapMmapFileReaderDevice;
+		public:
+			/**
+			 * Read the next packet in the range
+			 * @param[out] rawPacket The raw packet to set the packet data to
+			 * @return True if a packet was read, false if the end of the range was reached or if the next record is malformed
+			 */
+			bool getNextPacket(RawPacket& rawPacket);
+
+			/**
+			 * @return The offset in the file of the next packet record to read
+			 */
+			uint64_t getCurrentOffset() const { return m_CurOffset; }
+
+			/**
+			 * @return The number of packets read so far by this range reader
+			 */
+			uint64_t getNumOfPacketsRead() const { return m_NumOfPacketsRead; }
+
+		private:
+			const PcapMmapFileReaderDevice* m_Device;
+			uint64_t m_CurOffset;
+			uint64_t m_EndOffset;
+			uint64_t m_NumOfPacketsRead;
+
+			RangeReader(const PcapMmapFileReaderDevice* device, uint64_t startOffset, uint64_t endOffset) :
+				m_Device(device), m_CurOffset(startOffset), m_EndOffset(endOffset), m_NumOfPacketsRead(0) {}
+		};
+
+		/**
+		 * A constructor for this class that gets the pcap full path file name to open. Notice that after calling this constructor the file
+		 * isn't opened yet, so reading packets will fail. For opening the file call open(). The default packet data mode of this reader is
+		 * ZeroCopyPacketData
+		 * @param[in] fileName The full path of the file to read
+		 */
+		PcapMmapFileReaderDevice(const std::string& fileName);
+
+		/**
+		 * A destructor for this class. Unmaps the file if it's still mapped
+		 */
+		virtual ~PcapMmapFileReaderDevice() { close(); }
+
+		/**
+		 * @return The link layer type of this file
+		 */
+		LinkLayerType getLinkLayerType() const { return m_PcapLinkLayerType; }
+
+		/**
+		 * @return The size in bytes of the mapped file, or 0 if the file isn't opened
+		 */
+		uint64_t getMappedSize() const { return m_MappedSize; }
+
+		/**
+		 * Split the packet records of the file into byte ranges of similar sizes. Range boundaries are found by walking the record
+		 * headers from the beginning of the file (the packet data isn't read), so each range starts at the beginning of a record and
+		 * no record crosses the end of a range. If the file has fewer records than requested ranges, or if a malformed record is found
+		 * before a boundary, the number of returned ranges is smaller than requested
+		 * @param[in] numOfRanges The requested number of ranges. Must be greater than 0
+		 * @param[out] ranges A vector to which the ranges are written (the vector is cleared first). The ranges are ordered, don't overlap
+		 * and cover all packet records in the file
+		 * @return True if the file was split successfully, false if the file isn't opened or if numOfRanges is 0
+		 */
+		bool splitToRanges(size_t numOfRanges, std::vector<FileRange>& ranges) const;
+
+		/**
+		 * Create a reader for a certain range of the file
+		 * @param[in] range The range to read. Its start offset must point to the beginning of a packet record, as returned by splitToRanges()
+		 * @return A range reader object. If the device isn't opened the range reader doesn't return any packet
+		 */
+		RangeReader getRangeReader(const FileRange& range) const;
+
+		//overridden methods
+
+		/**
+		 * Read the next packet from the file. Before using this method please verify the file is opened using open()
+		 * @param[out] rawPacket A reference for an empty RawPacket where the packet will be written
+		 * @return True if a packet was read successfully. False will be returned if the file isn't opened (also, an error log will be printed),
+		 * if reached end-of-file or if a malformed packet record was encountered
+		 */
+		bool getNextPacket(RawPacket& rawPacket);
+
+		/**
+		 * Map the file whose path was specified in the constructor to memory in a read-only mode and read its header
+		 * @return True if the file was mapped successfully or if file is already opened. False if opening the file failed for some reason (for example:
+		 * file path does not exist or it's not a valid pcap file)
+		 */
+		bool open();
+
+		/**
+		 * Unmap the file. Packets that point into the mapped file become invalid after calling this method
+		 */
+		void close();
+
+		/**
+		 * Get statistics of packets read so far using getNextPacket(). In the PcapStats struct, only the packetsRecv member is relevant.
+		 * The rest of the members will contain 0
+		 * @param[out] stats The stats struct where stats are returned
+		 */
+		void getStatistics(PcapStats& stats) const;
+
+		/**
+		 * Set a filter for the sequential reading of this device. Only packets that match the filter will be returned by getNextPacket().
+		 * The filter doesn't apply to range readers
+		 * @param[in] filterAsString The filter to be set in Berkeley Packet Filter (BPF) syntax (http://biot.com/capstats/bpf.html)
+		 * @return True if filter set successfully, false otherwise
+		 */
+		bool setFilter(std::string filterAsString);
+
+	private:
+		LinkLayerType m_PcapLinkLayerType;
+		const uint8_t* m_MappedData;
+		uint64_t m_MappedSize;
+		uint64_t m_CurOffset;
+		uint32_t m_SnapLen;
+		bool m_SwapBytes;
+		bool m_NanoSecPrecision;
+		BpfFilterWrapper m_BpfWrapper;
+#if defined(_WIN32)
+		void* m_FileHandle;
+		void* m_MappingHandle;
+#else
+		int m_FileDescriptor;
+#endif
+
+		// private copy c'tor
+		PcapMmapFileReaderDevice(const PcapMmapFileReaderDevice& other);
+		PcapMmapFileReaderDevice& operator=(const PcapMmapFileReaderDevice& other);
+
+		bool readRecord(uint64_t& offset, uint64_t endOffset, const uint8_t*& data, uint32_t& capLen, uint32_t& origLen, timespec& timestamp) const;
+	};
+
 	/**
 	 * @class SnoopFileReaderDevice
 	 * A class for opening a snoop file in read-only mode. This class enable to open the file and read all packets, packet-by-packet
@@ -351,18 +569,108 @@ namespace pcpp
 	 */
 	class IFileWriterDevice : public IFileDevice
 	{
+	public:
+		/**
+		 * An enum describing what writePacket() does in async writing mode when the queue doesn't have room for the packet
+		 */
+		enum AsyncQueueFullPolicy
+		{
+			/** Wait until the writer thread frees room in the queue */
+			BlockWhenQueueFull,
+			/** Don't write the packet and return false. The packet is counted as dropped */
+			DropWhenQueueFull
+		};
+
+		/**
+		 * @struct AsyncWriterStats
+		 * Statistics of the async writing mode, see startAsyncWriting()
+		 */
+		struct AsyncWriterStats
+		{
+			/** The number of packets copied into the queue */
+			uint64_t packetsQueued;
+			/** The number of packets dropped because the queue was full (only with DropWhenQueueFull) or the packet was larger than the queue */
+			uint64_t packetsDropped;
+			/** The number of times writePacket() waited for room in the queue (only with BlockWhenQueueFull) */
+			uint64_t numOfBlockedWrites;
+			/** The number of batches the writer thread wrote to the file */
+			uint64_t numOfBatchesWritten;
+			/** The number of batches the writer thread failed to write to the file, completely or partially */
+			uint64_t numOfFailedBatches;
+			/** The number of queued packets the writer thread failed to write to the file */
+			uint64_t packetsFailed;
+			/** The number of bytes the writer thread wrote to the file */
+			uint64_t bytesWritten;
+			/** The number of packets currently queued or being written */
+			uint64_t queueDepthPackets;
+			/** The number of bytes currently queued or being written */
+			uint64_t queueDepthBytes;
+			/** The highest number of bytes queued while the writer thread was busy */
+			uint64_t maxQueueDepthBytes;
+		};
+
+		/**
+		 * The default size of each of the two buffers used in async writing mode
+		 */
+		static const size_t DefaultAsyncBufferSize = 4 * 1024 * 1024;
+
 	protected:
-		uint32_t m_NumOfPacketsWritten;
-		uint32_t m_NumOfPacketsNotWritten;
+		class AsyncWriter;
+
+		// atomic because in async writing mode they're updated by the threads that write packets and by the writer thread
+		std::atomic<uint32_t> m_NumOfPacketsWritten;
+		std::atomic<uint32_t> m_NumOfPacketsNotWritten;
+		AsyncWriter* m_AsyncWriter;
+		bool m_AsyncWritingEnabled;
 
 		IFileWriterDevice(const std::string& fileName);
 
+		/**
+		 * Copy a packet into the async writing queue. Called by writePacket() in async writing mode after the packet is validated
+		 * @param[in] packet The packet to queue
+		 * @param[in] comment A comment to store with the packet (if the file format supports it)
+		 * @return True if the packet was queued, false if it was dropped
+		 */
+		bool queuePacketForAsyncWrite(const RawPacket& packet, const std::string& comment);
+
+		/**
+		 * Wait until the writer thread wrote all queued packets to the file. Does nothing if async writing isn't enabled
+		 */
+		void waitForAsyncWrites();
+
+		/**
+		 * @param[in] packet A packet to be queued
+		 * @param[in] comment The comment to be queued with the packet
+		 * @return The number of bytes the packet takes in the async writing queue, 0 if async writing isn't supported by the device
+		 */
+		virtual size_t getAsyncRecordSize(const RawPacket& packet, const std::string& comment) const { (void)packet; (void)comment; return 0; }
+
+		/**
+		 * Serialize a packet into the async writing queue
+		 * @param[in] packet The packet to serialize
+		 * @param[in] comment The comment to serialize with the packet
+		 * @param[out] record A buffer of getAsyncRecordSize() bytes to serialize the packet into
+		 */
+		virtual void serializeAsyncRecord(const RawPacket& packet, const std::string& comment, uint8_t* record) const { (void)packet; (void)comment; (void)record; }
+
+		/**
+		 * Write a batch of serialized packets to the file. Called on the writer thread only, while the caller's thread keeps queueing packets
+		 * @param[in] records The serialized packets
+		 * @param[in] recordsLen The length of the serialized packets in bytes
+		 * @param[in] numOfRecords The number of serialized packets
+		 * @return The number of packets written successfully, numOfRecords if the whole batch was written
+		 */
+		virtual size_t writeAsyncRecords(const uint8_t* records, size_t recordsLen, size_t numOfRecords) { (void)records; (void)recordsLen; (void)numOfRecords; return 0; }
+
+	private:
+		void asyncWriterThreadMain();
+
 	public:
 
 		/**
-		 * A destructor for this class
+		 * A destructor for this class. Async writing must be stopped before the destructor of the derived class ends
 		 */
-		virtual ~IFileWriterDevice() {}
+		virtual ~IFileWriterDevice();
 
 		virtual bool writePacket(RawPacket const& packet) = 0;
 
@@ -370,6 +678,42 @@ namespace pcpp
 
 		using IFileDevice::open;
 		virtual bool open(bool appendMode) = 0;
+
+		/**
+		 * Start writing packets asynchronously. From now on writePacket() copies packets into an in-memory queue and returns, while a
+		 * background writer thread writes them to the file. The queue is made of two buffers: writePacket() fills one while the writer
+		 * thread writes the other one to the file in a single large write, so disk latency doesn't stall the thread that writes the
+		 * packets. The writer thread swaps the buffers when the filled buffer is half full, when flush() is called or every
+		 * flushIntervalMs milliseconds. writePacket() may be called from several threads in this mode. Packets are counted as written
+		 * in getStatistics() when they're queued, and moved to the dropped count if the writer thread fails to write them. flush() and close() write all queued packets to the file before returning.
+		 * The device must be opened before calling this method
+		 * @param[in] bufferSize The size in bytes of each of the two buffers. Packets larger than that are dropped. The default is
+		 * DefaultAsyncBufferSize
+		 * @param[in] policy What writePacket() does when the queue is full. The default is to wait for room
+		 * @param[in] flushIntervalMs The longest time in milliseconds a packet stays in the queue before the writer thread writes it.
+		 * The default is 100ms
+		 * @return True if async writing was started. False if the device isn't opened, async writing is already enabled, the buffer
+		 * size is 0 or the device doesn't support async writing (an error will be printed to log)
+		 */
+		bool startAsyncWriting(size_t bufferSize = DefaultAsyncBufferSize, AsyncQueueFullPolicy policy = BlockWhenQueueFull, int flushIntervalMs = 100);
+
+		/**
+		 * Write all queued packets to the file, stop the writer thread and go back to writing packets on the caller's thread. It must be
+		 * called when no other thread is writing packets. It's called automatically by close()
+		 */
+		void stopAsyncWriting();
+
+		/**
+		 * @return True if async writing is enabled, see startAsyncWriting()
+		 */
+		bool isAsyncWritingEnabled() const { return m_AsyncWritingEnabled; }
+
+		/**
+		 * Get the statistics of the async writing mode. All counters are zero if async writing was never started and are reset
+		 * when it's started
+		 * @param[out] stats The stats struct where stats are returned
+		 */
+		void getAsyncWriterStats(AsyncWriterStats& stats) const;
 	};
 
 
@@ -393,6 +737,10 @@ namespace pcpp
 
 		void closeFile();
 
+		size_t getAsyncRecordSize(const RawPacket& packet, const std::string& comment) const;
+		void serializeAsyncRecord(const RawPacket& packet, const std::string& comment, uint8_t* record) const;
+		size_t writeAsyncRecords(const uint8_t* records, size_t recordsLen, size_t numOfRecords);
+
 	public:
 		/**
 		 * A constructor for this class that gets the pcap full path file name to open for writing or create. Notice that after calling this
@@ -405,7 +753,7 @@ namespace pcpp
 		/**
 		 * A destructor for this class
 		 */
-		~PcapFileWriterDevice() {}
+		~PcapFileWriterDevice() { stopAsyncWriting(); }
 
 		/**
 		 * Write a RawPacket to the file. Before using this method please verify the file is opened using open(). This method won't change the
@@ -413,7 +761,8 @@ namespace pcpp
 		 * @param[in] packet A reference for an existing RawPcket to write to the file
 		 * @return True if a packet was written successfully. False will be returned if the file isn't opened
 		 * or if the packet link layer type is different than the one defined for the file
-		 * (in all cases, an error will be printed to log)
+		 * (in all cases, an error will be printed to log). In async writing mode the packet is queued and false is also returned if
+		 * it was dropped, see startAsyncWriting()
 		 */
 		bool writePacket(RawPacket const& packet);
 
@@ -484,6 +833,10 @@ namespace pcpp
 		PcapNgFileWriterDevice(const PcapFileWriterDevice& other);
 		PcapNgFileWriterDevice& operator=(const PcapNgFileWriterDevice& other);
 
+		size_t getAsyncRecordSize(const RawPacket& packet, const std::string& comment) const;
+		void serializeAsyncRecord(const RawPacket& packet, const std::string& comment, uint8_t* record) const;
+		size_t writeAsyncRecords(const uint8_t* records, size_t recordsLen, size_t numOfRecords);
+
 	public:
 
 		/**
@@ -522,7 +875,8 @@ namespace pcpp
 		 * written packet or the input comment
 		 * @param[in] packet A reference for an existing RawPcket to write to the file
 		 * @param[in] comment The comment to be written for the packet. If this string is empty or null it will be ignored
-		 * @return True if a packet was written successfully. False will be returned if the file isn't opened (an error will be printed to log)
+		 * @return True if a packet was written successfully. False will be returned if the file isn't opened (an error will be printed to log).
+		 * In async writing mode the packet and the comment are queued and false is also returned if they were dropped, see startAsyncWriting()
 		 */
 		bool writePacket(RawPacket const& packet, const std::string& comment);
 
@@ -4,10 +4,12 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
 #include "ProtocolType.h"
 #include <stdint.h>
 #include "ArpLayer.h"
 #include "RawPacket.h"
+#include "PointerVector.h"
 
 //Forward Declaration - used in GeneralFilter
 struct bpf_program;
@@ -36,6 +38,8 @@ namespace pcpp
 {
 	//Forward Declaration - used in GeneralFilter
 	class RawPacket;
+	class Packet;
+	class GeneralFilter;
 
 	/**
 	 * An enum that contains direction (source or destination)
@@ -128,6 +132,142 @@ namespace pcpp
 		bool matchPacketWithFilter(const uint8_t* packetData, uint32_t packetDataLength, timespec packetTimestamp, uint16_t linkType);
 	};
 
+	/**
+	 * @class CompiledFilter
+	 * A filter tree (GeneralFilter and its sub-classes) compiled into a flat program that is evaluated directly on the raw packet bytes,
+	 * without converting the tree to a BPF string and running it in libpcap's BPF interpreter.<BR>
+	 * The program is a list of predicates (e.g "EtherType is IPv4", "source port is in range X-Y") connected by jumps taken when the
+	 * predicate is true or false, which is how the "and", "or" and "not" filters are evaluated. Each predicate matches what libpcap
+	 * generates for the BPF string of the corresponding filter, including the following details:
+	 * - The VLAN filters shift the offsets of all the filters that come after them in the tree, like the "vlan" keyword in BPF
+	 * - Port filters match only non-fragmented (or first fragment) IPv4 packets and IPv6 packets in which TCP/UDP/SCTP immediately
+	 *   follows the IPv6 header
+	 * - If a predicate needs to read beyond the end of the packet the packet doesn't match, regardless of the rest of the filter
+	 *
+	 * Filters that can't be compiled natively (BPFStringFilter, protocols that ProtoFilter can't translate, invalid IP addresses, etc.)
+	 * and packets of link types the native engine doesn't handle are matched using BpfFilterWrapper, so the result is always the same as
+	 * matching with BPF. Natively evaluated link types are: Ethernet, Linux cooked capture (SLL) and raw IP. MAC address, VLAN and EtherType
+	 * filters are evaluated natively only for Ethernet.<BR>
+	 * The program is a snapshot of the filter tree at the time compile() was called. If the tree (or any filter in it) is modified after
+	 * that, compile() should be called again
+	 */
+	class CompiledFilter
+	{
+		friend class GeneralFilter;
+	public:
+		class Builder;
+
+		/**
+		 * A c'tor for this class that creates an empty filter which matches all packets
+		 */
+		CompiledFilter();
+
+		/**
+		 * Compile a filter tree. If some filter in the tree can't be compiled natively, the BPF string of the tree is used instead
+		 * @param[in] filter The root of the filter tree
+		 * @return True if the tree was compiled to a native program or false if BPF will be used for matching
+		 */
+		bool compile(GeneralFilter& filter);
+
+		/**
+		 * @return True if the filter was compiled to a native program, false if BPF is used for matching
+		 */
+		bool isNative() const { return m_IsNative; }
+
+		/**
+		 * @param[in] linkType A link type
+		 * @return True if packets of this link type are matched by the native program, false if they're matched using BPF
+		 */
+		bool isNativeForLinkType(LinkLayerType linkType) const;
+
+		/**
+		 * Match a packet with the filter
+		 * @param[in] packetData A pointer to the packet data
+		 * @param[in] packetDataLength The length in bytes of the packet data
+		 * @param[in] linkType The packet link type
+		 * @return True if the packet matches the filter, false otherwise. If BPF is used and the BPF string can't be compiled by libpcap,
+		 * false is returned
+		 */
+		bool matchPacket(const uint8_t* packetData, uint32_t packetDataLength, LinkLayerType linkType);
+
+		/**
+		 * Match a raw packet with the filter
+		 * @param[in] rawPacket A pointer to the raw packet
+		 * @return True if the packet matches the filter, false otherwise
+		 */
+		bool matchPacket(const RawPacket* rawPacket);
+
+		/**
+		 * Match an already parsed packet with the filter. The filter is evaluated on the raw data of the packet, the packet isn't parsed again
+		 * @param[in] packet The packet to match
+		 * @return True if the packet matches the filter, false otherwise
+		 */
+		bool matchPacket(const Packet& packet);
+
+		/**
+		 * Match a batch of raw packets with the filter
+		 * @param[in] rawPackets A vector of raw packets (RawPacketVector)
+		 * @param[out] results A vector that will contain the result for each packet in the same order as the input vector. Its previous
+		 * content is cleared
+		 * @return The number of packets that matched the filter
+		 */
+		size_t matchPackets(const PointerVector<RawPacket>& rawPackets, std::vector<bool>& results);
+
+	private:
+		enum InstructionType
+		{
+			EtherTypeEquals,
+			VlanTagEquals,
+			MacAddressEquals,
+			IPv4NetEquals,
+			IPv4FieldCompare,
+			IPProtocolEquals,
+			PortRangeMatch,
+			TransportFieldCompare,
+			ArpFieldEquals
+		};
+
+		// a single predicate with the jumps to take when it's true or false. A negative jump target means the end of the program:
+		// AcceptTarget or RejectTarget
+		struct Instruction
+		{
+			uint8_t type;
+			// a FilterOperator for compare instructions, a Direction for address and port instructions
+			uint8_t op;
+			// the number of bytes VLAN filters that precede this instruction add to the link-layer offsets
+			uint8_t vlanShift;
+			// the size of the field to compare (1 or 2 bytes) for field compare instructions, or whether IPv6 is matched for IP protocol
+			uint8_t size;
+			uint16_t offset;
+			uint16_t protocol;
+			uint32_t value;
+			uint32_t secondValue;
+			uint32_t mask;
+			uint8_t bytes[6];
+			int32_t jumpIfTrue;
+			int32_t jumpIfFalse;
+		};
+
+		static const int32_t AcceptTarget = -1;
+		static const int32_t RejectTarget = -2;
+
+		std::vector<Instruction> m_Program;
+		int32_t m_EntryPoint;
+		bool m_IsNative;
+		bool m_IsEthernetOnly;
+		std::string m_FilterStr;
+		BpfFilterWrapper m_BpfFilter;
+		// whether libpcap was asked to compile the BPF string for m_BpfFilterLinkType, and whether it succeeded. A failure is kept as well,
+		// so a string libpcap can't compile isn't compiled again for every packet
+		bool m_IsBpfFilterSet;
+		bool m_IsBpfFilterValid;
+		LinkLayerType m_BpfFilterLinkType;
+
+		bool compile(GeneralFilter& filter, const std::string& filterStr);
+		bool matchWithBpf(const uint8_t* packetData, uint32_t packetDataLength, LinkLayerType linkType);
+		bool runProgram(const uint8_t* packetData, uint32_t packetDataLength, LinkLayerType linkType) const;
+	};
+
 	/**
 	 * @class GeneralFilter
 	 * The base class for all filter classes. This class is virtual and abstract, hence cannot be instantiated.<BR>
@@ -135,8 +275,30 @@ namespace pcpp
 	 */
 	class GeneralFilter
 	{
+		friend class CompiledFilter::Builder;
+	private:
+		// incremented whenever any filter is modified. A filter tree doesn't know when one of its sub-filters is modified, so
+		// matchPacketWithFilter() checks whether the tree changed only when some filter was modified since the tree was compiled
+		static std::atomic<uint64_t> s_FilterVersion;
+		uint64_t m_CompiledFilterVersion;
+
 	protected:
 		BpfFilterWrapper m_BpfWrapper;
+		CompiledFilter m_CompiledFilter;
+
+		/**
+		 * Should be called by every method that modifies the filter, so the compiled program of the filter (and of the filter trees that
+		 * contain it) is rebuilt before the next match
+		 */
+		static void filterChanged() { s_FilterVersion.fetch_add(1, std::memory_order_relaxed); }
+
+		/**
+		 * Add the filter to a native filter program being built. The default implementation doesn't support native compilation
+		 * @param[in] builder The program builder
+		 * @param[out] nodeIndex The index of the node that represents this filter in the builder
+		 * @return True if the filter was added or false if it can't be compiled natively
+		 */
+		virtual bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex) { (void)builder; (void)nodeIndex; return false; }
 
 	public:
 		/**
@@ -146,13 +308,18 @@ namespace pcpp
 		virtual void parseToString(std::string& result) = 0;
 
 		/**
-		* Match a raw packet with a given BPF filter.
-		* @param[in] rawPacket A pointer to the raw packet to match the BPF filter with
-		* @return True if a raw packet matches the BPF filter or false otherwise
+		* Match a raw packet with the filter. The filter is compiled into a native program (see CompiledFilter) which is kept until the filter
+		* is changed, and BPF is used only for filters or link types the native engine doesn't support
+		* @param[in] rawPacket A pointer to the raw packet to match the filter with
+		* @return True if a raw packet matches the filter or false otherwise
 		*/
 		bool matchPacketWithFilter(RawPacket* rawPacket);
 
-		GeneralFilter() {}
+		// a new filter, or a filter that was assigned to, may take the place of a filter in a tree that was already compiled, so both count
+		// as a modification. The compiled program isn't copied, it's compiled again on the next match
+		GeneralFilter() : m_CompiledFilterVersion(0) { filterChanged(); }
+		GeneralFilter(const GeneralFilter&) : m_CompiledFilterVersion(0) { filterChanged(); }
+		GeneralFilter& operator=(const GeneralFilter&) { m_CompiledFilterVersion = 0; filterChanged(); return *this; }
 
 		/**
 		 * Virtual destructor, frees the bpf program
@@ -207,7 +374,7 @@ namespace pcpp
 		 * Set the direction for the filter (source or destination)
 		 * @param[in] dir The direction
 		 */
-		void setDirection(Direction dir) { m_Dir = dir; }
+		void setDirection(Direction dir) { m_Dir = dir; filterChanged(); }
 	};
 
 
@@ -230,7 +397,7 @@ namespace pcpp
 		 * Set the operator for the filter
 		 * @param[in] op The operator to set
 		 */
-		void setOperator(FilterOperator op) { m_Operator = op; }
+		void setOperator(FilterOperator op) { m_Operator = op; filterChanged(); }
 	};
 
 
@@ -249,6 +416,7 @@ namespace pcpp
 		int m_Len;
 		void convertToIPAddressWithMask(std::string& ipAddrmodified, std::string& mask) const;
 		void convertToIPAddressWithLen(std::string& ipAddrmodified) const;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * The basic constructor that creates the filter from an IPv4 address and direction (source or destination)
@@ -287,19 +455,19 @@ namespace pcpp
 		 * @param[in] ipAddress The IPv4 address to build the filter with. If this address is not a valid IPv4 address an error will be
 		 * written to log and parsing this filter will fail
 		 */
-		void setAddr(const std::string& ipAddress) { m_Address = ipAddress; }
+		void setAddr(const std::string& ipAddress) { m_Address = ipAddress; filterChanged(); }
 
 		/**
 		 * Set the IPv4 mask
 		 * @param[in] ipv4Mask The mask to use. Mask should also be in a valid IPv4 format (i.e x.x.x.x), otherwise parsing this filter will fail
 		 */
-		void setMask(const std::string& ipv4Mask) { m_IPv4Mask = ipv4Mask; m_Len = 0; }
+		void setMask(const std::string& ipv4Mask) { m_IPv4Mask = ipv4Mask; m_Len = 0; filterChanged(); }
 
 		/**
 		 * Set the subnet
 		 * @param[in] len The subnet to use (e.g "/24")
 		 */
-		void setLen(int len) { m_IPv4Mask = ""; m_Len = len; }
+		void setLen(int len) { m_IPv4Mask = ""; m_Len = len; filterChanged(); }
 	};
 
 
@@ -314,6 +482,7 @@ namespace pcpp
 	{
 	private:
 		uint16_t m_IpID;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor that gets the IP ID to filter and the operator and creates the filter out of them
@@ -328,7 +497,7 @@ namespace pcpp
 		 * Set the IP ID to filter
 		 * @param[in] ipID The IP ID to filter
 		 */
-		void setIpID(uint16_t ipID) { m_IpID = ipID; }
+		void setIpID(uint16_t ipID) { m_IpID = ipID; filterChanged(); }
 	};
 
 
@@ -343,6 +512,7 @@ namespace pcpp
 	{
 	private:
 		uint16_t m_TotalLength;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor that gets the total length to filter and the operator and creates the filter out of them
@@ -357,7 +527,7 @@ namespace pcpp
 		 * Set the total length value
 		 * @param[in] totalLength The total length value to filter
 		 */
-		void setTotalLength(uint16_t totalLength) { m_TotalLength = totalLength; }
+		void setTotalLength(uint16_t totalLength) { m_TotalLength = totalLength; filterChanged(); }
 	};
 
 
@@ -372,6 +542,7 @@ namespace pcpp
 	private:
 		std::string m_Port;
 		void portToString(uint16_t portAsInt);
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor that gets the port and the direction and creates the filter
@@ -386,7 +557,7 @@ namespace pcpp
 		 * Set the port
 		 * @param[in] port The port to create the filter with
 		 */
-		void setPort(uint16_t port) { portToString(port); }
+		void setPort(uint16_t port) { portToString(port); filterChanged(); }
 	};
 
 
@@ -402,6 +573,7 @@ namespace pcpp
 	private:
 		uint16_t m_FromPort;
 		uint16_t m_ToPort;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor that gets the port range the the direction and creates the filter with them
@@ -417,13 +589,13 @@ namespace pcpp
 		 * Set the lower end of the port range
 		 * @param[in] fromPort The lower end of the port range
 		 */
-		void setFromPort(uint16_t fromPort) { m_FromPort = fromPort; }
+		void setFromPort(uint16_t fromPort) { m_FromPort = fromPort; filterChanged(); }
 
 		/**
 		 * Set the higher end of the port range
 		 * @param[in] toPort The higher end of the port range
 		 */
-		void setToPort(uint16_t toPort) { m_ToPort = toPort; }
+		void setToPort(uint16_t toPort) { m_ToPort = toPort; filterChanged(); }
 	};
 
 
@@ -437,6 +609,7 @@ namespace pcpp
 	{
 	private:
 		MacAddress m_MacAddress;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor that gets the MAC address and the direction and creates the filter with them
@@ -451,7 +624,7 @@ namespace pcpp
 		 * Set the MAC address
 		 * @param[in] address The MAC address to use for filtering
 		 */
-		void setMacAddress(MacAddress address) { m_MacAddress = address; }
+		void setMacAddress(MacAddress address) { m_MacAddress = address; filterChanged(); }
 	};
 
 
@@ -466,6 +639,7 @@ namespace pcpp
 	{
 	private:
 		uint16_t m_EtherType;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor that gets the EtherType and creates the filter with it
@@ -479,7 +653,7 @@ namespace pcpp
 		 * Set the EtherType value
 		 * @param[in] etherType The EtherType value to create the filter with
 		 */
-		void setEtherType(uint16_t etherType) { m_EtherType = etherType; }
+		void setEtherType(uint16_t etherType) { m_EtherType = etherType; filterChanged(); }
 	};
 
 
@@ -496,6 +670,7 @@ namespace pcpp
 	{
 	private:
 		std::vector<GeneralFilter*> m_FilterList;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 
 		/**
@@ -513,7 +688,7 @@ namespace pcpp
 		 * Add filter to the and condition
 		 * @param[in] filter The filter to add
 		 */
-		void addFilter(GeneralFilter* filter) { m_FilterList.push_back(filter); }
+		void addFilter(GeneralFilter* filter) { m_FilterList.push_back(filter); filterChanged(); }
 
 		/**
 		 * Remove the current filters and set new ones
@@ -538,6 +713,7 @@ namespace pcpp
 	{
 	private:
 		std::vector<GeneralFilter*> m_FilterList;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 
 		/**
@@ -555,7 +731,7 @@ namespace pcpp
 		 * Add filter to the or condition
 		 * @param[in] filter The filter to add
 		 */
-		void addFilter(GeneralFilter* filter) { m_FilterList.push_back(filter); }
+		void addFilter(GeneralFilter* filter) { m_FilterList.push_back(filter); filterChanged(); }
 
 		void parseToString(std::string& result);
 	};
@@ -571,6 +747,7 @@ namespace pcpp
 	{
 	private:
 		GeneralFilter* m_FilterToInverse;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor that gets a pointer to a filter and create the inverse version of it
@@ -584,7 +761,7 @@ namespace pcpp
 		 * Set a filter to create an inverse filter from
 		 * @param[in] filterToInverse A pointer to filter which the created filter be the inverse of
 		 */
-		void setFilter(GeneralFilter* filterToInverse) { m_FilterToInverse = filterToInverse; }
+		void setFilter(GeneralFilter* filterToInverse) { m_FilterToInverse = filterToInverse; filterChanged(); }
 	};
 
 
@@ -600,6 +777,7 @@ namespace pcpp
 	{
 	private:
 		ProtocolType m_Proto;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor that gets the protocol and creates the filter
@@ -615,7 +793,7 @@ namespace pcpp
 		 * @param[in] proto The protocol to filter, only packets matching this protocol will be received. Please note not all protocols are
 		 * supported. List of supported protocols is found in the class description
 		 */
-		void setProto(ProtocolType proto) { m_Proto = proto; }
+		void setProto(ProtocolType proto) { m_Proto = proto; filterChanged(); }
 	};
 
 
@@ -630,6 +808,7 @@ namespace pcpp
 	{
 	private:
 		ArpOpcode m_OpCode;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor that get the ARP opcode and creates the filter
@@ -643,7 +822,7 @@ namespace pcpp
 		 * Set the ARP opcode
 		 * @param[in] opCode The ARP opcode: ::ARP_REQUEST or ::ARP_REPLY
 		 */
-		void setOpCode(ArpOpcode opCode) { m_OpCode = opCode; }
+		void setOpCode(ArpOpcode opCode) { m_OpCode = opCode; filterChanged(); }
 	};
 
 
@@ -658,6 +837,7 @@ namespace pcpp
 	{
 	private:
 		uint16_t m_VlanID;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor the gets the VLAN ID and creates the filter
@@ -671,7 +851,7 @@ namespace pcpp
 		 * Set the VLAN ID of the filter
 		 * @param[in] vlanId The VLAN ID to use for the filter
 		 */
-		void setVlanID(uint16_t vlanId) { m_VlanID = vlanId; }
+		void setVlanID(uint16_t vlanId) { m_VlanID = vlanId; filterChanged(); }
 	};
 
 
@@ -717,6 +897,7 @@ namespace pcpp
 	private:
 		uint8_t m_TcpFlagsBitMask;
 		MatchOptions m_MatchOption;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor that gets a 1-byte bitmask containing all TCP flags participating in the filter and the match option, and
@@ -733,7 +914,7 @@ namespace pcpp
 		 * following value for example: TcpFlagsFilter::tcpSyn | TcpFlagsFilter::tcpAck | TcpFlagsFilter::tcpUrg
 		 * @param[in] matchOption The match option: TcpFlagsFilter::MatchAll or TcpFlagsFilter::MatchOneAtLeast
 		 */
-		void setTcpFlagsBitMask(uint8_t tcpFlagBitMask, MatchOptions matchOption) { m_TcpFlagsBitMask = tcpFlagBitMask; m_MatchOption = matchOption; }
+		void setTcpFlagsBitMask(uint8_t tcpFlagBitMask, MatchOptions matchOption) { m_TcpFlagsBitMask = tcpFlagBitMask; m_MatchOption = matchOption; filterChanged(); }
 
 		void parseToString(std::string& result);
 	};
@@ -749,6 +930,7 @@ namespace pcpp
 	{
 	private:
 		uint16_t m_WindowSize;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor that get the window-size and operator and creates the filter. For example: "filter all TCP packets with window-size
@@ -764,7 +946,7 @@ namespace pcpp
 		 * Set window-size value
 		 * @param[in] windowSize The window-size value that will be used in the filter
 		 */
-		void setWindowSize(uint16_t windowSize) { m_WindowSize = windowSize; }
+		void setWindowSize(uint16_t windowSize) { m_WindowSize = windowSize; filterChanged(); }
 	};
 
 
@@ -778,6 +960,7 @@ namespace pcpp
 	{
 	private:
 		uint16_t m_Length;
+		bool compileNative(CompiledFilter::Builder& builder, int& nodeIndex);
 	public:
 		/**
 		 * A constructor that get the UDP length and operator and creates the filter. For example: "filter all UDP packets with length
@@ -793,7 +976,7 @@ namespace pcpp
 		 * Set length value
 		 * @param[in] length The length value that will be used in the filter
 		 */
-		void setLength(uint16_t length) { m_Length = length; }
+		void setLength(uint16_t length) { m_Length = length; filterChanged(); }
 	};
 
 } // namespace pcpp
@@ -47,6 +47,17 @@ namespace pcpp
 	 */
 	typedef bool (*OnPacketArrivesStopBlocking)(RawPacket* pPacket, PcapLiveDevice* pDevice, void* userCookie);
 
+	/**
+	 * @typedef OnPacketsArriveCallback
+	 * A callback that is called with a burst of packets captured by PcapLiveDevice. The packets and their data are owned by the device and are
+	 * valid only until the callback returns, so packets that should be kept must be copied
+	 * @param[in] packets A pointer to an array of raw packets
+	 * @param[in] numOfPackets The length of the array
+	 * @param[in] pDevice A pointer to the PcapLiveDevice instance
+	 * @param[in] userCookie A pointer to the object put by the user when packet capturing stared
+	 */
+	typedef void (*OnPacketsArriveCallback)(RawPacket* packets, uint32_t numOfPackets, PcapLiveDevice* pDevice, void* userCookie);
+
 
 	/**
 	 * @typedef OnStatsUpdateCallback
@@ -109,6 +120,10 @@ namespace pcpp
 		RawPacketVector* m_CapturedPackets;
 		bool m_CaptureCallbackMode;
 		LinkLayerType m_LinkType;
+		OnPacketsArriveCallback m_cbOnPacketsArrive;
+		void* m_cbOnPacketsArriveUserCookie;
+		class BurstBuffer;
+		BurstBuffer* m_BurstBuffer;
 
 		// c'tor is not public, there should be only one for every interface (created by PcapLiveDeviceList)
 		PcapLiveDevice(pcap_if_t* pInterface, bool calculateMTU, bool calculateMacAddress, bool calculateDefaultGateway);
@@ -127,8 +142,14 @@ namespace pcpp
 		static void onPacketArrives(uint8_t* user, const struct pcap_pkthdr* pkthdr, const uint8_t* packet);
 		static void onPacketArrivesNoCallback(uint8_t* user, const struct pcap_pkthdr* pkthdr, const uint8_t* packet);
 		static void onPacketArrivesBlockingMode(uint8_t* user, const struct pcap_pkthdr* pkthdr, const uint8_t* packet);
+		static void onPacketArrivesBurstMode(uint8_t* user, const struct pcap_pkthdr* pkthdr, const uint8_t* packet);
 	public:
 
+		/**
+		 * The default maximum number of packets handed to the callback given to startCaptureBurst()
+		 */
+		static const int DefaultMaxBurstSize = 64;
+
 		/**
 		 * The type of the live device
 		 */
@@ -389,6 +410,25 @@ namespace pcpp
 		 */
 		virtual bool startCapture(RawPacketVector& capturedPacketsVector);
 
+		/**
+		 * Start capturing packets on this network interface (device) in bursts. Instead of calling a callback for every packet, the packets
+		 * that libpcap returns in each read (up to maxBurstSize packets) are handed to the onPacketsArrive callback as one array. The packet data
+		 * is copied to a buffer that is reused by all bursts, so once the buffer grew to fit the largest burst no memory is allocated during the
+		 * capture. The capture is done on a new thread created by this method and stops when calling stopCapture(). This method must be called
+		 * after the device is opened (i.e the open() method was called), otherwise an error will be returned.
+		 * @param[in] onPacketsArrive A callback that is called with each burst of captured packets. The packets are valid only until the
+		 * callback returns
+		 * @param[in] onPacketsArriveUserCookie A pointer to a user provided object. This object will be transferred to the onPacketsArrive callback
+		 * each time it is called. This cookie is very useful for transferring objects that give context to the capture callback, for example:
+		 * objects that counts packets, manages flow state or manages the application state according to the packet that was captured
+		 * @param[in] maxBurstSize The maximum number of packets in each burst. The default is DefaultMaxBurstSize
+		 * @return True if capture started successfully, false if (relevant log error is printed in any case):
+		 * - Capture is already running
+		 * - Device is not opened
+		 * - The callback is null or maxBurstSize isn't positive
+		 */
+		virtual bool startCaptureBurst(OnPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie, int maxBurstSize = DefaultMaxBurstSize);
+
 		/**
 		 * Start capturing packets on this network interface (device) in blocking mode, meaning this method blocks and won't return until
 		 * the user frees the blocking (via onPacketArrives callback) or until a user defined timeout expires.
@@ -56,6 +56,41 @@ namespace pcpp
 			RecvError = 3
 		};
 
+		/**
+		 * @struct RxRingConfiguration
+		 * Configuration of the memory-mapped receive ring used when opening the device with open(const RxRingConfiguration&). The ring
+		 * is made of blocks the kernel fills with packets and hands over to the user as a whole, so packets are read directly from
+		 * shared memory without any system call or copy per packet. Please refer to the Linux kernel documentation of PACKET_MMAP
+		 * (TPACKET_V3) for more details
+		 */
+		struct RxRingConfiguration
+		{
+			/**
+			 * The size in bytes of each block in the ring. Must be a multiple of the system page size. The default is 1MB
+			 */
+			uint32_t blockSize;
+
+			/**
+			 * The number of blocks in the ring. The default is 64
+			 */
+			uint32_t numOfBlocks;
+
+			/**
+			 * The maximum time in milliseconds the kernel waits before handing over a block that isn't full to the user. Lower values
+			 * lower latency on low traffic rates. The default is 10ms
+			 */
+			uint32_t blockTimeoutMs;
+
+			/**
+			 * A c'tor for this struct
+			 * @param[in] blockSize The size in bytes of each block in the ring. The default is 1MB
+			 * @param[in] numOfBlocks The number of blocks in the ring. The default is 64
+			 * @param[in] blockTimeoutMs The maximum time in milliseconds the kernel waits before handing over a block that isn't full. The default is 10ms
+			 */
+			explicit RxRingConfiguration(uint32_t blockSize = 1 << 20, uint32_t numOfBlocks = 64, uint32_t blockTimeoutMs = 10) :
+				blockSize(blockSize), numOfBlocks(numOfBlocks), blockTimeoutMs(blockTimeoutMs) {}
+		};
+
 		/*
 		 * A c'tor for this class. This c'tor doesn't create the raw socket, but rather initializes internal structures. The actual
 		 * raw socket creation is done in the open() method. Each raw socket is bound to a network interface which means
@@ -83,6 +118,10 @@ namespace pcpp
 		 * There is a slight difference on this method's behavior between Windows and Linux around how packets are received.
 		 * On Linux the received packet contains all layers starting from the L2 (Ethernet). However on Windows raw socket are
 		 * integrated in L3 level so the received packet contains only L3 (IP) layer and up.
+		 *
+		 * If the device was opened with a receive ring (see open(const RxRingConfiguration&)) the packet data isn't copied: rawPacket
+		 * points directly into the ring and doesn't own its data. The data remains valid until the next call to one of the receive
+		 * methods, so if it's needed for longer it has to be copied (for example by copying the RawPacket object)
 		 * @param[out] rawPacket An empty packet instance where the received packet data will be written to
 		 * @param[in] blocking Indicates whether to run in blocking or non-blocking mode. Default value is blocking
 		 * @param[in] timeout When in blocking mode, specifies the timeout [in seconds] to wait for a packet. If timeout expired
@@ -100,7 +139,8 @@ namespace pcpp
 		/**
 		 * Receive packets into a packet vector for a certain amount of time. This method starts a timer and invokes the
 		 * receivePacket() method in blocking mode repeatedly until the timeout expires. All packets received successfully are
-		 * put into a packet vector
+		 * put into a packet vector. If the device was opened with a receive ring the packets are copied out of the ring, so they
+		 * remain valid as long as the vector holds them
 		 * @param[out] packetVec The packet vector to add the received packet to
 		 * @param[in] timeout Timeout in seconds to receive packets on the raw socket
 		 * @param[out] failedRecv Number of receive attempts that failed
@@ -108,6 +148,22 @@ namespace pcpp
 		 */
 		int receivePackets(RawPacketVector& packetVec, int timeout, int& failedRecv);
 
+		/**
+		 * Receive a batch of packets into an array of RawPacket objects. The method waits for the first packet according to the
+		 * blocking and timeout parameters (the same way receivePacket() does), and then fills the array with all other packets
+		 * that are already available without waiting any further.
+		 * If the device was opened with a receive ring, packets are taken from a single block of the ring and aren't copied, so
+		 * they remain valid only until the next call to one of the receive methods (see receivePacket() for more details)
+		 * @param[out] rawPacketsArr An array of RawPacket objects to write the received packets to
+		 * @param[in] rawPacketArrLength The length of the array
+		 * @param[in] blocking Indicates whether to wait for the first packet or not. Default value is blocking
+		 * @param[in] timeout When in blocking mode, specifies the timeout [in seconds] to wait for the first packet. Zero or
+		 * negative values mean no timeout. The default value is no timeout
+		 * @return The number of packets received, or 0 if no packets were received (because of timeout, nothing to receive in
+		 * non-blocking mode or an error, in which case an error is logged)
+		 */
+		int receivePackets(RawPacket* rawPacketsArr, int rawPacketArrLength, bool blocking = true, int timeout = -1);
+
 		/**
 		 * Send an Ethernet packet to the network. L2 protocols other than Ethernet are not supported in raw sockets.
 		 * The entire packet is sent as is, including the original Ethernet and IP data.
@@ -121,14 +177,34 @@ namespace pcpp
 
 		/**
 		 * Send a set of Ethernet packets to the network. L2 protocols other than Ethernet are not supported by raw sockets.
-		 * The entire packet is sent as is, including the original Ethernet and IP data.
+		 * The entire packet is sent as is, including the original Ethernet and IP data. Packets are sent in batches with a single
+		 * system call per batch (sendmmsg), and packets whose link type isn't Ethernet are skipped.
 		 * This method is only supported in Linux as Windows doesn't allow sending packets from raw sockets. Using it from
 		 * other platforms will return "false" with an appropriate error log message
+		 * If the socket's send buffer or the device queue is full (EAGAIN/ENOBUFS) the rest of the batch is retried for a short
+		 * while. If the socket is still full after that, sending stops and the rest of the packets aren't sent. Packets that fail
+		 * with other errors are skipped
 		 * @param[in] packetVec The set of packets to send
-		 * @return The number of packets sent successfully. For packets that weren't sent successfully there will be a
-		 * corresponding error message printed to log
+		 * @param[out] numOfPacketsHandled If not null, set to the number of packets from the start of the set that were sent or
+		 * skipped. If sending stopped because the socket stayed full, the packets from this index onwards weren't sent and can be
+		 * sent again later
+		 * @return The number of packets actually sent, which is less than the number of packets in the set if some of them
+		 * weren't Ethernet packets or couldn't be sent. For packets that couldn't be sent there will be a corresponding error
+		 * message printed to log
+		 */
+		int sendPackets(const RawPacketVector& packetVec, int* numOfPacketsHandled = nullptr);
+
+		/**
+		 * Send an array of Ethernet packets to the network. This method behaves the same as sendPackets(const RawPacketVector&),
+		 * but takes the packets from an array, which is convenient for replaying packets received with
+		 * receivePackets(RawPacket*, int, bool, int)
+		 * @param[in] rawPacketsArr The array of packets to send
+		 * @param[in] rawPacketArrLength The length of the array
+		 * @param[out] numOfPacketsHandled If not null, set to the number of packets from the start of the array that were sent
+		 * or skipped. The packets from this index onwards weren't sent
+		 * @return The number of packets actually sent
 		 */
-		int sendPackets(const RawPacketVector& packetVec);
+		int sendPackets(const RawPacket* rawPacketsArr, int rawPacketArrLength, int* numOfPacketsHandled = nullptr);
 
 		// overridden methods
 
@@ -138,6 +214,20 @@ namespace pcpp
 		 */
 		virtual bool open();
 
+		/**
+		 * Open the device the same way open() does, and set up a memory-mapped receive ring (PACKET_MMAP with TPACKET_V3) for
+		 * receiving packets. In this mode packets are read directly from memory shared with the kernel, which allows receiving
+		 * at much higher rates. Sending packets isn't affected. This mode is supported on Linux only
+		 * @param[in] rxRingConfig The configuration of the receive ring
+		 * @return True if device was opened successfully, false otherwise with a corresponding error log message
+		 */
+		bool open(const RxRingConfiguration& rxRingConfig);
+
+		/**
+		 * @return True if the device is open and receives packets through a memory-mapped receive ring, false otherwise
+		 */
+		bool isRxRingEnabled() const;
+
 		/**
 		 * Close the raw socket
 		 */
@@ -157,6 +247,10 @@ namespace pcpp
 		IPAddress m_InterfaceIP;
 
 		RecvPacketResult getError(int& errorCode) const;
+		bool setReceiveMode(bool blocking, int timeout);
+		RecvPacketResult waitForRxRingBlock(bool blocking, int timeout);
+		void fillPacketFromRxRing(RawPacket& rawPacket);
+		int sendPacketBatch(const RawPacket** rawPackets, int numOfPackets, int& numOfPacketsHandled);
 
 	};
 }
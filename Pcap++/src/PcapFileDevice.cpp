@@ -3,13 +3,27 @@
 #include <stdio.h>
 #include <cerrno>
 #include "PcapFileDevice.h"
+#include "light_pcapng.h"
 #include "light_pcapng_ext.h"
 #include "Logger.h"
 #include "TimespecTimeval.h"
 #include "pcap.h"
 #include <string.h>
 #include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "EndianPortable.h"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace pcpp
 {
@@ -76,6 +90,31 @@ IFileReaderDevice::IFileReaderDevice(const std::string& fileName) : IFileDevice(
 {
 	m_NumOfPacketsNotParsed = 0;
 	m_NumOfPacketsRead = 0;
+	m_PacketDataMode = CopyPacketData;
+}
+
+bool IFileReaderDevice::setPacketData(RawPacket& rawPacket, const uint8_t* data, int dataLen, timespec timestamp, LinkLayerType linkType, int frameLength)
+{
+	if (m_PacketDataMode == CopyPacketData)
+	{
+		uint8_t* packetData = new uint8_t[dataLen];
+		memcpy(packetData, data, dataLen);
+		if (!rawPacket.setRawData(packetData, dataLen, timestamp, linkType, frameLength, true))
+		{
+			delete [] packetData;
+			return false;
+		}
+		return true;
+	}
+
+	if (m_PacketDataMode == ZeroCopyPacketData)
+		return rawPacket.setRawData(data, dataLen, timestamp, linkType, frameLength, false);
+
+	// ReusePacketBuffer mode
+	if (m_PacketBuffer.size() < (size_t)dataLen)
+		m_PacketBuffer.resize(dataLen);
+	memcpy(m_PacketBuffer.data(), data, dataLen);
+	return rawPacket.setRawData(m_PacketBuffer.data(), dataLen, timestamp, linkType, frameLength, false);
 }
 
 IFileReaderDevice* IFileReaderDevice::getReader(const std::string& fileName)
@@ -101,6 +140,10 @@ int IFileReaderDevice::getNextPackets(RawPacketVector& packetVec, int numOfPacke
 {
 	int numOfPacketsRead = 0;
 
+	// each packet in the vector must own its data
+	PacketDataMode origMode = m_PacketDataMode;
+	m_PacketDataMode = CopyPacketData;
+
 	for (; numOfPacketsToRead < 0 || numOfPacketsRead < numOfPacketsToRead; numOfPacketsRead++)
 	{
 		RawPacket* newPacket = new RawPacket();
@@ -116,6 +159,7 @@ int IFileReaderDevice::getNextPackets(RawPacketVector& packetVec, int numOfPacke
 		}
 	}
 
+	m_PacketDataMode = origMode;
 	return numOfPacketsRead;
 }
 
@@ -205,15 +249,31 @@ bool SnoopFileReaderDevice::getNextPacket(RawPacket& rawPacket)
 	if(packetSize > 15000) {
 		return false;
 	}
-	char* packetData = new char[packetSize];
+	// there is no internal buffer to borrow data from, so in both non-copy modes the packet is read directly into the reader's buffer
+	bool ownPacketData = (m_PacketDataMode == CopyPacketData);
+	char* packetData;
+	if (ownPacketData)
+	{
+		packetData = new char[packetSize];
+	}
+	else
+	{
+		if (m_PacketBuffer.size() < packetSize)
+			m_PacketBuffer.resize(packetSize);
+		packetData = (char*)m_PacketBuffer.data();
+	}
 	m_snoopFile.read(packetData, packetSize);
 	if(!m_snoopFile) {
+		if (ownPacketData)
+			delete [] packetData;
 		return false;
 	}
 	timespec ts = { static_cast<time_t>(be32toh(snoop_packet_header.time_sec)), static_cast<long>(be32toh(snoop_packet_header.time_usec)) * 1000 };
-	if (!rawPacket.setRawData((const uint8_t*)packetData, packetSize, ts, static_cast<LinkLayerType>(m_PcapLinkLayerType)))
+	if (!rawPacket.setRawData((const uint8_t*)packetData, packetSize, ts, static_cast<LinkLayerType>(m_PcapLinkLayerType), -1, ownPacketData))
 	{
 		PCPP_LOG_ERROR("Couldn't set data to raw packet");
+		if (ownPacketData)
+			delete [] packetData;
 		return false;
 	}
 	size_t pad = be32toh(snoop_packet_header.packet_record_length) - (sizeof(snoop_packet_header_t) + be32toh(snoop_packet_header.included_length));
@@ -304,14 +364,13 @@ bool PcapFileReaderDevice::getNextPacket(RawPacket& rawPacket)
 		return false;
 	}
 
-	uint8_t* pMyPacketData = new uint8_t[pkthdr.caplen];
-	memcpy(pMyPacketData, pPacketData, pkthdr.caplen);
 #if defined(PCAP_TSTAMP_PRECISION_NANO)
 	timespec ts = { pkthdr.ts.tv_sec, static_cast<long>(pkthdr.ts.tv_usec) }; //because we opened with nano second precision 'tv_usec' is actually nanos
 #else
-	struct timeval ts = pkthdr.ts;
+	timespec ts;
+	TIMEVAL_TO_TIMESPEC(&pkthdr.ts, &ts);
 #endif
-	if (!rawPacket.setRawData(pMyPacketData, pkthdr.caplen, ts, static_cast<LinkLayerType>(m_PcapLinkLayerType), pkthdr.len))
+	if (!setPacketData(rawPacket, pPacketData, pkthdr.caplen, ts, static_cast<LinkLayerType>(m_PcapLinkLayerType), pkthdr.len))
 	{
 		PCPP_LOG_ERROR("Couldn't set data to raw packet");
 		return false;
@@ -321,6 +380,343 @@ bool PcapFileReaderDevice::getNextPacket(RawPacket& rawPacket)
 }
 
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// PcapMmapFileReaderDevice members
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static const uint32_t PcapMagicMicroSec = 0xa1b2c3d4;
+static const uint32_t PcapMagicNanoSec = 0xa1b23c4d;
+// records with a captured length larger than this value are considered corrupted (the same limit libpcap uses)
+static const uint32_t PcapMaxRecordLength = 262144;
+
+static inline uint32_t swapUInt32(uint32_t value)
+{
+	return ((value & 0xff) << 24) | ((value & 0xff00) << 8) | ((value & 0xff0000) >> 8) | ((value & 0xff000000) >> 24);
+}
+
+PcapMmapFileReaderDevice::PcapMmapFileReaderDevice(const std::string& fileName) : IFileReaderDevice(fileName)
+{
+	m_PcapLinkLayerType = LINKTYPE_ETHERNET;
+	m_MappedData = nullptr;
+	m_MappedSize = 0;
+	m_CurOffset = 0;
+	m_SnapLen = 0;
+	m_SwapBytes = false;
+	m_NanoSecPrecision = false;
+	m_PacketDataMode = ZeroCopyPacketData;
+#if defined(_WIN32)
+	m_FileHandle = INVALID_HANDLE_VALUE;
+	m_MappingHandle = nullptr;
+#else
+	m_FileDescriptor = -1;
+#endif
+}
+
+bool PcapMmapFileReaderDevice::open()
+{
+	m_NumOfPacketsRead = 0;
+	m_NumOfPacketsNotParsed = 0;
+
+	if (m_MappedData != nullptr)
+	{
+		PCPP_LOG_DEBUG("File already mapped. Nothing to do");
+		return true;
+	}
+
+#if defined(_WIN32)
+	m_FileHandle = CreateFileA(m_FileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_FileHandle == INVALID_HANDLE_VALUE)
+	{
+		PCPP_LOG_ERROR("Cannot open file '" << m_FileName << "', error code: " << GetLastError());
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(m_FileHandle, &fileSize))
+	{
+		PCPP_LOG_ERROR("Cannot get the size of file '" << m_FileName << "', error code: " << GetLastError());
+		close();
+		return false;
+	}
+	m_MappedSize = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+	m_FileDescriptor = ::open(m_FileName.c_str(), O_RDONLY);
+	if (m_FileDescriptor < 0)
+	{
+		PCPP_LOG_ERROR("Cannot open file '" << m_FileName << "': " << strerror(errno));
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(m_FileDescriptor, &fileStat) != 0)
+	{
+		PCPP_LOG_ERROR("Cannot get the size of file '" << m_FileName << "': " << strerror(errno));
+		close();
+		return false;
+	}
+	m_MappedSize = static_cast<uint64_t>(fileStat.st_size);
+#endif
+
+	if (m_MappedSize < sizeof(pcap_file_header))
+	{
+		PCPP_LOG_ERROR("File '" << m_FileName << "' is too small to be a pcap file");
+		close();
+		return false;
+	}
+
+	if (m_MappedSize > static_cast<uint64_t>(SIZE_MAX))
+	{
+		PCPP_LOG_ERROR("File '" << m_FileName << "' is too large to be mapped on this platform");
+		close();
+		return false;
+	}
+
+#if defined(_WIN32)
+	m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_MappingHandle != nullptr)
+		m_MappedData = static_cast<const uint8_t*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (m_MappedData == nullptr)
+	{
+		PCPP_LOG_ERROR("Cannot map file '" << m_FileName << "', error code: " << GetLastError());
+		close();
+		return false;
+	}
+#else
+	void* mappedData = mmap(nullptr, static_cast<size_t>(m_MappedSize), PROT_READ, MAP_SHARED, m_FileDescriptor, 0);
+	if (mappedData == MAP_FAILED)
+	{
+		PCPP_LOG_ERROR("Cannot map file '" << m_FileName << "': " << strerror(errno));
+		close();
+		return false;
+	}
+	m_MappedData = static_cast<const uint8_t*>(mappedData);
+	madvise(mappedData, static_cast<size_t>(m_MappedSize), MADV_SEQUENTIAL);
+#endif
+
+	pcap_file_header fileHeader;
+	memcpy(&fileHeader, m_MappedData, sizeof(fileHeader));
+	if (fileHeader.magic == PcapMagicMicroSec || fileHeader.magic == PcapMagicNanoSec)
+	{
+		m_SwapBytes = false;
+	}
+	else if (swapUInt32(fileHeader.magic) == PcapMagicMicroSec || swapUInt32(fileHeader.magic) == PcapMagicNanoSec)
+	{
+		m_SwapBytes = true;
+		fileHeader.magic = swapUInt32(fileHeader.magic);
+		fileHeader.snaplen = swapUInt32(fileHeader.snaplen);
+		fileHeader.linktype = swapUInt32(fileHeader.linktype);
+	}
+	else
+	{
+		PCPP_LOG_ERROR("File '" << m_FileName << "' is not a pcap file");
+		close();
+		return false;
+	}
+
+	m_NanoSecPrecision = (fileHeader.magic == PcapMagicNanoSec);
+	m_SnapLen = fileHeader.snaplen;
+
+	// the upper 16 bits of the link type field may contain additional information (FCS length)
+	int linkLayer = static_cast<int>(fileHeader.linktype & 0xffff);
+	if (!RawPacket::isLinkTypeValid(linkLayer))
+	{
+		PCPP_LOG_ERROR("Invalid link layer (" << linkLayer << ") for reader device filename '" << m_FileName << "'");
+		close();
+		return false;
+	}
+	m_PcapLinkLayerType = static_cast<LinkLayerType>(linkLayer);
+
+	m_CurOffset = sizeof(pcap_file_header);
+
+	PCPP_LOG_DEBUG("Successfully mapped file '" << m_FileName << "' of size " << m_MappedSize);
+	m_DeviceOpened = true;
+	return true;
+}
+
+void PcapMmapFileReaderDevice::close()
+{
+#if defined(_WIN32)
+	if (m_MappedData != nullptr)
+		UnmapViewOfFile(m_MappedData);
+	if (m_MappingHandle != nullptr)
+		CloseHandle(m_MappingHandle);
+	if (m_FileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(m_FileHandle);
+	m_MappingHandle = nullptr;
+	m_FileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (m_MappedData != nullptr)
+		munmap(const_cast<uint8_t*>(m_MappedData), static_cast<size_t>(m_MappedSize));
+	if (m_FileDescriptor >= 0)
+		::close(m_FileDescriptor);
+	m_FileDescriptor = -1;
+#endif
+
+	if (m_DeviceOpened)
+		PCPP_LOG_DEBUG("File reader closed for file '" << m_FileName << "'");
+
+	m_MappedData = nullptr;
+	m_MappedSize = 0;
+	m_CurOffset = 0;
+	m_DeviceOpened = false;
+}
+
+bool PcapMmapFileReaderDevice::readRecord(uint64_t& offset, uint64_t endOffset, const uint8_t*& data, uint32_t& capLen, uint32_t& origLen, timespec& timestamp) const
+{
+	if (offset >= endOffset || offset + sizeof(packet_header) > m_MappedSize)
+		return false;
+
+	packet_header recordHeader;
+	memcpy(&recordHeader, m_MappedData + offset, sizeof(recordHeader));
+	if (m_SwapBytes)
+	{
+		recordHeader.tv_sec = swapUInt32(recordHeader.tv_sec);
+		recordHeader.tv_usec = swapUInt32(recordHeader.tv_usec);
+		recordHeader.caplen = swapUInt32(recordHeader.caplen);
+		recordHeader.len = swapUInt32(recordHeader.len);
+	}
+
+	if (recordHeader.caplen > std::max(m_SnapLen, PcapMaxRecordLength))
+	{
+		PCPP_LOG_ERROR("Malformed packet record at offset " << offset << " of file '" << m_FileName << "'");
+		return false;
+	}
+
+	uint64_t recordEnd = offset + sizeof(packet_header) + recordHeader.caplen;
+	if (recordEnd > m_MappedSize)
+	{
+		PCPP_LOG_DEBUG("Packet record at offset " << offset << " is truncated");
+		return false;
+	}
+
+	data = m_MappedData + offset + sizeof(packet_header);
+	capLen = recordHeader.caplen;
+	origLen = recordHeader.len;
+	timestamp.tv_sec = recordHeader.tv_sec;
+	timestamp.tv_nsec = m_NanoSecPrecision ? recordHeader.tv_usec : static_cast<long>(recordHeader.tv_usec) * 1000;
+	offset = recordEnd;
+	return true;
+}
+
+bool PcapMmapFileReaderDevice::splitToRanges(size_t numOfRanges, std::vector<FileRange>& ranges) const
+{
+	ranges.clear();
+
+	if (m_MappedData == nullptr)
+	{
+		PCPP_LOG_ERROR("File device '" << m_FileName << "' not opened");
+		return false;
+	}
+
+	if (numOfRanges == 0)
+	{
+		PCPP_LOG_ERROR("Number of ranges must be greater than 0");
+		return false;
+	}
+
+	const uint64_t firstRecordOffset = sizeof(pcap_file_header);
+	const uint64_t dataSize = m_MappedSize - firstRecordOffset;
+
+	// walk the record headers from the beginning of the file, so boundaries are always at the beginning of a record and are found with
+	// the same rules the records are read with. Only the headers are read, the packet data is skipped
+	std::vector<uint64_t> boundaries;
+	boundaries.push_back(firstRecordOffset);
+	uint64_t offset = firstRecordOffset;
+	const uint8_t* data;
+	uint32_t capLen, origLen;
+	timespec timestamp;
+	bool endOfRecords = false;
+	for (size_t i = 1; i < numOfRanges && !endOfRecords; i++)
+	{
+		uint64_t desiredBoundary = firstRecordOffset + dataSize / numOfRanges * i;
+		while (offset < desiredBoundary)
+		{
+			if (!readRecord(offset, m_MappedSize, data, capLen, origLen, timestamp))
+			{
+				endOfRecords = true;
+				break;
+			}
+		}
+
+		// a large record may cover more than one desired boundary
+		if (!endOfRecords && offset < m_MappedSize && offset > boundaries.back())
+			boundaries.push_back(offset);
+	}
+	boundaries.push_back(m_MappedSize);
+
+	for (size_t i = 0; i + 1 < boundaries.size(); i++)
+	{
+		FileRange range = { boundaries[i], boundaries[i + 1] };
+		ranges.push_back(range);
+	}
+
+	return true;
+}
+
+PcapMmapFileReaderDevice::RangeReader PcapMmapFileReaderDevice::getRangeReader(const FileRange& range) const
+{
+	if (m_MappedData == nullptr)
+		return RangeReader(this, 0, 0);
+
+	return RangeReader(this, range.startOffset, std::min(range.endOffset, m_MappedSize));
+}
+
+bool PcapMmapFileReaderDevice::RangeReader::getNextPacket(RawPacket& rawPacket)
+{
+	const uint8_t* data;
+	uint32_t capLen, origLen;
+	timespec timestamp;
+	if (!m_Device->readRecord(m_CurOffset, m_EndOffset, data, capLen, origLen, timestamp))
+		return false;
+
+	m_NumOfPacketsRead++;
+	return rawPacket.setRawData(data, capLen, timestamp, m_Device->m_PcapLinkLayerType, origLen, false);
+}
+
+bool PcapMmapFileReaderDevice::getNextPacket(RawPacket& rawPacket)
+{
+	if (m_MappedData == nullptr)
+	{
+		PCPP_LOG_ERROR("File device '" << m_FileName << "' not opened");
+		return false;
+	}
+
+	const uint8_t* data;
+	uint32_t capLen, origLen;
+	timespec timestamp;
+	do
+	{
+		if (!readRecord(m_CurOffset, m_MappedSize, data, capLen, origLen, timestamp))
+		{
+			PCPP_LOG_DEBUG("Packet could not be read. Probably end-of-file");
+			return false;
+		}
+	} while (!m_BpfWrapper.matchPacketWithFilter(data, capLen, timestamp, m_PcapLinkLayerType));
+
+	if (!setPacketData(rawPacket, data, capLen, timestamp, m_PcapLinkLayerType, origLen))
+	{
+		PCPP_LOG_ERROR("Couldn't set data to raw packet");
+		return false;
+	}
+
+	m_NumOfPacketsRead++;
+	return true;
+}
+
+void PcapMmapFileReaderDevice::getStatistics(PcapStats& stats) const
+{
+	stats.packetsRecv = m_NumOfPacketsRead;
+	stats.packetsDrop = m_NumOfPacketsNotParsed;
+	stats.packetsDropByInterface = 0;
+	PCPP_LOG_DEBUG("Statistics received for reader device for filename '" << m_FileName << "'");
+}
+
+bool PcapMmapFileReaderDevice::setFilter(std::string filterAsString)
+{
+	return m_BpfWrapper.setFilter(filterAsString, m_PcapLinkLayerType);
+}
+
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // PcapNgFileReaderDevice members
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -383,9 +779,7 @@ bool PcapNgFileReaderDevice::getNextPacket(RawPacket& rawPacket, std::string& pa
 		}
 	}
 
-	uint8_t* myPacketData = new uint8_t[pktHeader.captured_length];
-	memcpy(myPacketData, pktData, pktHeader.captured_length);
-	if (!rawPacket.setRawData(myPacketData, pktHeader.captured_length, pktHeader.timestamp, static_cast<LinkLayerType>(pktHeader.data_link), pktHeader.original_length))
+	if (!setPacketData(rawPacket, pktData, pktHeader.captured_length, pktHeader.timestamp, static_cast<LinkLayerType>(pktHeader.data_link), pktHeader.original_length))
 	{
 		PCPP_LOG_ERROR("Couldn't set data to raw packet");
 		return false;
@@ -503,10 +897,256 @@ std::string PcapNgFileReaderDevice::getCaptureFileComment() const
 // IFileWriterDevice members
 // ~~~~~~~~~~~~~~~~~~~~~~~~~
 
+/**
+ * The state of the async writing mode. Packets are serialized into the front buffer by the threads that write them, while the writer thread
+ * writes the back buffer to the file. The writer thread swaps the buffers under the lock, so the threads that write packets never wait
+ * for disk I/O unless both buffers are full
+ */
+class IFileWriterDevice::AsyncWriter
+{
+public:
+	std::mutex mutex;
+	// wakes the writer thread when there's a batch to write
+	std::condition_variable writerCondition;
+	// wakes threads waiting for room in the queue or for a flush to end
+	std::condition_variable producerCondition;
+	std::thread thread;
+
+	uint8_t* frontBuffer;
+	size_t frontBufferLen;
+	size_t numOfPacketsInFrontBuffer;
+	uint8_t* backBuffer;
+	size_t backBufferLen;
+	size_t numOfPacketsInBackBuffer;
+	size_t bufferSize;
+
+	AsyncQueueFullPolicy policy;
+	int flushIntervalMs;
+	bool stopRequested;
+	bool flushRequested;
+	bool writeInProgress;
+	int numOfBlockedProducers;
+	AsyncWriterStats stats;
+
+	AsyncWriter(size_t bufferSize, AsyncQueueFullPolicy policy, int flushIntervalMs) :
+		frontBuffer(new uint8_t[bufferSize]), frontBufferLen(0), numOfPacketsInFrontBuffer(0),
+		backBuffer(new uint8_t[bufferSize]), backBufferLen(0), numOfPacketsInBackBuffer(0), bufferSize(bufferSize),
+		policy(policy), flushIntervalMs(flushIntervalMs), stopRequested(false), flushRequested(false), writeInProgress(false), numOfBlockedProducers(0)
+	{
+		memset(&stats, 0, sizeof(stats));
+	}
+
+	~AsyncWriter()
+	{
+		delete [] frontBuffer;
+		delete [] backBuffer;
+	}
+
+	bool isBatchReady() const
+	{
+		// blocked producers wake the writer thread only when there's something to write, otherwise it would keep the lock
+		// they wait for
+		return stopRequested || flushRequested || (numOfBlockedProducers > 0 && frontBufferLen > 0) || frontBufferLen >= bufferSize / 2;
+	}
+};
+
 IFileWriterDevice:: IFileWriterDevice(const std::string& fileName) : IFileDevice(fileName)
 {
 	m_NumOfPacketsNotWritten = 0;
 	m_NumOfPacketsWritten = 0;
+	m_AsyncWriter = nullptr;
+	m_AsyncWritingEnabled = false;
+}
+
+IFileWriterDevice::~IFileWriterDevice()
+{
+	// the writer thread calls methods of the derived class so it's stopped by the derived class d'tor
+	delete m_AsyncWriter;
+}
+
+bool IFileWriterDevice::startAsyncWriting(size_t bufferSize, AsyncQueueFullPolicy policy, int flushIntervalMs)
+{
+	if (!m_DeviceOpened)
+	{
+		PCPP_LOG_ERROR("Device not opened");
+		return false;
+	}
+
+	if (m_AsyncWritingEnabled)
+	{
+		PCPP_LOG_ERROR("Async writing is already enabled for '" << m_FileName << "'");
+		return false;
+	}
+
+	if (bufferSize == 0 || flushIntervalMs <= 0)
+	{
+		PCPP_LOG_ERROR("Async writing buffer size and flush interval must be greater than 0");
+		return false;
+	}
+
+	RawPacket emptyPacket;
+	if (getAsyncRecordSize(emptyPacket, std::string()) == 0)
+	{
+		PCPP_LOG_ERROR("Async writing isn't supported by the writer of '" << m_FileName << "'");
+		return false;
+	}
+
+	delete m_AsyncWriter;
+	m_AsyncWriter = new AsyncWriter(bufferSize, policy, flushIntervalMs);
+	m_AsyncWriter->thread = std::thread(&IFileWriterDevice::asyncWriterThreadMain, this);
+	m_AsyncWritingEnabled = true;
+	PCPP_LOG_DEBUG("Async writing started for '" << m_FileName << "'");
+	return true;
+}
+
+void IFileWriterDevice::stopAsyncWriting()
+{
+	if (!m_AsyncWritingEnabled)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_AsyncWriter->mutex);
+		m_AsyncWriter->stopRequested = true;
+	}
+	m_AsyncWriter->writerCondition.notify_one();
+	m_AsyncWriter->thread.join();
+
+	m_AsyncWritingEnabled = false;
+	PCPP_LOG_DEBUG("Async writing stopped for '" << m_FileName << "'");
+}
+
+void IFileWriterDevice::getAsyncWriterStats(AsyncWriterStats& stats) const
+{
+	if (m_AsyncWriter == nullptr)
+	{
+		memset(&stats, 0, sizeof(stats));
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_AsyncWriter->mutex);
+	stats = m_AsyncWriter->stats;
+	stats.queueDepthPackets = m_AsyncWriter->numOfPacketsInFrontBuffer + m_AsyncWriter->numOfPacketsInBackBuffer;
+	stats.queueDepthBytes = m_AsyncWriter->frontBufferLen + m_AsyncWriter->backBufferLen;
+}
+
+bool IFileWriterDevice::queuePacketForAsyncWrite(const RawPacket& packet, const std::string& comment)
+{
+	AsyncWriter* writer = m_AsyncWriter;
+	size_t recordSize = getAsyncRecordSize(packet, comment);
+
+	std::unique_lock<std::mutex> lock(writer->mutex);
+
+	if (recordSize > writer->bufferSize)
+	{
+		PCPP_LOG_ERROR("Packet of " << recordSize << " bytes doesn't fit in the async writing buffer of " << writer->bufferSize << " bytes");
+		writer->stats.packetsDropped++;
+		m_NumOfPacketsNotWritten++;
+		return false;
+	}
+
+	if (writer->frontBufferLen + recordSize > writer->bufferSize)
+	{
+		if (writer->policy == DropWhenQueueFull)
+		{
+			writer->stats.packetsDropped++;
+			m_NumOfPacketsNotWritten++;
+			return false;
+		}
+
+		writer->stats.numOfBlockedWrites++;
+		writer->numOfBlockedProducers++;
+		writer->writerCondition.notify_one();
+		writer->producerCondition.wait(lock, [writer, recordSize]() { return writer->frontBufferLen + recordSize <= writer->bufferSize; });
+		writer->numOfBlockedProducers--;
+	}
+
+	size_t prevFrontBufferLen = writer->frontBufferLen;
+	serializeAsyncRecord(packet, comment, writer->frontBuffer + prevFrontBufferLen);
+	writer->frontBufferLen += recordSize;
+	writer->numOfPacketsInFrontBuffer++;
+	writer->stats.packetsQueued++;
+	m_NumOfPacketsWritten++;
+
+	uint64_t queueDepth = writer->frontBufferLen + writer->backBufferLen;
+	if (queueDepth > writer->stats.maxQueueDepthBytes)
+		writer->stats.maxQueueDepthBytes = queueDepth;
+
+	// wake the writer thread once when the buffer becomes half full, otherwise it wakes up every flush interval
+	if (prevFrontBufferLen < writer->bufferSize / 2 && writer->frontBufferLen >= writer->bufferSize / 2)
+		writer->writerCondition.notify_one();
+
+	return true;
+}
+
+void IFileWriterDevice::waitForAsyncWrites()
+{
+	if (!m_AsyncWritingEnabled)
+		return;
+
+	AsyncWriter* writer = m_AsyncWriter;
+	std::unique_lock<std::mutex> lock(writer->mutex);
+	writer->flushRequested = true;
+	writer->writerCondition.notify_one();
+	writer->producerCondition.wait(lock, [writer]() { return writer->frontBufferLen == 0 && !writer->writeInProgress; });
+}
+
+void IFileWriterDevice::asyncWriterThreadMain()
+{
+	AsyncWriter* writer = m_AsyncWriter;
+	std::unique_lock<std::mutex> lock(writer->mutex);
+
+	while (true)
+	{
+		writer->writerCondition.wait_for(lock, std::chrono::milliseconds(writer->flushIntervalMs), [writer]() { return writer->isBatchReady(); });
+
+		if (writer->frontBufferLen == 0)
+		{
+			// nothing left to write, release threads waiting in flush()
+			if (writer->flushRequested)
+			{
+				writer->flushRequested = false;
+				writer->producerCondition.notify_all();
+			}
+
+			if (writer->stopRequested)
+				break;
+
+			continue;
+		}
+
+		std::swap(writer->frontBuffer, writer->backBuffer);
+		writer->backBufferLen = writer->frontBufferLen;
+		writer->numOfPacketsInBackBuffer = writer->numOfPacketsInFrontBuffer;
+		writer->frontBufferLen = 0;
+		writer->numOfPacketsInFrontBuffer = 0;
+		writer->writeInProgress = true;
+		writer->producerCondition.notify_all();
+
+		lock.unlock();
+		size_t numOfPacketsWritten = writeAsyncRecords(writer->backBuffer, writer->backBufferLen, writer->numOfPacketsInBackBuffer);
+		lock.lock();
+
+		if (numOfPacketsWritten == writer->numOfPacketsInBackBuffer)
+		{
+			writer->stats.numOfBatchesWritten++;
+			writer->stats.bytesWritten += writer->backBufferLen;
+		}
+		else
+		{
+			// the packets were counted as written when they were queued
+			size_t numOfPacketsFailed = writer->numOfPacketsInBackBuffer - numOfPacketsWritten;
+			PCPP_LOG_ERROR("Failed to write " << numOfPacketsFailed << " of " << writer->numOfPacketsInBackBuffer << " packets to '" << m_FileName << "'");
+			writer->stats.numOfFailedBatches++;
+			writer->stats.packetsFailed += numOfPacketsFailed;
+			m_NumOfPacketsWritten -= numOfPacketsFailed;
+			m_NumOfPacketsNotWritten += numOfPacketsFailed;
+		}
+
+		writer->backBufferLen = 0;
+		writer->numOfPacketsInBackBuffer = 0;
+		writer->writeInProgress = false;
+		writer->producerCondition.notify_all();
+	}
 }
 
 
@@ -549,6 +1189,9 @@ bool PcapFileWriterDevice::writePacket(RawPacket const& packet)
 		return false;
 	}
 
+	if (m_AsyncWritingEnabled)
+		return queuePacketForAsyncWrite(packet, std::string());
+
 	pcap_pkthdr pktHdr;
 	pktHdr.caplen = ((RawPacket&)packet).getRawDataLen();
 	pktHdr.len = ((RawPacket&)packet).getFrameLength();
@@ -579,6 +1222,52 @@ bool PcapFileWriterDevice::writePacket(RawPacket const& packet)
 	return true;
 }
 
+size_t PcapFileWriterDevice::getAsyncRecordSize(const RawPacket& packet, const std::string& comment) const
+{
+	// pcap files don't support comments
+	(void)comment;
+	return sizeof(packet_header) + packet.getRawDataLen();
+}
+
+void PcapFileWriterDevice::serializeAsyncRecord(const RawPacket& packet, const std::string& comment, uint8_t* record) const
+{
+	(void)comment;
+
+	// records are stored in the file format so a batch is written to the file as is
+	packet_header pktHdr;
+	timespec packetTimestamp = packet.getPacketTimeStamp();
+	pktHdr.tv_sec = packetTimestamp.tv_sec;
+	pktHdr.tv_usec = packetTimestamp.tv_nsec / 1000;
+	pktHdr.caplen = packet.getRawDataLen();
+	pktHdr.len = packet.getFrameLength();
+	memcpy(record, &pktHdr, sizeof(pktHdr));
+	memcpy(record + sizeof(pktHdr), packet.getRawData(), pktHdr.caplen);
+}
+
+size_t PcapFileWriterDevice::writeAsyncRecords(const uint8_t* records, size_t recordsLen, size_t numOfRecords)
+{
+	// in append mode the file is opened by PcapPlusPlus, see comment above pcap_dump
+	FILE* file = (m_AppendMode ? m_File : pcap_dump_file(m_PcapDumpHandler));
+	size_t bytesWritten = fwrite(records, 1, recordsLen, file);
+	if (bytesWritten == recordsLen)
+		return numOfRecords;
+
+	// count the records that were written completely
+	size_t numOfRecordsWritten = 0;
+	size_t offset = 0;
+	while (offset + sizeof(packet_header) <= bytesWritten)
+	{
+		packet_header pktHdr;
+		memcpy(&pktHdr, records + offset, sizeof(pktHdr));
+		offset += sizeof(pktHdr) + pktHdr.caplen;
+		if (offset > bytesWritten)
+			break;
+		numOfRecordsWritten++;
+	}
+
+	return numOfRecordsWritten;
+}
+
 bool PcapFileWriterDevice::writePackets(const RawPacketVector& packets)
 {
 	for (RawPacketVector::ConstVectorIterator iter = packets.begin(); iter != packets.end(); iter++)
@@ -638,6 +1327,8 @@ void PcapFileWriterDevice::flush()
 	if (!m_DeviceOpened)
 		return;
 
+	waitForAsyncWrites();
+
 	if (!m_AppendMode && pcap_dump_flush(m_PcapDumpHandler) == -1)
 	{
 		PCPP_LOG_ERROR("Error while flushing the packets to file");
@@ -655,6 +1346,7 @@ void PcapFileWriterDevice::close()
 	if (!m_DeviceOpened)
 		return;
 
+	stopAsyncWriting();
 	flush();
 
 	IFileDevice::close();
@@ -790,6 +1482,9 @@ bool PcapNgFileWriterDevice::writePacket(RawPacket const& packet, const std::str
 		return false;
 	}
 
+	if (m_AsyncWritingEnabled)
+		return queuePacketForAsyncWrite(packet, comment);
+
 	light_packet_header pktHeader;
 	pktHeader.captured_length = ((RawPacket&)packet).getRawDataLen();
 	pktHeader.original_length = ((RawPacket&)packet).getFrameLength();
@@ -809,7 +1504,13 @@ bool PcapNgFileWriterDevice::writePacket(RawPacket const& packet, const std::str
 
 	const uint8_t* pktData = ((RawPacket&)packet).getRawData();
 
-	light_write_packet((light_pcapng_t*)m_LightPcapNg, &pktHeader, pktData);
+	if (light_write_packet((light_pcapng_t*)m_LightPcapNg, &pktHeader, pktData) != LIGHT_SUCCESS)
+	{
+		PCPP_LOG_ERROR("Failed to write packet to '" << m_FileName << "'");
+		m_NumOfPacketsNotWritten++;
+		return false;
+	}
+
 	m_NumOfPacketsWritten++;
 	return true;
 }
@@ -819,6 +1520,70 @@ bool PcapNgFileWriterDevice::writePacket(RawPacket const& packet)
 	return writePacket(packet, std::string());
 }
 
+namespace
+{
+
+// the header of a packet in the async writing queue of PcapNgFileWriterDevice. It's followed by the packet data and the comment
+struct PcapNgAsyncRecordHeader
+{
+	timespec timestamp;
+	uint32_t capturedLength;
+	uint32_t originalLength;
+	uint16_t linkType;
+	uint16_t commentLength;
+};
+
+}
+
+size_t PcapNgFileWriterDevice::getAsyncRecordSize(const RawPacket& packet, const std::string& comment) const
+{
+	return sizeof(PcapNgAsyncRecordHeader) + packet.getRawDataLen() + std::min<size_t>(comment.size(), UINT16_MAX);
+}
+
+void PcapNgFileWriterDevice::serializeAsyncRecord(const RawPacket& packet, const std::string& comment, uint8_t* record) const
+{
+	PcapNgAsyncRecordHeader recordHeader;
+	recordHeader.timestamp = packet.getPacketTimeStamp();
+	recordHeader.capturedLength = packet.getRawDataLen();
+	recordHeader.originalLength = packet.getFrameLength();
+	recordHeader.linkType = (uint16_t)packet.getLinkLayerType();
+	recordHeader.commentLength = static_cast<uint16_t>(std::min<size_t>(comment.size(), UINT16_MAX));
+	memcpy(record, &recordHeader, sizeof(recordHeader));
+	record += sizeof(recordHeader);
+	memcpy(record, packet.getRawData(), recordHeader.capturedLength);
+	memcpy(record + recordHeader.capturedLength, comment.data(), recordHeader.commentLength);
+}
+
+size_t PcapNgFileWriterDevice::writeAsyncRecords(const uint8_t* records, size_t recordsLen, size_t numOfRecords)
+{
+	(void)numOfRecords;
+
+	// light_pcapng builds a block per packet, the batch is written to its file stream without interruption
+	size_t numOfRecordsWritten = 0;
+	const uint8_t* recordsEnd = records + recordsLen;
+	while (records < recordsEnd)
+	{
+		PcapNgAsyncRecordHeader recordHeader;
+		memcpy(&recordHeader, records, sizeof(recordHeader));
+		records += sizeof(recordHeader);
+
+		light_packet_header pktHeader;
+		pktHeader.captured_length = recordHeader.capturedLength;
+		pktHeader.original_length = recordHeader.originalLength;
+		pktHeader.timestamp = recordHeader.timestamp;
+		pktHeader.data_link = recordHeader.linkType;
+		pktHeader.interface_id = 0;
+		pktHeader.comment = (recordHeader.commentLength > 0 ? (char*)records + recordHeader.capturedLength : nullptr);
+		pktHeader.comment_length = recordHeader.commentLength;
+
+		if (light_write_packet((light_pcapng_t*)m_LightPcapNg, &pktHeader, records) == LIGHT_SUCCESS)
+			numOfRecordsWritten++;
+		records += recordHeader.capturedLength + recordHeader.commentLength;
+	}
+
+	return numOfRecordsWritten;
+}
+
 bool PcapNgFileWriterDevice::writePackets(const RawPacketVector& packets)
 {
 	for (RawPacketVector::ConstVectorIterator iter = packets.begin(); iter != packets.end(); iter++)
@@ -886,6 +1651,7 @@ void PcapNgFileWriterDevice::flush()
 	if (!m_DeviceOpened || m_LightPcapNg == nullptr)
 		return;
 
+	waitForAsyncWrites();
 	light_pcapng_flush((light_pcapng_t*)m_LightPcapNg);
 	PCPP_LOG_DEBUG("File writer flushed to file '" << m_FileName << "'");
 }
@@ -895,6 +1661,8 @@ void PcapNgFileWriterDevice::close()
 	if (m_LightPcapNg == nullptr)
 		return;
 
+	stopAsyncWriting();
+
 	light_pcapng_close((light_pcapng_t*)m_LightPcapNg);
 	m_LightPcapNg = nullptr;
 
@@ -3,7 +3,13 @@
 #include "PcapFilter.h"
 #include "Logger.h"
 #include "IPv4Layer.h"
+#include "EthLayer.h"
+#include "Packet.h"
+#include "EndianPortable.h"
 #include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
 #if defined(_WIN32)
 #include <winsock2.h>
 #endif
@@ -16,15 +22,688 @@ namespace pcpp
 
 static const int DEFAULT_SNAPLEN = 9000;
 
+std::atomic<uint64_t> GeneralFilter::s_FilterVersion(1);
+
 bool GeneralFilter::matchPacketWithFilter(RawPacket* rawPacket)
+{
+	uint64_t filterVersion = s_FilterVersion.load(std::memory_order_relaxed);
+	if (filterVersion != m_CompiledFilterVersion)
+	{
+		// some filter was modified since the program was compiled, not necessarily one in this tree. The BPF string fully describes
+		// the tree, so the program needs to be compiled again only if the string changed
+		std::string filterStr;
+		parseToString(filterStr);
+		if (m_CompiledFilterVersion == 0 || filterStr != m_CompiledFilter.m_FilterStr)
+			m_CompiledFilter.compile(*this, filterStr);
+
+		m_CompiledFilterVersion = filterVersion;
+	}
+
+	return m_CompiledFilter.matchPacket(rawPacket);
+}
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// CompiledFilter - native filter program builder and evaluator
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// the filter tree is first translated into a tree of nodes: leaves are instructions and inner nodes are "and", "or" and "not".
+// The tree is then emitted into a flat program in which the "and", "or" and "not" nodes are replaced by the jump targets of the
+// instructions (short-circuit evaluation)
+class CompiledFilter::Builder
+{
+public:
+	enum NodeType
+	{
+		LeafNode,
+		AndNode,
+		OrNode,
+		NotNode
+	};
+
+	struct Node
+	{
+		NodeType nodeType;
+		Instruction instruction;
+		std::vector<int> children;
+	};
+
+	std::vector<Node> nodes;
+	// the number of bytes the VLAN filters added so far shift the link-layer offsets, like the "vlan" keyword in BPF
+	uint8_t vlanShift;
+	bool isEthernetOnly;
+
+	Builder() : vlanShift(0), isEthernetOnly(false) {}
+
+	bool addFilter(GeneralFilter* filter, int& nodeIndex)
+	{
+		if (filter == nullptr)
+			return false;
+
+		return filter->compileNative(*this, nodeIndex);
+	}
+
+	int addLeaf(InstructionType type)
+	{
+		Node node;
+		node.nodeType = LeafNode;
+		memset(&node.instruction, 0, sizeof(node.instruction));
+		node.instruction.type = type;
+		node.instruction.vlanShift = vlanShift;
+		nodes.push_back(node);
+		return (int)nodes.size() - 1;
+	}
+
+	Instruction& leaf(int nodeIndex) { return nodes[nodeIndex].instruction; }
+
+	// the methods below add the leaf instructions the filter classes compile to and return the index of the new node
+
+	int addEtherType(uint16_t etherType)
+	{
+		int nodeIndex = addLeaf(EtherTypeEquals);
+		leaf(nodeIndex).value = etherType;
+		return nodeIndex;
+	}
+
+	// "vlan" or "vlan <id>". Shifts the offsets of all the filters that follow
+	int addVlan(bool matchVlanId, uint16_t vlanId)
+	{
+		int nodeIndex = addLeaf(VlanTagEquals);
+		leaf(nodeIndex).size = (matchVlanId ? 1 : 0);
+		leaf(nodeIndex).value = vlanId;
+		vlanShift += 4;
+		isEthernetOnly = true;
+		return nodeIndex;
+	}
+
+	int addMacAddress(Direction dir, const MacAddress& macAddress)
+	{
+		int nodeIndex = addLeaf(MacAddressEquals);
+		leaf(nodeIndex).op = dir;
+		macAddress.copyTo(leaf(nodeIndex).bytes);
+		isEthernetOnly = true;
+		return nodeIndex;
+	}
+
+	// the network and the mask are in network byte order
+	int addIPv4Net(Direction dir, uint32_t network, uint32_t mask)
+	{
+		int nodeIndex = addLeaf(IPv4NetEquals);
+		leaf(nodeIndex).op = dir;
+		leaf(nodeIndex).value = network & mask;
+		leaf(nodeIndex).mask = mask;
+		return nodeIndex;
+	}
+
+	// "ip[offset:2] op value"
+	int addIPv4FieldCompare(uint16_t offset, FilterOperator op, uint32_t value)
+	{
+		int nodeIndex = addLeaf(IPv4FieldCompare);
+		leaf(nodeIndex).offset = offset;
+		leaf(nodeIndex).op = op;
+		leaf(nodeIndex).value = value;
+		return nodeIndex;
+	}
+
+	int addIPProtocol(uint8_t protocol, bool matchIPv6)
+	{
+		int nodeIndex = addLeaf(IPProtocolEquals);
+		leaf(nodeIndex).protocol = protocol;
+		leaf(nodeIndex).size = (matchIPv6 ? 1 : 0);
+		return nodeIndex;
+	}
+
+	int addPortRange(Direction dir, uint16_t fromPort, uint16_t toPort)
+	{
+		int nodeIndex = addLeaf(PortRangeMatch);
+		leaf(nodeIndex).op = dir;
+		leaf(nodeIndex).value = fromPort;
+		leaf(nodeIndex).secondValue = toPort;
+		return nodeIndex;
+	}
+
+	// "tcp[offset:size] & mask op value" or "udp[offset:size] & mask op value"
+	int addTransportFieldCompare(uint8_t protocol, uint16_t offset, uint8_t size, uint32_t mask, FilterOperator op, uint32_t value)
+	{
+		int nodeIndex = addLeaf(TransportFieldCompare);
+		leaf(nodeIndex).protocol = protocol;
+		leaf(nodeIndex).offset = offset;
+		leaf(nodeIndex).size = size;
+		leaf(nodeIndex).mask = mask;
+		leaf(nodeIndex).op = op;
+		leaf(nodeIndex).value = value;
+		return nodeIndex;
+	}
+
+	// "arp[offset] = value"
+	int addArpField(uint16_t offset, uint8_t value)
+	{
+		int nodeIndex = addLeaf(ArpFieldEquals);
+		leaf(nodeIndex).offset = offset;
+		leaf(nodeIndex).value = value;
+		return nodeIndex;
+	}
+
+	bool addGroup(NodeType type, const std::vector<GeneralFilter*>& filters, int& nodeIndex)
+	{
+		// an empty "and"/"or" filter is an empty string inside another filter, which isn't a valid BPF filter
+		if (filters.empty())
+			return false;
+
+		std::vector<int> children;
+		for (std::vector<GeneralFilter*>::const_iterator iter = filters.begin(); iter != filters.end(); ++iter)
+		{
+			int childIndex;
+			if (!addFilter(*iter, childIndex))
+				return false;
+			children.push_back(childIndex);
+		}
+
+		Node node;
+		node.nodeType = type;
+		node.children = children;
+		nodes.push_back(node);
+		nodeIndex = (int)nodes.size() - 1;
+		return true;
+	}
+
+	// emit a node whose result leads to trueTarget or falseTarget. Nodes are emitted after the nodes they jump to, so jumps are
+	// always backwards and the entry point of the node is returned
+	int32_t emit(int nodeIndex, int32_t trueTarget, int32_t falseTarget, std::vector<Instruction>& program) const
+	{
+		const Node& node = nodes[nodeIndex];
+		switch (node.nodeType)
+		{
+		case LeafNode:
+		{
+			Instruction instruction = node.instruction;
+			instruction.jumpIfTrue = trueTarget;
+			instruction.jumpIfFalse = falseTarget;
+			program.push_back(instruction);
+			return (int32_t)program.size() - 1;
+		}
+		case NotNode:
+			return emit(node.children[0], falseTarget, trueTarget, program);
+		case AndNode:
+		{
+			int32_t entryPoint = trueTarget;
+			for (std::vector<int>::const_reverse_iterator iter = node.children.rbegin(); iter != node.children.rend(); ++iter)
+				entryPoint = emit(*iter, entryPoint, falseTarget, program);
+			return entryPoint;
+		}
+		default: // OrNode
+		{
+			int32_t entryPoint = falseTarget;
+			for (std::vector<int>::const_reverse_iterator iter = node.children.rbegin(); iter != node.children.rend(); ++iter)
+				entryPoint = emit(*iter, trueTarget, entryPoint, program);
+			return entryPoint;
+		}
+		}
+	}
+};
+
+namespace
+{
+
+// BPF port filters match SCTP ports as well
+const uint32_t IPProtocolSctp = 132;
+
+enum FilterLinkKind
+{
+	FilterLinkUnsupported,
+	FilterLinkEthernet,
+	FilterLinkSll,
+	FilterLinkRawIP
+};
+
+// the packet data and the link-layer offsets an instruction is evaluated with. Loads return false if they're out of the packet bounds,
+// in which case the packet doesn't match (like BPF which rejects the packet when a load is out of bounds)
+struct FilterPacketContext
+{
+	const uint8_t* data;
+	uint32_t len;
+	FilterLinkKind linkKind;
+	uint32_t etherTypeOffset;
+	uint32_t networkOffset;
+
+	bool load8(uint32_t offset, uint32_t& value) const
+	{
+		if (offset >= len)
+			return false;
+		value = data[offset];
+		return true;
+	}
+
+	bool load16(uint32_t offset, uint32_t& value) const
+	{
+		if (offset + 2 > len)
+			return false;
+		value = ((uint32_t)data[offset] << 8) | data[offset + 1];
+		return true;
+	}
+
+	// returns 1 if the network layer is of the given EtherType, 0 if it's not and -1 if the packet is too short
+	int isEtherType(uint16_t etherType) const
+	{
+		uint32_t value;
+		if (linkKind == FilterLinkRawIP)
+		{
+			// raw IP packets have no EtherType, the protocol is determined by the IP version
+			if (etherType != PCPP_ETHERTYPE_IP && etherType != PCPP_ETHERTYPE_IPV6)
+				return 0;
+			if (!load8(0, value))
+				return -1;
+			return (value & 0xf0) == (etherType == PCPP_ETHERTYPE_IP ? 0x40u : 0x60u) ? 1 : 0;
+		}
+
+		if (!load16(etherTypeOffset, value))
+			return -1;
+		return value == etherType ? 1 : 0;
+	}
+};
+
+FilterLinkKind getFilterLinkKind(LinkLayerType linkType)
+{
+	switch (linkType)
+	{
+	case LINKTYPE_ETHERNET:
+		return FilterLinkEthernet;
+	case LINKTYPE_LINUX_SLL:
+		return FilterLinkSll;
+	case LINKTYPE_DLT_RAW1:
+	case LINKTYPE_DLT_RAW2:
+	case LINKTYPE_RAW:
+		return FilterLinkRawIP;
+	default:
+		return FilterLinkUnsupported;
+	}
+}
+
+bool compareWithOperator(uint8_t op, uint32_t value, uint32_t operand)
+{
+	switch (op)
+	{
+	case EQUALS:
+		return value == operand;
+	case NOT_EQUALS:
+		return value != operand;
+	case GREATER_THAN:
+		return value > operand;
+	case GREATER_OR_EQUAL:
+		return value >= operand;
+	case LESS_THAN:
+		return value < operand;
+	default: // LESS_OR_EQUAL
+		return value <= operand;
+	}
+}
+
+bool matchDirection(uint8_t direction, bool srcMatches, bool dstMatches)
+{
+	switch (direction)
+	{
+	case SRC:
+		return srcMatches;
+	case DST:
+		return dstMatches;
+	default: // SRC_OR_DST
+		return srcMatches || dstMatches;
+	}
+}
+
+// "tcp", "udp", "proto X": IPv4 protocol field, or IPv6 next header (also after a fragment header)
+int matchIPProtocol(const FilterPacketContext& ctx, uint32_t protocol, bool includeIPv6)
+{
+	uint32_t value;
+	int result = ctx.isEtherType(PCPP_ETHERTYPE_IP);
+	if (result < 0)
+		return -1;
+	if (result > 0)
+	{
+		if (!ctx.load8(ctx.networkOffset + 9, value))
+			return -1;
+		if (value == protocol)
+			return 1;
+	}
+
+	if (!includeIPv6)
+		return 0;
+
+	result = ctx.isEtherType(PCPP_ETHERTYPE_IPV6);
+	if (result <= 0)
+		return result;
+
+	if (!ctx.load8(ctx.networkOffset + 6, value))
+		return -1;
+	if (value == protocol)
+		return 1;
+	if (value != PACKETPP_IPPROTO_FRAGMENT)
+		return 0;
+
+	if (!ctx.load8(ctx.networkOffset + 40, value))
+		return -1;
+	return value == protocol ? 1 : 0;
+}
+
+// "ip[6:2] & 0x1fff = 0": the packet isn't a fragment or is the first fragment
+int isFirstIPv4Fragment(const FilterPacketContext& ctx)
+{
+	uint32_t value;
+	if (!ctx.load16(ctx.networkOffset + 6, value))
+		return -1;
+	return (value & 0x1fff) == 0 ? 1 : 0;
+}
+
+// the offset of the transport layer in IPv4 packets, as computed by BPF ("4*(ip[0]&0xf)")
+bool getTransportOffset(const FilterPacketContext& ctx, uint32_t& offset)
+{
+	uint32_t value;
+	if (!ctx.load8(ctx.networkOffset, value))
+		return false;
+	offset = ctx.networkOffset + 4 * (value & 0x0f);
+	return true;
+}
+
+int matchPortRange(const FilterPacketContext& ctx, uint8_t direction, uint32_t fromPort, uint32_t toPort)
+{
+	uint32_t value, srcPort, dstPort;
+	int result = ctx.isEtherType(PCPP_ETHERTYPE_IP);
+	if (result < 0)
+		return -1;
+	if (result > 0)
+	{
+		if (!ctx.load8(ctx.networkOffset + 9, value))
+			return -1;
+		if (value != PACKETPP_IPPROTO_TCP && value != PACKETPP_IPPROTO_UDP && value != IPProtocolSctp)
+			return 0;
+
+		result = isFirstIPv4Fragment(ctx);
+		if (result <= 0)
+			return result;
+
+		uint32_t transportOffset;
+		if (!getTransportOffset(ctx, transportOffset) || !ctx.load16(transportOffset, srcPort) || !ctx.load16(transportOffset + 2, dstPort))
+			return -1;
+	}
+	else
+	{
+		result = ctx.isEtherType(PCPP_ETHERTYPE_IPV6);
+		if (result <= 0)
+			return result;
+
+		if (!ctx.load8(ctx.networkOffset + 6, value))
+			return -1;
+		if (value != PACKETPP_IPPROTO_TCP && value != PACKETPP_IPPROTO_UDP && value != IPProtocolSctp)
+			return 0;
+
+		if (!ctx.load16(ctx.networkOffset + 40, srcPort) || !ctx.load16(ctx.networkOffset + 42, dstPort))
+			return -1;
+	}
+
+	bool srcMatches = (srcPort >= fromPort && srcPort <= toPort);
+	bool dstMatches = (dstPort >= fromPort && dstPort <= toPort);
+	return matchDirection(direction, srcMatches, dstMatches) ? 1 : 0;
+}
+
+} // namespace
+
+CompiledFilter::CompiledFilter() : m_EntryPoint(AcceptTarget), m_IsNative(true), m_IsEthernetOnly(false), m_IsBpfFilterSet(false),
+	m_IsBpfFilterValid(false), m_BpfFilterLinkType(LINKTYPE_ETHERNET)
+{
+}
+
+bool CompiledFilter::compile(GeneralFilter& filter)
 {
 	std::string filterStr;
-	parseToString(filterStr);
+	filter.parseToString(filterStr);
+	return compile(filter, filterStr);
+}
+
+bool CompiledFilter::compile(GeneralFilter& filter, const std::string& filterStr)
+{
+	m_Program.clear();
+	m_EntryPoint = AcceptTarget;
+	m_IsNative = true;
+	m_IsEthernetOnly = false;
+	m_FilterStr = filterStr;
+	m_IsBpfFilterSet = false;
+
+	// an empty filter matches all packets
+	if (filterStr.empty())
+		return true;
+
+	Builder builder;
+	int rootIndex;
+	if (!builder.addFilter(&filter, rootIndex))
+	{
+		PCPP_LOG_DEBUG("Filter '" << filterStr << "' can't be compiled natively, BPF will be used for matching");
+		m_IsNative = false;
+		return false;
+	}
+
+	m_EntryPoint = builder.emit(rootIndex, AcceptTarget, RejectTarget, m_Program);
+	m_IsEthernetOnly = builder.isEthernetOnly;
+	return true;
+}
+
+bool CompiledFilter::isNativeForLinkType(LinkLayerType linkType) const
+{
+	if (!m_IsNative)
+		return false;
+
+	// an empty program doesn't look at the packet data
+	if (m_Program.empty())
+		return true;
+
+	FilterLinkKind linkKind = getFilterLinkKind(linkType);
+	if (linkKind == FilterLinkUnsupported)
+		return false;
+
+	return !m_IsEthernetOnly || linkKind == FilterLinkEthernet;
+}
+
+bool CompiledFilter::matchPacket(const uint8_t* packetData, uint32_t packetDataLength, LinkLayerType linkType)
+{
+	if (!isNativeForLinkType(linkType))
+		return matchWithBpf(packetData, packetDataLength, linkType);
+
+	return runProgram(packetData, packetDataLength, linkType);
+}
+
+bool CompiledFilter::matchPacket(const RawPacket* rawPacket)
+{
+	return matchPacket(rawPacket->getRawData(), rawPacket->getRawDataLen(), rawPacket->getLinkLayerType());
+}
+
+bool CompiledFilter::matchPacket(const Packet& packet)
+{
+	return matchPacket(packet.getRawPacketReadOnly());
+}
+
+size_t CompiledFilter::matchPackets(const PointerVector<RawPacket>& rawPackets, std::vector<bool>& results)
+{
+	results.clear();
+	results.reserve(rawPackets.size());
+
+	size_t numOfMatches = 0;
+	for (PointerVector<RawPacket>::ConstVectorIterator iter = rawPackets.begin(); iter != rawPackets.end(); ++iter)
+	{
+		bool isMatch = matchPacket(*iter);
+		results.push_back(isMatch);
+		if (isMatch)
+			numOfMatches++;
+	}
+
+	return numOfMatches;
+}
+
+bool CompiledFilter::matchWithBpf(const uint8_t* packetData, uint32_t packetDataLength, LinkLayerType linkType)
+{
+	if (!m_IsBpfFilterSet || linkType != m_BpfFilterLinkType)
+	{
+		m_IsBpfFilterValid = m_BpfFilter.setFilter(m_FilterStr, linkType);
+		if (!m_IsBpfFilterValid)
+			PCPP_LOG_DEBUG("Filter '" << m_FilterStr << "' can't be compiled by libpcap for link type " << linkType);
+		m_IsBpfFilterSet = true;
+		m_BpfFilterLinkType = linkType;
+	}
 
-	if (!m_BpfWrapper.setFilter(filterStr))
+	if (!m_IsBpfFilterValid)
 		return false;
 
-	return m_BpfWrapper.matchPacketWithFilter(rawPacket);
+	timespec timestamp = { 0, 0 };
+	return m_BpfFilter.matchPacketWithFilter(packetData, packetDataLength, timestamp, linkType);
+}
+
+bool CompiledFilter::runProgram(const uint8_t* packetData, uint32_t packetDataLength, LinkLayerType linkType) const
+{
+	FilterPacketContext ctx;
+	ctx.data = packetData;
+	ctx.len = packetDataLength;
+	ctx.linkKind = getFilterLinkKind(linkType);
+
+	uint32_t baseEtherTypeOffset = 0, baseNetworkOffset = 0;
+	if (ctx.linkKind == FilterLinkEthernet)
+	{
+		baseEtherTypeOffset = 12;
+		baseNetworkOffset = 14;
+	}
+	else if (ctx.linkKind == FilterLinkSll)
+	{
+		baseEtherTypeOffset = 14;
+		baseNetworkOffset = 16;
+	}
+
+	int32_t pc = m_EntryPoint;
+	while (pc >= 0)
+	{
+		const Instruction& instruction = m_Program[pc];
+		ctx.etherTypeOffset = baseEtherTypeOffset + instruction.vlanShift;
+		ctx.networkOffset = baseNetworkOffset + instruction.vlanShift;
+
+		int result = 0;
+		uint32_t value;
+		switch (instruction.type)
+		{
+		case EtherTypeEquals:
+		{
+			result = ctx.isEtherType((uint16_t)instruction.value);
+			break;
+		}
+		case VlanTagEquals:
+		{
+			if (!ctx.load16(ctx.etherTypeOffset, value))
+			{
+				result = -1;
+				break;
+			}
+			result = (value == PCPP_ETHERTYPE_VLAN || value == PCPP_ETHERTYPE_IEEE_802_1AD || value == 0x9100) ? 1 : 0;
+			// the VLAN ID is compared only if set in the filter
+			if (result > 0 && instruction.size != 0)
+			{
+				if (!ctx.load16(ctx.etherTypeOffset + 2, value))
+					result = -1;
+				else
+					result = (value & 0x0fff) == instruction.value ? 1 : 0;
+			}
+			break;
+		}
+		case MacAddressEquals:
+		{
+			if (ctx.len < 12)
+			{
+				result = -1;
+				break;
+			}
+			bool dstMatches = (memcmp(ctx.data, instruction.bytes, 6) == 0);
+			bool srcMatches = (memcmp(ctx.data + 6, instruction.bytes, 6) == 0);
+			result = matchDirection(instruction.op, srcMatches, dstMatches) ? 1 : 0;
+			break;
+		}
+		case IPv4NetEquals:
+		{
+			result = ctx.isEtherType(PCPP_ETHERTYPE_IP);
+			if (result <= 0)
+				break;
+			if (ctx.networkOffset + 20 > ctx.len)
+			{
+				result = -1;
+				break;
+			}
+			uint32_t srcAddr, dstAddr;
+			memcpy(&srcAddr, ctx.data + ctx.networkOffset + 12, sizeof(srcAddr));
+			memcpy(&dstAddr, ctx.data + ctx.networkOffset + 16, sizeof(dstAddr));
+			result = matchDirection(instruction.op, (srcAddr & instruction.mask) == instruction.value, (dstAddr & instruction.mask) == instruction.value) ? 1 : 0;
+			break;
+		}
+		case IPv4FieldCompare:
+		{
+			result = ctx.isEtherType(PCPP_ETHERTYPE_IP);
+			if (result <= 0)
+				break;
+			if (!ctx.load16(ctx.networkOffset + instruction.offset, value))
+				result = -1;
+			else
+				result = compareWithOperator(instruction.op, value, instruction.value) ? 1 : 0;
+			break;
+		}
+		case IPProtocolEquals:
+		{
+			result = matchIPProtocol(ctx, instruction.protocol, instruction.size != 0);
+			break;
+		}
+		case PortRangeMatch:
+		{
+			result = matchPortRange(ctx, instruction.op, instruction.value, instruction.secondValue);
+			break;
+		}
+		case TransportFieldCompare:
+		{
+			// "tcp[x]" and "udp[x]" in BPF: the protocol check, the first fragment check and the field read at the IPv4 header length
+			result = matchIPProtocol(ctx, instruction.protocol, true);
+			if (result <= 0)
+				break;
+			result = isFirstIPv4Fragment(ctx);
+			if (result <= 0)
+				break;
+			uint32_t transportOffset;
+			bool loaded = getTransportOffset(ctx, transportOffset);
+			if (loaded)
+			{
+				if (instruction.size == 1)
+					loaded = ctx.load8(transportOffset + instruction.offset, value);
+				else
+					loaded = ctx.load16(transportOffset + instruction.offset, value);
+			}
+			if (!loaded)
+				result = -1;
+			else
+				result = compareWithOperator(instruction.op, value & instruction.mask, instruction.value) ? 1 : 0;
+			break;
+		}
+		case ArpFieldEquals:
+		{
+			result = ctx.isEtherType(PCPP_ETHERTYPE_ARP);
+			if (result <= 0)
+				break;
+			if (!ctx.load8(ctx.networkOffset + instruction.offset, value))
+				result = -1;
+			else
+				result = value == instruction.value ? 1 : 0;
+			break;
+		}
+		default:
+			result = -1;
+			break;
+		}
+
+		if (result < 0)
+			return false;
+
+		pc = (result > 0 ? instruction.jumpIfTrue : instruction.jumpIfFalse);
+	}
+
+	return pc == AcceptTarget;
 }
 
 BpfFilterWrapper::BpfFilterWrapper()
@@ -230,6 +909,34 @@ void IPFilter::parseToString(std::string& result)
 	}
 }
 
+bool IPFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	// only IPv4 addresses and masks are supported natively, other cases are left to BPF
+	IPv4Address ipAddr(m_Address);
+	if (!ipAddr.isValid())
+		return false;
+
+	uint32_t mask = 0xffffffff;
+	if (!m_IPv4Mask.empty())
+	{
+		IPv4Address maskAsAddr(m_IPv4Mask);
+		if (!maskAsAddr.isValid())
+			return false;
+		mask = maskAsAddr.toInt();
+	}
+	else if (m_Len > 0)
+	{
+		if (m_Len > 32)
+			return false;
+		mask = htobe32(0xffffffff << (32 - m_Len));
+	}
+	else if (m_Len < 0)
+		return false;
+
+	nodeIndex = builder.addIPv4Net(getDir(), ipAddr.toInt(), mask);
+	return true;
+}
+
 void IPv4IDFilter::parseToString(std::string& result)
 {
 	std::string op = parseOperator();
@@ -238,6 +945,12 @@ void IPv4IDFilter::parseToString(std::string& result)
 	result = "ip[4:2] " + op + ' ' + stream.str();
 }
 
+bool IPv4IDFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	nodeIndex = builder.addIPv4FieldCompare(4, getOperator(), m_IpID);
+	return true;
+}
+
 void IPv4TotalLengthFilter::parseToString(std::string& result)
 {
 	std::string op = parseOperator();
@@ -246,6 +959,12 @@ void IPv4TotalLengthFilter::parseToString(std::string& result)
 	result = "ip[2:2] " + op + ' ' + stream.str();
 }
 
+bool IPv4TotalLengthFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	nodeIndex = builder.addIPv4FieldCompare(2, getOperator(), m_TotalLength);
+	return true;
+}
+
 void PortFilter::portToString(uint16_t portAsInt)
 {
 	std::ostringstream stream;
@@ -265,6 +984,13 @@ void PortFilter::parseToString(std::string& result)
 	result = dir + " port " + m_Port;
 }
 
+bool PortFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	uint16_t port = (uint16_t)atoi(m_Port.c_str());
+	nodeIndex = builder.addPortRange(getDir(), port, port);
+	return true;
+}
+
 void PortRangeFilter::parseToString(std::string& result)
 {
 	std::string dir;
@@ -278,6 +1004,13 @@ void PortRangeFilter::parseToString(std::string& result)
 	result = dir + " portrange " + fromPortStream.str() + '-' + toPortStream.str();
 }
 
+bool PortRangeFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	// BPF accepts the range in any order
+	nodeIndex = builder.addPortRange(getDir(), std::min(m_FromPort, m_ToPort), std::max(m_FromPort, m_ToPort));
+	return true;
+}
+
 void MacAddressFilter::parseToString(std::string& result)
 {
 	if (getDir() != SRC_OR_DST)
@@ -290,6 +1023,12 @@ void MacAddressFilter::parseToString(std::string& result)
 		result = "ether host " + m_MacAddress.toString();
 }
 
+bool MacAddressFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	nodeIndex = builder.addMacAddress(getDir(), m_MacAddress);
+	return true;
+}
+
 void EtherTypeFilter::parseToString(std::string& result)
 {
 	std::ostringstream stream;
@@ -297,6 +1036,17 @@ void EtherTypeFilter::parseToString(std::string& result)
 	result = "ether proto " + stream.str();
 }
 
+bool EtherTypeFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	// values that are lengths (802.3 frames) are handled by BPF with special LLC logic
+	if (m_EtherType <= 1500)
+		return false;
+
+	nodeIndex = builder.addEtherType(m_EtherType);
+	builder.isEthernetOnly = true;
+	return true;
+}
+
 AndFilter::AndFilter(std::vector<GeneralFilter*>& filters)
 {
 	for(std::vector<GeneralFilter*>::iterator it = filters.begin(); it != filters.end(); ++it)
@@ -313,6 +1063,8 @@ void AndFilter::setFilters(std::vector<GeneralFilter*>& filters)
 	{
 		m_FilterList.push_back(*it);
 	}
+
+	filterChanged();
 }
 
 void AndFilter::parseToString(std::string& result)
@@ -330,6 +1082,11 @@ void AndFilter::parseToString(std::string& result)
 	}
 }
 
+bool AndFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	return builder.addGroup(CompiledFilter::Builder::AndNode, m_FilterList, nodeIndex);
+}
+
 OrFilter::OrFilter(std::vector<GeneralFilter*>& filters)
 {
 	for(std::vector<GeneralFilter*>::iterator it = filters.begin(); it != filters.end(); ++it)
@@ -353,6 +1110,11 @@ void OrFilter::parseToString(std::string& result)
 	}
 }
 
+bool OrFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	return builder.addGroup(CompiledFilter::Builder::OrNode, m_FilterList, nodeIndex);
+}
+
 void NotFilter::parseToString(std::string& result)
 {
 	std::string innerFilterAsString;
@@ -360,6 +1122,11 @@ void NotFilter::parseToString(std::string& result)
 	result = "not (" + innerFilterAsString + ')';
 }
 
+bool NotFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	return builder.addGroup(CompiledFilter::Builder::NotNode, std::vector<GeneralFilter*>(1, m_FilterToInverse), nodeIndex);
+}
+
 void ProtoFilter::parseToString(std::string& result)
 {
 	std::ostringstream stream;
@@ -403,6 +1170,43 @@ void ProtoFilter::parseToString(std::string& result)
 	}
 }
 
+bool ProtoFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	switch (m_Proto)
+	{
+	case TCP:
+		nodeIndex = builder.addIPProtocol(PACKETPP_IPPROTO_TCP, true);
+		return true;
+	case UDP:
+		nodeIndex = builder.addIPProtocol(PACKETPP_IPPROTO_UDP, true);
+		return true;
+	case ICMP:
+		// "icmp" matches only IPv4
+		nodeIndex = builder.addIPProtocol(PACKETPP_IPPROTO_ICMP, false);
+		return true;
+	case GRE:
+		nodeIndex = builder.addIPProtocol(PACKETPP_IPPROTO_GRE, true);
+		return true;
+	case IGMP:
+		nodeIndex = builder.addIPProtocol(PACKETPP_IPPROTO_IGMP, true);
+		return true;
+	case IPv4:
+		nodeIndex = builder.addEtherType(PCPP_ETHERTYPE_IP);
+		return true;
+	case IPv6:
+		nodeIndex = builder.addEtherType(PCPP_ETHERTYPE_IPV6);
+		return true;
+	case ARP:
+		nodeIndex = builder.addEtherType(PCPP_ETHERTYPE_ARP);
+		return true;
+	case VLAN:
+		nodeIndex = builder.addVlan(false, 0);
+		return true;
+	default:
+		return false;
+	}
+}
+
 void ArpFilter::parseToString(std::string& result)
 {
 	std::ostringstream sstream;
@@ -410,6 +1214,12 @@ void ArpFilter::parseToString(std::string& result)
 	result += sstream.str();
 }
 
+bool ArpFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	nodeIndex = builder.addArpField(7, (uint8_t)m_OpCode);
+	return true;
+}
+
 void VlanFilter::parseToString(std::string& result)
 {
 	std::ostringstream stream;
@@ -417,6 +1227,12 @@ void VlanFilter::parseToString(std::string& result)
 	result = "vlan " + stream.str();
 }
 
+bool VlanFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	nodeIndex = builder.addVlan(true, m_VlanID);
+	return true;
+}
+
 void TcpFlagsFilter::parseToString(std::string& result)
 {
 	if (m_TcpFlagsBitMask == 0)
@@ -452,6 +1268,19 @@ void TcpFlagsFilter::parseToString(std::string& result)
 	}
 }
 
+bool TcpFlagsFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	// an empty bitmask is an empty BPF string
+	if (m_TcpFlagsBitMask == 0)
+		return false;
+
+	if (m_MatchOption == MatchAll)
+		nodeIndex = builder.addTransportFieldCompare(PACKETPP_IPPROTO_TCP, 13, 1, m_TcpFlagsBitMask, EQUALS, m_TcpFlagsBitMask);
+	else
+		nodeIndex = builder.addTransportFieldCompare(PACKETPP_IPPROTO_TCP, 13, 1, m_TcpFlagsBitMask, NOT_EQUALS, 0);
+	return true;
+}
+
 void TcpWindowSizeFilter::parseToString(std::string& result)
 {
 	std::ostringstream stream;
@@ -459,6 +1288,12 @@ void TcpWindowSizeFilter::parseToString(std::string& result)
 	result = "tcp[14:2] " + parseOperator() + ' ' + stream.str();
 }
 
+bool TcpWindowSizeFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	nodeIndex = builder.addTransportFieldCompare(PACKETPP_IPPROTO_TCP, 14, 2, 0xffff, getOperator(), m_WindowSize);
+	return true;
+}
+
 void UdpLengthFilter::parseToString(std::string& result)
 {
 	std::ostringstream stream;
@@ -466,4 +1301,10 @@ void UdpLengthFilter::parseToString(std::string& result)
 	result = "udp[4:2] " + parseOperator() + ' ' + stream.str();
 }
 
+bool UdpLengthFilter::compileNative(CompiledFilter::Builder& builder, int& nodeIndex)
+{
+	nodeIndex = builder.addTransportFieldCompare(PACKETPP_IPPROTO_UDP, 4, 2, 0xffff, getOperator(), m_Length);
+	return true;
+}
+
 } // namespace pcpp
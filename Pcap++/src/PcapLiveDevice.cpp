@@ -15,6 +15,8 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
+#include <algorithm>
 #if defined(_WIN32)
 // The definition of BPF_MAJOR_VERSION is required to support Npcap. In Npcap there are
 // compilation errors due to struct redefinition when including both Packet32.h and pcap.h
@@ -50,6 +52,64 @@ static const int DEFAULT_SNAPLEN = 9000;
 namespace pcpp
 {
 
+/**
+ * The packets of a burst and the buffer their data is copied to. While libpcap reads a burst the packet data is appended to the buffer and
+ * only the packet offsets are kept, since the buffer may be reallocated when it grows. When the burst is complete the raw packets are pointed
+ * at their data. Both the buffer and the raw packets are reused by all bursts
+ */
+class PcapLiveDevice::BurstBuffer
+{
+public:
+	struct PacketInfo
+	{
+		size_t dataOffset;
+		int capLen;
+		int frameLen;
+		timespec timestamp;
+	};
+
+	std::vector<RawPacket> packets;
+	std::vector<PacketInfo> packetInfo;
+	std::vector<uint8_t> data;
+	size_t dataLen;
+	uint32_t numOfPackets;
+
+	explicit BurstBuffer(int maxBurstSize) : packets(maxBurstSize), packetInfo(maxBurstSize), dataLen(0), numOfPackets(0) {}
+
+	void addPacket(const struct pcap_pkthdr* pkthdr, const uint8_t* packet)
+	{
+		if (numOfPackets >= packets.size())
+			return;
+
+		if (dataLen + pkthdr->caplen > data.size())
+			data.resize(std::max(2 * data.size(), dataLen + pkthdr->caplen));
+
+		if (pkthdr->caplen > 0)
+			memcpy(data.data() + dataLen, packet, pkthdr->caplen);
+
+		PacketInfo& info = packetInfo[numOfPackets++];
+		info.dataOffset = dataLen;
+		info.capLen = pkthdr->caplen;
+		info.frameLen = pkthdr->len;
+		info.timestamp.tv_sec = pkthdr->ts.tv_sec;
+		info.timestamp.tv_nsec = pkthdr->ts.tv_usec * 1000;
+		dataLen += pkthdr->caplen;
+	}
+
+	void setRawPackets(LinkLayerType linkType)
+	{
+		// data may still be empty if all packets of the burst were captured with no data, so its elements can't be indexed
+		for (uint32_t i = 0; i < numOfPackets; i++)
+			packets[i].setRawData(data.data() + packetInfo[i].dataOffset, packetInfo[i].capLen, packetInfo[i].timestamp, linkType, packetInfo[i].frameLen, false);
+	}
+
+	void reset()
+	{
+		numOfPackets = 0;
+		dataLen = 0;
+	}
+};
+
 #ifdef HAS_SET_DIRECTION_ENABLED
 static pcap_direction_t directionTypeMap(PcapLiveDevice::PcapDirection direction)
 {
@@ -117,6 +177,9 @@ PcapLiveDevice::PcapLiveDevice(pcap_if_t* pInterface, bool calculateMTU, bool ca
 	m_cbOnStatsUpdateUserCookie = nullptr;
 	m_CaptureCallbackMode = true;
 	m_CapturedPackets = nullptr;
+	m_cbOnPacketsArrive = nullptr;
+	m_cbOnPacketsArriveUserCookie = nullptr;
+	m_BurstBuffer = nullptr;
 	if (calculateMacAddress)
 	{
 		setDeviceMacAddress();
@@ -171,10 +234,36 @@ void PcapLiveDevice::onPacketArrivesBlockingMode(uint8_t* user, const struct pca
 			pThis->m_StopThread = true;
 }
 
+void PcapLiveDevice::onPacketArrivesBurstMode(uint8_t* user, const struct pcap_pkthdr* pkthdr, const uint8_t* packet)
+{
+	PcapLiveDevice* pThis = (PcapLiveDevice*)user;
+	if (pThis == nullptr)
+	{
+		PCPP_LOG_ERROR("Unable to extract PcapLiveDevice instance");
+		return;
+	}
+
+	pThis->m_BurstBuffer->addPacket(pkthdr, packet);
+}
+
 void PcapLiveDevice::captureThreadMain()
 {
 	PCPP_LOG_DEBUG("Started capture thread for device '" << m_Name << "'");
-	if (m_CaptureCallbackMode)
+	if (m_cbOnPacketsArrive != nullptr)
+	{
+		int maxBurstSize = static_cast<int>(m_BurstBuffer->packets.size());
+		while (!m_StopThread)
+		{
+			m_BurstBuffer->reset();
+			pcap_dispatch(m_PcapDescriptor, maxBurstSize, onPacketArrivesBurstMode, (uint8_t*)this);
+			if (m_BurstBuffer->numOfPackets == 0)
+				continue;
+
+			m_BurstBuffer->setRawPackets(getLinkType());
+			m_cbOnPacketsArrive(m_BurstBuffer->packets.data(), m_BurstBuffer->numOfPackets, this, m_cbOnPacketsArriveUserCookie);
+		}
+	}
+	else if (m_CaptureCallbackMode)
 	{
 		while (!m_StopThread)
 			pcap_dispatch(m_PcapDescriptor, -1, onPacketArrives, (uint8_t*)this);
@@ -424,6 +513,8 @@ bool PcapLiveDevice::startCapture(OnPacketArrivesCallback onPacketArrives, void*
 	m_CaptureCallbackMode = true;
 	m_cbOnPacketArrives = onPacketArrives;
 	m_cbOnPacketArrivesUserCookie = onPacketArrivesUserCookie;
+	m_cbOnPacketsArrive = nullptr;
+	m_cbOnPacketsArriveUserCookie = nullptr;
 
 	m_CaptureThread = std::thread(&pcpp::PcapLiveDevice::captureThreadMain, this);
 	m_CaptureThreadStarted = true;
@@ -459,6 +550,57 @@ bool PcapLiveDevice::startCapture(RawPacketVector& capturedPacketsVector)
 	m_CapturedPackets->clear();
 
 	m_CaptureCallbackMode = false;
+	m_cbOnPacketsArrive = nullptr;
+	m_cbOnPacketsArriveUserCookie = nullptr;
+	m_CaptureThread = std::thread(&pcpp::PcapLiveDevice::captureThreadMain, this);
+	m_CaptureThreadStarted = true;
+	PCPP_LOG_DEBUG("Successfully created capture thread for device '" << m_Name << "'. Thread id: " << m_CaptureThread.get_id());
+
+	return true;
+}
+
+bool PcapLiveDevice::startCaptureBurst(OnPacketsArriveCallback onPacketsArrive, void* onPacketsArriveUserCookie, int maxBurstSize)
+{
+	if (!m_DeviceOpened || m_PcapDescriptor == nullptr)
+	{
+		PCPP_LOG_ERROR("Device '" << m_Name << "' not opened");
+		return false;
+	}
+
+	if (m_CaptureThreadStarted)
+	{
+		PCPP_LOG_ERROR("Device '" << m_Name << "' already capturing traffic");
+		return false;
+	}
+
+	if (onPacketsArrive == nullptr)
+	{
+		PCPP_LOG_ERROR("Packets arrive callback is null");
+		return false;
+	}
+
+	if (maxBurstSize <= 0)
+	{
+		PCPP_LOG_ERROR("Burst size must be a positive number");
+		return false;
+	}
+
+	// keep the buffer of a previous capture with the same burst size, its data buffer already grew to fit the traffic
+	if (m_BurstBuffer != nullptr && m_BurstBuffer->packets.size() != static_cast<size_t>(maxBurstSize))
+	{
+		delete m_BurstBuffer;
+		m_BurstBuffer = nullptr;
+	}
+
+	if (m_BurstBuffer == nullptr)
+		m_BurstBuffer = new BurstBuffer(maxBurstSize);
+
+	m_CaptureCallbackMode = true;
+	m_cbOnPacketArrives = nullptr;
+	m_cbOnPacketArrivesUserCookie = nullptr;
+	m_cbOnPacketsArrive = onPacketsArrive;
+	m_cbOnPacketsArriveUserCookie = onPacketsArriveUserCookie;
+
 	m_CaptureThread = std::thread(&pcpp::PcapLiveDevice::captureThreadMain, this);
 	m_CaptureThreadStarted = true;
 	PCPP_LOG_DEBUG("Successfully created capture thread for device '" << m_Name << "'. Thread id: " << m_CaptureThread.get_id());
@@ -993,6 +1135,7 @@ const std::vector<IPv4Address>& PcapLiveDevice::getDnsServers() const
 
 PcapLiveDevice::~PcapLiveDevice()
 {
+	delete m_BurstBuffer;
 }
 
 } // namespace pcpp
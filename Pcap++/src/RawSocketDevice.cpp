@@ -5,9 +5,13 @@
 #include <errno.h>
 #include <unistd.h>
 #include <netinet/if_ether.h>
-#include <netpacket/packet.h>
+#include <linux/if_packet.h>
 #include <ifaddrs.h>
 #include <net/if.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <vector>
+#include <algorithm>
 #endif
 #include <string.h>
 #include "Logger.h"
@@ -21,6 +25,18 @@ namespace pcpp
 
 #define RAW_SOCKET_BUFFER_LEN 65536
 
+// the frame size of the receive ring. With TPACKET_V3 packets are packed into blocks regardless of the frame size, but the kernel
+// still requires it to be set
+#define RX_RING_FRAME_SIZE 2048
+
+// the max number of packets sent in a single system call
+#define RAW_SOCKET_SEND_BATCH_SIZE 64
+
+// when the socket's send buffer or the device queue is full, sending the rest of a batch is retried after waiting for the socket to
+// become writable. A batch is retried up to this number of times in total with the timeout below, and then the rest of it is given up on
+#define RAW_SOCKET_SEND_MAX_RETRIES 10
+#define RAW_SOCKET_SEND_RETRY_TIMEOUT_MS 10
+
 #if defined(_WIN32)
 
 #ifndef SIO_RCVALL
@@ -66,9 +82,50 @@ struct SocketContainer
 	int fd;
 	int interfaceIndex;
 	std::string interfaceName;
+
+	// the receive mode currently set on the socket, so it's changed only when a different mode is requested
+	bool blocking;
+	int timeout;
+
+	// a buffer to receive packets into when not using the receive ring. Only the received bytes are copied to the packet
+	std::vector<uint8_t> recvBuffer;
+
+	// the memory-mapped receive ring, if enabled
+	uint8_t* rxRing;
+	uint32_t rxRingBlockSize;
+	uint32_t rxRingNumOfBlocks;
+	uint32_t rxRingCurBlock;
+	uint32_t rxRingPacketsLeftInBlock;
+	bool rxRingBlockInUse;
+	tpacket3_hdr* rxRingCurPacket;
+
+	SocketContainer() : fd(-1), interfaceIndex(-1), blocking(true), timeout(0), rxRing(nullptr), rxRingBlockSize(0), rxRingNumOfBlocks(0),
+		rxRingCurBlock(0), rxRingPacketsLeftInBlock(0), rxRingBlockInUse(false), rxRingCurPacket(nullptr) {}
 #endif
 };
 
+#if defined(__linux__)
+
+// the Ethernet check is done by the link type and the minimum length rather than by parsing the packet
+static bool isEthernetPacket(const RawPacket* rawPacket)
+{
+	return rawPacket->getLinkLayerType() == LINKTYPE_ETHERNET && rawPacket->getRawDataLen() >= (int)sizeof(ether_header);
+}
+
+static void fillSendAddress(sockaddr_ll& addr, int interfaceIndex, const RawPacket* rawPacket)
+{
+	memset(&addr, 0, sizeof(struct sockaddr_ll));
+	addr.sll_family = htobe16(PF_PACKET);
+	addr.sll_protocol = htobe16(ETH_P_ALL);
+	addr.sll_halen = 6;
+	addr.sll_ifindex = interfaceIndex;
+
+	// the destination MAC address is the first field of the Ethernet header
+	memcpy(addr.sll_addr, rawPacket->getRawData(), 6);
+}
+
+#endif // defined(__linux__)
+
 RawSocketDevice::RawSocketDevice(const IPAddress& interfaceIP) : IDevice(), m_Socket(nullptr)
 {
 #if defined(_WIN32)
@@ -153,40 +210,23 @@ RawSocketDevice::RecvPacketResult RawSocketDevice::receivePacket(RawPacket& rawP
 		return RecvError;
 	}
 
-	int fd = ((SocketContainer*)m_Socket)->fd;
-	char* buffer = new char[RAW_SOCKET_BUFFER_LEN];
-	memset(buffer, 0, RAW_SOCKET_BUFFER_LEN);
+	SocketContainer* sockContainer = (SocketContainer*)m_Socket;
 
-	// value of 0 timeout means disabling timeout
-	if (timeout < 0)
-		timeout = 0;
-
-	// set blocking or non-blocking flag
-	int flags = fcntl(fd, F_GETFL, 0);
-	if (flags == -1)
-	{
-		delete [] buffer;
-		PCPP_LOG_ERROR("Cannot get socket flags");
-		return RecvError;
-	}
-	flags = (blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK));
-	if (fcntl(fd, F_SETFL, flags) != 0)
+	if (sockContainer->rxRing != nullptr)
 	{
-		delete [] buffer;
-		PCPP_LOG_ERROR("Cannot set socket non-blocking flag");
-		return RecvError;
+		RecvPacketResult result = waitForRxRingBlock(blocking, timeout);
+		if (result == RecvSuccess)
+			fillPacketFromRxRing(rawPacket);
+
+		return result;
 	}
 
-	// set timeout on socket
-	struct timeval timeoutVal;
-	timeoutVal.tv_sec = timeout;
-	timeoutVal.tv_usec = 0;
-	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeoutVal, sizeof(timeoutVal));
+	if (!setReceiveMode(blocking, timeout))
+		return RecvError;
 
-	int bufferLen = recv(fd, buffer, RAW_SOCKET_BUFFER_LEN, 0);
+	int bufferLen = recv(sockContainer->fd, sockContainer->recvBuffer.data(), sockContainer->recvBuffer.size(), 0);
 	if (bufferLen < 0)
 	{
-		delete [] buffer;
 		int errorCode = errno;
 		RecvPacketResult error = getError(errorCode);
 
@@ -198,14 +238,15 @@ RawSocketDevice::RecvPacketResult RawSocketDevice::receivePacket(RawPacket& rawP
 
 	if (bufferLen > 0)
 	{
-		timeval time;
-		gettimeofday(&time, NULL);
-		rawPacket.setRawData((const uint8_t*)buffer, bufferLen, time, LINKTYPE_ETHERNET);
+		uint8_t* buffer = new uint8_t[bufferLen];
+		memcpy(buffer, sockContainer->recvBuffer.data(), bufferLen);
+		timespec time;
+		clock_gettime(CLOCK_REALTIME, &time);
+		rawPacket.setRawData(buffer, bufferLen, time, LINKTYPE_ETHERNET, -1, true);
 		return RecvSuccess;
 	}
 
 	PCPP_LOG_ERROR("Buffer length is zero");
-	delete [] buffer;
 	return RecvError;
 
 #else
@@ -232,8 +273,27 @@ int RawSocketDevice::receivePackets(RawPacketVector& packetVec, int timeout, int
 
 	long timeoutSec = curSec + timeout;
 
+	// packets received from the ring point into ring memory that is returned to the kernel by the next receive calls, so the
+	// vector gets a copy of each packet that owns its data
+	bool rxRingEnabled = isRxRingEnabled();
+	RawPacket rxRingPacket;
+
 	while (curSec < timeoutSec)
 	{
+		if (rxRingEnabled)
+		{
+			if (receivePacket(rxRingPacket, true, timeoutSec-curSec) == RecvSuccess)
+			{
+				packetVec.pushBack(new RawPacket(rxRingPacket));
+				packetCount++;
+			}
+			else
+				failedRecv++;
+
+			clockGetTime(curSec, curNsec);
+			continue;
+		}
+
 		RawPacket* rawPacket = new RawPacket();
 		if (receivePacket(*rawPacket, true, timeoutSec-curSec) == RecvSuccess)
 		{
@@ -252,6 +312,47 @@ int RawSocketDevice::receivePackets(RawPacketVector& packetVec, int timeout, int
 	return packetCount;
 }
 
+int RawSocketDevice::receivePackets(RawPacket* rawPacketsArr, int rawPacketArrLength, bool blocking, int timeout)
+{
+	if (!isOpened())
+	{
+		PCPP_LOG_ERROR("Device is not open");
+		return 0;
+	}
+
+	if (rawPacketsArr == nullptr || rawPacketArrLength <= 0)
+	{
+		PCPP_LOG_ERROR("Packet array is empty");
+		return 0;
+	}
+
+#if defined(__linux__)
+	SocketContainer* sockContainer = (SocketContainer*)m_Socket;
+	if (sockContainer->rxRing != nullptr)
+	{
+		// take packets from the current block only, so all of them remain valid until the next receive call
+		RecvPacketResult result = waitForRxRingBlock(blocking, timeout);
+		if (result != RecvSuccess)
+			return 0;
+
+		int packetCount = 0;
+		while (packetCount < rawPacketArrLength && sockContainer->rxRingPacketsLeftInBlock > 0)
+			fillPacketFromRxRing(rawPacketsArr[packetCount++]);
+
+		return packetCount;
+	}
+#endif
+
+	if (receivePacket(rawPacketsArr[0], blocking, timeout) != RecvSuccess)
+		return 0;
+
+	int packetCount = 1;
+	while (packetCount < rawPacketArrLength && receivePacket(rawPacketsArr[packetCount], false, -1) == RecvSuccess)
+		packetCount++;
+
+	return packetCount;
+}
+
 bool RawSocketDevice::sendPacket(const RawPacket* rawPacket)
 {
 #if defined(_WIN32)
@@ -267,8 +368,7 @@ bool RawSocketDevice::sendPacket(const RawPacket* rawPacket)
 		return false;
 	}
 
-	Packet packet((RawPacket*)rawPacket, OsiModelDataLinkLayer);
-	if (!packet.isPacketOfType(pcpp::Ethernet))
+	if (!isEthernetPacket(rawPacket))
 	{
 		PCPP_LOG_ERROR("Can't send non-Ethernet packets");
 		return false;
@@ -277,15 +377,7 @@ bool RawSocketDevice::sendPacket(const RawPacket* rawPacket)
 	int fd = ((SocketContainer*)m_Socket)->fd;
 
 	sockaddr_ll addr;
-	memset(&addr, 0, sizeof(struct sockaddr_ll));
-	addr.sll_family = htobe16(PF_PACKET);
-	addr.sll_protocol = htobe16(ETH_P_ALL);
-	addr.sll_halen = 6;
-	addr.sll_ifindex = ((SocketContainer*)m_Socket)->interfaceIndex;
-
-	EthLayer* ethLayer = packet.getLayerOfType<EthLayer>();
-	MacAddress dstMac = ethLayer->getDestMac();
-	dstMac.copyTo((uint8_t*)&(addr.sll_addr));
+	fillSendAddress(addr, ((SocketContainer*)m_Socket)->interfaceIndex, rawPacket);
 
 	if (::sendto(fd, ((RawPacket*)rawPacket)->getRawData(), ((RawPacket*)rawPacket)->getRawDataLen(), 0, (struct sockaddr*)&addr, sizeof(addr)) == -1)
 	{
@@ -303,8 +395,11 @@ bool RawSocketDevice::sendPacket(const RawPacket* rawPacket)
 #endif
 }
 
-int RawSocketDevice::sendPackets(const RawPacketVector& packetVec)
+int RawSocketDevice::sendPackets(const RawPacketVector& packetVec, int* numOfPacketsHandled)
 {
+	if (numOfPacketsHandled != nullptr)
+		*numOfPacketsHandled = 0;
+
 #if defined(_WIN32)
 
 	PCPP_LOG_ERROR("Sending packets with raw socket are not supported on Windows");
@@ -318,38 +413,37 @@ int RawSocketDevice::sendPackets(const RawPacketVector& packetVec)
 		return 0;
 	}
 
-	int fd = ((SocketContainer*)m_Socket)->fd;
-
-	sockaddr_ll addr;
-	memset(&addr, 0, sizeof(struct sockaddr_ll));
-	addr.sll_family = htobe16(PF_PACKET);
-	addr.sll_protocol = htobe16(ETH_P_ALL);
-	addr.sll_halen = 6;
-	addr.sll_ifindex = ((SocketContainer*)m_Socket)->interfaceIndex;
-
+	const RawPacket* batch[RAW_SOCKET_SEND_BATCH_SIZE];
+	int batchLen = 0;
 	int sendCount = 0;
+	int handledCount = 0;
+	int batchHandledCount = 0;
+	bool socketFull = false;
 
-	for (RawPacketVector::ConstVectorIterator iter = packetVec.begin(); iter != packetVec.end(); iter++)
+	for (RawPacketVector::ConstVectorIterator iter = packetVec.begin(); iter != packetVec.end() && !socketFull; iter++)
 	{
-		Packet packet(*iter, OsiModelDataLinkLayer);
-		if (!packet.isPacketOfType(pcpp::Ethernet))
+		batch[batchLen++] = *iter;
+		if (batchLen == RAW_SOCKET_SEND_BATCH_SIZE)
 		{
-			PCPP_LOG_DEBUG("Can't send non-Ethernet packets");
-			continue;
+			sendCount += sendPacketBatch(batch, batchLen, batchHandledCount);
+			handledCount += batchHandledCount;
+			// if the socket stayed full the rest of the packets aren't sent
+			socketFull = (batchHandledCount < batchLen);
+			batchLen = 0;
 		}
+	}
 
-		EthLayer* ethLayer = packet.getLayerOfType<EthLayer>();
-		MacAddress dstMac = ethLayer->getDestMac();
-		dstMac.copyTo((uint8_t*)&(addr.sll_addr));
+	if (batchLen > 0)
+	{
+		sendCount += sendPacketBatch(batch, batchLen, batchHandledCount);
+		handledCount += batchHandledCount;
+	}
 
-		if (::sendto(fd, (*iter)->getRawData(), (*iter)->getRawDataLen(), 0, (struct sockaddr*)&addr, sizeof(addr)) == -1)
-		{
-			PCPP_LOG_DEBUG("Failed to send packet. Error was: '" << strerror(errno) << "'");
-			continue;
-		}
+	if (handledCount < (int)packetVec.size())
+		PCPP_LOG_ERROR("Socket stayed full, " << (int)packetVec.size() - handledCount << " packets weren't sent");
 
-		sendCount++;
-	}
+	if (numOfPacketsHandled != nullptr)
+		*numOfPacketsHandled = handledCount;
 
 	return sendCount;
 
@@ -362,6 +456,59 @@ int RawSocketDevice::sendPackets(const RawPacketVector& packetVec)
 }
 
 
+int RawSocketDevice::sendPackets(const RawPacket* rawPacketsArr, int rawPacketArrLength, int* numOfPacketsHandled)
+{
+	if (numOfPacketsHandled != nullptr)
+		*numOfPacketsHandled = 0;
+
+#if defined(_WIN32)
+
+	PCPP_LOG_ERROR("Sending packets with raw socket are not supported on Windows");
+	return 0;
+
+#elif defined(__linux__)
+
+	if (!isOpened())
+	{
+		PCPP_LOG_ERROR("Device is not open");
+		return 0;
+	}
+
+	const RawPacket* batch[RAW_SOCKET_SEND_BATCH_SIZE];
+	int sendCount = 0;
+	int handledCount = 0;
+
+	for (int i = 0; i < rawPacketArrLength; i += RAW_SOCKET_SEND_BATCH_SIZE)
+	{
+		int batchLen = std::min(rawPacketArrLength - i, RAW_SOCKET_SEND_BATCH_SIZE);
+		for (int j = 0; j < batchLen; j++)
+			batch[j] = &rawPacketsArr[i + j];
+
+		int batchHandledCount = 0;
+		sendCount += sendPacketBatch(batch, batchLen, batchHandledCount);
+		handledCount += batchHandledCount;
+		// if the socket stayed full the rest of the packets aren't sent
+		if (batchHandledCount < batchLen)
+			break;
+	}
+
+	if (handledCount < rawPacketArrLength)
+		PCPP_LOG_ERROR("Socket stayed full, " << rawPacketArrLength - handledCount << " packets weren't sent");
+
+	if (numOfPacketsHandled != nullptr)
+		*numOfPacketsHandled = handledCount;
+
+	return sendCount;
+
+#else
+
+	PCPP_LOG_ERROR("Raw socket are not supported on this platform");
+	return 0;
+
+#endif
+}
+
+
 bool RawSocketDevice::open()
 {
 #if defined(_WIN32)
@@ -519,6 +666,7 @@ bool RawSocketDevice::open()
 	((SocketContainer*)m_Socket)->fd = fd;
 	((SocketContainer*)m_Socket)->interfaceIndex = ifaceIndex;
 	((SocketContainer*)m_Socket)->interfaceName = ifaceName;
+	((SocketContainer*)m_Socket)->recvBuffer.resize(RAW_SOCKET_BUFFER_LEN);
 
 	m_DeviceOpened = true;
 
@@ -533,6 +681,89 @@ bool RawSocketDevice::open()
 #endif
 }
 
+bool RawSocketDevice::open(const RxRingConfiguration& rxRingConfig)
+{
+#if defined(__linux__) && !(defined(__ANDROID_API__) && __ANDROID_API__ < 24)
+
+	if (rxRingConfig.blockSize == 0 || rxRingConfig.numOfBlocks == 0 || rxRingConfig.blockSize % getpagesize() != 0)
+	{
+		PCPP_LOG_ERROR("Receive ring block size must be a non-zero multiple of the page size (" << getpagesize() << ") and the number of blocks must be non-zero");
+		return false;
+	}
+
+	if (!open())
+		return false;
+
+	SocketContainer* sockContainer = (SocketContainer*)m_Socket;
+	int fd = sockContainer->fd;
+
+	int version = TPACKET_V3;
+	if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) == -1)
+	{
+		PCPP_LOG_ERROR("Cannot set TPACKET_V3 on raw socket. Error was: '" << strerror(errno) << "'");
+		close();
+		return false;
+	}
+
+	tpacket_req3 req;
+	memset(&req, 0, sizeof(req));
+	req.tp_block_size = rxRingConfig.blockSize;
+	req.tp_block_nr = rxRingConfig.numOfBlocks;
+	req.tp_frame_size = RX_RING_FRAME_SIZE;
+	req.tp_frame_nr = (rxRingConfig.blockSize / RX_RING_FRAME_SIZE) * rxRingConfig.numOfBlocks;
+	req.tp_retire_blk_tov = rxRingConfig.blockTimeoutMs;
+	if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) == -1)
+	{
+		PCPP_LOG_ERROR("Cannot set up receive ring on raw socket. Error was: '" << strerror(errno) << "'");
+		close();
+		return false;
+	}
+
+	size_t rxRingSize = (size_t)rxRingConfig.blockSize * rxRingConfig.numOfBlocks;
+	void* rxRing = mmap(nullptr, rxRingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (rxRing == MAP_FAILED)
+	{
+		PCPP_LOG_ERROR("Cannot map receive ring of size " << rxRingSize << ". Error was: '" << strerror(errno) << "'");
+		close();
+		return false;
+	}
+
+	sockContainer->rxRing = (uint8_t*)rxRing;
+	sockContainer->rxRingBlockSize = rxRingConfig.blockSize;
+	sockContainer->rxRingNumOfBlocks = rxRingConfig.numOfBlocks;
+
+	// packets are delivered to the ring only from the interface the socket is bound to
+	sockaddr_ll addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sll_family = PF_PACKET;
+	addr.sll_protocol = htobe16(ETH_P_ALL);
+	addr.sll_ifindex = sockContainer->interfaceIndex;
+	if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1)
+	{
+		PCPP_LOG_ERROR("Cannot bind raw socket to interface '" << sockContainer->interfaceName << "'. Error was: '" << strerror(errno) << "'");
+		close();
+		return false;
+	}
+
+	return true;
+
+#else
+
+	PCPP_LOG_ERROR("Receive ring is supported on Linux only");
+	return false;
+
+#endif
+}
+
+bool RawSocketDevice::isRxRingEnabled() const
+{
+#if defined(__linux__)
+	return m_Socket != nullptr && m_DeviceOpened && ((SocketContainer*)m_Socket)->rxRing != nullptr;
+#else
+	return false;
+#endif
+}
+
 void RawSocketDevice::close()
 {
 	if (m_Socket != nullptr && isOpened())
@@ -541,6 +772,8 @@ void RawSocketDevice::close()
 #if defined(_WIN32)
 		closesocket(sockContainer->fd);
 #elif defined(__linux__)
+		if (sockContainer->rxRing != nullptr)
+			munmap(sockContainer->rxRing, (size_t)sockContainer->rxRingBlockSize * sockContainer->rxRingNumOfBlocks);
 		::close(sockContainer->fd);
 #endif
 		delete sockContainer;
@@ -569,4 +802,223 @@ RawSocketDevice::RecvPacketResult RawSocketDevice::getError(int& errorCode) cons
 #endif
 }
 
+bool RawSocketDevice::setReceiveMode(bool blocking, int timeout)
+{
+#if defined(__linux__)
+	SocketContainer* sockContainer = (SocketContainer*)m_Socket;
+
+	// value of 0 timeout means disabling timeout
+	if (timeout < 0)
+		timeout = 0;
+
+	// set blocking or non-blocking flag
+	if (blocking != sockContainer->blocking)
+	{
+		int flags = fcntl(sockContainer->fd, F_GETFL, 0);
+		if (flags == -1)
+		{
+			PCPP_LOG_ERROR("Cannot get socket flags");
+			return false;
+		}
+		flags = (blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK));
+		if (fcntl(sockContainer->fd, F_SETFL, flags) != 0)
+		{
+			PCPP_LOG_ERROR("Cannot set socket non-blocking flag");
+			return false;
+		}
+		sockContainer->blocking = blocking;
+	}
+
+	// set timeout on socket
+	if (timeout != sockContainer->timeout)
+	{
+		struct timeval timeoutVal;
+		timeoutVal.tv_sec = timeout;
+		timeoutVal.tv_usec = 0;
+		setsockopt(sockContainer->fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeoutVal, sizeof(timeoutVal));
+		sockContainer->timeout = timeout;
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+RawSocketDevice::RecvPacketResult RawSocketDevice::waitForRxRingBlock(bool blocking, int timeout)
+{
+#if defined(__linux__)
+	SocketContainer* sockContainer = (SocketContainer*)m_Socket;
+
+	long deadlineSec = 0, deadlineNSec = 0;
+	if (blocking && timeout > 0)
+	{
+		clockGetTime(deadlineSec, deadlineNSec);
+		deadlineSec += timeout;
+	}
+
+	while (sockContainer->rxRingPacketsLeftInBlock == 0)
+	{
+		tpacket_block_desc* blockDesc = (tpacket_block_desc*)(sockContainer->rxRing + (size_t)sockContainer->rxRingCurBlock * sockContainer->rxRingBlockSize);
+
+		// all packets of the current block were read, return it to the kernel and move to the next one
+		if (sockContainer->rxRingBlockInUse)
+		{
+			__atomic_store_n(&blockDesc->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+			sockContainer->rxRingBlockInUse = false;
+			sockContainer->rxRingCurBlock = (sockContainer->rxRingCurBlock + 1) % sockContainer->rxRingNumOfBlocks;
+			continue;
+		}
+
+		if ((__atomic_load_n(&blockDesc->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+		{
+			if (!blocking)
+				return RecvWouldBlock;
+
+			int pollTimeoutMs = -1;
+			if (timeout > 0)
+			{
+				long curSec, curNSec;
+				clockGetTime(curSec, curNSec);
+				long remainingMs = (deadlineSec - curSec) * 1000 + (deadlineNSec - curNSec) / 1000000;
+				if (remainingMs <= 0)
+					return RecvTimeout;
+				pollTimeoutMs = (int)remainingMs;
+			}
+
+			pollfd pfd;
+			pfd.fd = sockContainer->fd;
+			pfd.events = POLLIN | POLLERR;
+			pfd.revents = 0;
+			int pollResult = poll(&pfd, 1, pollTimeoutMs);
+			if (pollResult < 0 && errno != EINTR)
+			{
+				PCPP_LOG_ERROR("Error waiting for packets on the receive ring. Error was: '" << strerror(errno) << "'");
+				return RecvError;
+			}
+			if (pollResult == 0)
+				return RecvTimeout;
+
+			continue;
+		}
+
+		sockContainer->rxRingBlockInUse = true;
+		sockContainer->rxRingPacketsLeftInBlock = blockDesc->hdr.bh1.num_pkts;
+		sockContainer->rxRingCurPacket = (tpacket3_hdr*)((uint8_t*)blockDesc + blockDesc->hdr.bh1.offset_to_first_pkt);
+	}
+
+	return RecvSuccess;
+#else
+	return RecvError;
+#endif
+}
+
+void RawSocketDevice::fillPacketFromRxRing(RawPacket& rawPacket)
+{
+#if defined(__linux__)
+	SocketContainer* sockContainer = (SocketContainer*)m_Socket;
+	tpacket3_hdr* packetHeader = sockContainer->rxRingCurPacket;
+
+	timespec time;
+	time.tv_sec = packetHeader->tp_sec;
+	time.tv_nsec = packetHeader->tp_nsec;
+	rawPacket.setRawData((uint8_t*)packetHeader + packetHeader->tp_mac, packetHeader->tp_snaplen, time, LINKTYPE_ETHERNET, packetHeader->tp_len, false);
+
+	sockContainer->rxRingCurPacket = (tpacket3_hdr*)((uint8_t*)packetHeader + packetHeader->tp_next_offset);
+	sockContainer->rxRingPacketsLeftInBlock--;
+#endif
+}
+
+int RawSocketDevice::sendPacketBatch(const RawPacket** rawPackets, int numOfPackets, int& numOfPacketsHandled)
+{
+	numOfPacketsHandled = numOfPackets;
+
+#if defined(__linux__)
+	SocketContainer* sockContainer = (SocketContainer*)m_Socket;
+
+	mmsghdr msgs[RAW_SOCKET_SEND_BATCH_SIZE];
+	iovec iovecs[RAW_SOCKET_SEND_BATCH_SIZE];
+	sockaddr_ll addrs[RAW_SOCKET_SEND_BATCH_SIZE];
+	// the index of the packet each message was made of, as non-Ethernet packets don't get a message
+	int packetIndexes[RAW_SOCKET_SEND_BATCH_SIZE];
+	int msgCount = 0;
+
+	for (int i = 0; i < numOfPackets; i++)
+	{
+		if (!isEthernetPacket(rawPackets[i]))
+		{
+			PCPP_LOG_DEBUG("Can't send non-Ethernet packets");
+			continue;
+		}
+
+		fillSendAddress(addrs[msgCount], sockContainer->interfaceIndex, rawPackets[i]);
+		iovecs[msgCount].iov_base = (void*)rawPackets[i]->getRawData();
+		iovecs[msgCount].iov_len = rawPackets[i]->getRawDataLen();
+		memset(&msgs[msgCount], 0, sizeof(mmsghdr));
+		msgs[msgCount].msg_hdr.msg_name = &addrs[msgCount];
+		msgs[msgCount].msg_hdr.msg_namelen = sizeof(sockaddr_ll);
+		msgs[msgCount].msg_hdr.msg_iov = &iovecs[msgCount];
+		msgs[msgCount].msg_hdr.msg_iovlen = 1;
+		packetIndexes[msgCount] = i;
+		msgCount++;
+	}
+
+	// sendmmsg stops at the first message that fails. If the socket or device queue is full the rest of the batch is retried once the
+	// socket is writable, otherwise the failed packet is skipped and the rest of the batch is sent. The retries are counted for the whole
+	// batch, and when they run out the rest of the batch is left to the caller
+	int sendCount = 0;
+	int offset = 0;
+	int retries = 0;
+	while (offset < msgCount)
+	{
+		int result = sendmmsg(sockContainer->fd, &msgs[offset], msgCount - offset, 0);
+		if (result < 0)
+		{
+			int sendError = errno;
+			if (sendError == EINTR)
+				continue;
+
+			if (sendError == EAGAIN || sendError == EWOULDBLOCK || sendError == ENOBUFS)
+			{
+				if (retries == RAW_SOCKET_SEND_MAX_RETRIES)
+				{
+					numOfPacketsHandled = packetIndexes[offset];
+					break;
+				}
+
+				retries++;
+				if (sendError == ENOBUFS)
+				{
+					// a full device queue doesn't make the socket unwritable, so give the queue some time to drain
+					usleep(RAW_SOCKET_SEND_RETRY_TIMEOUT_MS * 1000);
+				}
+				else
+				{
+					pollfd pollFd;
+					pollFd.fd = sockContainer->fd;
+					pollFd.events = POLLOUT;
+					pollFd.revents = 0;
+					poll(&pollFd, 1, RAW_SOCKET_SEND_RETRY_TIMEOUT_MS);
+				}
+				continue;
+			}
+
+			PCPP_LOG_ERROR("Failed to send packet. Error was: '" << strerror(sendError) << "'");
+			offset++;
+			continue;
+		}
+
+		sendCount += result;
+		offset += result;
+	}
+
+	if (sendCount < msgCount)
+		PCPP_LOG_ERROR("Sent only " << sendCount << " out of " << msgCount << " packets in batch");
+
+	return sendCount;
+#else
+	return 0;
+#endif
+}
+
 }
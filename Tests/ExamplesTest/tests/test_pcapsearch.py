@@ -1,4 +1,5 @@
 from os import path
+import os
 import pytest
 import re
 import ntpath
@@ -54,6 +55,35 @@ class TestPcapSearch(ExampleTest):
         assert ".pcapng'" in completed_process.stdout
         assert not ".pcap'" in completed_process.stdout
 
+    @pytest.mark.parametrize("num_of_threads", [2, 4])
+    def test_multi_threaded(self, tmpdir, num_of_threads):
+        single_thread_report = os.path.join(tmpdir, "report_single_thread.txt")
+        multi_thread_report = os.path.join(tmpdir, "report_multi_thread.txt")
+        args = {"-d": "pcap_examples", "-s": "udp", "-r": single_thread_report}
+        single_thread_output = self.run_example(args=args).stdout
+        args = {"-d": "pcap_examples", "-s": "udp", "-r": multi_thread_report, "-t": str(num_of_threads)}
+        multi_thread_output = self.run_example(args=args).stdout
+
+        def found_lines(output):
+            return [line for line in output.splitlines() if "packets found in" in line or line.startswith("Done!")]
+
+        assert found_lines(single_thread_output) == found_lines(multi_thread_output)
+        with open(single_thread_report) as f1, open(multi_thread_report) as f2:
+            assert f1.read() == f2.read()
+
+    def test_search_index(self, tmpdir):
+        index_file = os.path.join(tmpdir, "search_index.txt")
+        args = {"-d": "pcap_examples", "-s": "icmp", "-x": index_file, "-t": "2"}
+        completed_process = self.run_example(args=args)
+        assert "92 packets were matched to search criteria" in completed_process.stdout
+        assert "0 files weren't read thanks to the search index" in completed_process.stdout
+        assert path.exists(index_file)
+
+        completed_process = self.run_example(args=args)
+        assert "92 packets were matched to search criteria" in completed_process.stdout
+        match = re.search(r"(\d+) files weren't read thanks to the search index", completed_process.stdout)
+        assert match is not None and int(match.group(1)) > 0
+
     def test_no_args(self):
         args = {}
         completed_process = self.run_example(args=args, expected_return_code=1)
@@ -1,5 +1,6 @@
 import pytest
 import os
+import filecmp
 from typing import Any
 import ipaddress
 from scapy.all import rdpcap, IP, IPv6, TCP, UDP
@@ -296,6 +297,42 @@ class TestPcapSplitter(ExampleTest):
                 <= num_of_packets_per_file + 1
             )
 
+    @pytest.mark.parametrize(
+        "method, param",
+        [
+            ("file-size", "100000"),
+            ("round-robin", "10"),
+            ("client-ip", None),
+            ("server-port", "5"),
+            ("connection", None),
+            ("connection", "300"),
+        ],
+    )
+    def test_split_multi_threaded(self, tmpdir, method, param):
+        single_thread_dir = tmpdir.mkdir("single_thread")
+        multi_thread_dir = tmpdir.mkdir("multi_thread")
+        args = {
+            "-f": os.path.join("pcap_examples", "many-protocols.pcap"),
+            "-o": single_thread_dir,
+            "-m": method,
+        }
+        if param is not None:
+            args["-p"] = param
+        self.run_example(args=args)
+
+        args["-o"] = multi_thread_dir
+        args["-t"] = "4"
+        completed_process = self.run_example(args=args)
+        assert "Throughput:" in completed_process.stdout
+
+        output_files = sorted(os.listdir(single_thread_dir))
+        assert sorted(os.listdir(multi_thread_dir)) == output_files
+        _, mismatch, errors = filecmp.cmpfiles(
+            single_thread_dir, multi_thread_dir, output_files, shallow=False
+        )
+        assert mismatch == []
+        assert errors == []
+
     def test_input_file_not_given(self):
         args = {}
         completed_process = self.run_example(args=args, expected_return_code=1)
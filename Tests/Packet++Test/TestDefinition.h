@@ -44,6 +44,10 @@ PTF_TEST_CASE(TcpChecksumMultiBuffer);
 PTF_TEST_CASE(PacketUtilsHash5TupleUdp);
 PTF_TEST_CASE(PacketUtilsHash5TupleTcp);
 PTF_TEST_CASE(PacketUtilsHash5TupleIPv6);
+PTF_TEST_CASE(PacketUtilsComputeChecksum);
+PTF_TEST_CASE(PacketUtilsIncrementalChecksum);
+PTF_TEST_CASE(PacketUtilsFlowKey);
+PTF_TEST_CASE(PacketUtilsFlowTable);
 
 // Implemented in PacketTests.cpp
 PTF_TEST_CASE(InsertDataToPacket);
@@ -57,10 +61,14 @@ PTF_TEST_CASE(ParsePartialPacketTest);
 PTF_TEST_CASE(PacketTrailerTest);
 PTF_TEST_CASE(ResizeLayerTest);
 PTF_TEST_CASE(PrintPacketAndLayers);
+PTF_TEST_CASE(LayerThreadCacheTest);
+PTF_TEST_CASE(LazyPacketParsingTest);
+PTF_TEST_CASE(TaggedLayerLookupTest);
 
 // Implemented in HttpTests.cpp
 PTF_TEST_CASE(HttpRequestParseMethodTest);
 PTF_TEST_CASE(HttpRequestLayerParsingTest);
+PTF_TEST_CASE(HttpRequestLayerFieldIndexTest);
 PTF_TEST_CASE(HttpRequestLayerCreationTest);
 PTF_TEST_CASE(HttpRequestLayerEditTest);
 PTF_TEST_CASE(HttpResponseParseStatusCodeTest);
@@ -85,6 +93,7 @@ PTF_TEST_CASE(DnsLayerRemoveResourceTest);
 PTF_TEST_CASE(DnsOverTcpParsingTest);
 PTF_TEST_CASE(DnsOverTcpCreationTest);
 PTF_TEST_CASE(DnsLayerAddDnsKeyTest);
+PTF_TEST_CASE(DnsRecordIterationTest);
 
 // Implemented in IcmpTests.cpp
 PTF_TEST_CASE(IcmpParsingTest);
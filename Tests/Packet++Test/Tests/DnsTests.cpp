@@ -1,6 +1,7 @@
 #include "../TestDefinition.h"
 #include "../Utils/TestUtils.h"
 #include <sstream>
+#include <vector>
 #include "EndianPortable.h"
 #include "Logger.h"
 #include "Packet.h"
@@ -757,3 +758,106 @@ PTF_TEST_CASE(DnsNXDomainTest)
 
 	PTF_ASSERT_EQUAL(1, dnsLayer->getDnsHeader()->queryOrResponse);
 } // DnsNXDomainTest
+
+
+
+PTF_TEST_CASE(DnsRecordIterationTest)
+{
+	timeval time;
+	gettimeofday(&time, nullptr);
+
+	// the records read from the layer data are the same as the DnsQuery and DnsResource objects of the layer
+	const char* dnsFiles[] = {
+		"PacketExamples/Dns1.dat", "PacketExamples/Dns2.dat", "PacketExamples/Dns3.dat", "PacketExamples/Dns4.dat",
+		"PacketExamples/DnsEdit1.dat", "PacketExamples/DnsEdit2.dat", "PacketExamples/DnsEdit3.dat", "PacketExamples/DnsEdit4.dat",
+		"PacketExamples/DnsEdit5.dat", "PacketExamples/DnsEdit6.dat", "PacketExamples/DnsEdit7.dat", "PacketExamples/DNS_NXDomain.dat",
+		"PacketExamples/DnsTooManyResources.dat", "PacketExamples/dns_over_tcp_query.dat", "PacketExamples/dns_over_tcp_response.dat",
+		"PacketExamples/dns_over_tcp_answer.dat", "PacketExamples/dns_over_tcp_answer2.dat"
+	};
+
+	for (size_t i = 0; i < sizeof(dnsFiles) / sizeof(dnsFiles[0]); i++)
+	{
+		READ_FILE_AND_CREATE_PACKET(1, dnsFiles[i]);
+		pcpp::Packet dnsPacket(&rawPacket1);
+		pcpp::DnsLayer* dnsLayer = dnsPacket.getLayerOfType<pcpp::DnsLayer>();
+		PTF_ASSERT_NOT_NULL(dnsLayer);
+
+		// read all records before the layer creates its resources
+		std::vector<pcpp::DnsRecordInfo> records;
+		pcpp::DnsRecordInfo record;
+		bool recordFound = dnsLayer->getFirstRecord(record);
+		while (recordFound)
+		{
+			records.push_back(record);
+			recordFound = dnsLayer->getNextRecord(record);
+		}
+
+		std::vector<pcpp::IDnsResource*> resources;
+		for (pcpp::DnsQuery* query = dnsLayer->getFirstQuery(); query != nullptr; query = dnsLayer->getNextQuery(query))
+			resources.push_back(query);
+		for (pcpp::DnsResource* answer = dnsLayer->getFirstAnswer(); answer != nullptr; answer = dnsLayer->getNextAnswer(answer))
+			resources.push_back(answer);
+		for (pcpp::DnsResource* authority = dnsLayer->getFirstAuthority(); authority != nullptr; authority = dnsLayer->getNextAuthority(authority))
+			resources.push_back(authority);
+		for (pcpp::DnsResource* additional = dnsLayer->getFirstAdditionalRecord(); additional != nullptr; additional = dnsLayer->getNextAdditionalRecord(additional))
+			resources.push_back(additional);
+
+		PTF_ASSERT_EQUAL(records.size(), resources.size());
+		for (size_t j = 0; j < records.size(); j++)
+		{
+			PTF_ASSERT_EQUAL(records[j].index, j);
+			PTF_ASSERT_EQUAL(records[j].resourceType, resources[j]->getType(), enum);
+			PTF_ASSERT_EQUAL(records[j].offsetInLayer, resources[j]->getNameOffset());
+			PTF_ASSERT_EQUAL(records[j].size, resources[j]->getSize());
+			PTF_ASSERT_EQUAL(records[j].dnsType, resources[j]->getDnsType(), enum);
+			PTF_ASSERT_EQUAL(records[j].dnsClass, resources[j]->getDnsClass());
+
+			char name[pcpp::DnsLayer::MaxDecodedNameLength + 1];
+			size_t nameLength = dnsLayer->decodeName(records[j].offsetInLayer, name, sizeof(name));
+			PTF_ASSERT_EQUAL(std::string(name, nameLength), resources[j]->getName());
+
+			if (records[j].resourceType == pcpp::DnsQueryType)
+			{
+				PTF_ASSERT_EQUAL(records[j].ttl, 0);
+				PTF_ASSERT_EQUAL(records[j].dataLength, 0);
+				continue;
+			}
+
+			pcpp::DnsResource* resource = static_cast<pcpp::DnsResource*>(resources[j]);
+			PTF_ASSERT_EQUAL(records[j].ttl, resource->getTTL());
+			PTF_ASSERT_EQUAL(records[j].dataOffset, resource->getDataOffset());
+			PTF_ASSERT_EQUAL(records[j].dataLength, resource->getDataLength());
+
+			if (records[j].dnsType == pcpp::DNS_TYPE_CNAME || records[j].dnsType == pcpp::DNS_TYPE_NS || records[j].dnsType == pcpp::DNS_TYPE_PTR)
+			{
+				nameLength = dnsLayer->decodeName(records[j].dataOffset, name, sizeof(name));
+				PTF_ASSERT_EQUAL(std::string(name, nameLength), resource->getData()->toString());
+			}
+		}
+	}
+
+
+	// names are truncated to the buffer size
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/Dns3.dat");
+	pcpp::Packet dnsPacket(&rawPacket2);
+	pcpp::DnsLayer* dnsLayer = dnsPacket.getLayerOfType<pcpp::DnsLayer>();
+	PTF_ASSERT_NOT_NULL(dnsLayer);
+
+	pcpp::DnsRecordInfo record;
+	PTF_ASSERT_TRUE(dnsLayer->getFirstRecord(record));
+	PTF_ASSERT_EQUAL(record.resourceType, pcpp::DnsQueryType, enum);
+	char name[6];
+	PTF_ASSERT_EQUAL(dnsLayer->decodeName(record.offsetInLayer, name, sizeof(name)), 5);
+	PTF_ASSERT_EQUAL(std::string(name), "Yaels");
+	PTF_ASSERT_EQUAL(dnsLayer->decodeName(record.offsetInLayer, name, 1), 0);
+	PTF_ASSERT_EQUAL(std::string(name), "");
+
+	// the last record has no next record
+	int recordCount = 1;
+	while (dnsLayer->getNextRecord(record))
+		recordCount++;
+	PTF_ASSERT_EQUAL(recordCount, 5);
+	PTF_ASSERT_EQUAL(record.index, 4);
+	PTF_ASSERT_EQUAL(record.resourceType, pcpp::DnsAdditionalType, enum);
+	PTF_ASSERT_FALSE(dnsLayer->getNextRecord(record));
+} // DnsRecordIterationTest
@@ -10,6 +10,10 @@
 #include "PayloadLayer.h"
 #include "SystemUtils.h"
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <string.h>
 PTF_TEST_CASE(HttpRequestParseMethodTest)
 {
 	PTF_ASSERT_EQUAL(pcpp::HttpRequestFirstLine::parseMethod(nullptr, 0), pcpp::HttpRequestLayer::HttpMethod::HttpMethodUnknown, enum);
@@ -95,6 +99,93 @@ PTF_TEST_CASE(HttpRequestLayerParsingTest)
 
 
 
+PTF_TEST_CASE(HttpRequestLayerFieldIndexTest)
+{
+	// build a request with more fields than the inline field index can hold
+	std::ostringstream request;
+	request << "GET /index.html HTTP/1.1\r\n";
+	for (int i = 0; i < pcpp::TextBasedProtocolMessage::MaxInlineIndexedFields + 3; i++)
+		request << "Header-" << i << ": value-" << i << "\r\n";
+	request << "X-Dup: first\r\nX-Dup:  second\r\nX-Empty:\r\n\r\n";
+	std::string requestAsString = request.str();
+	int expectedFieldCount = pcpp::TextBasedProtocolMessage::MaxInlineIndexedFields + 6;
+
+	uint8_t* requestData = new uint8_t[requestAsString.length()];
+	memcpy(requestData, requestAsString.c_str(), requestAsString.length());
+	pcpp::HttpRequestLayer requestLayer(requestData, requestAsString.length(), nullptr, nullptr);
+
+	// these methods read the field index and don't create HeaderField objects
+	PTF_ASSERT_EQUAL(requestLayer.getFieldCount(), expectedFieldCount);
+	PTF_ASSERT_TRUE(requestLayer.isHeaderComplete());
+	PTF_ASSERT_EQUAL(requestLayer.getHeaderLen(), requestAsString.length());
+	PTF_ASSERT_EQUAL(requestLayer.getFieldValueByName("Header-0"), "value-0");
+	PTF_ASSERT_EQUAL(requestLayer.getFieldValueByName("HEADER-14"), "value-14");
+	PTF_ASSERT_EQUAL(requestLayer.getFieldValueByName("x-dup"), "first");
+	PTF_ASSERT_EQUAL(requestLayer.getFieldValueByName("x-dup", 1), "second");
+	PTF_ASSERT_EQUAL(requestLayer.getFieldValueByName("x-dup", 2), "");
+	PTF_ASSERT_EQUAL(requestLayer.getFieldValueByName("X-Empty"), "");
+	PTF_ASSERT_EQUAL(requestLayer.getFieldValueByName("Header"), "");
+	PTF_ASSERT_EQUAL(requestLayer.getFieldValueByName("Header-100"), "");
+
+	// a copy of a message whose fields weren't materialized
+	pcpp::HttpRequestLayer requestLayerCopy(requestLayer);
+	PTF_ASSERT_EQUAL(requestLayerCopy.getFieldValueByName("header-13"), "value-13");
+	PTF_ASSERT_EQUAL(requestLayerCopy.getFieldCount(), expectedFieldCount);
+	PTF_ASSERT_NOT_NULL(requestLayerCopy.getFieldByName("Header-13"));
+	PTF_ASSERT_EQUAL(requestLayerCopy.getFieldByName("Header-13")->getFieldValue(), "value-13");
+
+	// const methods may create the HeaderField objects from several threads at the same time
+	const pcpp::HttpRequestLayer sharedRequestLayer(requestLayer);
+	const int numOfThreads = 4;
+	pcpp::HeaderField* firstFields[numOfThreads];
+	pcpp::HeaderField* foundFields[numOfThreads];
+	std::string foundValues[numOfThreads];
+	std::vector<std::thread> threads;
+	for (int i = 0; i < numOfThreads; i++)
+	{
+		threads.push_back(std::thread([&sharedRequestLayer, &firstFields, &foundFields, &foundValues, i]()
+		{
+			foundValues[i] = sharedRequestLayer.getFieldValueByName("Header-12");
+			foundFields[i] = sharedRequestLayer.getFieldByName("Header-13");
+			firstFields[i] = sharedRequestLayer.getFirstField();
+		}));
+	}
+	for (int i = 0; i < numOfThreads; i++)
+		threads[i].join();
+
+	for (int i = 0; i < numOfThreads; i++)
+	{
+		PTF_ASSERT_EQUAL(foundValues[i], "value-12");
+		PTF_ASSERT_NOT_NULL(foundFields[i]);
+		PTF_ASSERT_EQUAL(foundFields[i], foundFields[0], ptr);
+		PTF_ASSERT_EQUAL(firstFields[i], firstFields[0], ptr);
+	}
+	PTF_ASSERT_EQUAL(foundFields[0]->getFieldValue(), "value-13");
+	PTF_ASSERT_EQUAL(sharedRequestLayer.getFieldCount(), expectedFieldCount);
+
+	// editing the first line moves the fields before any HeaderField object was created
+	std::string newUri = "/a/much/longer/uri/than/before.html";
+	PTF_ASSERT_TRUE(requestLayer.getFirstLine()->setUri(newUri));
+	PTF_ASSERT_EQUAL(requestLayer.getFieldValueByName("Header-3"), "value-3");
+	pcpp::HeaderField* field = requestLayer.getFieldByName("header-3");
+	PTF_ASSERT_NOT_NULL(field);
+	PTF_ASSERT_EQUAL(field->getFieldName(), "Header-3");
+	PTF_ASSERT_EQUAL(field->getFieldValue(), "value-3");
+	PTF_ASSERT_EQUAL(requestLayer.getFieldCount(), expectedFieldCount);
+	PTF_ASSERT_EQUAL(requestLayer.getHeaderLen(), requestAsString.length() + newUri.length() - strlen("/index.html"));
+
+	// edit fields after they were materialized
+	PTF_ASSERT_TRUE(field->setFieldValue("a-longer-value"));
+	PTF_ASSERT_EQUAL(requestLayer.getFieldValueByName("Header-3"), "a-longer-value");
+	PTF_ASSERT_TRUE(requestLayer.removeField("x-dup"));
+	PTF_ASSERT_EQUAL(requestLayer.getFieldValueByName("X-Dup"), "second");
+	PTF_ASSERT_NOT_NULL(requestLayer.insertField(requestLayer.getFieldByName("Header-0"), "Header-New", "new-value"));
+	PTF_ASSERT_EQUAL(requestLayer.getFieldValueByName("header-new"), "new-value");
+	PTF_ASSERT_EQUAL(requestLayer.getFieldCount(), expectedFieldCount);
+} // HttpRequestLayerFieldIndexTest
+
+
+
 PTF_TEST_CASE(HttpRequestLayerCreationTest)
 {
 	timeval time;
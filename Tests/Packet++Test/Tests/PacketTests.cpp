@@ -8,6 +8,7 @@
 #include "IPv6Layer.h"
 #include "PPPoELayer.h"
 #include "VlanLayer.h"
+#include "MplsLayer.h"
 #include "IcmpLayer.h"
 #include "TcpLayer.h"
 #include "UdpLayer.h"
@@ -18,6 +19,7 @@
 #include "RadiusLayer.h"
 #include "PacketTrailerLayer.h"
 #include "PayloadLayer.h"
+#include "LayerAllocator.h"
 #include "GeneralUtils.h"
 #include "SystemUtils.h"
 
@@ -563,6 +565,18 @@ PTF_TEST_CASE(CopyLayerAndPacketTest)
 } // CopyLayerAndPacketTest
 
 
+// the way Packet::getLayerOfType() looked layers up before layer classes were tagged with their protocol
+template<class TLayer>
+TLayer* getLayerOfTypeWithDynamicCast(pcpp::Packet& packet, bool reverse)
+{
+	pcpp::Layer* curLayer = (reverse ? packet.getLastLayer() : packet.getFirstLayer());
+	while (curLayer != nullptr && dynamic_cast<TLayer*>(curLayer) == nullptr)
+		curLayer = (reverse ? curLayer->getPrevLayer() : curLayer->getNextLayer());
+
+	return dynamic_cast<TLayer*>(curLayer);
+}
+
+
 PTF_TEST_CASE(PacketLayerLookupTest)
 {
 	timeval time;
@@ -1041,3 +1055,250 @@ PTF_TEST_CASE(PrintPacketAndLayers)
 	packet.toStringList(packetAsStringList);
 	PTF_ASSERT_TRUE(packetAsStringList == expectedLayerStrings);
 } // PrintPacketAndLayer
+
+
+
+PTF_TEST_CASE(LayerThreadCacheTest)
+{
+	timeval time;
+	gettimeofday(&time, nullptr);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TcpPacketWithOptions3.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/Vxlan1.dat");
+
+	PTF_ASSERT_FALSE(pcpp::LayerAllocator::isThreadCacheEnabled());
+
+	// layers aren't cached when the cache is disabled
+	{
+		pcpp::Packet packet(&rawPacket1);
+		PTF_ASSERT_NOT_NULL(packet.getLayerOfType<pcpp::TcpLayer>());
+	}
+	PTF_ASSERT_EQUAL(pcpp::LayerAllocator::getThreadCacheSize(), 0);
+
+	pcpp::LayerAllocator::enableThreadCache();
+	PTF_ASSERT_TRUE(pcpp::LayerAllocator::isThreadCacheEnabled());
+
+	size_t numOfLayers = 0;
+	{
+		pcpp::Packet packet(&rawPacket1);
+		for (pcpp::Layer* layer = packet.getFirstLayer(); layer != nullptr; layer = layer->getNextLayer())
+			numOfLayers++;
+		PTF_ASSERT_EQUAL(pcpp::LayerAllocator::getThreadCacheSize(), 0);
+	}
+	// all layers are now cached
+	PTF_ASSERT_EQUAL(pcpp::LayerAllocator::getThreadCacheSize(), numOfLayers);
+
+	// re-parsing the same packet reuses all of the cached storage
+	{
+		pcpp::Packet packet(&rawPacket1);
+		PTF_ASSERT_EQUAL(pcpp::LayerAllocator::getThreadCacheSize(), 0);
+		pcpp::TcpLayer* tcpLayer = packet.getLayerOfType<pcpp::TcpLayer>();
+		PTF_ASSERT_NOT_NULL(tcpLayer);
+		PTF_ASSERT_EQUAL(tcpLayer->getSrcPort(), 60225);
+
+		// re-parse the packet object with a different raw packet
+		packet.setRawPacket(&rawPacket2, false);
+		pcpp::IPv4Layer* ipLayer = packet.getLayerOfType<pcpp::IPv4Layer>(true);
+		PTF_ASSERT_NOT_NULL(ipLayer);
+		PTF_ASSERT_EQUAL(ipLayer->getSrcIPAddress(), pcpp::IPv4Address("192.168.203.3"));
+	}
+	PTF_ASSERT_GREATER_OR_EQUAL_THAN(pcpp::LayerAllocator::getThreadCacheSize(), numOfLayers);
+
+	// layers created by the user are also served from the cache
+	size_t cacheSize = pcpp::LayerAllocator::getThreadCacheSize();
+	auto newEthLayer = new pcpp::EthLayer(pcpp::MacAddress("aa:bb:cc:dd:ee:ff"), pcpp::MacAddress("11:22:33:44:55:66"));
+	PTF_ASSERT_EQUAL(pcpp::LayerAllocator::getThreadCacheSize(), cacheSize - 1);
+	delete newEthLayer;
+	PTF_ASSERT_EQUAL(pcpp::LayerAllocator::getThreadCacheSize(), cacheSize);
+
+	// the cache size is bounded, layers freed beyond the limit go back to the heap
+	pcpp::LayerAllocator::enableThreadCache(0);
+	{
+		pcpp::Packet packet(&rawPacket2);
+	}
+	PTF_ASSERT_LOWER_THAN(pcpp::LayerAllocator::getThreadCacheSize(), cacheSize);
+
+	pcpp::LayerAllocator::disableThreadCache();
+	PTF_ASSERT_FALSE(pcpp::LayerAllocator::isThreadCacheEnabled());
+	PTF_ASSERT_EQUAL(pcpp::LayerAllocator::getThreadCacheSize(), 0);
+} // LayerThreadCacheTest
+
+
+
+PTF_TEST_CASE(LazyPacketParsingTest)
+{
+	timeval time;
+	gettimeofday(&time, nullptr);
+
+	const char* fileNames[] = {
+		"PacketExamples/TwoHttpRequests1.dat",
+		"PacketExamples/SSL-ClientHello1.dat",
+		"PacketExamples/IGMPv1_1.dat",
+		"PacketExamples/PPPoESession2.dat",
+		"PacketExamples/GREv0_2.dat",
+		"PacketExamples/Dns1.dat",
+		"PacketExamples/packet_trailer_ipv4.dat",
+		"PacketExamples/packet_trailer_arp.dat"
+	};
+
+	// a lazily parsed packet has the same layers as an eagerly parsed packet, whichever way they're reached
+	for (size_t i = 0; i < sizeof(fileNames) / sizeof(fileNames[0]); i++)
+	{
+		int bufferLength = 0;
+		uint8_t* buffer = pcpp_tests::readFileIntoBuffer(fileNames[i], bufferLength);
+		PTF_ASSERT_NOT_NULL(buffer);
+		pcpp::RawPacket rawPacket(buffer, bufferLength, time, true);
+
+		pcpp::Packet eagerPacket(&rawPacket);
+
+		pcpp::Packet lazyPacket(&rawPacket, pcpp::LazyParsing);
+		PTF_ASSERT_NOT_NULL(lazyPacket.getFirstLayer());
+		PTF_ASSERT_EQUAL(lazyPacket.getFirstLayer()->getProtocol(), eagerPacket.getFirstLayer()->getProtocol());
+		pcpp::Layer* eagerLayer = eagerPacket.getFirstLayer();
+		pcpp::Layer* lazyLayer = lazyPacket.getFirstLayer();
+		while (eagerLayer != nullptr)
+		{
+			PTF_ASSERT_NOT_NULL(lazyLayer);
+			PTF_ASSERT_EQUAL(lazyLayer->getProtocol(), eagerLayer->getProtocol());
+			PTF_ASSERT_EQUAL(lazyLayer->getData(), eagerLayer->getData(), ptr);
+			PTF_ASSERT_EQUAL(lazyLayer->getDataLen(), eagerLayer->getDataLen());
+			PTF_ASSERT_TRUE(lazyPacket.isPacketOfType(eagerLayer->getProtocol()));
+			eagerLayer = eagerLayer->getNextLayer();
+			lazyLayer = lazyLayer->getNextLayer();
+		}
+		PTF_ASSERT_NULL(lazyLayer);
+		PTF_ASSERT_EQUAL(lazyPacket.toString(), eagerPacket.toString());
+
+		// the last layer and protocol queries parse the whole packet
+		lazyPacket.setRawPacket(&rawPacket, false, pcpp::LazyParsing);
+		PTF_ASSERT_EQUAL(lazyPacket.getLastLayer()->getProtocol(), eagerPacket.getLastLayer()->getProtocol());
+		lazyPacket.setRawPacket(&rawPacket, false, pcpp::LazyParsing);
+		PTF_ASSERT_FALSE(lazyPacket.isPacketOfType(pcpp::Radius));
+		PTF_ASSERT_EQUAL(lazyPacket.getLastLayer()->getProtocol(), eagerPacket.getLastLayer()->getProtocol());
+		PTF_ASSERT_EQUAL(lazyPacket.toString(), eagerPacket.toString());
+	}
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+
+	// layers above the requested one aren't parsed, so they reflect the data as it is when they're reached
+	pcpp::Packet httpPacket(&rawPacket1, pcpp::LazyParsing);
+	pcpp::TcpLayer* tcpLayer = httpPacket.getLayerOfType<pcpp::TcpLayer>();
+	PTF_ASSERT_NOT_NULL(tcpLayer);
+	PTF_ASSERT_TRUE(httpPacket.isPacketOfType(pcpp::IPv4));
+	tcpLayer->getTcpHeader()->portDst = htobe16(12345);
+	tcpLayer->getTcpHeader()->portSrc = htobe16(12346);
+	PTF_ASSERT_FALSE(httpPacket.isPacketOfType(pcpp::HTTPRequest));
+	PTF_ASSERT_TRUE(httpPacket.isPacketOfType(pcpp::GenericPayload));
+	tcpLayer->getTcpHeader()->portDst = htobe16(80);
+
+	// packet manipulation works on a partially parsed packet
+	httpPacket.setRawPacket(&rawPacket1, false, pcpp::LazyParsing);
+	PTF_ASSERT_NOT_NULL(httpPacket.getLayerOfType<pcpp::IPv4Layer>());
+	pcpp::Packet copiedPacket(httpPacket);
+	PTF_ASSERT_TRUE(copiedPacket.isPacketOfType(pcpp::HTTPRequest));
+	PTF_ASSERT_TRUE(httpPacket.removeFirstLayer());
+	PTF_ASSERT_EQUAL(httpPacket.getFirstLayer()->getProtocol(), pcpp::IPv4, enum);
+	PTF_ASSERT_TRUE(httpPacket.isPacketOfType(pcpp::HTTPRequest));
+	PTF_ASSERT_FALSE(httpPacket.isPacketOfType(pcpp::Ethernet));
+	httpPacket.computeCalculateFields();
+	PTF_ASSERT_EQUAL(httpPacket.getLastLayer()->getProtocol(), pcpp::HTTPRequest, enum);
+} // LazyPacketParsingTest
+
+
+
+PTF_TEST_CASE(TaggedLayerLookupTest)
+{
+	timeval time;
+	gettimeofday(&time, nullptr);
+
+	const char* fileNames[] = {
+		"PacketExamples/TwoHttpRequests1.dat",
+		"PacketExamples/SSL-ClientHello1.dat",
+		"PacketExamples/IGMPv1_1.dat",
+		"PacketExamples/PPPoESession2.dat",
+		"PacketExamples/Dns1.dat",
+		"PacketExamples/Vxlan1.dat",
+		"PacketExamples/radius_1.dat",
+		"PacketExamples/packet_trailer_ipv4.dat"
+	};
+
+	// lookups by protocol find the same layers as dynamic_cast, in both parsing modes
+	for (size_t i = 0; i < sizeof(fileNames) / sizeof(fileNames[0]); i++)
+	{
+		int bufferLength = 0;
+		uint8_t* buffer = pcpp_tests::readFileIntoBuffer(fileNames[i], bufferLength);
+		PTF_ASSERT_NOT_NULL(buffer);
+		pcpp::RawPacket rawPacket(buffer, bufferLength, time, true);
+
+		pcpp::Packet eagerPacket(&rawPacket);
+		pcpp::Packet lazyPacket(&rawPacket, pcpp::LazyParsing);
+		pcpp::Packet* packets[] = { &eagerPacket, &lazyPacket };
+		for (pcpp::Packet* packet : packets)
+		{
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::EthLayer>()->getData(), getLayerOfTypeWithDynamicCast<pcpp::EthLayer>(eagerPacket, false)->getData(), ptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::IPv4Layer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::IPv4Layer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::TcpLayer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::TcpLayer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::UdpLayer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::UdpLayer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::HttpRequestLayer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::HttpRequestLayer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::SSLLayer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::SSLLayer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::SSLHandshakeLayer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::SSLHandshakeLayer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::IgmpLayer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::IgmpLayer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::IgmpV1Layer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::IgmpV1Layer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::IgmpV2Layer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::IgmpV2Layer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::PPPoELayer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::PPPoELayer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::PPPoEDiscoveryLayer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::PPPoEDiscoveryLayer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::DnsLayer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::DnsLayer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::RadiusLayer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::RadiusLayer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::PacketTrailerLayer>() != nullptr, getLayerOfTypeWithDynamicCast<pcpp::PacketTrailerLayer>(eagerPacket, false) != nullptr);
+			PTF_ASSERT_EQUAL(packet->getLayerOfType<pcpp::IPv4Layer>(true) != nullptr, getLayerOfTypeWithDynamicCast<pcpp::IPv4Layer>(eagerPacket, true) != nullptr);
+		}
+
+		// both packets parse the same buffer, so the layers of the eager packet can be compared by their data
+		pcpp::IPv4Layer* ipLayer = eagerPacket.getLayerOfType<pcpp::IPv4Layer>(true);
+		if (ipLayer != nullptr)
+		{
+			PTF_ASSERT_EQUAL(ipLayer, getLayerOfTypeWithDynamicCast<pcpp::IPv4Layer>(eagerPacket, true), ptr);
+			PTF_ASSERT_EQUAL(lazyPacket.getLayerOfType<pcpp::IPv4Layer>(true)->getData(), ipLayer->getData(), ptr);
+			PTF_ASSERT_EQUAL(eagerPacket.getLayerOfType(pcpp::IPv4), getLayerOfTypeWithDynamicCast<pcpp::IPv4Layer>(eagerPacket, false), ptr);
+		}
+	}
+
+	// the index follows layers added and removed from the packet
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	pcpp::Packet httpPacket(&rawPacket1);
+	pcpp::Packet copiedPacket(httpPacket);
+	PTF_ASSERT_EQUAL(copiedPacket.getLayerOfType<pcpp::HttpRequestLayer>()->getData(), copiedPacket.getLayerOfType<pcpp::TcpLayer>()->getLayerPayload(), ptr);
+	pcpp::VlanLayer vlanLayer(100, false, 1, PCPP_ETHERTYPE_IP);
+	PTF_ASSERT_NULL(httpPacket.getLayerOfType<pcpp::VlanLayer>());
+	PTF_ASSERT_TRUE(httpPacket.insertLayer(httpPacket.getFirstLayer(), &vlanLayer));
+	PTF_ASSERT_EQUAL(httpPacket.getLayerOfType<pcpp::VlanLayer>(), &vlanLayer, ptr);
+	PTF_ASSERT_EQUAL(httpPacket.getLayerOfType(pcpp::VLAN), &vlanLayer, ptr);
+	PTF_ASSERT_TRUE(httpPacket.removeFirstLayer());
+	PTF_ASSERT_EQUAL(httpPacket.getLayerOfType<pcpp::VlanLayer>(), &vlanLayer, ptr);
+	PTF_ASSERT_NULL(httpPacket.getLayerOfType<pcpp::EthLayer>());
+	PTF_ASSERT_TRUE(httpPacket.detachLayer(&vlanLayer));
+	PTF_ASSERT_NULL(httpPacket.getLayerOfType<pcpp::VlanLayer>());
+	PTF_ASSERT_EQUAL(httpPacket.getFirstLayer(), httpPacket.getLayerOfType<pcpp::IPv4Layer>(), ptr);
+
+	// protocols that don't fit in the index are still found
+	pcpp::Packet newPacket(100);
+	pcpp::EthLayer newEthLayer(pcpp::MacAddress("00:11:22:33:44:55"), pcpp::MacAddress("66:77:88:99:aa:bb"));
+	pcpp::VlanLayer newVlanLayer(100, false, 1, PCPP_ETHERTYPE_MPLS);
+	pcpp::MplsLayer newMplsLayer(100, 64, 0, true);
+	pcpp::IPv4Layer newIPv4Layer(pcpp::IPv4Address("1.1.1.1"), pcpp::IPv4Address("2.2.2.2"));
+	pcpp::IPv6Layer newIPv6Layer(pcpp::IPv6Address("fe80::1"), pcpp::IPv6Address("fe80::2"));
+	pcpp::UdpLayer newUdpLayer(1000, 2000);
+	pcpp::TcpLayer newTcpLayer(1000, 2000);
+	pcpp::IcmpLayer newIcmpLayer;
+	pcpp::IgmpV1Layer newIgmpLayer(pcpp::IgmpType_MembershipQuery);
+	pcpp::Layer* newLayers[] = { &newEthLayer, &newVlanLayer, &newMplsLayer, &newIPv4Layer, &newIPv6Layer, &newUdpLayer, &newTcpLayer, &newIcmpLayer, &newIgmpLayer };
+	for (pcpp::Layer* layer : newLayers)
+		PTF_ASSERT_TRUE(newPacket.addLayer(layer));
+
+	PTF_ASSERT_EQUAL(newPacket.getLayerOfType<pcpp::IcmpLayer>(), &newIcmpLayer, ptr);
+	PTF_ASSERT_EQUAL(newPacket.getLayerOfType<pcpp::IgmpV1Layer>(), &newIgmpLayer, ptr);
+	PTF_ASSERT_EQUAL(newPacket.getLayerOfType<pcpp::IgmpLayer>(), &newIgmpLayer, ptr);
+	PTF_ASSERT_EQUAL(newPacket.getLayerOfType(pcpp::IGMPv1), &newIgmpLayer, ptr);
+	PTF_ASSERT_NULL(newPacket.getLayerOfType<pcpp::IgmpV2Layer>());
+	PTF_ASSERT_NULL(newPacket.getLayerOfType<pcpp::DnsLayer>());
+} // TaggedLayerLookupTest
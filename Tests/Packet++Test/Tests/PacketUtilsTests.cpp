@@ -8,6 +8,10 @@
 #include "UdpLayer.h"
 #include "SystemUtils.h"
 #include "PacketUtils.h"
+#include "FlowTable.h"
+#include <vector>
+#include <map>
+#include <string.h>
 
 PTF_TEST_CASE(PacketUtilsHash5TupleUdp)
 {
@@ -134,3 +138,337 @@ PTF_TEST_CASE(PacketUtilsHash5TupleIPv6)
 	PTF_ASSERT_EQUAL(pcpp::hash5Tuple(&dstSrcPacket, true), 4288746927);
 
 } // PacketUtilsHash5TupleIPv6
+
+
+
+// a straightforward implementation of the Internet checksum (RFC 1071) to compare the optimized one to
+static uint16_t referenceChecksum(const uint8_t* data, size_t len)
+{
+	uint32_t sum = 0;
+	for (size_t i = 0; i + 1 < len; i += 2)
+		sum += (data[i] << 8) | data[i + 1];
+	if (len % 2)
+		sum += data[len - 1] << 8;
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t)~sum;
+}
+
+
+
+PTF_TEST_CASE(PacketUtilsComputeChecksum)
+{
+	std::vector<uint8_t> data(70000 + 16);
+	uint32_t seed = 12345;
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		data[i] = (uint8_t)(seed >> 16);
+	}
+
+	// cover the scalar and vector kernels, their tails, unaligned buffers and buffers long enough to flush the vector accumulators
+	size_t lengths[] = { 0, 1, 2, 7, 15, 16, 31, 33, 63, 64, 65, 127, 128, 511, 1499, 1500, 9000, 65535, 70000 };
+	for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+	{
+		for (size_t offset = 0; offset < 4; offset++)
+		{
+			pcpp::ScalarBuffer<uint16_t> vec;
+			vec.buffer = (uint16_t*)(data.data() + offset);
+			vec.len = lengths[i];
+			PTF_ASSERT_EQUAL(pcpp::computeChecksum(&vec, 1), referenceChecksum(data.data() + offset, lengths[i]));
+		}
+	}
+
+	// all ones data, which sums to the negative zero
+	std::vector<uint8_t> allOnes(4096, 0xff);
+	pcpp::ScalarBuffer<uint16_t> allOnesVec;
+	allOnesVec.buffer = (uint16_t*)allOnes.data();
+	allOnesVec.len = allOnes.size();
+	PTF_ASSERT_EQUAL(pcpp::computeChecksum(&allOnesVec, 1), 0);
+
+	// multiple buffers are summed as if they were concatenated, as long as all of them (except the last) have an even length
+	pcpp::ScalarBuffer<uint16_t> vecs[3];
+	vecs[0].buffer = (uint16_t*)data.data();
+	vecs[0].len = 1000;
+	vecs[1].buffer = (uint16_t*)(data.data() + 1000);
+	vecs[1].len = 100;
+	vecs[2].buffer = (uint16_t*)(data.data() + 1100);
+	vecs[2].len = 401;
+	PTF_ASSERT_EQUAL(pcpp::computeChecksum(vecs, 3), referenceChecksum(data.data(), 1501));
+
+	// updating a checksum incrementally gives the same result as recomputing it
+	uint16_t checksum = htobe16(referenceChecksum(data.data(), 1500));
+	uint8_t newData[8] = { 0x01, 0x02, 0x03, 0x04, 0xff, 0xff, 0x00, 0x00 };
+	uint8_t oldData[8];
+	memcpy(oldData, data.data() + 20, sizeof(oldData));
+	memcpy(data.data() + 20, newData, sizeof(newData));
+	PTF_ASSERT_EQUAL(pcpp::updateChecksum(checksum, oldData, newData, sizeof(newData)), htobe16(referenceChecksum(data.data(), 1500)));
+	PTF_ASSERT_EQUAL(pcpp::updateChecksum(checksum, oldData, oldData, sizeof(oldData)), checksum);
+} // PacketUtilsComputeChecksum
+
+
+
+PTF_TEST_CASE(PacketUtilsIncrementalChecksum)
+{
+	timeval time;
+	gettimeofday(&time, nullptr);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TcpPacketWithOptions3.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/UdpPacket4Checksum1.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/IPv6UdpPacket.dat");
+
+	// IPv4 + TCP: rewrite addresses, ports and TTL with the setters, the checksums must match a full recomputation
+	pcpp::Packet tcpPacket(&rawPacket1);
+	tcpPacket.computeCalculateFields();
+	pcpp::IPv4Layer* ipLayer = tcpPacket.getLayerOfType<pcpp::IPv4Layer>();
+	pcpp::TcpLayer* tcpLayer = tcpPacket.getLayerOfType<pcpp::TcpLayer>();
+	PTF_ASSERT_NOT_NULL(ipLayer);
+	PTF_ASSERT_NOT_NULL(tcpLayer);
+	ipLayer->setSrcIPv4Address(pcpp::IPv4Address("10.1.2.3"));
+	ipLayer->setDstIPv4Address(pcpp::IPv4Address("255.254.0.1"));
+	ipLayer->setTimeToLive(ipLayer->getIPv4Header()->timeToLive - 1);
+	tcpLayer->setSrcPort(40000);
+	tcpLayer->setDstPort(8080);
+	PTF_ASSERT_EQUAL(ipLayer->getSrcIPv4Address(), pcpp::IPv4Address("10.1.2.3"));
+	PTF_ASSERT_EQUAL(tcpLayer->getSrcPort(), 40000);
+	PTF_ASSERT_EQUAL(tcpLayer->getDstPort(), 8080);
+	uint16_t ipChecksum = ipLayer->getIPv4Header()->headerChecksum;
+	uint16_t tcpChecksum = tcpLayer->getTcpHeader()->headerChecksum;
+	tcpPacket.computeCalculateFields();
+	PTF_ASSERT_EQUAL(ipLayer->getIPv4Header()->headerChecksum, ipChecksum);
+	PTF_ASSERT_EQUAL(tcpLayer->getTcpHeader()->headerChecksum, tcpChecksum);
+
+	// IPv4 + UDP
+	pcpp::Packet udpPacket(&rawPacket2);
+	udpPacket.computeCalculateFields();
+	ipLayer = udpPacket.getLayerOfType<pcpp::IPv4Layer>();
+	pcpp::UdpLayer* udpLayer = udpPacket.getLayerOfType<pcpp::UdpLayer>();
+	PTF_ASSERT_NOT_NULL(ipLayer);
+	PTF_ASSERT_NOT_NULL(udpLayer);
+	ipLayer->setSrcIPv4Address(pcpp::IPv4Address("192.168.100.200"));
+	udpLayer->setDstPort(5353);
+	ipChecksum = ipLayer->getIPv4Header()->headerChecksum;
+	uint16_t udpChecksum = udpLayer->getUdpHeader()->headerChecksum;
+	udpPacket.computeCalculateFields();
+	PTF_ASSERT_EQUAL(ipLayer->getIPv4Header()->headerChecksum, ipChecksum);
+	PTF_ASSERT_EQUAL(udpLayer->getUdpHeader()->headerChecksum, udpChecksum);
+
+	// a zero UDP checksum means there's no checksum, it stays zero
+	udpLayer->getUdpHeader()->headerChecksum = 0;
+	udpLayer->setSrcPort(1234);
+	ipLayer->setDstIPv4Address(pcpp::IPv4Address("1.2.3.4"));
+	PTF_ASSERT_EQUAL(udpLayer->getUdpHeader()->headerChecksum, 0);
+
+	// IPv6 + UDP: there's no IPv6 header checksum but the addresses are part of the UDP pseudo header
+	pcpp::Packet ip6Packet(&rawPacket3);
+	ip6Packet.computeCalculateFields();
+	pcpp::IPv6Layer* ip6Layer = ip6Packet.getLayerOfType<pcpp::IPv6Layer>();
+	udpLayer = ip6Packet.getLayerOfType<pcpp::UdpLayer>();
+	PTF_ASSERT_NOT_NULL(ip6Layer);
+	PTF_ASSERT_NOT_NULL(udpLayer);
+	ip6Layer->setSrcIPv6Address(pcpp::IPv6Address("2001:db8::1"));
+	ip6Layer->setDstIPv6Address(pcpp::IPv6Address("fe80::1234:5678"));
+	PTF_ASSERT_EQUAL(ip6Layer->getSrcIPv6Address(), pcpp::IPv6Address("2001:db8::1"));
+	udpChecksum = udpLayer->getUdpHeader()->headerChecksum;
+	ip6Packet.computeCalculateFields();
+	PTF_ASSERT_EQUAL(udpLayer->getUdpHeader()->headerChecksum, udpChecksum);
+} // PacketUtilsIncrementalChecksum
+
+
+
+PTF_TEST_CASE(PacketUtilsFlowKey)
+{
+	pcpp::IPv4Address clientIP("212.199.202.9");
+	pcpp::IPv4Address serverIP("10.0.0.6");
+
+	pcpp::IPv4Layer ipLayer(clientIP, serverIP);
+	pcpp::UdpLayer udpLayer(63628, 1900);
+	pcpp::Packet clientToServer(1);
+	clientToServer.addLayer(&ipLayer);
+	clientToServer.addLayer(&udpLayer);
+	clientToServer.computeCalculateFields();
+
+	pcpp::IPv4Layer ipLayer2(serverIP, clientIP);
+	pcpp::UdpLayer udpLayer2(1900, 63628);
+	pcpp::Packet serverToClient(1);
+	serverToClient.addLayer(&ipLayer2);
+	serverToClient.addLayer(&udpLayer2);
+	serverToClient.computeCalculateFields();
+
+	pcpp::FlowKey key1, key2;
+	PTF_ASSERT_FALSE(key1.isValid());
+	PTF_ASSERT_TRUE(key1.initFromPacket(&clientToServer));
+	PTF_ASSERT_TRUE(key2.initFromPacket(&serverToClient));
+	PTF_ASSERT_TRUE(key1.isValid());
+	PTF_ASSERT_TRUE(key1 == key2);
+	PTF_ASSERT_EQUAL(key1.hash(), key2.hash());
+	PTF_ASSERT_EQUAL(key1.ipVersion, 4);
+	PTF_ASSERT_EQUAL(key1.protocol, pcpp::PACKETPP_IPPROTO_UDP);
+	// the endpoint with the lower address is the source
+	PTF_ASSERT_EQUAL(key1.getSrcIPAddress(), pcpp::IPAddress(serverIP));
+	PTF_ASSERT_EQUAL(key1.getDstIPAddress(), pcpp::IPAddress(clientIP));
+	PTF_ASSERT_EQUAL(key1.srcPort, 1900);
+	PTF_ASSERT_EQUAL(key1.dstPort, 63628);
+
+	PTF_ASSERT_TRUE(key1.initFromPacket(&clientToServer, true));
+	PTF_ASSERT_TRUE(key2.initFromPacket(&serverToClient, true));
+	PTF_ASSERT_TRUE(key1 != key2);
+	PTF_ASSERT_EQUAL(key1.getSrcIPAddress(), pcpp::IPAddress(clientIP));
+	PTF_ASSERT_EQUAL(key1.srcPort, 63628);
+
+	// flows that differ only by protocol have different keys
+	pcpp::IPv4Layer ipLayer3(clientIP, serverIP);
+	pcpp::TcpLayer tcpLayer(63628, 1900);
+	pcpp::Packet tcpPacket(1);
+	tcpPacket.addLayer(&ipLayer3);
+	tcpPacket.addLayer(&tcpLayer);
+	tcpPacket.computeCalculateFields();
+	PTF_ASSERT_TRUE(key2.initFromPacket(&tcpPacket, true));
+	PTF_ASSERT_EQUAL(key2.protocol, pcpp::PACKETPP_IPPROTO_TCP);
+	PTF_ASSERT_TRUE(key1 != key2);
+
+	// IPv6
+	pcpp::IPv6Address ipv6Client("2001:db8::2");
+	pcpp::IPv6Address ipv6Server("2001:db8::1");
+	pcpp::IPv6Layer ipv6Layer(ipv6Client, ipv6Server);
+	pcpp::TcpLayer tcpLayer2(50000, 443);
+	pcpp::Packet ipv6Packet(1);
+	ipv6Packet.addLayer(&ipv6Layer);
+	ipv6Packet.addLayer(&tcpLayer2);
+	ipv6Packet.computeCalculateFields();
+	PTF_ASSERT_TRUE(key1.initFromPacket(&ipv6Packet));
+	PTF_ASSERT_EQUAL(key1.ipVersion, 6);
+	PTF_ASSERT_EQUAL(key1.getSrcIPAddress(), pcpp::IPAddress(ipv6Server));
+	PTF_ASSERT_EQUAL(key1.getDstIPAddress(), pcpp::IPAddress(ipv6Client));
+	PTF_ASSERT_EQUAL(key1.srcPort, 443);
+
+	// a packet without 5-tuple
+	pcpp::IPv4Layer ipLayer4(clientIP, serverIP);
+	pcpp::Packet ipOnlyPacket(1);
+	ipOnlyPacket.addLayer(&ipLayer4);
+	PTF_ASSERT_FALSE(key1.initFromPacket(&ipOnlyPacket));
+	PTF_ASSERT_FALSE(key1.isValid());
+	PTF_ASSERT_TRUE(key1 == pcpp::FlowKey());
+} // PacketUtilsFlowKey
+
+
+
+struct FlowTableTestEviction
+{
+	std::vector<uint16_t> evictedPorts;
+	std::vector<int> reasons;
+};
+
+static void flowTableTestOnFlowEvicted(const pcpp::FlowKey& key, int& value, pcpp::FlowTable<int>::EvictionReason reason, void* userCookie)
+{
+	FlowTableTestEviction* eviction = (FlowTableTestEviction*)userCookie;
+	eviction->evictedPorts.push_back(key.srcPort);
+	eviction->reasons.push_back((int)reason);
+}
+
+static pcpp::FlowKey createFlowTableTestKey(uint16_t port)
+{
+	pcpp::FlowKey key;
+	key.ipVersion = 4;
+	key.protocol = pcpp::PACKETPP_IPPROTO_TCP;
+	key.srcIP[0] = 10;
+	key.dstIP[0] = 192;
+	key.srcPort = port;
+	key.dstPort = 80;
+	return key;
+}
+
+PTF_TEST_CASE(PacketUtilsFlowTable)
+{
+	FlowTableTestEviction eviction;
+	pcpp::FlowTable<int> flowTable(3, 10, flowTableTestOnFlowEvicted, &eviction);
+	PTF_ASSERT_EQUAL(flowTable.getMaxNumOfFlows(), 3);
+	PTF_ASSERT_EQUAL(flowTable.getIdleTimeout(), 10);
+
+	bool isNewFlow = false;
+	flowTable.findOrCreate(createFlowTableTestKey(1), 100, &isNewFlow) = 1;
+	PTF_ASSERT_TRUE(isNewFlow);
+	flowTable.findOrCreate(createFlowTableTestKey(2), 101) = 2;
+	flowTable.findOrCreate(createFlowTableTestKey(3), 102) = 3;
+	PTF_ASSERT_EQUAL(flowTable.getNumOfFlows(), 3);
+	PTF_ASSERT_EQUAL(flowTable.findOrCreate(createFlowTableTestKey(2), 103, &isNewFlow), 2);
+	PTF_ASSERT_FALSE(isNewFlow);
+	PTF_ASSERT_NULL(flowTable.find(createFlowTableTestKey(4)));
+
+	// flow 1 wasn't seen but find() without timestamp doesn't refresh it, so it's evicted when the table is full
+	PTF_ASSERT_EQUAL(*flowTable.find(createFlowTableTestKey(1)), 1);
+	flowTable.findOrCreate(createFlowTableTestKey(4), 104) = 4;
+	PTF_ASSERT_EQUAL(flowTable.getNumOfFlows(), 3);
+	PTF_ASSERT_NULL(flowTable.find(createFlowTableTestKey(1)));
+	PTF_ASSERT_EQUAL(eviction.evictedPorts.size(), 1);
+	PTF_ASSERT_EQUAL(eviction.evictedPorts[0], 1);
+	PTF_ASSERT_EQUAL(eviction.reasons[0], (int)pcpp::FlowTable<int>::FlowTableFull);
+
+	// find() with a timestamp refreshes the flow, so flow 2 is evicted next
+	PTF_ASSERT_EQUAL(*flowTable.find(createFlowTableTestKey(3), 105), 3);
+	flowTable.findOrCreate(createFlowTableTestKey(5), 106) = 5;
+	PTF_ASSERT_EQUAL(eviction.evictedPorts.size(), 2);
+	PTF_ASSERT_EQUAL(eviction.evictedPorts[1], 2);
+
+	// erase doesn't call the callback
+	PTF_ASSERT_TRUE(flowTable.erase(createFlowTableTestKey(5)));
+	PTF_ASSERT_FALSE(flowTable.erase(createFlowTableTestKey(5)));
+	PTF_ASSERT_EQUAL(flowTable.getNumOfFlows(), 2);
+	PTF_ASSERT_EQUAL(eviction.evictedPorts.size(), 2);
+
+	// flow 4 was last seen at 104 and flow 3 at 105
+	PTF_ASSERT_EQUAL(flowTable.purgeIdleFlows(114), 0);
+	PTF_ASSERT_EQUAL(flowTable.purgeIdleFlows(115), 1);
+	PTF_ASSERT_EQUAL(eviction.evictedPorts[2], 4);
+	PTF_ASSERT_EQUAL(eviction.reasons[2], (int)pcpp::FlowTable<int>::FlowIdleTimeout);
+
+	// idle flows are also purged when new flows are created
+	flowTable.findOrCreate(createFlowTableTestKey(6), 200) = 6;
+	PTF_ASSERT_EQUAL(flowTable.getNumOfFlows(), 1);
+	PTF_ASSERT_EQUAL(eviction.evictedPorts[3], 3);
+
+	flowTable.clear();
+	PTF_ASSERT_EQUAL(flowTable.getNumOfFlows(), 0);
+	PTF_ASSERT_EQUAL(eviction.evictedPorts[4], 6);
+	PTF_ASSERT_EQUAL(eviction.reasons[4], (int)pcpp::FlowTable<int>::FlowTableCleared);
+
+	// stress the table growth and the backward-shift deletion against std::map
+	pcpp::FlowTable<int> bigFlowTable(10000);
+	std::map<uint16_t, int> expected;
+	for (int i = 0; i < 20000; i++)
+	{
+		uint16_t port = (uint16_t)((i * 7919) % 6000);
+		if (i % 3 == 2)
+		{
+			PTF_ASSERT_EQUAL(bigFlowTable.erase(createFlowTableTestKey(port)), expected.erase(port) == 1);
+		}
+		else
+		{
+			bigFlowTable.findOrCreate(createFlowTableTestKey(port), i) = i;
+			expected[port] = i;
+		}
+	}
+
+	PTF_ASSERT_EQUAL(bigFlowTable.getNumOfFlows(), expected.size());
+	for (uint16_t port = 0; port < 6000; port++)
+	{
+		int* value = bigFlowTable.find(createFlowTableTestKey(port));
+		if (expected.find(port) == expected.end())
+		{
+			PTF_ASSERT_NULL(value);
+		}
+		else
+		{
+			PTF_ASSERT_NOT_NULL(value);
+			PTF_ASSERT_EQUAL(*value, expected[port]);
+		}
+	}
+
+	// flows are iterated from the least recently seen
+	int lastValue = -1;
+	size_t numOfFlows = 0;
+	bool isOrdered = true;
+	bigFlowTable.forEachFlow([&](const pcpp::FlowKey&, int& value) { isOrdered = isOrdered && value > lastValue; lastValue = value; numOfFlows++; });
+	PTF_ASSERT_TRUE(isOrdered);
+	PTF_ASSERT_EQUAL(numOfFlows, expected.size());
+} // PacketUtilsFlowTable
@@ -709,8 +709,10 @@ PTF_TEST_CASE(TLSCipherSuiteTest)
 	std::ifstream cipherIDsFile("PacketExamples/CipherSuiteIDs.txt");
 	std::string cipherSuiteName;
 	std::string cipherSuiteIDStr;
+	size_t numOfCipherSuiteNames = 0;
 	while (std::getline(cipherNamesFile, cipherSuiteName))
 	{
+		numOfCipherSuiteNames++;
 		std::getline(cipherIDsFile, cipherSuiteIDStr);
 		std::stringstream iss;
 		iss << std::hex << cipherSuiteIDStr;
@@ -724,6 +726,29 @@ PTF_TEST_CASE(TLSCipherSuiteTest)
 		PTF_ASSERT_EQUAL(cipherSuiteByID->getID(), cipherSuiteID);
 		PTF_ASSERT_EQUAL(cipherSuiteByName, cipherSuiteByID, ptr);
 	}
+
+	// every cipher-suite in the ID table is found by its name as the same object, and all of them are listed in the file
+	size_t numOfCipherSuiteIDs = 0;
+	for (uint32_t cipherSuiteID = 0; cipherSuiteID <= 0xFFFF; cipherSuiteID++)
+	{
+		pcpp::SSLCipherSuite* cipherSuiteByID = pcpp::SSLCipherSuite::getCipherSuiteByID(cipherSuiteID);
+		if (cipherSuiteByID == nullptr)
+			continue;
+
+		numOfCipherSuiteIDs++;
+		PTF_ASSERT_EQUAL(cipherSuiteByID->getID(), cipherSuiteID);
+		PTF_ASSERT_EQUAL(pcpp::SSLCipherSuite::getCipherSuiteByName(cipherSuiteByID->asString()), cipherSuiteByID, ptr);
+	}
+	PTF_ASSERT_EQUAL(numOfCipherSuiteIDs, numOfCipherSuiteNames);
+
+	// IDs in known and unknown pages of the ID table and names that aren't cipher-suite names
+	PTF_ASSERT_NULL(pcpp::SSLCipherSuite::getCipherSuiteByID(0x00FF));
+	PTF_ASSERT_NULL(pcpp::SSLCipherSuite::getCipherSuiteByID(0x1306));
+	PTF_ASSERT_NULL(pcpp::SSLCipherSuite::getCipherSuiteByID(0x0A0A));
+	PTF_ASSERT_NULL(pcpp::SSLCipherSuite::getCipherSuiteByID(0xFFFF));
+	PTF_ASSERT_NULL(pcpp::SSLCipherSuite::getCipherSuiteByName(""));
+	PTF_ASSERT_NULL(pcpp::SSLCipherSuite::getCipherSuiteByName("TLS_AES_128_GCM_SHA25"));
+	PTF_ASSERT_NULL(pcpp::SSLCipherSuite::getCipherSuiteByName("TLS_NO_SUCH_CIPHER_SUITE"));
 } // TLSCipherSuiteTest
 
 
@@ -743,6 +768,8 @@ PTF_TEST_CASE(ClientHelloTLSFingerprintTest)
 	pcpp::SSLClientHelloMessage::ClientHelloTLSFingerprint tlsFingerprint = clientHelloMsg->generateTLSFingerprint();
 	PTF_ASSERT_EQUAL(tlsFingerprint.toString(), "771,4866-4867-4865-255,0-11-10-35-22-23-13-43-45-51,29-23-30-25-24,0-1-2");
 	PTF_ASSERT_EQUAL(tlsFingerprint.toMD5(), "a66e498c488aa0523759691248cdfb01");
+	pcpp::TLSFingerprintDigest tlsFingerprintDigest1 = clientHelloMsg->generateTLSFingerprintDigest();
+	PTF_ASSERT_EQUAL(tlsFingerprintDigest1.toString(), "a66e498c488aa0523759691248cdfb01");
 
 
 	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/tls_grease.dat");
@@ -756,6 +783,26 @@ PTF_TEST_CASE(ClientHelloTLSFingerprintTest)
 	tlsFingerprint = clientHelloMsg->generateTLSFingerprint();
 	PTF_ASSERT_EQUAL(tlsFingerprint.toString(), "771,4865-4866-4867-49195-49199-49196-49200-52393-52392-49171-49172-156-157-47-53,0-23-65281-10-11-35-16-5-13-18-51-45-43-27-21,29-23-24,0");
 	PTF_ASSERT_EQUAL(tlsFingerprint.toMD5(), "b32309a26951912be7dba376398abc3b");
+	pcpp::TLSFingerprintDigest tlsFingerprintDigest2 = clientHelloMsg->generateTLSFingerprintDigest();
+	PTF_ASSERT_EQUAL(tlsFingerprintDigest2.toString(), "b32309a26951912be7dba376398abc3b");
+	PTF_ASSERT_TRUE(tlsFingerprintDigest1 != tlsFingerprintDigest2);
+	PTF_ASSERT_TRUE(tlsFingerprintDigest2 == clientHelloMsg->generateTLSFingerprintDigest());
+	PTF_ASSERT_EQUAL(pcpp::TLSFingerprintDigest::Hash()(tlsFingerprintDigest2), pcpp::TLSFingerprintDigest::Hash()(clientHelloMsg->generateTLSFingerprintDigest()));
+
+
+	// a message with zero-size extensions and longer fingerprint strings
+	const char* clientHelloFiles[] = { "PacketExamples/tls_zero_size_ext.dat", "PacketExamples/tls1_3_client_hello2.dat", "PacketExamples/SSL-ClientHello1.dat" };
+	for (int i = 0; i < 3; i++)
+	{
+		READ_FILE_AND_CREATE_PACKET(3, clientHelloFiles[i]);
+		pcpp::Packet clientHelloPacket(&rawPacket3);
+
+		handshakeLayer = clientHelloPacket.getLayerOfType<pcpp::SSLHandshakeLayer>();
+		PTF_ASSERT_NOT_NULL(handshakeLayer);
+		clientHelloMsg = handshakeLayer->getHandshakeMessageOfType<pcpp::SSLClientHelloMessage>();
+		PTF_ASSERT_NOT_NULL(clientHelloMsg);
+		PTF_ASSERT_EQUAL(clientHelloMsg->generateTLSFingerprintDigest().toString(), clientHelloMsg->generateTLSFingerprint().toMD5());
+	}
 } // ClientHelloTLSFingerprintTest
 
 
@@ -776,6 +823,7 @@ PTF_TEST_CASE(ServerHelloTLSFingerprintTest)
 	pcpp::SSLServerHelloMessage::ServerHelloTLSFingerprint tlsFingerprint = serverHelloMessage->generateTLSFingerprint();
 	PTF_ASSERT_EQUAL(tlsFingerprint.toString(), "771,49195,65281-16-11");
 	PTF_ASSERT_EQUAL(tlsFingerprint.toMD5(), "554786d4c84f8a7953b7e453c6371067");
+	PTF_ASSERT_EQUAL(serverHelloMessage->generateTLSFingerprintDigest().toString(), "554786d4c84f8a7953b7e453c6371067");
 
 
 	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/tls_server_hello.dat");
@@ -790,4 +838,20 @@ PTF_TEST_CASE(ServerHelloTLSFingerprintTest)
 	tlsFingerprint = serverHelloMessage->generateTLSFingerprint();
 	PTF_ASSERT_EQUAL(tlsFingerprint.toString(), "771,49195,23-65281-11-35-16");
 	PTF_ASSERT_EQUAL(tlsFingerprint.toMD5(), "eca9b8f0f3eae50309eaf901cb822d9b");
+	PTF_ASSERT_EQUAL(serverHelloMessage->generateTLSFingerprintDigest().toString(), "eca9b8f0f3eae50309eaf901cb822d9b");
+
+
+	// the version is taken from the supported versions extension
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/tls1_3_server_hello1.dat");
+
+	pcpp::Packet tls13ServerHelloPacket(&rawPacket3);
+
+	handshakeLayer = tls13ServerHelloPacket.getLayerOfType<pcpp::SSLHandshakeLayer>();
+	PTF_ASSERT_NOT_NULL(handshakeLayer);
+	serverHelloMessage = handshakeLayer->getHandshakeMessageOfType<pcpp::SSLServerHelloMessage>();
+	PTF_ASSERT_NOT_NULL(serverHelloMessage);
+
+	tlsFingerprint = serverHelloMessage->generateTLSFingerprint();
+	PTF_ASSERT_NOT_EQUAL(tlsFingerprint.tlsVersion, be16toh(serverHelloMessage->getServerHelloHeader()->handshakeVersion));
+	PTF_ASSERT_EQUAL(serverHelloMessage->generateTLSFingerprintDigest().toString(), tlsFingerprint.toMD5());
 } // ServerHelloTLSFingerprintTest
@@ -146,6 +146,10 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(PacketUtilsHash5TupleUdp, "udp");
 	PTF_RUN_TEST(PacketUtilsHash5TupleTcp, "tcp");
 	PTF_RUN_TEST(PacketUtilsHash5TupleIPv6, "ipv6");
+	PTF_RUN_TEST(PacketUtilsComputeChecksum, "packet_utils;checksum");
+	PTF_RUN_TEST(PacketUtilsIncrementalChecksum, "packet_utils;checksum");
+	PTF_RUN_TEST(PacketUtilsFlowKey, "packet_utils;flow_table");
+	PTF_RUN_TEST(PacketUtilsFlowTable, "packet_utils;flow_table");
 
 	PTF_RUN_TEST(InsertDataToPacket, "packet;insert");
 	PTF_RUN_TEST(CreatePacketFromBuffer, "packet");
@@ -158,9 +162,13 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(PacketTrailerTest, "packet;packet_trailer");
 	PTF_RUN_TEST(ResizeLayerTest, "packet;resize");
 	PTF_RUN_TEST(PrintPacketAndLayers, "packet;print");
+	PTF_RUN_TEST(LayerThreadCacheTest, "packet;layer_cache");
+	PTF_RUN_TEST(LazyPacketParsingTest, "packet;lazy_parsing");
+	PTF_RUN_TEST(TaggedLayerLookupTest, "packet;layer_lookup");
 
 	PTF_RUN_TEST(HttpRequestParseMethodTest, "http");
 	PTF_RUN_TEST(HttpRequestLayerParsingTest, "http");
+	PTF_RUN_TEST(HttpRequestLayerFieldIndexTest, "http");
 	PTF_RUN_TEST(HttpRequestLayerCreationTest, "http");
 	PTF_RUN_TEST(HttpRequestLayerEditTest, "http");
 	PTF_RUN_TEST(HttpResponseParseStatusCodeTest, "http");
@@ -183,6 +191,7 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(DnsOverTcpParsingTest, "dns");
 	PTF_RUN_TEST(DnsOverTcpCreationTest, "dns");
 	PTF_RUN_TEST(DnsLayerAddDnsKeyTest, "dns");
+	PTF_RUN_TEST(DnsRecordIterationTest, "dns");
 
 	PTF_RUN_TEST(IcmpParsingTest, "icmp");
 	PTF_RUN_TEST(IcmpCreationTest, "icmp");
@@ -6,6 +6,7 @@
 PTF_TEST_CASE(TestIPAddress);
 PTF_TEST_CASE(TestMacAddress);
 PTF_TEST_CASE(TestLRUList);
+PTF_TEST_CASE(TestHashedLRUList);
 PTF_TEST_CASE(TestGeneralUtils);
 PTF_TEST_CASE(TestGetMacAddress);
 PTF_TEST_CASE(TestIPv4Network);
@@ -15,6 +16,7 @@ PTF_TEST_CASE(TestIPNetwork);
 // Implemented in LoggerTests.cpp
 PTF_TEST_CASE(TestLogger);
 PTF_TEST_CASE(TestLoggerMultiThread);
+PTF_TEST_CASE(TestLoggerAsync);
 
 // Implemented in FileTests.cpp
 PTF_TEST_CASE(TestPcapFileReadWrite);
@@ -22,11 +24,14 @@ PTF_TEST_CASE(TestPcapSllFileReadWrite);
 PTF_TEST_CASE(TestPcapSll2FileReadWrite);
 PTF_TEST_CASE(TestPcapRawIPFileReadWrite);
 PTF_TEST_CASE(TestPcapFileAppend);
+PTF_TEST_CASE(TestPcapFileAsyncWrite);
 PTF_TEST_CASE(TestPcapNgFileReadWrite);
 PTF_TEST_CASE(TestPcapNgFileReadWriteAdv);
 PTF_TEST_CASE(TestPcapFileReadLinkTypeIPv6);
 PTF_TEST_CASE(TestPcapFileReadLinkTypeIPv4);
 PTF_TEST_CASE(TestSolarisSnoopFileRead);
+PTF_TEST_CASE(TestFileReaderPacketDataModes);
+PTF_TEST_CASE(TestPcapMmapFileReader);
 
 // Implemented in LiveDeviceTests.cpp
 PTF_TEST_CASE(TestPcapLiveDeviceList);
@@ -35,6 +40,7 @@ PTF_TEST_CASE(TestPcapLiveDevice);
 PTF_TEST_CASE(TestPcapLiveDeviceClone);
 PTF_TEST_CASE(TestPcapLiveDeviceNoNetworking);
 PTF_TEST_CASE(TestPcapLiveDeviceStatsMode);
+PTF_TEST_CASE(TestPcapLiveDeviceBurstMode);
 PTF_TEST_CASE(TestPcapLiveDeviceBlockingMode);
 PTF_TEST_CASE(TestPcapLiveDeviceSpecialCfg);
 PTF_TEST_CASE(TestWinPcapLiveDevice);
@@ -48,6 +54,7 @@ PTF_TEST_CASE(TestPcapFilters_MatchStatic);
 PTF_TEST_CASE(TestPcapFiltersLive);
 PTF_TEST_CASE(TestPcapFilters_General_BPFStr);
 PTF_TEST_CASE(TestPcapFiltersOffline);
+PTF_TEST_CASE(TestPcapFiltersCompiled);
 PTF_TEST_CASE(TestPcapFilters_LinkLayer);
 
 // Implemented in PacketParsingTests.cpp
@@ -72,6 +79,11 @@ PTF_TEST_CASE(TestTcpReassemblyMaxOOOFrags);
 PTF_TEST_CASE(TestTcpReassemblyMaxSeq);
 PTF_TEST_CASE(TestTcpReassemblyDisableOOOCleanup);
 PTF_TEST_CASE(TestTcpReassemblyTimeStamps);
+PTF_TEST_CASE(TestTcpReassemblyManyConnections);
+PTF_TEST_CASE(TestTcpReassemblyOutOfOrderMemory);
+PTF_TEST_CASE(TestTcpReassemblySharded);
+PTF_TEST_CASE(TestHttpReassembly);
+PTF_TEST_CASE(TestHttpReassemblyWithTcpReassembly);
 
 // Implemented in IPFragmentationTests.cpp
 PTF_TEST_CASE(TestIPFragmentationSanity);
@@ -81,6 +93,7 @@ PTF_TEST_CASE(TestIPFragMultipleFrags);
 PTF_TEST_CASE(TestIPFragMapOverflow);
 PTF_TEST_CASE(TestIPFragRemove);
 PTF_TEST_CASE(TestIPFragWithPadding);
+PTF_TEST_CASE(TestIPFragMemoryBudget);
 
 // Implemented in PfRingTests.cpp
 PTF_TEST_CASE(TestPfRingDevice);
@@ -105,6 +118,8 @@ PTF_TEST_CASE(TestKniDeviceSendReceive);
 
 // Implemented in RawSocketTests.cpp
 PTF_TEST_CASE(TestRawSockets);
+PTF_TEST_CASE(TestRawSocketsRxRing);
+PTF_TEST_CASE(TestRawSocketsBatchSend);
 
 // Implemented in SystemUtilsTests.cpp
 PTF_TEST_CASE(TestSystemCoreUtils);
@@ -321,6 +321,188 @@ PTF_TEST_CASE(TestPcapFileAppend)
 
 
 
+PTF_TEST_CASE(TestPcapFileAsyncWrite)
+{
+	pcpp::PcapFileReaderDevice readerDev(EXAMPLE_PCAP_PATH);
+	PTF_ASSERT_TRUE(readerDev.open());
+	pcpp::RawPacketVector packetVec;
+	PTF_ASSERT_EQUAL(readerDev.getNextPackets(packetVec), 4631);
+	readerDev.close();
+
+	uint64_t expectedBytes = 0;
+	for (pcpp::RawPacketVector::ConstVectorIterator iter = packetVec.begin(); iter != packetVec.end(); iter++)
+		expectedBytes += 16 + (*iter)->getRawDataLen();
+
+	// pcap file, block when the queue is full
+	pcpp::PcapFileWriterDevice writerDev(EXAMPLE_PCAP_WRITE_PATH);
+	pcpp::Logger::getInstance().suppressLogs();
+	PTF_ASSERT_FALSE(writerDev.startAsyncWriting());
+	pcpp::Logger::getInstance().enableLogs();
+	PTF_ASSERT_TRUE(writerDev.open());
+	PTF_ASSERT_TRUE(writerDev.startAsyncWriting(64 * 1024));
+	PTF_ASSERT_TRUE(writerDev.isAsyncWritingEnabled());
+	pcpp::Logger::getInstance().suppressLogs();
+	PTF_ASSERT_FALSE(writerDev.startAsyncWriting());
+	pcpp::Logger::getInstance().enableLogs();
+
+	for (pcpp::RawPacketVector::ConstVectorIterator iter = packetVec.begin(); iter != packetVec.end(); iter++)
+	{
+		PTF_ASSERT_TRUE(writerDev.writePacket(**iter));
+	}
+
+	writerDev.flush();
+	pcpp::IFileWriterDevice::AsyncWriterStats asyncStats;
+	writerDev.getAsyncWriterStats(asyncStats);
+	PTF_ASSERT_EQUAL(asyncStats.packetsQueued, 4631);
+	PTF_ASSERT_EQUAL(asyncStats.packetsDropped, 0);
+	PTF_ASSERT_EQUAL(asyncStats.numOfFailedBatches, 0);
+	PTF_ASSERT_GREATER_THAN(asyncStats.numOfBatchesWritten, 1);
+	PTF_ASSERT_EQUAL(asyncStats.bytesWritten, expectedBytes);
+	PTF_ASSERT_EQUAL(asyncStats.queueDepthPackets, 0);
+	PTF_ASSERT_EQUAL(asyncStats.queueDepthBytes, 0);
+	PTF_ASSERT_GREATER_THAN(asyncStats.maxQueueDepthBytes, 0);
+	PTF_ASSERT_LOWER_OR_EQUAL_THAN(asyncStats.maxQueueDepthBytes, 2 * 64 * 1024);
+
+	// go back to writing on this thread
+	writerDev.stopAsyncWriting();
+	PTF_ASSERT_FALSE(writerDev.isAsyncWritingEnabled());
+	for (int i = 0; i < 10; i++)
+	{
+		PTF_ASSERT_TRUE(writerDev.writePacket(*packetVec.at(i)));
+	}
+
+	pcpp::IPcapDevice::PcapStats writerStatistics;
+	writerDev.getStatistics(writerStatistics);
+	PTF_ASSERT_EQUAL((uint32_t)writerStatistics.packetsRecv, 4641);
+	PTF_ASSERT_EQUAL((uint32_t)writerStatistics.packetsDrop, 0);
+	writerDev.close();
+
+	pcpp::PcapFileReaderDevice readerDev2(EXAMPLE_PCAP_WRITE_PATH);
+	PTF_ASSERT_TRUE(readerDev2.open());
+	pcpp::RawPacket rawPacket;
+	int packetCount = 0;
+	while (readerDev2.getNextPacket(rawPacket))
+	{
+		pcpp::RawPacket* origPacket = packetVec.at(packetCount % 4631);
+		PTF_ASSERT_EQUAL(rawPacket.getRawDataLen(), origPacket->getRawDataLen());
+		PTF_ASSERT_EQUAL(rawPacket.getFrameLength(), origPacket->getFrameLength());
+		PTF_ASSERT_EQUAL(rawPacket.getPacketTimeStamp().tv_sec, origPacket->getPacketTimeStamp().tv_sec);
+		PTF_ASSERT_EQUAL(rawPacket.getPacketTimeStamp().tv_nsec, origPacket->getPacketTimeStamp().tv_nsec);
+		PTF_ASSERT_BUF_COMPARE(rawPacket.getRawData(), origPacket->getRawData(), rawPacket.getRawDataLen());
+		packetCount++;
+	}
+	PTF_ASSERT_EQUAL(packetCount, 4641);
+	readerDev2.close();
+
+	// pcap file in append mode, drop packets when the queue is full. Packets larger than the queue are always dropped
+	pcpp::PcapFileWriterDevice writerDev2(EXAMPLE_PCAP_WRITE_PATH);
+	PTF_ASSERT_TRUE(writerDev2.open(true));
+	PTF_ASSERT_TRUE(writerDev2.startAsyncWriting(1024, pcpp::IFileWriterDevice::DropWhenQueueFull));
+	int numOfTooLargePackets = 0;
+	int numOfWrittenPackets = 0;
+	pcpp::Logger::getInstance().suppressLogs();
+	for (pcpp::RawPacketVector::ConstVectorIterator iter = packetVec.begin(); iter != packetVec.end(); iter++)
+	{
+		if (16 + (*iter)->getRawDataLen() > 1024)
+			numOfTooLargePackets++;
+		if (writerDev2.writePacket(**iter))
+			numOfWrittenPackets++;
+	}
+	pcpp::Logger::getInstance().enableLogs();
+	PTF_ASSERT_GREATER_THAN(numOfTooLargePackets, 0);
+
+	writerDev2.close();
+	writerDev2.getAsyncWriterStats(asyncStats);
+	PTF_ASSERT_EQUAL(asyncStats.packetsQueued, (uint64_t)numOfWrittenPackets);
+	PTF_ASSERT_EQUAL(asyncStats.packetsQueued + asyncStats.packetsDropped, 4631);
+	PTF_ASSERT_GREATER_OR_EQUAL_THAN(asyncStats.packetsDropped, (uint64_t)numOfTooLargePackets);
+	writerDev2.getStatistics(writerStatistics);
+	PTF_ASSERT_EQUAL((uint32_t)writerStatistics.packetsRecv, (uint32_t)numOfWrittenPackets);
+	PTF_ASSERT_EQUAL((uint32_t)writerStatistics.packetsDrop, (uint32_t)asyncStats.packetsDropped);
+
+	pcpp::PcapFileReaderDevice readerDev3(EXAMPLE_PCAP_WRITE_PATH);
+	PTF_ASSERT_TRUE(readerDev3.open());
+	packetCount = 0;
+	while (readerDev3.getNextPacket(rawPacket))
+		packetCount++;
+	PTF_ASSERT_EQUAL(packetCount, 4641 + numOfWrittenPackets);
+	readerDev3.close();
+
+	// pcap-ng file with packet comments
+	pcpp::PcapNgFileWriterDevice pcapNgWriterDev(EXAMPLE_PCAPNG_WRITE_PATH);
+	PTF_ASSERT_TRUE(pcapNgWriterDev.open());
+	PTF_ASSERT_TRUE(pcapNgWriterDev.startAsyncWriting(64 * 1024));
+	for (int i = 0; i < 1000; i++)
+	{
+		if (i % 2 == 0)
+		{
+			PTF_ASSERT_TRUE(pcapNgWriterDev.writePacket(*packetVec.at(i), "packet #" + std::to_string(i)));
+		}
+		else
+		{
+			PTF_ASSERT_TRUE(pcapNgWriterDev.writePacket(*packetVec.at(i)));
+		}
+	}
+	pcapNgWriterDev.close();
+	pcapNgWriterDev.getAsyncWriterStats(asyncStats);
+	PTF_ASSERT_EQUAL(asyncStats.packetsQueued, 1000);
+	PTF_ASSERT_EQUAL(asyncStats.queueDepthPackets, 0);
+
+	pcpp::PcapNgFileReaderDevice pcapNgReaderDev(EXAMPLE_PCAPNG_WRITE_PATH);
+	PTF_ASSERT_TRUE(pcapNgReaderDev.open());
+	std::string pktComment;
+	packetCount = 0;
+	while (pcapNgReaderDev.getNextPacket(rawPacket, pktComment))
+	{
+		pcpp::RawPacket* origPacket = packetVec.at(packetCount);
+		PTF_ASSERT_EQUAL(rawPacket.getRawDataLen(), origPacket->getRawDataLen());
+		PTF_ASSERT_BUF_COMPARE(rawPacket.getRawData(), origPacket->getRawData(), rawPacket.getRawDataLen());
+		PTF_ASSERT_EQUAL(pktComment, (packetCount % 2 == 0 ? "packet #" + std::to_string(packetCount) : std::string()));
+		packetCount++;
+	}
+	PTF_ASSERT_EQUAL(packetCount, 1000);
+	pcapNgReaderDev.close();
+
+#ifdef __linux__
+	// writes to /dev/full fail once the file stream's buffer is flushed. Packets that weren't written are moved to the dropped count
+	pcpp::PcapNgFileWriterDevice fullDiskWriterDev("/dev/full");
+	PTF_ASSERT_TRUE(fullDiskWriterDev.open());
+	PTF_ASSERT_TRUE(fullDiskWriterDev.startAsyncWriting(64 * 1024));
+	for (int i = 0; i < 1000; i++)
+	{
+		PTF_ASSERT_TRUE(fullDiskWriterDev.writePacket(*packetVec.at(i)));
+	}
+	pcpp::Logger::getInstance().suppressLogs();
+	fullDiskWriterDev.stopAsyncWriting();
+	pcpp::Logger::getInstance().enableLogs();
+	fullDiskWriterDev.getAsyncWriterStats(asyncStats);
+	PTF_ASSERT_EQUAL(asyncStats.packetsQueued, 1000);
+	PTF_ASSERT_GREATER_THAN(asyncStats.numOfFailedBatches, 0);
+	PTF_ASSERT_GREATER_THAN(asyncStats.packetsFailed, 0);
+	fullDiskWriterDev.getStatistics(writerStatistics);
+	PTF_ASSERT_EQUAL((uint64_t)writerStatistics.packetsDrop, asyncStats.packetsFailed);
+	PTF_ASSERT_EQUAL((uint64_t)writerStatistics.packetsRecv, 1000 - asyncStats.packetsFailed);
+
+	// writing on this thread reports failed packets too
+	int numOfFailedWrites = 0;
+	pcpp::Logger::getInstance().suppressLogs();
+	for (int i = 0; i < 1000; i++)
+	{
+		if (!fullDiskWriterDev.writePacket(*packetVec.at(i)))
+			numOfFailedWrites++;
+	}
+	pcpp::Logger::getInstance().enableLogs();
+	PTF_ASSERT_GREATER_THAN(numOfFailedWrites, 0);
+	fullDiskWriterDev.getStatistics(writerStatistics);
+	PTF_ASSERT_EQUAL((uint64_t)writerStatistics.packetsDrop, asyncStats.packetsFailed + numOfFailedWrites);
+	pcpp::Logger::getInstance().suppressLogs();
+	fullDiskWriterDev.close();
+	pcpp::Logger::getInstance().enableLogs();
+#endif
+} // TestPcapFileAsyncWrite
+
+
+
 PTF_TEST_CASE(TestPcapNgFileReadWrite)
 {
 	pcpp::PcapNgFileReaderDevice readerDev(EXAMPLE_PCAPNG_PATH);
@@ -867,3 +1049,166 @@ PTF_TEST_CASE(TestSolarisSnoopFileRead)
 
 	readerDev.close();
 } // TestSolarisSnoopFileRead
+
+
+
+PTF_TEST_CASE(TestFileReaderPacketDataModes)
+{
+	std::vector<std::string> fileNames = { EXAMPLE_PCAP_PATH, EXAMPLE2_PCAPNG_PATH, EXAMPLE_SOLARIS_SNOOP };
+	std::vector<pcpp::IFileReaderDevice::PacketDataMode> modes = { pcpp::IFileReaderDevice::ReusePacketBuffer, pcpp::IFileReaderDevice::ZeroCopyPacketData };
+
+	for (const auto& fileName : fileNames)
+	{
+		// read all packets in the default mode for reference
+		pcpp::IFileReaderDevice* referenceReader = pcpp::IFileReaderDevice::getReader(fileName);
+		FileReaderTeardown referenceReaderTeardown(referenceReader);
+		PTF_ASSERT_EQUAL(referenceReader->getPacketDataMode(), pcpp::IFileReaderDevice::CopyPacketData, enum);
+		PTF_ASSERT_TRUE(referenceReader->open());
+		pcpp::RawPacketVector referencePackets;
+		int numOfPackets = referenceReader->getNextPackets(referencePackets);
+		PTF_ASSERT_GREATER_THAN(numOfPackets, 0);
+
+		for (const auto& mode : modes)
+		{
+			pcpp::IFileReaderDevice* reader = pcpp::IFileReaderDevice::getReader(fileName);
+			FileReaderTeardown readerTeardown(reader);
+			reader->setPacketDataMode(mode);
+			PTF_ASSERT_EQUAL(reader->getPacketDataMode(), mode, enum);
+			PTF_ASSERT_TRUE(reader->open());
+
+			pcpp::RawPacket rawPacket;
+			int packetCount = 0;
+			int tcpCount = 0;
+			auto referenceIter = referencePackets.begin();
+			while (reader->getNextPacket(rawPacket))
+			{
+				PTF_ASSERT_TRUE(referenceIter != referencePackets.end());
+				PTF_ASSERT_EQUAL(rawPacket.getRawDataLen(), (*referenceIter)->getRawDataLen());
+				PTF_ASSERT_EQUAL(rawPacket.getFrameLength(), (*referenceIter)->getFrameLength());
+				PTF_ASSERT_EQUAL(rawPacket.getLinkLayerType(), (*referenceIter)->getLinkLayerType(), enum);
+				PTF_ASSERT_BUF_COMPARE(rawPacket.getRawData(), (*referenceIter)->getRawData(), rawPacket.getRawDataLen());
+
+				pcpp::Packet packet(&rawPacket);
+				if (packet.isPacketOfType(pcpp::TCP))
+					tcpCount++;
+
+				// assigning into a packet that doesn't own its data copies the data without freeing the reader's buffer
+				if (packetCount == 0)
+				{
+					rawPacket = *referencePackets.front();
+					PTF_ASSERT_EQUAL(rawPacket.getRawDataLen(), referencePackets.front()->getRawDataLen());
+					PTF_ASSERT_BUF_COMPARE(rawPacket.getRawData(), referencePackets.front()->getRawData(), rawPacket.getRawDataLen());
+				}
+
+				packetCount++;
+				referenceIter++;
+			}
+
+			PTF_ASSERT_EQUAL(packetCount, numOfPackets);
+			PTF_ASSERT_GREATER_THAN(tcpCount, 0);
+
+			// bulk reading always copies the packets, regardless of the mode
+			reader->close();
+			PTF_ASSERT_TRUE(reader->open());
+			pcpp::RawPacketVector packetVec;
+			PTF_ASSERT_EQUAL(reader->getNextPackets(packetVec), numOfPackets);
+			PTF_ASSERT_EQUAL(reader->getPacketDataMode(), mode, enum);
+			PTF_ASSERT_BUF_COMPARE(packetVec.front()->getRawData(), referencePackets.front()->getRawData(), referencePackets.front()->getRawDataLen());
+			PTF_ASSERT_BUF_COMPARE(packetVec.at(numOfPackets - 1)->getRawData(), referencePackets.at(numOfPackets - 1)->getRawData(), referencePackets.at(numOfPackets - 1)->getRawDataLen());
+			reader->close();
+		}
+
+		referenceReader->close();
+	}
+} // TestFileReaderPacketDataModes
+
+
+
+PTF_TEST_CASE(TestPcapMmapFileReader)
+{
+	// read all packets with the regular pcap reader for reference
+	pcpp::PcapFileReaderDevice referenceReader(EXAMPLE_PCAP_PATH);
+	PTF_ASSERT_TRUE(referenceReader.open());
+	pcpp::RawPacketVector referencePackets;
+	int numOfPackets = referenceReader.getNextPackets(referencePackets);
+	PTF_ASSERT_EQUAL(numOfPackets, 4631);
+	referenceReader.close();
+
+	pcpp::PcapMmapFileReaderDevice readerDev(EXAMPLE_PCAP_PATH);
+	PTF_ASSERT_EQUAL(readerDev.getPacketDataMode(), pcpp::IFileReaderDevice::ZeroCopyPacketData, enum);
+	std::vector<pcpp::PcapMmapFileReaderDevice::FileRange> ranges;
+	pcpp::Logger::getInstance().suppressLogs();
+	PTF_ASSERT_FALSE(readerDev.splitToRanges(4, ranges));
+	pcpp::Logger::getInstance().enableLogs();
+	PTF_ASSERT_TRUE(readerDev.open());
+	PTF_ASSERT_EQUAL(readerDev.getLinkLayerType(), pcpp::LINKTYPE_ETHERNET, enum);
+
+	// sequential read
+	pcpp::RawPacket rawPacket;
+	int packetCount = 0;
+	while (readerDev.getNextPacket(rawPacket))
+	{
+		pcpp::RawPacket* referencePacket = referencePackets.at(packetCount);
+		PTF_ASSERT_EQUAL(rawPacket.getRawDataLen(), referencePacket->getRawDataLen());
+		PTF_ASSERT_EQUAL(rawPacket.getFrameLength(), referencePacket->getFrameLength());
+		PTF_ASSERT_EQUAL(rawPacket.getPacketTimeStamp().tv_sec, referencePacket->getPacketTimeStamp().tv_sec);
+		PTF_ASSERT_EQUAL(rawPacket.getPacketTimeStamp().tv_nsec, referencePacket->getPacketTimeStamp().tv_nsec);
+		PTF_ASSERT_BUF_COMPARE(rawPacket.getRawData(), referencePacket->getRawData(), rawPacket.getRawDataLen());
+		packetCount++;
+	}
+	PTF_ASSERT_EQUAL(packetCount, numOfPackets);
+
+	pcpp::IPcapDevice::PcapStats readerStatistics;
+	readerDev.getStatistics(readerStatistics);
+	PTF_ASSERT_EQUAL((uint32_t)readerStatistics.packetsRecv, 4631);
+
+	// split the file to ranges and make sure together they cover all packets exactly once and in order
+	const size_t numOfRangesToTest[] = { 1, 2, 3, 4, 5, 6, 7, 8, 64 };
+	for (size_t numOfRanges : numOfRangesToTest)
+	{
+		PTF_ASSERT_TRUE(readerDev.splitToRanges(numOfRanges, ranges));
+		PTF_ASSERT_EQUAL(ranges.size(), numOfRanges);
+		PTF_ASSERT_EQUAL(ranges.front().startOffset, (uint64_t)24); // the size of the pcap file header;
+		PTF_ASSERT_EQUAL(ranges.back().endOffset, readerDev.getMappedSize());
+
+		int rangesPacketCount = 0;
+		for (size_t i = 0; i < ranges.size(); i++)
+		{
+			if (i > 0)
+				PTF_ASSERT_EQUAL(ranges[i].startOffset, ranges[i - 1].endOffset);
+
+			pcpp::PcapMmapFileReaderDevice::RangeReader rangeReader = readerDev.getRangeReader(ranges[i]);
+			while (rangeReader.getNextPacket(rawPacket))
+			{
+				pcpp::RawPacket* referencePacket = referencePackets.at(rangesPacketCount);
+				PTF_ASSERT_EQUAL(rawPacket.getRawDataLen(), referencePacket->getRawDataLen());
+				PTF_ASSERT_BUF_COMPARE(rawPacket.getRawData(), referencePacket->getRawData(), rawPacket.getRawDataLen());
+				rangesPacketCount++;
+			}
+			PTF_ASSERT_EQUAL(rangeReader.getCurrentOffset(), ranges[i].endOffset);
+		}
+		PTF_ASSERT_EQUAL(rangesPacketCount, numOfPackets);
+	}
+
+	// filter applies to sequential reads
+	readerDev.close();
+	PTF_ASSERT_TRUE(readerDev.open());
+	PTF_ASSERT_TRUE(readerDev.setFilter("tcp"));
+	int tcpCount = 0;
+	while (readerDev.getNextPacket(rawPacket))
+	{
+		pcpp::Packet packet(&rawPacket);
+		PTF_ASSERT_TRUE(packet.isPacketOfType(pcpp::TCP));
+		tcpCount++;
+	}
+	PTF_ASSERT_GREATER_THAN(tcpCount, 0);
+	PTF_ASSERT_LOWER_THAN(tcpCount, numOfPackets);
+
+	readerDev.close();
+	PTF_ASSERT_FALSE(readerDev.isOpened());
+
+	pcpp::PcapMmapFileReaderDevice nonExistingReader(EXAMPLE_PCAP_PATH "_does_not_exist");
+	pcpp::Logger::getInstance().suppressLogs();
+	PTF_ASSERT_FALSE(nonExistingReader.open());
+	pcpp::Logger::getInstance().enableLogs();
+} // TestPcapMmapFileReader
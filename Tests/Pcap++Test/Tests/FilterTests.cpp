@@ -8,6 +8,7 @@
 #include "UdpLayer.h"
 #include "PcapLiveDeviceList.h"
 #include "PcapFileDevice.h"
+#include "PcapFilter.h"
 #include "../Common/GlobalTestArgs.h"
 #include "../Common/PcapFileNamesDef.h"
 #include "../Common/TestUtils.h"
@@ -733,6 +734,253 @@ PTF_TEST_CASE(TestPcapFiltersOffline)
 	rawPacketVec.clear();
 }
 
+PTF_TEST_CASE(TestPcapFiltersCompiled)
+{
+	// the expected numbers of matching packets are the same ones TestPcapFiltersOffline gets using BPF
+
+	pcpp::RawPacketVector vlanPackets, examplePackets, grePackets, igmpPackets, rawIPPackets, sllPackets;
+	pcpp::PcapFileReaderDevice fileReaderDev(EXAMPLE_PCAP_VLAN);
+	PTF_ASSERT_TRUE(fileReaderDev.open());
+	fileReaderDev.getNextPackets(vlanPackets);
+	fileReaderDev.close();
+	pcpp::PcapFileReaderDevice fileReaderDev2(EXAMPLE_PCAP_PATH);
+	PTF_ASSERT_TRUE(fileReaderDev2.open());
+	fileReaderDev2.getNextPackets(examplePackets);
+	fileReaderDev2.close();
+	pcpp::PcapFileReaderDevice fileReaderDev3(EXAMPLE_PCAP_GRE);
+	PTF_ASSERT_TRUE(fileReaderDev3.open());
+	fileReaderDev3.getNextPackets(grePackets);
+	fileReaderDev3.close();
+	pcpp::PcapFileReaderDevice fileReaderDev4(EXAMPLE_PCAP_IGMP);
+	PTF_ASSERT_TRUE(fileReaderDev4.open());
+	fileReaderDev4.getNextPackets(igmpPackets);
+	fileReaderDev4.close();
+
+	pcpp::CompiledFilter compiledFilter;
+	std::vector<bool> results;
+
+	// an empty filter matches everything
+	PTF_ASSERT_TRUE(compiledFilter.isNative());
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(vlanPackets, results), vlanPackets.size());
+	PTF_ASSERT_EQUAL(results.size(), vlanPackets.size());
+
+	pcpp::VlanFilter vlanFilter(118);
+	PTF_ASSERT_TRUE(compiledFilter.compile(vlanFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(vlanPackets, results), 12);
+	for (size_t i = 0; i < vlanPackets.size(); i++)
+	{
+		pcpp::Packet packet(vlanPackets.at(i));
+		pcpp::VlanLayer* vlanLayer = packet.getLayerOfType<pcpp::VlanLayer>();
+		PTF_ASSERT_EQUAL((bool)results[i], vlanLayer != nullptr && vlanLayer->getVlanID() == 118);
+		PTF_ASSERT_EQUAL(compiledFilter.matchPacket(packet), (bool)results[i]);
+	}
+
+	pcpp::MacAddressFilter macAddrFilter(pcpp::MacAddress("00:13:c3:df:ae:18"), pcpp::DST);
+	PTF_ASSERT_TRUE(compiledFilter.compile(macAddrFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(vlanPackets, results), 5);
+
+	pcpp::EtherTypeFilter ethTypeFilter(PCPP_ETHERTYPE_VLAN);
+	PTF_ASSERT_TRUE(compiledFilter.compile(ethTypeFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(vlanPackets, results), 24);
+
+	pcpp::IPv4IDFilter ipIDFilter(0x9900, pcpp::GREATER_THAN);
+	PTF_ASSERT_TRUE(compiledFilter.compile(ipIDFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(examplePackets, results), 1423);
+
+	pcpp::IPv4TotalLengthFilter ipTotalLengthFilter(576, pcpp::LESS_OR_EQUAL);
+	PTF_ASSERT_TRUE(compiledFilter.compile(ipTotalLengthFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(examplePackets, results), 2066);
+
+	pcpp::TcpWindowSizeFilter tcpWindowSizeFilter(8312, pcpp::NOT_EQUALS);
+	PTF_ASSERT_TRUE(compiledFilter.compile(tcpWindowSizeFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(examplePackets, results), 4249);
+
+	pcpp::UdpLengthFilter udpLengthFilter(46, pcpp::EQUALS);
+	PTF_ASSERT_TRUE(compiledFilter.compile(udpLengthFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(examplePackets, results), 4);
+
+	pcpp::IPFilter ipFilterWithMask("212.199.202.9", pcpp::SRC, "255.255.255.0");
+	PTF_ASSERT_TRUE(compiledFilter.compile(ipFilterWithMask));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(examplePackets, results), 2536);
+	ipFilterWithMask.setLen(24);
+	PTF_ASSERT_TRUE(compiledFilter.compile(ipFilterWithMask));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(examplePackets, results), 2536);
+
+	pcpp::PortRangeFilter portRangeFilter(40000, 50000, pcpp::SRC);
+	PTF_ASSERT_TRUE(compiledFilter.compile(portRangeFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(examplePackets, results), 1464);
+
+	pcpp::TcpFlagsFilter tcpFlagsFilter(pcpp::TcpFlagsFilter::tcpSyn | pcpp::TcpFlagsFilter::tcpAck, pcpp::TcpFlagsFilter::MatchAll);
+	PTF_ASSERT_TRUE(compiledFilter.compile(tcpFlagsFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(examplePackets, results), 65);
+	tcpFlagsFilter.setTcpFlagsBitMask(pcpp::TcpFlagsFilter::tcpSyn | pcpp::TcpFlagsFilter::tcpAck, pcpp::TcpFlagsFilter::MatchOneAtLeast);
+	PTF_ASSERT_TRUE(compiledFilter.compile(tcpFlagsFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(examplePackets, results), 4489);
+
+	pcpp::ProtoFilter protoFilter(pcpp::ARP);
+	PTF_ASSERT_TRUE(compiledFilter.compile(protoFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(grePackets, results), 2);
+	protoFilter.setProto(pcpp::TCP);
+	PTF_ASSERT_TRUE(compiledFilter.compile(protoFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(grePackets, results), 9);
+	protoFilter.setProto(pcpp::GRE);
+	PTF_ASSERT_TRUE(compiledFilter.compile(protoFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(grePackets, results), 17);
+	protoFilter.setProto(pcpp::UDP);
+	PTF_ASSERT_TRUE(compiledFilter.compile(protoFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(igmpPackets, results), 38);
+	protoFilter.setProto(pcpp::IGMP);
+	PTF_ASSERT_TRUE(compiledFilter.compile(protoFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(igmpPackets, results), 6);
+
+	// and, or, not
+	pcpp::IPFilter ipFilter("10.0.0.6", pcpp::SRC);
+	protoFilter.setProto(pcpp::UDP);
+	std::vector<pcpp::GeneralFilter*> filterVec;
+	filterVec.push_back(&ipFilter);
+	filterVec.push_back(&protoFilter);
+	pcpp::AndFilter andFilter(filterVec);
+	PTF_ASSERT_TRUE(compiledFilter.compile(andFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(examplePackets, results), 69);
+
+	pcpp::NotFilter notFilter(&andFilter);
+	PTF_ASSERT_TRUE(compiledFilter.compile(notFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(examplePackets, results), examplePackets.size() - 69);
+
+	protoFilter.setProto(pcpp::GRE);
+	ipFilter.setAddr("20.0.0.1");
+	ipFilter.setDirection(pcpp::SRC_OR_DST);
+	filterVec.clear();
+	filterVec.push_back(&protoFilter);
+	filterVec.push_back(&ipFilter);
+	andFilter.setFilters(filterVec);
+	pcpp::ProtoFilter protoFilter2(pcpp::ARP);
+	pcpp::OrFilter orFilter;
+	orFilter.addFilter(&protoFilter2);
+	orFilter.addFilter(&andFilter);
+	PTF_ASSERT_TRUE(compiledFilter.compile(orFilter));
+	PTF_ASSERT_EQUAL(compiledFilter.matchPackets(grePackets, results), 19);
+
+	// GeneralFilter::matchPacketWithFilter() uses the native program and follows changes in the filter
+	int matchCount = 0;
+	for (pcpp::RawPacketVector::VectorIterator iter = examplePackets.begin(); iter != examplePackets.end(); iter++)
+	{
+		if (udpLengthFilter.matchPacketWithFilter(*iter))
+			matchCount++;
+	}
+	PTF_ASSERT_EQUAL(matchCount, 4);
+	udpLengthFilter.setLength(46);
+	udpLengthFilter.setOperator(pcpp::NOT_EQUALS);
+	matchCount = 0;
+	for (pcpp::RawPacketVector::VectorIterator iter = examplePackets.begin(); iter != examplePackets.end(); iter++)
+	{
+		if (udpLengthFilter.matchPacketWithFilter(*iter))
+			matchCount++;
+	}
+	udpLengthFilter.setOperator(pcpp::GREATER_OR_EQUAL);
+	udpLengthFilter.setLength(0);
+	PTF_ASSERT_TRUE(compiledFilter.compile(udpLengthFilter));
+	PTF_ASSERT_EQUAL((size_t)matchCount + 4, compiledFilter.matchPackets(examplePackets, results));
+
+	// changes in a sub-filter are followed as well, although the filter that is matched isn't modified itself
+	pcpp::UdpLengthFilter innerUdpLengthFilter(46, pcpp::EQUALS);
+	pcpp::NotFilter notUdpLengthFilter(&innerUdpLengthFilter);
+	matchCount = 0;
+	for (pcpp::RawPacketVector::VectorIterator iter = examplePackets.begin(); iter != examplePackets.end(); iter++)
+	{
+		if (notUdpLengthFilter.matchPacketWithFilter(*iter))
+			matchCount++;
+	}
+	PTF_ASSERT_EQUAL((size_t)matchCount + 4, examplePackets.size());
+	pcpp::UdpLengthFilter equalsUdpLengthFilter(46, pcpp::EQUALS);
+	innerUdpLengthFilter.setOperator(pcpp::NOT_EQUALS);
+	matchCount = 0;
+	for (pcpp::RawPacketVector::VectorIterator iter = examplePackets.begin(); iter != examplePackets.end(); iter++)
+	{
+		if (notUdpLengthFilter.matchPacketWithFilter(*iter))
+			matchCount++;
+	}
+	PTF_ASSERT_TRUE(compiledFilter.compile(notUdpLengthFilter));
+	PTF_ASSERT_EQUAL((size_t)matchCount, compiledFilter.matchPackets(examplePackets, results));
+	PTF_ASSERT_NOT_EQUAL((size_t)matchCount + 4, examplePackets.size());
+
+	// assigning to a sub-filter is a change as well
+	innerUdpLengthFilter = equalsUdpLengthFilter;
+	matchCount = 0;
+	for (pcpp::RawPacketVector::VectorIterator iter = examplePackets.begin(); iter != examplePackets.end(); iter++)
+	{
+		if (notUdpLengthFilter.matchPacketWithFilter(*iter))
+			matchCount++;
+	}
+	PTF_ASSERT_EQUAL((size_t)matchCount + 4, examplePackets.size());
+
+	// VLAN filters shift the offsets of the filters that follow them, like in BPF: "vlan and ip" matches IPv4 inside VLAN
+	pcpp::ProtoFilter vlanProtoFilter(pcpp::VLAN);
+	pcpp::ProtoFilter ipProtoFilter(pcpp::IPv4);
+	pcpp::AndFilter vlanAndIPFilter;
+	vlanAndIPFilter.addFilter(&vlanProtoFilter);
+	vlanAndIPFilter.addFilter(&ipProtoFilter);
+	PTF_ASSERT_TRUE(compiledFilter.compile(vlanAndIPFilter));
+	compiledFilter.matchPackets(vlanPackets, results);
+	for (size_t i = 0; i < vlanPackets.size(); i++)
+	{
+		pcpp::Packet packet(vlanPackets.at(i));
+		pcpp::VlanLayer* vlanLayer = packet.getLayerOfType<pcpp::VlanLayer>();
+		bool isIPv4InVlan = (vlanLayer != nullptr && vlanLayer->getNextLayer() != nullptr && vlanLayer->getNextLayer()->getProtocol() == pcpp::IPv4);
+		PTF_ASSERT_EQUAL((bool)results[i], isIPv4InVlan);
+	}
+
+	// link types other than Ethernet
+	pcpp::PcapFileReaderDevice fileReaderDev5(RAW_IP_PCAP_PATH);
+	PTF_ASSERT_TRUE(fileReaderDev5.open());
+	fileReaderDev5.getNextPackets(rawIPPackets);
+	fileReaderDev5.close();
+	pcpp::PcapFileReaderDevice fileReaderDev6(SLL_PCAP_PATH);
+	PTF_ASSERT_TRUE(fileReaderDev6.open());
+	fileReaderDev6.getNextPackets(sllPackets);
+	fileReaderDev6.close();
+
+	protoFilter.setProto(pcpp::TCP);
+	PTF_ASSERT_TRUE(compiledFilter.compile(protoFilter));
+	PTF_ASSERT_TRUE(compiledFilter.isNativeForLinkType(pcpp::LINKTYPE_DLT_RAW1));
+	PTF_ASSERT_TRUE(compiledFilter.isNativeForLinkType(pcpp::LINKTYPE_LINUX_SLL));
+	PTF_ASSERT_FALSE(compiledFilter.isNativeForLinkType(pcpp::LINKTYPE_NULL));
+	pcpp::RawPacketVector* linkTypePackets[] = { &rawIPPackets, &sllPackets };
+	for (int i = 0; i < 2; i++)
+	{
+		size_t expectedCount = 0;
+		for (pcpp::RawPacketVector::VectorIterator iter = linkTypePackets[i]->begin(); iter != linkTypePackets[i]->end(); iter++)
+		{
+			pcpp::Packet packet(*iter);
+			if (packet.isPacketOfType(pcpp::TCP))
+				expectedCount++;
+		}
+		PTF_ASSERT_GREATER_THAN(expectedCount, 0);
+		PTF_ASSERT_EQUAL(compiledFilter.matchPackets(*linkTypePackets[i], results), expectedCount);
+	}
+
+	// MAC address filters are natively evaluated only for Ethernet
+	PTF_ASSERT_TRUE(compiledFilter.compile(macAddrFilter));
+	PTF_ASSERT_TRUE(compiledFilter.isNativeForLinkType(pcpp::LINKTYPE_ETHERNET));
+	PTF_ASSERT_FALSE(compiledFilter.isNativeForLinkType(pcpp::LINKTYPE_LINUX_SLL));
+
+	// filters that can't be compiled natively use BPF
+	pcpp::BPFStringFilter bpfStringFilter("ether dst 00:13:c3:df:ae:18");
+	PTF_ASSERT_FALSE(compiledFilter.compile(bpfStringFilter));
+	PTF_ASSERT_FALSE(compiledFilter.isNative());
+	PTF_ASSERT_FALSE(compiledFilter.isNativeForLinkType(pcpp::LINKTYPE_ETHERNET));
+	pcpp::IPFilter ipv6Filter("2001:db8::1", pcpp::SRC);
+	PTF_ASSERT_FALSE(compiledFilter.compile(ipv6Filter));
+	pcpp::AndFilter emptyAndFilter;
+	filterVec.clear();
+	filterVec.push_back(&emptyAndFilter);
+	filterVec.push_back(&ipFilter);
+	pcpp::OrFilter orWithEmptyFilter(filterVec);
+	PTF_ASSERT_FALSE(compiledFilter.compile(orWithEmptyFilter));
+} // TestPcapFiltersCompiled
+
+
+
 PTF_TEST_CASE(TestPcapFilters_LinkLayer)
 {
 	// check if matchPacketWithFilter work properly for packets with different LinkLayerType
@@ -1,6 +1,8 @@
 #include "../TestDefinition.h"
 #include "../Common/TestUtils.h"
 #include "IPReassembly.h"
+#include "EthLayer.h"
+#include "IPv4Layer.h"
 #include "IPv6Layer.h"
 #include "HttpLayer.h"
 #include "PcapFileDevice.h"
@@ -1105,3 +1107,134 @@ PTF_TEST_CASE(TestIPFragWithPadding)
 	delete result;
 	delete [] buffer;
 } // TestIPFragWithPadding
+
+
+PTF_TEST_CASE(TestIPFragMemoryBudget)
+{
+	pcpp::PcapFileReaderDevice reader("PcapExamples/ip4_fragments.pcap");
+	PTF_ASSERT_TRUE(reader.open());
+
+	pcpp::RawPacketVector ip4Packet1Frags;
+	pcpp::RawPacketVector ip4Packet2Frags;
+	pcpp::RawPacketVector ip4Packet3Frags;
+
+	PTF_ASSERT_EQUAL(reader.getNextPackets(ip4Packet1Frags, 6), 6);
+	PTF_ASSERT_EQUAL(reader.getNextPackets(ip4Packet2Frags, 6), 6);
+	PTF_ASSERT_EQUAL(reader.getNextPackets(ip4Packet3Frags, 6), 6);
+
+	pcpp::IPReassembly::ReassemblyStatus status;
+
+	// no budget: bytes are held while packets are reassembled and released when they're done
+	pcpp::IPReassembly ipReassembly;
+	PTF_ASSERT_EQUAL(ipReassembly.getMaxBytesToStore(), 0);
+	PTF_ASSERT_EQUAL(ipReassembly.getCurrentBytesHeld(), 0);
+
+	ipReassembly.processPacket(ip4Packet1Frags.at(0), status);
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::FIRST_FRAGMENT, enum);
+	size_t bytesPerPacket = ipReassembly.getCurrentBytesHeld();
+	PTF_ASSERT_GREATER_THAN(bytesPerPacket, 0);
+	ipReassembly.processPacket(ip4Packet2Frags.at(0), status);
+	PTF_ASSERT_EQUAL(ipReassembly.getCurrentBytesHeld(), 2 * bytesPerPacket);
+
+	// without a budget a duplicated out-of-order fragment is stored as well
+	ipReassembly.processPacket(ip4Packet1Frags.at(2), status);
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::OUT_OF_ORDER_FRAGMENT, enum);
+	ipReassembly.processPacket(ip4Packet1Frags.at(2), status);
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::OUT_OF_ORDER_FRAGMENT, enum);
+	PTF_ASSERT_EQUAL(ipReassembly.getNumOfDroppedFragments(), 0);
+
+	pcpp::Packet* result = nullptr;
+	for (size_t i = 1; i < ip4Packet1Frags.size(); i++)
+	{
+		if (i != 2)
+			result = ipReassembly.processPacket(ip4Packet1Frags.at(i), status);
+	}
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::REASSEMBLED, enum);
+	PTF_ASSERT_NOT_NULL(result);
+	delete result;
+
+	PTF_ASSERT_EQUAL(ipReassembly.getCurrentCapacity(), 1);
+	PTF_ASSERT_EQUAL(ipReassembly.getCurrentBytesHeld(), bytesPerPacket);
+	ipReassembly.processPacket(ip4Packet2Frags.at(1), status);
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::FRAGMENT, enum);
+	PTF_ASSERT_GREATER_OR_EQUAL_THAN(ipReassembly.getCurrentBytesHeld(), bytesPerPacket);
+
+	pcpp::IPReassembly::IPv4PacketKey ip4Key(0x1ea1, pcpp::IPv4Address(std::string("10.118.213.212")), pcpp::IPv4Address(std::string("10.118.213.211")));
+	ipReassembly.removePacket(ip4Key);
+	PTF_ASSERT_EQUAL(ipReassembly.getCurrentCapacity(), 0);
+	PTF_ASSERT_EQUAL(ipReassembly.getCurrentBytesHeld(), 0);
+	PTF_ASSERT_EQUAL(ipReassembly.getNumOfDroppedFragments(), 0);
+
+	// with a budget a duplicated out-of-order fragment overlaps the stored one, so it's dropped
+	pcpp::IPReassembly overlapIPReassembly(nullptr, nullptr, PCPP_IP_REASSEMBLY_DEFAULT_MAX_PACKETS_TO_STORE, 1000000);
+	overlapIPReassembly.processPacket(ip4Packet1Frags.at(2), status);
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::OUT_OF_ORDER_FRAGMENT, enum);
+	overlapIPReassembly.processPacket(ip4Packet1Frags.at(2), status);
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::FRAGMENT_DROPPED, enum);
+	PTF_ASSERT_EQUAL(overlapIPReassembly.getNumOfDroppedFragments(), 1);
+	for (size_t i = 0; i < ip4Packet1Frags.size(); i++)
+	{
+		if (i != 2)
+			result = overlapIPReassembly.processPacket(ip4Packet1Frags.at(i), status);
+	}
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::REASSEMBLED, enum);
+	PTF_ASSERT_NOT_NULL(result);
+	delete result;
+
+	// the IP fields of the reassembled packet are fixed even if it's parsed only until a layer below IP
+	pcpp::IPReassembly parseUntilIPReassembly;
+	for (size_t i = 0; i < ip4Packet1Frags.size(); i++)
+		result = parseUntilIPReassembly.processPacket(ip4Packet1Frags.at(i), status, pcpp::UnknownProtocol, pcpp::OsiModelDataLinkLayer);
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::REASSEMBLED, enum);
+	PTF_ASSERT_NOT_NULL(result);
+	PTF_ASSERT_NOT_NULL(result->getLayerOfType<pcpp::EthLayer>());
+	PTF_ASSERT_NULL(result->getLayerOfType<pcpp::IPv4Layer>());
+	pcpp::Packet fullyParsedResult(result->getRawPacket());
+	PTF_ASSERT_NOT_NULL(fullyParsedResult.getLayerOfType<pcpp::IPv4Layer>());
+	PTF_ASSERT_EQUAL(fullyParsedResult.getLayerOfType<pcpp::IPv4Layer>()->getFragmentOffset(), 0);
+	PTF_ASSERT_FALSE(fullyParsedResult.getLayerOfType<pcpp::IPv4Layer>()->isFragment());
+	delete result;
+
+	// a budget for 2 packets: the least recently used packet is dropped to make room for the 3rd one
+	pcpp::PointerVector<pcpp::IPReassembly::PacketKey> packetsRemovedFromIPReassemblyEngine;
+	pcpp::IPReassembly budgetIPReassembly(ipReassemblyOnFragmentsClean, &packetsRemovedFromIPReassemblyEngine, PCPP_IP_REASSEMBLY_DEFAULT_MAX_PACKETS_TO_STORE, 2 * bytesPerPacket);
+	PTF_ASSERT_EQUAL(budgetIPReassembly.getMaxBytesToStore(), 2 * bytesPerPacket);
+
+	budgetIPReassembly.processPacket(ip4Packet1Frags.at(0), status);
+	budgetIPReassembly.processPacket(ip4Packet2Frags.at(0), status);
+	budgetIPReassembly.processPacket(ip4Packet1Frags.at(1), status);
+	PTF_ASSERT_EQUAL(budgetIPReassembly.getCurrentCapacity(), 2);
+	PTF_ASSERT_EQUAL(packetsRemovedFromIPReassemblyEngine.size(), 0);
+
+	budgetIPReassembly.processPacket(ip4Packet3Frags.at(0), status);
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::FIRST_FRAGMENT, enum);
+	PTF_ASSERT_EQUAL(packetsRemovedFromIPReassemblyEngine.size(), 1);
+	pcpp::IPReassembly::IPv4PacketKey* removedKey = dynamic_cast<pcpp::IPReassembly::IPv4PacketKey*>(packetsRemovedFromIPReassemblyEngine.at(0));
+	PTF_ASSERT_NOT_NULL(removedKey);
+	PTF_ASSERT_EQUAL(removedKey->getIpID(), 0x1ea1);
+	PTF_ASSERT_EQUAL(budgetIPReassembly.getCurrentCapacity(), 2);
+	PTF_ASSERT_LOWER_OR_EQUAL_THAN(budgetIPReassembly.getCurrentBytesHeld(), 2 * bytesPerPacket);
+	PTF_ASSERT_EQUAL(budgetIPReassembly.getNumOfDroppedFragments(), 1);
+
+	// a budget smaller than a single fragment
+	pcpp::IPReassembly tinyIPReassembly(nullptr, nullptr, PCPP_IP_REASSEMBLY_DEFAULT_MAX_PACKETS_TO_STORE, 100);
+	PTF_ASSERT_NULL(tinyIPReassembly.processPacket(ip4Packet1Frags.at(0), status));
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::FRAGMENT_DROPPED, enum);
+	PTF_ASSERT_NULL(tinyIPReassembly.processPacket(ip4Packet1Frags.at(3), status));
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::FRAGMENT_DROPPED, enum);
+	PTF_ASSERT_EQUAL(tinyIPReassembly.getCurrentBytesHeld(), 0);
+	PTF_ASSERT_EQUAL(tinyIPReassembly.getNumOfDroppedFragments(), 2);
+
+	// an out-of-order fragment with a high offset holds memory for its own data only, not for the whole packet
+	pcpp::RawPacket highOffsetRawPacket(*ip4Packet1Frags.at(3));
+	pcpp::Packet highOffsetFragment(&highOffsetRawPacket);
+	pcpp::IPv4Layer* highOffsetIPLayer = highOffsetFragment.getLayerOfType<pcpp::IPv4Layer>();
+	PTF_ASSERT_NOT_NULL(highOffsetIPLayer);
+	highOffsetIPLayer->getIPv4Header()->fragmentOffset = htobe16(0x2000 | (64000 / 8));
+	size_t highOffsetPayloadLen = highOffsetIPLayer->getLayerPayloadSize();
+	pcpp::IPReassembly highOffsetIPReassembly;
+	PTF_ASSERT_NULL(highOffsetIPReassembly.processPacket(&highOffsetFragment, status));
+	PTF_ASSERT_EQUAL(status, pcpp::IPReassembly::OUT_OF_ORDER_FRAGMENT, enum);
+	PTF_ASSERT_GREATER_OR_EQUAL_THAN(highOffsetIPReassembly.getCurrentBytesHeld(), highOffsetPayloadLen);
+	PTF_ASSERT_LOWER_OR_EQUAL_THAN(highOffsetIPReassembly.getCurrentBytesHeld(), 2 * highOffsetPayloadLen);
+} // TestIPFragMemoryBudget
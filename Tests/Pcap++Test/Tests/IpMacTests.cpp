@@ -275,6 +275,90 @@ PTF_TEST_CASE(TestLRUList)
 } // TestLRUList
 
 
+PTF_TEST_CASE(TestHashedLRUList)
+{
+	pcpp::HashedLRUList<uint32_t> lruList(2);
+
+	uint32_t deletedValue = 0;
+	PTF_ASSERT_EQUAL(lruList.put(1, &deletedValue), 0);
+	PTF_ASSERT_EQUAL(deletedValue, 0);
+
+	PTF_ASSERT_EQUAL(lruList.put(2, nullptr), 0);
+	PTF_ASSERT_EQUAL(lruList.getMRUElement(), 2);
+	PTF_ASSERT_EQUAL(lruList.getLRUElement(), 1);
+
+	PTF_ASSERT_EQUAL(lruList.put(3, &deletedValue), 1);
+	PTF_ASSERT_EQUAL(deletedValue, 1);
+	PTF_ASSERT_EQUAL(lruList.getSize(), 2);
+
+	// putting an existing element advances it to the head of the list
+	PTF_ASSERT_EQUAL(lruList.put(2, &deletedValue), 0);
+	PTF_ASSERT_EQUAL(lruList.getMRUElement(), 2);
+	PTF_ASSERT_EQUAL(lruList.getLRUElement(), 3);
+	PTF_ASSERT_EQUAL(lruList.put(4, &deletedValue), 1);
+	PTF_ASSERT_EQUAL(deletedValue, 3);
+
+	// find() doesn't change the order of the list
+	PTF_ASSERT_NOT_NULL(lruList.find(2));
+	PTF_ASSERT_EQUAL(*lruList.find(2), 2);
+	PTF_ASSERT_NULL(lruList.find(3));
+	PTF_ASSERT_EQUAL(lruList.getLRUElement(), 2);
+
+	lruList.eraseElement(1);
+	lruList.eraseElement(2);
+	lruList.eraseElement(3);
+	PTF_ASSERT_EQUAL(lruList.getSize(), 1);
+	PTF_ASSERT_EQUAL(lruList.getMRUElement(), 4);
+	lruList.eraseElement(4);
+	PTF_ASSERT_EQUAL(lruList.getSize(), 0);
+
+	// compare against LRUList with many elements, so the storage has to grow and hash collisions occur
+	const uint32_t maxSize = 1000;
+	pcpp::LRUList<uint32_t> expectedList(maxSize);
+	pcpp::HashedLRUList<uint32_t> hashedList(maxSize);
+	for (uint32_t i = 0; i < 10 * maxSize; i++)
+	{
+		uint32_t element = (i * 7919) % (3 * maxSize);
+		uint32_t expectedDeletedValue = 0;
+		deletedValue = 0;
+		PTF_ASSERT_EQUAL(hashedList.put(element, &deletedValue), expectedList.put(element, &expectedDeletedValue));
+		PTF_ASSERT_EQUAL(deletedValue, expectedDeletedValue);
+
+		if (i % 3 == 0)
+		{
+			hashedList.eraseElement(element / 2);
+			expectedList.eraseElement(element / 2);
+		}
+
+		PTF_ASSERT_EQUAL(hashedList.getSize(), expectedList.getSize());
+		if (hashedList.getSize() > 0)
+		{
+			PTF_ASSERT_EQUAL(hashedList.getMRUElement(), expectedList.getMRUElement());
+			PTF_ASSERT_EQUAL(hashedList.getLRUElement(), expectedList.getLRUElement());
+		}
+	}
+
+	// a custom hasher that sends all elements to the same bucket
+	struct ConstantHash
+	{
+		size_t operator()(uint32_t) const { return 0; }
+	};
+
+	pcpp::HashedLRUList<uint32_t, ConstantHash> collidingList(10);
+	collidingList.reserve(100);
+	for (uint32_t i = 0; i < 20; i++)
+		collidingList.put(i);
+	PTF_ASSERT_EQUAL(collidingList.getSize(), 10);
+	PTF_ASSERT_EQUAL(collidingList.getLRUElement(), 10);
+	collidingList.eraseElement(15);
+	collidingList.eraseElement(10);
+	PTF_ASSERT_EQUAL(collidingList.getSize(), 8);
+	PTF_ASSERT_EQUAL(collidingList.getLRUElement(), 11);
+	PTF_ASSERT_EQUAL(collidingList.put(16), 0);
+	PTF_ASSERT_EQUAL(collidingList.getMRUElement(), 16);
+} // TestHashedLRUList
+
+
 PTF_TEST_CASE(TestGeneralUtils)
 {
 	uint8_t resultArr[4];
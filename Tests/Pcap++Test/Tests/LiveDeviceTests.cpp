@@ -11,6 +11,7 @@
 #include "../Common/TestUtils.h"
 #include "../Common/PcapFileNamesDef.h"
 #include <sstream>
+#include <algorithm>
 #if defined(_WIN32)
 #include "PcapRemoteDevice.h"
 #include "PcapRemoteDeviceList.h"
@@ -25,6 +26,29 @@ static void packetArrives(pcpp::RawPacket* rawPacket, pcpp::PcapLiveDevice* pDev
 	(*(int*)userCookie)++;
 }
 
+struct BurstCaptureCounters
+{
+	int packetCount;
+	int burstCount;
+	uint32_t maxBurstSize;
+	bool invalidPacketFound;
+
+	BurstCaptureCounters() : packetCount(0), burstCount(0), maxBurstSize(0), invalidPacketFound(false) {}
+};
+
+static void packetsArrive(pcpp::RawPacket* packets, uint32_t numOfPackets, pcpp::PcapLiveDevice* pDevice, void* userCookie)
+{
+	BurstCaptureCounters* counters = (BurstCaptureCounters*)userCookie;
+	counters->burstCount++;
+	counters->packetCount += numOfPackets;
+	counters->maxBurstSize = std::max(counters->maxBurstSize, numOfPackets);
+	for (uint32_t i = 0; i < numOfPackets; i++)
+	{
+		if (!packets[i].isPacketSet() || packets[i].getRawDataLen() <= 0 || packets[i].getLinkLayerType() != pDevice->getLinkType())
+			counters->invalidPacketFound = true;
+	}
+}
+
 static void statsUpdate(pcpp::IPcapDevice::PcapStats& stats, void* userCookie)
 {
 	(*(int*)userCookie)++;
@@ -377,6 +401,68 @@ PTF_TEST_CASE(TestPcapLiveDeviceStatsMode)
 
 
 
+PTF_TEST_CASE(TestPcapLiveDeviceBurstMode)
+{
+	pcpp::PcapLiveDevice* liveDev = pcpp::PcapLiveDeviceList::getInstance().getPcapLiveDeviceByIp(PcapTestGlobalArgs.ipToSendReceivePackets.c_str());
+	PTF_ASSERT_NOT_NULL(liveDev);
+	PTF_ASSERT_TRUE(liveDev->open());
+	DeviceTeardown devTeardown(liveDev);
+
+	// negative tests
+	pcpp::Logger::getInstance().suppressLogs();
+	PTF_ASSERT_FALSE(liveDev->startCaptureBurst(nullptr, nullptr));
+	PTF_ASSERT_FALSE(liveDev->startCaptureBurst(&packetsArrive, nullptr, 0));
+	pcpp::Logger::getInstance().enableLogs();
+
+	BurstCaptureCounters counters;
+	PTF_ASSERT_TRUE(liveDev->startCaptureBurst(&packetsArrive, &counters, 8));
+	pcpp::Logger::getInstance().suppressLogs();
+	PTF_ASSERT_FALSE(liveDev->startCaptureBurst(&packetsArrive, &counters));
+	pcpp::Logger::getInstance().enableLogs();
+	sendURLRequest("www.google.com");
+	int totalSleepTime = 0;
+	while (totalSleepTime <= 20)
+	{
+		pcpp::multiPlatformSleep(2);
+		totalSleepTime += 2;
+		if (counters.packetCount > 0)
+			break;
+	}
+
+	PTF_PRINT_VERBOSE("Total sleep time: " << totalSleepTime << " secs");
+
+	liveDev->stopCapture();
+	PTF_ASSERT_GREATER_THAN(counters.packetCount, 0);
+	PTF_ASSERT_GREATER_THAN(counters.burstCount, 0);
+	PTF_ASSERT_LOWER_OR_EQUAL_THAN(counters.maxBurstSize, (uint32_t)8);
+	PTF_ASSERT_FALSE(counters.invalidPacketFound);
+
+	// capture again with a different burst size and make sure the regular capture modes still work after burst mode
+	BurstCaptureCounters counters2;
+	PTF_ASSERT_TRUE(liveDev->startCaptureBurst(&packetsArrive, &counters2));
+	sendURLRequest("www.google.com");
+	pcpp::multiPlatformSleep(2);
+	liveDev->stopCapture();
+	PTF_ASSERT_LOWER_OR_EQUAL_THAN(counters2.maxBurstSize, (uint32_t)pcpp::PcapLiveDevice::DefaultMaxBurstSize);
+	PTF_ASSERT_FALSE(counters2.invalidPacketFound);
+
+	int packetCount = 0;
+	PTF_ASSERT_TRUE(liveDev->startCapture(&packetArrives, (void*)&packetCount));
+	sendURLRequest("www.google.com");
+	pcpp::multiPlatformSleep(2);
+	liveDev->stopCapture();
+	PTF_ASSERT_GREATER_THAN(packetCount, 0);
+
+	liveDev->close();
+
+	// a negative test
+	pcpp::Logger::getInstance().suppressLogs();
+	PTF_ASSERT_FALSE(liveDev->startCaptureBurst(&packetsArrive, &counters));
+	pcpp::Logger::getInstance().enableLogs();
+} // TestPcapLiveDeviceBurstMode
+
+
+
 PTF_TEST_CASE(TestPcapLiveDeviceBlockingMode)
 {
 	// open device
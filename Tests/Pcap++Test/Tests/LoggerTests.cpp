@@ -87,6 +87,40 @@ class MultiThreadLogCounter
 int MultiThreadLogCounter::logMessageThreadCount[MultiThreadLogCounter::ThreadCount] = {0, 0, 0, 0, 0};
 
 
+class AsyncLogCounter
+{
+	public:
+		static int numOfMessages;
+		static int numOfPrinterThreads;
+		static std::thread::id printerThreadId;
+		static std::string lastMessage;
+
+		static void logPrinter(pcpp::Logger::LogLevel logLevel, const std::string& logMessage, const std::string& fileName, const std::string& method, const int line)
+		{
+			if (numOfMessages == 0 || printerThreadId != std::this_thread::get_id())
+			{
+				numOfPrinterThreads++;
+				printerThreadId = std::this_thread::get_id();
+			}
+			numOfMessages++;
+			lastMessage = logMessage;
+		}
+
+		static void clean()
+		{
+			numOfMessages = 0;
+			numOfPrinterThreads = 0;
+			printerThreadId = std::thread::id();
+			lastMessage.clear();
+		}
+};
+
+int AsyncLogCounter::numOfMessages = 0;
+int AsyncLogCounter::numOfPrinterThreads = 0;
+std::thread::id AsyncLogCounter::printerThreadId;
+std::string AsyncLogCounter::lastMessage;
+
+
 #if defined(_WIN32)
 #define SEPARATOR '\\'
 #else
@@ -141,6 +175,8 @@ class LoggerCleaner
 			pcpp::Logger::getInstance().enableLogs();
 			pcpp::Logger::getInstance().setAllModulesToLogLevel(pcpp::Logger::Info);
 			pcpp::Logger::getInstance().resetLogPrinter();
+			pcpp::Logger::getInstance().stopAsyncLogging();
+			pcpp::Logger::getInstance().setMaxLogsPerSecond(0);
 			std::cout.clear();
 			LogPrinter::clean();
 		}
@@ -306,3 +342,83 @@ PTF_TEST_CASE(TestLogger)
 	PTF_ASSERT_EQUAL(LogPrinter::lastLogLevelSeen, 999);
 	PTF_ASSERT_NULL(LogPrinter::lastLogMessageSeen);
 } // TestLogger
+
+
+
+PTF_TEST_CASE(TestLoggerAsync)
+{
+	// cppcheck-suppress unusedVariable
+	LoggerCleaner loggerCleaner;
+
+	AsyncLogCounter::clean();
+	pcpp::Logger::getInstance().setLogPrinter(&AsyncLogCounter::logPrinter);
+
+	// messages longer than the per-thread format buffer and formatting flags of previous messages
+	pcpp::invokeErrorLog(std::string(1000, 'a'));
+	PTF_ASSERT_EQUAL(pcpp::Logger::getInstance().getLastError().length(), 1009);
+	PCPP_LOG_ERROR(std::hex << 255);
+	PTF_ASSERT_EQUAL(pcpp::Logger::getInstance().getLastError(), "ff");
+	PCPP_LOG_ERROR(255);
+	PTF_ASSERT_EQUAL(pcpp::Logger::getInstance().getLastError(), "255");
+	PTF_ASSERT_EQUAL(AsyncLogCounter::numOfMessages, 3);
+	PTF_ASSERT_TRUE(AsyncLogCounter::printerThreadId == std::this_thread::get_id());
+
+	// async logging: all messages are printed by a single flusher thread. Queues of threads that exited are reused by
+	// new threads, so the capacity fits the messages of all threads in case the flusher doesn't print anything until they're done
+	AsyncLogCounter::clean();
+	PTF_ASSERT_TRUE(pcpp::Logger::getInstance().startAsyncLogging(1024));
+	PTF_ASSERT_FALSE(pcpp::Logger::getInstance().startAsyncLogging());
+	PTF_ASSERT_TRUE(pcpp::Logger::getInstance().isAsyncLoggingEnabled());
+	uint64_t droppedLogs = pcpp::Logger::getInstance().getNumOfDroppedLogs();
+
+	std::thread threads[MultiThreadLogCounter::ThreadCount];
+	for (auto& thread : threads)
+	{
+		thread = std::thread([]() { for (int i = 0; i < 200; i++) pcpp::invokeErrorLog(); });
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	PTF_ASSERT_EQUAL(pcpp::Logger::getInstance().getLastError(), "error log");
+	pcpp::Logger::getInstance().flushAsyncLogs();
+	PTF_ASSERT_EQUAL(AsyncLogCounter::numOfMessages, 1000);
+	PTF_ASSERT_EQUAL(AsyncLogCounter::lastMessage, "error log");
+	PTF_ASSERT_EQUAL(AsyncLogCounter::numOfPrinterThreads, 1);
+	PTF_ASSERT_TRUE(AsyncLogCounter::printerThreadId != std::this_thread::get_id());
+	PTF_ASSERT_EQUAL(pcpp::Logger::getInstance().getNumOfDroppedLogs(), droppedLogs);
+
+	// stopping prints the messages still in the queue
+	pcpp::invokeErrorLog("last");
+	pcpp::Logger::getInstance().stopAsyncLogging();
+	PTF_ASSERT_FALSE(pcpp::Logger::getInstance().isAsyncLoggingEnabled());
+	PTF_ASSERT_EQUAL(AsyncLogCounter::numOfMessages, 1001);
+	PTF_ASSERT_EQUAL(AsyncLogCounter::lastMessage, "error loglast");
+
+	// rate limiting per call site
+	AsyncLogCounter::clean();
+	pcpp::Logger::getInstance().setMaxLogsPerSecond(10);
+	PTF_ASSERT_EQUAL(pcpp::Logger::getInstance().getMaxLogsPerSecond(), 10);
+	for (int i = 0; i < 100; i++)
+	{
+		pcpp::invokeErrorLog();
+	}
+
+	// the messages may span two one second windows
+	int numOfPrintedMessages = AsyncLogCounter::numOfMessages;
+	PTF_ASSERT_GREATER_OR_EQUAL_THAN(numOfPrintedMessages, 10);
+	PTF_ASSERT_LOWER_OR_EQUAL_THAN(numOfPrintedMessages, 20);
+
+	// other call sites aren't affected
+	PCPP_LOG_ERROR("another call site");
+	PTF_ASSERT_EQUAL(AsyncLogCounter::lastMessage, "another call site");
+
+	pcpp::multiPlatformMSleep(1100);
+	pcpp::invokeErrorLog();
+	std::ostringstream expectedMessage;
+	expectedMessage << "error log (" << 100 - numOfPrintedMessages << " similar messages were suppressed)";
+	PTF_ASSERT_EQUAL(AsyncLogCounter::lastMessage, expectedMessage.str());
+	PTF_ASSERT_EQUAL(pcpp::Logger::getInstance().getLastError(), expectedMessage.str());
+} // TestLoggerAsync
@@ -5,6 +5,11 @@
 #include "Packet.h"
 #include "RawSocketDevice.h"
 #include "PcapFileDevice.h"
+#include <set>
+#include <string>
+#include <string.h>
+#include <chrono>
+#include <thread>
 
 extern PcapTestArgs PcapTestGlobalArgs;
 
@@ -160,3 +165,202 @@ PTF_TEST_CASE(TestRawSockets)
 		pcpp::Logger::getInstance().enableLogs();
 	}
 } // TestRawSockets
+
+
+
+PTF_TEST_CASE(TestRawSocketsRxRing)
+{
+	pcpp::IPAddress ipAddr = pcpp::IPAddress(PcapTestGlobalArgs.ipToSendReceivePackets);
+	PTF_ASSERT_TRUE(ipAddr.isValid());
+	pcpp::RawSocketDevice rxRingSock(ipAddr);
+
+#if !defined(__linux__)
+	pcpp::Logger::getInstance().suppressLogs();
+	PTF_ASSERT_FALSE(rxRingSock.open(pcpp::RawSocketDevice::RxRingConfiguration()));
+	PTF_ASSERT_FALSE(rxRingSock.isRxRingEnabled());
+	pcpp::Logger::getInstance().enableLogs();
+	PTF_TEST_CASE_PASSED;
+#endif
+
+	// block size must be a multiple of the page size
+	pcpp::Logger::getInstance().suppressLogs();
+	PTF_ASSERT_FALSE(rxRingSock.open(pcpp::RawSocketDevice::RxRingConfiguration(1000, 4)));
+	PTF_ASSERT_FALSE(rxRingSock.open(pcpp::RawSocketDevice::RxRingConfiguration(1 << 16, 0)));
+	pcpp::Logger::getInstance().enableLogs();
+	PTF_ASSERT_FALSE(rxRingSock.isOpened());
+
+	PTF_ASSERT_TRUE(rxRingSock.open(pcpp::RawSocketDevice::RxRingConfiguration(1 << 16, 8, 5)));
+	PTF_ASSERT_TRUE(rxRingSock.isRxRingEnabled());
+
+	// read packets to send from a file
+	pcpp::PcapFileReaderDevice readerDev(EXAMPLE2_PCAP_PATH);
+	PTF_ASSERT_TRUE(readerDev.open());
+	pcpp::RawPacketVector packetVec;
+	readerDev.getNextPackets(packetVec, 100);
+	std::multiset<std::string> packetsToReceive;
+	for (pcpp::RawPacketVector::VectorIterator iter = packetVec.begin(); iter != packetVec.end(); )
+	{
+		pcpp::Packet parsedPacket(*iter);
+		if (!parsedPacket.isPacketOfType(pcpp::Ethernet))
+		{
+			packetVec.erase(iter);
+			continue;
+		}
+
+		packetsToReceive.insert(std::string((const char*)(*iter)->getRawData(), (*iter)->getRawDataLen()));
+		iter++;
+	}
+	PTF_ASSERT_GREATER_THAN(packetsToReceive.size(), 0);
+
+	// send the packets from another socket on the same interface, and receive them through the ring in batches
+	pcpp::RawSocketDevice sendSock(ipAddr);
+	PTF_ASSERT_TRUE(sendSock.open());
+	PTF_ASSERT_FALSE(sendSock.isRxRingEnabled());
+	PTF_ASSERT_EQUAL(sendSock.sendPackets(packetVec), (int)packetVec.size());
+
+	pcpp::RawPacket rawPacketsArr[32];
+	for (int i = 0; i < 50 && !packetsToReceive.empty(); i++)
+	{
+		int numOfPackets = rxRingSock.receivePackets(rawPacketsArr, 32, true, 1);
+		PTF_ASSERT_LOWER_OR_EQUAL_THAN(numOfPackets, 32);
+		for (int j = 0; j < numOfPackets; j++)
+		{
+			PTF_ASSERT_GREATER_THAN(rawPacketsArr[j].getRawDataLen(), 0);
+			PTF_ASSERT_GREATER_OR_EQUAL_THAN(rawPacketsArr[j].getFrameLength(), rawPacketsArr[j].getRawDataLen());
+			std::multiset<std::string>::iterator iter = packetsToReceive.find(std::string((const char*)rawPacketsArr[j].getRawData(), rawPacketsArr[j].getRawDataLen()));
+			if (iter != packetsToReceive.end())
+				packetsToReceive.erase(iter);
+		}
+	}
+	PTF_ASSERT_EQUAL(packetsToReceive.size(), 0);
+
+	// receive single packets, copying a packet keeps its data after the ring block is returned to the kernel
+	PTF_ASSERT_TRUE(sendSock.sendPacket(packetVec.front()));
+	pcpp::RawPacket rawPacket;
+	PTF_ASSERT_EQUAL(rxRingSock.receivePacket(rawPacket, true, 20), pcpp::RawSocketDevice::RecvSuccess, enum);
+	pcpp::Packet parsedPacket(&rawPacket);
+	PTF_ASSERT_TRUE(parsedPacket.isPacketOfType(pcpp::Ethernet));
+	pcpp::RawPacket copiedPacket(rawPacket);
+	PTF_ASSERT_BUF_COMPARE(copiedPacket.getRawData(), rawPacket.getRawData(), rawPacket.getRawDataLen());
+
+	// receive non-blocking until the ring is empty
+	pcpp::RawSocketDevice::RecvPacketResult res = pcpp::RawSocketDevice::RecvSuccess;
+	for (int i = 0; i < 1000 && res == pcpp::RawSocketDevice::RecvSuccess; i++)
+		res = rxRingSock.receivePacket(rawPacket, false);
+	PTF_NON_CRITICAL_EQUAL(res, pcpp::RawSocketDevice::RecvWouldBlock, enum);
+	PTF_ASSERT_EQUAL(rxRingSock.receivePackets(rawPacketsArr, 32, false), 0);
+
+	// a packet received into a RawPacket that owns its data frees the old data
+	pcpp::RawPacket ownedPacket(copiedPacket);
+	PTF_ASSERT_TRUE(sendSock.sendPacket(packetVec.front()));
+	PTF_ASSERT_EQUAL(rxRingSock.receivePacket(ownedPacket, true, 20), pcpp::RawSocketDevice::RecvSuccess, enum);
+
+	// packets received into a vector are copied out of the ring, so earlier packets keep their data while the ring is reused.
+	// Send numbered packets through a small ring and check that the numbers in the vector never go backwards
+	pcpp::RawSocketDevice smallRxRingSock(ipAddr);
+	PTF_ASSERT_TRUE(smallRxRingSock.open(pcpp::RawSocketDevice::RxRingConfiguration(1 << 16, 2, 5)));
+	const size_t numberedPacketLen = 64;
+	PTF_ASSERT_GREATER_OR_EQUAL_THAN(packetVec.front()->getRawDataLen(), (int)numberedPacketLen);
+	const uint8_t* numberedPacketTemplate = packetVec.front()->getRawData();
+	std::thread senderThread([&sendSock, numberedPacketTemplate, numberedPacketLen]()
+	{
+		for (uint32_t packetNum = 0; packetNum < 2000; packetNum++)
+		{
+			uint8_t numberedPacketData[numberedPacketLen];
+			memcpy(numberedPacketData, numberedPacketTemplate, numberedPacketLen - sizeof(packetNum));
+			memcpy(numberedPacketData + numberedPacketLen - sizeof(packetNum), &packetNum, sizeof(packetNum));
+			timeval time = { 0, 0 };
+			pcpp::RawPacket numberedPacket(numberedPacketData, numberedPacketLen, time, false);
+			sendSock.sendPacket(&numberedPacket);
+			if (packetNum % 50 == 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+	pcpp::RawPacketVector receivedPacketVec;
+	int failedRecv = 0;
+	smallRxRingSock.receivePackets(receivedPacketVec, 2, failedRecv);
+	senderThread.join();
+	int numOfNumberedPackets = 0;
+	uint32_t prevPacketNum = 0;
+	for (pcpp::RawPacketVector::ConstVectorIterator iter = receivedPacketVec.begin(); iter != receivedPacketVec.end(); iter++)
+	{
+		if ((*iter)->getRawDataLen() != (int)numberedPacketLen || memcmp((*iter)->getRawData(), numberedPacketTemplate, numberedPacketLen - sizeof(uint32_t)) != 0)
+			continue;
+
+		uint32_t packetNum;
+		memcpy(&packetNum, (*iter)->getRawData() + numberedPacketLen - sizeof(packetNum), sizeof(packetNum));
+		PTF_ASSERT_GREATER_OR_EQUAL_THAN(packetNum, prevPacketNum);
+		prevPacketNum = packetNum;
+		numOfNumberedPackets++;
+	}
+	PTF_ASSERT_GREATER_THAN(numOfNumberedPackets, 0);
+	smallRxRingSock.close();
+
+	// close and reopen without the ring
+	rxRingSock.close();
+	PTF_ASSERT_FALSE(rxRingSock.isRxRingEnabled());
+	pcpp::Logger::getInstance().suppressLogs();
+	PTF_ASSERT_EQUAL(rxRingSock.receivePackets(rawPacketsArr, 32), 0);
+	pcpp::Logger::getInstance().enableLogs();
+	PTF_ASSERT_TRUE(rxRingSock.open());
+	PTF_ASSERT_FALSE(rxRingSock.isRxRingEnabled());
+	PTF_ASSERT_TRUE(sendSock.sendPacket(packetVec.front()));
+	PTF_ASSERT_GREATER_THAN(rxRingSock.receivePackets(rawPacketsArr, 32, true, 20), 0);
+} // TestRawSocketsRxRing
+
+
+
+PTF_TEST_CASE(TestRawSocketsBatchSend)
+{
+	pcpp::IPAddress ipAddr = pcpp::IPAddress(PcapTestGlobalArgs.ipToSendReceivePackets);
+	PTF_ASSERT_TRUE(ipAddr.isValid());
+	pcpp::RawSocketDevice sendSock(ipAddr);
+
+#if !defined(__linux__)
+	PTF_SKIP_TEST("Batch send is supported on Linux only");
+#endif
+
+	PTF_ASSERT_TRUE(sendSock.open());
+
+	// read more packets than a single batch holds, and add a packet which isn't Ethernet. It should be skipped without failing the rest
+	pcpp::PcapFileReaderDevice readerDev(EXAMPLE2_PCAP_PATH);
+	PTF_ASSERT_TRUE(readerDev.open());
+	pcpp::RawPacketVector packetVec;
+	readerDev.getNextPackets(packetVec, 200);
+	PTF_ASSERT_GREATER_THAN(packetVec.size(), 64);
+	int numOfEthPackets = (int)packetVec.size();
+	uint8_t* nonEthData = new uint8_t[packetVec.front()->getRawDataLen()];
+	memcpy(nonEthData, packetVec.front()->getRawData(), packetVec.front()->getRawDataLen());
+	pcpp::RawPacket* nonEthPacket = new pcpp::RawPacket(nonEthData, packetVec.front()->getRawDataLen(), packetVec.front()->getPacketTimeStamp(), true, pcpp::LINKTYPE_RAW);
+	packetVec.pushBack(nonEthPacket);
+
+	pcpp::RawSocketDevice rxRingSock(ipAddr);
+	PTF_ASSERT_TRUE(rxRingSock.open(pcpp::RawSocketDevice::RxRingConfiguration(1 << 16, 8, 5)));
+
+	int numOfPacketsHandled = 0;
+	PTF_ASSERT_EQUAL(sendSock.sendPackets(packetVec, &numOfPacketsHandled), numOfEthPackets);
+	PTF_ASSERT_EQUAL(numOfPacketsHandled, (int)packetVec.size());
+
+	pcpp::RawPacket rawPacketsArr[32];
+	int numOfPackets = 0;
+	for (int i = 0; i < 50 && numOfPackets == 0; i++)
+		numOfPackets = rxRingSock.receivePackets(rawPacketsArr, 32, true, 1);
+	PTF_ASSERT_GREATER_THAN(numOfPackets, 0);
+
+	// packets received through the ring can be replayed as is
+	PTF_ASSERT_EQUAL(sendSock.sendPackets(rawPacketsArr, numOfPackets, &numOfPacketsHandled), numOfPackets);
+	PTF_ASSERT_EQUAL(numOfPacketsHandled, numOfPackets);
+	PTF_ASSERT_EQUAL(sendSock.sendPackets(rawPacketsArr, 0), 0);
+
+	// a single non-Ethernet packet is rejected
+	pcpp::Logger::getInstance().suppressLogs();
+	PTF_ASSERT_FALSE(sendSock.sendPacket(nonEthPacket));
+	pcpp::Logger::getInstance().enableLogs();
+
+	sendSock.close();
+	pcpp::Logger::getInstance().suppressLogs();
+	PTF_ASSERT_EQUAL(sendSock.sendPackets(packetVec, &numOfPacketsHandled), 0);
+	PTF_ASSERT_EQUAL(numOfPacketsHandled, 0);
+	PTF_ASSERT_EQUAL(sendSock.sendPackets(rawPacketsArr, numOfPackets), 0);
+	pcpp::Logger::getInstance().enableLogs();
+} // TestRawSocketsBatchSend
@@ -3,9 +3,15 @@
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <map>
+#include <string.h>
+#include <mutex>
 #include "EndianPortable.h"
 #include "SystemUtils.h"
 #include "TcpReassembly.h"
+#include "ShardedTcpReassembly.h"
+#include "HttpReassembly.h"
+#include "EthLayer.h"
 #include "IPv4Layer.h"
 #include "TcpLayer.h"
 #include "PayloadLayer.h"
@@ -170,6 +176,38 @@ static void tcpReassemblyConnectionEndCallback(const pcpp::ConnectionData& conne
 }
 
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Thread-safe callbacks for ShardedTcpReassembly, invoked by workers
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct TcpReassemblySharedStats
+{
+	std::mutex mutex;
+	TcpReassemblyMultipleConnStats results;
+};
+
+static void shardedTcpReassemblyMsgReadyCallback(int8_t sideIndex, const pcpp::TcpStreamData& tcpData, void* userCookie)
+{
+	TcpReassemblySharedStats* sharedStats = (TcpReassemblySharedStats*)userCookie;
+	std::lock_guard<std::mutex> lock(sharedStats->mutex);
+	tcpReassemblyMsgReadyCallback(sideIndex, tcpData, &sharedStats->results);
+}
+
+static void shardedTcpReassemblyConnectionStartCallback(const pcpp::ConnectionData& connectionData, void* userCookie)
+{
+	TcpReassemblySharedStats* sharedStats = (TcpReassemblySharedStats*)userCookie;
+	std::lock_guard<std::mutex> lock(sharedStats->mutex);
+	tcpReassemblyConnectionStartCallback(connectionData, &sharedStats->results);
+}
+
+static void shardedTcpReassemblyConnectionEndCallback(const pcpp::ConnectionData& connectionData, pcpp::TcpReassembly::ConnectionEndReason reason, void* userCookie)
+{
+	TcpReassemblySharedStats* sharedStats = (TcpReassemblySharedStats*)userCookie;
+	std::lock_guard<std::mutex> lock(sharedStats->mutex);
+	tcpReassemblyConnectionEndCallback(connectionData, reason, &sharedStats->results);
+}
+
+
 // ~~~~~~~~~~~~~~~~~~~
 // tcpReassemblyTest()
 // ~~~~~~~~~~~~~~~~~~~
@@ -265,6 +303,54 @@ static pcpp::RawPacket tcpReassemblyAddRetransmissions(pcpp::RawPacket rawPacket
 }
 
 
+// ~~~~~~~~~~~~~~~~~~~
+// HttpReassemblyStats
+// ~~~~~~~~~~~~~~~~~~~
+
+struct HttpReassemblyStats
+{
+	std::vector<pcpp::HttpMessageData> messages;
+	std::vector<std::pair<pcpp::HttpMessageData, pcpp::HttpMessageData> > transactions;
+	std::vector<std::string> headerInfo;
+	std::string bodies[2];
+
+	void clear() { messages.clear(); transactions.clear(); headerInfo.clear(); bodies[0].clear(); bodies[1].clear(); }
+};
+
+static void httpReassemblyHeadersCallback(const pcpp::HttpMessageData& message, void* userCookie)
+{
+	HttpReassemblyStats* stats = (HttpReassemblyStats*)userCookie;
+	std::string firstLine((const char*)message.header, std::find(message.header, message.header + message.headerLength, '\r') - message.header);
+	stats->headerInfo.push_back(firstLine + "|" + message.getUri() + "|" + message.getFieldValue("host"));
+}
+
+static void httpReassemblyBodyCallback(const pcpp::HttpMessageData& message, const uint8_t* data, size_t dataLen, void* userCookie)
+{
+	((HttpReassemblyStats*)userCookie)->bodies[message.side].append((const char*)data, dataLen);
+}
+
+static void httpReassemblyMessageEndCallback(const pcpp::HttpMessageData& message, void* userCookie)
+{
+	((HttpReassemblyStats*)userCookie)->messages.push_back(message);
+}
+
+static void httpReassemblyTransactionEndCallback(const pcpp::HttpMessageData& request, const pcpp::HttpMessageData& response, void* userCookie)
+{
+	((HttpReassemblyStats*)userCookie)->transactions.push_back(std::make_pair(request, response));
+}
+
+static void httpReassemblyFeedStream(pcpp::HttpReassembly& httpReassembly, int8_t side, const std::string& stream, size_t segmentSize, const pcpp::ConnectionData& connData)
+{
+	for (size_t offset = 0; offset < stream.length(); offset += segmentSize)
+	{
+		size_t len = std::min(segmentSize, stream.length() - offset);
+		timeval timestamp = { (time_t)offset, 0 };
+		pcpp::TcpStreamData streamData((const uint8_t*)stream.data() + offset, len, 0, connData, timestamp);
+		httpReassembly.onTcpMessageReady(side, streamData);
+	}
+}
+
+
 
 // ~~~~~~~~~~~~~~~~~~~~~
 // ~~~~~~~~~~~~~~~~~~~~~
@@ -1152,3 +1238,530 @@ PTF_TEST_CASE(TestTcpReassemblyTimeStamps)
 	packetStream.clear();
 	tcpReassemblyResults.clear();
 } // TestTcpReassemblyTimeStamps
+
+
+
+PTF_TEST_CASE(TestTcpReassemblyManyConnections)
+{
+	TcpReassemblyMultipleConnStats results;
+	const int numOfConnections = 2000;
+
+	pcpp::TcpReassemblyConfiguration config(true, 1, 100);
+	pcpp::TcpReassembly tcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback, config);
+
+	pcpp::Packet packet;
+	pcpp::EthLayer ethLayer(pcpp::MacAddress("00:11:22:33:44:55"), pcpp::MacAddress("66:77:88:99:aa:bb"));
+	pcpp::IPv4Layer ipLayer(pcpp::IPv4Address("10.0.0.1"), pcpp::IPv4Address("192.168.0.1"));
+	pcpp::TcpLayer tcpLayer(1024, 80);
+	uint8_t payload[] = { 'd', 'a', 't', 'a' };
+	pcpp::PayloadLayer payloadLayer(payload, sizeof(payload), false);
+	PTF_ASSERT_TRUE(packet.addLayer(&ethLayer));
+	PTF_ASSERT_TRUE(packet.addLayer(&ipLayer));
+	PTF_ASSERT_TRUE(packet.addLayer(&tcpLayer));
+	PTF_ASSERT_TRUE(packet.addLayer(&payloadLayer));
+	packet.computeCalculateFields();
+
+	// open many connections so the connection table has to grow a few times
+	for (int i = 0; i < numOfConnections; i++)
+	{
+		ipLayer.getIPv4Header()->ipSrc = htobe32(0x0a000000 + i);
+		tcpLayer.getTcpHeader()->portSrc = htobe16(1024 + i);
+		PTF_ASSERT_EQUAL(tcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::TcpMessageHandled, enum);
+	}
+
+	PTF_ASSERT_EQUAL(results.flowKeysList.size(), numOfConnections);
+	PTF_ASSERT_EQUAL(tcpReassembly.getConnectionInformation().size(), numOfConnections);
+
+	// close every other connection and make sure the rest can still be found after the closed ones are purged
+	for (int i = 0; i < numOfConnections; i += 2)
+		tcpReassembly.closeConnection(results.flowKeysList[i]);
+
+	pcpp::multiPlatformSleep(2);
+
+	uint32_t numOfPurged = 0;
+	uint32_t purgedInLastCall = 0;
+	do
+	{
+		purgedInLastCall = tcpReassembly.purgeClosedConnections();
+		PTF_ASSERT_LOWER_OR_EQUAL_THAN(purgedInLastCall, 100);
+		numOfPurged += purgedInLastCall;
+	} while (purgedInLastCall > 0);
+
+	PTF_ASSERT_EQUAL(numOfPurged, numOfConnections / 2);
+	PTF_ASSERT_EQUAL(tcpReassembly.getConnectionInformation().size(), numOfConnections / 2);
+
+	const pcpp::TcpReassembly::ConnectionInfoList& managedConnections = tcpReassembly.getConnectionInformation();
+	for (int i = 0; i < numOfConnections; i++)
+	{
+		pcpp::TcpReassembly::ConnectionInfoList::const_iterator iter = managedConnections.find(results.flowKeysList[i]);
+		if (i % 2 == 0)
+		{
+			PTF_ASSERT_TRUE(iter == managedConnections.end());
+			pcpp::ConnectionData connData;
+			connData.flowKey = results.flowKeysList[i];
+			PTF_ASSERT_LOWER_THAN(tcpReassembly.isConnectionOpen(connData), 0);
+		}
+		else
+		{
+			PTF_ASSERT_TRUE(iter != managedConnections.end());
+			PTF_ASSERT_GREATER_THAN(tcpReassembly.isConnectionOpen(iter->second), 0);
+		}
+	}
+
+	// packets of open connections are still handled
+	ipLayer.getIPv4Header()->ipSrc = htobe32(0x0a000000 + numOfConnections - 1);
+	tcpLayer.getTcpHeader()->portSrc = htobe16(1024 + numOfConnections - 1);
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(sizeof(payload));
+	PTF_ASSERT_EQUAL(tcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::TcpMessageHandled, enum);
+	PTF_ASSERT_EQUAL(results.stats[results.flowKeysList[numOfConnections - 1]].numOfDataPackets, 2);
+
+	tcpReassembly.closeAllConnections();
+	for (int i = 1; i < numOfConnections; i += 2)
+	{
+		PTF_ASSERT_TRUE(results.stats[results.flowKeysList[i]].connectionsEndedManually);
+		PTF_ASSERT_EQUAL(tcpReassembly.isConnectionOpen(managedConnections.find(results.flowKeysList[i])->second), 0);
+	}
+} // TestTcpReassemblyManyConnections
+
+
+
+PTF_TEST_CASE(TestTcpReassemblyOutOfOrderMemory)
+{
+	TcpReassemblyMultipleConnStats results;
+
+	pcpp::Packet packet;
+	pcpp::EthLayer ethLayer(pcpp::MacAddress("00:11:22:33:44:55"), pcpp::MacAddress("66:77:88:99:aa:bb"));
+	pcpp::IPv4Layer ipLayer(pcpp::IPv4Address("10.0.0.1"), pcpp::IPv4Address("192.168.0.1"));
+	pcpp::TcpLayer tcpLayer(1024, 80);
+	uint8_t payload[] = { 'a', 'a', 'a', 'a' };
+	pcpp::PayloadLayer payloadLayer(payload, sizeof(payload), false);
+	PTF_ASSERT_TRUE(packet.addLayer(&ethLayer));
+	PTF_ASSERT_TRUE(packet.addLayer(&ipLayer));
+	PTF_ASSERT_TRUE(packet.addLayer(&tcpLayer));
+	PTF_ASSERT_TRUE(packet.addLayer(&payloadLayer));
+	packet.computeCalculateFields();
+
+	uint8_t* packetPayload = payloadLayer.getData();
+
+	// no memory limit: out-of-order fragments are buffered until the gap is filled
+
+	pcpp::TcpReassembly tcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback);
+	PTF_ASSERT_EQUAL(tcpReassembly.getOutOfOrderMemoryUsage(), 0);
+
+	PTF_ASSERT_EQUAL(tcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::TcpMessageHandled, enum);
+	PTF_ASSERT_EQUAL(results.flowKeysList.size(), 1);
+	uint32_t flowKey = results.flowKeysList[0];
+
+	// send "dddd" and "cccc" before "bbbb"
+	memset(packetPayload, 'd', sizeof(payload));
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(12);
+	PTF_ASSERT_EQUAL(tcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::OutOfOrderTcpMessageBuffered, enum);
+	memset(packetPayload, 'c', sizeof(payload));
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(8);
+	PTF_ASSERT_EQUAL(tcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::OutOfOrderTcpMessageBuffered, enum);
+
+	PTF_ASSERT_EQUAL(tcpReassembly.getConnectionOutOfOrderDataSize(flowKey), 2 * sizeof(payload));
+	PTF_ASSERT_EQUAL(tcpReassembly.getConnectionOutOfOrderDataSize(flowKey + 1), 0);
+	PTF_ASSERT_GREATER_THAN(tcpReassembly.getOutOfOrderMemoryUsage(), 2 * sizeof(payload));
+	PTF_ASSERT_GREATER_OR_EQUAL_THAN(tcpReassembly.getOutOfOrderMemoryPoolSize(), tcpReassembly.getOutOfOrderMemoryUsage());
+	PTF_ASSERT_EQUAL(results.stats[flowKey].reassembledData, "aaaa");
+
+	memset(packetPayload, 'b', sizeof(payload));
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(4);
+	PTF_ASSERT_EQUAL(tcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::TcpMessageHandled, enum);
+
+	PTF_ASSERT_EQUAL(results.stats[flowKey].reassembledData, "aaaabbbbccccdddd");
+	PTF_ASSERT_EQUAL(results.stats[flowKey].totalMissingBytes, 0);
+	PTF_ASSERT_EQUAL(tcpReassembly.getConnectionOutOfOrderDataSize(flowKey), 0);
+	PTF_ASSERT_EQUAL(tcpReassembly.getOutOfOrderMemoryUsage(), 0);
+
+	// the pool keeps a slab per block size for reuse
+	size_t poolSizeAfterFewFragments = tcpReassembly.getOutOfOrderMemoryPoolSize();
+	PTF_ASSERT_GREATER_THAN(poolSizeAfterFewFragments, 0);
+
+	// buffering many fragments takes several slabs, which are returned to the heap once the fragments are released
+	memset(packetPayload, 'e', sizeof(payload));
+	const int numOfManyFragments = 3000;
+	for (int i = 1; i <= numOfManyFragments; i++)
+	{
+		tcpLayer.getTcpHeader()->sequenceNumber = htobe32(16 + i * sizeof(payload));
+		PTF_ASSERT_EQUAL(tcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::OutOfOrderTcpMessageBuffered, enum);
+	}
+
+	PTF_ASSERT_EQUAL(tcpReassembly.getConnectionOutOfOrderDataSize(flowKey), numOfManyFragments * sizeof(payload));
+	PTF_ASSERT_GREATER_THAN(tcpReassembly.getOutOfOrderMemoryPoolSize(), 2 * poolSizeAfterFewFragments);
+
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(16);
+	PTF_ASSERT_EQUAL(tcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::TcpMessageHandled, enum);
+	PTF_ASSERT_EQUAL(results.stats[flowKey].reassembledData.size(), 16 + (numOfManyFragments + 1) * sizeof(payload));
+	PTF_ASSERT_EQUAL(tcpReassembly.getOutOfOrderMemoryUsage(), 0);
+	PTF_ASSERT_EQUAL(tcpReassembly.getOutOfOrderMemoryPoolSize(), poolSizeAfterFewFragments);
+
+	// fragments still buffered when the connection is closed are released as well
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(100000);
+	PTF_ASSERT_EQUAL(tcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::OutOfOrderTcpMessageBuffered, enum);
+	PTF_ASSERT_GREATER_THAN(tcpReassembly.getOutOfOrderMemoryUsage(), 0);
+	tcpReassembly.closeAllConnections();
+	PTF_ASSERT_EQUAL(tcpReassembly.getOutOfOrderMemoryUsage(), 0);
+
+	// with a memory limit, exceeding it makes the reassembly consider the missing data lost
+
+	results.clear();
+	pcpp::TcpReassemblyConfiguration config(true, 5, 30, 0, true, 1);
+	pcpp::TcpReassembly limitedTcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback, config);
+
+	memset(packetPayload, 'a', sizeof(payload));
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(0);
+	PTF_ASSERT_EQUAL(limitedTcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::TcpMessageHandled, enum);
+	PTF_ASSERT_EQUAL(results.flowKeysList.size(), 1);
+	flowKey = results.flowKeysList[0];
+
+	memset(packetPayload, 'c', sizeof(payload));
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(8);
+	PTF_ASSERT_EQUAL(limitedTcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::OutOfOrderTcpMessageBuffered, enum);
+
+	PTF_ASSERT_EQUAL(limitedTcpReassembly.getOutOfOrderMemoryUsage(), 0);
+	PTF_ASSERT_EQUAL(limitedTcpReassembly.getConnectionOutOfOrderDataSize(flowKey), 0);
+	PTF_ASSERT_EQUAL(results.stats[flowKey].reassembledData, "aaaa[4 bytes missing]cccc");
+	PTF_ASSERT_EQUAL(results.stats[flowKey].totalMissingBytes, 4);
+
+	// data arriving after the gap was given up on is handled in order
+	memset(packetPayload, 'd', sizeof(payload));
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(12);
+	PTF_ASSERT_EQUAL(limitedTcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::TcpMessageHandled, enum);
+	PTF_ASSERT_EQUAL(results.stats[flowKey].reassembledData, "aaaa[4 bytes missing]ccccdddd");
+
+	// when the limit is exceeded the connection holding the most out-of-order data is flushed, not the one whose fragment exceeded it
+
+	// measure how much memory buffering one fragment takes
+	size_t fragmentMemoryUsage = 0;
+	{
+		results.clear();
+		pcpp::TcpReassembly probeTcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback);
+		tcpLayer.getTcpHeader()->sequenceNumber = htobe32(0);
+		PTF_ASSERT_EQUAL(probeTcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::TcpMessageHandled, enum);
+		tcpLayer.getTcpHeader()->sequenceNumber = htobe32(8);
+		PTF_ASSERT_EQUAL(probeTcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::OutOfOrderTcpMessageBuffered, enum);
+		fragmentMemoryUsage = probeTcpReassembly.getOutOfOrderMemoryUsage();
+		PTF_ASSERT_GREATER_THAN(fragmentMemoryUsage, 0);
+	}
+
+	const int numOfHolderFragments = 20;
+	results.clear();
+	pcpp::TcpReassemblyConfiguration evictionConfig(true, 5, 30, 0, true, numOfHolderFragments * fragmentMemoryUsage + fragmentMemoryUsage / 2);
+	pcpp::TcpReassembly evictingTcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback, evictionConfig);
+
+	// the large holder buffers fragments up to just below the limit
+	memset(packetPayload, 'h', sizeof(payload));
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(0);
+	PTF_ASSERT_EQUAL(evictingTcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::TcpMessageHandled, enum);
+	for (int i = 0; i < numOfHolderFragments; i++)
+	{
+		tcpLayer.getTcpHeader()->sequenceNumber = htobe32(8 + i * sizeof(payload));
+		PTF_ASSERT_EQUAL(evictingTcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::OutOfOrderTcpMessageBuffered, enum);
+	}
+	PTF_ASSERT_EQUAL(results.flowKeysList.size(), 1);
+	uint32_t holderFlowKey = results.flowKeysList[0];
+	PTF_ASSERT_EQUAL(evictingTcpReassembly.getConnectionOutOfOrderDataSize(holderFlowKey), numOfHolderFragments * sizeof(payload));
+
+	// the small victim's first out-of-order fragment exceeds the limit
+	tcpLayer.getTcpHeader()->portSrc = htobe16(1025);
+	memset(packetPayload, 'v', sizeof(payload));
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(0);
+	PTF_ASSERT_EQUAL(evictingTcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::TcpMessageHandled, enum);
+	PTF_ASSERT_EQUAL(results.flowKeysList.size(), 2);
+	uint32_t victimFlowKey = results.flowKeysList[1];
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(8);
+	PTF_ASSERT_EQUAL(evictingTcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::OutOfOrderTcpMessageBuffered, enum);
+
+	PTF_ASSERT_EQUAL(evictingTcpReassembly.getConnectionOutOfOrderDataSize(holderFlowKey), 0);
+	PTF_ASSERT_EQUAL(results.stats[holderFlowKey].totalMissingBytes, 4);
+	PTF_ASSERT_EQUAL(results.stats[holderFlowKey].reassembledData, "hhhh[4 bytes missing]" + std::string(numOfHolderFragments * sizeof(payload), 'h'));
+	PTF_ASSERT_EQUAL(evictingTcpReassembly.getConnectionOutOfOrderDataSize(victimFlowKey), sizeof(payload));
+	PTF_ASSERT_EQUAL(results.stats[victimFlowKey].reassembledData, "vvvv");
+	PTF_ASSERT_EQUAL(evictingTcpReassembly.getOutOfOrderMemoryUsage(), fragmentMemoryUsage);
+
+	// the victim's gap is still filled in order
+	tcpLayer.getTcpHeader()->sequenceNumber = htobe32(4);
+	PTF_ASSERT_EQUAL(evictingTcpReassembly.reassemblePacket(packet), pcpp::TcpReassembly::TcpMessageHandled, enum);
+	PTF_ASSERT_EQUAL(results.stats[victimFlowKey].reassembledData, "vvvvvvvvvvvv");
+	PTF_ASSERT_EQUAL(results.stats[victimFlowKey].totalMissingBytes, 0);
+	PTF_ASSERT_EQUAL(evictingTcpReassembly.getOutOfOrderMemoryUsage(), 0);
+} // TestTcpReassemblyOutOfOrderMemory
+
+
+
+PTF_TEST_CASE(TestTcpReassemblySharded)
+{
+	std::string errMsg;
+	std::vector<pcpp::RawPacket> packetStream;
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec("PcapExamples/example.pcap", packetStream, errMsg));
+
+	// reassemble the stream with a single TcpReassembly instance to get the expected results
+	TcpReassemblyMultipleConnStats expectedResults;
+	PTF_ASSERT_TRUE(tcpReassemblyTest(packetStream, expectedResults, true, true));
+	PTF_ASSERT_GREATER_THAN(expectedResults.stats.size(), 10);
+
+	TcpReassemblySharedStats sharedStats;
+	size_t numOfQueuedPackets = 0;
+	{
+		// use a small queue so the feeding thread has to wait for the workers
+		pcpp::ShardedTcpReassembly shardedTcpReassembly(4, shardedTcpReassemblyMsgReadyCallback, &sharedStats, shardedTcpReassemblyConnectionStartCallback,
+			shardedTcpReassemblyConnectionEndCallback, pcpp::TcpReassemblyConfiguration(), 16);
+		PTF_ASSERT_EQUAL(shardedTcpReassembly.getNumOfShards(), 4);
+
+		int packetIndex = 0;
+		for (std::vector<pcpp::RawPacket>::iterator iter = packetStream.begin(); iter != packetStream.end(); iter++, packetIndex++)
+		{
+			bool queued = false;
+			if (packetIndex % 2 == 0)
+			{
+				pcpp::Packet packet(&(*iter));
+				queued = shardedTcpReassembly.reassemblePacket(packet);
+				PTF_ASSERT_EQUAL(queued, packet.isPacketOfType(pcpp::TCP) && packet.isPacketOfType(pcpp::IP));
+			}
+			else
+			{
+				queued = shardedTcpReassembly.reassemblePacket(&(*iter));
+			}
+
+			if (queued)
+				numOfQueuedPackets++;
+		}
+
+		shardedTcpReassembly.closeAllConnections();
+
+		uint64_t numOfProcessedPackets = 0;
+		for (size_t i = 0; i < shardedTcpReassembly.getNumOfShards(); i++)
+			numOfProcessedPackets += shardedTcpReassembly.getNumOfProcessedPackets(i);
+		PTF_ASSERT_EQUAL(numOfProcessedPackets, numOfQueuedPackets);
+		PTF_ASSERT_EQUAL(shardedTcpReassembly.getNumOfProcessedPackets(4), 0);
+
+		for (std::vector<uint32_t>::iterator iter = expectedResults.flowKeysList.begin(); iter != expectedResults.flowKeysList.end(); iter++)
+			PTF_ASSERT_LOWER_THAN(shardedTcpReassembly.getShardIndex(*iter), 4);
+	}
+
+	// every connection is reassembled exactly like with a single TcpReassembly instance
+	PTF_ASSERT_EQUAL(sharedStats.results.stats.size(), expectedResults.stats.size());
+	for (TcpReassemblyMultipleConnStats::Stats::iterator iter = expectedResults.stats.begin(); iter != expectedResults.stats.end(); iter++)
+	{
+		TcpReassemblyMultipleConnStats::Stats::iterator shardedIter = sharedStats.results.stats.find(iter->first);
+		PTF_ASSERT_TRUE(shardedIter != sharedStats.results.stats.end());
+		PTF_ASSERT_EQUAL(shardedIter->second.numOfDataPackets, iter->second.numOfDataPackets);
+		PTF_ASSERT_EQUAL(shardedIter->second.numOfMessagesFromSide[0], iter->second.numOfMessagesFromSide[0]);
+		PTF_ASSERT_EQUAL(shardedIter->second.numOfMessagesFromSide[1], iter->second.numOfMessagesFromSide[1]);
+		PTF_ASSERT_EQUAL(shardedIter->second.connectionsStarted, iter->second.connectionsStarted);
+		PTF_ASSERT_EQUAL(shardedIter->second.connectionsEnded, iter->second.connectionsEnded);
+		PTF_ASSERT_EQUAL(shardedIter->second.connectionsEndedManually, iter->second.connectionsEndedManually);
+		PTF_ASSERT_EQUAL(shardedIter->second.totalMissingBytes, iter->second.totalMissingBytes);
+		PTF_ASSERT_EQUAL(shardedIter->second.reassembledData, iter->second.reassembledData);
+	}
+} // TestTcpReassemblySharded
+
+
+
+
+PTF_TEST_CASE(TestHttpReassembly)
+{
+	const std::string requests[] = {
+		"GET /a HTTP/1.1\r\nHost: example.com\r\n\r\n",
+		"POST /b HTTP/1.1\r\nHost: example.com\r\nContent-Length: 5\r\n\r\nhello",
+		"HEAD /c HTTP/1.1\r\nhost:  example.com \r\n\r\n"
+	};
+
+	const std::string responses[] = {
+		"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n4\r\nWiki\r\n5;ext=1\r\npedia\r\n0\r\nX-Trailer: y\r\n\r\n",
+		"HTTP/1.1 100 Continue\r\n\r\n",
+		"HTTP/1.1 201 Created\r\nContent-Length: 3\r\n\r\nabc",
+		"HTTP/1.1 200 OK\r\nContent-Length: 1000\r\n\r\n"
+	};
+
+	std::string clientStream = requests[0] + requests[1] + requests[2];
+	std::string serverStream = responses[0] + responses[1] + responses[2] + responses[3];
+
+	pcpp::ConnectionData connData;
+	connData.flowKey = 1;
+
+	// pipelined requests, chunked and content-length bodies, and responses without a body, split into segments of every size
+	for (size_t segmentSize = 1; segmentSize <= serverStream.length(); segmentSize++)
+	{
+		HttpReassemblyStats stats;
+		pcpp::HttpReassembly httpReassembly(httpReassemblyMessageEndCallback, &stats, httpReassemblyTransactionEndCallback, httpReassemblyHeadersCallback, httpReassemblyBodyCallback);
+
+		httpReassemblyFeedStream(httpReassembly, 0, clientStream, segmentSize, connData);
+		httpReassemblyFeedStream(httpReassembly, 1, serverStream, segmentSize, connData);
+		PTF_ASSERT_EQUAL(httpReassembly.getConnectionCount(), 1);
+		PTF_ASSERT_EQUAL(httpReassembly.getBufferedDataSize(), 0);
+
+		PTF_ASSERT_EQUAL(stats.messages.size(), 7);
+		for (int i = 0; i < 3; i++)
+		{
+			PTF_ASSERT_TRUE(stats.messages[i].isRequest);
+			PTF_ASSERT_TRUE(stats.messages[i].isComplete);
+			PTF_ASSERT_EQUAL(stats.messages[i].wireLength, requests[i].length());
+		}
+		for (int i = 0; i < 4; i++)
+		{
+			PTF_ASSERT_FALSE(stats.messages[3 + i].isRequest);
+			PTF_ASSERT_TRUE(stats.messages[3 + i].isComplete);
+			PTF_ASSERT_EQUAL(stats.messages[3 + i].wireLength, responses[i].length());
+			PTF_ASSERT_EQUAL(stats.messages[3 + i].side, 1);
+		}
+		PTF_ASSERT_EQUAL(stats.messages[1].bodyLength, 5);
+		PTF_ASSERT_EQUAL(stats.messages[1].contentLength, 5);
+		PTF_ASSERT_TRUE(stats.messages[3].isChunked);
+		PTF_ASSERT_EQUAL(stats.messages[3].bodyLength, 9);
+		PTF_ASSERT_EQUAL(stats.messages[4].statusCode, 100);
+		PTF_ASSERT_EQUAL(stats.messages[6].contentLength, 1000);
+		PTF_ASSERT_EQUAL(stats.messages[6].bodyLength, 0);
+		PTF_ASSERT_EQUAL(stats.bodies[0], "hello");
+		PTF_ASSERT_EQUAL(stats.bodies[1], "Wikipediaabc");
+
+		PTF_ASSERT_EQUAL(stats.headerInfo.size(), 7);
+		PTF_ASSERT_EQUAL(stats.headerInfo[0], "GET /a HTTP/1.1|/a|example.com");
+		PTF_ASSERT_EQUAL(stats.headerInfo[2], "HEAD /c HTTP/1.1|/c|example.com");
+		PTF_ASSERT_EQUAL(stats.headerInfo[5], "HTTP/1.1 201 Created||");
+
+		// the informational response doesn't end a transaction
+		PTF_ASSERT_EQUAL(stats.transactions.size(), 3);
+		PTF_ASSERT_EQUAL(stats.transactions[0].first.method, pcpp::HttpRequestLayer::HttpGET, enum);
+		PTF_ASSERT_EQUAL(stats.transactions[0].second.statusCode, 200);
+		PTF_ASSERT_EQUAL(stats.transactions[1].first.method, pcpp::HttpRequestLayer::HttpPOST, enum);
+		PTF_ASSERT_EQUAL(stats.transactions[1].second.statusCode, 201);
+		PTF_ASSERT_EQUAL(stats.transactions[1].second.method, pcpp::HttpRequestLayer::HttpPOST, enum);
+		PTF_ASSERT_EQUAL(stats.transactions[2].first.method, pcpp::HttpRequestLayer::HttpHEAD, enum);
+		PTF_ASSERT_EQUAL(stats.transactions[2].second.bodyLength, 0);
+		PTF_ASSERT_EQUAL(stats.transactions[2].first.endTime.tv_sec, (time_t)((clientStream.length() - 1) / segmentSize * segmentSize));
+		PTF_ASSERT_EQUAL(stats.transactions[2].second.endTime.tv_sec, (time_t)((serverStream.length() - 1) / segmentSize * segmentSize));
+
+		httpReassembly.onTcpConnectionEnd(connData);
+		PTF_ASSERT_EQUAL(httpReassembly.getConnectionCount(), 0);
+		PTF_ASSERT_EQUAL(stats.messages.size(), 7);
+	}
+
+	HttpReassemblyStats stats;
+	pcpp::HttpReassembly httpReassembly(httpReassemblyMessageEndCallback, &stats, httpReassemblyTransactionEndCallback, NULL, httpReassemblyBodyCallback);
+	timeval timestamp = { 0, 0 };
+
+	// a body delimited by the end of the connection, with missing bytes in it
+	connData.flowKey = 2;
+	httpReassemblyFeedStream(httpReassembly, 0, "GET / HTTP/1.0\r\n\r\n", 100, connData);
+	httpReassemblyFeedStream(httpReassembly, 1, "HTTP/1.0 200 OK\r\n\r\nsome data", 100, connData);
+	std::string dataAfterMissingBytes = "[4 bytes missing]more";
+	pcpp::TcpStreamData missingDataStream((const uint8_t*)dataAfterMissingBytes.data(), dataAfterMissingBytes.length(), 4, connData, timestamp);
+	httpReassembly.onTcpMessageReady(1, missingDataStream);
+	PTF_ASSERT_EQUAL(stats.messages.size(), 1);
+	httpReassembly.onTcpConnectionEnd(connData);
+	PTF_ASSERT_EQUAL(stats.messages.size(), 2);
+	PTF_ASSERT_TRUE(stats.messages[1].isComplete);
+	PTF_ASSERT_TRUE(stats.messages[1].isBytesMissing);
+	PTF_ASSERT_EQUAL(stats.messages[1].bodyLength, 13);
+	PTF_ASSERT_EQUAL(stats.messages[1].wireLength, 36);
+	PTF_ASSERT_EQUAL(stats.bodies[1], "some datamore");
+	PTF_ASSERT_EQUAL(stats.transactions.size(), 1);
+
+	// missing bytes inside a header: the message is incomplete and parsing resumes on the next start line
+	stats.clear();
+	connData.flowKey = 3;
+	httpReassemblyFeedStream(httpReassembly, 0, "GET /1 HTTP/1.1\r\nHo", 100, connData);
+	dataAfterMissingBytes = "[10 bytes missing]x\r\n\r\nGET /2 HTTP/1.1\r\n\r\n";
+	pcpp::TcpStreamData missingHeaderStream((const uint8_t*)dataAfterMissingBytes.data(), dataAfterMissingBytes.length(), 10, connData, timestamp);
+	httpReassembly.onTcpMessageReady(0, missingHeaderStream);
+	httpReassemblyFeedStream(httpReassembly, 1, "HTTP/1.1 204 No Content\r\n\r\n", 100, connData);
+	PTF_ASSERT_EQUAL(stats.messages.size(), 3);
+	PTF_ASSERT_FALSE(stats.messages[0].isComplete);
+	PTF_ASSERT_TRUE(stats.messages[0].isBytesMissing);
+	PTF_ASSERT_TRUE(stats.messages[1].isComplete);
+	PTF_ASSERT_EQUAL(stats.messages[1].wireLength, 19);
+	PTF_ASSERT_EQUAL(stats.messages[2].statusCode, 204);
+	// requests and responses can't be matched after data was lost
+	PTF_ASSERT_EQUAL(stats.transactions.size(), 0);
+
+	// missing bytes that end exactly at the end of a chunk: the parser stays in sync and the message completes
+	stats.clear();
+	connData.flowKey = 5;
+	httpReassemblyFeedStream(httpReassembly, 0, "GET /1 HTTP/1.1\r\n\r\nGET /2 HTTP/1.1\r\n\r\n", 100, connData);
+	httpReassemblyFeedStream(httpReassembly, 1, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n4\r\nWi", 100, connData);
+	dataAfterMissingBytes = "[2 bytes missing]\r\n0\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+	pcpp::TcpStreamData missingChunkStream((const uint8_t*)dataAfterMissingBytes.data(), dataAfterMissingBytes.length(), 2, connData, timestamp);
+	httpReassembly.onTcpMessageReady(1, missingChunkStream);
+	PTF_ASSERT_EQUAL(stats.messages.size(), 4);
+	PTF_ASSERT_FALSE(stats.messages[2].isRequest);
+	PTF_ASSERT_TRUE(stats.messages[2].isComplete);
+	PTF_ASSERT_TRUE(stats.messages[2].isBytesMissing);
+	PTF_ASSERT_EQUAL(stats.messages[2].bodyLength, 2);
+	PTF_ASSERT_EQUAL(stats.messages[2].wireLength, 61);
+	PTF_ASSERT_TRUE(stats.messages[3].isComplete);
+	PTF_ASSERT_FALSE(stats.messages[3].isBytesMissing);
+	PTF_ASSERT_EQUAL(stats.messages[3].bodyLength, 2);
+	PTF_ASSERT_EQUAL(stats.transactions.size(), 2);
+	PTF_ASSERT_EQUAL(stats.transactions[1].second.contentLength, 2);
+
+	// a header longer than the maximum header size stops the parsing of that side
+	stats.clear();
+	connData.flowKey = 4;
+	pcpp::HttpReassembly limitedHttpReassembly(httpReassemblyMessageEndCallback, &stats, NULL, NULL, NULL, pcpp::HttpReassemblyConfiguration(32));
+	httpReassemblyFeedStream(limitedHttpReassembly, 0, "GET /" + std::string(40, 'a') + " HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\n\r\n", 10, connData);
+	PTF_ASSERT_EQUAL(stats.messages.size(), 1);
+	PTF_ASSERT_FALSE(stats.messages[0].isComplete);
+	PTF_ASSERT_EQUAL(limitedHttpReassembly.getBufferedDataSize(), 0);
+
+	httpReassembly.closeAllConnections();
+	PTF_ASSERT_EQUAL(httpReassembly.getConnectionCount(), 0);
+} // TestHttpReassembly
+
+
+
+PTF_TEST_CASE(TestHttpReassemblyWithTcpReassembly)
+{
+	std::string errMsg;
+	std::vector<pcpp::RawPacket> packetStream;
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec("PcapExamples/three_http_streams.pcap", packetStream, errMsg));
+
+	TcpReassemblyMultipleConnStats tcpResults;
+	PTF_ASSERT_TRUE(tcpReassemblyTest(packetStream, tcpResults, true, true));
+
+	HttpReassemblyStats stats;
+	pcpp::HttpReassembly httpReassembly(httpReassemblyMessageEndCallback, &stats, httpReassemblyTransactionEndCallback, httpReassemblyHeadersCallback);
+	pcpp::TcpReassembly tcpReassembly(pcpp::HttpReassembly::tcpMessageReadyCallback, &httpReassembly, NULL, pcpp::HttpReassembly::tcpConnectionEndCallback);
+	for (std::vector<pcpp::RawPacket>::iterator iter = packetStream.begin(); iter != packetStream.end(); iter++)
+	{
+		pcpp::Packet packet(&(*iter));
+		tcpReassembly.reassemblePacket(packet);
+	}
+	tcpReassembly.closeAllConnections();
+	PTF_ASSERT_EQUAL(httpReassembly.getConnectionCount(), 0);
+
+	PTF_ASSERT_EQUAL(stats.messages.size(), 6);
+	PTF_ASSERT_EQUAL(stats.transactions.size(), 3);
+
+	// all the data of each connection belongs to its request and response
+	for (size_t i = 0; i < stats.transactions.size(); i++)
+	{
+		const pcpp::HttpMessageData& request = stats.transactions[i].first;
+		const pcpp::HttpMessageData& response = stats.transactions[i].second;
+		PTF_ASSERT_EQUAL(request.method, pcpp::HttpRequestLayer::HttpGET, enum);
+		PTF_ASSERT_TRUE(request.isComplete);
+		PTF_ASSERT_EQUAL(response.statusCode, 200);
+		PTF_ASSERT_TRUE(response.isComplete);
+		PTF_ASSERT_GREATER_THAN(response.bodyLength, 0);
+		PTF_ASSERT_EQUAL(request.flowKey, response.flowKey);
+		PTF_ASSERT_EQUAL(request.wireLength + response.wireLength, tcpResults.stats[request.flowKey].reassembledData.length());
+		PTF_ASSERT_FALSE(response.startTime.tv_sec < request.endTime.tv_sec);
+	}
+
+	// one response has a Content-Length, the others end with the connection
+	int numOfContentLengthResponses = 0;
+	for (size_t i = 0; i < stats.transactions.size(); i++)
+	{
+		const pcpp::HttpMessageData& response = stats.transactions[i].second;
+		if (response.contentLength < 0)
+			continue;
+
+		numOfContentLengthResponses++;
+		PTF_ASSERT_EQUAL(response.contentLength, 43);
+		PTF_ASSERT_EQUAL(response.bodyLength, 43);
+	}
+	PTF_ASSERT_EQUAL(numOfContentLengthResponses, 1);
+	PTF_ASSERT_TRUE(std::find(stats.headerInfo.begin(), stats.headerInfo.end(), "GET / HTTP/1.1|/|www.bowlsbybruno.com") != stats.headerInfo.end());
+} // TestHttpReassemblyWithTcpReassembly
@@ -202,6 +202,7 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(TestIPAddress, "no_network;ip");
 	PTF_RUN_TEST(TestMacAddress, "no_network;mac");
 	PTF_RUN_TEST(TestLRUList, "no_network");
+	PTF_RUN_TEST(TestHashedLRUList, "no_network");
 	PTF_RUN_TEST(TestGeneralUtils, "no_network");
 	PTF_RUN_TEST(TestGetMacAddress, "mac");
 	PTF_RUN_TEST(TestIPv4Network, "no_network;ip");
@@ -210,17 +211,21 @@ int main(int argc, char* argv[])
 
 	PTF_RUN_TEST(TestLogger, "no_network;logger");
 	PTF_RUN_TEST(TestLoggerMultiThread, "no_network;logger;skip_mem_leak_check");
+	PTF_RUN_TEST(TestLoggerAsync, "no_network;logger;skip_mem_leak_check");
 
 	PTF_RUN_TEST(TestPcapFileReadWrite, "no_network;pcap");
 	PTF_RUN_TEST(TestPcapSllFileReadWrite, "no_network;pcap");
 	PTF_RUN_TEST(TestPcapSll2FileReadWrite, "no_network;pcap");
 	PTF_RUN_TEST(TestPcapRawIPFileReadWrite, "no_network;pcap");
 	PTF_RUN_TEST(TestPcapFileAppend, "no_network;pcap");
+	PTF_RUN_TEST(TestPcapFileAsyncWrite, "no_network;pcap;pcapng");
 	PTF_RUN_TEST(TestPcapNgFileReadWrite, "no_network;pcap;pcapng");
 	PTF_RUN_TEST(TestPcapNgFileReadWriteAdv, "no_network;pcap;pcapng");
 	PTF_RUN_TEST(TestPcapFileReadLinkTypeIPv6, "no_network;pcap");
 	PTF_RUN_TEST(TestPcapFileReadLinkTypeIPv4, "no_network;pcap");
 	PTF_RUN_TEST(TestSolarisSnoopFileRead, "no_network;pcap;snoop");
+	PTF_RUN_TEST(TestFileReaderPacketDataModes, "no_network;pcap;pcapng;snoop");
+	PTF_RUN_TEST(TestPcapMmapFileReader, "no_network;pcap");
 
 	PTF_RUN_TEST(TestPcapLiveDeviceList, "no_network;live_device;skip_mem_leak_check");
 	PTF_RUN_TEST(TestPcapLiveDeviceListSearch, "live_device");
@@ -228,6 +233,7 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(TestPcapLiveDeviceClone, "live_device");
 	PTF_RUN_TEST(TestPcapLiveDeviceNoNetworking, "no_network;live_device");
 	PTF_RUN_TEST(TestPcapLiveDeviceStatsMode, "live_device");
+	PTF_RUN_TEST(TestPcapLiveDeviceBurstMode, "live_device");
 	PTF_RUN_TEST(TestPcapLiveDeviceBlockingMode, "live_device");
 	PTF_RUN_TEST(TestPcapLiveDeviceSpecialCfg, "live_device");
 	PTF_RUN_TEST(TestWinPcapLiveDevice, "live_device;winpcap");
@@ -240,6 +246,7 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(TestPcapFiltersLive, "filters");
 	PTF_RUN_TEST(TestPcapFilters_General_BPFStr, "no_network;filters;skip_mem_leak_check");
 	PTF_RUN_TEST(TestPcapFiltersOffline, "no_network;filters");
+	PTF_RUN_TEST(TestPcapFiltersCompiled, "no_network;filters");
 	PTF_RUN_TEST(TestPcapFilters_LinkLayer, "no_network;filters;skip_mem_leak_check");
 
 	PTF_RUN_TEST(TestHttpRequestParsing, "no_network;http");
@@ -280,6 +287,11 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(TestTcpReassemblyMaxSeq, "no_network;tcp_reassembly");
 	PTF_RUN_TEST(TestTcpReassemblyDisableOOOCleanup, "no_network;tcp_reassembly");
 	PTF_RUN_TEST(TestTcpReassemblyTimeStamps, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestTcpReassemblyManyConnections, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestTcpReassemblyOutOfOrderMemory, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestTcpReassemblySharded, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestHttpReassembly, "no_network;tcp_reassembly;http");
+	PTF_RUN_TEST(TestHttpReassemblyWithTcpReassembly, "no_network;tcp_reassembly;http");
 
 	PTF_RUN_TEST(TestIPFragmentationSanity, "no_network;ip_frag");
 	PTF_RUN_TEST(TestIPFragOutOfOrder, "no_network;ip_frag");
@@ -288,8 +300,11 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(TestIPFragMapOverflow, "no_network;ip_frag");
 	PTF_RUN_TEST(TestIPFragRemove, "no_network;ip_frag");
 	PTF_RUN_TEST(TestIPFragWithPadding, "no_network;ip_frag");
+	PTF_RUN_TEST(TestIPFragMemoryBudget, "no_network;ip_frag");
 
 	PTF_RUN_TEST(TestRawSockets, "raw_sockets");
+	PTF_RUN_TEST(TestRawSocketsRxRing, "raw_sockets");
+	PTF_RUN_TEST(TestRawSocketsBatchSend, "raw_sockets");
 
 	PTF_RUN_TEST(TestSystemCoreUtils, "no_network;system_utils");
 
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""
+Generates the cipher-suite lookup tables in Packet++/src/SSLHandshake.cpp.
+
+The tables map cipher-suite IDs and names to the SSLCipherSuite objects defined in the cipher-suite list of that file
+(the "static const SSLCipherSuite CipherN = SSLCipherSuite(...)" lines). They're written between the
+"// BEGIN GENERATED CIPHER-SUITE TABLES" and "// END GENERATED CIPHER-SUITE TABLES" lines.
+
+Usage, after adding, removing or changing cipher-suites in the list:
+
+    python3 scripts/generate_cipher_suite_tables.py
+
+Use --check to verify the tables are up to date without changing the file. The script exits with status 1 if they aren't.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+DEFAULT_SOURCE_FILE = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Packet++", "src", "SSLHandshake.cpp"))
+
+BEGIN_MARKER = "// BEGIN GENERATED CIPHER-SUITE TABLES\n"
+END_MARKER = "// END GENERATED CIPHER-SUITE TABLES\n"
+
+CIPHER_SUITE_PATTERN = re.compile(
+    r'^static const SSLCipherSuite Cipher(\d+) = SSLCipherSuite\((0x[0-9A-Fa-f]+),[^"]*"([^"]+)"\);$', re.MULTILINE
+)
+
+# must match hashString() in SSLHandshake.cpp
+HASH_A = 54059
+HASH_B = 76963
+HASH_FIRST = 37
+
+ID_TABLE_ENTRIES_PER_ROW = 8
+PAGE_INDEX_ENTRIES_PER_ROW = 32
+NAME_TABLE_ENTRIES_PER_ROW = 8
+
+
+def hash_string(name):
+    h = HASH_FIRST
+    for c in name:
+        h = ((h * HASH_A) ^ (ord(c) * HASH_B)) & 0xFFFFFFFF
+    return h
+
+
+def format_rows(entries, entries_per_row, indent):
+    rows = []
+    for i in range(0, len(entries), entries_per_row):
+        rows.append(indent + ", ".join(entries[i : i + entries_per_row]))
+    return ",\n".join(rows)
+
+
+def parse_cipher_suites(source):
+    cipher_suites = [(int(num), int(cipher_id, 16), name) for num, cipher_id, name in CIPHER_SUITE_PATTERN.findall(source)]
+    if not cipher_suites:
+        raise ValueError("no cipher-suites found")
+
+    ids = [cipher_id for _, cipher_id, _ in cipher_suites]
+    names = [name for _, _, name in cipher_suites]
+    if len(set(ids)) != len(ids):
+        raise ValueError("duplicate cipher-suite IDs")
+    if len(set(names)) != len(names):
+        raise ValueError("duplicate cipher-suite names")
+
+    return cipher_suites
+
+
+def generate_id_tables(cipher_suites):
+    var_by_id = {cipher_id: "&Cipher%d" % num for num, cipher_id, _ in cipher_suites}
+    pages = sorted(set(cipher_id >> 8 for cipher_id in var_by_id))
+    if len(pages) > 255:
+        raise ValueError("too many ID pages for a uint8_t page index")
+
+    # page 0 is the empty page shared by all pages with no known IDs
+    page_index = {page: i + 1 for i, page in enumerate(pages)}
+    page_index_entries = [str(page_index.get(page, 0)) for page in range(256)]
+
+    page_tables = ["\t// unknown pages\n\t{}"]
+    for page in pages:
+        entries = [var_by_id.get((page << 8) | low_byte, "nullptr") for low_byte in range(256)]
+        page_tables.append(
+            "\t// 0x%02X00-0x%02XFF\n\t{\n%s\n\t}" % (page, page, format_rows(entries, ID_TABLE_ENTRIES_PER_ROW, "\t\t"))
+        )
+
+    return (
+        "// Cipher-suite IDs are looked up in two steps: the high byte of the ID selects a page of 256 cipher-suites and the low byte selects\n"
+        "// the cipher-suite in the page. All known IDs fall in %d pages so the tables take a few KB instead of a 65536-entry array, and IDs in\n"
+        "// pages with no known cipher-suites point to an empty page so a lookup never branches. These tables and the name table below are\n"
+        "// constant-initialized, so they don't cost anything at startup\n"
+        "static const uint8_t CipherSuiteIdPageIndex[256] =\n"
+        "{\n"
+        "%s\n"
+        "};\n"
+        "\n"
+        "static const SSLCipherSuite* const CipherSuiteIdPages[%d][256] =\n"
+        "{\n"
+        "%s\n"
+        "};\n"
+    ) % (
+        len(pages),
+        format_rows(page_index_entries, PAGE_INDEX_ENTRIES_PER_ROW, "\t"),
+        len(pages) + 1,
+        ",\n".join(page_tables),
+    )
+
+
+def generate_name_table(cipher_suites):
+    # the smallest power of 2 that keeps the table less than a third full
+    table_size = 1
+    while table_size < 3 * len(cipher_suites):
+        table_size *= 2
+
+    table = [None] * table_size
+    for num, _, name in cipher_suites:
+        slot = hash_string(name) & (table_size - 1)
+        while table[slot] is not None:
+            slot = (slot + 1) & (table_size - 1)
+        table[slot] = "&Cipher%d" % num
+
+    entries = [entry if entry is not None else "nullptr" for entry in table]
+
+    return (
+        "// An open-addressing hash table of the cipher-suites by name: a name is looked for from slot hashString(name) %% %d onwards until\n"
+        "// it's found or an empty slot is reached. The table is less than a third full so most names are found in the first slot\n"
+        "static const size_t CipherSuiteNameTableSize = %d;\n"
+        "\n"
+        "static const SSLCipherSuite* const CipherSuiteNameTable[CipherSuiteNameTableSize] =\n"
+        "{\n"
+        "%s\n"
+        "};\n"
+    ) % (table_size, table_size, format_rows(entries, NAME_TABLE_ENTRIES_PER_ROW, "\t"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the cipher-suite lookup tables in SSLHandshake.cpp")
+    parser.add_argument("--file", default=DEFAULT_SOURCE_FILE, help="path of SSLHandshake.cpp")
+    parser.add_argument("--check", action="store_true", help="only check that the tables are up to date")
+    args = parser.parse_args()
+
+    with open(args.file, newline="") as source_file:
+        source = source_file.read()
+
+    begin = source.find(BEGIN_MARKER)
+    end = source.find(END_MARKER)
+    if begin < 0 or end < begin:
+        sys.exit("%s: generated tables markers not found" % args.file)
+
+    cipher_suites = parse_cipher_suites(source[:begin])
+    generated = generate_id_tables(cipher_suites) + "\n" + generate_name_table(cipher_suites)
+    new_source = source[: begin + len(BEGIN_MARKER)] + generated + source[end:]
+
+    if new_source == source:
+        return 0
+
+    if args.check:
+        print("%s: cipher-suite tables are out of date, run %s" % (args.file, os.path.relpath(__file__)))
+        return 1
+
+    with open(args.file, "w", newline="") as source_file:
+        source_file.write(new_source)
+    print("%s: updated the tables of %d cipher-suites" % (args.file, len(cipher_suites)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())